@@ -1,6 +1,7 @@
 #include "Blob.h"
 #include "Log.h"
 #include <fstream>
+#include <cstring>
 
 bool Blob::ReadBinaryFile(const std::filesystem::path& path)
 {
@@ -37,6 +38,26 @@ bool Blob::ReadBinaryFile(const std::filesystem::path& path)
     return true;
 }
 
+bool Blob::Copy(const void* inData, size_t inSize)
+{
+    Release();
+    if(inData == nullptr || inSize == 0)
+    {
+        return false;
+    }
+    
+    m_Data = static_cast<uint8_t*>(malloc(inSize));
+    if (m_Data == nullptr)
+    {
+        Log::Error("Failed to malloc %llu bytes for the blob", static_cast<unsigned long long>(inSize));
+        return false;
+    }
+    
+    memcpy(m_Data, inData, inSize);
+    m_Size = inSize;
+    return true;
+}
+
 void Blob::Release()
 {
     if(m_Data)
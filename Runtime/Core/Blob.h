@@ -15,6 +15,7 @@ public:
     size_t          GetSize() const { return m_Size; }
     bool            IsEmpty() const { return m_Data == nullptr || m_Size == 0; }
     bool            ReadBinaryFile(const std::filesystem::path& path);
+    bool            Copy(const void* inData, size_t inSize);
     void            Release();  
 
 private:
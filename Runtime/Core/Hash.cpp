@@ -1 +1,6 @@
-#include "Hash.h"
\ No newline at end of file
+#include "Hash.h"
+
+size_t HashCombine(size_t inSeed, size_t inValue)
+{
+    return static_cast<size_t>(Hash128to64(uint128(inSeed, inValue)));
+}
\ No newline at end of file
@@ -2,4 +2,4 @@
 
 #include "CityHash.h"
 
-// size_t Combine
\ No newline at end of file
+size_t HashCombine(size_t inSeed, size_t inValue);
\ No newline at end of file
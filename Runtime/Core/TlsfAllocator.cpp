@@ -0,0 +1,282 @@
+#include "TlsfAllocator.h"
+#include "Templates.h"
+
+static uint32_t FloorLog2(uint64_t inValue)
+{
+    uint32_t result = 0;
+    for(uint32_t shift = 32; shift > 0; shift >>= 1)
+    {
+        if(inValue >= (1ull << shift))
+        {
+            inValue >>= shift;
+            result += shift;
+        }
+    }
+    return result;
+}
+
+static uint32_t LowestBit(uint64_t inValue)
+{
+    return FloorLog2(inValue & (~inValue + 1));
+}
+
+void TlsfAllocator::SetTotalSize(uint64_t inSize)
+{
+    m_TotalSize = inSize;
+    Reset();
+}
+
+void TlsfAllocator::Reset()
+{
+    m_Blocks.clear();
+    m_UnusedBlocks.clear();
+    m_UsedBlocks.clear();
+    for(auto& freeLists : m_FreeLists)
+    {
+        for(uint32_t& freeList : freeLists)
+        {
+            freeList = s_InvalidBlock;
+        }
+    }
+    m_ClassBitmap = 0;
+    for(uint32_t& bitmap : m_SubClassBitmaps)
+    {
+        bitmap = 0;
+    }
+    m_UsedSize = 0;
+    
+    if(m_TotalSize > 0)
+    {
+        InsertFreeBlock(CreateBlock(0, m_TotalSize));
+    }
+}
+
+bool TlsfAllocator::TryAllocate(uint64_t inSize, uint64_t inAlignment, uint64_t& outOffset)
+{
+    const uint32_t found = FindFreeBlock(inSize, inAlignment);
+    if(found == s_InvalidBlock)
+    {
+        outOffset = UINT64_MAX;
+        return false;
+    }
+
+    uint32_t block = found;
+    RemoveFreeBlock(block);
+    const uint64_t offset = Align(m_Blocks[block].Offset, inAlignment);
+    const uint64_t padding = offset - m_Blocks[block].Offset;
+    if(padding > 0)
+    {
+        // The front padding stays free for smaller allocations
+        const uint32_t tail = SplitBlock(block, padding);
+        InsertFreeBlock(block);
+        block = tail;
+    }
+    if(m_Blocks[block].Size > inSize)
+    {
+        InsertFreeBlock(SplitBlock(block, inSize));
+    }
+
+    m_UsedBlocks.emplace(offset, block);
+    m_UsedSize += inSize;
+    outOffset = offset;
+    return true;
+}
+
+void TlsfAllocator::GetFreeRanges(std::vector<Range>& outRanges) const
+{
+    outRanges.clear();
+    // The first block is never released, it always starts at offset 0
+    for(uint32_t block = m_Blocks.empty() ? s_InvalidBlock : 0; block != s_InvalidBlock; block = m_Blocks[block].NextPhysical)
+    {
+        if(m_Blocks[block].IsFree)
+        {
+            outRanges.push_back({m_Blocks[block].Offset, m_Blocks[block].Size});
+        }
+    }
+}
+
+bool TlsfAllocator::CanAllocate(uint64_t inSize, uint64_t inAlignment) const
+{
+    return FindFreeBlock(inSize, inAlignment) != s_InvalidBlock;
+}
+
+void TlsfAllocator::Free(uint64_t inOffset)
+{
+    auto iter = m_UsedBlocks.find(inOffset);
+    if(iter == m_UsedBlocks.end())
+    {
+        return;
+    }
+    uint32_t block = iter->second;
+    m_UsedBlocks.erase(iter);
+    m_UsedSize -= m_Blocks[block].Size;
+
+    const uint32_t next = m_Blocks[block].NextPhysical;
+    if(next != s_InvalidBlock && m_Blocks[next].IsFree)
+    {
+        RemoveFreeBlock(next);
+        m_Blocks[block].Size += m_Blocks[next].Size;
+        m_Blocks[block].NextPhysical = m_Blocks[next].NextPhysical;
+        if(m_Blocks[next].NextPhysical != s_InvalidBlock)
+        {
+            m_Blocks[m_Blocks[next].NextPhysical].PrevPhysical = block;
+        }
+        ReleaseBlock(next);
+    }
+
+    const uint32_t prev = m_Blocks[block].PrevPhysical;
+    if(prev != s_InvalidBlock && m_Blocks[prev].IsFree)
+    {
+        RemoveFreeBlock(prev);
+        m_Blocks[prev].Size += m_Blocks[block].Size;
+        m_Blocks[prev].NextPhysical = m_Blocks[block].NextPhysical;
+        if(m_Blocks[block].NextPhysical != s_InvalidBlock)
+        {
+            m_Blocks[m_Blocks[block].NextPhysical].PrevPhysical = prev;
+        }
+        ReleaseBlock(block);
+        block = prev;
+    }
+    
+    InsertFreeBlock(block);
+}
+
+void TlsfAllocator::MapSize(uint64_t inSize, uint32_t& outClass, uint32_t& outSubClass)
+{
+    if(inSize < s_NumSubClasses)
+    {
+        outClass = 0;
+        outSubClass = static_cast<uint32_t>(inSize);
+        return;
+    }
+    const uint32_t log2 = FloorLog2(inSize);
+    outClass = log2 - s_SubClassesLog2 + 1;
+    outSubClass = static_cast<uint32_t>(inSize >> (log2 - s_SubClassesLog2)) - s_NumSubClasses;
+}
+
+uint32_t TlsfAllocator::FindFreeBlock(uint64_t inSize, uint64_t inAlignment) const
+{
+    if(inSize == 0 || inSize > m_TotalSize)
+    {
+        return s_InvalidBlock;
+    }
+    
+    // Starts at the class of inSize, the blocks of that class may be too small or too misaligned and are checked.
+    // Every class after it holds only blocks larger than inSize
+    uint32_t classIndex, subClassIndex;
+    MapSize(inSize, classIndex, subClassIndex);
+    uint32_t subClassMask = m_SubClassBitmaps[classIndex] & (~0u << subClassIndex);
+    while(true)
+    {
+        if(subClassMask == 0)
+        {
+            const uint64_t classMask = classIndex + 1 < s_NumClasses ? m_ClassBitmap & (~0ull << (classIndex + 1)) : 0;
+            if(classMask == 0)
+            {
+                return s_InvalidBlock;
+            }
+            classIndex = LowestBit(classMask);
+            subClassMask = m_SubClassBitmaps[classIndex];
+        }
+        subClassIndex = LowestBit(subClassMask);
+        subClassMask &= subClassMask - 1;
+
+        for(uint32_t block = m_FreeLists[classIndex][subClassIndex]; block != s_InvalidBlock; block = m_Blocks[block].NextFree)
+        {
+            const Block& freeBlock = m_Blocks[block];
+            const uint64_t offset = Align(freeBlock.Offset, inAlignment);
+            if(offset + inSize <= freeBlock.Offset + freeBlock.Size)
+            {
+                return block;
+            }
+        }
+    }
+}
+
+uint32_t TlsfAllocator::CreateBlock(uint64_t inOffset, uint64_t inSize)
+{
+    uint32_t block;
+    if(!m_UnusedBlocks.empty())
+    {
+        block = m_UnusedBlocks.back();
+        m_UnusedBlocks.pop_back();
+        m_Blocks[block] = Block();
+    }
+    else
+    {
+        block = static_cast<uint32_t>(m_Blocks.size());
+        m_Blocks.emplace_back();
+    }
+    m_Blocks[block].Offset = inOffset;
+    m_Blocks[block].Size = inSize;
+    return block;
+}
+
+void TlsfAllocator::ReleaseBlock(uint32_t inBlock)
+{
+    m_UnusedBlocks.push_back(inBlock);
+}
+
+void TlsfAllocator::InsertFreeBlock(uint32_t inBlock)
+{
+    uint32_t classIndex, subClassIndex;
+    MapSize(m_Blocks[inBlock].Size, classIndex, subClassIndex);
+
+    Block& block = m_Blocks[inBlock];
+    block.IsFree = true;
+    block.PrevFree = s_InvalidBlock;
+    block.NextFree = m_FreeLists[classIndex][subClassIndex];
+    if(block.NextFree != s_InvalidBlock)
+    {
+        m_Blocks[block.NextFree].PrevFree = inBlock;
+    }
+    m_FreeLists[classIndex][subClassIndex] = inBlock;
+    m_ClassBitmap |= 1ull << classIndex;
+    m_SubClassBitmaps[classIndex] |= 1u << subClassIndex;
+}
+
+void TlsfAllocator::RemoveFreeBlock(uint32_t inBlock)
+{
+    uint32_t classIndex, subClassIndex;
+    MapSize(m_Blocks[inBlock].Size, classIndex, subClassIndex);
+
+    Block& block = m_Blocks[inBlock];
+    if(block.PrevFree != s_InvalidBlock)
+    {
+        m_Blocks[block.PrevFree].NextFree = block.NextFree;
+    }
+    else
+    {
+        m_FreeLists[classIndex][subClassIndex] = block.NextFree;
+    }
+    if(block.NextFree != s_InvalidBlock)
+    {
+        m_Blocks[block.NextFree].PrevFree = block.PrevFree;
+    }
+    block.IsFree = false;
+    block.PrevFree = s_InvalidBlock;
+    block.NextFree = s_InvalidBlock;
+
+    if(m_FreeLists[classIndex][subClassIndex] == s_InvalidBlock)
+    {
+        m_SubClassBitmaps[classIndex] &= ~(1u << subClassIndex);
+        if(m_SubClassBitmaps[classIndex] == 0)
+        {
+            m_ClassBitmap &= ~(1ull << classIndex);
+        }
+    }
+}
+
+uint32_t TlsfAllocator::SplitBlock(uint32_t inBlock, uint64_t inSize)
+{
+    const uint32_t tail = CreateBlock(m_Blocks[inBlock].Offset + inSize, m_Blocks[inBlock].Size - inSize);
+    m_Blocks[tail].PrevPhysical = inBlock;
+    m_Blocks[tail].NextPhysical = m_Blocks[inBlock].NextPhysical;
+    if(m_Blocks[inBlock].NextPhysical != s_InvalidBlock)
+    {
+        m_Blocks[m_Blocks[inBlock].NextPhysical].PrevPhysical = tail;
+    }
+    m_Blocks[inBlock].NextPhysical = tail;
+    m_Blocks[inBlock].Size = inSize;
+    return tail;
+}
\ No newline at end of file
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <unordered_map>
+
+// Two level segregated fit allocator over a range of bytes. The free blocks are binned by size into power of two
+// classes which are split into s_NumSubClasses linear sub classes, a bitmap per level finds a fitting free block in
+// constant time. Adjacent free blocks are merged when a block is freed.
+class TlsfAllocator
+{
+public:
+    struct Range
+    {
+        uint64_t Offset;
+        uint64_t Size;
+    };
+    
+    TlsfAllocator() = default;
+    TlsfAllocator(uint64_t inSize) { SetTotalSize(inSize); }
+    void SetTotalSize(uint64_t inSize);
+    uint64_t GetTotalSize() const { return m_TotalSize; }
+    uint64_t GetUsedSize() const { return m_UsedSize; }
+    uint32_t GetAllocationCount() const { return static_cast<uint32_t>(m_UsedBlocks.size()); }
+    // inAlignment must be a power of two
+    bool TryAllocate(uint64_t inSize, uint64_t inAlignment, uint64_t& outOffset);
+    // True if TryAllocate would succeed, does not change the allocator
+    bool CanAllocate(uint64_t inSize, uint64_t inAlignment) const;
+    void Free(uint64_t inOffset);
+    void Reset();
+    // The free ranges in offset order
+    void GetFreeRanges(std::vector<Range>& outRanges) const;
+    bool IsEmpty() const { return m_UsedBlocks.empty(); }
+
+private:
+    static constexpr uint32_t s_SubClassesLog2 = 5;
+    static constexpr uint32_t s_NumSubClasses = 1 << s_SubClassesLog2;
+    static constexpr uint32_t s_NumClasses = 64 - s_SubClassesLog2 + 1;
+    static constexpr uint32_t s_InvalidBlock = UINT32_MAX;
+
+    struct Block
+    {
+        uint64_t Offset = 0;
+        uint64_t Size = 0;
+        uint32_t PrevPhysical = s_InvalidBlock;
+        uint32_t NextPhysical = s_InvalidBlock;
+        uint32_t PrevFree = s_InvalidBlock;
+        uint32_t NextFree = s_InvalidBlock;
+        bool IsFree = false;
+    };
+
+    static void MapSize(uint64_t inSize, uint32_t& outClass, uint32_t& outSubClass);
+    uint32_t FindFreeBlock(uint64_t inSize, uint64_t inAlignment) const;
+    uint32_t CreateBlock(uint64_t inOffset, uint64_t inSize);
+    void ReleaseBlock(uint32_t inBlock);
+    void InsertFreeBlock(uint32_t inBlock);
+    void RemoveFreeBlock(uint32_t inBlock);
+    // Splits the tail behind inSize off into a new block and returns it, the caller inserts it into a free list
+    uint32_t SplitBlock(uint32_t inBlock, uint64_t inSize);
+
+    std::vector<Block> m_Blocks;
+    std::vector<uint32_t> m_UnusedBlocks;
+    std::unordered_map<uint64_t, uint32_t> m_UsedBlocks; // offset to block
+    uint32_t m_FreeLists[s_NumClasses][s_NumSubClasses] {};
+    uint64_t m_ClassBitmap = 0;
+    uint32_t m_SubClassBitmaps[s_NumClasses] {};
+    uint64_t m_TotalSize = 0;
+    uint64_t m_UsedSize = 0;
+};
\ No newline at end of file
@@ -5,9 +5,19 @@
 #include "Core/Log.h"
 #include "WinApp/ImguiTestApp.h"
 #include "WinApp/RDGTestApp.h"
+#include "WinApp/RDGBenchmark.h"
+#include "WinApp/FramePacingBenchmark.h"
+#include "WinApp/MemoryAllocatorBenchmark.h"
+#include "WinApp/AssetsManager.h"
+#include "Tests/Tests.h"
 
 void RunApp(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine, int nCmdShow)
 {
+    // -nopipelinecache measures a cold start, every pipeline is compiled by the driver
+    if(strstr(lpCmdLine, "-nopipelinecache") != nullptr)
+        RHI::SetPipelineCacheDirectory(nullptr);
+    else
+        RHI::SetPipelineCacheDirectory(AssetsManager::GetShaderPath().string().c_str());
     RHI::Init(true);
     RDG::Init();
     std::unique_ptr<RDGTestApp> app = std::make_unique<RDGTestApp>(380
@@ -18,6 +28,39 @@ void RunApp(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine, int n
     app->Run();
 }
 
+void RunRDGBenchmark()
+{
+    RHI::Init(ERHIBackend::Null);
+    RDG::Init();
+    RDGBenchmarkDesc desc;
+    desc.DumpDirectory = "RDGBenchmark";
+    RDGBenchmark::Run(desc);
+}
+
+void RunFramePacingBenchmark()
+{
+    RHI::Init(ERHIBackend::Null);
+    FramePacingBenchmarkDesc desc;
+    desc.NumFramesInFlight = 1;
+    FramePacingBenchmark::Run(desc);
+    desc.NumFramesInFlight = RHIFrameContext::s_DefaultNumFramesInFlight;
+    FramePacingBenchmark::Run(desc);
+}
+
+void RunMemoryAllocatorBenchmark()
+{
+    RHI::Init(ERHIBackend::Null);
+    MemoryAllocatorBenchmarkDesc desc;
+    MemoryAllocatorBenchmark::Run(desc);
+}
+
+bool RunTests()
+{
+    RHI::Init(ERHIBackend::Null);
+    RDG::Init();
+    return Tests::RunAll();
+}
+
 void PostCleanup()
 {
     RDG::Shutdown();
@@ -28,7 +71,20 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine
 {
     try
     {
-        RunApp(hInstance, hPrevInstance, lpCmdLine, nCmdShow);
+        if(strstr(lpCmdLine, "-rdgbenchmark") != nullptr)
+            RunRDGBenchmark();
+        else if(strstr(lpCmdLine, "-framebenchmark") != nullptr)
+            RunFramePacingBenchmark();
+        else if(strstr(lpCmdLine, "-allocbenchmark") != nullptr)
+            RunMemoryAllocatorBenchmark();
+        else if(strstr(lpCmdLine, "-tests") != nullptr)
+        {
+            const bool isPassed = RunTests();
+            PostCleanup();
+            return isPassed ? 0 : 1;
+        }
+        else
+            RunApp(hInstance, hPrevInstance, lpCmdLine, nCmdShow);
         PostCleanup();
         return 0;
     }
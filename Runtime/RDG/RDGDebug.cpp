@@ -0,0 +1,246 @@
+#include "RDGDebug.h"
+#include "RDGraph.h"
+#include "../Core/Log.h"
+#include <fstream>
+
+static std::string GetResourceStatesName(ERHIResourceStates inStates)
+{
+    static const std::pair<ERHIResourceStates, const char*> s_StateNames[] = {
+        {ERHIResourceStates::Present, "Present"},
+        {ERHIResourceStates::GpuReadOnly, "GpuReadOnly"},
+        {ERHIResourceStates::IndirectCommands, "IndirectCommands"},
+        {ERHIResourceStates::UnorderedAccess, "UnorderedAccess"},
+        {ERHIResourceStates::RenderTarget, "RenderTarget"},
+        {ERHIResourceStates::ShadingRateSource, "ShadingRateSource"},
+        {ERHIResourceStates::CopySrc, "CopySrc"},
+        {ERHIResourceStates::CopyDst, "CopyDst"},
+        {ERHIResourceStates::DepthStencilWrite, "DepthStencilWrite"},
+        {ERHIResourceStates::DepthStencilRead, "DepthStencilRead"},
+        {ERHIResourceStates::AccelerationStructure, "AccelerationStructure"},
+        {ERHIResourceStates::OcclusionPrediction, "OcclusionPrediction"},
+    };
+
+    std::string name;
+    for(const auto& state : s_StateNames)
+    {
+        if((inStates & state.first) != 0)
+        {
+            if(!name.empty())
+                name += "|";
+            name += state.second;
+        }
+    }
+    return name.empty() ? "None" : name;
+}
+
+static const char* GetLoadActionName(ERDGLoadAction inAction)
+{
+    switch (inAction)
+    {
+    case ERDGLoadAction::Clear: return "Clear";
+    case ERDGLoadAction::DontCare: return "DontCare";
+    case ERDGLoadAction::Load:
+    default: return "Load";
+    }
+}
+
+static const char* GetStoreActionName(ERDGStoreAction inAction)
+{
+    return inAction == ERDGStoreAction::DontCare ? "DontCare" : "Store";
+}
+
+static std::string EscapeString(const std::string& inString)
+{
+    std::string result;
+    result.reserve(inString.size());
+    for(char c : inString)
+    {
+        if(c == '"' || c == '\\')
+            result += '\\';
+        result += c;
+    }
+    return result;
+}
+
+struct RDGResourceLifetime
+{
+    RDGNodeHandle FirstPass = RDGInvalidHandle;
+    RDGNodeHandle LastPass = RDGInvalidHandle;
+};
+
+// First and last surviving pass using each resource, two transient resources with disjoint lifetimes could share memory
+static std::vector<RDGResourceLifetime> GetResourceLifetimes(const RDGraph& inGraph)
+{
+    std::vector<RDGResourceLifetime> lifetimes(inGraph.GetNumResources());
+    auto updateLifetimes = [&lifetimes](RDGNodeHandle inPass, const std::vector<RDGResourceAccess>& inAccesses)
+    {
+        for(const RDGResourceAccess& access : inAccesses)
+        {
+            RDGResourceLifetime& lifetime = lifetimes[access.Resource];
+            if(lifetime.FirstPass == RDGInvalidHandle)
+                lifetime.FirstPass = inPass;
+            lifetime.LastPass = inPass;
+        }
+    };
+    
+    for(RDGNodeHandle i = 0; i < inGraph.GetNumPasses(); ++i)
+    {
+        const RDGPass* pass = inGraph.GetPass(i);
+        if(pass->IsCulled())
+            continue;
+        updateLifetimes(i, pass->GetReadResources());
+        updateLifetimes(i, pass->GetWriteResources());
+    }
+    return lifetimes;
+}
+
+namespace RDG
+{
+    bool DumpGraphviz(const RDGraph& inGraph, const std::filesystem::path& inPath)
+    {
+        std::ofstream file(inPath);
+        if(!file.is_open())
+        {
+            Log::Error("[RDG] Failed to open %s", inPath.string().c_str());
+            return false;
+        }
+
+        file << "digraph RDG\n{\n";
+        file << "    rankdir=LR;\n";
+        file << "    node [fontname=\"Consolas\"];\n";
+
+        for(RDGNodeHandle i = 0; i < inGraph.GetNumPasses(); ++i)
+        {
+            const RDGPass* pass = inGraph.GetPass(i);
+            file << "    P" << i << " [shape=box, label=\"#" << i << " " << EscapeString(pass->GetName());
+            if(pass->IsRaster())
+            {
+                const RDGRenderPassInfo& info = pass->GetRenderPassInfo();
+                file << "\\n" << (info.BeginRenderPass ? "Begin" : "Merged") << (info.EndRenderPass ? " End" : "");
+            }
+            file << "\"";
+            if(pass->IsCulled())
+                file << ", style=dashed, color=gray";
+            else if(pass->IsRaster())
+                file << ", style=filled, fillcolor=lightsalmon";
+            file << "];\n";
+        }
+
+        std::vector<RDGResourceLifetime> lifetimes = GetResourceLifetimes(inGraph);
+        for(RDGNodeHandle i = 0; i < inGraph.GetNumResources(); ++i)
+        {
+            const RDGResource* res = inGraph.GetResource(i);
+            file << "    R" << i << " [shape=ellipse, label=\"" << EscapeString(res->GetName());
+            if(lifetimes[i].FirstPass != RDGInvalidHandle)
+                file << "\\n[" << lifetimes[i].FirstPass << ", " << lifetimes[i].LastPass << "]";
+            file << "\"" << (res->IsExternal() ? ", style=bold" : "") << "];\n";
+        }
+
+        for(RDGNodeHandle i = 0; i < inGraph.GetNumPasses(); ++i)
+        {
+            const RDGPass* pass = inGraph.GetPass(i);
+            for(const RDGResourceAccess& access : pass->GetReadResources())
+                file << "    R" << access.Resource << " -> P" << i << " [label=\"" << GetResourceStatesName(access.State) << "\"];\n";
+            for(const RDGResourceAccess& access : pass->GetWriteResources())
+                file << "    P" << i << " -> R" << access.Resource << " [color=red, label=\"" << GetResourceStatesName(access.State) << "\"];\n";
+        }
+
+        // Execution order
+        RDGNodeHandle prevPass = RDGInvalidHandle;
+        for(RDGNodeHandle i = 0; i < inGraph.GetNumPasses(); ++i)
+        {
+            if(inGraph.GetPass(i)->IsCulled())
+                continue;
+            if(prevPass != RDGInvalidHandle)
+                file << "    P" << prevPass << " -> P" << i << " [style=dotted, constraint=false];\n";
+            prevPass = i;
+        }
+
+        file << "}\n";
+        return true;
+    }
+    
+    bool DumpJson(const RDGraph& inGraph, const std::filesystem::path& inPath)
+    {
+        std::ofstream file(inPath);
+        if(!file.is_open())
+        {
+            Log::Error("[RDG] Failed to open %s", inPath.string().c_str());
+            return false;
+        }
+
+        file << "{\n  \"passes\": [\n";
+        for(RDGNodeHandle i = 0; i < inGraph.GetNumPasses(); ++i)
+        {
+            const RDGPass* pass = inGraph.GetPass(i);
+            file << "    {\"handle\": " << i
+                << ", \"name\": \"" << EscapeString(pass->GetName())
+                << "\", \"raster\": " << (pass->IsRaster() ? "true" : "false")
+                << ", \"culled\": " << (pass->IsCulled() ? "true" : "false");
+
+            if(pass->IsRaster())
+            {
+                const RDGRenderPassInfo& info = pass->GetRenderPassInfo();
+                const RDGRenderTargets& targets = pass->GetRenderTargets();
+                file << ", \"beginRenderPass\": " << (info.BeginRenderPass ? "true" : "false")
+                    << ", \"endRenderPass\": " << (info.EndRenderPass ? "true" : "false")
+                    << ", \"renderTargets\": [";
+                bool isFirst = true;
+                for(uint32_t rt = 0; rt < RHIRenderTargetsMaxCount; ++rt)
+                {
+                    if(!targets.Colors[rt].IsValid())
+                        continue;
+                    file << (isFirst ? "" : ", ") << "{\"resource\": " << targets.Colors[rt].Texture
+                        << ", \"load\": \"" << GetLoadActionName(info.ColorLoadActions[rt])
+                        << "\", \"store\": \"" << GetStoreActionName(info.ColorStoreActions[rt]) << "\"}";
+                    isFirst = false;
+                }
+                file << "]";
+                if(targets.DepthStencil.IsValid())
+                {
+                    file << ", \"depthStencil\": {\"resource\": " << targets.DepthStencil.Texture
+                        << ", \"load\": \"" << GetLoadActionName(info.DepthLoadAction)
+                        << "\", \"store\": \"" << GetStoreActionName(info.DepthStoreAction) << "\"}";
+                }
+            }
+
+            auto writeAccesses = [&file](const char* inKey, const std::vector<RDGResourceAccess>& inAccesses)
+            {
+                file << ", \"" << inKey << "\": [";
+                for(size_t a = 0; a < inAccesses.size(); ++a)
+                {
+                    file << (a == 0 ? "" : ", ") << "{\"resource\": " << inAccesses[a].Resource
+                        << ", \"state\": \"" << GetResourceStatesName(inAccesses[a].State) << "\"}";
+                }
+                file << "]";
+            };
+            writeAccesses("reads", pass->GetReadResources());
+            writeAccesses("writes", pass->GetWriteResources());
+
+            const std::vector<RDGBarrier>& barriers = pass->GetBarriers();
+            file << ", \"barriers\": [";
+            for(size_t b = 0; b < barriers.size(); ++b)
+            {
+                file << (b == 0 ? "" : ", ") << "{\"resource\": " << barriers[b].Resource
+                    << ", \"before\": \"" << GetResourceStatesName(barriers[b].Before)
+                    << "\", \"after\": \"" << GetResourceStatesName(barriers[b].After) << "\"}";
+            }
+            file << "]}" << (i + 1 < inGraph.GetNumPasses() ? "," : "") << "\n";
+        }
+        file << "  ],\n  \"resources\": [\n";
+
+        std::vector<RDGResourceLifetime> lifetimes = GetResourceLifetimes(inGraph);
+        for(RDGNodeHandle i = 0; i < inGraph.GetNumResources(); ++i)
+        {
+            const RDGResource* res = inGraph.GetResource(i);
+            file << "    {\"handle\": " << i
+                << ", \"name\": \"" << EscapeString(res->GetName())
+                << "\", \"external\": " << (res->IsExternal() ? "true" : "false");
+            if(lifetimes[i].FirstPass != RDGInvalidHandle)
+                file << ", \"firstPass\": " << lifetimes[i].FirstPass << ", \"lastPass\": " << lifetimes[i].LastPass;
+            file << "}" << (i + 1 < inGraph.GetNumResources() ? "," : "") << "\n";
+        }
+        file << "  ]\n}\n";
+        return true;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,12 @@
+#pragma once
+#include <filesystem>
+
+class RDGraph;
+
+namespace RDG
+{
+    // Dump the compiled graph: execution order, culled passes, barriers, merged render passes and resource lifetimes.
+    // Call after RDGraph::Compile
+    bool DumpGraphviz(const RDGraph& inGraph, const std::filesystem::path& inPath);
+    bool DumpJson(const RDGraph& inGraph, const std::filesystem::path& inPath);
+}
\ No newline at end of file
@@ -3,6 +3,7 @@
 
 class RDGraph;
 using RDGNodeHandle = size_t;
+constexpr RDGNodeHandle RDGInvalidHandle = static_cast<RDGNodeHandle>(-1);
 
 class RDGNode
 {
@@ -1,24 +1,103 @@
 #pragma once
 #include "RDGDefinitions.h"
+#include "../RHI/RHIConstants.h"
 #include <vector>
 
 class RDGraph;
+class RHICommandList;
+
+struct RDGResourceAccess
+{
+    RDGNodeHandle Resource;
+    ERHIResourceStates State;
+};
+
+struct RDGBarrier
+{
+    RDGNodeHandle Resource;
+    ERHIResourceStates Before;
+    ERHIResourceStates After;
+};
+
+enum class ERDGLoadAction : uint8_t
+{
+    Load = 0,
+    Clear,
+    DontCare
+};
+
+enum class ERDGStoreAction : uint8_t
+{
+    Store = 0,
+    DontCare
+};
+
+struct RDGRenderTargetBinding
+{
+    RDGNodeHandle Texture = RDGInvalidHandle;
+    ERDGLoadAction LoadAction = ERDGLoadAction::Load;
+
+    bool IsValid() const { return Texture != RDGInvalidHandle; }
+};
+
+struct RDGRenderTargets
+{
+    RDGRenderTargetBinding Colors[RHIRenderTargetsMaxCount];
+    RDGRenderTargetBinding DepthStencil;
+
+    bool HasSameTargets(const RDGRenderTargets& inOther) const
+    {
+        for(uint32_t i = 0; i < RHIRenderTargetsMaxCount; ++i)
+        {
+            if(Colors[i].Texture != inOther.Colors[i].Texture)
+                return false;
+        }
+        return DepthStencil.Texture == inOther.DepthStencil.Texture;
+    }
+};
+
+// Filled by RDGraph::Compile, consecutive raster passes writing the same targets share one render pass scope.
+// Only the first pass of a merged scope binds the frame buffer, the store actions apply when the scope ends.
+struct RDGRenderPassInfo
+{
+    bool BeginRenderPass = true;
+    bool EndRenderPass = true;
+    ERDGLoadAction ColorLoadActions[RHIRenderTargetsMaxCount] {};
+    ERDGStoreAction ColorStoreActions[RHIRenderTargetsMaxCount] {};
+    ERDGLoadAction DepthLoadAction = ERDGLoadAction::Load;
+    ERDGStoreAction DepthStoreAction = ERDGStoreAction::Store;
+};
 
 class RDGPass : public RDGNode
 {
 public:
     ~RDGPass() override = default;
-    virtual void Execute() {}
+    virtual void Execute(RHICommandList* inCmdList) {}
+
+    bool IsRaster() const { return m_IsRaster; }
+    bool IsCulled() const { return m_IsCulled; }
+    const std::vector<RDGBarrier>& GetBarriers() const { return m_Barriers; }
+    const RDGRenderTargets& GetRenderTargets() const { return m_RenderTargets; }
+    const RDGRenderPassInfo& GetRenderPassInfo() const { return m_RenderPassInfo; }
+    const std::vector<RDGResourceAccess>& GetReadResources() const { return m_ReadResources; }
+    const std::vector<RDGResourceAccess>& GetWriteResources() const { return m_WriteResources; }
 
 protected:
+    friend RDGraph;
     RDGPass(const std::string_view inName, RDGNodeHandle inHandle)
         : RDGNode(inName, inHandle)
     {
         
     }
     
-    std::vector<RDGNodeHandle> m_ReadResources;
-    std::vector<RDGNodeHandle> m_WriteResources;
+    std::vector<RDGResourceAccess> m_ReadResources;
+    std::vector<RDGResourceAccess> m_WriteResources;
+    bool m_IsRaster = false;
+    bool m_IsCulled = false;
+    // Barriers planned by RDGraph::Compile, issued before the pass executes
+    std::vector<RDGBarrier> m_Barriers;
+    RDGRenderTargets m_RenderTargets;
+    RDGRenderPassInfo m_RenderPassInfo;
 };
 
 template<typename ExecuteLambdaType>
@@ -27,7 +106,7 @@ class RDGEmptyLambdaPass : public RDGPass
 public:
     ~RDGEmptyLambdaPass() override = default;
 
-    void Execute() override
+    void Execute(RHICommandList* inCmdList) override
     {
         m_ExecuteLambda();
     }
@@ -44,6 +123,31 @@ private:
     ExecuteLambdaType m_ExecuteLambda;
 };
 
+// The lambda receives the command list and the render pass info, it should only bind the frame buffer
+// when BeginRenderPass is set and only clear the targets whose load action is Clear
+template<typename ExecuteLambdaType>
+class RDGRasterLambdaPass : public RDGPass
+{
+public:
+    ~RDGRasterLambdaPass() override = default;
+
+    void Execute(RHICommandList* inCmdList) override
+    {
+        m_ExecuteLambda(inCmdList, m_RenderPassInfo);
+    }
+    
+private:
+    friend RDGraph;
+    RDGRasterLambdaPass(const std::string_view inName, RDGNodeHandle inHandle, ExecuteLambdaType&& inExecuteLambda)
+        : RDGPass(inName, inHandle)
+        , m_ExecuteLambda(std::move(inExecuteLambda))
+    {
+        
+    }
+    
+    ExecuteLambdaType m_ExecuteLambda;
+};
+
 template<typename ParameterStructType, typename ExecuteLambdaType>
 class RDGLambdaPass : public RDGPass
 {
@@ -53,7 +157,7 @@ class RDGLambdaPass : public RDGPass
 public:
     ~RDGLambdaPass() override = default;
 
-    void Execute() override
+    void Execute(RHICommandList* inCmdList) override
     {
         m_ExecuteLambda();
     }
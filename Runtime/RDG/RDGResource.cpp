@@ -1,8 +1,8 @@
 #include "RDGResource.h"
 #include "RDGraph.h"
 
-RDGResource::RDGResource(std::string_view inName, RDGNodeHandle inHandle, bool isExternal)
-    : RDGNode(inName, inHandle), m_IsExternal(isExternal)
+RDGResource::RDGResource(std::string_view inName, RDGNodeHandle inHandle, bool isExternal, ERHIResourceStates inInitialState)
+    : RDGNode(inName, inHandle), m_IsExternal(isExternal), m_CurrentState(inInitialState)
 {
     
 }
@@ -13,36 +13,98 @@ RDGBuffer::RDGBuffer(std::string_view inName, RDGNodeHandle inHandle, const RHIB
     
 }
 
+RDGBuffer::RDGBuffer(std::string_view inName, RDGNodeHandle inHandle, RHIBufferRef inBuffer, ERHIResourceStates inInitialState)
+    : RDGResource(inName, inHandle, true, inInitialState), m_Desc(inBuffer->GetDesc()), m_Buffer(inBuffer)
+{
+    
+}
+
 RDGBuffer::~RDGBuffer()
 {
     m_Buffer.SafeRelease();
 }
 
-void RDGBuffer::InitRHI()
+void RDGBuffer::InitRHI(RDGResourcePool& inPool)
 {
+    if(m_IsExternal)
+        return;
+    
     if(m_Buffer.GetReference() == nullptr || !m_Buffer->IsValid())
     {
-        m_Buffer = RHI::GetDevice()->CreateBuffer(m_Desc);
+        m_Buffer = inPool.AcquireBuffer(m_Desc, m_CurrentState);
         m_Buffer->SetName(m_Name);
     }
 }
 
+void RDGBuffer::ReleaseRHI(RDGResourcePool& inPool)
+{
+    if(m_IsExternal)
+        return;
+
+    if(m_Buffer.GetReference() != nullptr)
+    {
+        inPool.Release(m_Buffer, m_CurrentState);
+        m_Buffer.SafeRelease();
+    }
+}
+
+void RDGBuffer::Transition(RHICommandList* inCmdList, ERHIResourceStates inAfterState)
+{
+    // Without a recorded barrier the resource stays in its state, the tracked state follows the gpu
+    if(inCmdList != nullptr && m_Buffer.GetReference() != nullptr)
+    {
+        inCmdList->ResourceBarrier(m_Buffer, inAfterState);
+        m_CurrentState = inAfterState;
+    }
+}
+
 RDGTexture::RDGTexture(std::string_view inName, RDGNodeHandle inHandle, const RHITextureDesc& inDesc)
     : RDGResource(inName, inHandle, false), m_Desc(inDesc)
 {
     
 }
 
+RDGTexture::RDGTexture(std::string_view inName, RDGNodeHandle inHandle, RHITextureRef inTexture, ERHIResourceStates inInitialState)
+    : RDGResource(inName, inHandle, true, inInitialState), m_Desc(inTexture->GetDesc()), m_Texture(inTexture)
+{
+    
+}
+
 RDGTexture::~RDGTexture()
 {
     m_Texture.SafeRelease();
 }
 
-void RDGTexture::InitRHI()
+void RDGTexture::InitRHI(RDGResourcePool& inPool)
 {
+    if(m_IsExternal)
+        return;
+    
     if(m_Texture.GetReference() == nullptr || !m_Texture->IsValid())
     {
-        m_Texture = RHI::GetDevice()->CreateTexture(m_Desc);
+        m_Texture = inPool.AcquireTexture(m_Desc, m_CurrentState);
         m_Texture->SetName(m_Name);
     }
+}
+
+void RDGTexture::ReleaseRHI(RDGResourcePool& inPool)
+{
+    if(m_IsExternal)
+        return;
+
+    if(m_Texture.GetReference() != nullptr)
+    {
+        inPool.Release(m_Texture, m_CurrentState);
+        m_Texture.SafeRelease();
+    }
+}
+
+void RDGTexture::Transition(RHICommandList* inCmdList, ERHIResourceStates inAfterState)
+{
+    // Without a recorded barrier the resource stays in its state, the tracked state follows the gpu
+    if(inCmdList != nullptr && m_Texture.GetReference() != nullptr)
+    {
+        inCmdList->ResourceBarrier(m_Texture, inAfterState);
+        m_CurrentState = inAfterState;
+    }
 }
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once
 #include "RDGDefinitions.h"
 #include "../RHI/RHI.h"
+#include "RDGResourcePool.h"
 
 class RDGraph;
 
@@ -8,13 +9,24 @@ class RDGResource : public RDGNode
 {
 public:
     virtual RHIObject* GetRHI() const = 0;
-    virtual void InitRHI() = 0;
+    // Transient resources are taken from the pool on first use and given back once the graph has executed
+    virtual void InitRHI(RDGResourcePool& inPool) = 0;
+    virtual void ReleaseRHI(RDGResourcePool& inPool) = 0;
+
+    bool IsExternal() const { return m_IsExternal; }
+    ERHIResourceStates GetCurrentState() const { return m_CurrentState; }
     
 protected:
     friend RDGraph;
-    RDGResource(std::string_view inName, RDGNodeHandle inHandle, bool isExternal);
+    RDGResource(std::string_view inName, RDGNodeHandle inHandle, bool isExternal, ERHIResourceStates inInitialState = ERHIResourceStates::None);
+
+    // Record a transition to inAfterState, the command list can be null when the graph is executed without recording.
+    // The tracked state only changes when a barrier was recorded
+    virtual void Transition(RHICommandList* inCmdList, ERHIResourceStates inAfterState) = 0;
     
     const bool m_IsExternal;
+    // Tracked across frames, external resources enter the graph with the state they were imported with
+    ERHIResourceStates m_CurrentState;
     std::vector<RDGNodeHandle> m_Producers;
     std::vector<RDGNodeHandle> m_Consumers;
 };
@@ -24,11 +36,14 @@ class RDGBuffer : public RDGResource
 public:
     ~RDGBuffer() override;
     RHIObject* GetRHI() const override { return m_Buffer.GetReference(); }
-    void InitRHI();
+    void InitRHI(RDGResourcePool& inPool) override;
+    void ReleaseRHI(RDGResourcePool& inPool) override;
     
 private:
     friend RDGraph;
     RDGBuffer(std::string_view inName, RDGNodeHandle inHandle, const RHIBufferDesc& inDesc);
+    RDGBuffer(std::string_view inName, RDGNodeHandle inHandle, RHIBufferRef inBuffer, ERHIResourceStates inInitialState);
+    void Transition(RHICommandList* inCmdList, ERHIResourceStates inAfterState) override;
     RHIBufferDesc m_Desc;
     RHIBufferRef m_Buffer;
 };
@@ -38,11 +53,14 @@ class RDGTexture : public RDGResource
 public:
     ~RDGTexture() override;
     RHIObject* GetRHI() const override { return m_Texture.GetReference(); }
-    void InitRHI();
+    void InitRHI(RDGResourcePool& inPool) override;
+    void ReleaseRHI(RDGResourcePool& inPool) override;
     
 private:
     friend RDGraph;
     RDGTexture(std::string_view inName, RDGNodeHandle inHandle, const RHITextureDesc& inDesc);
+    RDGTexture(std::string_view inName, RDGNodeHandle inHandle, RHITextureRef inTexture, ERHIResourceStates inInitialState);
+    void Transition(RHICommandList* inCmdList, ERHIResourceStates inAfterState) override;
     RHITextureDesc m_Desc;
     RHITextureRef m_Texture;
 };
\ No newline at end of file
@@ -0,0 +1,183 @@
+#include "RDGResourcePool.h"
+#include "../Core/Hash.h"
+#include <cstring>
+
+static bool IsSameDesc(const RHIBufferDesc& inA, const RHIBufferDesc& inB)
+{
+    return inA.Size == inB.Size && inA.Stride == inB.Stride && inA.Format == inB.Format
+        && inA.CpuAccess == inB.CpuAccess && inA.Usages == inB.Usages;
+}
+
+static bool IsSameClearValue(ERHIFormat inFormat, const RHIClearValue& inA, const RHIClearValue& inB)
+{
+    const RHIFormatInfo& formatInfo = RHI::GetFormatInfo(inFormat);
+    if(formatInfo.HasDepth || formatInfo.HasStencil)
+        return inA.DepthStencil.Depth == inB.DepthStencil.Depth && inA.DepthStencil.Stencil == inB.DepthStencil.Stencil;
+    return memcmp(inA.Color, inB.Color, sizeof(inA.Color)) == 0;
+}
+
+static bool IsSameDesc(const RHITextureDesc& inA, const RHITextureDesc& inB)
+{
+    return inA.Format == inB.Format && inA.Dimension == inB.Dimension
+        && inA.Width == inB.Width && inA.Height == inB.Height && inA.Depth == inB.Depth
+        && inA.ArraySize == inB.ArraySize && inA.MipLevels == inB.MipLevels && inA.SampleCount == inB.SampleCount
+        && inA.Usages == inB.Usages && IsSameClearValue(inA.Format, inA.ClearValue, inB.ClearValue);
+}
+
+RDGResourcePool::~RDGResourcePool()
+{
+    Clear();
+}
+
+size_t RDGResourcePool::GetHash(const RHIBufferDesc& inDesc)
+{
+    size_t hash = static_cast<size_t>(inDesc.Size);
+    hash = HashCombine(hash, static_cast<size_t>(inDesc.Stride));
+    hash = HashCombine(hash, static_cast<size_t>(inDesc.Format));
+    hash = HashCombine(hash, static_cast<size_t>(inDesc.CpuAccess));
+    hash = HashCombine(hash, static_cast<size_t>(inDesc.Usages));
+    return hash;
+}
+
+size_t RDGResourcePool::GetHash(const RHITextureDesc& inDesc)
+{
+    size_t hash = static_cast<size_t>(inDesc.Format);
+    hash = HashCombine(hash, static_cast<size_t>(inDesc.Dimension));
+    hash = HashCombine(hash, inDesc.Width);
+    hash = HashCombine(hash, inDesc.Height);
+    hash = HashCombine(hash, inDesc.Depth);
+    hash = HashCombine(hash, inDesc.ArraySize);
+    hash = HashCombine(hash, inDesc.MipLevels);
+    hash = HashCombine(hash, inDesc.SampleCount);
+    hash = HashCombine(hash, static_cast<size_t>(inDesc.Usages));
+    // The clear value only matters for render targets and depth stencils, but hashing it for all textures keeps the key simple
+    const RHIFormatInfo& formatInfo = RHI::GetFormatInfo(inDesc.Format);
+    if(formatInfo.HasDepth || formatInfo.HasStencil)
+        hash = HashCombine(hash, CityHash64(reinterpret_cast<const char*>(&inDesc.ClearValue.DepthStencil.Depth), sizeof(float)) + inDesc.ClearValue.DepthStencil.Stencil);
+    else
+        hash = HashCombine(hash, CityHash64(reinterpret_cast<const char*>(inDesc.ClearValue.Color), sizeof(inDesc.ClearValue.Color)));
+    return hash;
+}
+
+template<typename ResourceType, typename ResourceDescType>
+RefCountPtr<ResourceType> RDGResourcePool::Acquire(std::unordered_map<size_t, std::vector<PooledResource<ResourceType>>>& inPool
+    , const ResourceDescType& inDesc, ERHIResourceStates& outState)
+{
+    auto iter = inPool.find(GetHash(inDesc));
+    if(iter != inPool.end())
+    {
+        std::vector<PooledResource<ResourceType>>& entries = iter->second;
+        for(size_t i = 0; i < entries.size(); ++i)
+        {
+            if(IsSameDesc(entries[i].Resource->GetDesc(), inDesc))
+            {
+                RefCountPtr<ResourceType> resource = entries[i].Resource;
+                outState = entries[i].State;
+                entries[i] = entries.back();
+                entries.pop_back();
+                if(entries.empty())
+                    inPool.erase(iter);
+                m_Stats.Hits++;
+                return resource;
+            }
+        }
+    }
+
+    m_Stats.Misses++;
+    outState = ERHIResourceStates::None;
+    return nullptr;
+}
+
+RHIBufferRef RDGResourcePool::AcquireBuffer(const RHIBufferDesc& inDesc, ERHIResourceStates& outState)
+{
+    RHIBufferRef buffer = Acquire(m_FreeBuffers, inDesc, outState);
+    if(buffer.GetReference() != nullptr)
+    {
+        m_Stats.PooledBuffers--;
+        return buffer;
+    }
+    return RHI::GetDevice()->CreateBuffer(inDesc);
+}
+
+RHITextureRef RDGResourcePool::AcquireTexture(const RHITextureDesc& inDesc, ERHIResourceStates& outState)
+{
+    RHITextureRef texture = Acquire(m_FreeTextures, inDesc, outState);
+    if(texture.GetReference() != nullptr)
+    {
+        m_Stats.PooledTextures--;
+        return texture;
+    }
+    return RHI::GetDevice()->CreateTexture(inDesc);
+}
+
+void RDGResourcePool::Release(const RHIBufferRef& inBuffer, ERHIResourceStates inState)
+{
+    if(inBuffer.GetReference() == nullptr || !inBuffer->IsValid())
+        return;
+    
+    m_FreeBuffers[GetHash(inBuffer->GetDesc())].push_back({inBuffer, inState, m_FrameIndex});
+    m_Stats.PooledBuffers++;
+}
+
+void RDGResourcePool::Release(const RHITextureRef& inTexture, ERHIResourceStates inState)
+{
+    if(inTexture.GetReference() == nullptr || !inTexture->IsValid())
+        return;
+    
+    m_FreeTextures[GetHash(inTexture->GetDesc())].push_back({inTexture, inState, m_FrameIndex});
+    m_Stats.PooledTextures++;
+}
+
+template<typename ResourceType>
+uint32_t RDGResourcePool::Evict(std::unordered_map<size_t, std::vector<PooledResource<ResourceType>>>& inPool)
+{
+    uint32_t numEvicted = 0;
+    for(auto iter = inPool.begin(); iter != inPool.end();)
+    {
+        std::vector<PooledResource<ResourceType>>& entries = iter->second;
+        for(size_t i = 0; i < entries.size();)
+        {
+            if(m_FrameIndex - entries[i].LastUsedFrame > m_MaxUnusedFrames)
+            {
+                entries[i] = entries.back();
+                entries.pop_back();
+                numEvicted++;
+            }
+            else
+            {
+                ++i;
+            }
+        }
+        
+        if(entries.empty())
+            iter = inPool.erase(iter);
+        else
+            ++iter;
+    }
+    return numEvicted;
+}
+
+void RDGResourcePool::Tick()
+{
+    m_FrameIndex++;
+    uint32_t numEvictedBuffers = Evict(m_FreeBuffers);
+    uint32_t numEvictedTextures = Evict(m_FreeTextures);
+    m_Stats.PooledBuffers -= numEvictedBuffers;
+    m_Stats.PooledTextures -= numEvictedTextures;
+    m_Stats.Evictions += numEvictedBuffers + numEvictedTextures;
+}
+
+void RDGResourcePool::Clear()
+{
+    m_FreeBuffers.clear();
+    m_FreeTextures.clear();
+    m_Stats.PooledBuffers = 0;
+    m_Stats.PooledTextures = 0;
+}
+
+void RDGResourcePool::ResetStats()
+{
+    m_Stats.Hits = 0;
+    m_Stats.Misses = 0;
+    m_Stats.Evictions = 0;
+}
\ No newline at end of file
@@ -0,0 +1,64 @@
+#pragma once
+#include "../RHI/RHI.h"
+#include <unordered_map>
+
+struct RDGResourcePoolStats
+{
+    uint64_t Hits = 0;
+    uint64_t Misses = 0;
+    uint64_t Evictions = 0;
+    uint32_t PooledBuffers = 0;
+    uint32_t PooledTextures = 0;
+};
+
+// Keeps transient resources alive across frames, resources are keyed by a hash of their desc
+// and evicted once they have not been used for a number of frames
+class RDGResourcePool
+{
+public:
+    static constexpr uint32_t s_DefaultMaxUnusedFrames = 3;
+    
+    ~RDGResourcePool();
+    
+    RHIBufferRef AcquireBuffer(const RHIBufferDesc& inDesc, ERHIResourceStates& outState);
+    RHITextureRef AcquireTexture(const RHITextureDesc& inDesc, ERHIResourceStates& outState);
+    void Release(const RHIBufferRef& inBuffer, ERHIResourceStates inState);
+    void Release(const RHITextureRef& inTexture, ERHIResourceStates inState);
+
+    // Advance the frame and evict the resources unused for more than m_MaxUnusedFrames
+    void Tick();
+    void Clear();
+
+    void SetMaxUnusedFrames(uint32_t inFrames) { m_MaxUnusedFrames = inFrames; }
+    uint32_t GetMaxUnusedFrames() const { return m_MaxUnusedFrames; }
+    const RDGResourcePoolStats& GetStats() const { return m_Stats; }
+    void ResetStats();
+    
+    static size_t GetHash(const RHIBufferDesc& inDesc);
+    static size_t GetHash(const RHITextureDesc& inDesc);
+    
+private:
+    template<typename ResourceType>
+    struct PooledResource
+    {
+        RefCountPtr<ResourceType> Resource;
+        ERHIResourceStates State;
+        uint64_t LastUsedFrame;
+    };
+
+    using PooledBuffer = PooledResource<RHIBuffer>;
+    using PooledTexture = PooledResource<RHITexture>;
+
+    template<typename ResourceType, typename ResourceDescType>
+    RefCountPtr<ResourceType> Acquire(std::unordered_map<size_t, std::vector<PooledResource<ResourceType>>>& inPool
+        , const ResourceDescType& inDesc, ERHIResourceStates& outState);
+
+    template<typename ResourceType>
+    uint32_t Evict(std::unordered_map<size_t, std::vector<PooledResource<ResourceType>>>& inPool);
+    
+    std::unordered_map<size_t, std::vector<PooledBuffer>> m_FreeBuffers;
+    std::unordered_map<size_t, std::vector<PooledTexture>> m_FreeTextures;
+    uint64_t m_FrameIndex = 0;
+    uint32_t m_MaxUnusedFrames = s_DefaultMaxUnusedFrames;
+    RDGResourcePoolStats m_Stats;
+};
\ No newline at end of file
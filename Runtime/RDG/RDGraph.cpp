@@ -1,4 +1,5 @@
 #include "RDGraph.h"
+#include "../Core/Log.h"
 
 RDGraph::~RDGraph()
 {
@@ -11,34 +12,333 @@ bool RDGraph::Init()
 }
 
 void RDGraph::Shutdown()
+{
+    Reset();
+    m_ResourcePool.Clear();
+}
+
+void RDGraph::Reset()
 {
     for(auto pass : m_MangedPasses)
         delete pass;
 
+    // A graph compiled but never executed still holds its transient resources
     for(auto res : m_ManagedResources)
+    {
+        res->ReleaseRHI(m_ResourcePool);
         delete res;
+    }
 
     m_MangedPasses.clear();
     m_ManagedResources.clear();
+    m_IsCompiled = false;
+}
+
+RDGNodeHandle RDGraph::AddResource(std::string_view inName, RHIBufferRef inBuffer, ERHIResourceStates inInitialState)
+{
+    if(inBuffer.GetReference() == nullptr || !inBuffer->IsValid())
+    {
+        Log::Error("[RDG] Failed to import buffer %s, the buffer is invalid", inName.data());
+        return RDGInvalidHandle;
+    }
+    
+    RDGNodeHandle handle = m_ManagedResources.size();
+    RDGResource* res = new RDGBuffer(inName, handle, inBuffer, inInitialState);
+    m_ManagedResources.push_back(res);
+    m_IsCompiled = false;
+    return handle;
+}
+
+RDGNodeHandle RDGraph::AddResource(std::string_view inName, RHITextureRef inTexture, ERHIResourceStates inInitialState)
+{
+    if(inTexture.GetReference() == nullptr || !inTexture->IsValid())
+    {
+        Log::Error("[RDG] Failed to import texture %s, the texture is invalid", inName.data());
+        return RDGInvalidHandle;
+    }
+    
+    RDGNodeHandle handle = m_ManagedResources.size();
+    RDGResource* res = new RDGTexture(inName, handle, inTexture, inInitialState);
+    m_ManagedResources.push_back(res);
+    m_IsCompiled = false;
+    return handle;
+}
+
+void RDGraph::ReadResource(RDGNodeHandle inPass, RDGNodeHandle inResource, ERHIResourceStates inState)
+{
+    if(inPass >= m_MangedPasses.size() || inResource >= m_ManagedResources.size())
+    {
+        Log::Error("[RDG] Invalid pass or resource handle");
+        return;
+    }
+    m_MangedPasses[inPass]->m_ReadResources.push_back({inResource, inState});
+    m_IsCompiled = false;
+}
+
+void RDGraph::WriteResource(RDGNodeHandle inPass, RDGNodeHandle inResource, ERHIResourceStates inState)
+{
+    if(inPass >= m_MangedPasses.size() || inResource >= m_ManagedResources.size())
+    {
+        Log::Error("[RDG] Invalid pass or resource handle");
+        return;
+    }
+    m_MangedPasses[inPass]->m_WriteResources.push_back({inResource, inState});
+    m_IsCompiled = false;
+}
+
+ERHIResourceStates RDGraph::GetResourceState(RDGNodeHandle inResource) const
+{
+    if(inResource >= m_ManagedResources.size())
+        return ERHIResourceStates::None;
+    return m_ManagedResources[inResource]->GetCurrentState();
 }
 
-RDGNodeHandle RDGraph::AddResource(std::string_view inName, RHIBufferRef inBuffer)
+void RDGraph::SetResourceState(RDGNodeHandle inResource, ERHIResourceStates inState)
 {
-    return 0;
+    if(inResource < m_ManagedResources.size())
+    {
+        m_ManagedResources[inResource]->m_CurrentState = inState;
+        m_IsCompiled = false;
+    }
 }
 
-RDGNodeHandle RDGraph::AddResource(std::string_view inName, RHITextureRef inTexture)
+void RDGraph::SetRenderTargets(RDGNodeHandle inPass, const RDGRenderTargets& inRenderTargets)
 {
-    return 0;
+    RDGPass* pass = m_MangedPasses[inPass];
+    pass->m_IsRaster = true;
+    pass->m_RenderTargets = inRenderTargets;
+    
+    for(uint32_t i = 0; i < RHIRenderTargetsMaxCount; ++i)
+    {
+        if(inRenderTargets.Colors[i].IsValid())
+            WriteResource(inPass, inRenderTargets.Colors[i].Texture, ERHIResourceStates::RenderTarget);
+    }
+    
+    if(inRenderTargets.DepthStencil.IsValid())
+        WriteResource(inPass, inRenderTargets.DepthStencil.Texture, ERHIResourceStates::DepthStencilWrite);
 }
 
 void RDGraph::Compile()
 {
+    for(auto res : m_ManagedResources)
+    {
+        res->m_Producers.clear();
+        res->m_Consumers.clear();
+    }
+    
+    for(auto pass : m_MangedPasses)
+    {
+        for(const RDGResourceAccess& access : pass->m_ReadResources)
+            m_ManagedResources[access.Resource]->m_Consumers.push_back(pass->GetHandle());
+        
+        for(const RDGResourceAccess& access : pass->m_WriteResources)
+            m_ManagedResources[access.Resource]->m_Producers.push_back(pass->GetHandle());
+    }
+
+    CullPasses();
+    AcquireResources();
+    PlanBarriers();
+    MergeRenderPasses();
+    m_IsCompiled = true;
+}
+
+void RDGraph::CullPasses()
+{
+    // Walk the passes backwards, a pass survives when it writes something that is used later or leaves the graph.
+    // Passes without declared writes may have side effects the graph can not see, so they are always kept
+    std::vector<bool> isNeeded(m_ManagedResources.size(), false);
+    for(size_t i = 0; i < m_ManagedResources.size(); ++i)
+        isNeeded[i] = m_ManagedResources[i]->IsExternal();
+    
+    for(auto iter = m_MangedPasses.rbegin(); iter != m_MangedPasses.rend(); ++iter)
+    {
+        RDGPass* pass = *iter;
+        bool isCulled = !pass->m_WriteResources.empty();
+        for(const RDGResourceAccess& access : pass->m_WriteResources)
+        {
+            if(isNeeded[access.Resource])
+            {
+                isCulled = false;
+                break;
+            }
+        }
+
+        pass->m_IsCulled = isCulled;
+        if(isCulled)
+            continue;
+
+        // Writes may be partial, so earlier producers of the same resource are kept as well
+        for(const RDGResourceAccess& access : pass->m_ReadResources)
+            isNeeded[access.Resource] = true;
+        for(const RDGResourceAccess& access : pass->m_WriteResources)
+            isNeeded[access.Resource] = true;
+    }
+}
+
+void RDGraph::AcquireResources()
+{
+    // Pooled resources come back in the state they were released in, so they are acquired before the barriers are planned
+    for(auto pass : m_MangedPasses)
+    {
+        if(pass->m_IsCulled)
+            continue;
+
+        for(const RDGResourceAccess& access : pass->m_ReadResources)
+            m_ManagedResources[access.Resource]->InitRHI(m_ResourcePool);
+        for(const RDGResourceAccess& access : pass->m_WriteResources)
+            m_ManagedResources[access.Resource]->InitRHI(m_ResourcePool);
+    }
+}
+
+void RDGraph::PlanBarriers()
+{
+    // Track the states through the passes in execution order, Execute issues exactly these barriers
+    std::vector<ERHIResourceStates> states(m_ManagedResources.size());
+    for(size_t i = 0; i < m_ManagedResources.size(); ++i)
+        states[i] = m_ManagedResources[i]->m_CurrentState;
+
+    auto planBarriers = [&states](RDGPass* inPass, const std::vector<RDGResourceAccess>& inAccesses)
+    {
+        for(const RDGResourceAccess& access : inAccesses)
+        {
+            if(states[access.Resource] != access.State)
+            {
+                inPass->m_Barriers.push_back({access.Resource, states[access.Resource], access.State});
+                states[access.Resource] = access.State;
+            }
+        }
+    };
     
+    for(auto pass : m_MangedPasses)
+    {
+        pass->m_Barriers.clear();
+        if(pass->m_IsCulled)
+            continue;
+        
+        planBarriers(pass, pass->m_ReadResources);
+        planBarriers(pass, pass->m_WriteResources);
+    }
+}
+
+bool RDGraph::CanMergeRenderPass(const RDGPass* inPrevPass, const RDGPass* inPass) const
+{
+    if(!inPrevPass->m_IsRaster || !inPass->m_IsRaster || !inPrevPass->m_RenderTargets.HasSameTargets(inPass->m_RenderTargets))
+        return false;
+
+    // A clear or discard in the middle of the scope needs its own render pass
+    const RDGRenderTargets& targets = inPass->m_RenderTargets;
+    for(uint32_t i = 0; i < RHIRenderTargetsMaxCount; ++i)
+    {
+        if(targets.Colors[i].IsValid() && targets.Colors[i].LoadAction != ERDGLoadAction::Load)
+            return false;
+    }
+    if(targets.DepthStencil.IsValid() && targets.DepthStencil.LoadAction != ERDGLoadAction::Load)
+        return false;
+
+    // Any barrier between the two passes is a dependency the render pass can not span,
+    // this also covers the pass sampling one of the shared targets
+    return inPass->m_Barriers.empty();
+}
+
+void RDGraph::MergeRenderPasses()
+{
+    std::vector<size_t> lastPassIndices(m_ManagedResources.size(), 0);
+    for(size_t i = 0; i < m_MangedPasses.size(); ++i)
+    {
+        if(m_MangedPasses[i]->m_IsCulled)
+            continue;
+        
+        for(const RDGResourceAccess& access : m_MangedPasses[i]->m_ReadResources)
+            lastPassIndices[access.Resource] = i;
+        for(const RDGResourceAccess& access : m_MangedPasses[i]->m_WriteResources)
+            lastPassIndices[access.Resource] = i;
+    }
+
+    RDGPass* prevPass = nullptr;
+    for(auto pass : m_MangedPasses)
+    {
+        RDGRenderPassInfo& info = pass->m_RenderPassInfo;
+        info = RDGRenderPassInfo();
+        if(pass->m_IsCulled)
+            continue;
+        
+        if(pass->m_IsRaster)
+        {
+            for(uint32_t rt = 0; rt < RHIRenderTargetsMaxCount; ++rt)
+                info.ColorLoadActions[rt] = pass->m_RenderTargets.Colors[rt].LoadAction;
+            info.DepthLoadAction = pass->m_RenderTargets.DepthStencil.LoadAction;
+
+            if(prevPass && CanMergeRenderPass(prevPass, pass))
+            {
+                prevPass->m_RenderPassInfo.EndRenderPass = false;
+                info.BeginRenderPass = false;
+            }
+        }
+        prevPass = pass;
+    }
+
+    // The contents only need to leave tile memory when something reads them after the render pass scope ends
+    for(size_t i = 0; i < m_MangedPasses.size(); ++i)
+    {
+        RDGPass* pass = m_MangedPasses[i];
+        if(pass->m_IsCulled || !pass->m_IsRaster || !pass->m_RenderPassInfo.EndRenderPass)
+            continue;
+
+        auto getStoreAction = [this, &lastPassIndices, i](const RDGRenderTargetBinding& inBinding)
+        {
+            const RDGResource* res = m_ManagedResources[inBinding.Texture];
+            return res->IsExternal() || lastPassIndices[inBinding.Texture] > i ? ERDGStoreAction::Store : ERDGStoreAction::DontCare;
+        };
+
+        RDGRenderPassInfo& info = pass->m_RenderPassInfo;
+        for(uint32_t rt = 0; rt < RHIRenderTargetsMaxCount; ++rt)
+        {
+            if(pass->m_RenderTargets.Colors[rt].IsValid())
+                info.ColorStoreActions[rt] = getStoreAction(pass->m_RenderTargets.Colors[rt]);
+        }
+        if(pass->m_RenderTargets.DepthStencil.IsValid())
+            info.DepthStoreAction = getStoreAction(pass->m_RenderTargets.DepthStencil);
+    }
 }
 
-void RDGraph::Execute()
+void RDGraph::Execute(RHICommandList* inCmdList)
 {
+    if(!m_IsCompiled)
+    {
+        Compile();
+    }
+    
     for(auto pass : m_MangedPasses)
-        pass->Execute();
+    {
+        if(pass->m_IsCulled)
+            continue;
+
+        // The merge decisions of Compile rely on these barriers, they are not worked out again
+        for(const RDGBarrier& barrier : pass->m_Barriers)
+            m_ManagedResources[barrier.Resource]->Transition(inCmdList, barrier.After);
+        pass->Execute(inCmdList);
+    }
+
+    for(auto res : m_ManagedResources)
+        res->ReleaseRHI(m_ResourcePool);
+    m_ResourcePool.Tick();
+    // The tracked states moved on, the next execution plans its barriers again
+    m_IsCompiled = false;
+}
+
+void RDGraph::ExecuteAndSubmit(const RefCountPtr<RHIFence>& inSignalFence)
+{
+    RHIDevice* device = RHI::GetDevice();
+    RHICommandListPool& commandListPool = device->GetCommandListPool();
+    RefCountPtr<RHICommandList> commandList = commandListPool.Acquire();
+    if(!commandList.IsValid())
+    {
+        Log::Error("[RDG] Failed to acquire a command list to execute the graph");
+        return;
+    }
+    
+    Execute(commandList.GetReference());
+    commandList->End();
+    device->ExecuteCommandList(commandList, inSignalFence);
+    commandListPool.Release(commandList);
 }
\ No newline at end of file
@@ -3,6 +3,7 @@
 #include "RDGDefinitions.h"
 #include "RDGResource.h"
 #include "RDGPass.h"
+#include "RDGResourcePool.h"
 
 class RDGraph
 {
@@ -10,24 +11,48 @@ public:
     ~RDGraph();
     bool Init();
     void Shutdown();
+    // Remove all passes and resources, the pooled resources are kept for the next graph
+    void Reset();
     
     template<typename ExecuteLambdaType>
     RDGNodeHandle AddPass(std::string_view inName, ExecuteLambdaType&& inExecuteLambda);
 
     template<typename ParameterStructType, typename ExecuteLambdaType>
     RDGNodeHandle AddPass(std::string_view inName, const ParameterStructType* inParameterStruct, ExecuteLambdaType&& inExecuteLambda);
+
+    // The lambda signature is void(RHICommandList*, const RDGRenderPassInfo&)
+    template<typename ExecuteLambdaType>
+    RDGNodeHandle AddRasterPass(std::string_view inName, const RDGRenderTargets& inRenderTargets, ExecuteLambdaType&& inExecuteLambda);
     
     template<typename ResourceDescType>
     RDGNodeHandle AddResource(std::string_view inName, const ResourceDescType& inDesc);
     
-    RDGNodeHandle AddResource(std::string_view inName, RHIBufferRef inBuffer);
-    RDGNodeHandle AddResource(std::string_view inName, RHITextureRef inTexture);
+    // Import an external resource, inInitialState is the state the resource is in when the graph starts
+    RDGNodeHandle AddResource(std::string_view inName, RHIBufferRef inBuffer, ERHIResourceStates inInitialState = ERHIResourceStates::None);
+    RDGNodeHandle AddResource(std::string_view inName, RHITextureRef inTexture, ERHIResourceStates inInitialState = ERHIResourceStates::None);
+
+    void ReadResource(RDGNodeHandle inPass, RDGNodeHandle inResource, ERHIResourceStates inState);
+    void WriteResource(RDGNodeHandle inPass, RDGNodeHandle inResource, ERHIResourceStates inState);
+
+    // The state the resource was left in by the last execution, external resources carry it over to the next frame
+    ERHIResourceStates GetResourceState(RDGNodeHandle inResource) const;
+    // Override the tracked state when an external resource was transitioned outside the graph, e.g. after presenting
+    void SetResourceState(RDGNodeHandle inResource, ERHIResourceStates inState);
     
+    // Culls the passes, acquires the transient resources and plans the barriers and render pass scopes
     void Compile();
-    void Execute();
+    // Issues the barriers planned by Compile, the graph is compiled first when it changed since the last Compile
+    void Execute(RHICommandList* inCmdList = nullptr);
+    // Executes the graph on a direct command list of the command list pool of the device and submits it, the list goes
+    // back to the pool. inSignalFence is signaled once the gpu finished the graph
+    void ExecuteAndSubmit(const RefCountPtr<RHIFence>& inSignalFence = nullptr);
+
+    RDGResourcePool& GetResourcePool() { return m_ResourcePool; }
 
     const RDGPass* GetPass(RDGNodeHandle inHandle) const { return m_MangedPasses[inHandle]; }
     const RDGResource* GetResource(RDGNodeHandle inHandle) const { return m_ManagedResources[inHandle]; }
+    size_t GetNumPasses() const { return m_MangedPasses.size(); }
+    size_t GetNumResources() const { return m_ManagedResources.size(); }
 
     RDGraph(const RDGraph&) = delete;
     RDGraph& operator=(const RDGraph&) = delete;
@@ -52,8 +77,17 @@ public:
 private:
     friend bool RDG::Init();
     RDGraph() = default;
+    void SetRenderTargets(RDGNodeHandle inPass, const RDGRenderTargets& inRenderTargets);
+    void CullPasses();
+    void AcquireResources();
+    void PlanBarriers();
+    void MergeRenderPasses();
+    bool CanMergeRenderPass(const RDGPass* inPrevPass, const RDGPass* inPass) const;
+    
     std::vector<RDGPass*>        m_MangedPasses;
     std::vector<RDGResource*>    m_ManagedResources;
+    RDGResourcePool              m_ResourcePool;
+    bool                         m_IsCompiled = false;
 };
 
 template<typename ExecuteLambdaType>
@@ -62,6 +96,18 @@ RDGNodeHandle RDGraph::AddPass(const std::string_view inName, ExecuteLambdaType&
     RDGNodeHandle handle = m_MangedPasses.size();
     RDGPass* pass = new RDGEmptyLambdaPass<ExecuteLambdaType>(inName, handle, std::forward<ExecuteLambdaType>(inExecuteLambda));
     m_MangedPasses.push_back(pass);
+    m_IsCompiled = false;
+    return handle;
+}
+
+template<typename ExecuteLambdaType>
+RDGNodeHandle RDGraph::AddRasterPass(std::string_view inName, const RDGRenderTargets& inRenderTargets, ExecuteLambdaType&& inExecuteLambda)
+{
+    RDGNodeHandle handle = m_MangedPasses.size();
+    RDGPass* pass = new RDGRasterLambdaPass<ExecuteLambdaType>(inName, handle, std::forward<ExecuteLambdaType>(inExecuteLambda));
+    m_MangedPasses.push_back(pass);
+    m_IsCompiled = false;
+    SetRenderTargets(handle, inRenderTargets);
     return handle;
 }
 
@@ -80,5 +126,6 @@ RDGNodeHandle RDGraph::AddResource(std::string_view inName, const ResourceDescTy
     RDGNodeHandle handle = m_ManagedResources.size();
     RDGResource* res = new RDGResourceType(inName, handle, inDesc);
     m_ManagedResources.push_back(res);
+    m_IsCompiled = false;
     return handle;
 }
\ No newline at end of file
@@ -12,6 +12,11 @@ RefCountPtr<RHIBuffer> D3D12Device::CreateBuffer(const RHIBufferDesc& inDesc, bo
     {
         Log::Error("[D3D12] Failed to create buffer");
     }
+    else if(!isVirtual && inDesc.CpuAccess == ERHICpuAccessMode::None)
+    {
+        // Committed buffers in device local memory are evicted by the residency manager, placed ones with their heap
+        m_ResidencyManager.Track(buffer);
+    }
     return buffer;
 }
 
@@ -125,6 +130,7 @@ bool D3D12Buffer::Init()
             OUTPUT_D3D12_FAILED_RESULT(hr)
             return false;
         }
+        m_SubresourceStates.Init(1, m_InitialStates);
     }
 
     m_AllocationInfo = m_Device.GetDevice()->GetResourceAllocationInfo(D3D12Device::GetNodeMask(), 1, &m_BufferDescD3D);
@@ -139,6 +145,9 @@ void D3D12Buffer::Shutdown()
 
 void D3D12Buffer::ShutdownInternal()
 {
+    // Tracked objects are made resident again before they are released
+    m_Device.GetResidencyManager().Untrack(this);
+
     for(auto cbv : m_ConstantBufferViews)
     {
         m_Device.GetDescriptorManager().Free(cbv.second.DescriptorHeap, cbv.second.Slot, 1);
@@ -163,6 +172,7 @@ void D3D12Buffer::ShutdownInternal()
     }
 
     m_BufferHandle.Reset();
+    m_SubresourceStates.Clear();
 }
 
 bool D3D12Buffer::IsValid() const
@@ -285,7 +295,7 @@ bool D3D12Buffer::BindMemory(RefCountPtr<RHIResourceHeap> inHeap)
         m_InitialStates = D3D12_RESOURCE_STATE_COPY_DEST;
     }
     
-    if(!inHeap->TryAllocate(GetAllocSizeInByte(), m_OffsetInHeap))
+    if(!inHeap->TryAllocate(GetAllocSizeInByte(), GetAllocAlignment(), m_OffsetInHeap))
     {
         Log::Error("[D3D12] Failed to bind buffer memory, the heap size is not enough");
         return false;
@@ -306,6 +316,7 @@ bool D3D12Buffer::BindMemory(RefCountPtr<RHIResourceHeap> inHeap)
         return false;
     }
 
+    m_SubresourceStates.Init(1, m_InitialStates);
     m_ResourceHeap = inHeap;
     return true;
 }
@@ -535,32 +546,13 @@ bool D3D12Buffer::TryGetUAVHandle(D3D12_CPU_DESCRIPTOR_HANDLE& outHandle, const
 
 D3D12_RESOURCE_STATES D3D12Buffer::GetCurrentState(const RHIBufferSubRange& inSubResource)
 {
-    auto currentStateIter = m_SubResourceStates.find(inSubResource);
-    if(currentStateIter == m_SubResourceStates.end())
-    {
-        auto allSubResourceState = m_SubResourceStates.find(RHIBufferSubRange::All);
-        if(allSubResourceState == m_SubResourceStates.end())
-        {
-            m_SubResourceStates.emplace(inSubResource, m_InitialStates);
-            if(inSubResource != RHIBufferSubRange::All)
-                m_SubResourceStates.emplace(inSubResource, m_InitialStates);
-            return m_InitialStates;
-        }
-        m_SubResourceStates.emplace(inSubResource, allSubResourceState->second);
-        return allSubResourceState->second;
-    }
-    return currentStateIter->second;
+    return m_SubresourceStates.IsInitialized() ? m_SubresourceStates.Get(0) : m_InitialStates;
 }
 
 void D3D12Buffer::ChangeState(D3D12_RESOURCE_STATES inAfterState, const RHIBufferSubRange& inSubResource)
 {
-    auto currentStateIter = m_SubResourceStates.find(inSubResource);
-    if(currentStateIter == m_SubResourceStates.end())
-    {
-        m_SubResourceStates.emplace(inSubResource, inAfterState);
-    }
-    else
+    if(m_SubresourceStates.IsInitialized())
     {
-        currentStateIter->second = inAfterState;
+        m_SubresourceStates.Set(0, inAfterState);
     }
 }
\ No newline at end of file
@@ -41,7 +41,6 @@ bool D3D12CommandList::Init()
     }
 
     m_CachedBarriers.clear();
-    m_StagingBuffers.clear();
 
     const D3D12_COMMAND_LIST_TYPE d3dQueueType = RHI::D3D12::ConvertCommandQueueType(m_QueueType);
 
@@ -79,6 +78,9 @@ void D3D12CommandList::Begin()
     {
         m_CmdAllocatorHandle->Reset();
         m_CmdListHandle->Reset(m_CmdAllocatorHandle.Get(), nullptr);
+        m_StateTracker.Reset();
+        ReleaseRingBlocks();
+        m_ResidencyUsage.Clear();
         m_IsClosed = false;
     }
 }
@@ -110,8 +112,7 @@ void D3D12CommandList::SetPipelineState(const RefCountPtr<RHIComputePipeline>& i
     {
         const D3D12ComputePipeline* pipeline = CheckCast<D3D12ComputePipeline*>(inPipelineState.GetReference());
         const D3D12PipelineBindingLayout* layout = CheckCast<D3D12PipelineBindingLayout*>(pipeline->GetDesc().BindingLayout);
-        SetPipelineState(pipeline ? pipeline->GetPipelineState() : nullptr
-                , layout ? layout->GetRootSignature() : nullptr);
+        SetPipelineState(pipeline ? pipeline->GetPipelineState() : nullptr, layout);
     }
 }
 
@@ -127,25 +128,42 @@ void D3D12CommandList::SetPipelineState(const RefCountPtr<RHIGraphicsPipeline>&
             if(!pipelineDesc.UsingMeshShader)
                 m_CmdListHandle->IASetPrimitiveTopology(RHI::D3D12::ConvertPrimitiveType(pipelineDesc.PrimitiveType));
         }
-        SetPipelineState(pipeline ? pipeline->GetPipelineState() : nullptr
-                , layout ? layout->GetRootSignature() : nullptr);
+        SetPipelineState(pipeline ? pipeline->GetPipelineState() : nullptr, layout);
     }
 }
 
-void D3D12CommandList::SetPipelineState(ID3D12PipelineState* inPipelineState, ID3D12RootSignature* inRootSignature)
+void D3D12CommandList::SetPipelineState(ID3D12PipelineState* inPipelineState, const D3D12PipelineBindingLayout* inLayout)
 {
+    ID3D12RootSignature* rootSignature = inLayout ? inLayout->GetRootSignature() : nullptr;
     if(inPipelineState)
     {
         m_CmdListHandle->SetPipelineState(inPipelineState);
     }
-    if(inRootSignature)
+    if(rootSignature)
     {
-        m_CmdListHandle->SetGraphicsRootSignature(inRootSignature);
+        m_CmdListHandle->SetGraphicsRootSignature(rootSignature);
     }
 
-    m_Context.CurrentSignature = inRootSignature;
+    m_Context.CurrentSignature = rootSignature;
     m_Context.CurrentPipelineState = inPipelineState;
+    m_Context.CurrentLayout = inLayout;
     m_Device.GetDescriptorManager().BindShaderVisibleHeaps(m_CmdListHandle.Get());
+
+    // The tables point into the heaps bound above, so they are set once per pipeline instead of once per draw
+    D3D12_GPU_DESCRIPTOR_HANDLE bindlessResources, bindlessSamplers;
+    if(inLayout && inLayout->GetBindlessResourcesParameter() >= 0 && m_Device.GetBindlessTableHandles(bindlessResources, bindlessSamplers))
+    {
+        if(GetQueueType() == ERHICommandQueueType::Async)
+        {
+            m_CmdListHandle->SetComputeRootDescriptorTable(inLayout->GetBindlessResourcesParameter(), bindlessResources);
+            m_CmdListHandle->SetComputeRootDescriptorTable(inLayout->GetBindlessSamplersParameter(), bindlessSamplers);
+        }
+        else
+        {
+            m_CmdListHandle->SetGraphicsRootDescriptorTable(inLayout->GetBindlessResourcesParameter(), bindlessResources);
+            m_CmdListHandle->SetGraphicsRootDescriptorTable(inLayout->GetBindlessSamplersParameter(), bindlessSamplers);
+        }
+    }
 }
 
 void D3D12CommandList::SetFrameBuffer(const RefCountPtr<RHIFrameBuffer>& inFrameBuffer)
@@ -189,6 +207,7 @@ void D3D12CommandList::SetFrameBuffer(const RefCountPtr<RHIFrameBuffer>& inFrame
         const D3D12FrameBuffer* frameBuffer = CheckCast<D3D12FrameBuffer*>(inFrameBuffer.GetReference());
         if(frameBuffer && frameBuffer->IsValid() && inNumRenderTargets == frameBuffer->GetNumRenderTargets())
         {
+            m_ResidencyUsage.Add(frameBuffer);
             m_CmdListHandle->OMSetRenderTargets(frameBuffer->GetNumRenderTargets()
                 , frameBuffer->GetRenderTargetViews()
                 , false
@@ -253,8 +272,10 @@ void D3D12CommandList::CopyBuffer(RefCountPtr<RHIBuffer>& dstBuffer, size_t dstO
         ID3D12Resource* dstRes = buffer0->GetBuffer();
         ID3D12Resource* srcRes = buffer1->GetBuffer();
         m_CmdListHandle->CopyBufferRegion(dstRes, dstOffset, srcRes, srcOffset, size);
-        buffer0->ChangeState(D3D12_RESOURCE_STATE_COPY_DEST);
-        buffer1->ChangeState(D3D12_RESOURCE_STATE_COPY_SOURCE);
+        m_ResidencyUsage.Add(buffer0);
+        m_ResidencyUsage.Add(buffer1);
+        m_StateTracker.Promote(buffer0, D3D12_RESOURCE_STATE_COPY_DEST);
+        m_StateTracker.Promote(buffer1, D3D12_RESOURCE_STATE_COPY_SOURCE);
     }
 }
 
@@ -269,8 +290,10 @@ void D3D12CommandList::CopyTexture(RefCountPtr<RHITexture>& dstTexture, RefCount
         ID3D12Resource* dstRes = t0->GetTexture();
         ID3D12Resource* srcRes = t1->GetTexture();
         m_CmdListHandle->CopyResource(dstRes, srcRes);
-        t0->ChangeState(D3D12_RESOURCE_STATE_COPY_DEST);
-        t1->ChangeState(D3D12_RESOURCE_STATE_COPY_SOURCE);
+        m_ResidencyUsage.Add(t0);
+        m_ResidencyUsage.Add(t1);
+        m_StateTracker.Promote(t0, RHITextureSubResource::All, D3D12_RESOURCE_STATE_COPY_DEST);
+        m_StateTracker.Promote(t1, RHITextureSubResource::All, D3D12_RESOURCE_STATE_COPY_SOURCE);
     }
 }
 
@@ -310,9 +333,11 @@ void D3D12CommandList::CopyTexture(RefCountPtr<RHITexture>& dstTexture, const RH
         srcBox.back = srcSlice.Z + srcSlice.Depth;
         
         m_CmdListHandle->CopyTextureRegion(&dstLocation, dstSlice.X, dstSlice.Y, dstSlice.Z, &srcLocation, &srcBox);
+        m_ResidencyUsage.Add(t0);
+        m_ResidencyUsage.Add(t1);
 
-        t0->ChangeState(D3D12_RESOURCE_STATE_COPY_DEST);
-        t1->ChangeState(D3D12_RESOURCE_STATE_COPY_SOURCE);
+        m_StateTracker.Promote(t0, {dstSlice.MipLevel, 1, dstSlice.ArraySlice, 1}, D3D12_RESOURCE_STATE_COPY_DEST);
+        m_StateTracker.Promote(t1, {srcSlice.MipLevel, 1, srcSlice.ArraySlice, 1}, D3D12_RESOURCE_STATE_COPY_SOURCE);
     }
 }
 
@@ -351,12 +376,18 @@ void D3D12CommandList::CopyBufferToTexture(RefCountPtr<RHITexture>& dstTexture,
         srcLocation.PlacedFootprint.Footprint.Width = dstSlice.Width;
         srcLocation.PlacedFootprint.Footprint.Height = dstSlice.Height;
         srcLocation.PlacedFootprint.Footprint.Depth = dstSlice.Depth;
-        srcLocation.PlacedFootprint.Footprint.RowPitch = (uint32_t)dstSlice.Width * RHI::GetFormatInfo(dstTexture->GetDesc().Format).BytesPerBlock;
+        // Buffer rows are placed at the pitch alignment D3D12 requires
+        const RHIFormatInfo& formatInfo = RHI::GetFormatInfo(dstTexture->GetDesc().Format);
+        const uint32_t blockSize = std::max<uint32_t>(1, formatInfo.BlockSize);
+        const uint32_t rowSize = (dstSlice.Width + blockSize - 1) / blockSize * formatInfo.BytesPerBlock;
+        srcLocation.PlacedFootprint.Footprint.RowPitch = Align<uint32_t>(rowSize, D3D12_TEXTURE_DATA_PITCH_ALIGNMENT);
         
         m_CmdListHandle->CopyTextureRegion(&dstLocation, dstSlice.X, dstSlice.Y, dstSlice.Z, &srcLocation, nullptr);
+        m_ResidencyUsage.Add(t0);
+        m_ResidencyUsage.Add(t1);
 
-        t0->ChangeState(D3D12_RESOURCE_STATE_COPY_DEST);
-        t1->ChangeState(D3D12_RESOURCE_STATE_COPY_SOURCE);
+        m_StateTracker.Promote(t0, {dstSlice.MipLevel, 1, dstSlice.ArraySlice, 1}, D3D12_RESOURCE_STATE_COPY_DEST);
+        m_StateTracker.Promote(t1, D3D12_RESOURCE_STATE_COPY_SOURCE);
     }
 }
 
@@ -370,6 +401,7 @@ void D3D12CommandList::SetVertexBuffer(const RefCountPtr<RHIBuffer>& inBuffer, s
         vbv.StrideInBytes = (uint32_t)bufferDesc.Stride;
         vbv.SizeInBytes = (uint32_t)bufferDesc.Size;
         m_CmdListHandle->IASetVertexBuffers(0, 1, &vbv);
+        m_ResidencyUsage.Add(inBuffer.GetReference());
     }
 }
 
@@ -383,6 +415,7 @@ void D3D12CommandList::SetIndexBuffer(const RefCountPtr<RHIBuffer>& inBuffer, si
         ibv.BufferLocation = inBuffer->GetGpuAddress() + inOffset;
         ibv.Format = RHI::D3D12::ConvertFormat(bufferDesc.Format);
         m_CmdListHandle->IASetIndexBuffer(&ibv);
+        m_ResidencyUsage.Add(inBuffer.GetReference());
     }
 }
 void D3D12CommandList::Draw(uint32_t vertexCount, uint32_t instanceCount, uint32_t vertexOffset, uint32_t firstInstance)
@@ -404,6 +437,7 @@ void D3D12CommandList::DrawIndirect(RefCountPtr<RHIBuffer>& indirectCommands, ui
         if(buffer && buffer->IsValid() && signature)
         {
             m_CmdListHandle->ExecuteIndirect(signature, drawCount, buffer->GetBuffer(), commandsBufferOffset, nullptr, 0);
+            m_ResidencyUsage.Add(buffer);
         }
     }
 }
@@ -427,6 +461,24 @@ void D3D12CommandList::DrawIndexedIndirect(RefCountPtr<RHIBuffer>& indirectComma
         if(buffer && buffer->IsValid() && signature)
         {
             m_CmdListHandle->ExecuteIndirect(signature, drawCount, buffer->GetBuffer(), commandsBufferOffset, nullptr, 0);
+            m_ResidencyUsage.Add(buffer);
+        }
+    }
+}
+
+void D3D12CommandList::DrawIndexedIndirectCount(RefCountPtr<RHIBuffer>& indirectCommands, RefCountPtr<RHIBuffer>& countBuffer, uint32_t maxDrawCount, size_t commandsBufferOffset, size_t countBufferOffset)
+{
+    if(IsValid() && !IsClosed())
+    {
+        FlushBarriers();
+        D3D12Buffer* buffer = CheckCast<D3D12Buffer*>(indirectCommands.GetReference());
+        D3D12Buffer* counts = CheckCast<D3D12Buffer*>(countBuffer.GetReference());
+        ID3D12CommandSignature* signature = GetDrawIndexedCommandSignature();
+        if(buffer && buffer->IsValid() && counts && counts->IsValid() && signature)
+        {
+            m_CmdListHandle->ExecuteIndirect(signature, maxDrawCount, buffer->GetBuffer(), commandsBufferOffset, counts->GetBuffer(), countBufferOffset);
+            m_ResidencyUsage.Add(buffer);
+            m_ResidencyUsage.Add(counts);
         }
     }
 }
@@ -450,6 +502,7 @@ void D3D12CommandList::DispatchIndirect(RefCountPtr<RHIBuffer>& indirectCommands
         if(buffer && buffer->IsValid() && signature)
         {
             m_CmdListHandle->ExecuteIndirect(signature, count, buffer->GetBuffer(), commandsBufferOffset, nullptr, 0);
+            m_ResidencyUsage.Add(buffer);
         }
     }
 }
@@ -473,6 +526,24 @@ void D3D12CommandList::DispatchMeshIndirect(RefCountPtr<RHIBuffer>& indirectComm
         if(buffer && buffer->IsValid() && signature)
         {
             m_CmdListHandle->ExecuteIndirect(signature, count, buffer->GetBuffer(), commandsBufferOffset, nullptr, 0);
+            m_ResidencyUsage.Add(buffer);
+        }
+    }
+}
+
+void D3D12CommandList::DispatchMeshIndirectCount(RefCountPtr<RHIBuffer>& indirectCommands, RefCountPtr<RHIBuffer>& countBuffer, uint32_t maxCount, size_t commandsBufferOffset, size_t countBufferOffset)
+{
+    if(IsValid() && !IsClosed())
+    {
+        FlushBarriers();
+        D3D12Buffer* buffer = CheckCast<D3D12Buffer*>(indirectCommands.GetReference());
+        D3D12Buffer* counts = CheckCast<D3D12Buffer*>(countBuffer.GetReference());
+        ID3D12CommandSignature* signature = GetDispatchMeshCommandSignature();
+        if(buffer && buffer->IsValid() && counts && counts->IsValid() && signature)
+        {
+            m_CmdListHandle->ExecuteIndirect(signature, maxCount, buffer->GetBuffer(), commandsBufferOffset, counts->GetBuffer(), countBufferOffset);
+            m_ResidencyUsage.Add(buffer);
+            m_ResidencyUsage.Add(counts);
         }
     }
 }
@@ -502,16 +573,19 @@ void D3D12CommandList::DispatchRays(uint32_t width, uint32_t height, uint32_t de
 }
 
 void D3D12CommandList::ResourceBarrier(RefCountPtr<RHITexture>& inResource , ERHIResourceStates inAfterState)
+{
+    ResourceBarrier(inResource, RHITextureSubResource::All, inAfterState);
+}
+
+void D3D12CommandList::ResourceBarrier(RefCountPtr<RHITexture>& inResource, const RHITextureSubResource& inSubResource, ERHIResourceStates inAfterState)
 {
     if(IsValid() && !IsClosed())
     {
         D3D12Texture* texture = CheckCast<D3D12Texture*>(inResource.GetReference());
         if(texture && texture->IsValid())
         {
-            D3D12_RESOURCE_STATES beforeState = texture->GetCurrentState();
-            D3D12_RESOURCE_STATES afterState = RHI::D3D12::ConvertResourceStates(inAfterState);
-            m_CachedBarriers.push_back(CD3DX12_RESOURCE_BARRIER::Transition(texture->GetTexture(), beforeState, afterState));
-            texture->ChangeState(afterState);
+            m_StateTracker.Transition(texture, inSubResource, RHI::D3D12::ConvertResourceStates(inAfterState), m_CachedBarriers);
+            m_ResidencyUsage.Add(texture);
         }
     }
 }
@@ -523,10 +597,8 @@ void D3D12CommandList::ResourceBarrier(RefCountPtr<RHIBuffer>& inResource, ERHIR
         D3D12Buffer* buffer = CheckCast<D3D12Buffer*>(inResource.GetReference());
         if(buffer && buffer->IsValid())
         {
-            D3D12_RESOURCE_STATES beforeState = buffer->GetCurrentState();
-            D3D12_RESOURCE_STATES afterState  = RHI::D3D12::ConvertResourceStates(inAfterState);
-            m_CachedBarriers.push_back(CD3DX12_RESOURCE_BARRIER::Transition(buffer->GetBuffer(), beforeState, afterState));
-            buffer->ChangeState(afterState);
+            m_StateTracker.Transition(buffer, RHI::D3D12::ConvertResourceStates(inAfterState), m_CachedBarriers);
+            m_ResidencyUsage.Add(buffer);
         }
     }
 }
@@ -538,18 +610,161 @@ void D3D12CommandList::SetResourceSet(RefCountPtr<RHIResourceSet>& inResourceSet
         D3D12ResourceSet* resourceSet = CheckCast<D3D12ResourceSet*>(inResourceSet.GetReference());
         if(resourceSet && inResourceSet->IsValid())
         {
+            resourceSet->FlushDescriptorWrites();
+            m_ResidencyUsage.Add(resourceSet->GetResidencyUsage());
+            const D3D12_GPU_DESCRIPTOR_HANDLE* tableHandles = nullptr;
+            if(resourceSet->IsDynamic())
+            {
+                if(!CommitDynamicResourceSet(resourceSet))
+                {
+                    Log::Error("[D3D12] Failed to copy the tables of the dynamic resource set into the descriptor ring");
+                    return;
+                }
+                tableHandles = m_DynamicTableHandles.data();
+            }
+            
             if(GetQueueType() == ERHICommandQueueType::Async)
             {
-                resourceSet->SetComputeRootArguments(m_CmdListHandle.Get());
+                resourceSet->SetComputeRootArguments(m_CmdListHandle.Get(), tableHandles);
             }
             else
             {
-                resourceSet->SetGraphicsRootArguments(m_CmdListHandle.Get());
+                resourceSet->SetGraphicsRootArguments(m_CmdListHandle.Get(), tableHandles);
             }
         }
     }
 }
 
+// Copies the staged tables of the set into the ring blocks, one copy call per heap type
+bool D3D12CommandList::CommitDynamicResourceSet(const D3D12ResourceSet* inResourceSet)
+{
+    const std::vector<D3D12ResourceArgument>& arguments = inResourceSet->GetRootArguments();
+    const std::vector<ShaderVisibleDescriptorRange>& ranges = inResourceSet->GetDescriptorRanges();
+    m_DynamicTableHandles.assign(arguments.size(), D3D12_GPU_DESCRIPTOR_HANDLE{});
+    for(DescriptorCopyBatch& batch : m_DynamicCopyBatches)
+    {
+        batch.DestStarts.clear();
+        batch.SrcStarts.clear();
+        batch.Sizes.clear();
+    }
+    
+    for(uint32_t i = 0; i < arguments.size(); ++i)
+    {
+        const D3D12ResourceArgument& argument = arguments[i];
+        if(argument.ParameterType != D3D12_ROOT_PARAMETER_TYPE_DESCRIPTOR_TABLE || argument.NumDescriptors == 0)
+        {
+            continue;
+        }
+
+        const ShaderVisibleDescriptorRange& range = ranges[argument.ShaderVisibleDescriptorRangeIndex];
+        uint32_t slot;
+        const D3D12DescriptorHeap* heap = AllocateRingDescriptors(range.Heap->HeapType, range.NumDescriptors, slot);
+        if(heap == nullptr)
+        {
+            return false;
+        }
+        
+        DescriptorCopyBatch& batch = m_DynamicCopyBatches[heap->HeapType == D3D12_DESCRIPTOR_HEAP_TYPE_SAMPLER ? 1 : 0];
+        batch.DestStarts.push_back(heap->GetCpuSlotHandle(slot));
+        batch.SrcStarts.push_back(range.Heap->GetCpuSlotHandle(range.Slot));
+        batch.Sizes.push_back(range.NumDescriptors);
+        m_DynamicTableHandles[i] = heap->GetGpuSlotHandle(slot);
+    }
+
+    for(uint32_t i = 0; i < m_DynamicCopyBatches.size(); ++i)
+    {
+        const DescriptorCopyBatch& batch = m_DynamicCopyBatches[i];
+        if(!batch.Sizes.empty())
+        {
+            const UINT numRanges = static_cast<UINT>(batch.Sizes.size());
+            m_Device.GetDevice()->CopyDescriptors(numRanges, batch.DestStarts.data(), batch.Sizes.data()
+                , numRanges, batch.SrcStarts.data(), batch.Sizes.data()
+                , i == 0 ? D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV : D3D12_DESCRIPTOR_HEAP_TYPE_SAMPLER);
+        }
+    }
+    return true;
+}
+
+const D3D12DescriptorHeap* D3D12CommandList::AllocateRingDescriptors(D3D12_DESCRIPTOR_HEAP_TYPE inType, uint32_t inNumDescriptors, uint32_t& outSlot)
+{
+    D3D12DescriptorRingBlock& block = inType == D3D12_DESCRIPTOR_HEAP_TYPE_SAMPLER ? m_SamplerRingBlock : m_ResourceRingBlock;
+    if(block.Heap == nullptr || block.NumUsed + inNumDescriptors > block.NumDescriptors)
+    {
+        if(block.Heap != nullptr)
+        {
+            m_RingBlocks.push_back(block);
+            block = D3D12DescriptorRingBlock();
+        }
+        if(!m_Device.GetDescriptorManager().AcquireRingBlock(inType, block))
+        {
+            return nullptr;
+        }
+        if(inNumDescriptors > block.NumDescriptors)
+        {
+            Log::Error("[D3D12] %u descriptors of a dynamic table exceed the %u of a ring block", inNumDescriptors, block.NumDescriptors);
+            return nullptr;
+        }
+    }
+
+    outSlot = block.Slot + block.NumUsed;
+    block.NumUsed += inNumDescriptors;
+    return block.Heap;
+}
+
+void D3D12CommandList::TakeRingBlocks(std::vector<D3D12DescriptorRingBlock>& outBlocks)
+{
+    for(D3D12DescriptorRingBlock* block : {&m_ResourceRingBlock, &m_SamplerRingBlock})
+    {
+        if(block->Heap != nullptr)
+        {
+            m_RingBlocks.push_back(*block);
+            *block = D3D12DescriptorRingBlock();
+        }
+    }
+    outBlocks.insert(outBlocks.end(), m_RingBlocks.begin(), m_RingBlocks.end());
+    m_RingBlocks.clear();
+}
+
+// The blocks of a command list which was not executed never reached a queue
+void D3D12CommandList::ReleaseRingBlocks()
+{
+    std::vector<D3D12DescriptorRingBlock> blocks;
+    TakeRingBlocks(blocks);
+    if(!blocks.empty())
+    {
+        m_Device.GetDescriptorManager().ReleaseRingBlocks(blocks);
+    }
+}
+
+void D3D12CommandList::SetPushConstants(const void* inData, uint32_t inSize)
+{
+    if(IsValid() && !IsClosed())
+    {
+        const D3D12PipelineBindingLayout* layout = m_Context.CurrentLayout;
+        if(layout == nullptr || layout->GetPushConstantsParameter() < 0)
+        {
+            Log::Error("[D3D12] The layout of the bound pipeline has no push constants");
+            return;
+        }
+        
+        const uint32_t numValues = inSize / sizeof(uint32_t);
+        if(numValues > layout->GetNumPushConstants())
+        {
+            Log::Error("[D3D12] %u push constants exceed the %u of the layout", numValues, layout->GetNumPushConstants());
+            return;
+        }
+        
+        if(GetQueueType() == ERHICommandQueueType::Async)
+        {
+            m_CmdListHandle->SetComputeRoot32BitConstants(layout->GetPushConstantsParameter(), numValues, inData, 0);
+        }
+        else
+        {
+            m_CmdListHandle->SetGraphicsRoot32BitConstants(layout->GetPushConstantsParameter(), numValues, inData, 0);
+        }
+    }
+}
+
 void D3D12CommandList::FlushBarriers()
 {
     if(IsValid() && !m_CachedBarriers.empty())
@@ -561,6 +776,8 @@ void D3D12CommandList::FlushBarriers()
 
 void D3D12CommandList::ShutdownInternal()
 {
+    m_StateTracker.Reset();
+    ReleaseRingBlocks();
     m_CmdAllocatorHandle.Reset();
     m_CmdListHandle.Reset();
 }
@@ -2,16 +2,24 @@
 
 #include "../RHICommandList.h"
 #include "D3D12Definitions.h"
+#include "D3D12StateTracker.h"
+#include "D3D12DescriptorManager.h"
+#include "../RHIResidencyManager.h"
+
+class D3D12PipelineBindingLayout;
+class D3D12ResourceSet;
 
 struct D3D12CommandListContext
 {
     ID3D12RootSignature* CurrentSignature = nullptr;
     ID3D12PipelineState* CurrentPipelineState = nullptr;
+    const D3D12PipelineBindingLayout* CurrentLayout = nullptr;
 
     void Clear()
     {
         CurrentSignature = nullptr;
         CurrentPipelineState = nullptr;
+        CurrentLayout = nullptr;
     }
 };
 
@@ -41,8 +49,10 @@ public:
     void SetIndexBuffer(const RefCountPtr<RHIBuffer>& inBuffer, size_t inOffset = 0) override;
     
     void ResourceBarrier(RefCountPtr<RHITexture>& inResource , ERHIResourceStates inAfterState) override;
+    void ResourceBarrier(RefCountPtr<RHITexture>& inResource, const RHITextureSubResource& inSubResource, ERHIResourceStates inAfterState) override;
     void ResourceBarrier(RefCountPtr<RHIBuffer>& inResource, ERHIResourceStates inAfterState) override;
     void SetResourceSet(RefCountPtr<RHIResourceSet>& inResourceSet) override;
+    void SetPushConstants(const void* inData, uint32_t inSize) override;
     
     void CopyBuffer(RefCountPtr<RHIBuffer>& dstBuffer, size_t dstOffset, RefCountPtr<RHIBuffer>& srcBuffer, size_t srcOffset, size_t size) override;
     void CopyTexture(RefCountPtr<RHITexture>& dstTexture, RefCountPtr<RHITexture>& srcTexture) override;
@@ -54,15 +64,22 @@ public:
     void DrawIndirect(RefCountPtr<RHIBuffer>& indirectCommands, uint32_t drawCount, size_t commandsBufferOffset = 0) override;
     void DrawIndexed(uint32_t indexCount, uint32_t instanceCount, uint32_t firstIndex = 0, uint32_t vertexOffset = 0, uint32_t firstInstance = 0) override;
     void DrawIndexedIndirect(RefCountPtr<RHIBuffer>& indirectCommands, uint32_t drawCount, size_t commandsBufferOffset = 0) override;
+    void DrawIndexedIndirectCount(RefCountPtr<RHIBuffer>& indirectCommands, RefCountPtr<RHIBuffer>& countBuffer, uint32_t maxDrawCount, size_t commandsBufferOffset = 0, size_t countBufferOffset = 0) override;
     void Dispatch(uint32_t threadGroupX, uint32_t threadGroupY, uint32_t threadGroupZ) override;
     void DispatchIndirect(RefCountPtr<RHIBuffer>& indirectCommands, uint32_t count, size_t commandsBufferOffset = 0) override;
     void DispatchMesh(uint32_t threadGroupX, uint32_t threadGroupY, uint32_t threadGroupZ) override;
     void DispatchMeshIndirect(RefCountPtr<RHIBuffer>& indirectCommands, uint32_t count, size_t commandsBufferOffset = 0) override;
+    void DispatchMeshIndirectCount(RefCountPtr<RHIBuffer>& indirectCommands, RefCountPtr<RHIBuffer>& countBuffer, uint32_t maxCount, size_t commandsBufferOffset = 0, size_t countBufferOffset = 0) override;
     void DispatchRays(uint32_t width, uint32_t height, uint32_t depth, const RHIShaderTable& shaderTable) override;
     
     bool IsClosed() const override { return m_IsClosed; }
     ERHICommandQueueType GetQueueType() const override { return m_QueueType; }
     ID3D12GraphicsCommandList6* GetCommandList() const { return m_CmdListHandle.Get(); }
+    D3D12StateTracker& GetStateTracker() { return m_StateTracker; }
+    // Appends the descriptor ring blocks taken since Begin to outBlocks, the device submits them with the command list
+    void TakeRingBlocks(std::vector<D3D12DescriptorRingBlock>& outBlocks);
+    // The heaps and committed resources recorded since Begin, the device makes them resident at submit
+    const RHIResidencyUsage& GetResidencyUsage() const { return m_ResidencyUsage; }
     
     
 protected:
@@ -74,7 +91,10 @@ private:
     void ShutdownInternal();
     void FlushBarriers();
 
-    void SetPipelineState(ID3D12PipelineState* inPipelineState, ID3D12RootSignature* inRootSignature);
+    void SetPipelineState(ID3D12PipelineState* inPipelineState, const D3D12PipelineBindingLayout* inLayout);
+    bool CommitDynamicResourceSet(const D3D12ResourceSet* inResourceSet);
+    const D3D12DescriptorHeap* AllocateRingDescriptors(D3D12_DESCRIPTOR_HEAP_TYPE inType, uint32_t inNumDescriptors, uint32_t& outSlot);
+    void ReleaseRingBlocks();
     ID3D12CommandSignature* GetDrawCommandSignature();
     ID3D12CommandSignature* GetDrawIndexedCommandSignature();
     ID3D12CommandSignature* GetDispatchCommandSignature();
@@ -89,10 +109,24 @@ private:
     Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList6> m_CmdListHandle;
     bool m_IsClosed;
     std::vector<CD3DX12_RESOURCE_BARRIER> m_CachedBarriers;
-    std::vector<RefCountPtr<RHIBuffer>> m_StagingBuffers;
+    D3D12StateTracker m_StateTracker;
+    RHIResidencyUsage m_ResidencyUsage;
 
     Microsoft::WRL::ComPtr<ID3D12CommandSignature> m_DrawCommandSignature;
     Microsoft::WRL::ComPtr<ID3D12CommandSignature> m_DrawIndexedCommandSignature;
     Microsoft::WRL::ComPtr<ID3D12CommandSignature> m_DispatchCommandSignature;
     Microsoft::WRL::ComPtr<ID3D12CommandSignature> m_DispatchMeshCommandSignature;
+
+    // The tables of the dynamic resource sets are copied into ring blocks of the shader visible heaps
+    struct DescriptorCopyBatch
+    {
+        std::vector<D3D12_CPU_DESCRIPTOR_HANDLE> DestStarts;
+        std::vector<D3D12_CPU_DESCRIPTOR_HANDLE> SrcStarts;
+        std::vector<UINT> Sizes;
+    };
+    D3D12DescriptorRingBlock m_ResourceRingBlock;
+    D3D12DescriptorRingBlock m_SamplerRingBlock;
+    std::vector<D3D12DescriptorRingBlock> m_RingBlocks; // the full blocks taken since Begin
+    std::vector<D3D12_GPU_DESCRIPTOR_HANDLE> m_DynamicTableHandles;
+    std::array<DescriptorCopyBatch, 2> m_DynamicCopyBatches; // CBV_SRV_UAV and samplers
 };
\ No newline at end of file
@@ -22,12 +22,15 @@ void D3D12Shader::SetByteCode(std::shared_ptr<Blob> inByteCode)
 
 RefCountPtr<RHIComputePipeline> D3D12Device::CreatePipeline(const RHIComputePipelineDesc& inDesc)
 {
-    RefCountPtr<RHIComputePipeline> pipeline(new D3D12ComputePipeline(*this, inDesc));
-    if(!pipeline->Init())
+    return m_PipelineCache.FindOrCreate(inDesc, [this](const RHIComputePipelineDesc& inCreateDesc)
     {
-        Log::Error("[D3D12] Failed to create compute pipeline");
-    }
-    return pipeline;
+        RefCountPtr<RHIComputePipeline> pipeline(new D3D12ComputePipeline(*this, inCreateDesc));
+        if(!pipeline->Init())
+        {
+            Log::Error("[D3D12] Failed to create compute pipeline");
+        }
+        return pipeline;
+    });
 }
 
 D3D12ComputePipeline::D3D12ComputePipeline(D3D12Device& inDevice, const RHIComputePipelineDesc& inDesc)
@@ -68,7 +71,7 @@ bool D3D12ComputePipeline::Init()
     pipelineDesc.CS.BytecodeLength = m_Desc.ComputeShader->GetSize();
     pipelineDesc.NodeMask = D3D12Device::GetNodeMask();
 
-    HRESULT hr = m_Device.GetDevice()->CreateComputePipelineState(&pipelineDesc, IID_PPV_ARGS(&m_PipelineState));
+    HRESULT hr = m_Device.CreateComputePipelineState(pipelineDesc, RHIPipelineCache::GetPersistentName(m_Desc), m_PipelineState);
     if(FAILED(hr))
     {
         OUTPUT_D3D12_FAILED_RESULT(hr)
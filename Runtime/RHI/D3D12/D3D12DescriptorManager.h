@@ -1,8 +1,21 @@
 #pragma once
 #include "D3D12Definitions.h"
 #include "../../Core/FreeListAllocator.h"
+#include <deque>
+#include <mutex>
 
 class D3D12Device;
+class D3D12DescriptorHeap;
+
+// A block of the ring region of a shader visible heap, a command list sub-allocates the tables of its dynamic
+// resource sets from it, see D3D12DescriptorManager::AcquireRingBlock
+struct D3D12DescriptorRingBlock
+{
+    const D3D12DescriptorHeap* Heap = nullptr;
+    uint32_t Slot = 0;
+    uint32_t NumDescriptors = 0;
+    uint32_t NumUsed = 0;
+};
 
 class D3D12DescriptorHeap
 {
@@ -20,10 +33,11 @@ public:
     const uint32_t NumDescriptors;
     const uint32_t DescriptorSize;
     const bool IsShaderVisible;
+    const uint32_t NumRingDescriptors;  // the last descriptors of the heap, TryAllocate does not hand them out
     
 private:
     friend class D3D12DescriptorManager;
-    D3D12DescriptorHeap(D3D12Device& inDevice, D3D12_DESCRIPTOR_HEAP_TYPE inType, uint32_t inNum, bool inIsShaderVisible = false);
+    D3D12DescriptorHeap(D3D12Device& inDevice, D3D12_DESCRIPTOR_HEAP_TYPE inType, uint32_t inNum, bool inIsShaderVisible = false, uint32_t inNumRingDescriptors = 0);
 
     // The srcDescriptorRangeStart parameter must be in a non shader-visible descriptor heap.
     // https://learn.microsoft.com/en-us/windows/win32/api/d3d12/nf-d3d12-id3d12device-copydescriptorssimple
@@ -43,9 +57,18 @@ private:
 };
 
 
+// The shader visible heaps are split into a static region and a ring region. Resource sets allocate their tables from
+// the static region for their whole lifetime. Dynamic resource sets stage their tables in cpu heaps instead, each
+// SetResourceSet copies them into a block of the ring region taken by the command list. The blocks and the freed static
+// ranges are reused once the queues passed the submits which may still read them.
 class D3D12DescriptorManager
 {
 public:
+    static constexpr uint32_t s_NumRingDescriptors = 262144;
+    static constexpr uint32_t s_NumRingSamplers = 1024;
+    static constexpr uint32_t s_RingBlockSize = 4096;
+    static constexpr uint32_t s_RingSamplerBlockSize = 64;
+    
     D3D12DescriptorManager(D3D12Device& inDevice);
     ~D3D12DescriptorManager();
 
@@ -58,8 +81,16 @@ public:
     const D3D12DescriptorHeap* AllocateShaderVisibleDescriptors(uint32_t inNumDescriptors, uint32_t& outSlot);
     const D3D12DescriptorHeap* AllocateShaderVisibleSamplers(uint32_t inNumDescriptors, uint32_t& outSlot);
     
-    // Free a number of descriptors from the heap
+    // Free a number of descriptors from the heap, the shader visible ranges are freed once the queues passed their submits
     void Free(const D3D12DescriptorHeap* inHeap, uint32_t inSlot, uint32_t inNumDescriptors);
+
+    // Returns a free block of the ring region, waits for the oldest submitted block if every block is in flight
+    bool AcquireRingBlock(D3D12_DESCRIPTOR_HEAP_TYPE inType, D3D12DescriptorRingBlock& outBlock);
+    // Returns blocks which never reached a queue, e.g. of a command list that began again without being executed
+    void ReleaseRingBlocks(const std::vector<D3D12DescriptorRingBlock>& inBlocks);
+    // Signals the queue after each ExecuteCommandLists, the blocks of the executed command list are reused once the
+    // queue passed the signal
+    void Submit(ID3D12CommandQueue* inQueue, ERHICommandQueueType inQueueType, const std::vector<D3D12DescriptorRingBlock>& inBlocks);
     
     // Copy a number of descriptors to this heap
     void CopyDescriptors(const D3D12DescriptorHeap* inHeap, uint32_t inNumDescriptors, uint32_t inDestSlot, const D3D12_CPU_DESCRIPTOR_HANDLE& srcDescriptorRangeStart);
@@ -67,8 +98,45 @@ public:
     void BindShaderVisibleHeaps(ID3D12GraphicsCommandList* inCmdList) const;
     
 private:
+    struct SubmittedBlock
+    {
+        uint32_t Slot;
+        uint32_t Queue;
+        uint64_t FenceValue;
+    };
+    
+    struct DescriptorRing
+    {
+        D3D12DescriptorHeap* Heap = nullptr;
+        uint32_t BlockSize = 0;
+        std::deque<uint32_t> FreeBlocks;              // the first slots of the blocks
+        std::deque<SubmittedBlock> SubmittedBlocks;   // in submit order
+    };
+
+    struct PendingFree
+    {
+        D3D12DescriptorHeap* Heap;
+        uint32_t Slot;
+        uint32_t NumDescriptors;
+        std::array<uint64_t, COMMAND_QUEUES_COUNT> FenceValues; // the last signals of the queues when it was freed
+    };
+    
+    void InitRing(DescriptorRing& inRing, D3D12DescriptorHeap* inHeap, uint32_t inBlockSize);
+    DescriptorRing* GetRing(D3D12_DESCRIPTOR_HEAP_TYPE inType);
+    bool IsCompleted(uint32_t inQueue, uint64_t inFenceValue) const;
+    void WaitForFence(uint32_t inQueue, uint64_t inFenceValue);
+    void RetireInternal();
+    
     D3D12Device& m_Device;
     std::vector<D3D12DescriptorHeap*> m_ManagedDescriptorHeaps;
     D3D12DescriptorHeap* m_ShaderVisibleHeap;
     D3D12DescriptorHeap* m_ShaderVisibleSamplersHeap;
+
+    std::mutex m_Mutex;
+    std::array<Microsoft::WRL::ComPtr<ID3D12Fence>, COMMAND_QUEUES_COUNT> m_QueueFences;
+    std::array<uint64_t, COMMAND_QUEUES_COUNT> m_QueueFenceValues;    // the last values signaled on the queues
+    HANDLE m_RingEvent;
+    DescriptorRing m_ResourceRing;
+    DescriptorRing m_SamplerRing;
+    std::vector<PendingFree> m_PendingFrees;
 };
\ No newline at end of file
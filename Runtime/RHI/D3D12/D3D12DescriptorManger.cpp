@@ -3,11 +3,12 @@
 #include "D3D12Definitions.h"
 #include "../../Core/Log.h"
 
-D3D12DescriptorHeap::D3D12DescriptorHeap(D3D12Device& inDevice, D3D12_DESCRIPTOR_HEAP_TYPE inType, uint32_t inNum, bool inIsShaderVisible)
+D3D12DescriptorHeap::D3D12DescriptorHeap(D3D12Device& inDevice, D3D12_DESCRIPTOR_HEAP_TYPE inType, uint32_t inNum, bool inIsShaderVisible, uint32_t inNumRingDescriptors)
     : HeapType(inType)
     , NumDescriptors(inNum)
     , DescriptorSize(inDevice.GetDevice()->GetDescriptorHandleIncrementSize(HeapType))
     , IsShaderVisible(inIsShaderVisible)
+    , NumRingDescriptors(inNumRingDescriptors)
     , m_Device(inDevice)
     , m_HeapHandle(nullptr)
     , m_CpuBase()
@@ -48,7 +49,7 @@ bool D3D12DescriptorHeap::Init()
         m_GpuBase = m_HeapHandle->GetGPUDescriptorHandleForHeapStart();
     }
 
-    m_DescriptorAllocator.SetTotalCount(NumDescriptors);
+    m_DescriptorAllocator.SetTotalCount(NumDescriptors - NumRingDescriptors);
 
     return true;
 }
@@ -98,8 +99,10 @@ void D3D12DescriptorHeap::ResetHeap()
 
 D3D12DescriptorManager::D3D12DescriptorManager(D3D12Device& inDevice)
     : m_Device(inDevice)
-    , m_ShaderVisibleHeap(new D3D12DescriptorHeap(inDevice, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, D3D12_MAX_SHADER_VISIBLE_DESCRIPTOR_HEAP_SIZE_TIER_1, true))
-    , m_ShaderVisibleSamplersHeap(new D3D12DescriptorHeap(inDevice, D3D12_DESCRIPTOR_HEAP_TYPE_SAMPLER, D3D12_MAX_SHADER_VISIBLE_SAMPLER_HEAP_SIZE, true))
+    , m_ShaderVisibleHeap(new D3D12DescriptorHeap(inDevice, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, D3D12_MAX_SHADER_VISIBLE_DESCRIPTOR_HEAP_SIZE_TIER_1, true, s_NumRingDescriptors))
+    , m_ShaderVisibleSamplersHeap(new D3D12DescriptorHeap(inDevice, D3D12_DESCRIPTOR_HEAP_TYPE_SAMPLER, D3D12_MAX_SHADER_VISIBLE_SAMPLER_HEAP_SIZE, true, s_NumRingSamplers))
+    , m_QueueFenceValues{}
+    , m_RingEvent(nullptr)
 {
     
 }
@@ -116,7 +119,39 @@ bool D3D12DescriptorManager::Init()
         Log::Warning("[D3D12] Descriptor manager is already initialized");
         return true;
     }
-    return m_ShaderVisibleHeap->Init() && m_ShaderVisibleSamplersHeap->Init();
+    
+    if(!m_ShaderVisibleHeap->Init() || !m_ShaderVisibleSamplersHeap->Init())
+    {
+        return false;
+    }
+
+    for(auto& fence : m_QueueFences)
+    {
+        HRESULT hr = m_Device.GetDevice()->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&fence));
+        if(FAILED(hr))
+        {
+            OUTPUT_D3D12_FAILED_RESULT(hr)
+            return false;
+        }
+    }
+    m_QueueFenceValues.fill(0);
+    
+    InitRing(m_ResourceRing, m_ShaderVisibleHeap, s_RingBlockSize);
+    InitRing(m_SamplerRing, m_ShaderVisibleSamplersHeap, s_RingSamplerBlockSize);
+    return true;
+}
+
+void D3D12DescriptorManager::InitRing(DescriptorRing& inRing, D3D12DescriptorHeap* inHeap, uint32_t inBlockSize)
+{
+    inRing.Heap = inHeap;
+    inRing.BlockSize = inBlockSize;
+    inRing.FreeBlocks.clear();
+    inRing.SubmittedBlocks.clear();
+    const uint32_t firstSlot = inHeap->NumDescriptors - inHeap->NumRingDescriptors;
+    for(uint32_t slot = firstSlot; slot + inBlockSize <= inHeap->NumDescriptors; slot += inBlockSize)
+    {
+        inRing.FreeBlocks.push_back(slot);
+    }
 }
 
 bool D3D12DescriptorManager::IsValid() const
@@ -131,6 +166,18 @@ void D3D12DescriptorManager::Shutdown()
         delete i;
     }
     m_ManagedDescriptorHeaps.clear();
+    m_PendingFrees.clear();
+    m_ResourceRing = DescriptorRing();
+    m_SamplerRing = DescriptorRing();
+    for(auto& fence : m_QueueFences)
+    {
+        fence.Reset();
+    }
+    if(m_RingEvent != nullptr)
+    {
+        CloseHandle(m_RingEvent);
+        m_RingEvent = nullptr;
+    }
     delete m_ShaderVisibleHeap;
     delete m_ShaderVisibleSamplersHeap;
 }
@@ -168,6 +215,8 @@ const D3D12DescriptorHeap* D3D12DescriptorManager::Allocate(D3D12_DESCRIPTOR_HEA
 
 const D3D12DescriptorHeap* D3D12DescriptorManager::AllocateShaderVisibleDescriptors(uint32_t inNumDescriptors, uint32_t& outSlot)
 {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    RetireInternal();
     if(m_ShaderVisibleHeap->TryAllocate(inNumDescriptors, outSlot))
     {
         return m_ShaderVisibleHeap;
@@ -178,6 +227,8 @@ const D3D12DescriptorHeap* D3D12DescriptorManager::AllocateShaderVisibleDescript
 
 const D3D12DescriptorHeap* D3D12DescriptorManager::AllocateShaderVisibleSamplers(uint32_t inNumDescriptors, uint32_t& outSlot)
 {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    RetireInternal();
     if(m_ShaderVisibleSamplersHeap->TryAllocate(inNumDescriptors, outSlot))
     {
         return m_ShaderVisibleSamplersHeap;
@@ -188,6 +239,15 @@ const D3D12DescriptorHeap* D3D12DescriptorManager::AllocateShaderVisibleSamplers
 
 void D3D12DescriptorManager::Free(const D3D12DescriptorHeap* inHeap, uint32_t inSlot, uint32_t inNumDescriptors)
 {
+    if(inHeap == m_ShaderVisibleHeap || inHeap == m_ShaderVisibleSamplersHeap)
+    {
+        // A submitted command list may still read the range
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        D3D12DescriptorHeap* heap = inHeap == m_ShaderVisibleHeap ? m_ShaderVisibleHeap : m_ShaderVisibleSamplersHeap;
+        m_PendingFrees.push_back({heap, inSlot, inNumDescriptors, m_QueueFenceValues});
+        return;
+    }
+    
     // It's inefficient when we have a large number of descriptor heaps
     for(auto i : m_ManagedDescriptorHeaps)
     {
@@ -231,4 +291,133 @@ void D3D12DescriptorManager::BindShaderVisibleHeaps(ID3D12GraphicsCommandList* i
         ID3D12DescriptorHeap* descriptorHeaps[] = { m_ShaderVisibleHeap->GetHeap(), m_ShaderVisibleSamplersHeap->GetHeap() };
         inCmdList->SetDescriptorHeaps(2, descriptorHeaps);
     }
+}
+
+D3D12DescriptorManager::DescriptorRing* D3D12DescriptorManager::GetRing(D3D12_DESCRIPTOR_HEAP_TYPE inType)
+{
+    switch (inType)
+    {
+    case D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV:
+        return &m_ResourceRing;
+    case D3D12_DESCRIPTOR_HEAP_TYPE_SAMPLER:
+        return &m_SamplerRing;
+    default:
+        return nullptr;
+    }
+}
+
+bool D3D12DescriptorManager::AcquireRingBlock(D3D12_DESCRIPTOR_HEAP_TYPE inType, D3D12DescriptorRingBlock& outBlock)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    DescriptorRing* ring = GetRing(inType);
+    if(ring == nullptr || ring->Heap == nullptr)
+    {
+        Log::Error("[D3D12] The descriptor heap type has no ring region");
+        return false;
+    }
+    
+    RetireInternal();
+    if(ring->FreeBlocks.empty())
+    {
+        if(ring->SubmittedBlocks.empty())
+        {
+            // Every block belongs to a command list that is still recording
+            Log::Error("[D3D12] The descriptor ring is exhausted by the recording command lists");
+            return false;
+        }
+        const SubmittedBlock& oldest = ring->SubmittedBlocks.front();
+        WaitForFence(oldest.Queue, oldest.FenceValue);
+        RetireInternal();
+    }
+
+    outBlock.Heap = ring->Heap;
+    outBlock.Slot = ring->FreeBlocks.front();
+    outBlock.NumDescriptors = ring->BlockSize;
+    outBlock.NumUsed = 0;
+    ring->FreeBlocks.pop_front();
+    return true;
+}
+
+void D3D12DescriptorManager::ReleaseRingBlocks(const std::vector<D3D12DescriptorRingBlock>& inBlocks)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    for(const D3D12DescriptorRingBlock& block : inBlocks)
+    {
+        DescriptorRing* ring = GetRing(block.Heap->HeapType);
+        ring->FreeBlocks.push_back(block.Slot);
+    }
+}
+
+void D3D12DescriptorManager::Submit(ID3D12CommandQueue* inQueue, ERHICommandQueueType inQueueType, const std::vector<D3D12DescriptorRingBlock>& inBlocks)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    const uint32_t queueIndex = static_cast<uint32_t>(inQueueType);
+    const uint64_t fenceValue = ++m_QueueFenceValues[queueIndex];
+    inQueue->Signal(m_QueueFences[queueIndex].Get(), fenceValue);
+    
+    for(const D3D12DescriptorRingBlock& block : inBlocks)
+    {
+        DescriptorRing* ring = GetRing(block.Heap->HeapType);
+        ring->SubmittedBlocks.push_back({block.Slot, queueIndex, fenceValue});
+    }
+}
+
+bool D3D12DescriptorManager::IsCompleted(uint32_t inQueue, uint64_t inFenceValue) const
+{
+    return inFenceValue == 0 || m_QueueFences[inQueue]->GetCompletedValue() >= inFenceValue;
+}
+
+void D3D12DescriptorManager::WaitForFence(uint32_t inQueue, uint64_t inFenceValue)
+{
+    if(IsCompleted(inQueue, inFenceValue))
+    {
+        return;
+    }
+    
+    if(m_RingEvent == nullptr)
+    {
+        m_RingEvent = CreateEventEx(nullptr, TEXT("Wait For Descriptor Ring"), false, EVENT_ALL_ACCESS);
+    }
+    ResetEvent(m_RingEvent);
+    m_QueueFences[inQueue]->SetEventOnCompletion(inFenceValue, m_RingEvent);
+    WaitForSingleObject(m_RingEvent, INFINITE);
+}
+
+void D3D12DescriptorManager::RetireInternal()
+{
+    for(DescriptorRing* ring : {&m_ResourceRing, &m_SamplerRing})
+    {
+        // The queues run independently, a completed block of one queue may wait behind a block of another
+        for(auto it = ring->SubmittedBlocks.begin(); it != ring->SubmittedBlocks.end();)
+        {
+            if(IsCompleted(it->Queue, it->FenceValue))
+            {
+                ring->FreeBlocks.push_back(it->Slot);
+                it = ring->SubmittedBlocks.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+    }
+
+    for(auto it = m_PendingFrees.begin(); it != m_PendingFrees.end();)
+    {
+        bool completed = true;
+        for(uint32_t queue = 0; queue < COMMAND_QUEUES_COUNT && completed; ++queue)
+        {
+            completed = IsCompleted(queue, it->FenceValues[queue]);
+        }
+        
+        if(completed)
+        {
+            it->Heap->Free(it->Slot, it->NumDescriptors);
+            it = m_PendingFrees.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
 }
\ No newline at end of file
@@ -2,6 +2,7 @@
 
 #include "D3D12CommandList.h"
 #include "D3D12DescriptorManager.h"
+#include "D3D12Resources.h"
 #include "../RHICommandList.h"
 #include "../../Core/Log.h"
 #include "../../Core/Templates.h"
@@ -24,6 +25,12 @@ D3D12Device::D3D12Device()
     , m_DeviceHandle(nullptr)
     , m_QueueHandles {nullptr, nullptr, nullptr}
     , m_DescriptorManager(nullptr)
+    , m_BindlessResourceHeap(nullptr)
+    , m_BindlessSamplerHeap(nullptr)
+    , m_BindlessResourceSlot(UINT_MAX)
+    , m_BindlessSamplerSlot(UINT_MAX)
+    , m_PipelineLibrary(nullptr)
+    , m_PipelineLibraryDirty(false)
 {
     
 }
@@ -134,6 +141,8 @@ bool D3D12Device::Init()
         Log::Error("[D3D12] Failed to create the descriptor manager");
         return false;
     }
+
+    InitPipelineLibrary();
     
     return true;
 }
@@ -145,6 +154,26 @@ void D3D12Device::Shutdown()
 
 void D3D12Device::ShutdownInternal()
 {
+    m_FrameContext.Shutdown();
+    m_CommandListPool.Clear();
+    m_BindlessTable.Shutdown();
+    m_BindlessResourceHeap = nullptr;
+    m_BindlessSamplerHeap = nullptr;
+    m_Defragmenter.Clear();
+    m_MemoryAllocator.Clear();
+    m_ResidencyManager.Clear();
+    m_ConstantAllocator.Shutdown();
+    m_UploadRing.Shutdown();
+    m_PipelineCompiler.Shutdown();
+    m_PipelineCache.Clear();
+    m_StateCache.Clear();
+    SavePipelineLibrary();
+    m_FixupCommandLists.clear();
+    for(QueueFenceValue& waitFence : m_FixupWaitFences)
+    {
+        waitFence.Fence = nullptr;
+    }
+    
     for(auto semaphore : m_WaitForSemaphores)
     {
         semaphore.clear();
@@ -153,6 +182,14 @@ void D3D12Device::ShutdownInternal()
     {
         semaphore.clear();
     }
+    for(auto& fences : m_WaitForFences)
+    {
+        fences.clear();
+    }
+    for(auto& fences : m_SignalFences)
+    {
+        fences.clear();
+    }
     
     for(auto i : m_QueueHandles)
     {
@@ -163,6 +200,140 @@ void D3D12Device::ShutdownInternal()
     m_FactoryHandle.Reset();
 }
 
+RHIPipelineCacheDeviceId D3D12Device::GetPipelineCacheDeviceId() const
+{
+    RHIPipelineCacheDeviceId deviceId;
+    DXGI_ADAPTER_DESC1 adapterDesc{};
+    m_AdapterHandle->GetDesc1(&adapterDesc);
+    deviceId.VendorId = adapterDesc.VendorId;
+    deviceId.DeviceId = adapterDesc.DeviceId;
+    memcpy(deviceId.CacheUuid.data(), &adapterDesc.SubSysId, sizeof(adapterDesc.SubSysId));
+    memcpy(deviceId.CacheUuid.data() + sizeof(adapterDesc.SubSysId), &adapterDesc.Revision, sizeof(adapterDesc.Revision));
+    
+    LARGE_INTEGER driverVersion{};
+    if(SUCCEEDED(m_AdapterHandle->CheckInterfaceSupport(__uuidof(IDXGIDevice), &driverVersion)))
+    {
+        deviceId.DriverVersion = static_cast<uint64_t>(driverVersion.QuadPart);
+    }
+    return deviceId;
+}
+
+void D3D12Device::InitPipelineLibrary()
+{
+    RHIPipelineCache::LoadBlob(ERHIBackend::D3D12, GetPipelineCacheDeviceId(), m_PipelineLibraryData);
+    
+    HRESULT hr = m_DeviceHandle->CreatePipelineLibrary(m_PipelineLibraryData.empty() ? nullptr : m_PipelineLibraryData.data()
+        , m_PipelineLibraryData.size()
+        , IID_PPV_ARGS(&m_PipelineLibrary));
+    
+    if(FAILED(hr) && !m_PipelineLibraryData.empty())
+    {
+        // D3D12_ERROR_DRIVER_VERSION_MISMATCH, D3D12_ERROR_ADAPTER_NOT_FOUND or a corrupted library
+        Log::Warning("[D3D12] The driver rejected the pipeline library, starting with an empty library");
+        m_PipelineLibraryData.clear();
+        hr = m_DeviceHandle->CreatePipelineLibrary(nullptr, 0, IID_PPV_ARGS(&m_PipelineLibrary));
+    }
+
+    if(FAILED(hr))
+    {
+        // Not fatal, e.g. DXGI_ERROR_UNSUPPORTED under some graphics tools. Pipelines are compiled without the library
+        Log::Warning("[D3D12] Failed to create the pipeline library");
+        OUTPUT_D3D12_FAILED_RESULT(hr)
+        m_PipelineLibrary.Reset();
+        m_PipelineLibraryData.clear();
+    }
+    m_PipelineLibraryDirty = false;
+}
+
+void D3D12Device::SavePipelineLibrary()
+{
+    if(m_PipelineLibrary != nullptr && m_PipelineLibraryDirty && m_AdapterHandle != nullptr)
+    {
+        const SIZE_T serializedSize = m_PipelineLibrary->GetSerializedSize();
+        std::vector<uint8_t> data(serializedSize);
+        if(serializedSize > 0 && SUCCEEDED(m_PipelineLibrary->Serialize(data.data(), serializedSize)))
+        {
+            RHIPipelineCache::SaveBlob(ERHIBackend::D3D12, GetPipelineCacheDeviceId(), data.data(), serializedSize);
+        }
+    }
+    
+    m_PipelineLibrary.Reset();
+    m_PipelineLibraryData.clear();
+    m_PipelineLibraryDirty = false;
+}
+
+void D3D12Device::StorePipelineState(const std::wstring& inName, ID3D12PipelineState* inPipelineState)
+{
+    // Loading the same pipeline from several threads is the one case the library does not synchronize, the lock
+    // covers loads and stores while the compiles run in parallel
+    std::lock_guard lock(m_PipelineLibraryMutex);
+    // E_INVALIDARG if the name is already taken, the stored pipeline stays
+    if(SUCCEEDED(m_PipelineLibrary->StorePipeline(inName.c_str(), inPipelineState)))
+    {
+        m_PipelineLibraryDirty = true;
+    }
+}
+
+HRESULT D3D12Device::CreateGraphicsPipelineState(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& inDesc, const std::string& inName, Microsoft::WRL::ComPtr<ID3D12PipelineState>& outPipelineState)
+{
+    const std::wstring name(inName.begin(), inName.end());
+    if(m_PipelineLibrary != nullptr)
+    {
+        std::lock_guard lock(m_PipelineLibraryMutex);
+        if(SUCCEEDED(m_PipelineLibrary->LoadGraphicsPipeline(name.c_str(), &inDesc, IID_PPV_ARGS(&outPipelineState))))
+        {
+            return S_OK;
+        }
+    }
+    
+    HRESULT hr = m_DeviceHandle->CreateGraphicsPipelineState(&inDesc, IID_PPV_ARGS(&outPipelineState));
+    if(SUCCEEDED(hr) && m_PipelineLibrary != nullptr)
+    {
+        StorePipelineState(name, outPipelineState.Get());
+    }
+    return hr;
+}
+
+HRESULT D3D12Device::CreateComputePipelineState(const D3D12_COMPUTE_PIPELINE_STATE_DESC& inDesc, const std::string& inName, Microsoft::WRL::ComPtr<ID3D12PipelineState>& outPipelineState)
+{
+    const std::wstring name(inName.begin(), inName.end());
+    if(m_PipelineLibrary != nullptr)
+    {
+        std::lock_guard lock(m_PipelineLibraryMutex);
+        if(SUCCEEDED(m_PipelineLibrary->LoadComputePipeline(name.c_str(), &inDesc, IID_PPV_ARGS(&outPipelineState))))
+        {
+            return S_OK;
+        }
+    }
+    
+    HRESULT hr = m_DeviceHandle->CreateComputePipelineState(&inDesc, IID_PPV_ARGS(&outPipelineState));
+    if(SUCCEEDED(hr) && m_PipelineLibrary != nullptr)
+    {
+        StorePipelineState(name, outPipelineState.Get());
+    }
+    return hr;
+}
+
+HRESULT D3D12Device::CreatePipelineState(const D3D12_PIPELINE_STATE_STREAM_DESC& inDesc, const std::string& inName, Microsoft::WRL::ComPtr<ID3D12PipelineState>& outPipelineState)
+{
+    const std::wstring name(inName.begin(), inName.end());
+    if(m_PipelineLibrary != nullptr)
+    {
+        std::lock_guard lock(m_PipelineLibraryMutex);
+        if(SUCCEEDED(m_PipelineLibrary->LoadPipeline(name.c_str(), &inDesc, IID_PPV_ARGS(&outPipelineState))))
+        {
+            return S_OK;
+        }
+    }
+    
+    HRESULT hr = m_DeviceHandle->CreatePipelineState(&inDesc, IID_PPV_ARGS(&outPipelineState));
+    if(SUCCEEDED(hr) && m_PipelineLibrary != nullptr)
+    {
+        StorePipelineState(name, outPipelineState.Get());
+    }
+    return hr;
+}
+
 bool D3D12Device::IsValid() const
 {
     bool valid = m_FactoryHandle != nullptr && m_AdapterHandle != nullptr && m_DeviceHandle != nullptr && m_DescriptorManager != nullptr;
@@ -222,47 +393,372 @@ void D3D12Device::AddQueueSignalSemaphore(ERHICommandQueueType inType, ID3D12Fen
     signalSemaphores.push_back(inSemaphore);
 }
 
-void D3D12Device::ExecuteCommandList(const RefCountPtr<RHICommandList>& inCommandList, const RefCountPtr<RHIFence>& inSignalFence)
+void D3D12Device::AddQueueWaitForFence(ERHICommandQueueType inType, RefCountPtr<RHITimelineFence>& inFence, uint64_t inValue)
+{
+    D3D12TimelineFence* d3dFence = CheckCast<D3D12TimelineFence*>(inFence.GetReference());
+    if(d3dFence && d3dFence->IsValid())
+    {
+        m_WaitForFences[static_cast<uint32_t>(inType)].push_back({d3dFence, inValue});
+    }
+}
+
+void D3D12Device::AddQueueSignalFence(ERHICommandQueueType inType, RefCountPtr<RHITimelineFence>& inFence, uint64_t inValue)
+{
+    D3D12TimelineFence* d3dFence = CheckCast<D3D12TimelineFence*>(inFence.GetReference());
+    if(d3dFence && d3dFence->IsValid())
+    {
+        m_SignalFences[static_cast<uint32_t>(inType)].push_back({d3dFence, inValue});
+    }
+}
+
+void D3D12Device::ExecuteCommandLists(const RefCountPtr<RHICommandList>* inCommandLists, uint32_t inCount
+    , const RHIQueueFenceValue* inWaitFences, uint32_t inNumWaitFences
+    , const RHIQueueFenceValue* inSignalFences, uint32_t inNumSignalFences
+    , const RefCountPtr<RHIFence>& inSignalFence)
 {
-    D3D12CommandList* commandList = CheckCast<D3D12CommandList*>(inCommandList.GetReference());
-    if(commandList && commandList->IsValid())
+    if(inCount == 0)
+    {
+        return;
+    }
+
+    const ERHICommandQueueType queueType = inCommandLists[0]->GetQueueType();
+    for(uint32_t i = 0; i < inCount; ++i)
     {
+        D3D12CommandList* commandList = CheckCast<D3D12CommandList*>(inCommandLists[i].GetReference());
+        if(commandList == nullptr || !commandList->IsValid() || commandList->GetQueueType() != queueType)
+        {
+            Log::Error("[D3D12] The command list %u is invalid or belongs to another queue than the first one", i);
+            return;
+        }
         if(!commandList->IsClosed())
         {
             commandList->End();
         }
+    }
+
+    std::lock_guard<std::mutex> lock(m_SubmitMutex);
+    const uint32_t queueIndex = static_cast<uint32_t>(queueType);
+    for(uint32_t i = 0; i < inNumWaitFences; ++i)
+    {
+        RefCountPtr<RHITimelineFence> fence = inWaitFences[i].Fence;
+        AddQueueWaitForFence(queueType, fence, inWaitFences[i].Value);
+    }
+    for(uint32_t i = 0; i < inNumSignalFences; ++i)
+    {
+        RefCountPtr<RHITimelineFence> fence = inSignalFences[i].Fence;
+        AddQueueSignalFence(queueType, fence, inSignalFences[i].Value);
+    }
+    // The pooled lists are reused once the queue finished this submit
+    RHIQueueFenceValue poolSignal;
+    if(m_CommandListPool.GetExecuteSignal(inCommandLists, inCount, poolSignal))
+    {
+        AddQueueSignalFence(queueType, poolSignal.Fence, poolSignal.Value);
+    }
 
-        ID3D12CommandQueue* queue = GetCommandQueue(inCommandList->GetQueueType());
-        ID3D12CommandList* cmdListHandle = commandList->GetCommandList();
-        queue->ExecuteCommandLists(1, &cmdListHandle);
+    ID3D12CommandQueue* queue = GetCommandQueue(queueType);
+    std::vector<QueueFenceValue>& waitForFences = m_WaitForFences[queueIndex];
+    for(const QueueFenceValue& waitFence : waitForFences)
+    {
+        queue->Wait(waitFence.Fence->GetFence(), waitFence.Value);
+    }
+    waitForFences.clear();
 
-        if(inSignalFence != nullptr && inSignalFence->IsValid())
+    // The semaphore waits gate the lists of this submit like the fence waits, they are queued before the lists
+    std::vector<ID3D12Fence*>& waitForSemaphores = m_WaitForSemaphores[queueIndex];
+    for(const auto& waitSemaphore : waitForSemaphores)
+    {
+        queue->Wait(waitSemaphore, FENCE_COMPLETED_VALUE);
+    }
+    waitForSemaphores.clear();
+
+    // The fix-up barriers of a list have to run after the lists before it, they split the batch
+    m_SubmitBatch.clear();
+    m_SubmittedRingBlocks.clear();
+    for(uint32_t i = 0; i < inCount; ++i)
+    {
+        D3D12CommandList* commandList = CheckCast<D3D12CommandList*>(inCommandLists[i].GetReference());
+        // Evicted heaps and resources the list uses are made resident before it executes
+        m_ResidencyManager.MarkUsed(commandList->GetResidencyUsage());
+        m_FixupBarriers.clear();
+        commandList->GetStateTracker().Resolve(queueType, m_FixupBarriers);
+        if(!m_FixupBarriers.empty())
         {
-            inSignalFence->Reset();
-            ID3D12Fence* fence = CheckCast<D3D12Fence*>(inSignalFence.GetReference())->GetFence();
-            queue->Signal(fence, FENCE_COMPLETED_VALUE);
+            FlushSubmitBatch(queue, queueType);
+            ExecuteFixupBarriers(queueType, m_FixupBarriers);
         }
+        m_SubmitBatch.push_back(commandList->GetCommandList());
+        commandList->TakeRingBlocks(m_SubmittedRingBlocks);
+    }
+    FlushSubmitBatch(queue, queueType);
+
+    if(inSignalFence != nullptr && inSignalFence->IsValid())
+    {
+        inSignalFence->Reset();
+        ID3D12Fence* fence = CheckCast<D3D12Fence*>(inSignalFence.GetReference())->GetFence();
+        queue->Signal(fence, FENCE_COMPLETED_VALUE);
+    }
 
-        std::vector<ID3D12Fence*>& waitForSemaphores = m_WaitForSemaphores[static_cast<uint32_t>(inCommandList->GetQueueType())];
-        if(!waitForSemaphores.empty())
+    std::vector<ID3D12Fence*>& signalSemaphores = m_SignalSemaphores[queueIndex];
+    if(!signalSemaphores.empty())
+    {
+        for(const auto& signalSemaphore : signalSemaphores)
         {
-            for(const auto& waitSemaphore : waitForSemaphores)
-            {
-                queue->Wait(waitSemaphore, FENCE_COMPLETED_VALUE);
-            }
+            queue->Signal(signalSemaphore, FENCE_COMPLETED_VALUE);
         }
+    }
 
-        std::vector<ID3D12Fence*>& signalSemaphores = m_SignalSemaphores[static_cast<uint32_t>(inCommandList->GetQueueType())];
-        if(!signalSemaphores.empty())
+    std::vector<QueueFenceValue>& signalFences = m_SignalFences[queueIndex];
+    for(const QueueFenceValue& signalFence : signalFences)
+    {
+        queue->Signal(signalFence.Fence->GetFence(), signalFence.Value);
+    }
+
+    signalSemaphores.clear();
+    signalFences.clear();
+}
+
+// Executes the lists collected since the last flush with one ExecuteCommandLists
+void D3D12Device::FlushSubmitBatch(ID3D12CommandQueue* inQueue, ERHICommandQueueType inQueueType)
+{
+    if(m_SubmitBatch.empty())
+    {
+        return;
+    }
+    
+    inQueue->ExecuteCommandLists(static_cast<UINT>(m_SubmitBatch.size()), m_SubmitBatch.data());
+    ++m_SubmitStats.Submits;
+    m_SubmitStats.CommandLists += m_SubmitBatch.size();
+
+    // The ring blocks of the dynamic resource sets and the freed shader visible tables are reused after this signal
+    m_DescriptorManager->Submit(inQueue, inQueueType, m_SubmittedRingBlocks);
+    m_SubmitBatch.clear();
+    m_SubmittedRingBlocks.clear();
+}
+
+// The barriers from the global states to the states a command list expects at its start. They are recorded on the
+// direct queue, the only queue that can transition from and to every state. For a command list of another queue the
+// direct queue first waits for the work submitted to that queue, and that queue waits for the barriers on the GPU
+void D3D12Device::ExecuteFixupBarriers(ERHICommandQueueType inQueueType, const std::vector<CD3DX12_RESOURCE_BARRIER>& inBarriers)
+{
+    FixupCommandList* fixup = nullptr;
+    for(FixupCommandList& commandList : m_FixupCommandLists)
+    {
+        if(commandList.Fence->IsCompleted())
         {
-            for(const auto& signalSemaphore : signalSemaphores)
-            {
-                queue->Signal(signalSemaphore, FENCE_COMPLETED_VALUE);
-            }
+            fixup = &commandList;
+            break;
+        }
+    }
+    
+    if(fixup == nullptr)
+    {
+        FixupCommandList commandList;
+        commandList.CommandList = RefCountPtr<D3D12CommandList>(CreateCommandList(ERHICommandQueueType::Direct));
+        commandList.Fence = CreateD3D12Fence();
+        if(!commandList.CommandList->IsValid() || !commandList.Fence->IsValid())
+        {
+            Log::Error("[D3D12] Failed to create a fix-up command list, %u barriers are dropped", (uint32_t)inBarriers.size());
+            return;
+        }
+        commandList.CommandList->SetName("FixupCommandList");
+        m_FixupCommandLists.push_back(commandList);
+        fixup = &m_FixupCommandLists.back();
+    }
+
+    ID3D12CommandQueue* directQueue = GetCommandQueue(ERHICommandQueueType::Direct);
+    if(inQueueType != ERHICommandQueueType::Direct)
+    {
+        QueueFenceValue& waitFence = m_FixupWaitFences[static_cast<uint32_t>(inQueueType)];
+        if(waitFence.Fence == nullptr)
+        {
+            waitFence.Fence = new D3D12TimelineFence(*this, 0);
+            waitFence.Value = 0;
+        }
+        if(!waitFence.Fence->IsValid() && !waitFence.Fence->Init())
+        {
+            Log::Error("[D3D12] Failed to create the fix-up wait fence, %u barriers are dropped", (uint32_t)inBarriers.size());
+            return;
         }
+        ++waitFence.Value;
+        GetCommandQueue(inQueueType)->Signal(waitFence.Fence->GetFence(), waitFence.Value);
+        directQueue->Wait(waitFence.Fence->GetFence(), waitFence.Value);
+    }
+
+    fixup->CommandList->Begin();
+    fixup->CommandList->GetCommandList()->ResourceBarrier((uint32_t)inBarriers.size(), inBarriers.data());
+    fixup->CommandList->End();
 
-        signalSemaphores.clear();
-        waitForSemaphores.clear();
+    fixup->Fence->Reset();
+    ID3D12CommandList* cmdListHandle = fixup->CommandList->GetCommandList();
+    directQueue->ExecuteCommandLists(1, &cmdListHandle);
+    directQueue->Signal(fixup->Fence->GetFence(), FENCE_COMPLETED_VALUE);
+    if(inQueueType != ERHICommandQueueType::Direct)
+    {
+        GetCommandQueue(inQueueType)->Wait(fixup->Fence->GetFence(), FENCE_COMPLETED_VALUE);
+    }
+}
+
+bool D3D12Device::QueryMemoryBudget(RHIMemoryBudget& outBudget)
+{
+    Microsoft::WRL::ComPtr<IDXGIAdapter3> adapter;
+    if(FAILED(m_AdapterHandle.As(&adapter)))
+    {
+        return false;
+    }
+
+    DXGI_QUERY_VIDEO_MEMORY_INFO memoryInfo{};
+    HRESULT hr = adapter->QueryVideoMemoryInfo(GetNodeMask(), DXGI_MEMORY_SEGMENT_GROUP_LOCAL, &memoryInfo);
+    if(FAILED(hr))
+    {
+        OUTPUT_D3D12_FAILED_RESULT(hr)
+        return false;
+    }
+    outBudget.Budget = memoryInfo.Budget;
+    outBudget.Usage = memoryInfo.CurrentUsage;
+    return true;
+}
+
+bool D3D12Device::EvictObjects(const RHIResidencyObject* inObjects, uint32_t inCount)
+{
+    std::vector<ID3D12Pageable*> pageables;
+    GetPageables(inObjects, inCount, pageables);
+    if(pageables.empty())
+    {
+        return false;
+    }
+    
+    HRESULT hr = m_DeviceHandle->Evict(static_cast<UINT>(pageables.size()), pageables.data());
+    if(FAILED(hr))
+    {
+        OUTPUT_D3D12_FAILED_RESULT(hr)
+        return false;
+    }
+    return true;
+}
+
+bool D3D12Device::MakeObjectsResident(const RHIResidencyObject* inObjects, uint32_t inCount)
+{
+    std::vector<ID3D12Pageable*> pageables;
+    GetPageables(inObjects, inCount, pageables);
+    if(pageables.empty())
+    {
+        return false;
+    }
+
+    // Blocks until the memory is paged in, E_OUTOFMEMORY if it does not fit even after the os paged out other processes
+    HRESULT hr = m_DeviceHandle->MakeResident(static_cast<UINT>(pageables.size()), pageables.data());
+    if(FAILED(hr))
+    {
+        OUTPUT_D3D12_FAILED_RESULT(hr)
+        return false;
+    }
+    return true;
+}
+
+bool D3D12Device::InitBindlessTable(uint32_t inNumResources, uint32_t inNumSamplers)
+{
+    // One contiguous range of each shader visible heap, the heaps stay bound for the whole command list
+    m_BindlessResourceHeap = m_DescriptorManager->AllocateShaderVisibleDescriptors(inNumResources, m_BindlessResourceSlot);
+    if(m_BindlessResourceHeap == nullptr)
+    {
+        Log::Error("[D3D12] The shader visible heap has no room for %u bindless descriptors", inNumResources);
+        return false;
+    }
+    
+    m_BindlessSamplerHeap = m_DescriptorManager->AllocateShaderVisibleSamplers(inNumSamplers, m_BindlessSamplerSlot);
+    if(m_BindlessSamplerHeap == nullptr)
+    {
+        Log::Error("[D3D12] The shader visible sampler heap has no room for %u bindless samplers", inNumSamplers);
+        m_BindlessResourceHeap = nullptr;
+        return false;
+    }
+    return true;
+}
+
+bool D3D12Device::WriteBindlessDescriptor(uint32_t inIndex, const RHIBindlessDescriptor& inDescriptor)
+{
+    if(m_BindlessResourceHeap == nullptr)
+    {
+        return false;
+    }
+    
+    D3D12_CPU_DESCRIPTOR_HANDLE handle;
+    switch (inDescriptor.Type)
+    {
+    case ERHIBindingResourceType::Texture_SRV:
+    {
+        D3D12Texture* texture = CheckCast<D3D12Texture*>(inDescriptor.Object);
+        if(!texture->TryGetSRVHandle(handle) && !texture->CreateSRV(handle))
+            return false;
+        break;
+    }
+    case ERHIBindingResourceType::Texture_UAV:
+    {
+        D3D12Texture* texture = CheckCast<D3D12Texture*>(inDescriptor.Object);
+        if(!texture->TryGetUAVHandle(handle) && !texture->CreateUAV(handle))
+            return false;
+        break;
+    }
+    case ERHIBindingResourceType::Buffer_SRV:
+    {
+        D3D12Buffer* buffer = CheckCast<D3D12Buffer*>(inDescriptor.Object);
+        if(!buffer->TryGetSRVHandle(handle) && !buffer->CreateSRV(handle))
+            return false;
+        break;
+    }
+    case ERHIBindingResourceType::Buffer_UAV:
+    {
+        D3D12Buffer* buffer = CheckCast<D3D12Buffer*>(inDescriptor.Object);
+        if(!buffer->TryGetUAVHandle(handle) && !buffer->CreateUAV(handle))
+            return false;
+        break;
+    }
+    case ERHIBindingResourceType::Sampler:
+        handle = CheckCast<D3D12Sampler*>(inDescriptor.Object)->GetHandle();
+        m_DescriptorManager->CopyDescriptors(m_BindlessSamplerHeap, 1, m_BindlessSamplerSlot + inIndex, handle);
+        return true;
+    default:
+        Log::Error("[D3D12] The bindless table only holds SRVs, UAVs and samplers");
+        return false;
+    }
+    
+    m_DescriptorManager->CopyDescriptors(m_BindlessResourceHeap, 1, m_BindlessResourceSlot + inIndex, handle);
+    return true;
+}
+
+bool D3D12Device::GetBindlessTableHandles(D3D12_GPU_DESCRIPTOR_HANDLE& outResources, D3D12_GPU_DESCRIPTOR_HANDLE& outSamplers) const
+{
+    if(m_BindlessResourceHeap == nullptr || m_BindlessSamplerHeap == nullptr)
+    {
+        return false;
+    }
+    outResources = m_BindlessResourceHeap->GetGpuSlotHandle(m_BindlessResourceSlot);
+    outSamplers = m_BindlessSamplerHeap->GetGpuSlotHandle(m_BindlessSamplerSlot);
+    return true;
+}
+
+void D3D12Device::GetPageables(const RHIResidencyObject* inObjects, uint32_t inCount, std::vector<ID3D12Pageable*>& outPageables)
+{
+    outPageables.reserve(inCount);
+    for(uint32_t i = 0; i < inCount; ++i)
+    {
+        ID3D12Pageable* pageable = nullptr;
+        switch (inObjects[i].Type)
+        {
+        case ERHIResidencyObjectType::ResourceHeap:
+            pageable = CheckCast<D3D12ResourceHeap*>(inObjects[i].Object)->GetHeap();
+            break;
+        case ERHIResidencyObjectType::Buffer:
+            pageable = CheckCast<D3D12Buffer*>(inObjects[i].Object)->GetBuffer();
+            break;
+        case ERHIResidencyObjectType::Texture:
+            pageable = CheckCast<D3D12Texture*>(inObjects[i].Object)->GetTexture();
+            break;
+        }
+        if(pageable != nullptr)
+        {
+            outPageables.push_back(pageable);
+        }
     }
 }
 
@@ -392,6 +888,11 @@ void D3D12Fence::CpuWait()
     }
 }
 
+bool D3D12Fence::IsCompleted()
+{
+    return IsValid() && m_FenceHandle->GetCompletedValue() >= FENCE_COMPLETED_VALUE;
+}
+
 void D3D12Fence::SetNameInternal()
 {
     if(IsValid())
@@ -401,6 +902,112 @@ void D3D12Fence::SetNameInternal()
     }
 }
 
+RefCountPtr<RHITimelineFence> D3D12Device::CreateTimelineFence(uint64_t inInitialValue)
+{
+    RefCountPtr<RHITimelineFence> fence(new D3D12TimelineFence(*this, inInitialValue));
+    if(!fence->Init())
+    {
+        Log::Error("[D3D12] Failed to create a timeline fence");
+    }
+    return fence;
+}
+
+D3D12TimelineFence::D3D12TimelineFence(D3D12Device& inDevice, uint64_t inInitialValue)
+    : m_Device(inDevice)
+    , m_FenceHandle(nullptr)
+    , m_SignaledEvent(nullptr)
+    , m_InitialValue(inInitialValue)
+{
+    
+}
+
+D3D12TimelineFence::~D3D12TimelineFence()
+{
+    ShutdownInternal();
+}
+
+bool D3D12TimelineFence::Init()
+{
+    if(IsValid())
+    {
+        Log::Warning("[D3D12] Timeline fence already initialized");
+        return true;    
+    }
+
+    HRESULT result = m_Device.GetDevice()->CreateFence(m_InitialValue, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&m_FenceHandle));
+    if(FAILED(result))
+    {
+        OUTPUT_D3D12_FAILED_RESULT(result);
+        return false;
+    }
+    
+    return true;
+}
+
+void D3D12TimelineFence::Shutdown()
+{
+    ShutdownInternal();
+}
+
+bool D3D12TimelineFence::IsValid() const
+{
+    return m_FenceHandle != nullptr;
+}
+
+void D3D12TimelineFence::ShutdownInternal()
+{
+    m_FenceHandle.Reset();
+    if(m_SignaledEvent != nullptr)
+    {
+        CloseHandle(m_SignaledEvent);
+        m_SignaledEvent = nullptr;
+    }
+}
+
+void D3D12TimelineFence::Signal(uint64_t inValue)
+{
+    if(IsValid())
+    {
+        m_FenceHandle->Signal(inValue);
+    }
+}
+
+uint64_t D3D12TimelineFence::GetCompletedValue()
+{
+    return IsValid() ? m_FenceHandle->GetCompletedValue() : 0;
+}
+
+bool D3D12TimelineFence::Wait(uint64_t inValue, uint64_t inTimeoutMs)
+{
+    if(!IsValid())
+    {
+        return false;
+    }
+    
+    if(m_FenceHandle->GetCompletedValue() >= inValue)
+    {
+        return true;
+    }
+
+    if(m_SignaledEvent == nullptr)
+    {
+        m_SignaledEvent = CreateEventEx(nullptr, TEXT("Wait For Fence Value"), false, EVENT_ALL_ACCESS);
+    }
+    ResetEvent(m_SignaledEvent);
+    m_FenceHandle->SetEventOnCompletion(inValue, m_SignaledEvent);
+    const DWORD timeout = inTimeoutMs >= INFINITE ? INFINITE : static_cast<DWORD>(inTimeoutMs);
+    return WaitForSingleObject(m_SignaledEvent, timeout) == WAIT_OBJECT_0;
+}
+
+void D3D12TimelineFence::SetNameInternal()
+{
+    if(IsValid())
+    {
+        std::wstring name(m_Name.begin(), m_Name.end());
+        m_FenceHandle->SetName(name.c_str());
+    }
+}
+
 D3D12Semaphore::D3D12Semaphore(D3D12Device& inDevice)
     : m_Device(inDevice)
     , m_FenceHandle(nullptr)
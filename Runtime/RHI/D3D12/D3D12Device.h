@@ -3,8 +3,11 @@
 #include "D3D12Definitions.h"
 
 class D3D12Buffer;
+class D3D12CommandList;
 class D3D12Texture;
 class D3D12DescriptorManager;
+class D3D12DescriptorHeap;
+struct D3D12DescriptorRingBlock;
 class D3D12Fence : public RHIFence
 {
 public:
@@ -14,6 +17,7 @@ public:
     bool IsValid() const override;
     void Reset() override;
     void CpuWait() override;
+    bool IsCompleted() override;
     
     ID3D12Fence* GetFence() const { return m_FenceHandle.Get(); }
 
@@ -31,6 +35,33 @@ private:
     uint8_t m_CurrentFenceValue;
 };
 
+class D3D12TimelineFence : public RHITimelineFence
+{
+public:
+    ~D3D12TimelineFence() override;
+    bool Init() override;
+    void Shutdown() override;
+    bool IsValid() const override;
+    void Signal(uint64_t inValue) override;
+    uint64_t GetCompletedValue() override;
+    bool Wait(uint64_t inValue, uint64_t inTimeoutMs = UINT64_MAX) override;
+
+    ID3D12Fence* GetFence() const { return m_FenceHandle.Get(); }
+
+protected:
+    void SetNameInternal() override;
+
+private:
+    friend class D3D12Device;
+    D3D12TimelineFence(D3D12Device& inDevice, uint64_t inInitialValue);
+    void ShutdownInternal();
+
+    D3D12Device& m_Device;
+    Microsoft::WRL::ComPtr<ID3D12Fence> m_FenceHandle;
+    HANDLE m_SignaledEvent;
+    uint64_t m_InitialValue;
+};
+
 class D3D12Semaphore : public RHISemaphore
 {
 public:
@@ -66,6 +97,7 @@ public:
     RefCountPtr<RHIFence>       CreateRhiFence() override;
     RefCountPtr<D3D12Fence>     CreateD3D12Fence();
     RefCountPtr<RHISemaphore>   CreateRhiSemaphore() override;
+    RefCountPtr<RHITimelineFence> CreateTimelineFence(uint64_t inInitialValue = 0) override;
     RefCountPtr<RHICommandList> CreateCommandList(ERHICommandQueueType inType = ERHICommandQueueType::Direct) override;
     RefCountPtr<RHIPipelineBindingLayout> CreatePipelineBindingLayout(const RHIPipelineBindingLayoutDesc& inBindingItems) override;
     RefCountPtr<RHIShader> CreateShader(ERHIShaderType inType) override;
@@ -80,20 +112,38 @@ public:
     RefCountPtr<RHIAccelerationStructure> CreateBottomLevelAccelerationStructure(const std::vector<RHIRayTracingGeometryDesc>& inDesc) override;
     RefCountPtr<RHIAccelerationStructure> CreateTopLevelAccelerationStructure(const std::vector<RHIRayTracingInstanceDesc>& inDesc) override;
     RefCountPtr<RHIFrameBuffer> CreateFrameBuffer(const RHIFrameBufferDesc& inDesc) override;
-    RefCountPtr<RHIResourceSet> CreateResourceSet(const RHIPipelineBindingLayout* inLayout) override;
+    RefCountPtr<RHIResourceSet> CreateResourceSet(const RHIPipelineBindingLayout* inLayout, bool inIsDynamic = false) override;
     void AddQueueWaitForSemaphore(ERHICommandQueueType inType, RefCountPtr<RHISemaphore>& inSemaphore) override;
     void AddQueueSignalSemaphore(ERHICommandQueueType inType, RefCountPtr<RHISemaphore>& inSemaphore) override;
     void AddQueueWaitForSemaphore(ERHICommandQueueType inType, RefCountPtr<D3D12Semaphore>& inSemaphore);
     void AddQueueSignalSemaphore(ERHICommandQueueType inType, RefCountPtr<D3D12Semaphore>& inSemaphore);
-    void ExecuteCommandList(const RefCountPtr<RHICommandList>& inCommandList, const RefCountPtr<RHIFence>& inSignalFence = nullptr) override;
+    void AddQueueWaitForFence(ERHICommandQueueType inType, RefCountPtr<RHITimelineFence>& inFence, uint64_t inValue) override;
+    void AddQueueSignalFence(ERHICommandQueueType inType, RefCountPtr<RHITimelineFence>& inFence, uint64_t inValue) override;
+    void ExecuteCommandLists(const RefCountPtr<RHICommandList>* inCommandLists, uint32_t inCount
+        , const RHIQueueFenceValue* inWaitFences = nullptr, uint32_t inNumWaitFences = 0
+        , const RHIQueueFenceValue* inSignalFences = nullptr, uint32_t inNumSignalFences = 0
+        , const RefCountPtr<RHIFence>& inSignalFence = nullptr) override;
+    bool QueryMemoryBudget(RHIMemoryBudget& outBudget) override;
+    bool EvictObjects(const RHIResidencyObject* inObjects, uint32_t inCount) override;
+    bool MakeObjectsResident(const RHIResidencyObject* inObjects, uint32_t inCount) override;
+    bool InitBindlessTable(uint32_t inNumResources, uint32_t inNumSamplers) override;
+    bool WriteBindlessDescriptor(uint32_t inIndex, const RHIBindlessDescriptor& inDescriptor) override;
     
     void FlushDirectCommandQueue();
     ERHIBackend GetBackend() const override { return ERHIBackend::D3D12; }
+    uint32_t GetTextureDataPitchAlignment() const override { return D3D12_TEXTURE_DATA_PITCH_ALIGNMENT; }
     IDXGIFactory2* GetFactory() const { return m_FactoryHandle.Get(); }
     IDXGIAdapter1* GetAdapter() const { return m_AdapterHandle.Get(); }
     ID3D12Device5* GetDevice() const { return m_DeviceHandle.Get(); }
     ID3D12CommandQueue* GetCommandQueue(ERHICommandQueueType inQueueType) const { return m_QueueHandles[static_cast<uint8_t>(inQueueType)].Get(); }
     D3D12DescriptorManager& GetDescriptorManager() { return *m_DescriptorManager; }
+    // The bindless ranges of the shader visible heaps, the descriptor tables of the layouts with UseBindlessTable
+    bool GetBindlessTableHandles(D3D12_GPU_DESCRIPTOR_HANDLE& outResources, D3D12_GPU_DESCRIPTOR_HANDLE& outSamplers) const;
+
+    // Load the pipeline from the persistent pipeline library by name, compile and store it on a miss
+    HRESULT CreateGraphicsPipelineState(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& inDesc, const std::string& inName, Microsoft::WRL::ComPtr<ID3D12PipelineState>& outPipelineState);
+    HRESULT CreateComputePipelineState(const D3D12_COMPUTE_PIPELINE_STATE_DESC& inDesc, const std::string& inName, Microsoft::WRL::ComPtr<ID3D12PipelineState>& outPipelineState);
+    HRESULT CreatePipelineState(const D3D12_PIPELINE_STATE_STREAM_DESC& inDesc, const std::string& inName, Microsoft::WRL::ComPtr<ID3D12PipelineState>& outPipelineState);
     
     // no mGPU support so far
     static uint32_t GetNodeMask() { return 0; }
@@ -104,17 +154,34 @@ public:
     static void LogAdapterDesc(const DXGI_ADAPTER_DESC1& inDesc);
 
 private:
-    friend bool RHI::Init(bool useVulkan);
+    friend bool RHI::Init(ERHIBackend inBackend);
     D3D12Device();
     void ShutdownInternal();
     void AddQueueWaitForSemaphore(ERHICommandQueueType inType, ID3D12Fence* inSemaphore);
     void AddQueueSignalSemaphore(ERHICommandQueueType inType, ID3D12Fence* inSemaphore);
+    void InitPipelineLibrary();
+    void SavePipelineLibrary();
+    void StorePipelineState(const std::wstring& inName, ID3D12PipelineState* inPipelineState);
+    RHIPipelineCacheDeviceId GetPipelineCacheDeviceId() const;
+    void ExecuteFixupBarriers(ERHICommandQueueType inQueueType, const std::vector<CD3DX12_RESOURCE_BARRIER>& inBarriers);
+    void FlushSubmitBatch(ID3D12CommandQueue* inQueue, ERHICommandQueueType inQueueType);
+    static void GetPageables(const RHIResidencyObject* inObjects, uint32_t inCount, std::vector<ID3D12Pageable*>& outPageables);
     
     Microsoft::WRL::ComPtr<IDXGIFactory2>               m_FactoryHandle;
     Microsoft::WRL::ComPtr<IDXGIAdapter1>               m_AdapterHandle;
     Microsoft::WRL::ComPtr<ID3D12Device5>               m_DeviceHandle;
     std::array<Microsoft::WRL::ComPtr<ID3D12CommandQueue>, COMMAND_QUEUES_COUNT> m_QueueHandles;
     std::unique_ptr<D3D12DescriptorManager>             m_DescriptorManager;
+    const D3D12DescriptorHeap*                          m_BindlessResourceHeap;
+    const D3D12DescriptorHeap*                          m_BindlessSamplerHeap;
+    uint32_t                                            m_BindlessResourceSlot;
+    uint32_t                                            m_BindlessSamplerSlot;
+
+    // The library reads the serialized data in place, it has to outlive the library
+    Microsoft::WRL::ComPtr<ID3D12PipelineLibrary1>      m_PipelineLibrary;
+    std::vector<uint8_t>                                m_PipelineLibraryData;
+    std::mutex                                          m_PipelineLibraryMutex;
+    bool                                                m_PipelineLibraryDirty;
 
     D3D12_FEATURE_DATA_D3D12_OPTIONS5 m_Feature5Data{}; // RayTracing, RenderPass
     D3D12_FEATURE_DATA_D3D12_OPTIONS6 m_Feature6Data{}; // VariableShadingRate
@@ -122,4 +189,26 @@ private:
     
     std::array<std::vector<ID3D12Fence*>, COMMAND_QUEUES_COUNT> m_WaitForSemaphores;
     std::array<std::vector<ID3D12Fence*>, COMMAND_QUEUES_COUNT> m_SignalSemaphores;
+
+    struct QueueFenceValue
+    {
+        RefCountPtr<D3D12TimelineFence> Fence;
+        uint64_t Value;
+    };
+    std::array<std::vector<QueueFenceValue>, COMMAND_QUEUES_COUNT> m_WaitForFences;
+    std::array<std::vector<QueueFenceValue>, COMMAND_QUEUES_COUNT> m_SignalFences;
+    // Signaled by the compute and copy queues before the direct queue runs the fix-up barriers of their command lists
+    std::array<QueueFenceValue, COMMAND_QUEUES_COUNT> m_FixupWaitFences{};
+
+    // Command lists resolve their resource states against the global states in submission order
+    struct FixupCommandList
+    {
+        RefCountPtr<D3D12CommandList> CommandList;
+        RefCountPtr<D3D12Fence> Fence;
+    };
+    std::mutex                      m_SubmitMutex;
+    std::vector<FixupCommandList>   m_FixupCommandLists;
+    std::vector<CD3DX12_RESOURCE_BARRIER> m_FixupBarriers;
+    std::vector<D3D12DescriptorRingBlock> m_SubmittedRingBlocks;
+    std::vector<ID3D12CommandList*> m_SubmitBatch;
 };
@@ -6,12 +6,15 @@
 
 RefCountPtr<RHIGraphicsPipeline> D3D12Device::CreatePipeline(const RHIGraphicsPipelineDesc& inDesc)
 {
-    RefCountPtr<RHIGraphicsPipeline> pipeline(new D3D12GraphicsPipeline(*this, inDesc));
-    if(!pipeline->Init())
+    return m_PipelineCache.FindOrCreate(inDesc, [this](const RHIGraphicsPipelineDesc& inCreateDesc)
     {
-        Log::Error("[D3D12] Failed to create graphics pipeline");
-    }
-    return pipeline;
+        RefCountPtr<RHIGraphicsPipeline> pipeline(new D3D12GraphicsPipeline(*this, inCreateDesc));
+        if(!pipeline->Init())
+        {
+            Log::Error("[D3D12] Failed to create graphics pipeline");
+        }
+        return pipeline;
+    });
 }
 
 D3D12GraphicsPipeline::D3D12GraphicsPipeline(D3D12Device& inDevice, const RHIGraphicsPipelineDesc& inDesc)
@@ -99,7 +102,7 @@ bool D3D12GraphicsPipeline::Init()
         D3D12_PIPELINE_STATE_STREAM_DESC streamDesc{};
         streamDesc.SizeInBytes = sizeof(pipelineStateDesc);
         streamDesc.pPipelineStateSubobjectStream = &pipelineStateDesc;
-        hr = m_Device.GetDevice()->CreatePipelineState(&streamDesc, IID_PPV_ARGS(&m_PipelineState));
+        hr = m_Device.CreatePipelineState(streamDesc, RHIPipelineCache::GetPersistentName(m_Desc), m_PipelineState);
     }
     else
     {
@@ -164,7 +167,7 @@ bool D3D12GraphicsPipeline::Init()
             pipelineStateDesc.RTVFormats[i] = RHI::D3D12::ConvertFormat(m_Desc.RTVFormats[i]);
         }
 
-        hr = m_Device.GetDevice()->CreateGraphicsPipelineState(&pipelineStateDesc, IID_PPV_ARGS(&m_PipelineState));
+        hr = m_Device.CreateGraphicsPipelineState(pipelineStateDesc, RHIPipelineCache::GetPersistentName(m_Desc), m_PipelineState);
     }
     if(FAILED(hr))
     {
@@ -4,18 +4,25 @@
 
 RefCountPtr<RHIPipelineBindingLayout> D3D12Device::CreatePipelineBindingLayout(const RHIPipelineBindingLayoutDesc& inBindingItems)
 {
-    RefCountPtr<RHIPipelineBindingLayout> layout(new D3D12PipelineBindingLayout(*this, inBindingItems));
-    if(!layout->Init())
+    return m_StateCache.FindOrCreate(inBindingItems, [this](const RHIPipelineBindingLayoutDesc& inDesc)
     {
-        Log::Error("Failed to create pipeline binding layout");
-    }
-    return layout;
+        RefCountPtr<RHIPipelineBindingLayout> layout(new D3D12PipelineBindingLayout(*this, inDesc));
+        if(!layout->Init())
+        {
+            Log::Error("Failed to create pipeline binding layout");
+        }
+        return layout;
+    });
 }
 
 D3D12PipelineBindingLayout::D3D12PipelineBindingLayout(D3D12Device& inDevice, const RHIPipelineBindingLayoutDesc& inBindingItems)
     : m_Device(inDevice)
     , m_Desc(inBindingItems)
     , m_RootSignature(nullptr)
+    , m_PushConstantsParameter(-1)
+    , m_NumPushConstants(0)
+    , m_BindlessResourcesParameter(-1)
+    , m_BindlessSamplersParameter(-1)
 {
     
 }
@@ -54,6 +61,21 @@ bool D3D12PipelineBindingLayout::Init()
             Log::Error("[D3D12] The root signature size exceeds the maximum size of %d DWORDs", s_RootSignatureMaxSize);
             return false;
         }
+
+        if(bindingItem.Type == ERHIBindingResourceType::PushConstants)
+        {
+            if(m_PushConstantsParameter >= 0)
+            {
+                Log::Error("[D3D12] Only one push constants item is allowed in a layout");
+                return false;
+            }
+            m_PushConstantsParameter = static_cast<int32_t>(m_RootParameters.size());
+            m_NumPushConstants = bindingItem.NumResources;
+            m_RootParameters.emplace_back();
+            m_RootParameters.back().InitAsConstants(bindingItem.NumResources, bindingItem.BaseRegister, bindingItem.Space, D3D12_SHADER_VISIBILITY_ALL);
+            totalRootSignaturesSize += static_cast<uint8_t>(std::min<uint32_t>(bindingItem.NumResources, s_RootSignatureMaxSize + 1));
+            continue;
+        }
         
         if(bindingItem.Type == ERHIBindingResourceType::Buffer_CBV && !bindingItem.IsBindless && totalCbvDescriptorsCount < s_CbvRootDescriptorsMaxCount)
         {
@@ -88,6 +110,46 @@ bool D3D12PipelineBindingLayout::Init()
         }
     }
 
+    if(m_Desc.UseBindlessTable)
+    {
+        RHIBindlessTable& bindlessTable = m_Device.GetBindlessTable();
+        if(!bindlessTable.IsValid() && !bindlessTable.Init())
+        {
+            return false;
+        }
+        if(totalDescriptorRangesCount + RHIBindlessTable::s_NumRegisterSpaces * 2 + 1 > s_RootSignatureMaxSize)
+        {
+            Log::Error("[D3D12] The layout has no room for the descriptor ranges of the bindless table");
+            return false;
+        }
+
+        // Every range starts at the start of the table, the spaces alias the same descriptors with other resource types
+        CD3DX12_DESCRIPTOR_RANGE* resourceRanges = &m_DescriptorRanges[totalDescriptorRangesCount];
+        for(uint32_t i = 0; i < RHIBindlessTable::s_NumRegisterSpaces; ++i)
+        {
+            resourceRanges[i * 2].Init(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, bindlessTable.GetNumResources(), 0, RHIBindlessTable::s_RegisterSpace + i, 0);
+            resourceRanges[i * 2 + 1].Init(D3D12_DESCRIPTOR_RANGE_TYPE_UAV, bindlessTable.GetNumResources(), 0, RHIBindlessTable::s_RegisterSpace + i, 0);
+        }
+        totalDescriptorRangesCount += RHIBindlessTable::s_NumRegisterSpaces * 2;
+        m_BindlessResourcesParameter = static_cast<int32_t>(m_RootParameters.size());
+        m_RootParameters.emplace_back();
+        m_RootParameters.back().InitAsDescriptorTable(RHIBindlessTable::s_NumRegisterSpaces * 2, resourceRanges, D3D12_SHADER_VISIBILITY_ALL);
+
+        CD3DX12_DESCRIPTOR_RANGE* samplerRange = &m_DescriptorRanges[totalDescriptorRangesCount];
+        samplerRange->Init(D3D12_DESCRIPTOR_RANGE_TYPE_SAMPLER, bindlessTable.GetNumSamplers(), 0, RHIBindlessTable::s_RegisterSpace, 0);
+        totalDescriptorRangesCount++;
+        m_BindlessSamplersParameter = static_cast<int32_t>(m_RootParameters.size());
+        m_RootParameters.emplace_back();
+        m_RootParameters.back().InitAsDescriptorTable(1, samplerRange, D3D12_SHADER_VISIBILITY_ALL);
+        totalRootSignaturesSize += 2;
+    }
+
+    if(totalRootSignaturesSize > s_RootSignatureMaxSize)
+    {
+        Log::Error("[D3D12] The root signature size exceeds the maximum size of %d DWORDs", s_RootSignatureMaxSize);
+        return false;
+    }
+
     CD3DX12_ROOT_SIGNATURE_DESC rootSignatureDesc;
     D3D12_ROOT_SIGNATURE_FLAGS rootSignatureFlags = D3D12_ROOT_SIGNATURE_FLAG_NONE;
     
@@ -20,6 +20,13 @@ public:
     const RHIPipelineBindingLayoutDesc& GetDesc() const override { return m_Desc; }
     ID3D12RootSignature* GetRootSignature() const {return m_RootSignature.Get(); }
     const std::vector<CD3DX12_ROOT_PARAMETER>& GetRootParameters() const { return m_RootParameters; }
+    // -1 if the layout has no push constants, respectively no bindless table
+    int32_t GetPushConstantsParameter() const { return m_PushConstantsParameter; }
+    uint32_t GetNumPushConstants() const { return m_NumPushConstants; }
+    int32_t GetBindlessResourcesParameter() const { return m_BindlessResourcesParameter; }
+    int32_t GetBindlessSamplersParameter() const { return m_BindlessSamplersParameter; }
+    // The bindless tables are set by the command list, not by the resource sets
+    bool IsBindlessParameter(uint32_t inIndex) const { return static_cast<int32_t>(inIndex) == m_BindlessResourcesParameter || static_cast<int32_t>(inIndex) == m_BindlessSamplersParameter; }
 
     // The maximum size of a root signature is 64 DWORDs.
     // - Descriptor tables cost 1 DWORD each.
@@ -42,6 +49,10 @@ private:
     std::array<CD3DX12_DESCRIPTOR_RANGE, s_RootSignatureMaxSize> m_DescriptorRanges;
     std::vector<CD3DX12_ROOT_PARAMETER> m_RootParameters;
     Microsoft::WRL::ComPtr<ID3D12RootSignature> m_RootSignature;
+    int32_t m_PushConstantsParameter;
+    uint32_t m_NumPushConstants;
+    int32_t m_BindlessResourcesParameter;
+    int32_t m_BindlessSamplersParameter;
 };
 
 ///////////////////////////////////////////////////////////////////////////////////
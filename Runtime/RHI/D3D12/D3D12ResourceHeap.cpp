@@ -52,7 +52,7 @@ bool D3D12ResourceHeap::Init()
     }
 
     m_TotalChunkNum = static_cast<uint32_t>(m_Desc.Size / m_Desc.Alignment);
-    m_MemAllocator.SetTotalCount(m_TotalChunkNum);
+    m_MemAllocator.SetTotalSize(m_Desc.Size);
     
     return true;
 }
@@ -64,6 +64,8 @@ void D3D12ResourceHeap::Shutdown()
 
 void D3D12ResourceHeap::ShutdownInternal()
 {
+    // Tracked objects are made resident again before they are released
+    m_Device.GetResidencyManager().Untrack(this);
     m_HeapHandle.Reset();
 }
 
@@ -81,7 +83,7 @@ void D3D12ResourceHeap::SetNameInternal()
     }
 }
 
-bool D3D12ResourceHeap::TryAllocate(size_t inSize, size_t& outOffset)
+bool D3D12ResourceHeap::TryAllocate(size_t inSize, size_t inAlignment, size_t& outOffset)
 {
     if(!IsValid())
     {
@@ -89,12 +91,10 @@ bool D3D12ResourceHeap::TryAllocate(size_t inSize, size_t& outOffset)
         return false;
     }
 
-    uint32_t chunks = static_cast<uint32_t>(Align(inSize, m_Desc.Alignment) / m_Desc.Alignment);
-    uint32_t offsetChunks = 0;
-
-    if(m_MemAllocator.TryAllocate(chunks, offsetChunks))
+    uint64_t offset = 0;
+    if(m_MemAllocator.TryAllocate(inSize, std::max<uint64_t>(inAlignment, 1), offset))
     {
-        outOffset = m_Desc.Alignment * offsetChunks;
+        outOffset = static_cast<size_t>(offset);
         return true;
     }
 
@@ -102,18 +102,25 @@ bool D3D12ResourceHeap::TryAllocate(size_t inSize, size_t& outOffset)
     return false;   
 }
 
+bool D3D12ResourceHeap::CanAllocate(size_t inSize, size_t inAlignment) const
+{
+    return IsValid() && m_MemAllocator.CanAllocate(inSize, std::max<uint64_t>(inAlignment, 1));
+}
+
 void D3D12ResourceHeap::Free(size_t inOffset, size_t inSize)
 {
-    if(inOffset % m_Desc.Alignment != 0)
+    m_MemAllocator.Free(inOffset);
+}
+
+void D3D12ResourceHeap::GetFreeRanges(std::vector<RHIMemoryRange>& outRanges) const
+{
+    std::vector<TlsfAllocator::Range> ranges;
+    m_MemAllocator.GetFreeRanges(ranges);
+    outRanges.clear();
+    for(const TlsfAllocator::Range& range : ranges)
     {
-        Log::Error("[D3D12] Free offset is not aligned to the heap's alignment: %d", m_Desc.Alignment);
-        return;
+        outRanges.push_back({range.Offset, range.Size});
     }
-    
-    uint32_t offsetChunks = static_cast<uint32_t>(inOffset / m_Desc.Alignment);
-    uint32_t chunks = static_cast<uint32_t>(Align(inSize, m_Desc.Alignment) / m_Desc.Alignment);
-
-    m_MemAllocator.Free(offsetChunks, chunks);
 }
 
 bool D3D12ResourceHeap::IsEmpty() const
@@ -3,10 +3,12 @@
 #include "D3D12PipelineState.h"
 #include "../../Core/Log.h"
 #include "../../Core/Templates.h"
+#include <algorithm>
+#include <functional>
 
-RefCountPtr<RHIResourceSet> D3D12Device::CreateResourceSet(const RHIPipelineBindingLayout* inLayout)
+RefCountPtr<RHIResourceSet> D3D12Device::CreateResourceSet(const RHIPipelineBindingLayout* inLayout, bool inIsDynamic)
 {
-    RefCountPtr<RHIResourceSet> resourceSet(new D3D12ResourceSet(*this, inLayout));
+    RefCountPtr<RHIResourceSet> resourceSet(new D3D12ResourceSet(*this, inLayout, inIsDynamic));
     if(!resourceSet->Init())
     {
         Log::Error("[D3D12] Failed to create resource set");
@@ -14,10 +16,11 @@ RefCountPtr<RHIResourceSet> D3D12Device::CreateResourceSet(const RHIPipelineBind
     return resourceSet;
 }
 
-D3D12ResourceSet::D3D12ResourceSet(D3D12Device& inDevice, const RHIPipelineBindingLayout* inLayout)
+D3D12ResourceSet::D3D12ResourceSet(D3D12Device& inDevice, const RHIPipelineBindingLayout* inLayout, bool inIsDynamic)
     : m_Device(inDevice)
     , m_Layout(inLayout)
     , m_LayoutD3D(nullptr)
+    , m_IsDynamic(inIsDynamic)
 {
     
 }
@@ -45,11 +48,27 @@ bool D3D12ResourceSet::Init()
         for(uint32_t i = 0; i < rootParameters.size(); ++i)
         {
             const CD3DX12_ROOT_PARAMETER& parameter = rootParameters[i];
-            if(parameter.ParameterType == D3D12_ROOT_PARAMETER_TYPE_DESCRIPTOR_TABLE)
+            if(m_LayoutD3D->IsBindlessParameter(i) || parameter.ParameterType == D3D12_ROOT_PARAMETER_TYPE_32BIT_CONSTANTS)
+            {
+                // Set by the command list, no bind call matches an argument without descriptors
+                D3D12ResourceArgument argument{};
+                argument.ParameterType = parameter.ParameterType;
+                argument.NumDescriptors = 0;
+                argument.GpuAddress = UINT64_MAX;
+                m_RootArguments.push_back(argument);
+            }
+            else if(parameter.ParameterType == D3D12_ROOT_PARAMETER_TYPE_DESCRIPTOR_TABLE)
             {
                 const D3D12_DESCRIPTOR_RANGE* descriptorRange = parameter.DescriptorTable.pDescriptorRanges;
                 ShaderVisibleDescriptorRange range;
-                if(descriptorRange->RangeType == D3D12_DESCRIPTOR_RANGE_TYPE_SAMPLER)
+                const bool isSampler = descriptorRange->RangeType == D3D12_DESCRIPTOR_RANGE_TYPE_SAMPLER;
+                if(m_IsDynamic)
+                {
+                    // Staged on the cpu, copied into the ring of the shader visible heap by each SetResourceSet
+                    range.Heap = m_Device.GetDescriptorManager().Allocate(isSampler ? D3D12_DESCRIPTOR_HEAP_TYPE_SAMPLER : D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV
+                        , descriptorRange->NumDescriptors, range.Slot);
+                }
+                else if(isSampler)
                 {
                     range.Heap = m_Device.GetDescriptorManager().AllocateShaderVisibleSamplers(descriptorRange->NumDescriptors, range.Slot);
                 }
@@ -57,6 +76,12 @@ bool D3D12ResourceSet::Init()
                 {
                     range.Heap = m_Device.GetDescriptorManager().AllocateShaderVisibleDescriptors(descriptorRange->NumDescriptors, range.Slot);
                 }
+                if(range.Heap == nullptr)
+                {
+                    Log::Error("[D3D12] Failed to allocate %u descriptors for the table at register %u space %u"
+                        , descriptorRange->NumDescriptors, descriptorRange->BaseShaderRegister, descriptorRange->RegisterSpace);
+                    return false;
+                }
                 range.NumDescriptors = descriptorRange->NumDescriptors;
                 m_AllocatedDescriptorRanges.push_back(range);
 
@@ -66,7 +91,7 @@ bool D3D12ResourceSet::Init()
                 argument.BaseRegister = descriptorRange->BaseShaderRegister;
                 argument.Space = descriptorRange->RegisterSpace;
                 argument.ParameterType = parameter.ParameterType;
-                argument.DescriptorTableStartHandle = range.Heap->GetGpuSlotHandle(range.Slot);
+                argument.DescriptorTableStartHandle = m_IsDynamic ? D3D12_GPU_DESCRIPTOR_HANDLE{} : range.Heap->GetGpuSlotHandle(range.Slot);
                 argument.ShaderVisibleDescriptorRangeIndex = m_AllocatedDescriptorRanges.size() - 1;
                 m_RootArguments.push_back(argument);
             }
@@ -105,6 +130,8 @@ void D3D12ResourceSet::ShutdownInternal()
     }
     m_AllocatedDescriptorRanges.clear();
     m_RootArguments.clear();
+    m_PendingWrites.clear();
+    m_ResidencyUsage.Clear();
 }
 
 void D3D12ResourceSet::BindBufferSRV(uint32_t inRegister, uint32_t inSpace, const RefCountPtr<RHIBuffer>& inBuffer)
@@ -123,6 +150,7 @@ void D3D12ResourceSet::BindBufferSRV(uint32_t inRegister, uint32_t inSpace, cons
         }
         RHIResourceGpuAddress address = inBuffer->GetGpuAddress();
         BindResource(ERHIResourceViewType::SRV, inRegister, inSpace, cpuDescriptorHandle, address);
+        m_ResidencyUsage.Bind(ERHIBindingResourceType::Buffer_SRV, inRegister, inSpace, buffer);
     }
 }
 
@@ -142,6 +170,7 @@ void D3D12ResourceSet::BindBufferUAV(uint32_t inRegister, uint32_t inSpace, cons
         }
         RHIResourceGpuAddress address = inBuffer->GetGpuAddress();
         BindResource(ERHIResourceViewType::UAV, inRegister, inSpace, cpuDescriptorHandle, address);
+        m_ResidencyUsage.Bind(ERHIBindingResourceType::Buffer_UAV, inRegister, inSpace, buffer);
     }
 }
 
@@ -161,6 +190,30 @@ void D3D12ResourceSet::BindBufferCBV(uint32_t inRegister, uint32_t inSpace, cons
         }
         RHIResourceGpuAddress address = inBuffer->GetGpuAddress();
         BindResource(ERHIResourceViewType::CBV, inRegister, inSpace, cpuDescriptorHandle, address);
+        m_ResidencyUsage.Bind(ERHIBindingResourceType::Buffer_CBV, inRegister, inSpace, buffer);
+    }
+}
+
+void D3D12ResourceSet::BindBufferCBV(uint32_t inRegister, uint32_t inSpace, const RHIConstantAllocation& inAllocation)
+{
+    if(!IsValid() || inAllocation.Buffer == nullptr)
+    {
+        return;
+    }
+    
+    for(D3D12ResourceArgument& argument : m_RootArguments)
+    {
+        if(argument.ViewType == ERHIResourceViewType::CBV && argument.NumDescriptors == 1 && argument.BaseRegister == inRegister && argument.Space == inSpace)
+        {
+            if(argument.ParameterType != D3D12_ROOT_PARAMETER_TYPE_CBV)
+            {
+                Log::Error("[D3D12] Constant allocations bind root constant buffers only, register %u space %u is in a descriptor table", inRegister, inSpace);
+                return;
+            }
+            argument.GpuAddress = inAllocation.Buffer->GetGpuAddress() + inAllocation.Offset;
+            m_ResidencyUsage.Bind(ERHIBindingResourceType::Buffer_CBV, inRegister, inSpace, inAllocation.Buffer);
+            return;
+        }
     }
 }
 
@@ -178,6 +231,7 @@ void D3D12ResourceSet::BindTextureSRV(uint32_t inRegister, uint32_t inSpace, con
             }
         }
         BindResource(ERHIResourceViewType::SRV, inRegister, inSpace, cpuDescriptorHandle, UINT64_MAX);
+        m_ResidencyUsage.Bind(ERHIBindingResourceType::Texture_SRV, inRegister, inSpace, texture);
     }
 }
 
@@ -197,6 +251,7 @@ void D3D12ResourceSet::BindBufferSRVArray(uint32_t inBaseRegister, uint32_t inSp
                 return;
             }
         }
+        m_ResidencyUsage.Bind(ERHIBindingResourceType::Buffer_SRV, inBaseRegister + i, inSpace, buffer);
     }
     BindResourceArray(ERHIResourceViewType::SRV, inBaseRegister, inSpace, handles);
 }
@@ -217,6 +272,7 @@ void D3D12ResourceSet::BindBufferUAVArray(uint32_t inBaseRegister, uint32_t inSp
                 return;
             }
         }
+        m_ResidencyUsage.Bind(ERHIBindingResourceType::Buffer_UAV, inBaseRegister + i, inSpace, buffer);
     }
     BindResourceArray(ERHIResourceViewType::UAV, inBaseRegister, inSpace, handles);
 }
@@ -237,6 +293,7 @@ void D3D12ResourceSet::BindBufferCBVArray(uint32_t inBaseRegister, uint32_t inSp
                 return;
             }
         }
+        m_ResidencyUsage.Bind(ERHIBindingResourceType::Buffer_CBV, inBaseRegister + i, inSpace, buffer);
     }
     BindResourceArray(ERHIResourceViewType::CBV, inBaseRegister, inSpace, handles);
 }
@@ -257,6 +314,7 @@ void D3D12ResourceSet::BindTextureSRVArray(uint32_t inBaseRegister, uint32_t inS
                 return;
             }
         }
+        m_ResidencyUsage.Bind(ERHIBindingResourceType::Texture_SRV, inBaseRegister + i, inSpace, texture);
     }
     BindResourceArray(ERHIResourceViewType::SRV, inBaseRegister, inSpace, handles);
 }
@@ -277,6 +335,7 @@ void D3D12ResourceSet::BindTextureUAVArray(uint32_t inBaseRegister, uint32_t inS
                 return;
             }
         }
+        m_ResidencyUsage.Bind(ERHIBindingResourceType::Texture_UAV, inBaseRegister + i, inSpace, texture);
     }
     BindResourceArray(ERHIResourceViewType::UAV, inBaseRegister, inSpace, handles);
 }
@@ -292,7 +351,7 @@ void D3D12ResourceSet::BindSamplerArray(uint32_t inBaseRegister, uint32_t inSpac
         D3D12Sampler* sampler = CheckCast<D3D12Sampler*>(inSampler[i].GetReference());
         handles[i] = sampler->GetHandle();
     }
-    BindResourceArray(ERHIResourceViewType::UAV, inBaseRegister, inSpace, handles);
+    BindResourceArray(ERHIResourceViewType::Sampler, inBaseRegister, inSpace, handles);
 }
 
 
@@ -310,6 +369,7 @@ void D3D12ResourceSet::BindTextureUAV(uint32_t inRegister, uint32_t inSpace, con
             }
         }
         BindResource(ERHIResourceViewType::UAV, inRegister, inSpace, cpuDescriptorHandle, UINT64_MAX);
+        m_ResidencyUsage.Bind(ERHIBindingResourceType::Texture_UAV, inRegister, inSpace, texture);
     }
 }
 
@@ -332,8 +392,8 @@ void D3D12ResourceSet::BindResource(ERHIResourceViewType inViewType, uint32_t in
         {
             if(argument.ParameterType == D3D12_ROOT_PARAMETER_TYPE_DESCRIPTOR_TABLE)
             {
-                ShaderVisibleDescriptorRange& range = m_AllocatedDescriptorRanges[argument.ShaderVisibleDescriptorRangeIndex];
-                m_Device.GetDescriptorManager().CopyDescriptors(range.Heap, 1, range.Slot, cpuDescriptorHandle);
+                const ShaderVisibleDescriptorRange& range = m_AllocatedDescriptorRanges[argument.ShaderVisibleDescriptorRangeIndex];
+                m_PendingWrites.push_back({range.Heap, range.Slot, cpuDescriptorHandle});
             }
             else
             {
@@ -351,17 +411,80 @@ void D3D12ResourceSet::BindResourceArray(ERHIResourceViewType inViewType, uint32
         D3D12ResourceArgument& argument = m_RootArguments[i];
         if(argument.ViewType == inViewType && argument.BaseRegister == inBaseRegister && argument.NumDescriptors >= cpuDescriptorHandles.size()  && argument.Space == inSpace)
         {
-            for(uint32_t i = 0; i < cpuDescriptorHandles.size(); i++)
+            const ShaderVisibleDescriptorRange& range = m_AllocatedDescriptorRanges[argument.ShaderVisibleDescriptorRangeIndex];
+            for(uint32_t j = 0; j < cpuDescriptorHandles.size(); j++)
             {
-                ShaderVisibleDescriptorRange& range = m_AllocatedDescriptorRanges[argument.ShaderVisibleDescriptorRangeIndex];
-                m_Device.GetDescriptorManager().CopyDescriptors(range.Heap, 1, range.Slot + i, cpuDescriptorHandles[i]);
+                m_PendingWrites.push_back({range.Heap, range.Slot + j, cpuDescriptorHandles[j]});
             }
             break;
         }
     }
 }
 
-void D3D12ResourceSet::SetGraphicsRootArguments(ID3D12GraphicsCommandList* inCmdList) const
+// The destinations of a heap type are merged into contiguous ranges, the sources may live in different cpu heaps and
+// stay single descriptor ranges
+void D3D12ResourceSet::FlushDescriptorWrites()
+{
+    if(m_PendingWrites.empty())
+    {
+        return;
+    }
+
+    // The stable sort keeps the writes to one slot in bind order, the last one wins
+    std::stable_sort(m_PendingWrites.begin(), m_PendingWrites.end(), [](const PendingDescriptorWrite& inLeft, const PendingDescriptorWrite& inRight)
+    {
+        if(inLeft.Heap->HeapType != inRight.Heap->HeapType)
+            return inLeft.Heap->HeapType < inRight.Heap->HeapType;
+        if(inLeft.Heap != inRight.Heap)
+            return std::less<const D3D12DescriptorHeap*>()(inLeft.Heap, inRight.Heap);
+        return inLeft.Slot < inRight.Slot;
+    });
+
+    std::vector<D3D12_CPU_DESCRIPTOR_HANDLE> destStarts;
+    std::vector<UINT> destSizes;
+    std::vector<D3D12_CPU_DESCRIPTOR_HANDLE> srcStarts;
+    std::vector<UINT> srcSizes;
+    size_t first = 0;
+    while(first < m_PendingWrites.size())
+    {
+        const D3D12_DESCRIPTOR_HEAP_TYPE heapType = m_PendingWrites[first].Heap->HeapType;
+        const PendingDescriptorWrite* previous = nullptr;
+        destStarts.clear();
+        destSizes.clear();
+        srcStarts.clear();
+        srcSizes.clear();
+        
+        size_t i = first;
+        for(; i < m_PendingWrites.size() && m_PendingWrites[i].Heap->HeapType == heapType; ++i)
+        {
+            const PendingDescriptorWrite& write = m_PendingWrites[i];
+            if(i + 1 < m_PendingWrites.size() && m_PendingWrites[i + 1].Heap == write.Heap && m_PendingWrites[i + 1].Slot == write.Slot)
+            {
+                continue;
+            }
+            
+            if(previous && previous->Heap == write.Heap && previous->Slot + 1 == write.Slot)
+            {
+                ++destSizes.back();
+            }
+            else
+            {
+                destStarts.push_back(write.Heap->GetCpuSlotHandle(write.Slot));
+                destSizes.push_back(1);
+            }
+            srcStarts.push_back(write.Source);
+            srcSizes.push_back(1);
+            previous = &write;
+        }
+
+        m_Device.GetDevice()->CopyDescriptors(static_cast<UINT>(destStarts.size()), destStarts.data(), destSizes.data()
+            , static_cast<UINT>(srcStarts.size()), srcStarts.data(), srcSizes.data(), heapType);
+        first = i;
+    }
+    m_PendingWrites.clear();
+}
+
+void D3D12ResourceSet::SetGraphicsRootArguments(ID3D12GraphicsCommandList* inCmdList, const D3D12_GPU_DESCRIPTOR_HANDLE* inTableHandles) const
 {
     if(IsValid())
     {
@@ -371,10 +494,14 @@ void D3D12ResourceSet::SetGraphicsRootArguments(ID3D12GraphicsCommandList* inCmd
             for(uint32_t i = 0; i < rootParameters.size(); ++i)
             {
                 const CD3DX12_ROOT_PARAMETER& parameter = rootParameters[i];
+                if(m_LayoutD3D->IsBindlessParameter(i))
+                {
+                    continue;
+                }
                 switch(parameter.ParameterType)
                 {
                 case D3D12_ROOT_PARAMETER_TYPE_DESCRIPTOR_TABLE:
-                    inCmdList->SetGraphicsRootDescriptorTable(i, m_RootArguments[i].DescriptorTableStartHandle);
+                    inCmdList->SetGraphicsRootDescriptorTable(i, inTableHandles ? inTableHandles[i] : m_RootArguments[i].DescriptorTableStartHandle);
                     break;
                 case D3D12_ROOT_PARAMETER_TYPE_CBV:
                     inCmdList->SetGraphicsRootConstantBufferView(i, m_RootArguments[i].GpuAddress);
@@ -386,8 +513,8 @@ void D3D12ResourceSet::SetGraphicsRootArguments(ID3D12GraphicsCommandList* inCmd
                     inCmdList->SetGraphicsRootUnorderedAccessView(i, m_RootArguments[i].GpuAddress);
                     break;
                 case D3D12_ROOT_PARAMETER_TYPE_32BIT_CONSTANTS:
-                    Log::Error("[D3D12] Not support root constants");
-                    return;
+                    // RHICommandList::SetPushConstants sets them
+                    break;
                 }
             }
         }
@@ -398,7 +525,7 @@ void D3D12ResourceSet::SetGraphicsRootArguments(ID3D12GraphicsCommandList* inCmd
     }
 }
 
-void D3D12ResourceSet::SetComputeRootArguments(ID3D12GraphicsCommandList* inCmdList) const
+void D3D12ResourceSet::SetComputeRootArguments(ID3D12GraphicsCommandList* inCmdList, const D3D12_GPU_DESCRIPTOR_HANDLE* inTableHandles) const
 {
     if(IsValid())
     {
@@ -408,10 +535,14 @@ void D3D12ResourceSet::SetComputeRootArguments(ID3D12GraphicsCommandList* inCmdL
             for(uint32_t i = 0; i < rootParameters.size(); ++i)
             {
                 const CD3DX12_ROOT_PARAMETER& parameter = rootParameters[i];
+                if(m_LayoutD3D->IsBindlessParameter(i))
+                {
+                    continue;
+                }
                 switch(parameter.ParameterType)
                 {
                 case D3D12_ROOT_PARAMETER_TYPE_DESCRIPTOR_TABLE:
-                    inCmdList->SetComputeRootDescriptorTable(i, m_RootArguments[i].DescriptorTableStartHandle);
+                    inCmdList->SetComputeRootDescriptorTable(i, inTableHandles ? inTableHandles[i] : m_RootArguments[i].DescriptorTableStartHandle);
                     break;
                 case D3D12_ROOT_PARAMETER_TYPE_CBV:
                     inCmdList->SetComputeRootConstantBufferView(i, m_RootArguments[i].GpuAddress);
@@ -423,8 +554,8 @@ void D3D12ResourceSet::SetComputeRootArguments(ID3D12GraphicsCommandList* inCmdL
                     inCmdList->SetComputeRootUnorderedAccessView(i, m_RootArguments[i].GpuAddress);
                     break;
                 case D3D12_ROOT_PARAMETER_TYPE_32BIT_CONSTANTS:
-                    Log::Error("[D3D12] Not support root constants");
-                    return;
+                    // RHICommandList::SetPushConstants sets them
+                    break;
                 }
             }
         }
@@ -451,5 +582,6 @@ void D3D12ResourceSet::BindAccelerationStructure(uint32_t inRegister, uint32_t i
         }
         RHIResourceGpuAddress address = buffer->GetGpuAddress();
         BindResource(ERHIResourceViewType::SRV, inRegister, inSpace, cpuDescriptorHandle, address);
+        m_ResidencyUsage.Bind(ERHIBindingResourceType::AccelerationStructure, inRegister, inSpace, buffer.GetReference());
     }
 }
\ No newline at end of file
@@ -2,8 +2,10 @@
 
 #include "D3D12DescriptorManager.h"
 #include "D3D12Definitions.h"
+#include "D3D12StateTracker.h"
 #include "../RHIResources.h"
-#include "../../Core/FreeListAllocator.h"
+#include "../RHIResidencyManager.h"
+#include "../../Core/TlsfAllocator.h"
 
 class D3D12PipelineBindingLayout;
 
@@ -18,8 +20,11 @@ public:
     void Shutdown() override;
     bool IsValid() const override;
     const RHIResourceHeapDesc& GetDesc() const override {return m_Desc;}
-    bool TryAllocate(size_t inSize, size_t& outOffset) override;
+    bool TryAllocate(size_t inSize, size_t inAlignment, size_t& outOffset) override;
+    bool CanAllocate(size_t inSize, size_t inAlignment) const override;
     void Free(size_t inOffset, size_t inSize) override;
+    size_t GetUsedSize() const override { return m_MemAllocator.GetUsedSize(); }
+    void GetFreeRanges(std::vector<RHIMemoryRange>& outRanges) const override;
     bool IsEmpty() const override;
     uint32_t GetTotalChunks() const override { return m_TotalChunkNum; }
     ID3D12Heap* GetHeap() const { return m_HeapHandle.Get(); }
@@ -36,7 +41,7 @@ private:
     RHIResourceHeapDesc m_Desc;
     Microsoft::WRL::ComPtr<ID3D12Heap> m_HeapHandle;
     uint32_t m_TotalChunkNum;
-    FreeListAllocator m_MemAllocator;
+    TlsfAllocator m_MemAllocator;
 };
 
 ///////////////////////////////////////////////////////////////////////////////////
@@ -122,6 +127,7 @@ public:
     bool IsManaged() const override { return IsManagedBuffer; }
     bool BindMemory(RefCountPtr<RHIResourceHeap> inHeap) override;
     size_t GetOffsetInHeap() const override { return m_OffsetInHeap; }
+    RHIResourceHeap* GetResourceHeap() const override { return m_ResourceHeap.GetReference(); }
     
     bool CreateCBV(D3D12_CPU_DESCRIPTOR_HANDLE& outHandle, const RHIBufferSubRange& inSubResource = RHIBufferSubRange::All);
     bool CreateSRV(D3D12_CPU_DESCRIPTOR_HANDLE& outHandle, const RHIBufferSubRange& inSubResource = RHIBufferSubRange::All);
@@ -131,8 +137,10 @@ public:
     bool TryGetSRVHandle(D3D12_CPU_DESCRIPTOR_HANDLE& outHandle, const RHIBufferSubRange& inSubResource = RHIBufferSubRange::All);
     bool TryGetUAVHandle(D3D12_CPU_DESCRIPTOR_HANDLE& outHandle, const RHIBufferSubRange& inSubResource = RHIBufferSubRange::All);
     
+    // A buffer is a single subresource, the range is ignored
     D3D12_RESOURCE_STATES GetCurrentState(const RHIBufferSubRange& inSubResource = RHIBufferSubRange::All);
     void ChangeState(D3D12_RESOURCE_STATES inAfterState, const RHIBufferSubRange& inSubResource = RHIBufferSubRange::All);
+    D3D12SubresourceStates& GetSubresourceStates() { return m_SubresourceStates; }
     
     const RHIBufferDesc& GetDesc() const override { return m_Desc; }
     uint32_t GetMemTypeFilter()  const override { return UINT32_MAX; }
@@ -167,7 +175,7 @@ private:
     std::unordered_map<RHIBufferSubRange, D3D12ResourceView<D3D12_CONSTANT_BUFFER_VIEW_DESC>> m_ConstantBufferViews;
     std::unordered_map<RHIBufferSubRange, D3D12ResourceView<D3D12_SHADER_RESOURCE_VIEW_DESC>> m_ShaderResourceViews;
     std::unordered_map<RHIBufferSubRange, D3D12ResourceView<D3D12_UNORDERED_ACCESS_VIEW_DESC>> m_UnorderedAccessViews;
-    std::unordered_map<RHIBufferSubRange, D3D12_RESOURCE_STATES> m_SubResourceStates;
+    D3D12SubresourceStates m_SubresourceStates;
 };
 
 ///////////////////////////////////////////////////////////////////////////////////
@@ -185,11 +193,13 @@ public:
     const RHIClearValue& GetClearValue() const override { return m_Desc.ClearValue; }
     bool BindMemory(RefCountPtr<RHIResourceHeap> inHeap) override;
     size_t GetOffsetInHeap() const override { return m_OffsetInHeap; }
+    RHIResourceHeap* GetResourceHeap() const override { return m_ResourceHeap.GetReference(); }
     const RHITextureDesc& GetDesc() const override { return m_Desc; }
     uint32_t GetMemTypeFilter()  const override { return UINT32_MAX; }
     size_t GetAllocSizeInByte() const override { return m_AllocationInfo.SizeInBytes; }
     size_t GetAllocAlignment() const override { return m_AllocationInfo.Alignment; }
     ID3D12Resource* GetTexture() const { return m_TextureHandle.Get(); }
+    bool IsSimultaneousAccess() const { return (m_TextureDescD3D.Flags & D3D12_RESOURCE_FLAG_ALLOW_SIMULTANEOUS_ACCESS) != 0; }
 
     bool CreateRTV(D3D12_CPU_DESCRIPTOR_HANDLE& outHandle, const RHITextureSubResource& inSubResource = RHITextureSubResource::All);
     bool CreateDSV(D3D12_CPU_DESCRIPTOR_HANDLE& outHandle, const RHITextureSubResource& inSubResource = RHITextureSubResource::All);
@@ -201,8 +211,14 @@ public:
     bool TryGetSRVHandle(D3D12_CPU_DESCRIPTOR_HANDLE& outHandle, const RHITextureSubResource& inSubResource = RHITextureSubResource::All);
     bool TryGetUAVHandle(D3D12_CPU_DESCRIPTOR_HANDLE& outHandle, const RHITextureSubResource& inSubResource = RHITextureSubResource::All);
 
+    // The state of the first subresource of the range
     D3D12_RESOURCE_STATES GetCurrentState(const RHITextureSubResource& inSubResource = RHITextureSubResource::All);
     void ChangeState(D3D12_RESOURCE_STATES inAfterState, const RHITextureSubResource& inSubResource = RHITextureSubResource::All);
+    D3D12SubresourceStates& GetSubresourceStates() { return m_SubresourceStates; }
+
+    // The subresource indices of the mip and array slice range over all planes
+    void GetSubresources(const RHITextureSubResource& inSubResource, std::vector<uint32_t>& outSubresources) const;
+    uint32_t GetNumSubresources() const;
 
     const bool IsVirtualTexture;
     const bool IsManagedTexture;
@@ -229,7 +245,7 @@ private:
     std::unordered_map<RHITextureSubResource, D3D12ResourceView<D3D12_DEPTH_STENCIL_VIEW_DESC>> m_DepthStencilViews;
     std::unordered_map<RHITextureSubResource, D3D12ResourceView<D3D12_SHADER_RESOURCE_VIEW_DESC>> m_ShaderResourceViews;
     std::unordered_map<RHITextureSubResource, D3D12ResourceView<D3D12_UNORDERED_ACCESS_VIEW_DESC>> m_UnorderedAccessViews;
-    std::unordered_map<RHITextureSubResource, D3D12_RESOURCE_STATES> m_SubResourceStates;
+    D3D12SubresourceStates m_SubresourceStates;
 };
 
 ///////////////////////////////////////////////////////////////////////////////////
@@ -331,6 +347,7 @@ public:
     void BindBufferSRV(uint32_t inRegister, uint32_t inSpace, const RefCountPtr<RHIBuffer>& inBuffer) override;
     void BindBufferUAV(uint32_t inRegister, uint32_t inSpace, const RefCountPtr<RHIBuffer>& inBuffer) override;
     void BindBufferCBV(uint32_t inRegister, uint32_t inSpace, const RefCountPtr<RHIBuffer>& inBuffer) override;
+    void BindBufferCBV(uint32_t inRegister, uint32_t inSpace, const RHIConstantAllocation& inAllocation) override;
     void BindTextureSRV(uint32_t inRegister, uint32_t inSpace, const RefCountPtr<RHITexture>& inTexture) override;
     void BindTextureUAV(uint32_t inRegister, uint32_t inSpace, const RefCountPtr<RHITexture>& inTexture) override;
     void BindSampler(uint32_t inRegister, uint32_t inSpace, const RefCountPtr<RHISampler>& inSampler) override;
@@ -343,18 +360,38 @@ public:
     void BindAccelerationStructure(uint32_t inRegister, uint32_t inSpace, const RefCountPtr<RHIAccelerationStructure>& inAccelerationStructure) override;
     
     const RHIPipelineBindingLayout* GetLayout() const override { return m_Layout; }
-    void SetGraphicsRootArguments(ID3D12GraphicsCommandList* inCmdList) const;
-    void SetComputeRootArguments(ID3D12GraphicsCommandList* inCmdList) const;
+    // inTableHandles replaces the descriptor tables of the set, indexed by root parameter
+    void SetGraphicsRootArguments(ID3D12GraphicsCommandList* inCmdList, const D3D12_GPU_DESCRIPTOR_HANDLE* inTableHandles = nullptr) const;
+    void SetComputeRootArguments(ID3D12GraphicsCommandList* inCmdList, const D3D12_GPU_DESCRIPTOR_HANDLE* inTableHandles = nullptr) const;
+
+    // The tables of a dynamic set live in cpu heaps, the command list copies them into its descriptor ring blocks
+    bool IsDynamic() const { return m_IsDynamic; }
+    const std::vector<D3D12ResourceArgument>& GetRootArguments() const { return m_RootArguments; }
+    const std::vector<ShaderVisibleDescriptorRange>& GetDescriptorRanges() const { return m_AllocatedDescriptorRanges; }
+    // The binds only record the descriptor copies, SetResourceSet flushes them with one CopyDescriptors per heap type
+    void FlushDescriptorWrites();
+    // The bound heaps and committed resources, SetResourceSet adds them to the usage of the command list
+    const RHIResidencyUsage& GetResidencyUsage() const { return m_ResidencyUsage; }
     
 private:
     friend D3D12Device;
-    D3D12ResourceSet(D3D12Device& inDevice, const RHIPipelineBindingLayout* inLayout);
+    D3D12ResourceSet(D3D12Device& inDevice, const RHIPipelineBindingLayout* inLayout, bool inIsDynamic);
     void ShutdownInternal();
     void BindResource(ERHIResourceViewType inViewType, uint32_t inRegister, uint32_t inSpace, D3D12_CPU_DESCRIPTOR_HANDLE cpuDescriptorHandle, RHIResourceGpuAddress address);
     void BindResourceArray(ERHIResourceViewType inViewType, uint32_t inBaseRegister, uint32_t inSpace, const std::vector<D3D12_CPU_DESCRIPTOR_HANDLE>& cpuDescriptorHandles);
     D3D12Device& m_Device;
     const RHIPipelineBindingLayout* m_Layout;
     const D3D12PipelineBindingLayout* m_LayoutD3D;
+    const bool m_IsDynamic;
     std::vector<ShaderVisibleDescriptorRange> m_AllocatedDescriptorRanges;
     std::vector<D3D12ResourceArgument> m_RootArguments;
+
+    struct PendingDescriptorWrite
+    {
+        const D3D12DescriptorHeap* Heap;
+        uint32_t Slot;
+        D3D12_CPU_DESCRIPTOR_HANDLE Source;
+    };
+    std::vector<PendingDescriptorWrite> m_PendingWrites;
+    RHIResidencyUsage m_ResidencyUsage;
 };
@@ -5,12 +5,15 @@
 
 RefCountPtr<RHISampler> D3D12Device::CreateSampler(const RHISamplerDesc& inDesc)
 {
-    RefCountPtr<RHISampler> sampler(new D3D12Sampler(*this, inDesc));
-    if(!sampler->Init())
+    return m_StateCache.FindOrCreate(inDesc, [this](const RHISamplerDesc& inCreateDesc)
     {
-        Log::Error("[D3D12] Failed to create sampler");
-    }
-    return sampler;
+        RefCountPtr<RHISampler> sampler(new D3D12Sampler(*this, inCreateDesc));
+        if(!sampler->Init())
+        {
+            Log::Error("[D3D12] Failed to create sampler");
+        }
+        return sampler;
+    });
 }
 
 D3D12Sampler::D3D12Sampler(D3D12Device& inDevice, const RHISamplerDesc& inDesc)
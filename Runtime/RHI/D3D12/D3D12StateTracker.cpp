@@ -0,0 +1,230 @@
+#include "D3D12StateTracker.h"
+#include "D3D12Resources.h"
+
+///////////////////////////////////////////////////////////////////////////////////
+/// D3D12SubresourceStates
+///////////////////////////////////////////////////////////////////////////////////
+void D3D12SubresourceStates::Init(uint32_t inNumSubresources, D3D12_RESOURCE_STATES inState)
+{
+    m_NumSubresources = inNumSubresources;
+    m_State = inState;
+    m_States.clear();
+}
+
+void D3D12SubresourceStates::Clear()
+{
+    m_NumSubresources = 0;
+    m_State = D3D12_RESOURCE_STATE_COMMON;
+    m_States.clear();
+}
+
+D3D12_RESOURCE_STATES D3D12SubresourceStates::Get(uint32_t inSubresource) const
+{
+    return m_States.empty() ? m_State : m_States[inSubresource];
+}
+
+void D3D12SubresourceStates::Set(uint32_t inSubresource, D3D12_RESOURCE_STATES inState)
+{
+    if(inSubresource >= m_NumSubresources)
+        return;
+    
+    if(m_States.empty())
+    {
+        if(inState == m_State)
+            return;
+        m_States.assign(m_NumSubresources, m_State);
+    }
+    m_States[inSubresource] = inState;
+
+    // Back to a single state once the subresources converge again, the common case after a mip chain was generated
+    for(D3D12_RESOURCE_STATES state : m_States)
+    {
+        if(state != inState)
+            return;
+    }
+    m_State = inState;
+    m_States.clear();
+}
+
+///////////////////////////////////////////////////////////////////////////////////
+/// D3D12StateTracker
+///////////////////////////////////////////////////////////////////////////////////
+void D3D12StateTracker::Transition(D3D12Texture* inTexture, const RHITextureSubResource& inSubResource, D3D12_RESOURCE_STATES inAfterState
+    , std::vector<CD3DX12_RESOURCE_BARRIER>& outBarriers)
+{
+    inTexture->GetSubresources(inSubResource, m_Subresources);
+    Transition(GetTrackedResource(inTexture), m_Subresources, inAfterState, outBarriers);
+}
+
+void D3D12StateTracker::Transition(D3D12Buffer* inBuffer, D3D12_RESOURCE_STATES inAfterState, std::vector<CD3DX12_RESOURCE_BARRIER>& outBarriers)
+{
+    m_Subresources.assign(1, 0);
+    Transition(GetTrackedResource(inBuffer), m_Subresources, inAfterState, outBarriers);
+}
+
+void D3D12StateTracker::Promote(D3D12Texture* inTexture, const RHITextureSubResource& inSubResource, D3D12_RESOURCE_STATES inState)
+{
+    TrackedResource& resource = GetTrackedResource(inTexture);
+    inTexture->GetSubresources(inSubResource, m_Subresources);
+    for(uint32_t subresource : m_Subresources)
+    {
+        Promote(resource.Subresources[subresource], inState);
+    }
+}
+
+void D3D12StateTracker::Promote(D3D12Buffer* inBuffer, D3D12_RESOURCE_STATES inState)
+{
+    Promote(GetTrackedResource(inBuffer).Subresources[0], inState);
+}
+
+void D3D12StateTracker::Promote(TrackedSubresource& inSubresource, D3D12_RESOURCE_STATES inState)
+{
+    if(!inSubresource.HasCurrent)
+    {
+        // Only the common state promotes implicitly, the fix-up at submit moves any other global state to inState
+        inSubresource.Expected = inState;
+        inSubresource.HasExpected = true;
+        inSubresource.IsPromoted = true;
+    }
+    inSubresource.Current = inState;
+    inSubresource.HasCurrent = true;
+}
+
+bool D3D12StateTracker::CanPromote(const TrackedResource& inResource, D3D12_RESOURCE_STATES inState)
+{
+    // Acceleration structures never leave their state
+    if((inState & D3D12_RESOURCE_STATE_RAYTRACING_ACCELERATION_STRUCTURE) != 0)
+        return false;
+    if(inResource.IsDecaying)
+        return true;
+    
+    // The states a texture in the common state is promoted to by its first access
+    constexpr D3D12_RESOURCE_STATES promotableStates = D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE | D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE
+        | D3D12_RESOURCE_STATE_COPY_DEST | D3D12_RESOURCE_STATE_COPY_SOURCE;
+    return (inState & ~promotableStates) == 0;
+}
+
+void D3D12StateTracker::Resolve(ERHICommandQueueType inQueueType, std::vector<CD3DX12_RESOURCE_BARRIER>& outBarriers)
+{
+    for(auto& [object, resource] : m_Resources)
+    {
+        m_Transitions.clear();
+        for(uint32_t i = 0; i < (uint32_t)resource.Subresources.size(); ++i)
+        {
+            TrackedSubresource& subresource = resource.Subresources[i];
+            const D3D12_RESOURCE_STATES globalState = resource.GlobalStates->Get(i);
+            if(!subresource.HasExpected || globalState == subresource.Expected)
+            {
+                // Already in the state, it was not promoted by this command list
+                subresource.IsPromoted = false;
+            }
+            else if(!subresource.IsPromoted || globalState != D3D12_RESOURCE_STATE_COMMON || !CanPromote(resource, subresource.Expected))
+            {
+                subresource.IsPromoted = false;
+                m_Transitions.push_back({i, globalState, subresource.Expected});
+            }
+        }
+        AddBarriers(resource, outBarriers);
+
+        // The decay to the common state when the command list completes
+        const bool isDecaying = inQueueType == ERHICommandQueueType::Copy || resource.IsDecaying;
+        constexpr D3D12_RESOURCE_STATES readOnlyStates = D3D12_RESOURCE_STATE_GENERIC_READ;
+        for(uint32_t i = 0; i < (uint32_t)resource.Subresources.size(); ++i)
+        {
+            const TrackedSubresource& subresource = resource.Subresources[i];
+            if(!subresource.HasCurrent)
+                continue;
+            
+            const bool isAccelerationStructure = (subresource.Current & D3D12_RESOURCE_STATE_RAYTRACING_ACCELERATION_STRUCTURE) != 0;
+            const bool isPromotedReadOnly = subresource.IsPromoted && !subresource.IsTransitioned && (subresource.Current & ~readOnlyStates) == 0;
+            resource.GlobalStates->Set(i, (isDecaying || isPromotedReadOnly) && !isAccelerationStructure ? D3D12_RESOURCE_STATE_COMMON : subresource.Current);
+        }
+    }
+    Reset();
+}
+
+void D3D12StateTracker::Reset()
+{
+    m_Resources.clear();
+    m_Transitions.clear();
+}
+
+D3D12StateTracker::TrackedResource& D3D12StateTracker::GetTrackedResource(D3D12Texture* inTexture)
+{
+    TrackedResource& resource = GetTrackedResource(inTexture, inTexture->GetTexture(), inTexture->GetSubresourceStates());
+    resource.IsDecaying = inTexture->IsSimultaneousAccess();
+    return resource;
+}
+
+D3D12StateTracker::TrackedResource& D3D12StateTracker::GetTrackedResource(D3D12Buffer* inBuffer)
+{
+    TrackedResource& resource = GetTrackedResource(inBuffer, inBuffer->GetBuffer(), inBuffer->GetSubresourceStates());
+    resource.IsDecaying = true;
+    return resource;
+}
+
+D3D12StateTracker::TrackedResource& D3D12StateTracker::GetTrackedResource(RHIObject* inObject, ID3D12Resource* inResource, D3D12SubresourceStates& inGlobalStates)
+{
+    auto iter = m_Resources.find(inObject);
+    if(iter == m_Resources.end())
+    {
+        TrackedResource resource;
+        resource.Object = inObject;
+        resource.Resource = inResource;
+        resource.GlobalStates = &inGlobalStates;
+        resource.Subresources.resize(inGlobalStates.GetNumSubresources());
+        iter = m_Resources.emplace(inObject, std::move(resource)).first;
+    }
+    return iter->second;
+}
+
+void D3D12StateTracker::Transition(TrackedResource& inResource, const std::vector<uint32_t>& inSubresources, D3D12_RESOURCE_STATES inAfterState
+    , std::vector<CD3DX12_RESOURCE_BARRIER>& outBarriers)
+{
+    m_Transitions.clear();
+    for(uint32_t subresource : inSubresources)
+    {
+        TrackedSubresource& state = inResource.Subresources[subresource];
+        if(!state.HasCurrent)
+        {
+            // The first use in this command list, the barrier is added at submit if the global state differs. The
+            // resources which always decay are promoted from the common state instead
+            state.Expected = inAfterState;
+            state.HasExpected = true;
+            state.IsPromoted = inResource.IsDecaying;
+        }
+        else if(state.Current != inAfterState)
+        {
+            m_Transitions.push_back({subresource, state.Current, inAfterState});
+            state.IsTransitioned = true;
+        }
+        state.Current = inAfterState;
+        state.HasCurrent = true;
+    }
+    AddBarriers(inResource, outBarriers);
+}
+
+void D3D12StateTracker::AddBarriers(const TrackedResource& inResource, std::vector<CD3DX12_RESOURCE_BARRIER>& outBarriers)
+{
+    if(m_Transitions.empty())
+        return;
+
+    bool allSubresources = m_Transitions.size() == inResource.Subresources.size();
+    for(size_t i = 1; i < m_Transitions.size() && allSubresources; ++i)
+    {
+        allSubresources = m_Transitions[i].Before == m_Transitions[0].Before && m_Transitions[i].After == m_Transitions[0].After;
+    }
+
+    if(allSubresources)
+    {
+        outBarriers.push_back(CD3DX12_RESOURCE_BARRIER::Transition(inResource.Resource, m_Transitions[0].Before, m_Transitions[0].After));
+    }
+    else
+    {
+        for(const PendingTransition& transition : m_Transitions)
+        {
+            outBarriers.push_back(CD3DX12_RESOURCE_BARRIER::Transition(inResource.Resource, transition.Before, transition.After, transition.Subresource));
+        }
+    }
+    m_Transitions.clear();
+}
\ No newline at end of file
@@ -0,0 +1,98 @@
+#pragma once
+
+#include "D3D12Definitions.h"
+#include "../RHIResources.h"
+#include <unordered_map>
+
+class D3D12Buffer;
+class D3D12Texture;
+
+///////////////////////////////////////////////////////////////////////////////////
+/// D3D12SubresourceStates
+///////////////////////////////////////////////////////////////////////////////////
+// The global states of the subresources of a resource, stored as a single state until the subresources diverge
+class D3D12SubresourceStates
+{
+public:
+    void Init(uint32_t inNumSubresources, D3D12_RESOURCE_STATES inState);
+    void Clear();
+    bool IsInitialized() const { return m_NumSubresources > 0; }
+    uint32_t GetNumSubresources() const { return m_NumSubresources; }
+    D3D12_RESOURCE_STATES Get(uint32_t inSubresource) const;
+    void Set(uint32_t inSubresource, D3D12_RESOURCE_STATES inState);
+
+private:
+    uint32_t m_NumSubresources = 0;
+    D3D12_RESOURCE_STATES m_State = D3D12_RESOURCE_STATE_COMMON;
+    std::vector<D3D12_RESOURCE_STATES> m_States; // empty while all subresources are in m_State
+};
+
+///////////////////////////////////////////////////////////////////////////////////
+/// D3D12StateTracker
+///////////////////////////////////////////////////////////////////////////////////
+// Tracks the states a command list moves its resources through, per mip and array slice. The global states are
+// only known at submit, so the first use of a subresource emits no barrier but records the state the command list
+// expects. D3D12Device::ExecuteCommandList resolves the expected states against the global states and executes
+// the barriers of the mismatches in a fix-up command list ahead of the command list. Transitions to the current
+// state are dropped, a transition of every subresource from the same state is a single barrier.
+// Buffers have a single subresource in D3D12, they are tracked as a whole.
+// A promoted first use of a subresource in the common state needs no fix-up barrier, the GPU promotes it. When the
+// command list completes, the buffers, the simultaneous access textures, everything a copy queue used and the
+// subresources still in the read-only state they were promoted to decay to the common state.
+class D3D12StateTracker
+{
+public:
+    void Transition(D3D12Texture* inTexture, const RHITextureSubResource& inSubResource, D3D12_RESOURCE_STATES inAfterState
+        , std::vector<CD3DX12_RESOURCE_BARRIER>& outBarriers);
+    void Transition(D3D12Buffer* inBuffer, D3D12_RESOURCE_STATES inAfterState, std::vector<CD3DX12_RESOURCE_BARRIER>& outBarriers);
+
+    // The subresources reached the state without a barrier, e.g. the implicit state promotion of a copy. On the first
+    // use in the command list the state is expected like a transition, so submit adds the barrier from the global state
+    void Promote(D3D12Texture* inTexture, const RHITextureSubResource& inSubResource, D3D12_RESOURCE_STATES inState);
+    void Promote(D3D12Buffer* inBuffer, D3D12_RESOURCE_STATES inState);
+
+    // Appends the barriers from the global states to the expected states and stores the final states of the command
+    // list after the decay as the global states. Command lists have to be resolved in submission order
+    void Resolve(ERHICommandQueueType inQueueType, std::vector<CD3DX12_RESOURCE_BARRIER>& outBarriers);
+    void Reset();
+
+private:
+    struct TrackedSubresource
+    {
+        D3D12_RESOURCE_STATES Expected = D3D12_RESOURCE_STATE_COMMON; // the state at the first use in the command list
+        D3D12_RESOURCE_STATES Current = D3D12_RESOURCE_STATE_COMMON;
+        bool HasExpected = false;
+        bool HasCurrent = false;
+        bool IsPromoted = false;    // the first use was an implicit promotion
+        bool IsTransitioned = false;
+    };
+
+    struct TrackedResource
+    {
+        RefCountPtr<RHIObject> Object; // alive until resolved
+        ID3D12Resource* Resource = nullptr;
+        D3D12SubresourceStates* GlobalStates = nullptr;
+        std::vector<TrackedSubresource> Subresources;
+        bool IsDecaying = false;    // buffers and simultaneous access textures promote to any state and always decay
+    };
+
+    struct PendingTransition
+    {
+        uint32_t Subresource;
+        D3D12_RESOURCE_STATES Before;
+        D3D12_RESOURCE_STATES After;
+    };
+
+    TrackedResource& GetTrackedResource(D3D12Texture* inTexture);
+    TrackedResource& GetTrackedResource(D3D12Buffer* inBuffer);
+    TrackedResource& GetTrackedResource(RHIObject* inObject, ID3D12Resource* inResource, D3D12SubresourceStates& inGlobalStates);
+    void Promote(TrackedSubresource& inSubresource, D3D12_RESOURCE_STATES inState);
+    static bool CanPromote(const TrackedResource& inResource, D3D12_RESOURCE_STATES inState);
+    void Transition(TrackedResource& inResource, const std::vector<uint32_t>& inSubresources, D3D12_RESOURCE_STATES inAfterState
+        , std::vector<CD3DX12_RESOURCE_BARRIER>& outBarriers);
+    void AddBarriers(const TrackedResource& inResource, std::vector<CD3DX12_RESOURCE_BARRIER>& outBarriers);
+
+    std::unordered_map<RHIObject*, TrackedResource> m_Resources;
+    std::vector<uint32_t> m_Subresources;
+    std::vector<PendingTransition> m_Transitions;
+};
\ No newline at end of file
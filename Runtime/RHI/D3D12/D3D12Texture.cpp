@@ -11,6 +11,11 @@ RefCountPtr<RHITexture> D3D12Device::CreateTexture(const RHITextureDesc& inDesc,
     {
         Log::Error("[D3D12] Failed to create texture");
     }
+    else if(!isVirtual)
+    {
+        // Committed textures are evicted by the residency manager, placed ones with their heap
+        m_ResidencyManager.Track(texture);
+    }
     return texture;
 }
 
@@ -46,6 +51,7 @@ D3D12Texture::D3D12Texture(D3D12Device& inDevice, const RHITextureDesc& inDesc,
     , m_OffsetInHeap(0)
 {
     m_TextureDescD3D = inTexture->GetDesc();
+    m_SubresourceStates.Init(GetNumSubresources(), m_InitialStates);
 }
 
 D3D12Texture::~D3D12Texture()
@@ -148,6 +154,21 @@ bool D3D12Texture::Init()
             OUTPUT_D3D12_FAILED_RESULT(hr)
             return false;
         }
+        m_SubresourceStates.Init(GetNumSubresources(), m_InitialStates);
+    }
+
+    // Placed textures without render target or depth stencil usage may use 4KB alignment instead of 64KB when they are
+    // small enough, the device reports the default alignment otherwise
+    if(IsVirtual() && m_Desc.SampleCount == 1
+        && (m_TextureDescD3D.Flags & (D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET | D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL)) == 0)
+    {
+        m_TextureDescD3D.Alignment = D3D12_SMALL_RESOURCE_PLACEMENT_ALIGNMENT;
+        m_AllocationInfo = m_Device.GetDevice()->GetResourceAllocationInfo(D3D12Device::GetNodeMask(), 1, &m_TextureDescD3D);
+        if(m_AllocationInfo.Alignment == D3D12_SMALL_RESOURCE_PLACEMENT_ALIGNMENT)
+        {
+            return true;
+        }
+        m_TextureDescD3D.Alignment = 0;
     }
 
     m_AllocationInfo = m_Device.GetDevice()->GetResourceAllocationInfo(D3D12Device::GetNodeMask(), 1, &m_TextureDescD3D);
@@ -162,6 +183,9 @@ void D3D12Texture::Shutdown()
 
 void D3D12Texture::ShutdownInternal()
 {
+    // Tracked objects are made resident again before they are released
+    m_Device.GetResidencyManager().Untrack(this);
+
     for(auto rtv : m_RenderTargetViews)
     {
         m_Device.GetDescriptorManager().Free(rtv.second.DescriptorHeap, rtv.second.Slot, 1);
@@ -191,6 +215,7 @@ void D3D12Texture::ShutdownInternal()
     }
     
     m_TextureHandle.Reset();
+    m_SubresourceStates.Clear();
 }
 
 bool D3D12Texture::BindMemory(RefCountPtr<RHIResourceHeap> inHeap)
@@ -229,7 +254,7 @@ bool D3D12Texture::BindMemory(RefCountPtr<RHIResourceHeap> inHeap)
         return false;
     }
 
-    if(!inHeap->TryAllocate(GetAllocSizeInByte(), m_OffsetInHeap))
+    if(!inHeap->TryAllocate(GetAllocSizeInByte(), GetAllocAlignment(), m_OffsetInHeap))
     {
         Log::Error("[D3D12] Failed to bind texture memory, the heap size is not enough");
         return false;
@@ -268,6 +293,7 @@ bool D3D12Texture::BindMemory(RefCountPtr<RHIResourceHeap> inHeap)
         return false;
     }
 
+    m_SubresourceStates.Init(GetNumSubresources(), m_InitialStates);
     m_ResourceHeap = inHeap;
     return true;
 }
@@ -640,32 +666,45 @@ bool D3D12Texture::TryGetUAVHandle(D3D12_CPU_DESCRIPTOR_HANDLE& outHandle, const
 
 D3D12_RESOURCE_STATES D3D12Texture::GetCurrentState(const RHITextureSubResource& inSubResource)
 {
-    auto currentStateIter = m_SubResourceStates.find(inSubResource);
-    if(currentStateIter == m_SubResourceStates.end())
-    {
-        auto allSubResourceState = m_SubResourceStates.find(RHITextureSubResource::All);
-        if(allSubResourceState == m_SubResourceStates.end())
-        {
-            m_SubResourceStates.emplace(inSubResource, m_InitialStates);
-            if(inSubResource != RHITextureSubResource::All)
-                m_SubResourceStates.emplace(inSubResource, m_InitialStates);
-            return m_InitialStates;
-        }
-        m_SubResourceStates.emplace(inSubResource, allSubResourceState->second);
-        return allSubResourceState->second;
-    }
-    return currentStateIter->second;
+    std::vector<uint32_t> subresources;
+    GetSubresources(inSubResource, subresources);
+    return subresources.empty() ? m_InitialStates : m_SubresourceStates.Get(subresources[0]);
 }
 
 void D3D12Texture::ChangeState(D3D12_RESOURCE_STATES inAfterState, const RHITextureSubResource& inSubResource)
 {
-    auto currentStateIter = m_SubResourceStates.find(inSubResource);
-    if(currentStateIter == m_SubResourceStates.end())
+    std::vector<uint32_t> subresources;
+    GetSubresources(inSubResource, subresources);
+    for(uint32_t subresource : subresources)
     {
-        m_SubResourceStates.emplace(inSubResource, inAfterState);
+        m_SubresourceStates.Set(subresource, inAfterState);
     }
-    else
+}
+
+void D3D12Texture::GetSubresources(const RHITextureSubResource& inSubResource, std::vector<uint32_t>& outSubresources) const
+{
+    const uint32_t numMipLevels = m_TextureDescD3D.MipLevels;
+    const uint32_t numArraySlices = m_TextureDescD3D.Dimension == D3D12_RESOURCE_DIMENSION_TEXTURE3D ? 1 : m_TextureDescD3D.DepthOrArraySize;
+    const uint32_t numPlanes = RHI::GetFormatInfo(m_Desc.Format).HasStencil ? 2 : 1;
+    const uint32_t lastMip = inSubResource.FirstMipSlice + std::min(inSubResource.NumMipSlices, numMipLevels - std::min(inSubResource.FirstMipSlice, numMipLevels));
+    const uint32_t lastSlice = inSubResource.FirstArraySlice + std::min(inSubResource.NumArraySlices, numArraySlices - std::min(inSubResource.FirstArraySlice, numArraySlices));
+
+    outSubresources.clear();
+    for(uint32_t plane = 0; plane < numPlanes; ++plane)
     {
-        currentStateIter->second = inAfterState;
+        for(uint32_t slice = inSubResource.FirstArraySlice; slice < lastSlice; ++slice)
+        {
+            for(uint32_t mip = inSubResource.FirstMipSlice; mip < lastMip; ++mip)
+            {
+                outSubresources.push_back(D3D12CalcSubresource(mip, slice, plane, numMipLevels, numArraySlices));
+            }
+        }
     }
 }
+
+uint32_t D3D12Texture::GetNumSubresources() const
+{
+    const uint32_t numArraySlices = m_TextureDescD3D.Dimension == D3D12_RESOURCE_DIMENSION_TEXTURE3D ? 1 : m_TextureDescD3D.DepthOrArraySize;
+    const uint32_t numPlanes = RHI::GetFormatInfo(m_Desc.Format).HasStencil ? 2 : 1;
+    return m_TextureDescD3D.MipLevels * numArraySlices * numPlanes;
+}
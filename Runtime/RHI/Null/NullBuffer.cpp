@@ -0,0 +1,211 @@
+#include <cassert>
+#include <cstring>
+
+#include "NullResources.h"
+#include "NullDevice.h"
+#include "../../Core/Log.h"
+#include "../../Core/Templates.h"
+
+RefCountPtr<RHIBuffer> NullDevice::CreateBuffer(const RHIBufferDesc& inDesc, bool isVirtual)
+{
+    RefCountPtr<RHIBuffer> buffer(new NullBuffer(*this, inDesc, isVirtual));
+    if(!buffer->Init())
+    {
+        Log::Error("[Null] Failed to create buffer");
+    }
+    else if(!isVirtual && inDesc.CpuAccess == ERHICpuAccessMode::None)
+    {
+        // Committed buffers in device local memory are evicted by the residency manager, placed ones with their heap
+        m_ResidencyManager.Track(buffer);
+    }
+    return buffer;
+}
+
+NullBuffer::NullBuffer(NullDevice& inDevice, const RHIBufferDesc& inDesc, bool isVirtual)
+    : IsVirtualBuffer(isVirtual)
+    , m_Device(inDevice)
+    , m_Desc(inDesc)
+    , m_CurrentState(ERHIResourceStates::None)
+    , m_AllocSize(0)
+    , m_AllocAlignment(65536)
+    , m_ResourceHeap(nullptr)
+    , m_OffsetInHeap(0)
+    , m_NumMapCalls(0)
+{
+    
+}
+
+NullBuffer::~NullBuffer()
+{
+    ShutdownInternal();
+}
+
+bool NullBuffer::Init()
+{
+    if(IsValid())
+    {
+        Log::Warning("[Null] Buffer already initialized.");
+        return true;
+    }
+
+    if(m_Desc.Size == 0)
+    {
+        Log::Error("[Null] Failed to create buffer, the size is zero");
+        return false;
+    }
+
+    if((m_Desc.Usages & ERHIBufferUsage::ConstantBuffer) == ERHIBufferUsage::ConstantBuffer) 
+    {
+        m_Desc.Size = Align(m_Desc.Size, static_cast<uint64_t>(256)); // Keep the same constant buffer size as the gpu backends
+    }
+
+    switch(m_Desc.CpuAccess)
+    {
+    case ERHICpuAccessMode::Read:
+        m_CurrentState = ERHIResourceStates::CopyDst;
+        break;
+    case ERHICpuAccessMode::Write:
+        m_CurrentState = ERHIResourceStates::GpuReadOnly;
+        break;
+    default:
+        m_CurrentState = ERHIResourceStates::None;
+        break;
+    }
+
+    m_AllocSize = Align(m_Desc.Size, static_cast<uint64_t>(m_AllocAlignment));
+    m_ResourceHeap.SafeRelease();
+    
+    if(!IsVirtual())
+    {
+        m_Memory.resize(m_Desc.Size, 0);
+    }
+    
+    return true;
+}
+
+void NullBuffer::Shutdown()
+{
+    ShutdownInternal();
+}
+
+void NullBuffer::ShutdownInternal()
+{
+    assert(m_NumMapCalls == 0);
+    
+    // Tracked objects are made resident again before they are released
+    m_Device.GetResidencyManager().Untrack(this);
+
+    if(m_ResourceHeap != nullptr)
+    {
+        m_ResourceHeap->Free(m_OffsetInHeap, GetAllocSizeInByte());
+        m_ResourceHeap.SafeRelease();
+        m_OffsetInHeap = 0;
+    }
+    
+    m_Memory.clear();
+    m_Memory.shrink_to_fit();
+}
+
+bool NullBuffer::IsValid() const
+{
+    if(IsVirtual())
+    {
+        return m_ResourceHeap != nullptr && m_ResourceHeap->IsValid();
+    }
+    return !m_Memory.empty();
+}
+
+bool NullBuffer::BindMemory(RefCountPtr<RHIResourceHeap> inHeap)
+{
+    if(!IsVirtual())
+    {
+        Log::Warning("[Null] Buffer is not virtual, memory binding is not allowed.");
+        return true;
+    }
+
+    if(m_ResourceHeap != nullptr)
+    {
+        Log::Warning("[Null] Buffer already bound to a heap.");
+        return true;
+    }
+
+    NullResourceHeap* heap = CheckCast<NullResourceHeap*>(inHeap.GetReference());
+
+    if(heap == nullptr || !heap->IsValid())
+    {
+        Log::Error("[Null] Failed to bind buffer memory, the heap is invalid");
+        return false;
+    }
+
+    const RHIResourceHeapDesc& heapDesc = heap->GetDesc();
+
+    if(heapDesc.Usage != ERHIHeapUsage::Buffer)
+    {
+        Log::Error("[Null] Failed to bind buffer memory, the heap is not a buffer heap");
+        return false;
+    }
+
+    if(m_Desc.CpuAccess == ERHICpuAccessMode::Write && heapDesc.Type != ERHIResourceHeapType::Upload)
+    {
+        Log::Error("[Null] Failed to bind buffer memory, the heap is not upload heap");
+        return false;
+    }
+    
+    if(m_Desc.CpuAccess == ERHICpuAccessMode::Read && heapDesc.Type != ERHIResourceHeapType::Readback)
+    {
+        Log::Error("[Null] Failed to bind buffer memory, the heap is not read back heap");
+        return false;
+    }
+    
+    if(!heap->TryAllocate(GetAllocSizeInByte(), GetAllocAlignment(), m_OffsetInHeap))
+    {
+        Log::Error("[Null] Failed to bind buffer memory, the heap size is not enough");
+        return false;
+    }
+
+    m_ResourceHeap = heap;
+    return true;
+}
+
+uint8_t* NullBuffer::GetData()
+{
+    if(m_ResourceHeap != nullptr)
+    {
+        return m_ResourceHeap->GetData(m_OffsetInHeap);
+    }
+    return m_Memory.empty() ? nullptr : m_Memory.data();
+}
+
+RHIResourceGpuAddress NullBuffer::GetGpuAddress() const
+{
+    // There is no gpu virtual address space, the cpu address is unique and stable for the lifetime of the buffer
+    return reinterpret_cast<RHIResourceGpuAddress>(const_cast<NullBuffer*>(this)->GetData());
+}
+
+void* NullBuffer::Map(uint64_t inSize, uint64_t inOffset)
+{
+    assert(IsValid());
+    assert(inOffset + inSize <= m_Desc.Size);
+    ++m_NumMapCalls;
+    return GetData();
+}
+
+void NullBuffer::Unmap()
+{
+    assert(m_NumMapCalls > 0);
+    --m_NumMapCalls;
+}
+
+void NullBuffer::WriteData(const void* inData, uint64_t inSize, uint64_t inOffset)
+{
+    uint8_t* data = static_cast<uint8_t*>(Map(inSize, inOffset));
+    memcpy(data + inOffset, inData, inSize);
+    Unmap();
+}
+
+void NullBuffer::ReadData(void* outData, uint64_t inSize, uint64_t inOffset)
+{
+    const uint8_t* data = static_cast<const uint8_t*>(Map(inSize, inOffset));
+    memcpy(outData, data + inOffset, inSize);
+    Unmap();
+}
\ No newline at end of file
@@ -0,0 +1,520 @@
+#include "NullCommandList.h"
+#include "NullResources.h"
+#include "NullPipelineState.h"
+#include "../../Core/Log.h"
+#include "../../Core/Templates.h"
+#include <cassert>
+#include <cstring>
+
+RefCountPtr<RHICommandList> NullDevice::CreateCommandList(ERHICommandQueueType inType)
+{
+    return RefCountPtr<RHICommandList>(new NullCommandList(*this, inType));
+}
+
+NullCommandList::NullCommandList(NullDevice& inDevice, ERHICommandQueueType inType)
+    : m_Device(inDevice)
+    , m_QueueType(inType)
+    , m_IsClosed(true)
+    , m_MarkDepth(0)
+{
+    
+}
+
+bool NullCommandList::IsRecording() const
+{
+    if(m_IsClosed)
+    {
+        Log::Error("[Null] Command list %s is closed, call Begin before recording commands", m_Name.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool NullCommandList::ValidateIndirectCount(const RefCountPtr<RHIBuffer>& inCommands, const RefCountPtr<RHIBuffer>& inCountBuffer
+    , uint32_t inMaxCount, size_t inStride, size_t inCommandsOffset, size_t inCountOffset) const
+{
+    if(!inCommands.IsValid() || !inCountBuffer.IsValid())
+    {
+        Log::Error("[Null] Failed to encode indirect count command, the buffers are invalid");
+        return false;
+    }
+
+    if(inMaxCount == 0 || inCommandsOffset % 4 != 0 || inCountOffset % 4 != 0)
+    {
+        Log::Error("[Null] Failed to encode indirect count command, the max count is 0 or an offset is not a multiple of 4");
+        return false;
+    }
+
+    // The gpu may write any count up to inMaxCount, every argument slot and the count itself are in bounds
+    if(inCommandsOffset + inStride * inMaxCount > inCommands->GetDesc().Size
+        || inCountOffset + sizeof(uint32_t) > inCountBuffer->GetDesc().Size)
+    {
+        Log::Error("[Null] Failed to encode indirect count command, the arguments or the count are out of bounds");
+        return false;
+    }
+
+    const ERHIBufferUsage indirectUsage = ERHIBufferUsage::IndirectCommands;
+    if((inCommands->GetDesc().Usages & indirectUsage) != indirectUsage || (inCountBuffer->GetDesc().Usages & indirectUsage) != indirectUsage)
+    {
+        Log::Error("[Null] Failed to encode indirect count command, the buffers are not created with the IndirectCommands usage");
+        return false;
+    }
+    return true;
+}
+
+void NullCommandList::Begin()
+{
+    if(m_IsClosed)
+    {
+        m_Counters = NullCommandCounters();
+        m_DeferredCopies.clear();
+        m_ResidencyUsage.Clear();
+        m_MarkDepth = 0;
+        m_IsClosed = false;
+    }
+}
+
+void NullCommandList::End()
+{
+    if(!m_IsClosed)
+    {
+        if(m_MarkDepth != 0)
+        {
+            Log::Warning("[Null] Command list %s closed with %u unbalanced marks", m_Name.c_str(), m_MarkDepth);
+        }
+        m_IsClosed = true;
+    }
+}
+
+void NullCommandList::Submit()
+{
+    for(const std::function<void()>& copy : m_DeferredCopies)
+    {
+        copy();
+    }
+}
+
+void NullCommandList::BeginMark(const char* name)
+{
+    if(IsRecording())
+    {
+        ++m_MarkDepth;
+        ++m_Counters.Marks;
+    }
+}
+
+void NullCommandList::EndMark()
+{
+    if(IsRecording())
+    {
+        assert(m_MarkDepth > 0);
+        --m_MarkDepth;
+    }
+}
+
+void NullCommandList::SetPipelineState(const RefCountPtr<RHIComputePipeline>& inPipelineState)
+{
+    if(IsRecording())
+    {
+        assert(inPipelineState.IsValid() && inPipelineState->IsValid());
+        ++m_Counters.PipelineStates;
+    }
+}
+
+void NullCommandList::SetPipelineState(const RefCountPtr<RHIGraphicsPipeline>& inPipelineState)
+{
+    if(IsRecording())
+    {
+        assert(inPipelineState.IsValid() && inPipelineState->IsValid());
+        ++m_Counters.PipelineStates;
+    }
+}
+
+void NullCommandList::SetFrameBuffer(const RefCountPtr<RHIFrameBuffer>& inFrameBuffer)
+{
+    if(IsRecording())
+    {
+        assert(inFrameBuffer.IsValid() && inFrameBuffer->IsValid());
+        m_ResidencyUsage.Add(inFrameBuffer.GetReference());
+        ++m_Counters.FrameBuffers;
+    }
+}
+
+void NullCommandList::SetFrameBuffer(const RefCountPtr<RHIFrameBuffer>& inFrameBuffer
+    , const RHIClearValue* inColor , uint32_t inNumRenderTargets)
+{
+    SetFrameBuffer(inFrameBuffer);
+}
+
+void NullCommandList::SetFrameBuffer(const RefCountPtr<RHIFrameBuffer>& inFrameBuffer
+    , const RHIClearValue* inColor , uint32_t inNumRenderTargets
+    , float inDepth, uint8_t inStencil)
+{
+    SetFrameBuffer(inFrameBuffer);
+}
+
+void NullCommandList::SetViewports(const std::vector<RHIViewport>& inViewports)
+{
+    if(IsRecording())
+    {
+        ++m_Counters.Viewports;
+    }
+}
+
+void NullCommandList::SetScissorRects(const std::vector<RHIRect>& inRects)
+{
+    if(IsRecording())
+    {
+        ++m_Counters.ScissorRects;
+    }
+}
+
+void NullCommandList::SetVertexBuffer(const RefCountPtr<RHIBuffer>& inBuffer, size_t inOffset)
+{
+    if(IsRecording())
+    {
+        assert(inBuffer.IsValid() && inOffset < inBuffer->GetDesc().Size);
+        m_ResidencyUsage.Add(inBuffer.GetReference());
+        ++m_Counters.VertexBuffers;
+    }
+}
+
+void NullCommandList::SetIndexBuffer(const RefCountPtr<RHIBuffer>& inBuffer, size_t inOffset)
+{
+    if(IsRecording())
+    {
+        assert(inBuffer.IsValid() && inOffset < inBuffer->GetDesc().Size);
+        m_ResidencyUsage.Add(inBuffer.GetReference());
+        ++m_Counters.IndexBuffers;
+    }
+}
+
+void NullCommandList::ResourceBarrier(RefCountPtr<RHITexture>& inResource , ERHIResourceStates inAfterState)
+{
+    if(IsRecording())
+    {
+        NullTexture* texture = CheckCast<NullTexture*>(inResource.GetReference());
+        m_ResidencyUsage.Add(texture);
+        if(texture && texture->GetCurrentState() != inAfterState)
+        {
+            texture->ChangeState(inAfterState);
+            ++m_Counters.Barriers;
+        }
+    }
+}
+
+// The null texture keeps a single state, a subresource transition is counted like a full one
+void NullCommandList::ResourceBarrier(RefCountPtr<RHITexture>& inResource, const RHITextureSubResource& inSubResource, ERHIResourceStates inAfterState)
+{
+    ResourceBarrier(inResource, inAfterState);
+}
+
+void NullCommandList::ResourceBarrier(RefCountPtr<RHIBuffer>& inResource, ERHIResourceStates inAfterState)
+{
+    if(IsRecording())
+    {
+        NullBuffer* buffer = CheckCast<NullBuffer*>(inResource.GetReference());
+        m_ResidencyUsage.Add(buffer);
+        if(buffer && buffer->GetCurrentState() != inAfterState)
+        {
+            buffer->ChangeState(inAfterState);
+            ++m_Counters.Barriers;
+        }
+    }
+}
+
+void NullCommandList::SetResourceSet(RefCountPtr<RHIResourceSet>& inResourceSet)
+{
+    if(IsRecording())
+    {
+        assert(inResourceSet.IsValid() && inResourceSet->IsValid());
+        m_ResidencyUsage.Add(CheckCast<NullResourceSet*>(inResourceSet.GetReference())->GetResidencyUsage());
+        ++m_Counters.ResourceSets;
+    }
+}
+
+void NullCommandList::SetPushConstants(const void* inData, uint32_t inSize)
+{
+    if(IsRecording())
+    {
+        assert(inData != nullptr && inSize > 0 && inSize % 4 == 0);
+        ++m_Counters.PushConstants;
+    }
+}
+
+void NullCommandList::CopyBuffer(RefCountPtr<RHIBuffer>& dstBuffer, size_t dstOffset, RefCountPtr<RHIBuffer>& srcBuffer, size_t srcOffset, size_t size)
+{
+    if(!IsRecording())
+    {
+        return;
+    }
+    
+    if(!dstBuffer.IsValid() || !srcBuffer.IsValid()
+        || dstOffset + size > dstBuffer->GetDesc().Size
+        || srcOffset + size > srcBuffer->GetDesc().Size)
+    {
+        Log::Error("[Null] Failed to copy buffer, the copy range is out of bounds");
+        return;
+    }
+
+    RefCountPtr<NullBuffer> dst = CheckCast<NullBuffer*>(dstBuffer.GetReference());
+    RefCountPtr<NullBuffer> src = CheckCast<NullBuffer*>(srcBuffer.GetReference());
+    m_DeferredCopies.emplace_back([=]()
+    {
+        memmove(dst->GetData() + dstOffset, src->GetData() + srcOffset, size);
+    });
+    m_ResidencyUsage.Add(dst.GetReference());
+    m_ResidencyUsage.Add(src.GetReference());
+    ++m_Counters.Copies;
+}
+
+// Copies a block aligned region between two tightly packed layouts
+static void CopyRegion(uint8_t* inDst, size_t inDstRowPitch, size_t inDstDepthPitch
+    , const uint8_t* inSrc, size_t inSrcRowPitch, size_t inSrcDepthPitch
+    , size_t inRowSize, uint32_t inNumRows, uint32_t inDepth)
+{
+    for(uint32_t z = 0; z < inDepth; ++z)
+    {
+        for(uint32_t y = 0; y < inNumRows; ++y)
+        {
+            memcpy(inDst + z * inDstDepthPitch + y * inDstRowPitch, inSrc + z * inSrcDepthPitch + y * inSrcRowPitch, inRowSize);
+        }
+    }
+}
+
+static size_t GetSliceDataOffset(const NullTexture* inTexture, const RHITextureSlice& inSlice)
+{
+    const RHIFormatInfo& formatInfo = RHI::GetFormatInfo(inTexture->GetDesc().Format);
+    const uint32_t blockSize = std::max<uint32_t>(1, formatInfo.BlockSize);
+    return inTexture->GetSliceOffset(inSlice.MipLevel, inSlice.ArraySlice)
+        + inSlice.Z * inTexture->GetDepthPitch(inSlice.MipLevel)
+        + inSlice.Y / blockSize * inTexture->GetRowPitch(inSlice.MipLevel)
+        + inSlice.X / blockSize * static_cast<size_t>(formatInfo.BytesPerBlock);
+}
+
+void NullCommandList::CopyTexture(RefCountPtr<RHITexture>& dstTexture, RefCountPtr<RHITexture>& srcTexture)
+{
+    if(!IsRecording())
+    {
+        return;
+    }
+
+    if(!dstTexture.IsValid() || !srcTexture.IsValid() || dstTexture->GetAllocSizeInByte() != srcTexture->GetAllocSizeInByte())
+    {
+        Log::Error("[Null] Failed to copy texture, the textures are not the same size");
+        return;
+    }
+
+    RefCountPtr<NullTexture> dst = CheckCast<NullTexture*>(dstTexture.GetReference());
+    RefCountPtr<NullTexture> src = CheckCast<NullTexture*>(srcTexture.GetReference());
+    m_DeferredCopies.emplace_back([=]()
+    {
+        memcpy(dst->GetData(), src->GetData(), src->GetAllocSizeInByte());
+    });
+    m_ResidencyUsage.Add(dst.GetReference());
+    m_ResidencyUsage.Add(src.GetReference());
+    ++m_Counters.Copies;
+}
+
+void NullCommandList::CopyTexture(RefCountPtr<RHITexture>& dstTexture, const RHITextureSlice& dstSlice, RefCountPtr<RHITexture>& srcTexture, const RHITextureSlice& srcSlice)
+{
+    if(!IsRecording())
+    {
+        return;
+    }
+
+    if(!dstTexture.IsValid() || !srcTexture.IsValid() || dstTexture->GetDesc().Format != srcTexture->GetDesc().Format)
+    {
+        Log::Error("[Null] Failed to copy texture, the textures must have the same format");
+        return;
+    }
+
+    RefCountPtr<NullTexture> dst = CheckCast<NullTexture*>(dstTexture.GetReference());
+    RefCountPtr<NullTexture> src = CheckCast<NullTexture*>(srcTexture.GetReference());
+    const RHIFormatInfo& formatInfo = RHI::GetFormatInfo(dst->GetDesc().Format);
+    const uint32_t blockSize = std::max<uint32_t>(1, formatInfo.BlockSize);
+    const uint32_t width = std::min(dstSlice.Width, srcSlice.Width);
+    const uint32_t height = std::min(dstSlice.Height, srcSlice.Height);
+    const uint32_t depth = std::min(dstSlice.Depth, srcSlice.Depth);
+    const size_t rowSize = static_cast<size_t>((width + blockSize - 1) / blockSize) * formatInfo.BytesPerBlock;
+    const uint32_t numRows = (height + blockSize - 1) / blockSize;
+    const size_t dstOffset = GetSliceDataOffset(dst, dstSlice);
+    const size_t srcOffset = GetSliceDataOffset(src, srcSlice);
+    const uint32_t dstMip = dstSlice.MipLevel;
+    const uint32_t srcMip = srcSlice.MipLevel;
+    
+    m_DeferredCopies.emplace_back([=]()
+    {
+        CopyRegion(dst->GetData() + dstOffset, dst->GetRowPitch(dstMip), dst->GetDepthPitch(dstMip)
+            , src->GetData() + srcOffset, src->GetRowPitch(srcMip), src->GetDepthPitch(srcMip)
+            , rowSize, numRows, depth);
+    });
+    m_ResidencyUsage.Add(dst.GetReference());
+    m_ResidencyUsage.Add(src.GetReference());
+    ++m_Counters.Copies;
+}
+
+void NullCommandList::CopyBufferToTexture(RefCountPtr<RHITexture>& dstTexture, RefCountPtr<RHIBuffer>& srcBuffer)
+{
+    if(!IsRecording())
+    {
+        return;
+    }
+
+    if(!dstTexture.IsValid() || !srcBuffer.IsValid())
+    {
+        Log::Error("[Null] Failed to copy buffer to texture, the resources are invalid");
+        return;
+    }
+
+    RefCountPtr<NullTexture> dst = CheckCast<NullTexture*>(dstTexture.GetReference());
+    RefCountPtr<NullBuffer> src = CheckCast<NullBuffer*>(srcBuffer.GetReference());
+    const size_t size = std::min<size_t>(src->GetDesc().Size, dst->GetSliceOffset(0, dst->GetDesc().ArraySize));
+    m_DeferredCopies.emplace_back([=]()
+    {
+        memcpy(dst->GetData(), src->GetData(), size);
+    });
+    m_ResidencyUsage.Add(dst.GetReference());
+    m_ResidencyUsage.Add(src.GetReference());
+    ++m_Counters.Copies;
+}
+
+void NullCommandList::CopyBufferToTexture(RefCountPtr<RHITexture>& dstTexture, const RHITextureSlice& dstSlice, RefCountPtr<RHIBuffer>& srcBuffer, size_t srcOffset)
+{
+    if(!IsRecording())
+    {
+        return;
+    }
+
+    if(!dstTexture.IsValid() || !srcBuffer.IsValid())
+    {
+        Log::Error("[Null] Failed to copy buffer to texture, the resources are invalid");
+        return;
+    }
+    
+    RefCountPtr<NullTexture> dst = CheckCast<NullTexture*>(dstTexture.GetReference());
+    RefCountPtr<NullBuffer> src = CheckCast<NullBuffer*>(srcBuffer.GetReference());
+    const RHIFormatInfo& formatInfo = RHI::GetFormatInfo(dst->GetDesc().Format);
+    const uint32_t blockSize = std::max<uint32_t>(1, formatInfo.BlockSize);
+    const size_t rowSize = static_cast<size_t>((dstSlice.Width + blockSize - 1) / blockSize) * formatInfo.BytesPerBlock;
+    const uint32_t numRows = (dstSlice.Height + blockSize - 1) / blockSize;
+    const uint32_t depth = dstSlice.Depth;
+    
+    if(srcOffset + rowSize * numRows * depth > src->GetDesc().Size)
+    {
+        Log::Error("[Null] Failed to copy buffer to texture, the buffer is too small");
+        return;
+    }
+
+    const size_t dstOffset = GetSliceDataOffset(dst, dstSlice);
+    const uint32_t dstMip = dstSlice.MipLevel;
+    m_DeferredCopies.emplace_back([=]()
+    {
+        CopyRegion(dst->GetData() + dstOffset, dst->GetRowPitch(dstMip), dst->GetDepthPitch(dstMip)
+            , src->GetData() + srcOffset, rowSize, rowSize * numRows
+            , rowSize, numRows, depth);
+    });
+    m_ResidencyUsage.Add(dst.GetReference());
+    m_ResidencyUsage.Add(src.GetReference());
+    ++m_Counters.Copies;
+}
+
+void NullCommandList::Draw(uint32_t vertexCount, uint32_t instanceCount, uint32_t vertexOffset, uint32_t firstInstance)
+{
+    if(IsRecording())
+    {
+        ++m_Counters.Draws;
+    }
+}
+
+void NullCommandList::DrawIndirect(RefCountPtr<RHIBuffer>& indirectCommands, uint32_t drawCount, size_t commandsBufferOffset)
+{
+    if(IsRecording())
+    {
+        assert(indirectCommands.IsValid());
+        m_ResidencyUsage.Add(indirectCommands.GetReference());
+        ++m_Counters.DrawsIndirect;
+    }
+}
+
+void NullCommandList::DrawIndexed(uint32_t indexCount, uint32_t instanceCount, uint32_t firstIndex, uint32_t vertexOffset, uint32_t firstInstance)
+{
+    if(IsRecording())
+    {
+        ++m_Counters.Draws;
+    }
+}
+
+void NullCommandList::DrawIndexedIndirect(RefCountPtr<RHIBuffer>& indirectCommands, uint32_t drawCount, size_t commandsBufferOffset)
+{
+    if(IsRecording())
+    {
+        assert(indirectCommands.IsValid());
+        m_ResidencyUsage.Add(indirectCommands.GetReference());
+        ++m_Counters.DrawsIndirect;
+    }
+}
+
+void NullCommandList::DrawIndexedIndirectCount(RefCountPtr<RHIBuffer>& indirectCommands, RefCountPtr<RHIBuffer>& countBuffer, uint32_t maxDrawCount, size_t commandsBufferOffset, size_t countBufferOffset)
+{
+    if(IsRecording() && ValidateIndirectCount(indirectCommands, countBuffer, maxDrawCount, sizeof(RHIDrawIndexedArguments), commandsBufferOffset, countBufferOffset))
+    {
+        m_ResidencyUsage.Add(indirectCommands.GetReference());
+        m_ResidencyUsage.Add(countBuffer.GetReference());
+        ++m_Counters.DrawsIndirectCount;
+    }
+}
+
+void NullCommandList::Dispatch(uint32_t threadGroupX, uint32_t threadGroupY, uint32_t threadGroupZ)
+{
+    if(IsRecording())
+    {
+        ++m_Counters.Dispatches;
+    }
+}
+
+void NullCommandList::DispatchIndirect(RefCountPtr<RHIBuffer>& indirectCommands, uint32_t count, size_t commandsBufferOffset)
+{
+    if(IsRecording())
+    {
+        assert(indirectCommands.IsValid());
+        m_ResidencyUsage.Add(indirectCommands.GetReference());
+        ++m_Counters.DispatchesIndirect;
+    }
+}
+
+void NullCommandList::DispatchMesh(uint32_t threadGroupX, uint32_t threadGroupY, uint32_t threadGroupZ)
+{
+    if(IsRecording())
+    {
+        ++m_Counters.MeshDispatches;
+    }
+}
+
+void NullCommandList::DispatchMeshIndirect(RefCountPtr<RHIBuffer>& indirectCommands, uint32_t count, size_t commandsBufferOffset)
+{
+    if(IsRecording())
+    {
+        assert(indirectCommands.IsValid());
+        m_ResidencyUsage.Add(indirectCommands.GetReference());
+        ++m_Counters.MeshDispatchesIndirect;
+    }
+}
+
+void NullCommandList::DispatchMeshIndirectCount(RefCountPtr<RHIBuffer>& indirectCommands, RefCountPtr<RHIBuffer>& countBuffer, uint32_t maxCount, size_t commandsBufferOffset, size_t countBufferOffset)
+{
+    if(IsRecording() && ValidateIndirectCount(indirectCommands, countBuffer, maxCount, sizeof(RHIDispatchArguments), commandsBufferOffset, countBufferOffset))
+    {
+        m_ResidencyUsage.Add(indirectCommands.GetReference());
+        m_ResidencyUsage.Add(countBuffer.GetReference());
+        ++m_Counters.MeshDispatchesIndirectCount;
+    }
+}
+
+void NullCommandList::DispatchRays(uint32_t width, uint32_t height, uint32_t depth, const RHIShaderTable& shaderTable)
+{
+    if(IsRecording())
+    {
+        ++m_Counters.DispatchRays;
+    }
+}
\ No newline at end of file
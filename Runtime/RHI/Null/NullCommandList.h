@@ -0,0 +1,74 @@
+#pragma once
+#include "../RHICommandList.h"
+#include "NullDevice.h"
+#include <functional>
+
+class NullCommandList : public RHICommandList
+{
+public:
+    ~NullCommandList() override = default;
+    bool Init() override { return true; }
+    bool IsValid() const override { return true; }
+
+    void BeginMark(const char* name) override;
+    void EndMark() override;
+    void Begin() override;
+    void End() override;
+    
+    void SetPipelineState(const RefCountPtr<RHIComputePipeline>& inPipelineState) override;
+    void SetPipelineState(const RefCountPtr<RHIGraphicsPipeline>& inPipelineState) override;
+    void SetFrameBuffer(const RefCountPtr<RHIFrameBuffer>& inFrameBuffer) override;
+    void SetFrameBuffer(const RefCountPtr<RHIFrameBuffer>& inFrameBuffer
+        , const RHIClearValue* inColor , uint32_t inNumRenderTargets) override;
+    void SetFrameBuffer(const RefCountPtr<RHIFrameBuffer>& inFrameBuffer
+        , const RHIClearValue* inColor , uint32_t inNumRenderTargets
+        , float inDepth, uint8_t inStencil) override;
+    void SetViewports(const std::vector<RHIViewport>& inViewports) override;
+    void SetScissorRects(const std::vector<RHIRect>& inRects) override;
+    void SetVertexBuffer(const RefCountPtr<RHIBuffer>& inBuffer, size_t inOffset = 0) override;
+    void SetIndexBuffer(const RefCountPtr<RHIBuffer>& inBuffer, size_t inOffset = 0) override;
+    void ResourceBarrier(RefCountPtr<RHITexture>& inResource , ERHIResourceStates inAfterState) override;
+    void ResourceBarrier(RefCountPtr<RHITexture>& inResource, const RHITextureSubResource& inSubResource, ERHIResourceStates inAfterState) override;
+    void ResourceBarrier(RefCountPtr<RHIBuffer>& inResource, ERHIResourceStates inAfterState) override;
+    void SetResourceSet(RefCountPtr<RHIResourceSet>& inResourceSet) override;
+    void SetPushConstants(const void* inData, uint32_t inSize) override;
+    void CopyBuffer(RefCountPtr<RHIBuffer>& dstBuffer, size_t dstOffset, RefCountPtr<RHIBuffer>& srcBuffer, size_t srcOffset, size_t size) override;
+    void CopyTexture(RefCountPtr<RHITexture>& dstTexture, RefCountPtr<RHITexture>& srcTexture) override;
+    void CopyTexture(RefCountPtr<RHITexture>& dstTexture, const RHITextureSlice& dstSlice, RefCountPtr<RHITexture>& srcTexture, const RHITextureSlice& srcSlice) override;
+    void CopyBufferToTexture(RefCountPtr<RHITexture>& dstTexture, RefCountPtr<RHIBuffer>& srcBuffer) override;
+    void CopyBufferToTexture(RefCountPtr<RHITexture>& dstTexture, const RHITextureSlice& dstSlice, RefCountPtr<RHIBuffer>& srcBuffer, size_t srcOffset) override;
+    void Draw(uint32_t vertexCount, uint32_t instanceCount, uint32_t vertexOffset = 0, uint32_t firstInstance = 0) override;
+    void DrawIndirect(RefCountPtr<RHIBuffer>& indirectCommands, uint32_t drawCount, size_t commandsBufferOffset = 0) override;
+    void DrawIndexed(uint32_t indexCount, uint32_t instanceCount, uint32_t firstIndex = 0, uint32_t vertexOffset = 0, uint32_t firstInstance = 0) override;
+    void DrawIndexedIndirect(RefCountPtr<RHIBuffer>& indirectCommands, uint32_t drawCount, size_t commandsBufferOffset = 0) override;
+    void DrawIndexedIndirectCount(RefCountPtr<RHIBuffer>& indirectCommands, RefCountPtr<RHIBuffer>& countBuffer, uint32_t maxDrawCount, size_t commandsBufferOffset = 0, size_t countBufferOffset = 0) override;
+    void Dispatch(uint32_t threadGroupX, uint32_t threadGroupY, uint32_t threadGroupZ) override;
+    void DispatchIndirect(RefCountPtr<RHIBuffer>& indirectCommands, uint32_t count, size_t commandsBufferOffset = 0) override;
+    void DispatchMesh(uint32_t threadGroupX, uint32_t threadGroupY, uint32_t threadGroupZ) override;
+    void DispatchMeshIndirect(RefCountPtr<RHIBuffer>& indirectCommands, uint32_t count, size_t commandsBufferOffset = 0) override;
+    void DispatchMeshIndirectCount(RefCountPtr<RHIBuffer>& indirectCommands, RefCountPtr<RHIBuffer>& countBuffer, uint32_t maxCount, size_t commandsBufferOffset = 0, size_t countBufferOffset = 0) override;
+    void DispatchRays(uint32_t width, uint32_t height, uint32_t depth, const RHIShaderTable& shaderTable) override;
+    bool IsClosed() const override { return m_IsClosed; }
+    ERHICommandQueueType GetQueueType() const override { return m_QueueType; }
+
+    const NullCommandCounters& GetCounters() const { return m_Counters; }
+    const RHIResidencyUsage& GetResidencyUsage() const { return m_ResidencyUsage; }
+    
+private:
+    friend class NullDevice;
+    NullCommandList(NullDevice& inDevice, ERHICommandQueueType inType);
+    bool IsRecording() const;
+    // Checks what the backends leave to the debug layers, the count itself is only known on the gpu
+    bool ValidateIndirectCount(const RefCountPtr<RHIBuffer>& inCommands, const RefCountPtr<RHIBuffer>& inCountBuffer
+        , uint32_t inMaxCount, size_t inStride, size_t inCommandsOffset, size_t inCountOffset) const;
+    // Copies see the data the resources hold when the list is executed, the same as on the gpu queues
+    void Submit();
+
+    NullDevice& m_Device;
+    const ERHICommandQueueType m_QueueType;
+    bool m_IsClosed;
+    uint32_t m_MarkDepth;
+    NullCommandCounters m_Counters;
+    std::vector<std::function<void()>> m_DeferredCopies;
+    RHIResidencyUsage m_ResidencyUsage;
+};
\ No newline at end of file
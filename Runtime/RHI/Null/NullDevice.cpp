@@ -0,0 +1,382 @@
+#include "NullDevice.h"
+#include "NullCommandList.h"
+#include "../../Core/Log.h"
+#include "../../Core/Templates.h"
+#include <thread>
+
+NullCommandCounters& NullCommandCounters::operator+=(const NullCommandCounters& inOther)
+{
+    PipelineStates += inOther.PipelineStates;
+    FrameBuffers += inOther.FrameBuffers;
+    Viewports += inOther.Viewports;
+    ScissorRects += inOther.ScissorRects;
+    Barriers += inOther.Barriers;
+    ResourceSets += inOther.ResourceSets;
+    PushConstants += inOther.PushConstants;
+    VertexBuffers += inOther.VertexBuffers;
+    IndexBuffers += inOther.IndexBuffers;
+    Copies += inOther.Copies;
+    Draws += inOther.Draws;
+    DrawsIndirect += inOther.DrawsIndirect;
+    DrawsIndirectCount += inOther.DrawsIndirectCount;
+    Dispatches += inOther.Dispatches;
+    DispatchesIndirect += inOther.DispatchesIndirect;
+    MeshDispatches += inOther.MeshDispatches;
+    MeshDispatchesIndirect += inOther.MeshDispatchesIndirect;
+    MeshDispatchesIndirectCount += inOther.MeshDispatchesIndirectCount;
+    DispatchRays += inOther.DispatchRays;
+    Marks += inOther.Marks;
+    return *this;
+}
+
+NullDevice::NullDevice()
+    : m_IsValid(false)
+    , m_NumWaitForSemaphores{}
+    , m_NumSignalSemaphores{}
+    , m_NumSemaphoreWaits(0)
+    , m_NumSemaphoreSignals(0)
+    , m_SimulatedGpuTime(0)
+    , m_SimulatedMemoryBudget(0)
+    , m_NumEvictedObjects(0)
+    , m_NumMadeResidentObjects(0)
+    , m_NumBindlessResources(0)
+    , m_NumBindlessSamplers(0)
+{
+    
+}
+
+NullDevice::~NullDevice()
+{
+    ShutdownInternal();
+}
+
+bool NullDevice::Init()
+{
+    if(IsValid())
+    {
+        Log::Warning("[Null] Device already initialized");
+        return true;
+    }
+    
+    ResetStats();
+    m_IsValid = true;
+    Log::Info("[Null] Device initialized, no commands will reach a gpu");
+    return true;
+}
+
+void NullDevice::Shutdown()
+{
+    ShutdownInternal();
+}
+
+void NullDevice::ShutdownInternal()
+{
+    m_FrameContext.Shutdown();
+    m_CommandListPool.Clear();
+    m_BindlessTable.Shutdown();
+    m_Defragmenter.Clear();
+    m_MemoryAllocator.Clear();
+    m_ResidencyManager.Clear();
+    m_ConstantAllocator.Shutdown();
+    m_UploadRing.Shutdown();
+    m_PipelineCompiler.Shutdown();
+    m_PipelineCache.Clear();
+    m_StateCache.Clear();
+    for(auto& fences : m_WaitForFences)
+    {
+        fences.clear();
+    }
+    for(auto& fences : m_SignalFences)
+    {
+        fences.clear();
+    }
+    m_NumBindlessResources = 0;
+    m_NumBindlessSamplers = 0;
+    m_IsValid = false;
+}
+
+void NullDevice::ResetStats()
+{
+    m_NumWaitForSemaphores.fill(0);
+    m_NumSignalSemaphores.fill(0);
+    m_ExecutedCounters = NullCommandCounters();
+    m_SubmitStats = RHISubmitStats();
+    m_NumSemaphoreWaits = 0;
+    m_NumSemaphoreSignals = 0;
+    m_NumEvictedObjects = 0;
+    m_NumMadeResidentObjects = 0;
+}
+
+RefCountPtr<RHIFence> NullDevice::CreateRhiFence()
+{
+    return RefCountPtr<RHIFence>(new NullFence());
+}
+
+RefCountPtr<RHISemaphore> NullDevice::CreateRhiSemaphore()
+{
+    return RefCountPtr<RHISemaphore>(new NullSemaphore());
+}
+
+RefCountPtr<RHITimelineFence> NullDevice::CreateTimelineFence(uint64_t inInitialValue)
+{
+    return RefCountPtr<RHITimelineFence>(new NullTimelineFence(inInitialValue));
+}
+
+void NullDevice::AddQueueWaitForSemaphore(ERHICommandQueueType inType, RefCountPtr<RHISemaphore>& inSemaphore)
+{
+    if(inSemaphore.IsValid())
+    {
+        ++m_NumWaitForSemaphores[static_cast<uint32_t>(inType)];
+    }
+}
+
+void NullDevice::AddQueueSignalSemaphore(ERHICommandQueueType inType, RefCountPtr<RHISemaphore>& inSemaphore)
+{
+    if(inSemaphore.IsValid())
+    {
+        ++m_NumSignalSemaphores[static_cast<uint32_t>(inType)];
+    }
+}
+
+void NullDevice::AddQueueWaitForFence(ERHICommandQueueType inType, RefCountPtr<RHITimelineFence>& inFence, uint64_t inValue)
+{
+    NullTimelineFence* nullFence = CheckCast<NullTimelineFence*>(inFence.GetReference());
+    if(nullFence)
+    {
+        m_WaitForFences[static_cast<uint32_t>(inType)].push_back({nullFence, inValue});
+    }
+}
+
+void NullDevice::AddQueueSignalFence(ERHICommandQueueType inType, RefCountPtr<RHITimelineFence>& inFence, uint64_t inValue)
+{
+    NullTimelineFence* nullFence = CheckCast<NullTimelineFence*>(inFence.GetReference());
+    if(nullFence)
+    {
+        m_SignalFences[static_cast<uint32_t>(inType)].push_back({nullFence, inValue});
+    }
+}
+
+void NullDevice::ExecuteCommandLists(const RefCountPtr<RHICommandList>* inCommandLists, uint32_t inCount
+    , const RHIQueueFenceValue* inWaitFences, uint32_t inNumWaitFences
+    , const RHIQueueFenceValue* inSignalFences, uint32_t inNumSignalFences
+    , const RefCountPtr<RHIFence>& inSignalFence)
+{
+    if(inCount == 0)
+    {
+        return;
+    }
+    
+    const ERHICommandQueueType queueType = inCommandLists[0]->GetQueueType();
+    for(uint32_t i = 0; i < inCount; ++i)
+    {
+        NullCommandList* commandList = CheckCast<NullCommandList*>(inCommandLists[i].GetReference());
+        if(commandList == nullptr || !commandList->IsValid() || commandList->GetQueueType() != queueType)
+        {
+            Log::Error("[Null] The command list %u is invalid or belongs to another queue than the first one", i);
+            return;
+        }
+    }
+
+    const uint32_t queueIndex = static_cast<uint32_t>(queueType);
+    for(uint32_t i = 0; i < inNumWaitFences; ++i)
+    {
+        RefCountPtr<RHITimelineFence> fence = inWaitFences[i].Fence;
+        AddQueueWaitForFence(queueType, fence, inWaitFences[i].Value);
+    }
+    for(uint32_t i = 0; i < inNumSignalFences; ++i)
+    {
+        RefCountPtr<RHITimelineFence> fence = inSignalFences[i].Fence;
+        AddQueueSignalFence(queueType, fence, inSignalFences[i].Value);
+    }
+    // The pooled lists are reused once the queue finished this submit
+    RHIQueueFenceValue poolSignal;
+    if(m_CommandListPool.GetExecuteSignal(inCommandLists, inCount, poolSignal))
+    {
+        AddQueueSignalFence(queueType, poolSignal.Fence, poolSignal.Value);
+    }
+    
+    // The queues execute in submission order, immediately unless a gpu time is simulated
+    for(uint32_t i = 0; i < inCount; ++i)
+    {
+        NullCommandList* commandList = CheckCast<NullCommandList*>(inCommandLists[i].GetReference());
+        if(!commandList->IsClosed())
+        {
+            commandList->End();
+        }
+        m_ResidencyManager.MarkUsed(commandList->GetResidencyUsage());
+        commandList->Submit();
+        m_ExecutedCounters += commandList->GetCounters();
+    }
+    ++m_SubmitStats.Submits;
+    m_SubmitStats.CommandLists += inCount;
+    
+    std::chrono::steady_clock::time_point startTime = std::max(m_GpuIdleTime, std::chrono::steady_clock::now());
+    for(const QueueFenceValue& waitFence : m_WaitForFences[queueIndex])
+    {
+        std::chrono::steady_clock::time_point completionTime;
+        if(waitFence.Fence->GetCompletionTime(waitFence.Value, completionTime))
+        {
+            startTime = std::max(startTime, completionTime);
+        }
+        else
+        {
+            // A gpu queue would wait forever, the null queue runs the commands anyway
+            Log::Warning("[Null] The queue waits for the fence value %llu which is never signaled", waitFence.Value);
+        }
+    }
+    m_GpuIdleTime = startTime + m_SimulatedGpuTime * inCount;
+
+    if(inSignalFence != nullptr && inSignalFence->IsValid())
+    {
+        CheckCast<NullFence*>(inSignalFence.GetReference())->Signal(m_GpuIdleTime);
+    }
+    for(const QueueFenceValue& signalFence : m_SignalFences[queueIndex])
+    {
+        signalFence.Fence->QueueSignal(signalFence.Value, m_GpuIdleTime);
+    }
+    m_WaitForFences[queueIndex].clear();
+    m_SignalFences[queueIndex].clear();
+
+    m_NumSemaphoreWaits += m_NumWaitForSemaphores[queueIndex];
+    m_NumSemaphoreSignals += m_NumSignalSemaphores[queueIndex];
+    m_NumWaitForSemaphores[queueIndex] = 0;
+    m_NumSignalSemaphores[queueIndex] = 0;
+}
+
+bool NullDevice::QueryMemoryBudget(RHIMemoryBudget& outBudget)
+{
+    if(m_SimulatedMemoryBudget == 0)
+    {
+        return false;
+    }
+    outBudget.Budget = m_SimulatedMemoryBudget;
+    outBudget.Usage = 0;
+    return true;
+}
+
+bool NullDevice::EvictObjects(const RHIResidencyObject* inObjects, uint32_t inCount)
+{
+    m_NumEvictedObjects += inCount;
+    return true;
+}
+
+bool NullDevice::MakeObjectsResident(const RHIResidencyObject* inObjects, uint32_t inCount)
+{
+    m_NumMadeResidentObjects += inCount;
+    return true;
+}
+
+bool NullDevice::InitBindlessTable(uint32_t inNumResources, uint32_t inNumSamplers)
+{
+    m_NumBindlessResources = inNumResources;
+    m_NumBindlessSamplers = inNumSamplers;
+    return true;
+}
+
+bool NullDevice::WriteBindlessDescriptor(uint32_t inIndex, const RHIBindlessDescriptor& inDescriptor)
+{
+    const uint32_t numDescriptors = inDescriptor.Type == ERHIBindingResourceType::Sampler ? m_NumBindlessSamplers : m_NumBindlessResources;
+    return inIndex < numDescriptors && inDescriptor.Object != nullptr;
+}
+
+void NullFence::CpuWait()
+{
+    if(m_IsSignaled)
+    {
+        std::this_thread::sleep_until(m_CompletionTime);
+    }
+}
+
+bool NullFence::IsCompleted()
+{
+    return m_IsSignaled && std::chrono::steady_clock::now() >= m_CompletionTime;
+}
+
+void NullTimelineFence::Signal(uint64_t inValue)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_CompletedValue = std::max(m_CompletedValue, inValue);
+    }
+    m_Signaled.notify_all();
+}
+
+uint64_t NullTimelineFence::GetCompletedValue()
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    RetireInternal(std::chrono::steady_clock::now());
+    return m_CompletedValue;
+}
+
+bool NullTimelineFence::Wait(uint64_t inValue, uint64_t inTimeoutMs)
+{
+    const auto now = std::chrono::steady_clock::now();
+    const auto deadline = inTimeoutMs == UINT64_MAX
+        ? std::chrono::steady_clock::time_point::max()
+        : now + std::chrono::milliseconds(inTimeoutMs);
+    
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    while(true)
+    {
+        const auto current = std::chrono::steady_clock::now();
+        RetireInternal(current);
+        if(m_CompletedValue >= inValue)
+        {
+            return true;
+        }
+        if(current >= deadline)
+        {
+            return false;
+        }
+
+        // Sleeps until the next queue signal completes or the cpu signals
+        auto wakeTime = deadline;
+        if(!m_PendingSignals.empty())
+        {
+            wakeTime = std::min(wakeTime, m_PendingSignals.front().CompletionTime);
+        }
+        if(wakeTime == std::chrono::steady_clock::time_point::max())
+        {
+            m_Signaled.wait(lock);
+        }
+        else
+        {
+            m_Signaled.wait_until(lock, wakeTime);
+        }
+    }
+}
+
+void NullTimelineFence::QueueSignal(uint64_t inValue, std::chrono::steady_clock::time_point inCompletionTime)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_PendingSignals.push_back({inCompletionTime, inValue});
+}
+
+bool NullTimelineFence::GetCompletionTime(uint64_t inValue, std::chrono::steady_clock::time_point& outTime)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    RetireInternal(std::chrono::steady_clock::now());
+    if(m_CompletedValue >= inValue)
+    {
+        outTime = std::chrono::steady_clock::time_point::min();
+        return true;
+    }
+    for(const PendingSignal& signal : m_PendingSignals)
+    {
+        if(signal.Value >= inValue)
+        {
+            outTime = signal.CompletionTime;
+            return true;
+        }
+    }
+    return false;
+}
+
+void NullTimelineFence::RetireInternal(std::chrono::steady_clock::time_point inNow)
+{
+    while(!m_PendingSignals.empty() && m_PendingSignals.front().CompletionTime <= inNow)
+    {
+        m_CompletedValue = std::max(m_CompletedValue, m_PendingSignals.front().Value);
+        m_PendingSignals.pop_front();
+    }
+}
\ No newline at end of file
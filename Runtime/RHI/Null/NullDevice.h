@@ -0,0 +1,200 @@
+#pragma once
+#include "../RHIDevice.h"
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
+class NullBuffer;
+class NullTexture;
+class NullCommandList;
+
+// Counts of the commands recorded into a null command list, the device accumulates the counts of executed lists
+struct NullCommandCounters
+{
+    uint64_t PipelineStates = 0;
+    uint64_t FrameBuffers = 0;
+    uint64_t Viewports = 0;
+    uint64_t ScissorRects = 0;
+    uint64_t Barriers = 0;
+    uint64_t ResourceSets = 0;
+    uint64_t PushConstants = 0;
+    uint64_t VertexBuffers = 0;
+    uint64_t IndexBuffers = 0;
+    uint64_t Copies = 0;
+    uint64_t Draws = 0;
+    uint64_t DrawsIndirect = 0;
+    uint64_t DrawsIndirectCount = 0;
+    uint64_t Dispatches = 0;
+    uint64_t DispatchesIndirect = 0;
+    uint64_t MeshDispatches = 0;
+    uint64_t MeshDispatchesIndirect = 0;
+    uint64_t MeshDispatchesIndirectCount = 0;
+    uint64_t DispatchRays = 0;
+    uint64_t Marks = 0;
+
+    uint64_t GetTotal() const
+    {
+        return PipelineStates + FrameBuffers + Viewports + ScissorRects + Barriers + ResourceSets + PushConstants + VertexBuffers
+            + IndexBuffers + Copies + Draws + DrawsIndirect + DrawsIndirectCount + Dispatches + DispatchesIndirect + MeshDispatches + MeshDispatchesIndirect
+            + MeshDispatchesIndirectCount + DispatchRays + Marks;
+    }
+    
+    NullCommandCounters& operator+=(const NullCommandCounters& inOther);
+};
+
+class NullFence : public RHIFence
+{
+public:
+    ~NullFence() override = default;
+    bool Init() override { return true; }
+    void Shutdown() override {}
+    bool IsValid() const override { return true; }
+    void Reset() override { m_IsSignaled = false; }
+    // Sleeps until the simulated gpu time of the signaling submission passed, without simulated gpu time the null
+    // queues complete the work on submission and the fence is signaled when waited on
+    void CpuWait() override;
+    bool IsCompleted() override;
+
+    bool IsSignaled() const { return m_IsSignaled; }
+
+private:
+    friend class NullDevice;
+    NullFence() : m_IsSignaled(false) {}
+    void Signal(std::chrono::steady_clock::time_point inCompletionTime) { m_IsSignaled = true; m_CompletionTime = inCompletionTime; }
+    
+    bool m_IsSignaled;
+    std::chrono::steady_clock::time_point m_CompletionTime;
+};
+
+class NullTimelineFence : public RHITimelineFence
+{
+public:
+    ~NullTimelineFence() override = default;
+    bool Init() override { return true; }
+    void Shutdown() override {}
+    bool IsValid() const override { return true; }
+    void Signal(uint64_t inValue) override;
+    uint64_t GetCompletedValue() override;
+    bool Wait(uint64_t inValue, uint64_t inTimeoutMs = UINT64_MAX) override;
+
+private:
+    friend class NullDevice;
+    explicit NullTimelineFence(uint64_t inInitialValue) : m_CompletedValue(inInitialValue) {}
+    // The queue signals complete at the simulated gpu time of their submission
+    void QueueSignal(uint64_t inValue, std::chrono::steady_clock::time_point inCompletionTime);
+    // When a queue signal reaches inValue, false if nothing submitted or signaled reaches it
+    bool GetCompletionTime(uint64_t inValue, std::chrono::steady_clock::time_point& outTime);
+    void RetireInternal(std::chrono::steady_clock::time_point inNow);
+
+    struct PendingSignal
+    {
+        std::chrono::steady_clock::time_point CompletionTime;
+        uint64_t Value;
+    };
+
+    std::mutex m_Mutex;
+    std::condition_variable m_Signaled;
+    uint64_t m_CompletedValue;
+    std::deque<PendingSignal> m_PendingSignals; // in completion order, the null gpu executes one submission at a time
+};
+
+class NullSemaphore : public RHISemaphore
+{
+public:
+    ~NullSemaphore() override = default;
+    bool Init() override { return true; }
+    void Shutdown() override {}
+    bool IsValid() const override { return true; }
+    void Reset() override {}
+
+private:
+    friend class NullDevice;
+    NullSemaphore() = default;
+};
+
+// A device without gpu, resources live in cpu memory and command lists only count the recorded commands.
+// Used to run the rhi, rdg and app code headless for testing and benchmarking
+class NullDevice : public RHIDevice
+{
+public:
+    ~NullDevice() override;
+    bool Init() override;
+    void Shutdown() override;
+    bool IsValid() const override { return m_IsValid; }
+    
+    RefCountPtr<RHIFence>       CreateRhiFence() override;
+    RefCountPtr<RHISemaphore>   CreateRhiSemaphore() override;
+    RefCountPtr<RHITimelineFence> CreateTimelineFence(uint64_t inInitialValue = 0) override;
+    RefCountPtr<RHICommandList> CreateCommandList(ERHICommandQueueType inType = ERHICommandQueueType::Direct) override;
+    RefCountPtr<RHIPipelineBindingLayout> CreatePipelineBindingLayout(const RHIPipelineBindingLayoutDesc& inBindingItems) override;
+    RefCountPtr<RHIShader> CreateShader(ERHIShaderType inType) override;
+    RefCountPtr<RHIComputePipeline> CreatePipeline(const RHIComputePipelineDesc& inDesc) override;
+    RefCountPtr<RHIGraphicsPipeline> CreatePipeline(const RHIGraphicsPipelineDesc& inDesc) override;
+    RefCountPtr<RHIResourceHeap> CreateResourceHeap(const RHIResourceHeapDesc& inDesc) override;
+    RefCountPtr<RHIBuffer> CreateBuffer(const RHIBufferDesc& inDesc, bool isVirtual = false) override;
+    RefCountPtr<RHITexture> CreateTexture(const RHITextureDesc& inDesc, bool isVirtual = false) override;
+    RefCountPtr<RHISampler> CreateSampler(const RHISamplerDesc& inDesc) override;
+    RefCountPtr<RHIAccelerationStructure> CreateBottomLevelAccelerationStructure(const std::vector<RHIRayTracingGeometryDesc>& inDesc) override;
+    RefCountPtr<RHIAccelerationStructure> CreateTopLevelAccelerationStructure(const std::vector<RHIRayTracingInstanceDesc>& inDesc) override;
+    RefCountPtr<RHIFrameBuffer> CreateFrameBuffer(const RHIFrameBufferDesc& inDesc) override;
+    RefCountPtr<RHIResourceSet> CreateResourceSet(const RHIPipelineBindingLayout* inLayout, bool inIsDynamic = false) override;
+    void AddQueueWaitForSemaphore(ERHICommandQueueType inType, RefCountPtr<RHISemaphore>& inSemaphore) override;
+    void AddQueueSignalSemaphore(ERHICommandQueueType inType, RefCountPtr<RHISemaphore>& inSemaphore) override;
+    void AddQueueWaitForFence(ERHICommandQueueType inType, RefCountPtr<RHITimelineFence>& inFence, uint64_t inValue) override;
+    void AddQueueSignalFence(ERHICommandQueueType inType, RefCountPtr<RHITimelineFence>& inFence, uint64_t inValue) override;
+    void ExecuteCommandLists(const RefCountPtr<RHICommandList>* inCommandLists, uint32_t inCount
+        , const RHIQueueFenceValue* inWaitFences = nullptr, uint32_t inNumWaitFences = 0
+        , const RHIQueueFenceValue* inSignalFences = nullptr, uint32_t inNumSignalFences = 0
+        , const RefCountPtr<RHIFence>& inSignalFence = nullptr) override;
+    bool QueryMemoryBudget(RHIMemoryBudget& outBudget) override;
+    bool EvictObjects(const RHIResidencyObject* inObjects, uint32_t inCount) override;
+    bool MakeObjectsResident(const RHIResidencyObject* inObjects, uint32_t inCount) override;
+    bool InitBindlessTable(uint32_t inNumResources, uint32_t inNumSamplers) override;
+    bool WriteBindlessDescriptor(uint32_t inIndex, const RHIBindlessDescriptor& inDescriptor) override;
+    
+    ERHIBackend GetBackend() const override { return ERHIBackend::Null; }
+    uint32_t GetTextureDataPitchAlignment() const override { return 1; }
+
+    const NullCommandCounters& GetExecutedCommandCounters() const { return m_ExecutedCounters; }
+    uint64_t GetNumSemaphoreWaits() const { return m_NumSemaphoreWaits; }
+    uint64_t GetNumSemaphoreSignals() const { return m_NumSemaphoreSignals; }
+    void ResetStats();
+
+    // Every executed command list keeps the simulated gpu busy for inTime after the previous one finished, the fences signal
+    // once it would have completed. Used to measure how much the cpu and gpu work of frames overlap
+    void SetSimulatedGpuTime(std::chrono::microseconds inTime) { m_SimulatedGpuTime = inTime; }
+
+    // The budget QueryMemoryBudget reports, 0 reports no budget. The usage is left to the residency manager
+    void SetSimulatedMemoryBudget(uint64_t inBudget) { m_SimulatedMemoryBudget = inBudget; }
+    uint64_t GetNumEvictedObjects() const { return m_NumEvictedObjects; }
+    uint64_t GetNumMadeResidentObjects() const { return m_NumMadeResidentObjects; }
+
+private:
+    friend bool RHI::Init(ERHIBackend inBackend);
+    NullDevice();
+    void ShutdownInternal();
+
+    bool m_IsValid;
+    std::array<uint32_t, static_cast<uint8_t>(ERHICommandQueueType::Count)> m_NumWaitForSemaphores;
+    std::array<uint32_t, static_cast<uint8_t>(ERHICommandQueueType::Count)> m_NumSignalSemaphores;
+    NullCommandCounters m_ExecutedCounters;
+    uint64_t m_NumSemaphoreWaits;
+    uint64_t m_NumSemaphoreSignals;
+    std::chrono::microseconds m_SimulatedGpuTime;
+    std::chrono::steady_clock::time_point m_GpuIdleTime;
+    uint64_t m_SimulatedMemoryBudget;
+    uint64_t m_NumEvictedObjects;
+    uint64_t m_NumMadeResidentObjects;
+    uint32_t m_NumBindlessResources;
+    uint32_t m_NumBindlessSamplers;
+
+    struct QueueFenceValue
+    {
+        RefCountPtr<NullTimelineFence> Fence;
+        uint64_t Value;
+    };
+    std::array<std::vector<QueueFenceValue>, static_cast<uint8_t>(ERHICommandQueueType::Count)> m_WaitForFences;
+    std::array<std::vector<QueueFenceValue>, static_cast<uint8_t>(ERHICommandQueueType::Count)> m_SignalFences;
+};
\ No newline at end of file
@@ -0,0 +1,180 @@
+#include "NullPipelineState.h"
+#include "NullResources.h"
+#include "NullDevice.h"
+#include "../../Core/Log.h"
+
+RefCountPtr<RHIPipelineBindingLayout> NullDevice::CreatePipelineBindingLayout(const RHIPipelineBindingLayoutDesc& inBindingItems)
+{
+    return m_StateCache.FindOrCreate(inBindingItems, [](const RHIPipelineBindingLayoutDesc& inDesc)
+    {
+        return RefCountPtr<RHIPipelineBindingLayout>(new NullPipelineBindingLayout(inDesc));
+    });
+}
+
+RefCountPtr<RHIShader> NullDevice::CreateShader(ERHIShaderType inType)
+{
+    return RefCountPtr<RHIShader>(new NullShader(inType));
+}
+
+///////////////////////////////////////////////////////////////////////////////////
+/// NullComputePipeline
+///////////////////////////////////////////////////////////////////////////////////
+RefCountPtr<RHIComputePipeline> NullDevice::CreatePipeline(const RHIComputePipelineDesc& inDesc)
+{
+    return m_PipelineCache.FindOrCreate(inDesc, [](const RHIComputePipelineDesc& inCreateDesc)
+    {
+        RefCountPtr<RHIComputePipeline> pipeline(new NullComputePipeline(inCreateDesc));
+        if(!pipeline->Init())
+        {
+            Log::Error("[Null] Failed to create compute pipeline");
+        }
+        return pipeline;
+    });
+}
+
+bool NullComputePipeline::Init()
+{
+    if(IsValid())
+    {
+        Log::Warning("[Null] Compute pipeline already initialized.");
+        return true;
+    }
+
+    if(m_Desc.ComputeShader == nullptr || m_Desc.ComputeShader->GetType() != ERHIShaderType::Compute)
+    {
+        Log::Error("[Null] Failed to create compute pipeline, the compute shader is invalid");
+        return false;
+    }
+
+    if(m_Desc.BindingLayout == nullptr)
+    {
+        Log::Error("[Null] Failed to create compute pipeline, the binding layout is null");
+        return false;
+    }
+
+    m_IsValid = true;
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////////
+/// NullGraphicsPipeline
+///////////////////////////////////////////////////////////////////////////////////
+RefCountPtr<RHIGraphicsPipeline> NullDevice::CreatePipeline(const RHIGraphicsPipelineDesc& inDesc)
+{
+    return m_PipelineCache.FindOrCreate(inDesc, [](const RHIGraphicsPipelineDesc& inCreateDesc)
+    {
+        RefCountPtr<RHIGraphicsPipeline> pipeline(new NullGraphicsPipeline(inCreateDesc));
+        if(!pipeline->Init())
+        {
+            Log::Error("[Null] Failed to create graphics pipeline");
+        }
+        return pipeline;
+    });
+}
+
+bool NullGraphicsPipeline::Init()
+{
+    if(IsValid())
+    {
+        Log::Warning("[Null] Graphics pipeline already initialized.");
+        return true;
+    }
+
+    if(m_Desc.UsingMeshShader ? m_Desc.MeshShader == nullptr : m_Desc.VertexShader == nullptr)
+    {
+        Log::Error("[Null] Failed to create graphics pipeline, the %s shader is null", m_Desc.UsingMeshShader ? "mesh" : "vertex");
+        return false;
+    }
+    
+    if(m_Desc.NumRenderTarget > RHIRenderTargetsMaxCount)
+    {
+        Log::Error("[Null] Failed to create graphics pipeline, too many render targets: %u", m_Desc.NumRenderTarget);
+        return false;
+    }
+
+    m_IsValid = true;
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////////
+/// NullFrameBuffer
+///////////////////////////////////////////////////////////////////////////////////
+RefCountPtr<RHIFrameBuffer> NullDevice::CreateFrameBuffer(const RHIFrameBufferDesc& inDesc)
+{
+    RefCountPtr<RHIFrameBuffer> frameBuffer(new NullFrameBuffer(inDesc));
+    if(!frameBuffer->Init())
+    {
+        Log::Error("[Null] Failed to create frame buffer");
+    }
+    return frameBuffer;
+}
+
+NullFrameBuffer::NullFrameBuffer(const RHIFrameBufferDesc& inDesc)
+    : m_Desc(inDesc)
+    , m_IsValid(false)
+    , m_FrameBufferWidth(0)
+    , m_FrameBufferHeight(0)
+    , m_NumRenderTargets(0)
+{
+    
+}
+
+bool NullFrameBuffer::Init()
+{
+    if(IsValid())
+    {
+        Log::Warning("[Null] FrameBuffer already initialized.");
+        return true;
+    }
+
+    if(m_Desc.PipelineState == nullptr)
+    {
+        Log::Error("[Null] Failed to create frame buffer, the pipeline state is null");
+        return false;
+    }
+
+    m_NumRenderTargets = m_Desc.PipelineState->GetDesc().NumRenderTarget;
+
+    for(uint32_t i = 0; i < m_NumRenderTargets; ++i)
+    {
+        if(!m_Desc.RenderTargets[i] || !m_Desc.RenderTargets[i]->IsValid())
+        {
+            Log::Error("[Null] Render target %u is invalid", i);
+            return false;
+        }
+        m_FrameBufferWidth = m_Desc.RenderTargets[i]->GetDesc().Width;
+        m_FrameBufferHeight = m_Desc.RenderTargets[i]->GetDesc().Height;
+    }
+
+    if(m_Desc.DepthStencil)
+    {
+        if(!m_Desc.DepthStencil->IsValid())
+        {
+            Log::Error("[Null] Depth stencil is invalid");
+            return false;
+        }
+        m_FrameBufferWidth = m_Desc.DepthStencil->GetDesc().Width;
+        m_FrameBufferHeight = m_Desc.DepthStencil->GetDesc().Height;
+    }
+
+    m_IsValid = true;
+    return true;
+}
+
+ERHIFormat NullFrameBuffer::GetRenderTargetFormat(uint32_t inIndex) const
+{
+    if(inIndex < m_NumRenderTargets && m_Desc.RenderTargets[inIndex] != nullptr)
+    {
+        return m_Desc.RenderTargets[inIndex]->GetDesc().Format;
+    }
+    return ERHIFormat::Unknown;
+}
+
+ERHIFormat NullFrameBuffer::GetDepthStencilFormat() const
+{
+    if(HasDepthStencil())
+    {
+        return m_Desc.DepthStencil->GetDesc().Format;
+    }
+    return ERHIFormat::Unknown;
+}
\ No newline at end of file
@@ -0,0 +1,122 @@
+#pragma once
+
+#include "../RHIPipelineState.h"
+
+class NullDevice;
+class NullTexture;
+
+///////////////////////////////////////////////////////////////////////////////////
+/// NullPipelineBindingLayout
+///////////////////////////////////////////////////////////////////////////////////
+class NullPipelineBindingLayout : public RHIPipelineBindingLayout
+{
+public:
+    ~NullPipelineBindingLayout() override = default;
+    const RHIPipelineBindingLayoutDesc& GetDesc() const override { return m_Desc; }
+    
+private:
+    friend NullDevice;
+    NullPipelineBindingLayout(const RHIPipelineBindingLayoutDesc& inDesc) : m_Desc(inDesc) {}
+    
+    RHIPipelineBindingLayoutDesc m_Desc;
+};
+
+///////////////////////////////////////////////////////////////////////////////////
+/// NullShader
+///////////////////////////////////////////////////////////////////////////////////
+class NullShader : public RHIShader
+{
+public:
+    ~NullShader() override = default;
+    bool Init() override { return true; }
+    void Shutdown() override {}
+    // The byte code is never consumed, an empty shader is still a valid null shader
+    bool IsValid() const override { return true; }
+
+    ERHIShaderType GetType() const override {return m_Type;}
+    void SetEntryName(const char* inName) override { m_EntryName = inName; }
+    const std::string& GetEntryName() const override { return m_EntryName; }
+    std::shared_ptr<Blob> GetByteCode() const override {return m_ShaderBlob;}
+    void SetByteCode(std::shared_ptr<Blob> inByteCode) override { m_ShaderBlob = inByteCode; }
+    const uint8_t* GetData() const override { return m_ShaderBlob ? m_ShaderBlob->GetData() : nullptr; }
+    size_t GetSize() const override { return m_ShaderBlob ? m_ShaderBlob->GetSize() : 0; }
+
+private:
+    friend NullDevice;
+    NullShader(ERHIShaderType inType)
+        : m_Type(inType)
+        , m_EntryName("main")
+        , m_ShaderBlob(nullptr) {}
+
+    ERHIShaderType m_Type;
+    std::string m_EntryName;
+    std::shared_ptr<Blob> m_ShaderBlob;
+};
+
+///////////////////////////////////////////////////////////////////////////////////
+/// NullComputePipeline
+///////////////////////////////////////////////////////////////////////////////////
+class NullComputePipeline : public RHIComputePipeline
+{
+public:
+    ~NullComputePipeline() override = default;
+    bool Init() override;
+    bool IsValid() const override { return m_IsValid; }
+    const RHIComputePipelineDesc& GetDesc() const override { return m_Desc; }
+    
+private:
+    friend NullDevice;
+    NullComputePipeline(const RHIComputePipelineDesc& inDesc) : m_Desc(inDesc), m_IsValid(false) {}
+    
+    RHIComputePipelineDesc m_Desc;
+    bool m_IsValid;
+};
+
+///////////////////////////////////////////////////////////////////////////////////
+/// NullGraphicsPipeline
+///////////////////////////////////////////////////////////////////////////////////
+class NullGraphicsPipeline : public RHIGraphicsPipeline
+{
+public:
+    ~NullGraphicsPipeline() override = default;
+    bool Init() override;
+    bool IsValid() const override { return m_IsValid; }
+    const RHIGraphicsPipelineDesc& GetDesc() const override { return m_Desc; }
+    
+private:
+    friend NullDevice;
+    NullGraphicsPipeline(const RHIGraphicsPipelineDesc& inDesc) : m_Desc(inDesc), m_IsValid(false) {}
+    
+    RHIGraphicsPipelineDesc m_Desc;
+    bool m_IsValid;
+};
+
+///////////////////////////////////////////////////////////////////////////////////
+/// NullFrameBuffer
+///////////////////////////////////////////////////////////////////////////////////
+class NullFrameBuffer : public RHIFrameBuffer
+{
+public:
+    ~NullFrameBuffer() override = default;
+    bool Init() override;
+    bool IsValid() const override { return m_IsValid; }
+    const RHIFrameBufferDesc& GetDesc() const override { return m_Desc; }
+    uint32_t GetFrameBufferWidth() const override { return m_FrameBufferWidth; }
+    uint32_t GetFrameBufferHeight() const override { return m_FrameBufferHeight; }
+    uint32_t GetNumRenderTargets() const override { return m_NumRenderTargets; }
+    const RHITexture* GetRenderTarget(uint32_t inIndex) const override { return m_Desc.RenderTargets[inIndex]; }
+    const RHITexture* GetDepthStencil() const override { return m_Desc.DepthStencil; }
+    bool HasDepthStencil() const override { return m_Desc.DepthStencil != nullptr; }
+    ERHIFormat GetRenderTargetFormat(uint32_t inIndex) const override;
+    ERHIFormat GetDepthStencilFormat() const override;
+    
+private:
+    friend NullDevice;
+    NullFrameBuffer(const RHIFrameBufferDesc& inDesc);
+
+    RHIFrameBufferDesc m_Desc;
+    bool m_IsValid;
+    uint32_t m_FrameBufferWidth;
+    uint32_t m_FrameBufferHeight;
+    uint32_t m_NumRenderTargets;
+};
\ No newline at end of file
@@ -0,0 +1,330 @@
+#include "NullResources.h"
+#include "NullDevice.h"
+#include "../../Core/Log.h"
+#include "../../Core/Templates.h"
+
+///////////////////////////////////////////////////////////////////////////////////
+/// NullResourceHeap
+///////////////////////////////////////////////////////////////////////////////////
+RefCountPtr<RHIResourceHeap> NullDevice::CreateResourceHeap(const RHIResourceHeapDesc& inDesc)
+{
+    RefCountPtr<RHIResourceHeap> heap(new NullResourceHeap(*this, inDesc));
+    if(!heap->Init())
+    {
+        Log::Error("[Null] Failed to create resource heap");
+    }
+    return heap;
+}
+
+NullResourceHeap::NullResourceHeap(NullDevice& inDevice, const RHIResourceHeapDesc& inDesc)
+    : m_Device(inDevice)
+    , m_Desc(inDesc)
+    , m_TotalChunkNum(0)
+{
+    
+}
+
+NullResourceHeap::~NullResourceHeap()
+{
+    ShutdownInternal();
+}
+
+bool NullResourceHeap::Init()
+{
+    if(IsValid())
+    {
+        Log::Warning("[Null] Resource Heap already initialized.");
+        return true;
+    }
+
+    if(m_Desc.Size == 0 || m_Desc.Alignment == 0)
+    {
+        Log::Error("[Null] Failed to create resource heap, the size and alignment must not be zero");
+        return false;
+    }
+
+    m_Desc.Size = Align(m_Desc.Size, m_Desc.Alignment);
+    m_Memory.resize(m_Desc.Size);
+    m_TotalChunkNum = static_cast<uint32_t>(m_Desc.Size / m_Desc.Alignment);
+    m_MemAllocator.SetTotalSize(m_Desc.Size);
+    
+    return true;
+}
+
+void NullResourceHeap::Shutdown()
+{
+    ShutdownInternal();
+}
+
+void NullResourceHeap::ShutdownInternal()
+{
+    // Tracked objects are made resident again before they are released
+    m_Device.GetResidencyManager().Untrack(this);
+    m_Memory.clear();
+    m_Memory.shrink_to_fit();
+    m_MemAllocator.SetTotalSize(0);
+    m_TotalChunkNum = 0;
+}
+
+bool NullResourceHeap::IsValid() const
+{
+    return !m_Memory.empty();
+}
+
+bool NullResourceHeap::TryAllocate(size_t inSize, size_t inAlignment, size_t& outOffset)
+{
+    if(!IsValid())
+    {
+        outOffset = UINT64_MAX;
+        return false;
+    }
+
+    uint64_t offset = 0;
+    if(m_MemAllocator.TryAllocate(inSize, std::max<uint64_t>(inAlignment, 1), offset))
+    {
+        outOffset = static_cast<size_t>(offset);
+        return true;
+    }
+
+    outOffset = UINT64_MAX;
+    return false;   
+}
+
+bool NullResourceHeap::CanAllocate(size_t inSize, size_t inAlignment) const
+{
+    return IsValid() && m_MemAllocator.CanAllocate(inSize, std::max<uint64_t>(inAlignment, 1));
+}
+
+void NullResourceHeap::Free(size_t inOffset, size_t inSize)
+{
+    m_MemAllocator.Free(inOffset);
+}
+
+void NullResourceHeap::GetFreeRanges(std::vector<RHIMemoryRange>& outRanges) const
+{
+    std::vector<TlsfAllocator::Range> ranges;
+    m_MemAllocator.GetFreeRanges(ranges);
+    outRanges.clear();
+    for(const TlsfAllocator::Range& range : ranges)
+    {
+        outRanges.push_back({range.Offset, range.Size});
+    }
+}
+
+bool NullResourceHeap::IsEmpty() const
+{
+    return m_MemAllocator.IsEmpty();
+}
+
+///////////////////////////////////////////////////////////////////////////////////
+/// NullSampler
+///////////////////////////////////////////////////////////////////////////////////
+RefCountPtr<RHISampler> NullDevice::CreateSampler(const RHISamplerDesc& inDesc)
+{
+    return m_StateCache.FindOrCreate(inDesc, [](const RHISamplerDesc& inCreateDesc)
+    {
+        return RefCountPtr<RHISampler>(new NullSampler(inCreateDesc));
+    });
+}
+
+///////////////////////////////////////////////////////////////////////////////////
+/// NullAccelerationStructure
+///////////////////////////////////////////////////////////////////////////////////
+RefCountPtr<RHIAccelerationStructure> NullDevice::CreateBottomLevelAccelerationStructure(const std::vector<RHIRayTracingGeometryDesc>& inDesc)
+{
+    RefCountPtr<RHIAccelerationStructure> as(new NullAccelerationStructure(*this, inDesc));
+    if(!as->Init())
+    {
+        Log::Error("[Null] Failed to create bottom level acceleration structure");
+    }
+    return as;
+}
+
+RefCountPtr<RHIAccelerationStructure> NullDevice::CreateTopLevelAccelerationStructure(const std::vector<RHIRayTracingInstanceDesc>& inDesc)
+{
+    RefCountPtr<RHIAccelerationStructure> as(new NullAccelerationStructure(*this, inDesc));
+    if(!as->Init())
+    {
+        Log::Error("[Null] Failed to create top level acceleration structure");
+    }
+    return as;
+}
+
+NullAccelerationStructure::NullAccelerationStructure(NullDevice& inDevice, const std::vector<RHIRayTracingGeometryDesc>& inDesc)
+    : m_Device(inDevice)
+    , m_IsTopLevel(false)
+    , m_IsValid(false)
+    , m_GeometryDesc(inDesc)
+{
+    
+}
+
+NullAccelerationStructure::NullAccelerationStructure(NullDevice& inDevice, const std::vector<RHIRayTracingInstanceDesc>& inDesc)
+    : m_Device(inDevice)
+    , m_IsTopLevel(true)
+    , m_IsValid(false)
+    , m_InstanceDesc(inDesc)
+{
+    
+}
+
+bool NullAccelerationStructure::Init()
+{
+    if(IsValid())
+    {
+        Log::Warning("[Null] Acceleration structure already initialized.");
+        return true;
+    }
+    
+    if(m_IsTopLevel ? m_InstanceDesc.empty() : m_GeometryDesc.empty())
+    {
+        Log::Error("[Null] Failed to create acceleration structure, the desc is empty");
+        return false;
+    }
+
+    // Backs the gpu address the top level instances refer to
+    const size_t size = m_IsTopLevel ? m_InstanceDesc.size() * sizeof(RHIRayTracingInstanceDesc)
+                                     : m_GeometryDesc.size() * sizeof(RHIRayTracingGeometryDesc);
+    m_AccelerationStructureBuffer = m_Device.CreateBuffer(RHIBufferDesc::AccelerationStructure(size));
+    m_IsValid = m_AccelerationStructureBuffer.IsValid() && m_AccelerationStructureBuffer->IsValid();
+    return m_IsValid;
+}
+
+///////////////////////////////////////////////////////////////////////////////////
+/// NullResourceSet
+///////////////////////////////////////////////////////////////////////////////////
+RefCountPtr<RHIResourceSet> NullDevice::CreateResourceSet(const RHIPipelineBindingLayout* inLayout, bool inIsDynamic)
+{
+    RefCountPtr<RHIResourceSet> resourceSet(new NullResourceSet(*this, inLayout));
+    if(!resourceSet->Init())
+    {
+        Log::Error("[Null] Failed to create resource set");
+    }
+    return resourceSet;
+}
+
+NullResourceSet::NullResourceSet(NullDevice& inDevice, const RHIPipelineBindingLayout* inLayout)
+    : m_Device(inDevice)
+    , m_Layout(inLayout)
+{
+    
+}
+
+bool NullResourceSet::Init()
+{
+    if(m_Layout == nullptr)
+    {
+        Log::Error("[Null] Failed to create resource set, the layout is null");
+        return false;
+    }
+    return true;
+}
+
+uint64_t NullResourceSet::GetBindingKey(ERHIBindingResourceType inType, uint32_t inRegister, uint32_t inSpace)
+{
+    return static_cast<uint64_t>(inType) << 56 | static_cast<uint64_t>(inSpace) << 32 | inRegister;
+}
+
+void NullResourceSet::Bind(ERHIBindingResourceType inType, uint32_t inRegister, uint32_t inSpace, RHIObject* inResource)
+{
+    if(inResource == nullptr)
+    {
+        Log::Error("[Null] Failed to bind resource at register %u space %u, the resource is null", inRegister, inSpace);
+        return;
+    }
+    m_Bindings[GetBindingKey(inType, inRegister, inSpace)] = inResource;
+}
+
+void NullResourceSet::BindBufferSRV(uint32_t inRegister, uint32_t inSpace, const RefCountPtr<RHIBuffer>& inBuffer)
+{
+    Bind(ERHIBindingResourceType::Buffer_SRV, inRegister, inSpace, inBuffer.GetReference());
+    m_ResidencyUsage.Bind(ERHIBindingResourceType::Buffer_SRV, inRegister, inSpace, inBuffer.GetReference());
+}
+
+void NullResourceSet::BindBufferUAV(uint32_t inRegister, uint32_t inSpace, const RefCountPtr<RHIBuffer>& inBuffer)
+{
+    Bind(ERHIBindingResourceType::Buffer_UAV, inRegister, inSpace, inBuffer.GetReference());
+    m_ResidencyUsage.Bind(ERHIBindingResourceType::Buffer_UAV, inRegister, inSpace, inBuffer.GetReference());
+}
+
+void NullResourceSet::BindBufferCBV(uint32_t inRegister, uint32_t inSpace, const RefCountPtr<RHIBuffer>& inBuffer)
+{
+    Bind(ERHIBindingResourceType::Buffer_CBV, inRegister, inSpace, inBuffer.GetReference());
+    m_ResidencyUsage.Bind(ERHIBindingResourceType::Buffer_CBV, inRegister, inSpace, inBuffer.GetReference());
+}
+
+void NullResourceSet::BindBufferCBV(uint32_t inRegister, uint32_t inSpace, const RHIConstantAllocation& inAllocation)
+{
+    Bind(ERHIBindingResourceType::Buffer_CBV, inRegister, inSpace, inAllocation.Buffer);
+    m_ResidencyUsage.Bind(ERHIBindingResourceType::Buffer_CBV, inRegister, inSpace, inAllocation.Buffer);
+}
+
+void NullResourceSet::BindTextureSRV(uint32_t inRegister, uint32_t inSpace, const RefCountPtr<RHITexture>& inTexture)
+{
+    Bind(ERHIBindingResourceType::Texture_SRV, inRegister, inSpace, inTexture.GetReference());
+    m_ResidencyUsage.Bind(ERHIBindingResourceType::Texture_SRV, inRegister, inSpace, inTexture.GetReference());
+}
+
+void NullResourceSet::BindTextureUAV(uint32_t inRegister, uint32_t inSpace, const RefCountPtr<RHITexture>& inTexture)
+{
+    Bind(ERHIBindingResourceType::Texture_UAV, inRegister, inSpace, inTexture.GetReference());
+    m_ResidencyUsage.Bind(ERHIBindingResourceType::Texture_UAV, inRegister, inSpace, inTexture.GetReference());
+}
+
+void NullResourceSet::BindSampler(uint32_t inRegister, uint32_t inSpace, const RefCountPtr<RHISampler>& inSampler)
+{
+    Bind(ERHIBindingResourceType::Sampler, inRegister, inSpace, inSampler.GetReference());
+}
+
+void NullResourceSet::BindBufferSRVArray(uint32_t inBaseRegister, uint32_t inSpace, const std::vector<RefCountPtr<RHIBuffer>>& inBuffer)
+{
+    for(uint32_t i = 0; i < inBuffer.size(); ++i)
+    {
+        BindBufferSRV(inBaseRegister + i, inSpace, inBuffer[i]);
+    }
+}
+
+void NullResourceSet::BindBufferUAVArray(uint32_t inBaseRegister, uint32_t inSpace, const std::vector<RefCountPtr<RHIBuffer>>& inBuffer)
+{
+    for(uint32_t i = 0; i < inBuffer.size(); ++i)
+    {
+        BindBufferUAV(inBaseRegister + i, inSpace, inBuffer[i]);
+    }
+}
+
+void NullResourceSet::BindBufferCBVArray(uint32_t inBaseRegister, uint32_t inSpace, const std::vector<RefCountPtr<RHIBuffer>>& inBuffer)
+{
+    for(uint32_t i = 0; i < inBuffer.size(); ++i)
+    {
+        BindBufferCBV(inBaseRegister + i, inSpace, inBuffer[i]);
+    }
+}
+
+void NullResourceSet::BindTextureSRVArray(uint32_t inBaseRegister, uint32_t inSpace, const std::vector<RefCountPtr<RHITexture>>& inTextures)
+{
+    for(uint32_t i = 0; i < inTextures.size(); ++i)
+    {
+        BindTextureSRV(inBaseRegister + i, inSpace, inTextures[i]);
+    }
+}
+
+void NullResourceSet::BindTextureUAVArray(uint32_t inBaseRegister, uint32_t inSpace, const std::vector<RefCountPtr<RHITexture>>& inTextures)
+{
+    for(uint32_t i = 0; i < inTextures.size(); ++i)
+    {
+        BindTextureUAV(inBaseRegister + i, inSpace, inTextures[i]);
+    }
+}
+
+void NullResourceSet::BindSamplerArray(uint32_t inRegister, uint32_t inSpace, const std::vector<RefCountPtr<RHISampler>>& inSampler)
+{
+    for(uint32_t i = 0; i < inSampler.size(); ++i)
+    {
+        BindSampler(inRegister + i, inSpace, inSampler[i]);
+    }
+}
+
+void NullResourceSet::BindAccelerationStructure(uint32_t inRegister, uint32_t inSpace, const RefCountPtr<RHIAccelerationStructure>& inAccelerationStructure)
+{
+    Bind(ERHIBindingResourceType::AccelerationStructure, inRegister, inSpace, inAccelerationStructure.GetReference());
+}
\ No newline at end of file
@@ -0,0 +1,229 @@
+#pragma once
+
+#include "../RHIResources.h"
+#include "../RHIResidencyManager.h"
+#include "../../Core/TlsfAllocator.h"
+#include <unordered_map>
+
+class NullDevice;
+
+///////////////////////////////////////////////////////////////////////////////////
+/// NullResourceHeap
+///////////////////////////////////////////////////////////////////////////////////
+class NullResourceHeap : public RHIResourceHeap
+{
+public:
+    ~NullResourceHeap() override;
+    bool Init() override;
+    void Shutdown() override;
+    bool IsValid() const override;
+    const RHIResourceHeapDesc& GetDesc() const override {return m_Desc;}
+    bool TryAllocate(size_t inSize, size_t inAlignment, size_t& outOffset) override;
+    bool CanAllocate(size_t inSize, size_t inAlignment) const override;
+    void Free(size_t inOffset, size_t inSize) override;
+    size_t GetUsedSize() const override { return m_MemAllocator.GetUsedSize(); }
+    void GetFreeRanges(std::vector<RHIMemoryRange>& outRanges) const override;
+    bool IsEmpty() const override;
+    uint32_t GetTotalChunks() const override { return m_TotalChunkNum; }
+    uint8_t* GetData(size_t inOffset = 0) { return m_Memory.data() + inOffset; }
+    
+private:
+    friend class NullDevice;
+    NullResourceHeap(NullDevice& inDevice, const RHIResourceHeapDesc& inDesc);
+    void ShutdownInternal();
+    
+    NullDevice& m_Device;
+    RHIResourceHeapDesc m_Desc;
+    std::vector<uint8_t> m_Memory;
+    uint32_t m_TotalChunkNum;
+    TlsfAllocator m_MemAllocator;
+};
+
+///////////////////////////////////////////////////////////////////////////////////
+/// NullBuffer
+///////////////////////////////////////////////////////////////////////////////////
+class NullBuffer : public RHIBuffer
+{
+public:
+    ~NullBuffer() override;
+    bool Init() override;
+    void Shutdown() override;
+    bool IsValid() const override;
+
+    void* Map(uint64_t inSize, uint64_t inOffset = 0) override;
+    void  Unmap() override;
+    void  WriteData(const void* inData, uint64_t inSize, uint64_t inOffset = 0) override;
+    void  ReadData(void* outData, uint64_t inSize, uint64_t inOffset = 0) override;
+    bool IsVirtual() const override { return IsVirtualBuffer; }
+    bool IsManaged() const override { return true; }
+    bool BindMemory(RefCountPtr<RHIResourceHeap> inHeap) override;
+    size_t GetOffsetInHeap() const override { return m_OffsetInHeap; }
+    RHIResourceHeap* GetResourceHeap() const override { return m_ResourceHeap.GetReference(); }
+    const RHIBufferDesc& GetDesc() const override { return m_Desc; }
+    uint32_t GetMemTypeFilter()  const override { return UINT32_MAX; }
+    size_t GetAllocSizeInByte() const override { return m_AllocSize; }
+    size_t GetAllocAlignment() const override { return m_AllocAlignment; }
+    RHIResourceGpuAddress GetGpuAddress() const override;
+
+    ERHIResourceStates GetCurrentState() const { return m_CurrentState; }
+    void ChangeState(ERHIResourceStates inAfterState) { m_CurrentState = inAfterState; }
+    uint8_t* GetData();
+    
+    const bool IsVirtualBuffer;
+    
+private:
+    friend class NullDevice;
+    NullBuffer(NullDevice& inDevice, const RHIBufferDesc& inDesc, bool isVirtual);
+    void ShutdownInternal();
+    
+    NullDevice& m_Device;
+    RHIBufferDesc m_Desc;
+    ERHIResourceStates m_CurrentState;
+    size_t m_AllocSize;
+    size_t m_AllocAlignment;
+    std::vector<uint8_t> m_Memory;              // committed buffer storage
+    RefCountPtr<NullResourceHeap> m_ResourceHeap; // placed buffer storage
+    size_t m_OffsetInHeap;
+    uint32_t m_NumMapCalls;
+};
+
+///////////////////////////////////////////////////////////////////////////////////
+/// NullTexture
+///////////////////////////////////////////////////////////////////////////////////
+class NullTexture : public RHITexture
+{
+public:
+    ~NullTexture() override;
+    bool Init() override;
+    void Shutdown() override;
+    bool IsValid() const override;
+    
+    bool IsVirtual() const override { return IsVirtualTexture; }
+    bool IsManaged() const override { return true; }
+    bool BindMemory(RefCountPtr<RHIResourceHeap> inHeap) override;
+    size_t GetOffsetInHeap() const override { return m_OffsetInHeap; }
+    RHIResourceHeap* GetResourceHeap() const override { return m_ResourceHeap.GetReference(); }
+    const RHITextureDesc& GetDesc() const override { return m_Desc; }
+    uint32_t GetMemTypeFilter() const override { return UINT32_MAX; }
+    size_t GetAllocSizeInByte() const override { return m_AllocSize; }
+    size_t GetAllocAlignment() const override { return m_AllocAlignment; }
+    const RHIClearValue& GetClearValue() const override { return m_Desc.ClearValue; }
+
+    ERHIResourceStates GetCurrentState() const { return m_CurrentState; }
+    void ChangeState(ERHIResourceStates inAfterState) { m_CurrentState = inAfterState; }
+    uint8_t* GetData();
+    // Texels are tightly packed, mip levels follow each other inside an array slice
+    size_t GetSliceOffset(uint32_t inMipLevel, uint32_t inArraySlice) const;
+    size_t GetRowPitch(uint32_t inMipLevel) const;
+    size_t GetDepthPitch(uint32_t inMipLevel) const;
+    size_t GetMipSize(uint32_t inMipLevel) const;
+    
+    const bool IsVirtualTexture;
+    
+private:
+    friend class NullDevice;
+    friend class NullSwapChain;
+    NullTexture(NullDevice& inDevice, const RHITextureDesc& inDesc, bool isVirtual);
+    void ShutdownInternal();
+    
+    NullDevice& m_Device;
+    RHITextureDesc m_Desc;
+    ERHIResourceStates m_CurrentState;
+    size_t m_AllocSize;
+    size_t m_AllocAlignment;
+    size_t m_ArraySliceSize;
+    std::vector<uint8_t> m_Memory;
+    RefCountPtr<NullResourceHeap> m_ResourceHeap;
+    size_t m_OffsetInHeap;
+};
+
+///////////////////////////////////////////////////////////////////////////////////
+/// NullSampler
+///////////////////////////////////////////////////////////////////////////////////
+class NullSampler : public RHISampler
+{
+public:
+    ~NullSampler() override = default;
+    bool Init() override { return true; }
+    bool IsValid() const override { return true; }
+    const RHISamplerDesc& GetDesc() const override { return m_Desc; }
+    
+private:
+    friend class NullDevice;
+    NullSampler(const RHISamplerDesc& inDesc) : m_Desc(inDesc) {}
+    
+    RHISamplerDesc m_Desc;
+};
+
+///////////////////////////////////////////////////////////////////////////////////
+/// NullAccelerationStructure
+///////////////////////////////////////////////////////////////////////////////////
+class NullAccelerationStructure : public RHIAccelerationStructure
+{
+public:
+    ~NullAccelerationStructure() override = default;
+    bool Init() override;
+    bool IsValid() const override { return m_IsValid; }
+    const RHIRayTracingGeometryDesc* GetGeometryDesc() const override { return m_GeometryDesc.data(); }
+    const RHIRayTracingInstanceDesc* GetInstanceDesc() const override { return m_InstanceDesc.data(); }
+    RefCountPtr<RHIBuffer> GetScratchBuffer() const override { return nullptr; }
+    size_t GetGeometryDescCount() const override { return m_GeometryDesc.size(); }
+    size_t GetInstanceDescCount() const override { return m_InstanceDesc.size(); }
+    bool IsTopLevel() const override { return m_IsTopLevel; }
+    // Nothing to build on the cpu, the structure is usable as soon as it is created
+    bool IsBuilt() const override { return m_IsValid; }
+    
+private:
+    friend class NullDevice;
+    NullAccelerationStructure(NullDevice& inDevice, const std::vector<RHIRayTracingGeometryDesc>& inDesc);
+    NullAccelerationStructure(NullDevice& inDevice, const std::vector<RHIRayTracingInstanceDesc>& inDesc);
+    
+    NullDevice& m_Device;
+    const bool m_IsTopLevel;
+    bool m_IsValid;
+    std::vector<RHIRayTracingGeometryDesc> m_GeometryDesc;
+    std::vector<RHIRayTracingInstanceDesc> m_InstanceDesc;
+    RefCountPtr<RHIBuffer> m_AccelerationStructureBuffer;
+};
+
+///////////////////////////////////////////////////////////////////////////////////
+/// NullResourceSet
+///////////////////////////////////////////////////////////////////////////////////
+class NullResourceSet : public RHIResourceSet
+{
+public:
+    ~NullResourceSet() override = default;
+    bool Init() override;
+    bool IsValid() const override { return m_Layout != nullptr; }
+    const RHIPipelineBindingLayout* GetLayout() const override { return m_Layout; }
+    void BindBufferSRV(uint32_t inRegister, uint32_t inSpace, const RefCountPtr<RHIBuffer>& inBuffer) override;
+    void BindBufferUAV(uint32_t inRegister, uint32_t inSpace, const RefCountPtr<RHIBuffer>& inBuffer) override;
+    void BindBufferCBV(uint32_t inRegister, uint32_t inSpace, const RefCountPtr<RHIBuffer>& inBuffer) override;
+    void BindBufferCBV(uint32_t inRegister, uint32_t inSpace, const RHIConstantAllocation& inAllocation) override;
+    void BindTextureSRV(uint32_t inRegister, uint32_t inSpace, const RefCountPtr<RHITexture>& inTexture) override;
+    void BindTextureUAV(uint32_t inRegister, uint32_t inSpace, const RefCountPtr<RHITexture>& inTexture) override;
+    void BindSampler(uint32_t inRegister, uint32_t inSpace, const RefCountPtr<RHISampler>& inSampler) override;
+    void BindBufferSRVArray(uint32_t inBaseRegister, uint32_t inSpace, const std::vector<RefCountPtr<RHIBuffer>>& inBuffer) override;
+    void BindBufferUAVArray(uint32_t inBaseRegister, uint32_t inSpace, const std::vector<RefCountPtr<RHIBuffer>>& inBuffer) override;
+    void BindBufferCBVArray(uint32_t inBaseRegister, uint32_t inSpace, const std::vector<RefCountPtr<RHIBuffer>>& inBuffer) override;
+    void BindTextureSRVArray(uint32_t inBaseRegister, uint32_t inSpace, const std::vector<RefCountPtr<RHITexture>>& inTextures) override;
+    void BindTextureUAVArray(uint32_t inBaseRegister, uint32_t inSpace, const std::vector<RefCountPtr<RHITexture>>& inTextures) override;
+    void BindSamplerArray(uint32_t inRegister, uint32_t inSpace, const std::vector<RefCountPtr<RHISampler>>& inSampler) override;
+    void BindAccelerationStructure(uint32_t inRegister, uint32_t inSpace, const RefCountPtr<RHIAccelerationStructure>& inAccelerationStructure) override;
+
+    uint32_t GetNumBoundResources() const { return static_cast<uint32_t>(m_Bindings.size()); }
+    const RHIResidencyUsage& GetResidencyUsage() const { return m_ResidencyUsage; }
+    
+private:
+    friend class NullDevice;
+    NullResourceSet(NullDevice& inDevice, const RHIPipelineBindingLayout* inLayout);
+    void Bind(ERHIBindingResourceType inType, uint32_t inRegister, uint32_t inSpace, RHIObject* inResource);
+    
+    static uint64_t GetBindingKey(ERHIBindingResourceType inType, uint32_t inRegister, uint32_t inSpace);
+    
+    NullDevice& m_Device;
+    const RHIPipelineBindingLayout* m_Layout;
+    // Keeps the bound resources alive the same way the descriptor tables do on the gpu backends
+    std::unordered_map<uint64_t, RefCountPtr<RHIObject>> m_Bindings;
+    RHIResidencyUsage m_ResidencyUsage;
+};
\ No newline at end of file
@@ -0,0 +1,112 @@
+#include "NullSwapChain.h"
+#include "NullDevice.h"
+#include "../../Core/Log.h"
+
+NullSwapChain::NullSwapChain(NullDevice& inDevice, const RHISwapChainDesc& inDesc)
+    : m_Device(inDevice)
+    , m_Desc(inDesc)
+    , m_CurrentBackBufferIndex(0)
+    , m_NumPresents(0)
+{
+    
+}
+
+NullSwapChain::~NullSwapChain()
+{
+    ShutdownInternal();
+}
+
+bool NullSwapChain::Init()
+{
+    if(IsValid())
+    {
+        Log::Warning("[Null] SwapChain already initialized");
+        return true;
+    }
+
+    if(m_Desc.BufferCount == 0)
+    {
+        Log::Error("[Null] Failed to create swap chain, the buffer count is zero");
+        return false;
+    }
+
+    m_CurrentBackBufferIndex = 0;
+    return InitBackBuffers();
+}
+
+bool NullSwapChain::InitBackBuffers()
+{
+    m_BackBuffers.resize(GetBackBufferCount());
+    for(uint32_t i = 0; i < GetBackBufferCount(); i++)
+    {
+        RHITextureDesc backBufferDesc{};
+        backBufferDesc.Width = m_Desc.Width;
+        backBufferDesc.Height = m_Desc.Height;
+        backBufferDesc.Format = m_Desc.Format;
+        backBufferDesc.Usages = ERHITextureUsage::ShaderResource | ERHITextureUsage::RenderTarget;
+        backBufferDesc.SampleCount = m_Desc.SampleCount;
+        m_BackBuffers[i] = new NullTexture(m_Device, backBufferDesc, false);
+        if(!m_BackBuffers[i]->Init())
+        {
+            Log::Error("[Null] Failed to create back buffer %u", i);
+            m_BackBuffers.clear();
+            return false;
+        }
+        m_BackBuffers[i]->ChangeState(ERHIResourceStates::Present);
+    }
+    return true;
+}
+
+void NullSwapChain::Shutdown()
+{
+    ShutdownInternal();
+}
+
+void NullSwapChain::ShutdownInternal()
+{
+    m_BackBuffers.clear();
+}
+
+bool NullSwapChain::IsValid() const
+{
+    return !m_BackBuffers.empty();
+}
+
+void NullSwapChain::Present()
+{
+    if(IsValid())
+    {
+        ++m_NumPresents;
+        m_CurrentBackBufferIndex = (m_CurrentBackBufferIndex + 1) % GetBackBufferCount();
+    }
+    else
+    {
+        Log::Error("[Null] Failed to present back buffer, swapChain is not valid");
+    }
+}
+
+void NullSwapChain::Resize(uint32_t inWidth, uint32_t inHeight)
+{
+    m_Desc.Width = inWidth;
+    m_Desc.Height = inHeight;
+    if(IsValid())
+    {
+        m_BackBuffers.clear();
+        m_CurrentBackBufferIndex = 0;
+        InitBackBuffers();
+    }
+}
+
+RHITexture* NullSwapChain::GetBackBuffer(uint32_t index)
+{
+    if(index < m_BackBuffers.size())
+    {
+        return m_BackBuffers[index].GetReference();
+    }
+    return nullptr;
+}
+
+RHITexture* NullSwapChain::GetCurrentBackBuffer()
+{
+    return GetBackBuffer(m_CurrentBackBufferIndex);
+}
\ No newline at end of file
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "../RHISwapChain.h"
+#include "NullResources.h"
+
+// Presents nothing, the back buffers are cpu textures that can be read back for testing
+class NullSwapChain : public RHISwapChain
+{
+public:
+    ~NullSwapChain() override;
+    bool Init() override;
+    void Shutdown() override;
+    bool IsValid() const override;
+    const RHISwapChainDesc& GetDesc() const override { return m_Desc; }
+    void Present() override;
+    void Resize(uint32_t inWidth, uint32_t inHeight) override;
+    RHITexture* GetBackBuffer(uint32_t index) override;
+    RHITexture* GetCurrentBackBuffer() override;
+    uint32_t GetCurrentBackBufferIndex() override { return m_CurrentBackBufferIndex; }
+    uint32_t GetBackBufferCount() override { return m_Desc.BufferCount; }
+    uint64_t GetNumPresents() const { return m_NumPresents; }
+    
+private:
+    friend RefCountPtr<RHISwapChain> RHI::CreateSwapChain(const RHISwapChainDesc& inDesc);
+    NullSwapChain(NullDevice& inDevice, const RHISwapChainDesc& inDesc);
+    void ShutdownInternal();
+    bool InitBackBuffers();
+    
+    NullDevice& m_Device;
+    RHISwapChainDesc m_Desc;
+    std::vector<RefCountPtr<NullTexture>> m_BackBuffers;
+    uint32_t m_CurrentBackBufferIndex;
+    uint64_t m_NumPresents;
+};
\ No newline at end of file
@@ -0,0 +1,184 @@
+#include "NullResources.h"
+#include "NullDevice.h"
+#include "../../Core/Log.h"
+#include "../../Core/Templates.h"
+
+RefCountPtr<RHITexture> NullDevice::CreateTexture(const RHITextureDesc& inDesc, bool isVirtual)
+{
+    RefCountPtr<RHITexture> texture(new NullTexture(*this, inDesc, isVirtual));
+    if(!texture->Init())
+    {
+        Log::Error("[Null] Failed to create texture");
+    }
+    else if(!isVirtual)
+    {
+        // Committed textures are evicted by the residency manager, placed ones with their heap
+        m_ResidencyManager.Track(texture);
+    }
+    return texture;
+}
+
+NullTexture::NullTexture(NullDevice& inDevice, const RHITextureDesc& inDesc, bool isVirtual)
+    : IsVirtualTexture(isVirtual)
+    , m_Device(inDevice)
+    , m_Desc(inDesc)
+    , m_CurrentState(ERHIResourceStates::None)
+    , m_AllocSize(0)
+    , m_AllocAlignment(65536)
+    , m_ArraySliceSize(0)
+    , m_ResourceHeap(nullptr)
+    , m_OffsetInHeap(0)
+{
+    
+}
+
+NullTexture::~NullTexture()
+{
+    ShutdownInternal();
+}
+
+bool NullTexture::Init()
+{
+    if(IsValid())
+    {
+        Log::Warning("[Null] Texture already initialized.");
+        return true;
+    }
+
+    if(m_Desc.Width == 0 || m_Desc.Height == 0 || m_Desc.Depth == 0 || m_Desc.ArraySize == 0 || m_Desc.MipLevels == 0)
+    {
+        Log::Error("[Null] Failed to create texture, the extent, array size and mip levels must not be zero");
+        return false;
+    }
+
+    if(RHI::GetFormatInfo(m_Desc.Format).BytesPerBlock == 0)
+    {
+        Log::Error("[Null] Failed to create texture, the format is unknown");
+        return false;
+    }
+
+    m_ArraySliceSize = 0;
+    for(uint32_t mip = 0; mip < m_Desc.MipLevels; ++mip)
+    {
+        m_ArraySliceSize += GetMipSize(mip);
+    }
+    
+    m_AllocSize = Align(m_ArraySliceSize * m_Desc.ArraySize, m_AllocAlignment);
+    m_CurrentState = ERHIResourceStates::None;
+    m_ResourceHeap.SafeRelease();
+    
+    if(!IsVirtual())
+    {
+        m_Memory.resize(m_ArraySliceSize * m_Desc.ArraySize, 0);
+    }
+    
+    return true;
+}
+
+void NullTexture::Shutdown()
+{
+    ShutdownInternal();
+}
+
+void NullTexture::ShutdownInternal()
+{
+    // Tracked objects are made resident again before they are released
+    m_Device.GetResidencyManager().Untrack(this);
+    if(m_ResourceHeap != nullptr)
+    {
+        m_ResourceHeap->Free(m_OffsetInHeap, GetAllocSizeInByte());
+        m_ResourceHeap.SafeRelease();
+        m_OffsetInHeap = 0;
+    }
+    
+    m_Memory.clear();
+    m_Memory.shrink_to_fit();
+}
+
+bool NullTexture::IsValid() const
+{
+    if(IsVirtual())
+    {
+        return m_ResourceHeap != nullptr && m_ResourceHeap->IsValid();
+    }
+    return !m_Memory.empty();
+}
+
+bool NullTexture::BindMemory(RefCountPtr<RHIResourceHeap> inHeap)
+{
+    if(!IsVirtual())
+    {
+        Log::Warning("[Null] Texture is not virtual, memory binding is not allowed.");
+        return true;
+    }
+
+    if(m_ResourceHeap != nullptr)
+    {
+        Log::Warning("[Null] Texture already bound to a heap.");
+        return true;
+    }
+
+    NullResourceHeap* heap = CheckCast<NullResourceHeap*>(inHeap.GetReference());
+
+    if(heap == nullptr || !heap->IsValid())
+    {
+        Log::Error("[Null] Failed to bind texture memory, the heap is invalid");
+        return false;
+    }
+
+    if(heap->GetDesc().Usage != ERHIHeapUsage::Texture)
+    {
+        Log::Error("[Null] Failed to bind texture memory, the heap is not a texture heap");
+        return false;
+    }
+    
+    if(!heap->TryAllocate(GetAllocSizeInByte(), GetAllocAlignment(), m_OffsetInHeap))
+    {
+        Log::Error("[Null] Failed to bind texture memory, the heap size is not enough");
+        return false;
+    }
+
+    m_ResourceHeap = heap;
+    return true;
+}
+
+uint8_t* NullTexture::GetData()
+{
+    if(m_ResourceHeap != nullptr)
+    {
+        return m_ResourceHeap->GetData(m_OffsetInHeap);
+    }
+    return m_Memory.empty() ? nullptr : m_Memory.data();
+}
+
+size_t NullTexture::GetRowPitch(uint32_t inMipLevel) const
+{
+    const RHIFormatInfo& formatInfo = RHI::GetFormatInfo(m_Desc.Format);
+    const uint32_t blockSize = std::max<uint32_t>(1, formatInfo.BlockSize);
+    const uint32_t width = std::max(1u, m_Desc.Width >> inMipLevel);
+    return static_cast<size_t>((width + blockSize - 1) / blockSize) * formatInfo.BytesPerBlock;
+}
+
+size_t NullTexture::GetDepthPitch(uint32_t inMipLevel) const
+{
+    const RHIFormatInfo& formatInfo = RHI::GetFormatInfo(m_Desc.Format);
+    const uint32_t blockSize = std::max<uint32_t>(1, formatInfo.BlockSize);
+    const uint32_t height = std::max(1u, m_Desc.Height >> inMipLevel);
+    return GetRowPitch(inMipLevel) * ((height + blockSize - 1) / blockSize);
+}
+
+size_t NullTexture::GetSliceOffset(uint32_t inMipLevel, uint32_t inArraySlice) const
+{
+    size_t offset = m_ArraySliceSize * inArraySlice;
+    for(uint32_t mip = 0; mip < inMipLevel; ++mip)
+    {
+        offset += GetMipSize(mip);
+    }
+    return offset;
+}
+
+size_t NullTexture::GetMipSize(uint32_t inMipLevel) const
+{
+    const uint32_t depth = m_Desc.Dimension == ERHITextureDimension::Texture3D ? std::max(1u, m_Desc.Depth >> inMipLevel) : 1u;
+    return GetDepthPitch(inMipLevel) * depth;
+}
\ No newline at end of file
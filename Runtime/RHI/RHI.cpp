@@ -1,11 +1,14 @@
 #include "RHI.h"
 #include <mutex>
+#include <filesystem>
 
 #include "RHIResources.h"
 #include "../Core/Log.h"
 #include "../Core/Templates.h"
 #include "D3D12/D3D12Device.h"
 #include "D3D12/D3D12SwapChain.h"
+#include "Null/NullDevice.h"
+#include "Null/NullSwapChain.h"
 #if HAS_VULKAN
 #include "Vulkan/VulkanSwapChain.h"
 #include "Vulkan/VulkanDevice.h"
@@ -15,25 +18,47 @@ namespace RHI
 {
     static RHIDevice* s_Device = nullptr;
     static std::mutex s_Mtx;
-    static bool s_UseVulkan = false;
+    static ERHIBackend s_Backend = ERHIBackend::D3D12;
+    // Next to the compiled shaders by default, the same place AssetsManager loads them from
+    static std::string s_PipelineCacheDirectory = (std::filesystem::current_path() / ".." / "Shaders").string();
     
     bool Init(bool useVulkan)
+    {
+        return Init(useVulkan ? ERHIBackend::Vulkan : ERHIBackend::D3D12);
+    }
+
+    bool Init(ERHIBackend inBackend)
     {
         if(s_Device == nullptr)
         {
             std::lock_guard locker(s_Mtx);
+            if(inBackend == ERHIBackend::Null)
+            {
+                s_Device = new NullDevice();
+            }
 #if HAS_VULKAN
-            if(useVulkan)
+            else if(inBackend == ERHIBackend::Vulkan)
             {
                 s_Device = new VulkanDevice();
             }
-            else
 #endif
+            else
             {
                 s_Device = new D3D12Device();
+                inBackend = ERHIBackend::D3D12;
             }
-            s_UseVulkan = useVulkan;
-            return s_Device->Init();
+            s_Backend = inBackend;
+            if(!s_Device->Init())
+            {
+                return false;
+            }
+            
+            // Headless runs leave no manifest behind
+            if(inBackend != ERHIBackend::Null)
+            {
+                s_Device->GetPipelineCompiler().WarmUp(RHIPipelineCache::GetBlobPath(inBackend, "PipelineManifest"));
+            }
+            return true;
         }
         return true;
     }
@@ -49,6 +74,16 @@ namespace RHI
         }
     }
 
+    void SetPipelineCacheDirectory(const char* inPath)
+    {
+        s_PipelineCacheDirectory = inPath ? inPath : "";
+    }
+
+    const std::string& GetPipelineCacheDirectory()
+    {
+        return s_PipelineCacheDirectory;
+    }
+
     RHIDevice* GetDevice()
     {
         if(!Init() || !s_Device->IsValid())
@@ -60,8 +95,23 @@ namespace RHI
 
     RefCountPtr<RHISwapChain> CreateSwapChain(const RHISwapChainDesc& inDesc)
     {
+        if(s_Backend == ERHIBackend::Null)
+        {
+            NullDevice* device = CheckCast<NullDevice*>(GetDevice());
+            if(!device || !device->IsValid())
+            {
+                Log::Error("[Null] Failed to create swap chain, the device is not valid");
+                return nullptr;
+            }
+            RefCountPtr<RHISwapChain> swapChain(new NullSwapChain(*device, inDesc));
+            if(!swapChain->Init())
+            {
+                Log::Error("[Null] Failed to create swap chain");
+            }
+            return swapChain;
+        }
 #if HAS_VULKAN
-        if(s_UseVulkan)
+        if(s_Backend == ERHIBackend::Vulkan)
         {
             VulkanDevice* device = CheckCast<VulkanDevice*>(GetDevice());
             if(!device || !device->IsValid())
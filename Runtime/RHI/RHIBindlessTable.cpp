@@ -0,0 +1,202 @@
+#include "RHIBindlessTable.h"
+#include "RHIDevice.h"
+#include "../Core/Log.h"
+
+RHIBindlessTable::RHIBindlessTable(RHIDevice& inDevice)
+    : m_Device(inDevice)
+{
+
+}
+
+bool RHIBindlessTable::Init(uint32_t inNumResources, uint32_t inNumSamplers)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    if(m_NumResources > 0)
+    {
+        Log::Warning("[RHI] Bindless table already initialized");
+        return true;
+    }
+
+    if(inNumResources == 0 || inNumSamplers == 0)
+    {
+        Log::Error("[RHI] The bindless table needs at least one resource and one sampler");
+        return false;
+    }
+    
+    if(!m_Device.InitBindlessTable(inNumResources, inNumSamplers))
+    {
+        Log::Error("[RHI] Failed to create the bindless table of %u resources and %u samplers", inNumResources, inNumSamplers);
+        return false;
+    }
+
+    m_NumResources = inNumResources;
+    m_NumSamplers = inNumSamplers;
+    m_Resources.Allocator.SetTotalCount(inNumResources);
+    m_Resources.Objects.resize(inNumResources);
+    m_Samplers.Allocator.SetTotalCount(inNumSamplers);
+    m_Samplers.Objects.resize(inNumSamplers);
+    return true;
+}
+
+bool RHIBindlessTable::IsValid() const
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_NumResources > 0;
+}
+
+void RHIBindlessTable::Shutdown()
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    for(Slots* slots : {&m_Resources, &m_Samplers})
+    {
+        slots->Allocator.Reset();
+        slots->Objects.clear();
+        slots->PendingFrees.clear();
+    }
+    m_PendingReleases.clear();
+    m_Submitted.clear();
+    m_NumResources = 0;
+    m_NumSamplers = 0;
+    m_Stats = RHIBindlessTableStats();
+}
+
+uint32_t RHIBindlessTable::RegisterTextureSRV(const RefCountPtr<RHITexture>& inTexture)
+{
+    return Register(ERHIBindingResourceType::Texture_SRV, RefCountPtr<RHIObject>(inTexture));
+}
+
+uint32_t RHIBindlessTable::RegisterTextureUAV(const RefCountPtr<RHITexture>& inTexture)
+{
+    return Register(ERHIBindingResourceType::Texture_UAV, RefCountPtr<RHIObject>(inTexture));
+}
+
+uint32_t RHIBindlessTable::RegisterBufferSRV(const RefCountPtr<RHIBuffer>& inBuffer)
+{
+    return Register(ERHIBindingResourceType::Buffer_SRV, RefCountPtr<RHIObject>(inBuffer));
+}
+
+uint32_t RHIBindlessTable::RegisterBufferUAV(const RefCountPtr<RHIBuffer>& inBuffer)
+{
+    return Register(ERHIBindingResourceType::Buffer_UAV, RefCountPtr<RHIObject>(inBuffer));
+}
+
+uint32_t RHIBindlessTable::RegisterSampler(const RefCountPtr<RHISampler>& inSampler)
+{
+    return Register(ERHIBindingResourceType::Sampler, RefCountPtr<RHIObject>(inSampler));
+}
+
+uint32_t RHIBindlessTable::Register(ERHIBindingResourceType inType, const RefCountPtr<RHIObject>& inObject)
+{
+    if(!inObject.IsValid() || !inObject->IsValid())
+    {
+        Log::Error("[RHI] Failed to register an invalid object in the bindless table");
+        return s_InvalidIndex;
+    }
+    
+    if(!IsValid() && !Init())
+    {
+        return s_InvalidIndex;
+    }
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    Slots& slots = inType == ERHIBindingResourceType::Sampler ? m_Samplers : m_Resources;
+    uint32_t index;
+    if(!slots.Allocator.TryAllocate(1, index))
+    {
+        Log::Error("[RHI] The bindless table is full, failed to register %s", inObject->GetName().c_str());
+        return s_InvalidIndex;
+    }
+
+    // Descriptor writes into the same table have to be externally synchronized
+    if(!m_Device.WriteBindlessDescriptor(index, RHIBindlessDescriptor{inType, inObject.GetReference()}))
+    {
+        Log::Error("[RHI] Failed to write the bindless descriptor of %s", inObject->GetName().c_str());
+        slots.Allocator.Free(index, 1);
+        return s_InvalidIndex;
+    }
+
+    slots.Objects[index] = inObject;
+    ++m_Stats.Writes;
+    ++(inType == ERHIBindingResourceType::Sampler ? m_Stats.Samplers : m_Stats.Resources);
+    return index;
+}
+
+void RHIBindlessTable::UnregisterResource(uint32_t inIndex)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    Unregister(m_Resources, inIndex);
+}
+
+void RHIBindlessTable::UnregisterSampler(uint32_t inIndex)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    Unregister(m_Samplers, inIndex);
+}
+
+void RHIBindlessTable::Unregister(Slots& inSlots, uint32_t inIndex)
+{
+    if(inIndex >= inSlots.Objects.size() || !inSlots.Objects[inIndex].IsValid())
+    {
+        Log::Warning("[RHI] The bindless index %u is not registered", inIndex);
+        return;
+    }
+
+    // The index is not reused and the object stays alive while a frame in flight may still read it
+    m_PendingReleases.push_back(std::move(inSlots.Objects[inIndex]));
+    inSlots.PendingFrees.push_back(inIndex);
+    --(&inSlots == &m_Samplers ? m_Stats.Samplers : m_Stats.Resources);
+    ++m_Stats.PendingFrees;
+}
+
+void RHIBindlessTable::Submit(const RefCountPtr<RHIFence>& inFence)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    if(m_Resources.PendingFrees.empty() && m_Samplers.PendingFrees.empty())
+    {
+        return;
+    }
+
+    Submission submission;
+    submission.Fence = inFence;
+    submission.Resources = std::move(m_Resources.PendingFrees);
+    submission.Samplers = std::move(m_Samplers.PendingFrees);
+    submission.Releases = std::move(m_PendingReleases);
+    m_Resources.PendingFrees.clear();
+    m_Samplers.PendingFrees.clear();
+    m_PendingReleases.clear();
+    m_Submitted.push_back(std::move(submission));
+}
+
+void RHIBindlessTable::Retire()
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    while(!m_Submitted.empty() && (!m_Submitted.front().Fence.IsValid() || m_Submitted.front().Fence->IsCompleted()))
+    {
+        const Submission& submission = m_Submitted.front();
+        for(uint32_t index : submission.Resources)
+        {
+            m_Resources.Allocator.Free(index, 1);
+        }
+        for(uint32_t index : submission.Samplers)
+        {
+            m_Samplers.Allocator.Free(index, 1);
+        }
+        const uint32_t numFrees = static_cast<uint32_t>(submission.Resources.size() + submission.Samplers.size());
+        m_Stats.PendingFrees -= numFrees;
+        m_Stats.Frees += numFrees;
+        m_Submitted.pop_front();
+    }
+}
+
+RHIBindlessTableStats RHIBindlessTable::GetStats() const
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_Stats;
+}
+
+void RHIBindlessTable::ResetStats()
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Stats.Writes = 0;
+    m_Stats.Frees = 0;
+}
\ No newline at end of file
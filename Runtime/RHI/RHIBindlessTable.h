@@ -0,0 +1,104 @@
+#pragma once
+
+#include "RHIResources.h"
+#include "../Core/FreeListAllocator.h"
+#include <deque>
+#include <mutex>
+
+class RHIDevice;
+class RHIFence;
+
+// A view written into the global table by RHIDevice::WriteBindlessDescriptor. Type is one of Texture_SRV, Texture_UAV,
+// Buffer_SRV, Buffer_UAV and Sampler, the object is the texture, buffer or sampler of the view
+struct RHIBindlessDescriptor
+{
+    ERHIBindingResourceType Type;
+    RHIObject* Object;
+};
+
+struct RHIBindlessTableStats
+{
+    uint32_t Resources = 0;     // registered SRVs and UAVs
+    uint32_t Samplers = 0;
+    uint32_t PendingFrees = 0;  // unregistered indices whose frames are still in flight
+    uint64_t Writes = 0;
+    uint64_t Frees = 0;
+};
+
+// One large shader visible table, every registered SRV, UAV and sampler keeps a stable index in it until it is
+// unregistered. The shaders index the table directly, so a draw only passes its indices, e.g. with
+// RHICommandList::SetPushConstants, instead of binding a resource set. Layouts with UseBindlessTable see the table as
+// - D3D12: SRVs at t0 and UAVs at u0 of the spaces s_RegisterSpace to s_RegisterSpace + s_NumRegisterSpaces - 1, every
+//   space aliases the whole table so each one can be declared with another resource type. Samplers at s0 of s_RegisterSpace.
+// - Vulkan: the descriptor set after the sets of the layout, see VulkanDevice::s_BindlessSampledImageBinding.
+// An unregistered index is reused once the frames recorded until then completed, RHIFrameContext drives it: Retire in
+// BeginFrame and Submit in EndFrame.
+class RHIBindlessTable
+{
+public:
+    static constexpr uint32_t s_InvalidIndex = UINT32_MAX;
+    static constexpr uint32_t s_DefaultNumResources = 65536;
+    static constexpr uint32_t s_DefaultNumSamplers = 256;
+    static constexpr uint32_t s_RegisterSpace = 100;
+    static constexpr uint32_t s_NumRegisterSpaces = 4;
+    
+    explicit RHIBindlessTable(RHIDevice& inDevice);
+    RHIBindlessTable(const RHIBindlessTable&) = delete;
+    RHIBindlessTable& operator=(const RHIBindlessTable&) = delete;
+
+    // The registers initialize the table with the default sizes if it is not initialized yet
+    bool Init(uint32_t inNumResources = s_DefaultNumResources, uint32_t inNumSamplers = s_DefaultNumSamplers);
+    bool IsValid() const;
+    // Releases the registered objects, the backend releases the table itself
+    void Shutdown();
+
+    uint32_t GetNumResources() const { return m_NumResources; }
+    uint32_t GetNumSamplers() const { return m_NumSamplers; }
+
+    // Returns s_InvalidIndex if the table is full or the view can not be created. The table keeps the object alive
+    // until the index is unregistered and its frames completed
+    uint32_t RegisterTextureSRV(const RefCountPtr<RHITexture>& inTexture);
+    uint32_t RegisterTextureUAV(const RefCountPtr<RHITexture>& inTexture);
+    uint32_t RegisterBufferSRV(const RefCountPtr<RHIBuffer>& inBuffer);
+    uint32_t RegisterBufferUAV(const RefCountPtr<RHIBuffer>& inBuffer);
+    uint32_t RegisterSampler(const RefCountPtr<RHISampler>& inSampler);
+    void UnregisterResource(uint32_t inIndex);
+    void UnregisterSampler(uint32_t inIndex);
+
+    // The indices unregistered since the last submit are freed once inFence is signaled
+    void Submit(const RefCountPtr<RHIFence>& inFence);
+    // Frees the indices whose fence is signaled, does not block
+    void Retire();
+
+    RHIBindlessTableStats GetStats() const;
+    void ResetStats();
+    
+private:
+    struct Slots
+    {
+        FreeListAllocator Allocator;
+        std::vector<RefCountPtr<RHIObject>> Objects;  // null at free and pending indices
+        std::vector<uint32_t> PendingFrees;
+    };
+    
+    struct Submission
+    {
+        RefCountPtr<RHIFence> Fence;
+        std::vector<uint32_t> Resources;
+        std::vector<uint32_t> Samplers;
+        std::vector<RefCountPtr<RHIObject>> Releases;   // the frames before the fence may still read them
+    };
+
+    uint32_t Register(ERHIBindingResourceType inType, const RefCountPtr<RHIObject>& inObject);
+    void Unregister(Slots& inSlots, uint32_t inIndex);
+    
+    RHIDevice& m_Device;
+    mutable std::mutex m_Mutex;
+    uint32_t m_NumResources = 0;
+    uint32_t m_NumSamplers = 0;
+    Slots m_Resources;
+    Slots m_Samplers;
+    std::vector<RefCountPtr<RHIObject>> m_PendingReleases;
+    std::deque<Submission> m_Submitted;
+    RHIBindlessTableStats m_Stats;
+};
\ No newline at end of file
@@ -6,11 +6,14 @@ class RHIShaderTable;
 class RHIComputePipeline;
 class RHIResourceSet;
 struct RHITextureSlice;
+struct RHITextureSubResource;
 class RHIBuffer;
 class RHITexture;
 class RHIFrameBuffer;
 class RHIGraphicsPipeline;
 class RHIPipelineBindingLayout;
+class RHIAsyncGraphicsPipeline;
+class RHIAsyncComputePipeline;
 
 class RHICommandList : public RHIObject
 {
@@ -24,6 +27,10 @@ public:
 
     virtual void SetPipelineState(const RefCountPtr<RHIComputePipeline>& inPipelineState) = 0;
     virtual void SetPipelineState(const RefCountPtr<RHIGraphicsPipeline>& inPipelineState) = 0;
+    // Binds the async pipeline once it is compiled and the fallback until then.
+    // Returns false if nothing was bound, the caller skips its draws or dispatches
+    bool SetPipelineStateOrFallback(const RefCountPtr<RHIAsyncGraphicsPipeline>& inPipelineState, const RefCountPtr<RHIGraphicsPipeline>& inFallback = nullptr);
+    bool SetPipelineStateOrFallback(const RefCountPtr<RHIAsyncComputePipeline>& inPipelineState, const RefCountPtr<RHIComputePipeline>& inFallback = nullptr);
     
     virtual void SetFrameBuffer(const RefCountPtr<RHIFrameBuffer>& inFrameBuffer) = 0;
     virtual void SetFrameBuffer(const RefCountPtr<RHIFrameBuffer>& inFrameBuffer
@@ -36,8 +43,12 @@ public:
     virtual void SetScissorRects(const std::vector<RHIRect>& inRects) = 0;
     
     virtual void ResourceBarrier(RefCountPtr<RHITexture>& inResource, ERHIResourceStates inAfterState) = 0;
+    // Transitions the mip and array slice range only, e.g. the source mip of a mip generation pass
+    virtual void ResourceBarrier(RefCountPtr<RHITexture>& inResource, const RHITextureSubResource& inSubResource, ERHIResourceStates inAfterState) = 0;
     virtual void ResourceBarrier(RefCountPtr<RHIBuffer>& inResource, ERHIResourceStates inAfterState) = 0;
     virtual void SetResourceSet(RefCountPtr<RHIResourceSet>& inResourceSet) = 0;
+    // Sets the values of the PushConstants item of the bound pipeline, inSize is in bytes and a multiple of 4
+    virtual void SetPushConstants(const void* inData, uint32_t inSize) = 0;
     virtual void SetVertexBuffer(const RefCountPtr<RHIBuffer>& inBuffer, size_t inOffset = 0) = 0;
     virtual void SetIndexBuffer(const RefCountPtr<RHIBuffer>& inBuffer, size_t inOffset = 0) = 0;
     
@@ -51,9 +62,14 @@ public:
     virtual void DrawIndirect(RefCountPtr<RHIBuffer>& indirectCommands, uint32_t drawCount, size_t commandsBufferOffset = 0) = 0;
     virtual void DrawIndexed(uint32_t indexCount, uint32_t instanceCount, uint32_t firstIndex = 0, uint32_t vertexOffset = 0, uint32_t firstInstance = 0) = 0;
     virtual void DrawIndexedIndirect(RefCountPtr<RHIBuffer>& indirectCommands, uint32_t drawCount, size_t commandsBufferOffset = 0) = 0;
+    // The draw count is the uint32 at countBufferOffset of countBuffer, written on the gpu e.g. by a culling pass, and
+    // clamped to maxDrawCount. Both buffers are in the IndirectCommands state and both offsets are multiples of 4
+    virtual void DrawIndexedIndirectCount(RefCountPtr<RHIBuffer>& indirectCommands, RefCountPtr<RHIBuffer>& countBuffer, uint32_t maxDrawCount, size_t commandsBufferOffset = 0, size_t countBufferOffset = 0) = 0;
     virtual void Dispatch(uint32_t threadGroupX, uint32_t threadGroupY, uint32_t threadGroupZ) = 0;
     virtual void DispatchIndirect(RefCountPtr<RHIBuffer>& indirectCommands, uint32_t count, size_t commandsBufferOffset = 0) = 0;
     virtual void DispatchMesh(uint32_t threadGroupX, uint32_t threadGroupY, uint32_t threadGroupZ) = 0;
     virtual void DispatchMeshIndirect(RefCountPtr<RHIBuffer>& indirectCommands, uint32_t count, size_t commandsBufferOffset = 0) = 0;
+    // Same as DrawIndexedIndirectCount for RHIDispatchArguments
+    virtual void DispatchMeshIndirectCount(RefCountPtr<RHIBuffer>& indirectCommands, RefCountPtr<RHIBuffer>& countBuffer, uint32_t maxCount, size_t commandsBufferOffset = 0, size_t countBufferOffset = 0) = 0;
     virtual void DispatchRays(uint32_t width, uint32_t height, uint32_t depth, const RHIShaderTable& shaderTable) = 0;
 };
\ No newline at end of file
@@ -0,0 +1,246 @@
+#include "RHICommandListPool.h"
+#include "RHIDevice.h"
+#include "RHICommandList.h"
+#include "../Core/Log.h"
+
+RHICommandListPool::RHICommandListPool(RHIDevice& inDevice)
+    : m_Device(inDevice)
+{
+
+}
+
+RHICommandListPool::~RHICommandListPool()
+{
+    Clear();
+}
+
+RefCountPtr<RHICommandList> RHICommandListPool::Acquire(ERHICommandQueueType inType)
+{
+    const std::thread::id thread = std::this_thread::get_id();
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        ++m_Stats.Acquires;
+        FreeLists& threadLists = m_FreeLists[thread];
+        threadLists.LastAcquire = m_NumRetires;
+        std::vector<RefCountPtr<RHICommandList>>& freeLists = threadLists.CommandLists[static_cast<uint8_t>(inType)];
+        if(!freeLists.empty())
+        {
+            RefCountPtr<RHICommandList> commandList = std::move(freeLists.back());
+            freeLists.pop_back();
+            return commandList;
+        }
+        ++m_Stats.Creates;
+    }
+
+    // Created outside the lock, the other threads keep acquiring their free lists meanwhile
+    RefCountPtr<RHICommandList> commandList = m_Device.CreateCommandList(inType);
+    if(!commandList.IsValid() || !commandList->IsValid())
+    {
+        Log::Error("[RHI] The command list pool failed to create a command list");
+        return nullptr;
+    }
+    commandList->SetName("PooledCommandList");
+    commandList->Begin();
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Owners[commandList.GetReference()].Thread = thread;
+    ++m_Stats.CommandLists;
+    return commandList;
+}
+
+void RHICommandListPool::Release(const RefCountPtr<RHICommandList>* inCommandLists, uint32_t inCount)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    for(uint32_t i = 0; i < inCount; ++i)
+    {
+        auto iter = m_Owners.find(inCommandLists[i].GetReference());
+        if(iter == m_Owners.end())
+        {
+            Log::Warning("[RHI] The released command list was not acquired from the command list pool");
+            continue;
+        }
+        m_Released.push_back({inCommandLists[i], iter->second});
+        ++m_Stats.InFlight;
+    }
+}
+
+bool RHICommandListPool::GetExecuteSignal(const RefCountPtr<RHICommandList>* inCommandLists, uint32_t inCount, RHIQueueFenceValue& outSignal)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    if(m_Owners.empty())
+    {
+        return false;
+    }
+
+    std::vector<Owner*> owners;
+    for(uint32_t i = 0; i < inCount; ++i)
+    {
+        auto iter = m_Owners.find(inCommandLists[i].GetReference());
+        if(iter != m_Owners.end())
+        {
+            owners.push_back(&iter->second);
+        }
+    }
+    if(owners.empty())
+    {
+        return false;
+    }
+
+    // The lists of one submit belong to one queue
+    const uint8_t queueIndex = static_cast<uint8_t>(inCommandLists[0]->GetQueueType());
+    RefCountPtr<RHITimelineFence>& fence = m_QueueFences[queueIndex];
+    if(!fence.IsValid())
+    {
+        fence = m_Device.CreateTimelineFence(0);
+        if(!fence.IsValid() || !fence->IsValid())
+        {
+            // The lists fall back to the fence of the next Submit
+            Log::Error("[RHI] The command list pool failed to create the fence of a queue");
+            fence = nullptr;
+            return false;
+        }
+        fence->SetName("CommandListPoolFence");
+    }
+
+    const uint64_t value = ++m_QueueFenceValues[queueIndex];
+    for(Owner* owner : owners)
+    {
+        owner->FenceValue = value;
+    }
+    outSignal.Fence = fence;
+    outSignal.Value = value;
+    return true;
+}
+
+void RHICommandListPool::Submit(const RefCountPtr<RHIFence>& inFence)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    if(m_Released.empty())
+    {
+        return;
+    }
+
+    Submission submission;
+    submission.Fence = inFence;
+    submission.CommandLists = std::move(m_Released);
+    m_Released.clear();
+    m_Submitted.push_back(std::move(submission));
+}
+
+bool RHICommandListPool::IsCompleted(const Submission& inSubmission, const PooledList& inPooledList)
+{
+    if(inPooledList.ListOwner.FenceValue == 0)
+    {
+        return !inSubmission.Fence.IsValid() || inSubmission.Fence->IsCompleted();
+    }
+    return IsQueueCompleted(inPooledList);
+}
+
+bool RHICommandListPool::IsQueueCompleted(const PooledList& inPooledList)
+{
+    const uint8_t queueIndex = static_cast<uint8_t>(inPooledList.CommandList->GetQueueType());
+    return inPooledList.ListOwner.FenceValue != 0 && m_QueueFences[queueIndex]->IsCompleted(inPooledList.ListOwner.FenceValue);
+}
+
+// Resets the allocator or pool of the list, the acquiring thread records right away. An abandoned list is still open
+void RHICommandListPool::Recycle(PooledList& inPooledList)
+{
+    if(!inPooledList.CommandList->IsClosed())
+    {
+        inPooledList.CommandList->End();
+    }
+    inPooledList.CommandList->Begin();
+    m_Owners[inPooledList.CommandList.GetReference()].FenceValue = 0;
+    const uint8_t queueIndex = static_cast<uint8_t>(inPooledList.CommandList->GetQueueType());
+    m_FreeLists[inPooledList.ListOwner.Thread].CommandLists[queueIndex].push_back(std::move(inPooledList.CommandList));
+}
+
+void RHICommandListPool::Retire()
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    ++m_NumRetires;
+    
+    // The executed lists know their queue fence, they do not wait for the next Submit
+    for(size_t i = 0; i < m_Released.size();)
+    {
+        if(IsQueueCompleted(m_Released[i]))
+        {
+            Recycle(m_Released[i]);
+            m_Released.erase(m_Released.begin() + i);
+            --m_Stats.InFlight;
+        }
+        else
+        {
+            ++i;
+        }
+    }
+    
+    // The queues finish independently, the lists of a later submission may complete before the ones of an earlier one
+    for(auto iter = m_Submitted.begin(); iter != m_Submitted.end();)
+    {
+        std::vector<PooledList>& commandLists = iter->CommandLists;
+        for(size_t i = 0; i < commandLists.size();)
+        {
+            if(!IsCompleted(*iter, commandLists[i]))
+            {
+                ++i;
+                continue;
+            }
+            Recycle(commandLists[i]);
+            commandLists.erase(commandLists.begin() + i);
+            --m_Stats.InFlight;
+        }
+        iter = commandLists.empty() ? m_Submitted.erase(iter) : iter + 1;
+    }
+    ReleaseIdleThreads();
+}
+
+// The free lists of threads which stopped recording, e.g. the ones of finished jobs, are not kept forever
+void RHICommandListPool::ReleaseIdleThreads()
+{
+    for(auto iter = m_FreeLists.begin(); iter != m_FreeLists.end();)
+    {
+        if(m_NumRetires - iter->second.LastAcquire <= s_MaxIdleRetires)
+        {
+            ++iter;
+            continue;
+        }
+        
+        for(std::vector<RefCountPtr<RHICommandList>>& commandLists : iter->second.CommandLists)
+        {
+            for(RefCountPtr<RHICommandList>& commandList : commandLists)
+            {
+                m_Owners.erase(commandList.GetReference());
+                --m_Stats.CommandLists;
+            }
+        }
+        iter = m_FreeLists.erase(iter);
+    }
+}
+
+void RHICommandListPool::Clear()
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_FreeLists.clear();
+    m_Owners.clear();
+    m_Released.clear();
+    m_Submitted.clear();
+    m_QueueFences.fill(nullptr);
+    m_QueueFenceValues.fill(0);
+    m_NumRetires = 0;
+    m_Stats.CommandLists = 0;
+    m_Stats.InFlight = 0;
+}
+
+RHICommandListPoolStats RHICommandListPool::GetStats() const
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_Stats;
+}
+
+void RHICommandListPool::ResetStats()
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Stats.Acquires = 0;
+    m_Stats.Creates = 0;
+}
\ No newline at end of file
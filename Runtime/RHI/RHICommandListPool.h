@@ -0,0 +1,99 @@
+#pragma once
+
+#include "RHIDefinitions.h"
+#include <deque>
+#include <mutex>
+#include <thread>
+
+class RHIDevice;
+class RHIFence;
+class RHITimelineFence;
+class RHICommandList;
+struct RHIQueueFenceValue;
+
+struct RHICommandListPoolStats
+{
+    uint32_t CommandLists = 0;  // created by the pool, recording, in flight or free
+    uint32_t InFlight = 0;      // released lists whose execution did not complete yet
+    uint64_t Acquires = 0;
+    uint64_t Creates = 0;       // acquires which found no free list of the queue type and thread
+};
+
+// Recycles command lists, each with its own command allocator or pool, for transient per pass or per thread recording.
+// Acquire hands out a recording list of the queue type created for the calling thread, Release returns it once it was
+// executed. The pool keeps a timeline fence per queue type which the devices signal after each submit of pooled lists,
+// a released list is reused once the fence of its queue reached the value of its last submit, without waiting for the
+// next Submit. Lists which were never executed wait for the fence of the next Submit instead. Retire begins them in bulk
+// so their allocators are reset before a thread acquires them again, and releases the free lists of the threads which
+// did not acquire for s_MaxIdleRetires retires. RHIFrameContext drives it: Retire in BeginFrame and Submit in EndFrame.
+class RHICommandListPool
+{
+public:
+    static constexpr uint64_t s_MaxIdleRetires = 64;
+    
+    explicit RHICommandListPool(RHIDevice& inDevice);
+    ~RHICommandListPool();
+    RHICommandListPool(const RHICommandListPool&) = delete;
+    RHICommandListPool& operator=(const RHICommandListPool&) = delete;
+
+    // Returns a list whose Begin was called, null if the device fails to create one
+    RefCountPtr<RHICommandList> Acquire(ERHICommandQueueType inType = ERHICommandQueueType::Direct);
+    // Every acquired list is released once it was executed or abandoned, it is not touched until the next Submit
+    void Release(const RefCountPtr<RHICommandList>* inCommandLists, uint32_t inCount);
+    void Release(const RefCountPtr<RHICommandList>& inCommandList) { Release(&inCommandList, 1); }
+
+    // The lists released since the last submit are reused once their queue finished them, or inFence is signaled for
+    // the lists which were not executed
+    void Submit(const RefCountPtr<RHIFence>& inFence);
+    // Called by the devices in ExecuteCommandLists, stamps the pooled lists with the next value of the fence of their
+    // queue. Returns false if no list is pooled, the device signals outSignal after the lists otherwise
+    bool GetExecuteSignal(const RefCountPtr<RHICommandList>* inCommandLists, uint32_t inCount, RHIQueueFenceValue& outSignal);
+    // Begins the lists whose fence is signaled and returns them to their threads, does not block
+    void Retire();
+    // Releases every list, the caller waits for the gpu before
+    void Clear();
+
+    RHICommandListPoolStats GetStats() const;
+    void ResetStats();
+
+private:
+    struct Owner
+    {
+        std::thread::id Thread;     // the thread which acquired the list first, it gets it back
+        uint64_t FenceValue = 0;    // the value of the queue fence signaled by the last submit of the list, 0 if none
+    };
+    
+    struct PooledList
+    {
+        RefCountPtr<RHICommandList> CommandList;
+        Owner ListOwner;
+    };
+
+    struct Submission
+    {
+        RefCountPtr<RHIFence> Fence;
+        std::vector<PooledList> CommandLists;
+    };
+
+    struct FreeLists
+    {
+        std::array<std::vector<RefCountPtr<RHICommandList>>, static_cast<uint8_t>(ERHICommandQueueType::Count)> CommandLists;
+        uint64_t LastAcquire = 0;   // the retire count when the thread acquired last
+    };
+
+    bool IsCompleted(const Submission& inSubmission, const PooledList& inPooledList);
+    bool IsQueueCompleted(const PooledList& inPooledList);
+    void Recycle(PooledList& inPooledList);
+    void ReleaseIdleThreads();
+
+    RHIDevice& m_Device;
+    mutable std::mutex m_Mutex;
+    std::unordered_map<std::thread::id, FreeLists> m_FreeLists;
+    std::unordered_map<const RHICommandList*, Owner> m_Owners;
+    std::vector<PooledList> m_Released;
+    std::deque<Submission> m_Submitted;
+    std::array<RefCountPtr<RHITimelineFence>, static_cast<uint8_t>(ERHICommandQueueType::Count)> m_QueueFences;
+    std::array<uint64_t, static_cast<uint8_t>(ERHICommandQueueType::Count)> m_QueueFenceValues{};
+    uint64_t m_NumRetires = 0;
+    RHICommandListPoolStats m_Stats;
+};
\ No newline at end of file
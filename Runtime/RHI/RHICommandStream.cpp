@@ -0,0 +1,896 @@
+#include "RHICommandStream.h"
+#include "RHI.h"
+#include "../Core/Log.h"
+#include "../Core/Templates.h"
+#include <cstring>
+#include <fstream>
+
+///////////////////////////////////////////////////////////////////////////////////
+/// Command payloads
+///////////////////////////////////////////////////////////////////////////////////
+struct RHICmdObject
+{
+    uint32_t Object;
+};
+
+struct RHICmdSetFrameBuffer
+{
+    enum EClear : uint8_t { None, Color, ColorDepthStencil };
+    
+    uint32_t FrameBuffer;
+    uint32_t NumRenderTargets;
+    float Depth;
+    uint8_t Stencil;
+    EClear Clear;
+    RHIClearValue Colors[RHIRenderTargetsMaxCount];
+};
+
+struct RHICmdBarrier
+{
+    uint32_t Resource;
+    ERHIResourceStates AfterState;
+};
+
+struct RHICmdSubresourceBarrier
+{
+    uint32_t Resource;
+    RHITextureSubResource SubResource;
+    ERHIResourceStates AfterState;
+};
+
+struct RHICmdBindBuffer
+{
+    uint32_t Buffer;
+    uint64_t Offset;
+};
+
+struct RHICmdCopyBuffer
+{
+    uint32_t Dst;
+    uint32_t Src;
+    uint64_t DstOffset;
+    uint64_t SrcOffset;
+    uint64_t Size;
+};
+
+struct RHICmdTextureSlice
+{
+    uint32_t X, Y, Z;
+    uint32_t Width, Height, Depth;
+    uint32_t MipLevel;
+    uint32_t ArraySlice;
+
+    static RHICmdTextureSlice From(const RHITextureSlice& inSlice)
+    {
+        return {inSlice.X, inSlice.Y, inSlice.Z, inSlice.Width, inSlice.Height, inSlice.Depth, inSlice.MipLevel, inSlice.ArraySlice};
+    }
+
+    RHITextureSlice To(const RHITextureDesc& inDesc) const
+    {
+        RHITextureSlice slice(inDesc, MipLevel, ArraySlice);
+        slice.X = X; slice.Y = Y; slice.Z = Z;
+        slice.Width = Width; slice.Height = Height; slice.Depth = Depth;
+        return slice;
+    }
+};
+
+struct RHICmdCopyTexture
+{
+    uint32_t Dst;
+    uint32_t Src;
+    RHICmdTextureSlice DstSlice;
+    RHICmdTextureSlice SrcSlice;
+    uint64_t SrcOffset; // buffer to texture
+};
+
+struct RHICmdDraw
+{
+    uint32_t Count;
+    uint32_t InstanceCount;
+    uint32_t FirstIndex;
+    uint32_t VertexOffset;
+    uint32_t FirstInstance;
+};
+
+struct RHICmdIndirect
+{
+    uint32_t Buffer;
+    uint32_t Count;
+    uint64_t Offset;
+};
+
+struct RHICmdIndirectCount
+{
+    uint32_t Buffer;
+    uint32_t CountBuffer;
+    uint64_t Offset;
+    uint64_t CountOffset;
+    uint32_t MaxCount;
+    uint32_t Padding;
+};
+
+struct RHICmdDispatch
+{
+    uint32_t X, Y, Z;
+};
+
+template<typename T>
+static T ReadPayload(const uint8_t* inData)
+{
+    T payload;
+    memcpy(&payload, inData, sizeof(T));
+    return payload;
+}
+
+///////////////////////////////////////////////////////////////////////////////////
+/// Recording
+///////////////////////////////////////////////////////////////////////////////////
+void RHICommandStream::Reset()
+{
+    m_Data.clear();
+    m_NumCommands = 0;
+    m_Objects.clear();
+    m_ObjectInfos.clear();
+    m_ObjectIndices.clear();
+}
+
+uint32_t RHICommandStream::AddObject(RHIObject* inObject, ERHICommandObjectType inType)
+{
+    if(inObject == nullptr)
+    {
+        return InvalidObject;
+    }
+    
+    auto iter = m_ObjectIndices.find(inObject);
+    if(iter != m_ObjectIndices.end())
+    {
+        return iter->second;
+    }
+
+    RHICommandStreamObject info;
+    info.Type = inType;
+    info.Name = inObject->GetName();
+    if(inType == ERHICommandObjectType::Buffer)
+    {
+        info.BufferDesc = static_cast<RHIBuffer*>(inObject)->GetDesc();
+    }
+    else if(inType == ERHICommandObjectType::Texture)
+    {
+        info.TextureDesc = static_cast<RHITexture*>(inObject)->GetDesc();
+    }
+
+    const uint32_t index = static_cast<uint32_t>(m_Objects.size());
+    m_Objects.emplace_back(inObject);
+    m_ObjectInfos.emplace_back(std::move(info));
+    m_ObjectIndices.emplace(inObject, index);
+    return index;
+}
+
+uint8_t* RHICommandStream::AllocateCommand(ERHICommandOp inOp, size_t inPayloadSize)
+{
+    CommandHeader header;
+    header.Op = inOp;
+    header.Padding = 0;
+    header.Size = static_cast<uint32_t>(Align(inPayloadSize, CommandAlignment));
+
+    const size_t offset = m_Data.size();
+    m_Data.resize(offset + sizeof(CommandHeader) + header.Size, 0);
+    memcpy(m_Data.data() + offset, &header, sizeof(CommandHeader));
+    ++m_NumCommands;
+    return m_Data.data() + offset + sizeof(CommandHeader);
+}
+
+void RHICommandStream::BeginMark(const char* name)
+{
+    const size_t length = strlen(name);
+    memcpy(AllocateCommand(ERHICommandOp::BeginMark, length + 1), name, length + 1);
+}
+
+void RHICommandStream::EndMark()
+{
+    AllocateCommand(ERHICommandOp::EndMark, 0);
+}
+
+void RHICommandStream::SetPipelineState(const RefCountPtr<RHIComputePipeline>& inPipelineState)
+{
+    WriteCommand(ERHICommandOp::SetComputePipeline, RHICmdObject{AddObject(inPipelineState.GetReference(), ERHICommandObjectType::ComputePipeline)});
+}
+
+void RHICommandStream::SetPipelineState(const RefCountPtr<RHIGraphicsPipeline>& inPipelineState)
+{
+    WriteCommand(ERHICommandOp::SetGraphicsPipeline, RHICmdObject{AddObject(inPipelineState.GetReference(), ERHICommandObjectType::GraphicsPipeline)});
+}
+
+void RHICommandStream::SetFrameBuffer(const RefCountPtr<RHIFrameBuffer>& inFrameBuffer)
+{
+    RHICmdSetFrameBuffer cmd{};
+    cmd.FrameBuffer = AddObject(inFrameBuffer.GetReference(), ERHICommandObjectType::FrameBuffer);
+    cmd.Clear = RHICmdSetFrameBuffer::None;
+    WriteCommand(ERHICommandOp::SetFrameBuffer, cmd);
+}
+
+void RHICommandStream::SetFrameBuffer(const RefCountPtr<RHIFrameBuffer>& inFrameBuffer
+    , const RHIClearValue* inColor , uint32_t inNumRenderTargets)
+{
+    RHICmdSetFrameBuffer cmd{};
+    cmd.FrameBuffer = AddObject(inFrameBuffer.GetReference(), ERHICommandObjectType::FrameBuffer);
+    cmd.Clear = RHICmdSetFrameBuffer::Color;
+    cmd.NumRenderTargets = std::min(inNumRenderTargets, RHIRenderTargetsMaxCount);
+    for(uint32_t i = 0; i < cmd.NumRenderTargets; ++i)
+    {
+        cmd.Colors[i] = inColor[i];
+    }
+    WriteCommand(ERHICommandOp::SetFrameBuffer, cmd);
+}
+
+void RHICommandStream::SetFrameBuffer(const RefCountPtr<RHIFrameBuffer>& inFrameBuffer
+    , const RHIClearValue* inColor , uint32_t inNumRenderTargets
+    , float inDepth, uint8_t inStencil)
+{
+    RHICmdSetFrameBuffer cmd{};
+    cmd.FrameBuffer = AddObject(inFrameBuffer.GetReference(), ERHICommandObjectType::FrameBuffer);
+    cmd.Clear = RHICmdSetFrameBuffer::ColorDepthStencil;
+    cmd.NumRenderTargets = std::min(inNumRenderTargets, RHIRenderTargetsMaxCount);
+    for(uint32_t i = 0; i < cmd.NumRenderTargets; ++i)
+    {
+        cmd.Colors[i] = inColor[i];
+    }
+    cmd.Depth = inDepth;
+    cmd.Stencil = inStencil;
+    WriteCommand(ERHICommandOp::SetFrameBuffer, cmd);
+}
+
+void RHICommandStream::SetViewports(const std::vector<RHIViewport>& inViewports)
+{
+    const uint32_t count = static_cast<uint32_t>(inViewports.size());
+    uint8_t* payload = AllocateCommand(ERHICommandOp::SetViewports, CommandAlignment + count * sizeof(RHIViewport));
+    memcpy(payload, &count, sizeof(uint32_t));
+    memcpy(payload + CommandAlignment, inViewports.data(), count * sizeof(RHIViewport));
+}
+
+void RHICommandStream::SetScissorRects(const std::vector<RHIRect>& inRects)
+{
+    const uint32_t count = static_cast<uint32_t>(inRects.size());
+    uint8_t* payload = AllocateCommand(ERHICommandOp::SetScissorRects, CommandAlignment + count * sizeof(RHIRect));
+    memcpy(payload, &count, sizeof(uint32_t));
+    memcpy(payload + CommandAlignment, inRects.data(), count * sizeof(RHIRect));
+}
+
+void RHICommandStream::ResourceBarrier(const RefCountPtr<RHITexture>& inResource, ERHIResourceStates inAfterState)
+{
+    WriteCommand(ERHICommandOp::TextureBarrier, RHICmdBarrier{AddObject(inResource.GetReference(), ERHICommandObjectType::Texture), inAfterState});
+}
+
+void RHICommandStream::ResourceBarrier(const RefCountPtr<RHITexture>& inResource, const RHITextureSubResource& inSubResource, ERHIResourceStates inAfterState)
+{
+    WriteCommand(ERHICommandOp::TextureSubresourceBarrier, RHICmdSubresourceBarrier{AddObject(inResource.GetReference(), ERHICommandObjectType::Texture), inSubResource, inAfterState});
+}
+
+void RHICommandStream::ResourceBarrier(const RefCountPtr<RHIBuffer>& inResource, ERHIResourceStates inAfterState)
+{
+    WriteCommand(ERHICommandOp::BufferBarrier, RHICmdBarrier{AddObject(inResource.GetReference(), ERHICommandObjectType::Buffer), inAfterState});
+}
+
+void RHICommandStream::SetResourceSet(const RefCountPtr<RHIResourceSet>& inResourceSet)
+{
+    WriteCommand(ERHICommandOp::SetResourceSet, RHICmdObject{AddObject(inResourceSet.GetReference(), ERHICommandObjectType::ResourceSet)});
+}
+
+void RHICommandStream::SetPushConstants(const void* inData, uint32_t inSize)
+{
+    uint8_t* payload = AllocateCommand(ERHICommandOp::SetPushConstants, CommandAlignment + inSize);
+    memcpy(payload, &inSize, sizeof(uint32_t));
+    memcpy(payload + CommandAlignment, inData, inSize);
+}
+
+void RHICommandStream::SetVertexBuffer(const RefCountPtr<RHIBuffer>& inBuffer, size_t inOffset)
+{
+    WriteCommand(ERHICommandOp::SetVertexBuffer, RHICmdBindBuffer{AddObject(inBuffer.GetReference(), ERHICommandObjectType::Buffer), inOffset});
+}
+
+void RHICommandStream::SetIndexBuffer(const RefCountPtr<RHIBuffer>& inBuffer, size_t inOffset)
+{
+    WriteCommand(ERHICommandOp::SetIndexBuffer, RHICmdBindBuffer{AddObject(inBuffer.GetReference(), ERHICommandObjectType::Buffer), inOffset});
+}
+
+void RHICommandStream::CopyBuffer(const RefCountPtr<RHIBuffer>& dstBuffer, size_t dstOffset, const RefCountPtr<RHIBuffer>& srcBuffer, size_t srcOffset, size_t size)
+{
+    RHICmdCopyBuffer cmd;
+    cmd.Dst = AddObject(dstBuffer.GetReference(), ERHICommandObjectType::Buffer);
+    cmd.Src = AddObject(srcBuffer.GetReference(), ERHICommandObjectType::Buffer);
+    cmd.DstOffset = dstOffset;
+    cmd.SrcOffset = srcOffset;
+    cmd.Size = size;
+    WriteCommand(ERHICommandOp::CopyBuffer, cmd);
+}
+
+void RHICommandStream::CopyBufferToTexture(const RefCountPtr<RHITexture>& dstTexture, const RefCountPtr<RHIBuffer>& srcBuffer)
+{
+    RHICmdCopyTexture cmd{};
+    cmd.Dst = AddObject(dstTexture.GetReference(), ERHICommandObjectType::Texture);
+    cmd.Src = AddObject(srcBuffer.GetReference(), ERHICommandObjectType::Buffer);
+    WriteCommand(ERHICommandOp::CopyBufferToTexture, cmd);
+}
+
+void RHICommandStream::CopyBufferToTexture(const RefCountPtr<RHITexture>& dstTexture, const RHITextureSlice& dstSlice, const RefCountPtr<RHIBuffer>& srcBuffer, size_t srcOffset)
+{
+    RHICmdCopyTexture cmd{};
+    cmd.Dst = AddObject(dstTexture.GetReference(), ERHICommandObjectType::Texture);
+    cmd.Src = AddObject(srcBuffer.GetReference(), ERHICommandObjectType::Buffer);
+    cmd.DstSlice = RHICmdTextureSlice::From(dstSlice);
+    cmd.SrcOffset = srcOffset;
+    WriteCommand(ERHICommandOp::CopyBufferToTextureSlice, cmd);
+}
+
+void RHICommandStream::CopyTexture(const RefCountPtr<RHITexture>& dstTexture, const RefCountPtr<RHITexture>& srcTexture)
+{
+    RHICmdCopyTexture cmd{};
+    cmd.Dst = AddObject(dstTexture.GetReference(), ERHICommandObjectType::Texture);
+    cmd.Src = AddObject(srcTexture.GetReference(), ERHICommandObjectType::Texture);
+    WriteCommand(ERHICommandOp::CopyTexture, cmd);
+}
+
+void RHICommandStream::CopyTexture(const RefCountPtr<RHITexture>& dstTexture, const RHITextureSlice& dstSlice, const RefCountPtr<RHITexture>& srcTexture, const RHITextureSlice& srcSlice)
+{
+    RHICmdCopyTexture cmd{};
+    cmd.Dst = AddObject(dstTexture.GetReference(), ERHICommandObjectType::Texture);
+    cmd.Src = AddObject(srcTexture.GetReference(), ERHICommandObjectType::Texture);
+    cmd.DstSlice = RHICmdTextureSlice::From(dstSlice);
+    cmd.SrcSlice = RHICmdTextureSlice::From(srcSlice);
+    WriteCommand(ERHICommandOp::CopyTextureSlice, cmd);
+}
+
+void RHICommandStream::Draw(uint32_t vertexCount, uint32_t instanceCount, uint32_t vertexOffset, uint32_t firstInstance)
+{
+    WriteCommand(ERHICommandOp::Draw, RHICmdDraw{vertexCount, instanceCount, 0, vertexOffset, firstInstance});
+}
+
+void RHICommandStream::DrawIndirect(const RefCountPtr<RHIBuffer>& indirectCommands, uint32_t drawCount, size_t commandsBufferOffset)
+{
+    WriteCommand(ERHICommandOp::DrawIndirect, RHICmdIndirect{AddObject(indirectCommands.GetReference(), ERHICommandObjectType::Buffer), drawCount, commandsBufferOffset});
+}
+
+void RHICommandStream::DrawIndexed(uint32_t indexCount, uint32_t instanceCount, uint32_t firstIndex, uint32_t vertexOffset, uint32_t firstInstance)
+{
+    WriteCommand(ERHICommandOp::DrawIndexed, RHICmdDraw{indexCount, instanceCount, firstIndex, vertexOffset, firstInstance});
+}
+
+void RHICommandStream::DrawIndexedIndirect(const RefCountPtr<RHIBuffer>& indirectCommands, uint32_t drawCount, size_t commandsBufferOffset)
+{
+    WriteCommand(ERHICommandOp::DrawIndexedIndirect, RHICmdIndirect{AddObject(indirectCommands.GetReference(), ERHICommandObjectType::Buffer), drawCount, commandsBufferOffset});
+}
+
+void RHICommandStream::DrawIndexedIndirectCount(const RefCountPtr<RHIBuffer>& indirectCommands, const RefCountPtr<RHIBuffer>& countBuffer, uint32_t maxDrawCount, size_t commandsBufferOffset, size_t countBufferOffset)
+{
+    WriteCommand(ERHICommandOp::DrawIndexedIndirectCount, RHICmdIndirectCount{AddObject(indirectCommands.GetReference(), ERHICommandObjectType::Buffer)
+        , AddObject(countBuffer.GetReference(), ERHICommandObjectType::Buffer), commandsBufferOffset, countBufferOffset, maxDrawCount, 0});
+}
+
+void RHICommandStream::Dispatch(uint32_t threadGroupX, uint32_t threadGroupY, uint32_t threadGroupZ)
+{
+    WriteCommand(ERHICommandOp::Dispatch, RHICmdDispatch{threadGroupX, threadGroupY, threadGroupZ});
+}
+
+void RHICommandStream::DispatchIndirect(const RefCountPtr<RHIBuffer>& indirectCommands, uint32_t count, size_t commandsBufferOffset)
+{
+    WriteCommand(ERHICommandOp::DispatchIndirect, RHICmdIndirect{AddObject(indirectCommands.GetReference(), ERHICommandObjectType::Buffer), count, commandsBufferOffset});
+}
+
+void RHICommandStream::DispatchMesh(uint32_t threadGroupX, uint32_t threadGroupY, uint32_t threadGroupZ)
+{
+    WriteCommand(ERHICommandOp::DispatchMesh, RHICmdDispatch{threadGroupX, threadGroupY, threadGroupZ});
+}
+
+void RHICommandStream::DispatchMeshIndirect(const RefCountPtr<RHIBuffer>& indirectCommands, uint32_t count, size_t commandsBufferOffset)
+{
+    WriteCommand(ERHICommandOp::DispatchMeshIndirect, RHICmdIndirect{AddObject(indirectCommands.GetReference(), ERHICommandObjectType::Buffer), count, commandsBufferOffset});
+}
+
+void RHICommandStream::DispatchMeshIndirectCount(const RefCountPtr<RHIBuffer>& indirectCommands, const RefCountPtr<RHIBuffer>& countBuffer, uint32_t maxCount, size_t commandsBufferOffset, size_t countBufferOffset)
+{
+    WriteCommand(ERHICommandOp::DispatchMeshIndirectCount, RHICmdIndirectCount{AddObject(indirectCommands.GetReference(), ERHICommandObjectType::Buffer)
+        , AddObject(countBuffer.GetReference(), ERHICommandObjectType::Buffer), commandsBufferOffset, countBufferOffset, maxCount, 0});
+}
+
+///////////////////////////////////////////////////////////////////////////////////
+/// Replay
+///////////////////////////////////////////////////////////////////////////////////
+uint32_t RHICommandStream::Replay(RHICommandList* inCmdList) const
+{
+    if(inCmdList == nullptr || inCmdList->IsClosed())
+    {
+        Log::Error("[RHI] Failed to replay command stream, the command list is not open");
+        return 0;
+    }
+
+    // Resolves an object index to a typed reference, nullptr when the object was not resolved on load
+    auto getObject = [this](uint32_t inIndex) -> RHIObject*
+    {
+        return inIndex < m_Objects.size() ? m_Objects[inIndex].GetReference() : nullptr;
+    };
+
+    uint32_t numReplayed = 0;
+    size_t offset = 0;
+    while(offset < m_Data.size())
+    {
+        const CommandHeader header = ReadPayload<CommandHeader>(m_Data.data() + offset);
+        const uint8_t* payload = m_Data.data() + offset + sizeof(CommandHeader);
+        offset += sizeof(CommandHeader) + header.Size;
+        
+        switch (header.Op)
+        {
+        case ERHICommandOp::BeginMark:
+            inCmdList->BeginMark(reinterpret_cast<const char*>(payload));
+            break;
+        case ERHICommandOp::EndMark:
+            inCmdList->EndMark();
+            break;
+        case ERHICommandOp::SetComputePipeline:
+        {
+            RefCountPtr<RHIComputePipeline> pipeline(static_cast<RHIComputePipeline*>(getObject(ReadPayload<RHICmdObject>(payload).Object)));
+            if(!pipeline)
+                continue;
+            inCmdList->SetPipelineState(pipeline);
+            break;
+        }
+        case ERHICommandOp::SetGraphicsPipeline:
+        {
+            RefCountPtr<RHIGraphicsPipeline> pipeline(static_cast<RHIGraphicsPipeline*>(getObject(ReadPayload<RHICmdObject>(payload).Object)));
+            if(!pipeline)
+                continue;
+            inCmdList->SetPipelineState(pipeline);
+            break;
+        }
+        case ERHICommandOp::SetFrameBuffer:
+        {
+            const RHICmdSetFrameBuffer cmd = ReadPayload<RHICmdSetFrameBuffer>(payload);
+            RefCountPtr<RHIFrameBuffer> frameBuffer(static_cast<RHIFrameBuffer*>(getObject(cmd.FrameBuffer)));
+            if(!frameBuffer)
+                continue;
+            if(cmd.Clear == RHICmdSetFrameBuffer::ColorDepthStencil)
+                inCmdList->SetFrameBuffer(frameBuffer, cmd.Colors, cmd.NumRenderTargets, cmd.Depth, cmd.Stencil);
+            else if(cmd.Clear == RHICmdSetFrameBuffer::Color)
+                inCmdList->SetFrameBuffer(frameBuffer, cmd.Colors, cmd.NumRenderTargets);
+            else
+                inCmdList->SetFrameBuffer(frameBuffer);
+            break;
+        }
+        case ERHICommandOp::SetViewports:
+        {
+            std::vector<RHIViewport> viewports(ReadPayload<uint32_t>(payload));
+            memcpy(viewports.data(), payload + CommandAlignment, viewports.size() * sizeof(RHIViewport));
+            inCmdList->SetViewports(viewports);
+            break;
+        }
+        case ERHICommandOp::SetScissorRects:
+        {
+            std::vector<RHIRect> rects(ReadPayload<uint32_t>(payload));
+            memcpy(rects.data(), payload + CommandAlignment, rects.size() * sizeof(RHIRect));
+            inCmdList->SetScissorRects(rects);
+            break;
+        }
+        case ERHICommandOp::TextureBarrier:
+        {
+            const RHICmdBarrier cmd = ReadPayload<RHICmdBarrier>(payload);
+            RefCountPtr<RHITexture> texture(static_cast<RHITexture*>(getObject(cmd.Resource)));
+            if(!texture)
+                continue;
+            inCmdList->ResourceBarrier(texture, cmd.AfterState);
+            break;
+        }
+        case ERHICommandOp::TextureSubresourceBarrier:
+        {
+            const RHICmdSubresourceBarrier cmd = ReadPayload<RHICmdSubresourceBarrier>(payload);
+            RefCountPtr<RHITexture> texture(static_cast<RHITexture*>(getObject(cmd.Resource)));
+            if(!texture)
+                continue;
+            inCmdList->ResourceBarrier(texture, cmd.SubResource, cmd.AfterState);
+            break;
+        }
+        case ERHICommandOp::BufferBarrier:
+        {
+            const RHICmdBarrier cmd = ReadPayload<RHICmdBarrier>(payload);
+            RefCountPtr<RHIBuffer> buffer(static_cast<RHIBuffer*>(getObject(cmd.Resource)));
+            if(!buffer)
+                continue;
+            inCmdList->ResourceBarrier(buffer, cmd.AfterState);
+            break;
+        }
+        case ERHICommandOp::SetResourceSet:
+        {
+            RefCountPtr<RHIResourceSet> resourceSet(static_cast<RHIResourceSet*>(getObject(ReadPayload<RHICmdObject>(payload).Object)));
+            if(!resourceSet)
+                continue;
+            inCmdList->SetResourceSet(resourceSet);
+            break;
+        }
+        case ERHICommandOp::SetPushConstants:
+            inCmdList->SetPushConstants(payload + CommandAlignment, ReadPayload<uint32_t>(payload));
+            break;
+        case ERHICommandOp::SetVertexBuffer:
+        case ERHICommandOp::SetIndexBuffer:
+        {
+            const RHICmdBindBuffer cmd = ReadPayload<RHICmdBindBuffer>(payload);
+            RefCountPtr<RHIBuffer> buffer(static_cast<RHIBuffer*>(getObject(cmd.Buffer)));
+            if(!buffer)
+                continue;
+            if(header.Op == ERHICommandOp::SetVertexBuffer)
+                inCmdList->SetVertexBuffer(buffer, cmd.Offset);
+            else
+                inCmdList->SetIndexBuffer(buffer, cmd.Offset);
+            break;
+        }
+        case ERHICommandOp::CopyBuffer:
+        {
+            const RHICmdCopyBuffer cmd = ReadPayload<RHICmdCopyBuffer>(payload);
+            RefCountPtr<RHIBuffer> dst(static_cast<RHIBuffer*>(getObject(cmd.Dst)));
+            RefCountPtr<RHIBuffer> src(static_cast<RHIBuffer*>(getObject(cmd.Src)));
+            if(!dst || !src)
+                continue;
+            inCmdList->CopyBuffer(dst, cmd.DstOffset, src, cmd.SrcOffset, cmd.Size);
+            break;
+        }
+        case ERHICommandOp::CopyBufferToTexture:
+        case ERHICommandOp::CopyBufferToTextureSlice:
+        {
+            const RHICmdCopyTexture cmd = ReadPayload<RHICmdCopyTexture>(payload);
+            RefCountPtr<RHITexture> dst(static_cast<RHITexture*>(getObject(cmd.Dst)));
+            RefCountPtr<RHIBuffer> src(static_cast<RHIBuffer*>(getObject(cmd.Src)));
+            if(!dst || !src)
+                continue;
+            if(header.Op == ERHICommandOp::CopyBufferToTextureSlice)
+                inCmdList->CopyBufferToTexture(dst, cmd.DstSlice.To(dst->GetDesc()), src, cmd.SrcOffset);
+            else
+                inCmdList->CopyBufferToTexture(dst, src);
+            break;
+        }
+        case ERHICommandOp::CopyTexture:
+        case ERHICommandOp::CopyTextureSlice:
+        {
+            const RHICmdCopyTexture cmd = ReadPayload<RHICmdCopyTexture>(payload);
+            RefCountPtr<RHITexture> dst(static_cast<RHITexture*>(getObject(cmd.Dst)));
+            RefCountPtr<RHITexture> src(static_cast<RHITexture*>(getObject(cmd.Src)));
+            if(!dst || !src)
+                continue;
+            if(header.Op == ERHICommandOp::CopyTextureSlice)
+                inCmdList->CopyTexture(dst, cmd.DstSlice.To(dst->GetDesc()), src, cmd.SrcSlice.To(src->GetDesc()));
+            else
+                inCmdList->CopyTexture(dst, src);
+            break;
+        }
+        case ERHICommandOp::Draw:
+        {
+            const RHICmdDraw cmd = ReadPayload<RHICmdDraw>(payload);
+            inCmdList->Draw(cmd.Count, cmd.InstanceCount, cmd.VertexOffset, cmd.FirstInstance);
+            break;
+        }
+        case ERHICommandOp::DrawIndexed:
+        {
+            const RHICmdDraw cmd = ReadPayload<RHICmdDraw>(payload);
+            inCmdList->DrawIndexed(cmd.Count, cmd.InstanceCount, cmd.FirstIndex, cmd.VertexOffset, cmd.FirstInstance);
+            break;
+        }
+        case ERHICommandOp::DrawIndirect:
+        case ERHICommandOp::DrawIndexedIndirect:
+        case ERHICommandOp::DispatchIndirect:
+        case ERHICommandOp::DispatchMeshIndirect:
+        {
+            const RHICmdIndirect cmd = ReadPayload<RHICmdIndirect>(payload);
+            RefCountPtr<RHIBuffer> buffer(static_cast<RHIBuffer*>(getObject(cmd.Buffer)));
+            if(!buffer)
+                continue;
+            if(header.Op == ERHICommandOp::DrawIndirect)
+                inCmdList->DrawIndirect(buffer, cmd.Count, cmd.Offset);
+            else if(header.Op == ERHICommandOp::DrawIndexedIndirect)
+                inCmdList->DrawIndexedIndirect(buffer, cmd.Count, cmd.Offset);
+            else if(header.Op == ERHICommandOp::DispatchIndirect)
+                inCmdList->DispatchIndirect(buffer, cmd.Count, cmd.Offset);
+            else
+                inCmdList->DispatchMeshIndirect(buffer, cmd.Count, cmd.Offset);
+            break;
+        }
+        case ERHICommandOp::DrawIndexedIndirectCount:
+        case ERHICommandOp::DispatchMeshIndirectCount:
+        {
+            const RHICmdIndirectCount cmd = ReadPayload<RHICmdIndirectCount>(payload);
+            RefCountPtr<RHIBuffer> buffer(static_cast<RHIBuffer*>(getObject(cmd.Buffer)));
+            RefCountPtr<RHIBuffer> countBuffer(static_cast<RHIBuffer*>(getObject(cmd.CountBuffer)));
+            if(!buffer || !countBuffer)
+                continue;
+            if(header.Op == ERHICommandOp::DrawIndexedIndirectCount)
+                inCmdList->DrawIndexedIndirectCount(buffer, countBuffer, cmd.MaxCount, cmd.Offset, cmd.CountOffset);
+            else
+                inCmdList->DispatchMeshIndirectCount(buffer, countBuffer, cmd.MaxCount, cmd.Offset, cmd.CountOffset);
+            break;
+        }
+        case ERHICommandOp::Dispatch:
+        {
+            const RHICmdDispatch cmd = ReadPayload<RHICmdDispatch>(payload);
+            inCmdList->Dispatch(cmd.X, cmd.Y, cmd.Z);
+            break;
+        }
+        case ERHICommandOp::DispatchMesh:
+        {
+            const RHICmdDispatch cmd = ReadPayload<RHICmdDispatch>(payload);
+            inCmdList->DispatchMesh(cmd.X, cmd.Y, cmd.Z);
+            break;
+        }
+        default:
+            Log::Error("[RHI] Unknown command op %u in command stream", static_cast<uint32_t>(header.Op));
+            return numReplayed;
+        }
+        ++numReplayed;
+    }
+
+    if(numReplayed != m_NumCommands)
+    {
+        Log::Warning("[RHI] Skipped %u commands referencing unresolved objects", m_NumCommands - numReplayed);
+    }
+    return numReplayed;
+}
+
+///////////////////////////////////////////////////////////////////////////////////
+/// Serialization
+///////////////////////////////////////////////////////////////////////////////////
+
+bool RHICommandStream::IsValidCommand(const CommandHeader& inHeader, const uint8_t* inPayload) const
+{
+    auto isValidStruct = [&inHeader](size_t inStructSize)
+    {
+        return inHeader.Size == Align(inStructSize, CommandAlignment);
+    };
+    // Variable payloads start with their element count or size, followed by the data at CommandAlignment
+    auto isValidArray = [&inHeader, inPayload](size_t inElementSize)
+    {
+        if(inHeader.Size < CommandAlignment)
+            return false;
+        const size_t size = CommandAlignment + static_cast<size_t>(ReadPayload<uint32_t>(inPayload)) * inElementSize;
+        return inHeader.Size == Align(size, CommandAlignment);
+    };
+    // An unset object is skipped by Replay, any other index has to name an object of the expected type
+    auto isValidObject = [this](uint32_t inIndex, ERHICommandObjectType inType)
+    {
+        return inIndex == InvalidObject || (inIndex < m_ObjectInfos.size() && m_ObjectInfos[inIndex].Type == inType);
+    };
+
+    switch (inHeader.Op)
+    {
+    case ERHICommandOp::BeginMark:
+        // The name is null terminated inside of the payload
+        return inHeader.Size > 0 && memchr(inPayload, 0, inHeader.Size) != nullptr;
+    case ERHICommandOp::EndMark:
+        return inHeader.Size == 0;
+    case ERHICommandOp::SetComputePipeline:
+        return isValidStruct(sizeof(RHICmdObject))
+            && isValidObject(ReadPayload<RHICmdObject>(inPayload).Object, ERHICommandObjectType::ComputePipeline);
+    case ERHICommandOp::SetGraphicsPipeline:
+        return isValidStruct(sizeof(RHICmdObject))
+            && isValidObject(ReadPayload<RHICmdObject>(inPayload).Object, ERHICommandObjectType::GraphicsPipeline);
+    case ERHICommandOp::SetResourceSet:
+        return isValidStruct(sizeof(RHICmdObject))
+            && isValidObject(ReadPayload<RHICmdObject>(inPayload).Object, ERHICommandObjectType::ResourceSet);
+    case ERHICommandOp::SetFrameBuffer:
+    {
+        if(!isValidStruct(sizeof(RHICmdSetFrameBuffer)))
+            return false;
+        const RHICmdSetFrameBuffer cmd = ReadPayload<RHICmdSetFrameBuffer>(inPayload);
+        return cmd.NumRenderTargets <= RHIRenderTargetsMaxCount && cmd.Clear <= RHICmdSetFrameBuffer::ColorDepthStencil
+            && isValidObject(cmd.FrameBuffer, ERHICommandObjectType::FrameBuffer);
+    }
+    case ERHICommandOp::SetViewports:
+        return isValidArray(sizeof(RHIViewport));
+    case ERHICommandOp::SetScissorRects:
+        return isValidArray(sizeof(RHIRect));
+    case ERHICommandOp::SetPushConstants:
+        return isValidArray(1);
+    case ERHICommandOp::TextureBarrier:
+        return isValidStruct(sizeof(RHICmdBarrier))
+            && isValidObject(ReadPayload<RHICmdBarrier>(inPayload).Resource, ERHICommandObjectType::Texture);
+    case ERHICommandOp::BufferBarrier:
+        return isValidStruct(sizeof(RHICmdBarrier))
+            && isValidObject(ReadPayload<RHICmdBarrier>(inPayload).Resource, ERHICommandObjectType::Buffer);
+    case ERHICommandOp::TextureSubresourceBarrier:
+        return isValidStruct(sizeof(RHICmdSubresourceBarrier))
+            && isValidObject(ReadPayload<RHICmdSubresourceBarrier>(inPayload).Resource, ERHICommandObjectType::Texture);
+    case ERHICommandOp::SetVertexBuffer:
+    case ERHICommandOp::SetIndexBuffer:
+        return isValidStruct(sizeof(RHICmdBindBuffer))
+            && isValidObject(ReadPayload<RHICmdBindBuffer>(inPayload).Buffer, ERHICommandObjectType::Buffer);
+    case ERHICommandOp::CopyBuffer:
+    {
+        if(!isValidStruct(sizeof(RHICmdCopyBuffer)))
+            return false;
+        const RHICmdCopyBuffer cmd = ReadPayload<RHICmdCopyBuffer>(inPayload);
+        return isValidObject(cmd.Dst, ERHICommandObjectType::Buffer) && isValidObject(cmd.Src, ERHICommandObjectType::Buffer);
+    }
+    case ERHICommandOp::CopyTexture:
+    case ERHICommandOp::CopyTextureSlice:
+    case ERHICommandOp::CopyBufferToTexture:
+    case ERHICommandOp::CopyBufferToTextureSlice:
+    {
+        if(!isValidStruct(sizeof(RHICmdCopyTexture)))
+            return false;
+        const RHICmdCopyTexture cmd = ReadPayload<RHICmdCopyTexture>(inPayload);
+        const bool isBufferSource = inHeader.Op == ERHICommandOp::CopyBufferToTexture || inHeader.Op == ERHICommandOp::CopyBufferToTextureSlice;
+        return isValidObject(cmd.Dst, ERHICommandObjectType::Texture)
+            && isValidObject(cmd.Src, isBufferSource ? ERHICommandObjectType::Buffer : ERHICommandObjectType::Texture);
+    }
+    case ERHICommandOp::Draw:
+    case ERHICommandOp::DrawIndexed:
+        return isValidStruct(sizeof(RHICmdDraw));
+    case ERHICommandOp::DrawIndirect:
+    case ERHICommandOp::DrawIndexedIndirect:
+    case ERHICommandOp::DispatchIndirect:
+    case ERHICommandOp::DispatchMeshIndirect:
+        return isValidStruct(sizeof(RHICmdIndirect))
+            && isValidObject(ReadPayload<RHICmdIndirect>(inPayload).Buffer, ERHICommandObjectType::Buffer);
+    case ERHICommandOp::DrawIndexedIndirectCount:
+    case ERHICommandOp::DispatchMeshIndirectCount:
+    {
+        if(!isValidStruct(sizeof(RHICmdIndirectCount)))
+            return false;
+        const RHICmdIndirectCount cmd = ReadPayload<RHICmdIndirectCount>(inPayload);
+        return isValidObject(cmd.Buffer, ERHICommandObjectType::Buffer) && isValidObject(cmd.CountBuffer, ERHICommandObjectType::Buffer);
+    }
+    case ERHICommandOp::Dispatch:
+    case ERHICommandOp::DispatchMesh:
+        return isValidStruct(sizeof(RHICmdDispatch));
+    default:
+        return false;
+    }
+}
+
+static constexpr uint32_t s_CommandStreamMagic = 0x53434852; // "RHCS"
+static constexpr uint32_t s_CommandStreamVersion = 2;
+
+template<typename T>
+static void WriteValue(std::ofstream& inFile, const T& inValue)
+{
+    static_assert(std::is_trivially_copyable_v<T>, "Only POD values can be serialized");
+    inFile.write(reinterpret_cast<const char*>(&inValue), sizeof(T));
+}
+
+template<typename T>
+static bool ReadValue(std::ifstream& inFile, T& outValue)
+{
+    static_assert(std::is_trivially_copyable_v<T>, "Only POD values can be serialized");
+    inFile.read(reinterpret_cast<char*>(&outValue), sizeof(T));
+    return inFile.good();
+}
+
+bool RHICommandStream::Save(const std::filesystem::path& inPath) const
+{
+    std::ofstream file(inPath, std::ios::binary);
+    if(!file.is_open())
+    {
+        Log::Error("[RHI] Failed to open %s for writing", inPath.string().c_str());
+        return false;
+    }
+
+    WriteValue(file, s_CommandStreamMagic);
+    WriteValue(file, s_CommandStreamVersion);
+    WriteValue(file, static_cast<uint32_t>(m_ObjectInfos.size()));
+    for(const RHICommandStreamObject& object : m_ObjectInfos)
+    {
+        WriteValue(file, object.Type);
+        WriteValue(file, static_cast<uint32_t>(object.Name.size()));
+        file.write(object.Name.data(), static_cast<std::streamsize>(object.Name.size()));
+        WriteValue(file, object.BufferDesc);
+        WriteValue(file, object.TextureDesc);
+    }
+    WriteValue(file, m_NumCommands);
+    WriteValue(file, static_cast<uint64_t>(m_Data.size()));
+    file.write(reinterpret_cast<const char*>(m_Data.data()), static_cast<std::streamsize>(m_Data.size()));
+    return file.good();
+}
+
+bool RHICommandStream::Load(const std::filesystem::path& inPath, const RHICommandStreamResolver& inResolver)
+{
+    std::ifstream file(inPath, std::ios::binary);
+    if(!file.is_open())
+    {
+        Log::Error("[RHI] Failed to open %s for reading", inPath.string().c_str());
+        return false;
+    }
+
+    Reset();
+    
+    uint32_t magic = 0, version = 0, numObjects = 0;
+    if(!ReadValue(file, magic) || !ReadValue(file, version) || magic != s_CommandStreamMagic || version != s_CommandStreamVersion)
+    {
+        Log::Error("[RHI] %s is not a command stream of version %u", inPath.string().c_str(), s_CommandStreamVersion);
+        return false;
+    }
+
+    if(!ReadValue(file, numObjects))
+    {
+        Log::Error("[RHI] Failed to read the objects of %s", inPath.string().c_str());
+        return false;
+    }
+    
+    for(uint32_t i = 0; i < numObjects; ++i)
+    {
+        RHICommandStreamObject object;
+        uint32_t nameLength = 0;
+        if(!ReadValue(file, object.Type) || !ReadValue(file, nameLength) || object.Type > ERHICommandObjectType::ResourceSet)
+        {
+            Log::Error("[RHI] Failed to read the objects of %s", inPath.string().c_str());
+            Reset();
+            return false;
+        }
+        object.Name.resize(nameLength);
+        file.read(object.Name.data(), nameLength);
+        if(!ReadValue(file, object.BufferDesc) || !ReadValue(file, object.TextureDesc))
+        {
+            Log::Error("[RHI] Failed to read the objects of %s", inPath.string().c_str());
+            Reset();
+            return false;
+        }
+
+        RefCountPtr<RHIObject> resolved;
+        if(inResolver)
+        {
+            resolved = inResolver(object);
+        }
+        else if(object.Type == ERHICommandObjectType::Buffer)
+        {
+            resolved = RHI::GetDevice()->CreateBuffer(object.BufferDesc);
+        }
+        else if(object.Type == ERHICommandObjectType::Texture)
+        {
+            resolved = RHI::GetDevice()->CreateTexture(object.TextureDesc);
+        }
+        
+        if(resolved)
+        {
+            resolved->SetName(object.Name);
+        }
+        m_Objects.emplace_back(resolved);
+        m_ObjectInfos.emplace_back(std::move(object));
+    }
+
+    uint64_t dataSize = 0;
+    if(!ReadValue(file, m_NumCommands) || !ReadValue(file, dataSize))
+    {
+        Log::Error("[RHI] Failed to read the commands of %s", inPath.string().c_str());
+        Reset();
+        return false;
+    }
+    
+    m_Data.resize(dataSize);
+    file.read(reinterpret_cast<char*>(m_Data.data()), static_cast<std::streamsize>(dataSize));
+    if(!file.good())
+    {
+        Log::Error("[RHI] Failed to read the commands of %s", inPath.string().c_str());
+        Reset();
+        return false;
+    }
+
+    // Validate the command headers once, so Replay can trust the stream. The commands have to fill the data exactly,
+    // Replay reads a header wherever the last command ends
+    uint32_t numCommands = 0;
+    for(size_t offset = 0; offset < m_Data.size(); ++numCommands)
+    {
+        if(offset + sizeof(CommandHeader) > m_Data.size())
+        {
+            numCommands = UINT32_MAX;
+            break;
+        }
+        const CommandHeader header = ReadPayload<CommandHeader>(m_Data.data() + offset);
+        const uint8_t* payload = m_Data.data() + offset + sizeof(CommandHeader);
+        offset += sizeof(CommandHeader) + header.Size;
+        if(header.Op >= ERHICommandOp::Count || offset > m_Data.size() || !IsValidCommand(header, payload))
+        {
+            numCommands = UINT32_MAX;
+            break;
+        }
+    }
+    
+    if(numCommands != m_NumCommands)
+    {
+        Log::Error("[RHI] The commands of %s are corrupted", inPath.string().c_str());
+        Reset();
+        return false;
+    }
+    return true;
+}
\ No newline at end of file
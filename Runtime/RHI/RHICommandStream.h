@@ -0,0 +1,161 @@
+#pragma once
+
+#include "RHIResources.h"
+#include <filesystem>
+#include <functional>
+#include <cstring>
+
+class RHICommandList;
+class RHIComputePipeline;
+class RHIGraphicsPipeline;
+class RHIFrameBuffer;
+
+enum class ERHICommandOp : uint16_t
+{
+    BeginMark = 0,
+    EndMark,
+    SetComputePipeline,
+    SetGraphicsPipeline,
+    SetFrameBuffer,
+    SetViewports,
+    SetScissorRects,
+    TextureBarrier,
+    TextureSubresourceBarrier,
+    BufferBarrier,
+    SetResourceSet,
+    SetVertexBuffer,
+    SetIndexBuffer,
+    CopyBuffer,
+    CopyTexture,
+    CopyTextureSlice,
+    CopyBufferToTexture,
+    CopyBufferToTextureSlice,
+    Draw,
+    DrawIndirect,
+    DrawIndexed,
+    DrawIndexedIndirect,
+    Dispatch,
+    DispatchIndirect,
+    DispatchMesh,
+    DispatchMeshIndirect,
+    SetPushConstants,
+    DrawIndexedIndirectCount,
+    DispatchMeshIndirectCount,
+    Count
+};
+
+enum class ERHICommandObjectType : uint8_t
+{
+    Buffer = 0,
+    Texture,
+    ComputePipeline,
+    GraphicsPipeline,
+    FrameBuffer,
+    ResourceSet
+};
+
+// An object referenced by a command stream, the descs are only meaningful for buffers and textures
+struct RHICommandStreamObject
+{
+    ERHICommandObjectType Type = ERHICommandObjectType::Buffer;
+    std::string Name;
+    RHIBufferDesc BufferDesc;
+    RHITextureDesc TextureDesc;
+};
+
+// Maps the objects of a loaded stream to live rhi objects, returning nullptr skips the commands using the object.
+// The returned object must be of the type of the stream object, Replay casts it without a check
+typedef std::function<RefCountPtr<RHIObject>(const RHICommandStreamObject&)> RHICommandStreamResolver;
+
+// A backend agnostic, linear recording of RHICommandList calls.
+// Each command is a POD header followed by a POD payload, objects are referenced by index into the object table of the stream.
+// Recording does not touch the device, so any thread can record into its own stream and the streams are replayed
+// into a native command list afterward. DispatchRays is not recorded since the shader table is not a rhi object.
+class RHICommandStream
+{
+public:
+    RHICommandStream() : m_NumCommands(0) {}
+    RHICommandStream(const RHICommandStream&) = delete;
+    RHICommandStream& operator=(const RHICommandStream&) = delete;
+    RHICommandStream(RHICommandStream&&) = default;
+    RHICommandStream& operator=(RHICommandStream&&) = default;
+    
+    void Reset();
+    void Reserve(size_t inBytes) { m_Data.reserve(inBytes); }
+    bool IsEmpty() const { return m_NumCommands == 0; }
+    uint32_t GetNumCommands() const { return m_NumCommands; }
+    size_t GetSizeInBytes() const { return m_Data.size(); }
+    const std::vector<RHICommandStreamObject>& GetObjects() const { return m_ObjectInfos; }
+
+    void BeginMark(const char* name);
+    void EndMark();
+    void SetPipelineState(const RefCountPtr<RHIComputePipeline>& inPipelineState);
+    void SetPipelineState(const RefCountPtr<RHIGraphicsPipeline>& inPipelineState);
+    void SetFrameBuffer(const RefCountPtr<RHIFrameBuffer>& inFrameBuffer);
+    void SetFrameBuffer(const RefCountPtr<RHIFrameBuffer>& inFrameBuffer
+        , const RHIClearValue* inColor , uint32_t inNumRenderTargets);
+    void SetFrameBuffer(const RefCountPtr<RHIFrameBuffer>& inFrameBuffer
+        , const RHIClearValue* inColor , uint32_t inNumRenderTargets
+        , float inDepth, uint8_t inStencil);
+    void SetViewports(const std::vector<RHIViewport>& inViewports);
+    void SetScissorRects(const std::vector<RHIRect>& inRects);
+    void ResourceBarrier(const RefCountPtr<RHITexture>& inResource, ERHIResourceStates inAfterState);
+    void ResourceBarrier(const RefCountPtr<RHITexture>& inResource, const RHITextureSubResource& inSubResource, ERHIResourceStates inAfterState);
+    void ResourceBarrier(const RefCountPtr<RHIBuffer>& inResource, ERHIResourceStates inAfterState);
+    void SetResourceSet(const RefCountPtr<RHIResourceSet>& inResourceSet);
+    void SetPushConstants(const void* inData, uint32_t inSize);
+    void SetVertexBuffer(const RefCountPtr<RHIBuffer>& inBuffer, size_t inOffset = 0);
+    void SetIndexBuffer(const RefCountPtr<RHIBuffer>& inBuffer, size_t inOffset = 0);
+    void CopyBuffer(const RefCountPtr<RHIBuffer>& dstBuffer, size_t dstOffset, const RefCountPtr<RHIBuffer>& srcBuffer, size_t srcOffset, size_t size);
+    void CopyBufferToTexture(const RefCountPtr<RHITexture>& dstTexture, const RefCountPtr<RHIBuffer>& srcBuffer);
+    void CopyBufferToTexture(const RefCountPtr<RHITexture>& dstTexture, const RHITextureSlice& dstSlice, const RefCountPtr<RHIBuffer>& srcBuffer, size_t srcOffset);
+    void CopyTexture(const RefCountPtr<RHITexture>& dstTexture, const RefCountPtr<RHITexture>& srcTexture);
+    void CopyTexture(const RefCountPtr<RHITexture>& dstTexture, const RHITextureSlice& dstSlice, const RefCountPtr<RHITexture>& srcTexture, const RHITextureSlice& srcSlice);
+    void Draw(uint32_t vertexCount, uint32_t instanceCount, uint32_t vertexOffset = 0, uint32_t firstInstance = 0);
+    void DrawIndirect(const RefCountPtr<RHIBuffer>& indirectCommands, uint32_t drawCount, size_t commandsBufferOffset = 0);
+    void DrawIndexed(uint32_t indexCount, uint32_t instanceCount, uint32_t firstIndex = 0, uint32_t vertexOffset = 0, uint32_t firstInstance = 0);
+    void DrawIndexedIndirect(const RefCountPtr<RHIBuffer>& indirectCommands, uint32_t drawCount, size_t commandsBufferOffset = 0);
+    void DrawIndexedIndirectCount(const RefCountPtr<RHIBuffer>& indirectCommands, const RefCountPtr<RHIBuffer>& countBuffer, uint32_t maxDrawCount, size_t commandsBufferOffset = 0, size_t countBufferOffset = 0);
+    void Dispatch(uint32_t threadGroupX, uint32_t threadGroupY, uint32_t threadGroupZ);
+    void DispatchIndirect(const RefCountPtr<RHIBuffer>& indirectCommands, uint32_t count, size_t commandsBufferOffset = 0);
+    void DispatchMesh(uint32_t threadGroupX, uint32_t threadGroupY, uint32_t threadGroupZ);
+    void DispatchMeshIndirect(const RefCountPtr<RHIBuffer>& indirectCommands, uint32_t count, size_t commandsBufferOffset = 0);
+    void DispatchMeshIndirectCount(const RefCountPtr<RHIBuffer>& indirectCommands, const RefCountPtr<RHIBuffer>& countBuffer, uint32_t maxCount, size_t commandsBufferOffset = 0, size_t countBufferOffset = 0);
+
+    // Translates the commands into the command list, which must be open. Returns the number of replayed commands
+    uint32_t Replay(RHICommandList* inCmdList) const;
+    
+    bool Save(const std::filesystem::path& inPath) const;
+    // Without a resolver buffers and textures are recreated from their descs on the current device
+    bool Load(const std::filesystem::path& inPath, const RHICommandStreamResolver& inResolver = nullptr);
+    
+private:
+    struct CommandHeader
+    {
+        ERHICommandOp Op;
+        uint16_t Padding;
+        uint32_t Size; // payload size in bytes, aligned to CommandAlignment
+    };
+    
+    static constexpr size_t CommandAlignment = 8;
+    static constexpr uint32_t InvalidObject = UINT32_MAX;
+    
+    uint32_t AddObject(RHIObject* inObject, ERHICommandObjectType inType);
+    // Checks that the payload of a loaded command holds what its op reads and that the objects it references exist
+    // with the type the op casts them to
+    bool IsValidCommand(const CommandHeader& inHeader, const uint8_t* inPayload) const;
+    uint8_t* AllocateCommand(ERHICommandOp inOp, size_t inPayloadSize);
+    
+    template<typename T>
+    void WriteCommand(ERHICommandOp inOp, const T& inPayload)
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "Command payload must be POD");
+        memcpy(AllocateCommand(inOp, sizeof(T)), &inPayload, sizeof(T));
+    }
+    
+    std::vector<uint8_t> m_Data;
+    uint32_t m_NumCommands;
+    std::vector<RefCountPtr<RHIObject>> m_Objects;
+    std::vector<RHICommandStreamObject> m_ObjectInfos;
+    std::unordered_map<const RHIObject*, uint32_t> m_ObjectIndices;
+};
\ No newline at end of file
@@ -0,0 +1,200 @@
+#include "RHIConstantAllocator.h"
+#include "RHIDevice.h"
+#include "../Core/Templates.h"
+#include "../Core/Log.h"
+
+RHIConstantAllocator::RHIConstantAllocator(RHIDevice& inDevice)
+    : m_Device(inDevice)
+{
+
+}
+
+RHIConstantAllocator::~RHIConstantAllocator()
+{
+    Shutdown();
+}
+
+bool RHIConstantAllocator::Init(uint32_t inNumFrames, uint64_t inFrameSize)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    if(IsValid())
+    {
+        Log::Warning("[RHI] Constant allocator already initialized");
+        return true;
+    }
+    return InitInternal(inNumFrames, inFrameSize);
+}
+
+bool RHIConstantAllocator::InitInternal(uint32_t inNumFrames, uint64_t inFrameSize)
+{
+    const uint32_t numFrames = std::max<uint32_t>(inNumFrames, 1);
+    const uint64_t frameSize = Align(std::max<uint64_t>(inFrameSize, s_Alignment), s_Alignment);
+    const uint64_t bufferSize = frameSize * numFrames + s_MaxAllocationSize;
+    RefCountPtr<RHIBuffer> buffer = m_Device.CreateBuffer(RHIBufferDesc::ConstantsBuffer(bufferSize));
+    if(!buffer.IsValid() || !buffer->IsValid())
+    {
+        Log::Error("[RHI] Failed to create the constant allocator of %u frames with %llu bytes", numFrames, frameSize);
+        return false;
+    }
+    buffer->SetName("ConstantAllocator");
+
+    m_CpuAddress = static_cast<uint8_t*>(buffer->Map(bufferSize, 0));
+    if(m_CpuAddress == nullptr)
+    {
+        Log::Error("[RHI] Failed to map the constant allocator");
+        return false;
+    }
+
+    m_Buffer = buffer;
+    m_FrameSize = frameSize;
+    m_Frames.assign(numFrames, Frame());
+    m_CurrentFrame = 0;
+    m_Overflowed = false;
+    m_Stats.FrameSize = frameSize;
+    m_Stats.NumFrames = numFrames;
+    return true;
+}
+
+void RHIConstantAllocator::Shutdown()
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    ShutdownInternal();
+}
+
+void RHIConstantAllocator::ShutdownInternal()
+{
+    for(Frame& frame : m_Frames)
+    {
+        WaitForFrame(frame);
+    }
+    m_Frames.clear();
+
+    if(m_Buffer.IsValid())
+    {
+        m_Buffer->Unmap();
+        m_Buffer.SafeRelease();
+    }
+    m_CpuAddress = nullptr;
+    m_FrameSize = 0;
+    m_CurrentFrame = 0;
+}
+
+void RHIConstantAllocator::WaitForFrame(Frame& inFrame)
+{
+    if(inFrame.Fence.IsValid() && !inFrame.Fence->IsCompleted())
+    {
+        ++m_Stats.Stalls;
+        inFrame.Fence->CpuWait();
+    }
+    
+    for(RefCountPtr<RHIBuffer>& buffer : inFrame.OverflowBuffers)
+    {
+        buffer->Unmap();
+    }
+    inFrame.OverflowBuffers.clear();
+    inFrame.Fence.SafeRelease();
+    inFrame.Offset = 0;
+    inFrame.AllocatedBytes = 0;
+}
+
+void RHIConstantAllocator::BeginFrame()
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    if(!IsValid())
+    {
+        return;
+    }
+
+    if(m_Overflowed)
+    {
+        // Regrows once every frame region finished, the resource sets pick the new buffer up when they bind again
+        const uint32_t numFrames = static_cast<uint32_t>(m_Frames.size());
+        const uint64_t frameSize = std::max<uint64_t>(m_FrameSize * 2, m_Stats.PeakFrameBytes);
+        ShutdownInternal();
+        if(InitInternal(numFrames, frameSize))
+        {
+            Log::Info("[RHI] Constant allocator grown to %llu bytes per frame", m_FrameSize);
+        }
+        return;
+    }
+    
+    m_CurrentFrame = (m_CurrentFrame + 1) % static_cast<uint32_t>(m_Frames.size());
+    WaitForFrame(m_Frames[m_CurrentFrame]);
+}
+
+void RHIConstantAllocator::EndFrame(const RefCountPtr<RHIFence>& inFence)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    if(IsValid())
+    {
+        m_Frames[m_CurrentFrame].Fence = inFence;
+    }
+}
+
+RHIConstantAllocation RHIConstantAllocator::Allocate(uint64_t inSize)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    RHIConstantAllocation allocation;
+    if(!IsValid() && !InitInternal(s_DefaultNumFrames, s_DefaultFrameSize))
+    {
+        return allocation;
+    }
+
+    if(inSize == 0 || inSize > s_MaxAllocationSize)
+    {
+        Log::Error("[RHI] Invalid constant allocation of %llu bytes, a constant buffer holds up to %llu bytes", inSize, s_MaxAllocationSize);
+        return allocation;
+    }
+
+    const uint64_t alignedSize = Align(inSize, s_Alignment);
+    Frame& frame = m_Frames[m_CurrentFrame];
+    frame.AllocatedBytes += alignedSize;
+    ++m_Stats.Allocations;
+    m_Stats.AllocatedBytes += alignedSize;
+    m_Stats.PeakFrameBytes = std::max(m_Stats.PeakFrameBytes, frame.AllocatedBytes);
+    
+    if(frame.Offset + alignedSize <= m_FrameSize)
+    {
+        const uint64_t offset = m_CurrentFrame * m_FrameSize + frame.Offset;
+        frame.Offset += alignedSize;
+        allocation.Buffer = m_Buffer.GetReference();
+        allocation.Offset = offset;
+        allocation.Size = alignedSize;
+        allocation.CpuAddress = m_CpuAddress + offset;
+        return allocation;
+    }
+
+    // The frame region is full, falls back to a constant buffer released with the frame
+    RefCountPtr<RHIBuffer> buffer = m_Device.CreateBuffer(RHIBufferDesc::ConstantsBuffer(alignedSize));
+    if(!buffer.IsValid() || !buffer->IsValid())
+    {
+        Log::Error("[RHI] Failed to create a constant buffer of %llu bytes", alignedSize);
+        return allocation;
+    }
+    
+    m_Overflowed = true;
+    ++m_Stats.Overflows;
+    allocation.Buffer = buffer.GetReference();
+    allocation.Offset = 0;
+    allocation.Size = alignedSize;
+    allocation.CpuAddress = static_cast<uint8_t*>(buffer->Map(alignedSize, 0));
+    allocation.IsOverflow = true;
+    frame.OverflowBuffers.push_back(buffer);
+    return allocation;
+}
+
+RHIConstantAllocatorStats RHIConstantAllocator::GetStats() const
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_Stats;
+}
+
+void RHIConstantAllocator::ResetStats()
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Stats.Allocations = 0;
+    m_Stats.AllocatedBytes = 0;
+    m_Stats.PeakFrameBytes = 0;
+    m_Stats.Stalls = 0;
+    m_Stats.Overflows = 0;
+}
\ No newline at end of file
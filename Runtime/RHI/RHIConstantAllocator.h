@@ -0,0 +1,90 @@
+#pragma once
+
+#include "RHIResources.h"
+#include <cstring>
+#include <mutex>
+
+class RHIDevice;
+class RHIFence;
+
+struct RHIConstantAllocatorStats
+{
+    uint64_t Allocations = 0;
+    uint64_t AllocatedBytes = 0;
+    uint64_t PeakFrameBytes = 0;    // the most bytes a single frame allocated
+    uint64_t Stalls = 0;            // frames which waited for the gpu to finish the frame using the same slices
+    uint64_t Overflows = 0;         // allocations which did not fit and got their own constant buffer
+    uint64_t FrameSize = 0;
+    uint32_t NumFrames = 0;
+};
+
+// Hands out 256 bytes aligned slices of one persistently mapped constant buffer for the per draw and per frame
+// constants, instead of a committed constant buffer each. The buffer has a region per frame in flight, the region of
+// a frame is reset by BeginFrame once the fence of its EndFrame is signaled. A frame which overflows its region grows
+// the regions at the next BeginFrame, so the buffer bound by the resource sets rarely changes. The buffer ends with
+// s_MaxAllocationSize bytes of padding, a view of that size at the offset of any slice stays inside of it, the resource
+// sets bind one view of the buffer and only change its offset.
+class RHIConstantAllocator
+{
+public:
+    static constexpr uint64_t s_Alignment = 256; // D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT, a multiple of minUniformBufferOffsetAlignment
+    static constexpr uint64_t s_MaxAllocationSize = 65536; // D3D12_REQ_CONSTANT_BUFFER_ELEMENT_COUNT * 16 bytes
+    static constexpr uint64_t s_DefaultFrameSize = 4ull * 1024 * 1024;
+    static constexpr uint32_t s_DefaultNumFrames = 3;
+
+    explicit RHIConstantAllocator(RHIDevice& inDevice);
+    ~RHIConstantAllocator();
+    RHIConstantAllocator(const RHIConstantAllocator&) = delete;
+    RHIConstantAllocator& operator=(const RHIConstantAllocator&) = delete;
+
+    // Called by the first allocation with the default sizes, call it before to size the allocator yourself
+    bool Init(uint32_t inNumFrames = s_DefaultNumFrames, uint64_t inFrameSize = s_DefaultFrameSize);
+    // Waits for the frames in flight and releases the buffer
+    void Shutdown();
+    bool IsValid() const { return m_Buffer.IsValid(); }
+
+    // Moves to the next frame region, waits for the fence the region was last ended with
+    void BeginFrame();
+    // inFence is signaled after the command lists using the slices of the current frame
+    void EndFrame(const RefCountPtr<RHIFence>& inFence);
+
+    RHIConstantAllocation Allocate(uint64_t inSize);
+
+    template<typename T>
+    RHIConstantAllocation Allocate(const T& inData)
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "Only POD constants can be allocated");
+        RHIConstantAllocation allocation = Allocate(sizeof(T));
+        if(allocation.IsValid())
+        {
+            memcpy(allocation.CpuAddress, &inData, sizeof(T));
+        }
+        return allocation;
+    }
+
+    RHIConstantAllocatorStats GetStats() const;
+    void ResetStats();
+
+private:
+    struct Frame
+    {
+        RefCountPtr<RHIFence> Fence;
+        uint64_t Offset = 0;
+        uint64_t AllocatedBytes = 0;
+        std::vector<RefCountPtr<RHIBuffer>> OverflowBuffers;
+    };
+
+    bool InitInternal(uint32_t inNumFrames, uint64_t inFrameSize);
+    void ShutdownInternal();
+    void WaitForFrame(Frame& inFrame);
+
+    RHIDevice& m_Device;
+    mutable std::mutex m_Mutex;
+    RefCountPtr<RHIBuffer> m_Buffer;
+    uint8_t* m_CpuAddress = nullptr;
+    uint64_t m_FrameSize = 0;
+    std::vector<Frame> m_Frames;
+    uint32_t m_CurrentFrame = 0;
+    bool m_Overflowed = false;
+    RHIConstantAllocatorStats m_Stats;
+};
\ No newline at end of file
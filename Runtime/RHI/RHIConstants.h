@@ -15,7 +15,8 @@ constexpr uint32_t RHIRenderTargetsMaxCount = 8;
 enum class ERHIBackend  : uint8_t
 {
     D3D12,
-    Vulkan
+    Vulkan,
+    Null    // headless, cpu only
 };
 
 enum class ERHICommandQueueType : uint8_t
@@ -130,7 +131,7 @@ enum class ERHIBindingResourceType : uint8_t
     Buffer_CBV,
     Sampler,
     AccelerationStructure,
-    // PushConstants
+    PushConstants,  // NumResources is the number of 32-bit values, at most one item per layout
 };
 
 enum class ERHIRegisterType : uint8_t
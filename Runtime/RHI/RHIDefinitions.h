@@ -19,10 +19,15 @@ class RHIDevice;
 namespace RHI
 {
     bool                    Init(bool useVulkan = false);
+    bool                    Init(ERHIBackend inBackend);
     void                    Shutdown();
     RHIDevice*              GetDevice();
     const RHIFormatInfo&    GetFormatInfo(ERHIFormat inFormat);
     RefCountPtr<RHISwapChain> CreateSwapChain(const RHISwapChainDesc& inDesc);
+
+    // Where the backends keep their persistent pipeline caches, set it before Init. Empty disables the caches
+    void                    SetPipelineCacheDirectory(const char* inPath);
+    const std::string&      GetPipelineCacheDirectory();
 }
 
 class RHIObject : public RefCounter
@@ -0,0 +1,449 @@
+#include "RHIDefragmenter.h"
+#include "RHIDevice.h"
+#include "RHICommandList.h"
+#include "../Core/Log.h"
+#include "../Core/Templates.h"
+#include <algorithm>
+
+RHIDefragmenter::RHIDefragmenter(RHIDevice& inDevice)
+    : m_Device(inDevice)
+{
+
+}
+
+bool RHIDefragmenter::Register(const RefCountPtr<RHIBuffer>& inBuffer, BufferMovedCallback inCallback)
+{
+    if(!inBuffer.IsValid() || !inBuffer->IsValid() || inBuffer->GetResourceHeap() == nullptr || !inBuffer->IsVirtual())
+    {
+        Log::Warning("[RHI] Only buffers bound with BindMemory can be defragmented");
+        return false;
+    }
+    if(inBuffer->GetDesc().CpuAccess != ERHICpuAccessMode::None)
+    {
+        // Upload and readback heaps are not valid copy destinations and sources
+        Log::Warning("[RHI] The cpu accessible buffer %s can not be defragmented", inBuffer->GetName().c_str());
+        return false;
+    }
+    
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    Entry& entry = m_Entries[inBuffer.GetReference()];
+    entry.Buffer = inBuffer;
+    entry.OnBufferMoved = std::move(inCallback);
+    return true;
+}
+
+bool RHIDefragmenter::Register(const RefCountPtr<RHITexture>& inTexture, TextureMovedCallback inCallback)
+{
+    if(!inTexture.IsValid() || !inTexture->IsValid() || inTexture->GetResourceHeap() == nullptr || !inTexture->IsVirtual())
+    {
+        Log::Warning("[RHI] Only textures bound with BindMemory can be defragmented");
+        return false;
+    }
+    
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    Entry& entry = m_Entries[inTexture.GetReference()];
+    entry.Texture = inTexture;
+    entry.OnTextureMoved = std::move(inCallback);
+    return true;
+}
+
+void RHIDefragmenter::Unregister(const RHIObject* inResource)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Entries.erase(inResource);
+}
+
+void RHIDefragmenter::TrackBinding(const RHIObject* inResource, const RefCountPtr<RHIResourceSet>& inResourceSet, ERHIResourceViewType inViewType, uint32_t inRegister, uint32_t inSpace)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    auto iter = m_Entries.find(inResource);
+    if(iter == m_Entries.end())
+    {
+        Log::Warning("[RHI] The binding of an unregistered resource is not tracked");
+        return;
+    }
+    
+    for(Binding& binding : iter->second.Bindings)
+    {
+        if(binding.ResourceSet == inResourceSet && binding.ViewType == inViewType && binding.Register == inRegister && binding.Space == inSpace)
+        {
+            return;
+        }
+    }
+    iter->second.Bindings.push_back({inResourceSet, inViewType, inRegister, inSpace});
+}
+
+void RHIDefragmenter::Clear()
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Entries.clear();
+    m_RecordedMoves.clear();
+    m_PendingRebinds.clear();
+    m_PendingReleases.clear();
+    m_Submitted.clear();
+}
+
+uint32_t RHIDefragmenter::RecordMoves(RHICommandList* inCmdList)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    
+    // One round at a time, the sources of the last round still occupy their blocks until they are released
+    if(inCmdList == nullptr || m_MaxBytesPerFrame == 0 || !m_RecordedMoves.empty() || !m_PendingRebinds.empty() || !m_PendingReleases.empty()
+        || !m_Submitted.empty())
+    {
+        return 0;
+    }
+
+    std::unordered_map<const RHIResourceHeap*, uint32_t> blockIndices;
+    std::vector<RHIDefragmentationBlock> blocks;
+    std::vector<RHIResourceHeap*> heaps;
+    std::vector<std::vector<const RHIObject*>> blockResources;
+    for(auto iter = m_Entries.begin(); iter != m_Entries.end();)
+    {
+        Entry& entry = iter->second;
+        const uint32_t refCount = entry.Buffer.IsValid() ? entry.Buffer.GetRefCount() : entry.Texture.GetRefCount();
+        if(refCount == 1)
+        {
+            iter = m_Entries.erase(iter);
+            continue;
+        }
+
+        RHIResourceHeap* heap = entry.Buffer.IsValid() ? entry.Buffer->GetResourceHeap() : entry.Texture->GetResourceHeap();
+        auto blockIter = blockIndices.find(heap);
+        if(blockIter == blockIndices.end())
+        {
+            const RHIResourceHeapDesc& heapDesc = heap->GetDesc();
+            uint64_t alignmentLog2 = 0;
+            while((1ull << alignmentLog2) < heapDesc.Alignment)
+            {
+                ++alignmentLog2;
+            }
+            
+            RHIDefragmentationBlock block;
+            block.Pool = (static_cast<uint64_t>(heapDesc.TypeFilter) << 32)
+                | (static_cast<uint64_t>(heapDesc.Type) << 24)
+                | (static_cast<uint64_t>(heapDesc.Usage) << 16)
+                | alignmentLog2;
+            block.Size = heapDesc.Size;
+            heap->GetFreeRanges(block.FreeRanges);
+            blockIter = blockIndices.emplace(heap, static_cast<uint32_t>(blocks.size())).first;
+            blocks.push_back(std::move(block));
+            heaps.push_back(heap);
+            blockResources.emplace_back();
+        }
+
+        RHIDefragmentationAllocation allocation;
+        if(entry.Buffer.IsValid())
+        {
+            allocation.Offset = entry.Buffer->GetOffsetInHeap();
+            allocation.Size = entry.Buffer->GetAllocSizeInByte();
+            allocation.Alignment = std::max<uint64_t>(entry.Buffer->GetAllocAlignment(), 1);
+        }
+        else
+        {
+            allocation.Offset = entry.Texture->GetOffsetInHeap();
+            allocation.Size = entry.Texture->GetAllocSizeInByte();
+            allocation.Alignment = std::max<uint64_t>(entry.Texture->GetAllocAlignment(), 1);
+        }
+        blocks[blockIter->second].Allocations.push_back(allocation);
+        blockResources[blockIter->second].push_back(iter->first);
+        ++iter;
+    }
+
+    std::vector<RHIDefragmentationMove> moves;
+    PlanMoves(blocks, m_MaxBytesPerFrame, moves);
+
+    for(const RHIDefragmentationMove& move : moves)
+    {
+        const RHIObject* source = blockResources[move.SrcBlock][move.Allocation];
+        Entry& entry = m_Entries[source];
+        RefCountPtr<RHIResourceHeap> heap(heaps[move.DstBlock]);
+        
+        // The heap picks the offset, the planned one is only known to fit
+        Move recordedMove;
+        recordedMove.Source = source;
+        if(entry.Buffer.IsValid())
+        {
+            recordedMove.Buffer = m_Device.CreateBuffer(entry.Buffer->GetDesc(), true);
+            if(!recordedMove.Buffer.IsValid() || !recordedMove.Buffer->BindMemory(heap))
+            {
+                ++m_Stats.FailedMoves;
+                continue;
+            }
+            recordedMove.Buffer->SetName(entry.Buffer->GetName());
+            inCmdList->ResourceBarrier(entry.Buffer, ERHIResourceStates::CopySrc);
+            inCmdList->ResourceBarrier(recordedMove.Buffer, ERHIResourceStates::CopyDst);
+            inCmdList->CopyBuffer(recordedMove.Buffer, 0, entry.Buffer, 0, entry.Buffer->GetDesc().Size);
+            m_Stats.MovedBytes += entry.Buffer->GetAllocSizeInByte();
+        }
+        else
+        {
+            recordedMove.Texture = m_Device.CreateTexture(entry.Texture->GetDesc(), true);
+            if(!recordedMove.Texture.IsValid() || !recordedMove.Texture->BindMemory(heap))
+            {
+                ++m_Stats.FailedMoves;
+                continue;
+            }
+            recordedMove.Texture->SetName(entry.Texture->GetName());
+            inCmdList->ResourceBarrier(entry.Texture, ERHIResourceStates::CopySrc);
+            inCmdList->ResourceBarrier(recordedMove.Texture, ERHIResourceStates::CopyDst);
+            inCmdList->CopyTexture(recordedMove.Texture, entry.Texture);
+            m_Stats.MovedBytes += entry.Texture->GetAllocSizeInByte();
+        }
+        m_RecordedMoves.push_back(std::move(recordedMove));
+        ++m_Stats.RecordedMoves;
+    }
+    return static_cast<uint32_t>(m_RecordedMoves.size());
+}
+
+void RHIDefragmenter::Submit(const RefCountPtr<RHIFence>& inFence)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    if(m_RecordedMoves.empty() && m_PendingRebinds.empty() && m_PendingReleases.empty())
+    {
+        return;
+    }
+
+    Submission submission;
+    submission.Fence = inFence;
+    submission.Moves = std::move(m_RecordedMoves);
+    submission.Rebinds = std::move(m_PendingRebinds);
+    submission.Releases = std::move(m_PendingReleases);
+    m_RecordedMoves.clear();
+    m_PendingRebinds.clear();
+    m_PendingReleases.clear();
+    m_Submitted.push_back(std::move(submission));
+}
+
+void RHIDefragmenter::Retire()
+{
+    std::vector<std::function<void()>> callbacks;
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        while(!m_Submitted.empty() && (!m_Submitted.front().Fence.IsValid() || m_Submitted.front().Fence->IsCompleted()))
+        {
+            // The frames recorded after the rebind no longer use the old resources, they are released after them
+            for(Rebind& rebind : m_Submitted.front().Rebinds)
+            {
+                ApplyRebind(rebind);
+                m_PendingReleases.push_back(std::move(rebind.Source));
+            }
+            
+            for(Move& move : m_Submitted.front().Moves)
+            {
+                auto iter = m_Entries.find(move.Source);
+                if(iter == m_Entries.end())
+                {
+                    continue;
+                }
+
+                // The frames in flight still bind the old resource, the resource sets are rebound after them
+                Entry entry = std::move(iter->second);
+                m_Entries.erase(iter);
+                if(!entry.Bindings.empty())
+                {
+                    Rebind rebind;
+                    rebind.Bindings = entry.Bindings;
+                    rebind.Buffer = move.Buffer;
+                    rebind.Texture = move.Texture;
+                    rebind.Source = entry.Buffer.IsValid() ? RefCountPtr<RHIObject>(entry.Buffer) : RefCountPtr<RHIObject>(entry.Texture);
+                    m_PendingRebinds.push_back(std::move(rebind));
+                }
+                else
+                {
+                    m_PendingReleases.push_back(entry.Buffer.IsValid() ? RefCountPtr<RHIObject>(entry.Buffer) : RefCountPtr<RHIObject>(entry.Texture));
+                }
+
+                // The owners replace their references outside the lock, they may register again
+                if(move.Buffer.IsValid())
+                {
+                    if(entry.OnBufferMoved)
+                    {
+                        callbacks.emplace_back([callback = entry.OnBufferMoved, buffer = move.Buffer]() { callback(buffer); });
+                    }
+                    entry.Buffer = move.Buffer;
+                    m_Entries.emplace(move.Buffer.GetReference(), std::move(entry));
+                }
+                else
+                {
+                    if(entry.OnTextureMoved)
+                    {
+                        callbacks.emplace_back([callback = entry.OnTextureMoved, texture = move.Texture]() { callback(texture); });
+                    }
+                    entry.Texture = move.Texture;
+                    m_Entries.emplace(move.Texture.GetReference(), std::move(entry));
+                }
+                ++m_Stats.CompletedMoves;
+            }
+            m_Submitted.pop_front();
+        }
+    }
+
+    for(auto& callback : callbacks)
+    {
+        callback();
+    }
+}
+
+void RHIDefragmenter::ApplyRebind(Rebind& inRebind)
+{
+    for(Binding& binding : inRebind.Bindings)
+    {
+        switch (binding.ViewType)
+        {
+        case ERHIResourceViewType::SRV:
+            if(inRebind.Buffer.IsValid()) binding.ResourceSet->BindBufferSRV(binding.Register, binding.Space, inRebind.Buffer);
+            else binding.ResourceSet->BindTextureSRV(binding.Register, binding.Space, inRebind.Texture);
+            break;
+        case ERHIResourceViewType::UAV:
+            if(inRebind.Buffer.IsValid()) binding.ResourceSet->BindBufferUAV(binding.Register, binding.Space, inRebind.Buffer);
+            else binding.ResourceSet->BindTextureUAV(binding.Register, binding.Space, inRebind.Texture);
+            break;
+        case ERHIResourceViewType::CBV:
+            if(inRebind.Buffer.IsValid()) binding.ResourceSet->BindBufferCBV(binding.Register, binding.Space, inRebind.Buffer);
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+RHIDefragmenterStats RHIDefragmenter::GetStats() const
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_Stats;
+}
+
+void RHIDefragmenter::ResetStats()
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Stats = RHIDefragmenterStats();
+}
+
+void RHIDefragmenter::PlanMoves(const std::vector<RHIDefragmentationBlock>& inBlocks, uint64_t inMaxBytes, std::vector<RHIDefragmentationMove>& outMoves)
+{
+    outMoves.clear();
+    
+    const uint32_t numBlocks = static_cast<uint32_t>(inBlocks.size());
+    std::vector<std::vector<RHIMemoryRange>> freeRanges(numBlocks);
+    std::vector<uint64_t> usedBytes(numBlocks);
+    std::vector<uint32_t> order(numBlocks);
+    for(uint32_t i = 0; i < numBlocks; ++i)
+    {
+        freeRanges[i] = inBlocks[i].FreeRanges;
+        uint64_t freeBytes = 0;
+        for(const RHIMemoryRange& range : freeRanges[i])
+        {
+            freeBytes += range.Size;
+        }
+        usedBytes[i] = inBlocks[i].Size > freeBytes ? inBlocks[i].Size - freeBytes : 0;
+        order[i] = i;
+    }
+
+    // Grouped by pool, the fullest blocks first
+    std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b)
+    {
+        if(inBlocks[a].Pool != inBlocks[b].Pool) return inBlocks[a].Pool < inBlocks[b].Pool;
+        if(usedBytes[a] != usedBytes[b]) return usedBytes[a] > usedBytes[b];
+        return a < b;
+    });
+
+    uint64_t movedBytes = 0;
+    for(uint32_t poolBegin = 0; poolBegin < numBlocks;)
+    {
+        uint32_t poolEnd = poolBegin + 1;
+        while(poolEnd < numBlocks && inBlocks[order[poolEnd]].Pool == inBlocks[order[poolBegin]].Pool)
+        {
+            ++poolEnd;
+        }
+
+        for(uint32_t src = poolEnd - 1; src > poolBegin; --src)
+        {
+            const uint32_t srcBlock = order[src];
+            const RHIDefragmentationBlock& block = inBlocks[srcBlock];
+            uint64_t movableBytes = 0;
+            for(const RHIDefragmentationAllocation& allocation : block.Allocations)
+            {
+                movableBytes += allocation.Size;
+            }
+            // A block over the remaining budget is skipped, a smaller block after it may still fit
+            if(block.Allocations.empty() || movableBytes != usedBytes[srcBlock] || movedBytes + movableBytes > inMaxBytes)
+            {
+                continue;
+            }
+
+            // The largest allocations are placed first, the whole block has to fit or nothing moves
+            std::vector<uint32_t> allocations(block.Allocations.size());
+            for(uint32_t i = 0; i < allocations.size(); ++i)
+            {
+                allocations[i] = i;
+            }
+            std::sort(allocations.begin(), allocations.end(), [&](uint32_t a, uint32_t b)
+            {
+                return block.Allocations[a].Size > block.Allocations[b].Size;
+            });
+
+            std::vector<std::vector<RHIMemoryRange>> simulatedRanges(freeRanges.size());
+            for(uint32_t dst = poolBegin; dst < src; ++dst)
+            {
+                simulatedRanges[order[dst]] = freeRanges[order[dst]];
+            }
+            
+            std::vector<RHIDefragmentationMove> blockMoves;
+            for(uint32_t allocationIndex : allocations)
+            {
+                const RHIDefragmentationAllocation& allocation = block.Allocations[allocationIndex];
+                for(uint32_t dst = poolBegin; dst < src; ++dst)
+                {
+                    uint64_t offset;
+                    if(FindFreeRange(simulatedRanges[order[dst]], allocation.Size, allocation.Alignment, offset))
+                    {
+                        blockMoves.push_back({srcBlock, allocationIndex, order[dst], offset});
+                        break;
+                    }
+                }
+            }
+            if(blockMoves.size() != allocations.size())
+            {
+                continue;
+            }
+
+            outMoves.insert(outMoves.end(), blockMoves.begin(), blockMoves.end());
+            movedBytes += movableBytes;
+            for(uint32_t dst = poolBegin; dst < src; ++dst)
+            {
+                freeRanges[order[dst]] = std::move(simulatedRanges[order[dst]]);
+            }
+        }
+        poolBegin = poolEnd;
+    }
+}
+
+bool RHIDefragmenter::FindFreeRange(std::vector<RHIMemoryRange>& inRanges, uint64_t inSize, uint64_t inAlignment, uint64_t& outOffset)
+{
+    for(auto iter = inRanges.begin(); iter != inRanges.end(); ++iter)
+    {
+        const uint64_t offset = Align(iter->Offset, inAlignment);
+        const uint64_t end = iter->Offset + iter->Size;
+        if(offset + inSize > end)
+        {
+            continue;
+        }
+
+        // Keeps the padding in front and the remainder behind as free ranges
+        const RHIMemoryRange front {iter->Offset, offset - iter->Offset};
+        const RHIMemoryRange back {offset + inSize, end - offset - inSize};
+        iter = inRanges.erase(iter);
+        if(back.Size > 0)
+        {
+            iter = inRanges.insert(iter, back);
+        }
+        if(front.Size > 0)
+        {
+            inRanges.insert(iter, front);
+        }
+        outOffset = offset;
+        return true;
+    }
+    return false;
+}
\ No newline at end of file
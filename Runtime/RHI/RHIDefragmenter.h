@@ -0,0 +1,146 @@
+#pragma once
+
+#include "RHIResources.h"
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+
+class RHIDevice;
+class RHIFence;
+class RHICommandList;
+
+// A placed resource the planner may move, the offset and size inside its block
+struct RHIDefragmentationAllocation
+{
+    uint64_t Offset = 0;
+    uint64_t Size = 0;
+    uint64_t Alignment = 1;
+};
+
+struct RHIDefragmentationBlock
+{
+    uint64_t Pool = 0;      // allocations only move between blocks of the same pool, e.g. the same heap type
+    uint64_t Size = 0;
+    std::vector<RHIMemoryRange> FreeRanges;
+    // The movable allocations, a block with other allocations is never emptied and only receives moves
+    std::vector<RHIDefragmentationAllocation> Allocations;
+};
+
+struct RHIDefragmentationMove
+{
+    uint32_t SrcBlock = 0;
+    uint32_t Allocation = 0;    // index into the allocations of the source block
+    uint32_t DstBlock = 0;
+    uint64_t DstOffset = 0;
+};
+
+struct RHIDefragmenterStats
+{
+    uint64_t RecordedMoves = 0;
+    uint64_t CompletedMoves = 0;
+    uint64_t MovedBytes = 0;
+    uint64_t FailedMoves = 0;   // planned moves whose destination resource could not be bound
+};
+
+// Moves placed buffers and textures out of the least used heaps into fuller heaps of the same kind, so the emptied
+// heaps are released and the free memory is not scattered over many heaps. Works incrementally, RecordMoves copies
+// at most the bytes budget per frame into new resources. Once the copies completed, Retire calls the moved callback so
+// the owners replace their references. The tracked resource set bindings are rebound to the new resources once the
+// frames in flight at that point completed, the old resources are released after the frames which still bound them
+// completed.
+// RHIFrameContext drives it: Retire and RecordMoves in BeginFrame and Submit in EndFrame.
+class RHIDefragmenter
+{
+public:
+    static constexpr uint64_t s_DefaultMaxBytesPerFrame = 16ull * 1024 * 1024;
+    using BufferMovedCallback = std::function<void(const RefCountPtr<RHIBuffer>& inNewBuffer)>;
+    using TextureMovedCallback = std::function<void(const RefCountPtr<RHITexture>& inNewTexture)>;
+    
+    explicit RHIDefragmenter(RHIDevice& inDevice);
+    RHIDefragmenter(const RHIDefragmenter&) = delete;
+    RHIDefragmenter& operator=(const RHIDefragmenter&) = delete;
+
+    // Only resources bound with BindMemory can move, e.g. the ones of RHIMemoryAllocator. A resource only referenced
+    // by the defragmenter is unregistered by the next RecordMoves
+    bool Register(const RefCountPtr<RHIBuffer>& inBuffer, BufferMovedCallback inCallback = nullptr);
+    bool Register(const RefCountPtr<RHITexture>& inTexture, TextureMovedCallback inCallback = nullptr);
+    void Unregister(const RHIObject* inResource);
+    // Binds the registered resource again at the register when it moved. SRV, UAV and CBV are supported
+    void TrackBinding(const RHIObject* inResource, const RefCountPtr<RHIResourceSet>& inResourceSet, ERHIResourceViewType inViewType, uint32_t inRegister, uint32_t inSpace);
+    void Clear();
+
+    // 0 disables the moves
+    void SetMaxBytesPerFrame(uint64_t inBytes) { m_MaxBytesPerFrame = inBytes; }
+    uint64_t GetMaxBytesPerFrame() const { return m_MaxBytesPerFrame; }
+
+    // Plans the moves of this frame and records the copies into inCmdList, returns the number of moves
+    uint32_t RecordMoves(RHICommandList* inCmdList);
+    // The moves recorded since the last submit complete once inFence is signaled
+    void Submit(const RefCountPtr<RHIFence>& inFence);
+    // Completes the moves whose fence is signaled, does not block
+    void Retire();
+
+    RHIDefragmenterStats GetStats() const;
+    void ResetStats();
+
+    // Empties the least used blocks of each pool into the fuller blocks of the pool, first fit in offset order.
+    // Blocks whose allocations exceed the bytes left of inMaxBytes or do not fit into the fuller blocks are skipped,
+    // moving part of them would not release them
+    static void PlanMoves(const std::vector<RHIDefragmentationBlock>& inBlocks, uint64_t inMaxBytes, std::vector<RHIDefragmentationMove>& outMoves);
+
+private:
+    struct Binding
+    {
+        RefCountPtr<RHIResourceSet> ResourceSet;
+        ERHIResourceViewType ViewType;
+        uint32_t Register;
+        uint32_t Space;
+    };
+    
+    struct Entry
+    {
+        RefCountPtr<RHIBuffer> Buffer;
+        RefCountPtr<RHITexture> Texture;
+        BufferMovedCallback OnBufferMoved;
+        TextureMovedCallback OnTextureMoved;
+        std::vector<Binding> Bindings;
+    };
+
+    struct Move
+    {
+        const RHIObject* Source;
+        RefCountPtr<RHIBuffer> Buffer;
+        RefCountPtr<RHITexture> Texture;
+    };
+
+    // The bindings of a completed move, they are rebound once no frame in flight uses the resource sets
+    struct Rebind
+    {
+        std::vector<Binding> Bindings;
+        RefCountPtr<RHIObject> Source;
+        RefCountPtr<RHIBuffer> Buffer;
+        RefCountPtr<RHITexture> Texture;
+    };
+
+    struct Submission
+    {
+        RefCountPtr<RHIFence> Fence;
+        std::vector<Move> Moves;
+        std::vector<Rebind> Rebinds;
+        std::vector<RefCountPtr<RHIObject>> Releases;   // the moved resources, no frame uses them after the fence
+    };
+
+    static void ApplyRebind(Rebind& inRebind);
+    static bool FindFreeRange(std::vector<RHIMemoryRange>& inRanges, uint64_t inSize, uint64_t inAlignment, uint64_t& outOffset);
+
+    RHIDevice& m_Device;
+    mutable std::mutex m_Mutex;
+    std::unordered_map<const RHIObject*, Entry> m_Entries;
+    std::vector<Move> m_RecordedMoves;
+    std::vector<Rebind> m_PendingRebinds;
+    std::vector<RefCountPtr<RHIObject>> m_PendingReleases;
+    std::deque<Submission> m_Submitted;
+    uint64_t m_MaxBytesPerFrame = s_DefaultMaxBytesPerFrame;
+    RHIDefragmenterStats m_Stats;
+};
\ No newline at end of file
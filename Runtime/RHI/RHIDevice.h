@@ -1,6 +1,17 @@
 #pragma once
 
 #include "RHIDefinitions.h"
+#include "RHIStateCache.h"
+#include "RHIPipelineCache.h"
+#include "RHIPipelineCompiler.h"
+#include "RHIUploadRing.h"
+#include "RHIConstantAllocator.h"
+#include "RHIFrameContext.h"
+#include "RHIResidencyManager.h"
+#include "RHIMemoryAllocator.h"
+#include "RHIDefragmenter.h"
+#include "RHIBindlessTable.h"
+#include "RHICommandListPool.h"
 
 class RHIResourceSet;
 struct RHISamplerDesc;
@@ -31,6 +42,23 @@ class RHIFence : public RHIObject
 public:
     virtual void Reset() = 0;
     virtual void CpuWait() = 0;
+    // Polls the fence without blocking
+    virtual bool IsCompleted() = 0;
+};
+
+// used for Cpu/Gpu and CommandQueue/CommandQueue synchronization with a monotonically increasing value, a single
+// fence serves every sync point instead of one fence per submission
+class RHITimelineFence : public RHIObject
+{
+public:
+    // Sets the value from the cpu, the value must be larger than the last signaled value
+    virtual void Signal(uint64_t inValue) = 0;
+    // Polls the value the gpu reached without blocking
+    virtual uint64_t GetCompletedValue() = 0;
+    // Blocks until the fence reached inValue, returns false if inTimeoutMs passed before
+    virtual bool Wait(uint64_t inValue, uint64_t inTimeoutMs = UINT64_MAX) = 0;
+
+    bool IsCompleted(uint64_t inValue) { return GetCompletedValue() >= inValue; }
 };
 
 // used for CommandQueue/CommandQueue synchronization
@@ -40,14 +68,30 @@ public:
     virtual void Reset() = 0;
 };
 
+// A value of a timeline fence a batch of command lists waits for or signals, see RHIDevice::ExecuteCommandLists
+struct RHIQueueFenceValue
+{
+    RefCountPtr<RHITimelineFence> Fence;
+    uint64_t Value = 0;
+};
+
+struct RHISubmitStats
+{
+    uint64_t Submits = 0;       // queue submit calls, one per ExecuteCommandLists unless fix-ups split the batch
+    uint64_t CommandLists = 0;  // command lists executed by them
+};
+
 // used for creating rhi objects
 class RHIDevice : public RHIObject
 {
 public:
     virtual ERHIBackend                             GetBackend() const = 0;
+    // The alignment of the row pitch of buffer data copied into textures, CopyBufferToTexture reads the rows at it
+    virtual uint32_t                                GetTextureDataPitchAlignment() const = 0;
     
     virtual RefCountPtr<RHIFence>                   CreateRhiFence() = 0;
     virtual RefCountPtr<RHISemaphore>               CreateRhiSemaphore() = 0;
+    virtual RefCountPtr<RHITimelineFence>           CreateTimelineFence(uint64_t inInitialValue = 0) = 0;
     virtual RefCountPtr<RHICommandList>             CreateCommandList(ERHICommandQueueType inType = ERHICommandQueueType::Direct) = 0;
     virtual RefCountPtr<RHIPipelineBindingLayout>   CreatePipelineBindingLayout(const RHIPipelineBindingLayoutDesc& inBindingItems) = 0;
     virtual RefCountPtr<RHIShader>                  CreateShader(ERHIShaderType inType) = 0;
@@ -60,9 +104,90 @@ public:
     virtual RefCountPtr<RHIAccelerationStructure>   CreateBottomLevelAccelerationStructure(const std::vector<RHIRayTracingGeometryDesc>& inDesc) = 0;
     virtual RefCountPtr<RHIAccelerationStructure>   CreateTopLevelAccelerationStructure(const std::vector<RHIRayTracingInstanceDesc>& inDesc) = 0;
     virtual RefCountPtr<RHIFrameBuffer>             CreateFrameBuffer(const RHIFrameBufferDesc& inDesc) = 0;
-    virtual RefCountPtr<RHIResourceSet>             CreateResourceSet(const RHIPipelineBindingLayout* inLayout) = 0;
+    // A dynamic set is rebound with other resources within a frame, its tables are copied into per frame descriptor
+    // memory each time it is set on a command list instead of living in the shader visible heap
+    virtual RefCountPtr<RHIResourceSet>             CreateResourceSet(const RHIPipelineBindingLayout* inLayout, bool inIsDynamic = false) = 0;
     
     virtual void AddQueueWaitForSemaphore(ERHICommandQueueType inType, RefCountPtr<RHISemaphore>& inSemaphore) = 0;
     virtual void AddQueueSignalSemaphore(ERHICommandQueueType inType, RefCountPtr<RHISemaphore>& inSemaphore) = 0;
-    virtual void ExecuteCommandList(const RefCountPtr<RHICommandList>& inCommandList, const RefCountPtr<RHIFence>& inSignalFence = nullptr) = 0;
+    // The next command list executed on the queue waits until the fence reached inValue before it starts
+    virtual void AddQueueWaitForFence(ERHICommandQueueType inType, RefCountPtr<RHITimelineFence>& inFence, uint64_t inValue) = 0;
+    // The next command list executed on the queue sets the fence to inValue once it finished
+    virtual void AddQueueSignalFence(ERHICommandQueueType inType, RefCountPtr<RHITimelineFence>& inFence, uint64_t inValue) = 0;
+    // Executes the command lists of one queue type in array order with a single queue submit. The queue waits for
+    // inWaitFences and the waits added before the first list, and signals inSignalFences, the signals added before and
+    // inSignalFence after the last one
+    virtual void ExecuteCommandLists(const RefCountPtr<RHICommandList>* inCommandLists, uint32_t inCount
+        , const RHIQueueFenceValue* inWaitFences = nullptr, uint32_t inNumWaitFences = 0
+        , const RHIQueueFenceValue* inSignalFences = nullptr, uint32_t inNumSignalFences = 0
+        , const RefCountPtr<RHIFence>& inSignalFence = nullptr) = 0;
+    void ExecuteCommandList(const RefCountPtr<RHICommandList>& inCommandList, const RefCountPtr<RHIFence>& inSignalFence = nullptr)
+    {
+        ExecuteCommandLists(&inCommandList, 1, nullptr, 0, nullptr, 0, inSignalFence);
+    }
+    const RHISubmitStats& GetSubmitStats() const { return m_SubmitStats; }
+    void ResetSubmitStats() { m_SubmitStats = RHISubmitStats(); }
+
+    // The budget of the local video memory, false if the backend can not query it
+    virtual bool QueryMemoryBudget(RHIMemoryBudget& outBudget) = 0;
+    // False if the backend has no explicit residency control, the objects stay resident then
+    virtual bool EvictObjects(const RHIResidencyObject* inObjects, uint32_t inCount) = 0;
+    virtual bool MakeObjectsResident(const RHIResidencyObject* inObjects, uint32_t inCount) = 0;
+
+    // Creates the shader visible table of RHIBindlessTable, called once by RHIBindlessTable::Init
+    virtual bool InitBindlessTable(uint32_t inNumResources, uint32_t inNumSamplers) = 0;
+    // Writes the view at the index of the resource or sampler part of the table, the table synchronizes the writes
+    virtual bool WriteBindlessDescriptor(uint32_t inIndex, const RHIBindlessDescriptor& inDescriptor) = 0;
+
+    // CreatePipelineBindingLayout and CreateSampler go through this cache, identical descs return the same object
+    RHIStateCache& GetStateCache() { return m_StateCache; }
+    
+    // CreatePipeline goes through this cache, identical descs return the same pipeline
+    RHIPipelineCache& GetPipelineCache() { return m_PipelineCache; }
+
+    // Returns immediately, the pipeline is compiled on the pipeline compiler threads
+    RefCountPtr<RHIAsyncComputePipeline> CreatePipelineAsync(const RHIComputePipelineDesc& inDesc) { return m_PipelineCompiler.CompileAsync(inDesc); }
+    RefCountPtr<RHIAsyncGraphicsPipeline> CreatePipelineAsync(const RHIGraphicsPipelineDesc& inDesc) { return m_PipelineCompiler.CompileAsync(inDesc); }
+    RHIPipelineCompiler& GetPipelineCompiler() { return m_PipelineCompiler; }
+
+    // Persistently mapped upload memory for buffer and texture uploads, see RHIUploadRing::Submit
+    RHIUploadRing& GetUploadRing() { return m_UploadRing; }
+
+    // Per frame constants sub-allocated from one mapped buffer, see RHIResourceSet::BindBufferCBV
+    RHIConstantAllocator& GetConstantAllocator() { return m_ConstantAllocator; }
+
+    // The frames in flight of the render loop, see RHIFrameContext::BeginFrame
+    RHIFrameContext& GetFrameContext() { return m_FrameContext; }
+
+    // Keeps the tracked heaps and committed resources within the memory budget, see RHIResidencyManager::MarkUsed
+    RHIResidencyManager& GetResidencyManager() { return m_ResidencyManager; }
+
+    // Placed buffers and textures sub-allocated from shared heaps, see RHIMemoryAllocator::CreateBuffer
+    RHIMemoryAllocator& GetMemoryAllocator() { return m_MemoryAllocator; }
+
+    // Moves the registered placed resources out of the least used heaps, see RHIDefragmenter::Register
+    RHIDefragmenter& GetDefragmenter() { return m_Defragmenter; }
+
+    // Stable indices of the views in one shader visible table, see RHIBindlessTable::RegisterTextureSRV
+    RHIBindlessTable& GetBindlessTable() { return m_BindlessTable; }
+
+    // Recording command lists recycled per queue type and thread, see RHICommandListPool::Acquire
+    RHICommandListPool& GetCommandListPool() { return m_CommandListPool; }
+
+protected:
+    RHIDevice() : m_PipelineCompiler(*this), m_UploadRing(*this), m_ConstantAllocator(*this), m_FrameContext(*this), m_ResidencyManager(*this), m_MemoryAllocator(*this), m_Defragmenter(*this), m_BindlessTable(*this), m_CommandListPool(*this) {}
+    
+    // Destroyed in reverse order, the compiler saves into a live pipeline cache whose pipelines use the cached layouts
+    RHIStateCache m_StateCache;
+    RHIPipelineCache m_PipelineCache;
+    RHIPipelineCompiler m_PipelineCompiler;
+    RHIUploadRing m_UploadRing;
+    RHIConstantAllocator m_ConstantAllocator;
+    RHIFrameContext m_FrameContext;
+    RHIResidencyManager m_ResidencyManager;
+    RHIMemoryAllocator m_MemoryAllocator;
+    RHIDefragmenter m_Defragmenter;
+    RHIBindlessTable m_BindlessTable;
+    RHICommandListPool m_CommandListPool;
+    RHISubmitStats m_SubmitStats;
 };
\ No newline at end of file
@@ -0,0 +1,153 @@
+#include "RHIFrameContext.h"
+#include "RHIDevice.h"
+#include "RHICommandList.h"
+#include "../Core/Log.h"
+#include <chrono>
+
+RHIFrameContext::RHIFrameContext(RHIDevice& inDevice)
+    : m_Device(inDevice)
+{
+
+}
+
+RHIFrameContext::~RHIFrameContext()
+{
+    Shutdown();
+}
+
+bool RHIFrameContext::Init(uint32_t inNumFramesInFlight)
+{
+    if(IsValid())
+    {
+        Log::Warning("[RHI] Frame context already initialized");
+        return true;
+    }
+
+    const uint32_t numFrames = std::clamp<uint32_t>(inNumFramesInFlight, 1, s_MaxNumFramesInFlight);
+    std::vector<Frame> frames(numFrames);
+    for(uint32_t i = 0; i < numFrames; ++i)
+    {
+        frames[i].Fence = m_Device.CreateRhiFence();
+        if(!frames[i].Fence.IsValid() || !frames[i].Fence->IsValid())
+        {
+            Log::Error("[RHI] Failed to create the fence of frame %u", i);
+            return false;
+        }
+    }
+
+    RHIConstantAllocator& constantAllocator = m_Device.GetConstantAllocator();
+    if(!constantAllocator.IsValid())
+    {
+        constantAllocator.Init(numFrames);
+    }
+    
+    m_Frames = std::move(frames);
+    m_CurrentFrame = numFrames - 1; // the first BeginFrame moves to slot 0
+    m_IsRecording = false;
+    return true;
+}
+
+void RHIFrameContext::Shutdown()
+{
+    WaitIdle();
+    m_Frames.clear();
+    m_CurrentFrame = 0;
+    m_IsRecording = false;
+}
+
+RefCountPtr<RHICommandList>& RHIFrameContext::BeginFrame()
+{
+    if(!IsValid())
+    {
+        Init();
+    }
+
+    if(m_IsRecording)
+    {
+        Log::Warning("[RHI] BeginFrame called twice without EndFrame, the frame %llu is recorded further", m_FrameNumber);
+        return GetCommandList();
+    }
+
+    m_CurrentFrame = (m_CurrentFrame + 1) % GetNumFramesInFlight();
+    Frame& frame = m_Frames[m_CurrentFrame];
+    if(frame.IsInFlight && !frame.Fence->IsCompleted())
+    {
+        const auto start = std::chrono::high_resolution_clock::now();
+        frame.Fence->CpuWait();
+        m_Stats.StallTime += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+        ++m_Stats.Stalls;
+    }
+    frame.IsInFlight = false;
+
+    // The frame which used the slot before and every frame before it finished
+    const uint64_t completedFrames = m_FrameNumber + 1 >= GetNumFramesInFlight() ? m_FrameNumber + 1 - GetNumFramesInFlight() : 0;
+    m_Device.GetResidencyManager().BeginFrame(m_FrameNumber, completedFrames);
+
+    // The slot fence is reset by the next submit, the ring ranges, moves and frees still referencing it have to go first
+    m_Device.GetUploadRing().Retire();
+    m_Device.GetDefragmenter().Retire();
+    m_Device.GetBindlessTable().Retire();
+    m_Device.GetCommandListPool().Retire();
+    m_Device.GetMemoryAllocator().Trim();
+    m_Device.GetConstantAllocator().BeginFrame();
+
+    m_IsRecording = true;
+    RefCountPtr<RHICommandList>& commandList = GetCommandList();
+    commandList->Begin();
+    m_Device.GetDefragmenter().RecordMoves(commandList.GetReference());
+    return commandList;
+}
+
+void RHIFrameContext::EndFrame()
+{
+    if(!m_IsRecording)
+    {
+        Log::Error("[RHI] EndFrame called without BeginFrame");
+        return;
+    }
+
+    Frame& frame = m_Frames[m_CurrentFrame];
+    m_Device.ExecuteCommandList(GetCommandList(), frame.Fence);
+    m_Device.GetUploadRing().Submit(frame.Fence);
+    m_Device.GetDefragmenter().Submit(frame.Fence);
+    m_Device.GetBindlessTable().Submit(frame.Fence);
+    m_Device.GetCommandListPool().Submit(frame.Fence);
+    m_Device.GetConstantAllocator().EndFrame(frame.Fence);
+    frame.IsInFlight = true;
+    m_IsRecording = false;
+    ++m_FrameNumber;
+    ++m_Stats.Frames;
+}
+
+void RHIFrameContext::WaitIdle()
+{
+    for(Frame& frame : m_Frames)
+    {
+        WaitForFrame(frame);
+    }
+}
+
+void RHIFrameContext::WaitForFrame(Frame& inFrame)
+{
+    if(inFrame.IsInFlight && !inFrame.Fence->IsCompleted())
+    {
+        inFrame.Fence->CpuWait();
+    }
+    inFrame.IsInFlight = false;
+}
+
+RefCountPtr<RHICommandList>& RHIFrameContext::GetCommandList(ERHICommandQueueType inType)
+{
+    RefCountPtr<RHICommandList>& commandList = m_Frames[m_CurrentFrame].CommandLists[static_cast<uint8_t>(inType)];
+    if(!commandList.IsValid())
+    {
+        commandList = m_Device.CreateCommandList(inType);
+        commandList->SetName("FrameCommandList");
+    }
+    return commandList;
+}
+
+void RHIFrameContext::ResetStats()
+{
+    m_Stats = RHIFrameContextStats();
+}
\ No newline at end of file
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "RHIResources.h"
+#include <array>
+
+class RHIDevice;
+class RHIFence;
+class RHICommandList;
+
+struct RHIFrameContextStats
+{
+    uint64_t Frames = 0;
+    uint64_t Stalls = 0;        // frames which waited for the gpu to finish the frame last using the same slot
+    double StallTime = 0;       // milliseconds the cpu waited in BeginFrame
+};
+
+// Lets the cpu record the next frames while the gpu executes the previous ones. Every frame slot has its own command
+// lists, so a command allocator or pool is only reset once the gpu finished with it, and its own fence, which also
+// retires the upload ring allocations and constant allocator region of the frame. The cpu only waits in BeginFrame
+// when the slot it moves to is still in flight.
+class RHIFrameContext
+{
+public:
+    static constexpr uint32_t s_DefaultNumFramesInFlight = 2;
+    static constexpr uint32_t s_MaxNumFramesInFlight = 4;
+
+    explicit RHIFrameContext(RHIDevice& inDevice);
+    ~RHIFrameContext();
+    RHIFrameContext(const RHIFrameContext&) = delete;
+    RHIFrameContext& operator=(const RHIFrameContext&) = delete;
+
+    // Called by the first BeginFrame with the default count. Sizes the constant allocator to the same count if it is
+    // not initialized yet
+    bool Init(uint32_t inNumFramesInFlight = s_DefaultNumFramesInFlight);
+    // Waits for the frames in flight and releases the command lists
+    void Shutdown();
+    bool IsValid() const { return !m_Frames.empty(); }
+
+    // Moves to the next slot, waits for its fence if the gpu is still executing it and begins its direct command list
+    RefCountPtr<RHICommandList>& BeginFrame();
+    // Executes the direct command list of the frame signaling the frame fence, and hands the fence to the upload ring
+    // and the constant allocator. Command lists of other queues are executed by the caller before
+    void EndFrame();
+    // Waits for every frame in flight
+    void WaitIdle();
+
+    // The command lists of the current slot, created on first use
+    RefCountPtr<RHICommandList>& GetCommandList(ERHICommandQueueType inType = ERHICommandQueueType::Direct);
+    const RefCountPtr<RHIFence>& GetFence() const { return m_Frames[m_CurrentFrame].Fence; }
+    uint32_t GetFrameIndex() const { return m_CurrentFrame; }
+    uint32_t GetNumFramesInFlight() const { return static_cast<uint32_t>(m_Frames.size()); }
+    uint64_t GetFrameNumber() const { return m_FrameNumber; }
+
+    const RHIFrameContextStats& GetStats() const { return m_Stats; }
+    void ResetStats();
+
+private:
+    struct Frame
+    {
+        std::array<RefCountPtr<RHICommandList>, static_cast<uint8_t>(ERHICommandQueueType::Count)> CommandLists;
+        RefCountPtr<RHIFence> Fence;
+        bool IsInFlight = false;
+    };
+
+    void WaitForFrame(Frame& inFrame);
+
+    RHIDevice& m_Device;
+    std::vector<Frame> m_Frames;
+    uint32_t m_CurrentFrame = 0;
+    uint64_t m_FrameNumber = 0;
+    bool m_IsRecording = false;
+    RHIFrameContextStats m_Stats;
+};
\ No newline at end of file
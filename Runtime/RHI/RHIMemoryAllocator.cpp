@@ -0,0 +1,224 @@
+#include "RHIMemoryAllocator.h"
+#include "RHIDevice.h"
+#include "../Core/Log.h"
+#include "../Core/Templates.h"
+#include <algorithm>
+
+static uint32_t CeilLog2(uint64_t inValue)
+{
+    uint32_t result = 0;
+    while((1ull << result) < inValue)
+    {
+        ++result;
+    }
+    return result;
+}
+
+RHIMemoryAllocator::RHIMemoryAllocator(RHIDevice& inDevice)
+    : m_Device(inDevice)
+{
+
+}
+
+RefCountPtr<RHIBuffer> RHIMemoryAllocator::CreateBuffer(const RHIBufferDesc& inDesc)
+{
+    RefCountPtr<RHIBuffer> buffer = m_Device.CreateBuffer(inDesc, true);
+    if(!buffer.IsValid())
+    {
+        return nullptr;
+    }
+
+    RHIResourceHeapDesc heapDesc;
+    heapDesc.Usage = ERHIHeapUsage::Buffer;
+    heapDesc.TypeFilter = buffer->GetMemTypeFilter();
+    switch (inDesc.CpuAccess)
+    {
+    case ERHICpuAccessMode::None:
+        heapDesc.Type = ERHIResourceHeapType::DeviceLocal;
+        break;
+    case ERHICpuAccessMode::Read:
+        heapDesc.Type = ERHIResourceHeapType::Readback;
+        break;
+    case ERHICpuAccessMode::Write:
+        heapDesc.Type = ERHIResourceHeapType::Upload;
+        break;
+    }
+    
+    const uint64_t size = buffer->GetAllocSizeInByte();
+    const uint64_t alignment = std::max<uint64_t>(buffer->GetAllocAlignment(), 1);
+
+    // The lock is held through the binding, another thread would take the range CanAllocate found otherwise
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    RefCountPtr<RHIResourceHeap> heap = size >= m_DedicatedThreshold
+        ? CreateDedicatedBlock(heapDesc, size, alignment)
+        : FindOrCreateBlock(heapDesc, size, alignment);
+    if(!heap.IsValid() || !buffer->BindMemory(heap))
+    {
+        Log::Error("[RHI] Failed to allocate %llu bytes for a buffer", size);
+        return nullptr;
+    }
+    return buffer;
+}
+
+RefCountPtr<RHITexture> RHIMemoryAllocator::CreateTexture(const RHITextureDesc& inDesc)
+{
+    RefCountPtr<RHITexture> texture = m_Device.CreateTexture(inDesc, true);
+    if(!texture.IsValid())
+    {
+        return nullptr;
+    }
+
+    RHIResourceHeapDesc heapDesc;
+    heapDesc.Type = ERHIResourceHeapType::DeviceLocal;
+    heapDesc.Usage = ERHIHeapUsage::Texture;
+    heapDesc.TypeFilter = texture->GetMemTypeFilter();
+    
+    const uint64_t size = texture->GetAllocSizeInByte();
+    const uint64_t alignment = std::max<uint64_t>(texture->GetAllocAlignment(), 1);
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    RefCountPtr<RHIResourceHeap> heap = size >= m_DedicatedThreshold
+        ? CreateDedicatedBlock(heapDesc, size, alignment)
+        : FindOrCreateBlock(heapDesc, size, alignment);
+    if(!heap.IsValid() || !texture->BindMemory(heap))
+    {
+        Log::Error("[RHI] Failed to allocate %llu bytes for a texture", size);
+        return nullptr;
+    }
+    return texture;
+}
+
+void RHIMemoryAllocator::SetBlockSize(uint64_t inSize)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_BlockSize = inSize;
+    m_DedicatedThreshold = inSize / 2;
+}
+
+RefCountPtr<RHIResourceHeap> RHIMemoryAllocator::FindOrCreateBlock(const RHIResourceHeapDesc& inDesc, uint64_t inSize, uint64_t inAlignment)
+{
+    // MSAA textures need heaps with a larger alignment, they get block lists of their own
+    const uint64_t heapAlignment = std::max(inDesc.Alignment, inAlignment);
+    const uint32_t sizeClass = GetSizeClass(inSize, inAlignment);
+    const uint64_t key = (static_cast<uint64_t>(inDesc.TypeFilter) << 32)
+        | (static_cast<uint64_t>(CeilLog2(heapAlignment)) << 24)
+        | (static_cast<uint64_t>(inDesc.Type) << 16)
+        | (static_cast<uint64_t>(inDesc.Usage) << 8)
+        | sizeClass;
+
+    BlockList& blockList = m_BlockLists[key];
+    for(RefCountPtr<RHIResourceHeap>& block : blockList.Blocks)
+    {
+        if(block->CanAllocate(inSize, inAlignment))
+        {
+            ++m_Stats.PlacedAllocations;
+            return block;
+        }
+    }
+
+    RHIResourceHeapDesc heapDesc = inDesc;
+    heapDesc.Alignment = heapAlignment;
+    heapDesc.Size = Align(std::max(sizeClass > 0 ? std::min(s_PoolBlockSize, m_BlockSize) : m_BlockSize, inSize), heapAlignment);
+    RefCountPtr<RHIResourceHeap> block = m_Device.CreateResourceHeap(heapDesc);
+    if(!block.IsValid() || !block->IsValid())
+    {
+        return nullptr;
+    }
+    block->SetName(sizeClass > 0 ? "PooledMemoryBlock" : "MemoryBlock");
+    TrackBlock(block);
+    blockList.Desc = heapDesc;
+    blockList.Blocks.push_back(block);
+    ++m_Stats.BlockCreations;
+    ++m_Stats.PlacedAllocations;
+    return block;
+}
+
+RefCountPtr<RHIResourceHeap> RHIMemoryAllocator::CreateDedicatedBlock(const RHIResourceHeapDesc& inDesc, uint64_t inSize, uint64_t inAlignment)
+{
+    RHIResourceHeapDesc heapDesc = inDesc;
+    heapDesc.Alignment = std::max(inDesc.Alignment, inAlignment);
+    heapDesc.Size = Align(inSize, heapDesc.Alignment);
+    RefCountPtr<RHIResourceHeap> block = m_Device.CreateResourceHeap(heapDesc);
+    if(!block.IsValid() || !block->IsValid())
+    {
+        return nullptr;
+    }
+    block->SetName("DedicatedMemoryBlock");
+    TrackBlock(block);
+    ++m_Stats.DedicatedAllocations;
+    return block;
+}
+
+// The residency manager evicts the blocks in device local memory, a block untracks itself when it is released, for a
+// dedicated block that is when its resource is released
+void RHIMemoryAllocator::TrackBlock(const RefCountPtr<RHIResourceHeap>& inBlock)
+{
+    if(inBlock->GetDesc().Type == ERHIResourceHeapType::DeviceLocal)
+    {
+        m_Device.GetResidencyManager().Track(inBlock);
+    }
+}
+
+uint32_t RHIMemoryAllocator::GetSizeClass(uint64_t inSize, uint64_t inAlignment)
+{
+    if(inSize > s_MaxPooledSize)
+    {
+        return 0;
+    }
+    return CeilLog2(std::max(inSize, inAlignment));
+}
+
+void RHIMemoryAllocator::Trim()
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    for(auto& blockList : m_BlockLists)
+    {
+        std::vector<RefCountPtr<RHIResourceHeap>>& blocks = blockList.second.Blocks;
+        bool keptEmptyBlock = false;
+        for(auto iter = blocks.begin(); iter != blocks.end();)
+        {
+            if((*iter)->IsEmpty() && iter->GetRefCount() == 1)
+            {
+                if(!keptEmptyBlock)
+                {
+                    keptEmptyBlock = true;
+                }
+                else
+                {
+                    iter = blocks.erase(iter);
+                    ++m_Stats.BlockReleases;
+                    continue;
+                }
+            }
+            ++iter;
+        }
+    }
+}
+
+void RHIMemoryAllocator::Clear()
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_BlockLists.clear();
+}
+
+RHIMemoryAllocatorStats RHIMemoryAllocator::GetStats() const
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    RHIMemoryAllocatorStats stats = m_Stats;
+    for(const auto& blockList : m_BlockLists)
+    {
+        for(const RefCountPtr<RHIResourceHeap>& block : blockList.second.Blocks)
+        {
+            ++stats.Blocks;
+            stats.BlockBytes += block->GetDesc().Size;
+            stats.UsedBytes += block->GetUsedSize();
+        }
+    }
+    return stats;
+}
+
+void RHIMemoryAllocator::ResetStats()
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Stats = RHIMemoryAllocatorStats();
+}
\ No newline at end of file
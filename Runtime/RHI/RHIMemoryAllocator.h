@@ -0,0 +1,73 @@
+#pragma once
+
+#include "RHIResources.h"
+#include <mutex>
+#include <unordered_map>
+
+class RHIDevice;
+
+struct RHIMemoryAllocatorStats
+{
+    uint32_t Blocks = 0;
+    uint64_t BlockBytes = 0;
+    uint64_t UsedBytes = 0;             // bound to live resources
+    uint64_t BlockCreations = 0;        // heaps created for the block lists, every one is a driver allocation
+    uint64_t BlockReleases = 0;
+    uint64_t PlacedAllocations = 0;     // resources sub-allocated from a block
+    uint64_t DedicatedAllocations = 0;  // resources above the dedicated threshold, each got its own heap
+};
+
+// Sub-allocates placed buffers and textures from large resource heaps. The heaps are kept in block lists per heap
+// type, usage and memory type, resources up to s_MaxPooledSize go to separate pools per power of two size class so
+// small resources of similar size share blocks and do not fragment the large blocks. Resources from the dedicated
+// threshold on get a heap of their own. Empty blocks are released by Trim, one per block list is kept to absorb
+// create and destroy churn.
+class RHIMemoryAllocator
+{
+public:
+    static constexpr uint64_t s_DefaultBlockSize = 64ull * 1024 * 1024;
+    static constexpr uint64_t s_PoolBlockSize = 4ull * 1024 * 1024;
+    static constexpr uint64_t s_MaxPooledSize = 256ull * 1024;
+    
+    explicit RHIMemoryAllocator(RHIDevice& inDevice);
+    RHIMemoryAllocator(const RHIMemoryAllocator&) = delete;
+    RHIMemoryAllocator& operator=(const RHIMemoryAllocator&) = delete;
+
+    // Same as RHIDevice::CreateBuffer and RHIDevice::CreateTexture, the resources are virtual and bound to a block
+    RefCountPtr<RHIBuffer> CreateBuffer(const RHIBufferDesc& inDesc);
+    RefCountPtr<RHITexture> CreateTexture(const RHITextureDesc& inDesc);
+
+    // Affects the blocks created afterward, the dedicated threshold defaults to half the block size
+    void SetBlockSize(uint64_t inSize);
+    void SetDedicatedThreshold(uint64_t inSize) { m_DedicatedThreshold = inSize; }
+    uint64_t GetBlockSize() const { return m_BlockSize; }
+    uint64_t GetDedicatedThreshold() const { return m_DedicatedThreshold; }
+
+    // Called by RHIFrameContext::BeginFrame, releases the empty blocks except one per block list
+    void Trim();
+    // Releases every block, the resources bound to a block keep it alive
+    void Clear();
+
+    RHIMemoryAllocatorStats GetStats() const;
+    void ResetStats();
+
+private:
+    struct BlockList
+    {
+        RHIResourceHeapDesc Desc;
+        std::vector<RefCountPtr<RHIResourceHeap>> Blocks;
+    };
+
+    // Returns a heap with room for the resource, nullptr if the heap creation failed
+    RefCountPtr<RHIResourceHeap> FindOrCreateBlock(const RHIResourceHeapDesc& inDesc, uint64_t inSize, uint64_t inAlignment);
+    RefCountPtr<RHIResourceHeap> CreateDedicatedBlock(const RHIResourceHeapDesc& inDesc, uint64_t inSize, uint64_t inAlignment);
+    void TrackBlock(const RefCountPtr<RHIResourceHeap>& inBlock);
+    static uint32_t GetSizeClass(uint64_t inSize, uint64_t inAlignment);
+
+    RHIDevice& m_Device;
+    mutable std::mutex m_Mutex;
+    std::unordered_map<uint64_t, BlockList> m_BlockLists;
+    uint64_t m_BlockSize = s_DefaultBlockSize;
+    uint64_t m_DedicatedThreshold = s_DefaultBlockSize / 2;
+    RHIMemoryAllocatorStats m_Stats;
+};
\ No newline at end of file
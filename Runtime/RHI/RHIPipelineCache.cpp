@@ -0,0 +1,428 @@
+#include "RHIPipelineCache.h"
+#include "RHIPipelineCompiler.h"
+#include "RHIStateCache.h"
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include "../Core/Hash.h"
+#include "../Core/Log.h"
+
+template<typename T>
+static void AppendKey(std::string& outKey, const T& inValue)
+{
+    static_assert(std::is_trivially_copyable_v<T>, "Only POD values can be appended to a pipeline key");
+    outKey.append(reinterpret_cast<const char*>(&inValue), sizeof(T));
+}
+
+static void AppendShaderKey(std::string& outKey, const RHIShader* inShader)
+{
+    if(inShader == nullptr)
+    {
+        AppendKey(outKey, static_cast<uint64_t>(0));
+        return;
+    }
+    
+    AppendKey(outKey, inShader->GetType());
+    AppendKey(outKey, static_cast<uint64_t>(inShader->GetSize()));
+    if(inShader->GetSize() > 0)
+    {
+        const uint128 byteCodeHash = CityHash128(reinterpret_cast<const char*>(inShader->GetData()), inShader->GetSize());
+        AppendKey(outKey, Uint128Low64(byteCodeHash));
+        AppendKey(outKey, Uint128High64(byteCodeHash));
+    }
+    outKey.append(inShader->GetEntryName());
+    outKey.push_back('\0');
+}
+
+static void AppendBindingLayoutKey(std::string& outKey, const RHIPipelineBindingLayout* inLayout, bool inPersistent)
+{
+    if(!inPersistent || inLayout == nullptr)
+    {
+        AppendKey(outKey, reinterpret_cast<uintptr_t>(inLayout));
+        return;
+    }
+
+    outKey.append(RHIStateCache::GetKey(inLayout->GetDesc()));
+}
+
+static std::string GetGraphicsKey(const RHIGraphicsPipelineDesc& inDesc, bool inPersistent)
+{
+    std::string key;
+    key.reserve(512);
+    
+    AppendKey(key, inDesc.UsingMeshShader);
+    AppendShaderKey(key, inDesc.VertexShader);
+    AppendShaderKey(key, inDesc.HullShader);
+    AppendShaderKey(key, inDesc.DomainShader);
+    AppendShaderKey(key, inDesc.GeometryShader);
+    AppendShaderKey(key, inDesc.PixelShader);
+    AppendShaderKey(key, inDesc.AmplificationShader);
+    AppendShaderKey(key, inDesc.MeshShader);
+    AppendBindingLayoutKey(key, inDesc.BindingLayout, inPersistent);
+
+    if(inDesc.VertexInputLayout)
+    {
+        AppendKey(key, static_cast<uint32_t>(inDesc.VertexInputLayout->Items.size()));
+        for(const RHIVertexInputItem& item : inDesc.VertexInputLayout->Items)
+        {
+            key.append(item.SemanticName ? item.SemanticName : "");
+            key.push_back('\0');
+            AppendKey(key, item.SemanticIndex);
+            AppendKey(key, item.Format);
+        }
+    }
+    else
+    {
+        AppendKey(key, UINT32_MAX);
+    }
+    
+    AppendKey(key, inDesc.PrimitiveType);
+
+    // Field by field, the padding of the state structs is not initialized
+    const RHIRasterizerDesc& raster = inDesc.RasterizerState;
+    AppendKey(key, raster.FillMode);
+    AppendKey(key, raster.CullMode);
+    AppendKey(key, raster.FrontCounterClockwise);
+    AppendKey(key, raster.DepthBias);
+    AppendKey(key, raster.DepthBiasClamp);
+    AppendKey(key, raster.SlopeScaledDepthBias);
+    AppendKey(key, raster.DepthClipEnable);
+    AppendKey(key, raster.MultisampleEnable);
+    AppendKey(key, raster.AntialiasedLineEnable);
+    AppendKey(key, raster.ConservativeRasterEnable);
+    AppendKey(key, raster.ForcedSampleCount);
+
+    const RHIDepthStencilDesc& depthStencil = inDesc.DepthStencilState;
+    AppendKey(key, depthStencil.DepthTestEnable);
+    AppendKey(key, depthStencil.DepthWriteEnable);
+    AppendKey(key, depthStencil.DepthFunc);
+    AppendKey(key, depthStencil.StencilEnable);
+    AppendKey(key, depthStencil.StencilReadMask);
+    AppendKey(key, depthStencil.StencilWriteMask);
+    AppendKey(key, depthStencil.StencilRef);
+    AppendKey(key, depthStencil.FrontFaceStencilFailOp);
+    AppendKey(key, depthStencil.FrontFaceDepthFailOp);
+    AppendKey(key, depthStencil.FrontFacePassOp);
+    AppendKey(key, depthStencil.FrontFaceFunc);
+    AppendKey(key, depthStencil.BackFaceStencilFailOp);
+    AppendKey(key, depthStencil.BackFaceDepthFailOp);
+    AppendKey(key, depthStencil.BackFacePassOp);
+    AppendKey(key, depthStencil.BackFaceFunc);
+
+    const RHIBlendStateDesc& blend = inDesc.BlendState;
+    AppendKey(key, blend.NumRenderTarget);
+    AppendKey(key, blend.AlphaToCoverageEnable);
+    for(uint32_t i = 0; i < blend.NumRenderTarget && i < RHIRenderTargetsMaxCount; ++i)
+    {
+        const RHIBlendStateDesc::RenderTarget& target = blend.Targets[i];
+        AppendKey(key, target.BlendEnable);
+        AppendKey(key, target.ColorSrcBlend);
+        AppendKey(key, target.ColorDstBlend);
+        AppendKey(key, target.ColorBlendOp);
+        AppendKey(key, target.AlphaSrcBlend);
+        AppendKey(key, target.AlphaDstBlend);
+        AppendKey(key, target.AlphaBlendOp);
+        AppendKey(key, target.ColorWriteMask);
+    }
+
+    AppendKey(key, inDesc.NumRenderTarget);
+    for(uint32_t i = 0; i < inDesc.NumRenderTarget && i < RHIRenderTargetsMaxCount; ++i)
+    {
+        AppendKey(key, inDesc.RTVFormats[i]);
+    }
+    AppendKey(key, inDesc.DSVFormat);
+    AppendKey(key, inDesc.SampleCount);
+    AppendKey(key, inDesc.SampleQuality);
+    return key;
+}
+
+static std::string GetComputeKey(const RHIComputePipelineDesc& inDesc, bool inPersistent)
+{
+    std::string key;
+    AppendShaderKey(key, inDesc.ComputeShader);
+    AppendBindingLayoutKey(key, inDesc.BindingLayout, inPersistent);
+    return key;
+}
+
+static std::string GetPersistentNameFromKey(const std::string& inKey)
+{
+    const uint128 hash = CityHash128(inKey.data(), inKey.size());
+    char name[40];
+    snprintf(name, sizeof(name), "%016llx%016llx"
+        , static_cast<unsigned long long>(Uint128High64(hash))
+        , static_cast<unsigned long long>(Uint128Low64(hash)));
+    return name;
+}
+
+std::string RHIPipelineCache::GetKey(const RHIGraphicsPipelineDesc& inDesc)
+{
+    return GetGraphicsKey(inDesc, false);
+}
+
+std::string RHIPipelineCache::GetKey(const RHIComputePipelineDesc& inDesc)
+{
+    return GetComputeKey(inDesc, false);
+}
+
+std::string RHIPipelineCache::GetPersistentName(const RHIGraphicsPipelineDesc& inDesc)
+{
+    return GetPersistentNameFromKey(GetGraphicsKey(inDesc, true));
+}
+
+std::string RHIPipelineCache::GetPersistentName(const RHIComputePipelineDesc& inDesc)
+{
+    return GetPersistentNameFromKey(GetComputeKey(inDesc, true));
+}
+
+RHIPipelineCache::~RHIPipelineCache()
+{
+    Clear();
+}
+
+template<typename PipelineType, typename PipelineDescType, typename CreateFuncType>
+RefCountPtr<PipelineType> RHIPipelineCache::FindOrCreate(CacheMap<PipelineType>& inCache, const PipelineDescType& inDesc, const CreateFuncType& inCreateFunc)
+{
+    std::string key = GetKey(inDesc);
+    const uint64_t hash = CityHash64(key.data(), key.size());
+
+    {
+        std::lock_guard lock(m_Mutex);
+        auto iter = inCache.find(hash);
+        if(iter != inCache.end())
+        {
+            for(CacheEntry<PipelineType>& entry : iter->second)
+            {
+                if(entry.Key == key)
+                {
+                    entry.Hits++;
+                    m_Stats.Hits++;
+                    return entry.Pipeline;
+                }
+            }
+        }
+        m_Stats.Misses++;
+    }
+
+    // Compiled outside the lock so the pipeline compiler threads run in parallel. Two threads missing on the same
+    // desc both compile, the first one inserted wins and the other pipeline is dropped
+    const auto createBegin = std::chrono::high_resolution_clock::now();
+    RefCountPtr<PipelineType> pipeline = inCreateFunc(inDesc);
+    const double createTimeMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - createBegin).count();
+
+    std::lock_guard lock(m_Mutex);
+    m_Stats.CreateTimeMs += createTimeMs;
+    // Failed pipelines are not cached, the next request tries again
+    if(!pipeline.IsValid() || !pipeline->IsValid())
+    {
+        return pipeline;
+    }
+    
+    std::vector<CacheEntry<PipelineType>>& entries = inCache[hash];
+    for(CacheEntry<PipelineType>& entry : entries)
+    {
+        if(entry.Key == key)
+        {
+            return entry.Pipeline;
+        }
+    }
+
+    CacheEntry<PipelineType> entry;
+    entry.Key = std::move(key);
+    entry.Pipeline = pipeline;
+    entry.BindingLayout = inDesc.BindingLayout;
+    entries.emplace_back(std::move(entry));
+    if(m_Manifest != nullptr)
+    {
+        m_Manifest->Add(inDesc);
+    }
+    return pipeline;
+}
+
+RefCountPtr<RHIGraphicsPipeline> RHIPipelineCache::FindOrCreate(const RHIGraphicsPipelineDesc& inDesc, const GraphicsPipelineCreateFunc& inCreateFunc)
+{
+    return FindOrCreate(m_GraphicsPipelines, inDesc, inCreateFunc);
+}
+
+RefCountPtr<RHIComputePipeline> RHIPipelineCache::FindOrCreate(const RHIComputePipelineDesc& inDesc, const ComputePipelineCreateFunc& inCreateFunc)
+{
+    return FindOrCreate(m_ComputePipelines, inDesc, inCreateFunc);
+}
+
+void RHIPipelineCache::SetManifest(RHIPipelineManifest* inManifest)
+{
+    std::lock_guard lock(m_Mutex);
+    m_Manifest = inManifest;
+}
+
+void RHIPipelineCache::Clear()
+{
+    std::lock_guard lock(m_Mutex);
+    m_GraphicsPipelines.clear();
+    m_ComputePipelines.clear();
+}
+
+RHIPipelineCacheStats RHIPipelineCache::GetStats() const
+{
+    std::lock_guard lock(m_Mutex);
+    RHIPipelineCacheStats stats = m_Stats;
+    stats.NumGraphicsPipelines = 0;
+    stats.NumComputePipelines = 0;
+    for(const auto& entries : m_GraphicsPipelines)
+        stats.NumGraphicsPipelines += static_cast<uint32_t>(entries.second.size());
+    for(const auto& entries : m_ComputePipelines)
+        stats.NumComputePipelines += static_cast<uint32_t>(entries.second.size());
+    return stats;
+}
+
+void RHIPipelineCache::ResetStats()
+{
+    std::lock_guard lock(m_Mutex);
+    m_Stats = RHIPipelineCacheStats();
+}
+
+///////////////////////////////////////////////////////////////////////////////////
+/// Persistent blobs
+///////////////////////////////////////////////////////////////////////////////////
+struct RHIPipelineCacheBlobHeader
+{
+    char Magic[4];
+    uint32_t Version;
+    uint32_t Backend;
+    uint32_t VendorId;
+    uint32_t DeviceId;
+    uint32_t Padding;
+    uint64_t DriverVersion;
+    uint8_t CacheUuid[16];
+    uint64_t DataSize;
+    uint64_t DataHash;
+};
+
+static constexpr char s_BlobMagic[4] = {'R', 'H', 'P', 'C'};
+static constexpr uint32_t s_BlobVersion = 1;
+
+static void InitBlobHeader(RHIPipelineCacheBlobHeader& outHeader, ERHIBackend inBackend, const RHIPipelineCacheDeviceId& inDeviceId)
+{
+    memset(&outHeader, 0, sizeof(outHeader));
+    memcpy(outHeader.Magic, s_BlobMagic, sizeof(s_BlobMagic));
+    outHeader.Version = s_BlobVersion;
+    outHeader.Backend = static_cast<uint32_t>(inBackend);
+    outHeader.VendorId = inDeviceId.VendorId;
+    outHeader.DeviceId = inDeviceId.DeviceId;
+    outHeader.DriverVersion = inDeviceId.DriverVersion;
+    memcpy(outHeader.CacheUuid, inDeviceId.CacheUuid.data(), sizeof(outHeader.CacheUuid));
+}
+
+std::filesystem::path RHIPipelineCache::GetBlobPath(ERHIBackend inBackend, const char* inFileName)
+{
+    const std::string& directory = RHI::GetPipelineCacheDirectory();
+    if(directory.empty())
+    {
+        return {};
+    }
+    
+    std::string fileName(inFileName);
+    if(inBackend == ERHIBackend::Vulkan)
+        fileName += ".Vulkan.bin";
+    else if(inBackend == ERHIBackend::Null)
+        fileName += ".Null.bin";
+    else
+        fileName += ".D3D12.bin";
+    return std::filesystem::path(directory) / fileName;
+}
+
+bool RHIPipelineCache::LoadBlob(ERHIBackend inBackend, const RHIPipelineCacheDeviceId& inDeviceId, std::vector<uint8_t>& outData)
+{
+    outData.clear();
+    const std::filesystem::path path = GetBlobPath(inBackend);
+    if(path.empty())
+    {
+        return false;
+    }
+    
+    std::ifstream file(path, std::ios::binary);
+    if(!file.is_open())
+    {
+        Log::Info("[RHI] No pipeline cache at %s, pipelines are compiled from scratch", path.string().c_str());
+        return false;
+    }
+
+    RHIPipelineCacheBlobHeader header;
+    RHIPipelineCacheBlobHeader expected;
+    InitBlobHeader(expected, inBackend, inDeviceId);
+    if(!file.read(reinterpret_cast<char*>(&header), sizeof(header))
+        || memcmp(header.Magic, expected.Magic, sizeof(header.Magic)) != 0
+        || header.Version != expected.Version
+        || header.Backend != expected.Backend)
+    {
+        Log::Warning("[RHI] %s is not a valid pipeline cache, discarded", path.string().c_str());
+        return false;
+    }
+
+    if(header.VendorId != expected.VendorId
+        || header.DeviceId != expected.DeviceId
+        || header.DriverVersion != expected.DriverVersion
+        || memcmp(header.CacheUuid, expected.CacheUuid, sizeof(header.CacheUuid)) != 0)
+    {
+        Log::Info("[RHI] The pipeline cache was saved by another gpu or driver, discarded");
+        return false;
+    }
+
+    outData.resize(header.DataSize);
+    if(!file.read(reinterpret_cast<char*>(outData.data()), static_cast<std::streamsize>(header.DataSize))
+        || CityHash64(reinterpret_cast<const char*>(outData.data()), outData.size()) != header.DataHash)
+    {
+        Log::Warning("[RHI] The pipeline cache %s is corrupted, discarded", path.string().c_str());
+        outData.clear();
+        return false;
+    }
+
+    Log::Info("[RHI] Loaded pipeline cache %s (%llu bytes)", path.string().c_str(), static_cast<unsigned long long>(header.DataSize));
+    return true;
+}
+
+bool RHIPipelineCache::SaveBlob(ERHIBackend inBackend, const RHIPipelineCacheDeviceId& inDeviceId, const void* inData, size_t inSize)
+{
+    const std::filesystem::path path = GetBlobPath(inBackend);
+    if(path.empty() || inData == nullptr || inSize == 0)
+    {
+        return false;
+    }
+
+    std::error_code errorCode;
+    std::filesystem::create_directories(path.parent_path(), errorCode);
+    
+    // Written next to the final file and renamed, a crash while saving never leaves a truncated cache behind
+    std::filesystem::path tempPath = path;
+    tempPath += ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        if(!file.is_open())
+        {
+            Log::Warning("[RHI] Failed to open %s for writing the pipeline cache", tempPath.string().c_str());
+            return false;
+        }
+
+        RHIPipelineCacheBlobHeader header;
+        InitBlobHeader(header, inBackend, inDeviceId);
+        header.DataSize = inSize;
+        header.DataHash = CityHash64(static_cast<const char*>(inData), inSize);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(static_cast<const char*>(inData), static_cast<std::streamsize>(inSize));
+        if(!file.good())
+        {
+            Log::Warning("[RHI] Failed to write the pipeline cache %s", tempPath.string().c_str());
+            return false;
+        }
+    }
+
+    std::filesystem::rename(tempPath, path, errorCode);
+    if(errorCode)
+    {
+        Log::Warning("[RHI] Failed to save the pipeline cache %s: %s", path.string().c_str(), errorCode.message().c_str());
+        std::filesystem::remove(tempPath, errorCode);
+        return false;
+    }
+    
+    Log::Info("[RHI] Saved pipeline cache %s (%llu bytes)", path.string().c_str(), static_cast<unsigned long long>(inSize));
+    return true;
+}
\ No newline at end of file
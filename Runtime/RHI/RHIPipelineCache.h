@@ -0,0 +1,86 @@
+#pragma once
+
+#include "RHIPipelineState.h"
+#include <functional>
+#include <mutex>
+#include <filesystem>
+
+class RHIPipelineManifest;
+
+struct RHIPipelineCacheStats
+{
+    uint64_t Hits = 0;
+    uint64_t Misses = 0;
+    uint32_t NumGraphicsPipelines = 0;
+    uint32_t NumComputePipelines = 0;
+    double CreateTimeMs = 0;    // time spent in driver compiles, compare cold and warm runs of the persistent cache
+};
+
+// The gpu and driver a persistent pipeline blob was produced by, blobs of any other device are discarded on load
+struct RHIPipelineCacheDeviceId
+{
+    uint32_t VendorId = 0;
+    uint32_t DeviceId = 0;
+    uint64_t DriverVersion = 0;
+    std::array<uint8_t, 16> CacheUuid {};
+};
+
+// Deduplicates pipelines by the content of their desc, so requesting the same pipeline again costs a hash lookup
+// instead of a driver compile. Shaders are keyed by their byte code, binding layouts by identity since the pipeline
+// keeps using the layout it was created with. Lookups are thread safe, creation runs outside of the cache lock.
+class RHIPipelineCache
+{
+public:
+    typedef std::function<RefCountPtr<RHIGraphicsPipeline>(const RHIGraphicsPipelineDesc&)> GraphicsPipelineCreateFunc;
+    typedef std::function<RefCountPtr<RHIComputePipeline>(const RHIComputePipelineDesc&)> ComputePipelineCreateFunc;
+    
+    RHIPipelineCache() = default;
+    ~RHIPipelineCache();
+    RHIPipelineCache(const RHIPipelineCache&) = delete;
+    RHIPipelineCache& operator=(const RHIPipelineCache&) = delete;
+
+    RefCountPtr<RHIGraphicsPipeline> FindOrCreate(const RHIGraphicsPipelineDesc& inDesc, const GraphicsPipelineCreateFunc& inCreateFunc);
+    RefCountPtr<RHIComputePipeline> FindOrCreate(const RHIComputePipelineDesc& inDesc, const ComputePipelineCreateFunc& inCreateFunc);
+    void Clear();
+    // Every pipeline added to the cache is also recorded into the manifest for the warm-up of the next run
+    void SetManifest(RHIPipelineManifest* inManifest);
+    RHIPipelineCacheStats GetStats() const;
+    void ResetStats();
+
+    // The key is the serialized desc, its CityHash is the map key and the key itself resolves collisions
+    static std::string GetKey(const RHIGraphicsPipelineDesc& inDesc);
+    static std::string GetKey(const RHIComputePipelineDesc& inDesc);
+
+    // Stable across runs, binding layouts are keyed by their desc. Names pipelines in the backend persistent caches
+    static std::string GetPersistentName(const RHIGraphicsPipelineDesc& inDesc);
+    static std::string GetPersistentName(const RHIComputePipelineDesc& inDesc);
+
+    // Persistent driver cache blobs (VkPipelineCache data, ID3D12PipelineLibrary serialization) stored in the
+    // RHI pipeline cache directory, the header is validated against the backend and the device
+    static std::filesystem::path GetBlobPath(ERHIBackend inBackend, const char* inFileName = "PipelineCache");
+    static bool LoadBlob(ERHIBackend inBackend, const RHIPipelineCacheDeviceId& inDeviceId, std::vector<uint8_t>& outData);
+    static bool SaveBlob(ERHIBackend inBackend, const RHIPipelineCacheDeviceId& inDeviceId, const void* inData, size_t inSize);
+    
+private:
+    template<typename PipelineType>
+    struct CacheEntry
+    {
+        std::string Key;
+        RefCountPtr<PipelineType> Pipeline;
+        // Keeps the layout address from being reused by another layout while the key refers to it
+        RefCountPtr<RHIPipelineBindingLayout> BindingLayout;
+        uint64_t Hits = 0;
+    };
+
+    template<typename PipelineType>
+    using CacheMap = std::unordered_map<uint64_t, std::vector<CacheEntry<PipelineType>>>;
+    
+    template<typename PipelineType, typename PipelineDescType, typename CreateFuncType>
+    RefCountPtr<PipelineType> FindOrCreate(CacheMap<PipelineType>& inCache, const PipelineDescType& inDesc, const CreateFuncType& inCreateFunc);
+
+    mutable std::mutex m_Mutex;
+    CacheMap<RHIGraphicsPipeline> m_GraphicsPipelines;
+    CacheMap<RHIComputePipeline> m_ComputePipelines;
+    RHIPipelineCacheStats m_Stats;
+    RHIPipelineManifest* m_Manifest = nullptr;
+};
\ No newline at end of file
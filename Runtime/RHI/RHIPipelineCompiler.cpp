@@ -0,0 +1,720 @@
+#include "RHIPipelineCompiler.h"
+#include <fstream>
+#include <cstring>
+#include "RHIDevice.h"
+#include "RHIStateCache.h"
+#include "RHICommandList.h"
+#include "../Core/Hash.h"
+#include "../Core/Log.h"
+
+///////////////////////////////////////////////////////////////////////////////////
+/// RHIPipelineCompileTask
+///////////////////////////////////////////////////////////////////////////////////
+RHIPipelineCompileTask::RHIPipelineCompileTask(RHIDevice& inDevice)
+    : m_Device(inDevice)
+    , m_Claimed(false)
+    , m_Status(ERHIPipelineCompileStatus::Pending)
+{
+
+}
+
+void RHIPipelineCompileTask::Wait()
+{
+    if(Execute())
+    {
+        return;
+    }
+
+    std::unique_lock lock(m_Mutex);
+    m_Finished.wait(lock, [this]() { return !IsPending(); });
+}
+
+bool RHIPipelineCompileTask::Execute()
+{
+    if(m_Claimed.exchange(true))
+    {
+        return false;
+    }
+
+    const bool succeeded = Compile();
+    m_References.clear();
+    Finish(succeeded ? ERHIPipelineCompileStatus::Ready : ERHIPipelineCompileStatus::Failed);
+    return true;
+}
+
+void RHIPipelineCompileTask::Cancel()
+{
+    if(!m_Claimed.exchange(true))
+    {
+        m_References.clear();
+        Finish(ERHIPipelineCompileStatus::Failed);
+    }
+}
+
+void RHIPipelineCompileTask::Finish(ERHIPipelineCompileStatus inStatus)
+{
+    {
+        std::lock_guard lock(m_Mutex);
+        m_Status.store(inStatus, std::memory_order_release);
+    }
+    m_Finished.notify_all();
+}
+
+RHIAsyncGraphicsPipeline::RHIAsyncGraphicsPipeline(RHIDevice& inDevice, const RHIGraphicsPipelineDesc& inDesc)
+    : RHIPipelineCompileTask(inDevice)
+    , m_Desc(inDesc)
+    , m_Pipeline(nullptr)
+{
+    RHIShader* shaders[] = {m_Desc.VertexShader, m_Desc.HullShader, m_Desc.DomainShader, m_Desc.GeometryShader
+        , m_Desc.PixelShader, m_Desc.AmplificationShader, m_Desc.MeshShader};
+    for(RHIShader* shader : shaders)
+    {
+        if(shader != nullptr)
+            m_References.emplace_back(shader);
+    }
+    if(m_Desc.BindingLayout != nullptr)
+    {
+        m_References.emplace_back(m_Desc.BindingLayout);
+    }
+
+    if(inDesc.VertexInputLayout != nullptr)
+    {
+        m_VertexInputLayout = *inDesc.VertexInputLayout;
+        m_SemanticNames.reserve(m_VertexInputLayout.Items.size());
+        for(RHIVertexInputItem& item : m_VertexInputLayout.Items)
+        {
+            m_SemanticNames.emplace_back(item.SemanticName ? item.SemanticName : "");
+            item.SemanticName = m_SemanticNames.back().c_str();
+        }
+        m_Desc.VertexInputLayout = &m_VertexInputLayout;
+    }
+}
+
+bool RHIAsyncGraphicsPipeline::Compile()
+{
+    m_Pipeline = m_Device.CreatePipeline(m_Desc);
+    return m_Pipeline.IsValid() && m_Pipeline->IsValid();
+}
+
+RHIAsyncComputePipeline::RHIAsyncComputePipeline(RHIDevice& inDevice, const RHIComputePipelineDesc& inDesc)
+    : RHIPipelineCompileTask(inDevice)
+    , m_Desc(inDesc)
+    , m_Pipeline(nullptr)
+{
+    if(m_Desc.ComputeShader != nullptr)
+    {
+        m_References.emplace_back(m_Desc.ComputeShader);
+    }
+    if(m_Desc.BindingLayout != nullptr)
+    {
+        m_References.emplace_back(m_Desc.BindingLayout);
+    }
+}
+
+bool RHIAsyncComputePipeline::Compile()
+{
+    m_Pipeline = m_Device.CreatePipeline(m_Desc);
+    return m_Pipeline.IsValid() && m_Pipeline->IsValid();
+}
+
+///////////////////////////////////////////////////////////////////////////////////
+/// RHICommandList
+///////////////////////////////////////////////////////////////////////////////////
+bool RHICommandList::SetPipelineStateOrFallback(const RefCountPtr<RHIAsyncGraphicsPipeline>& inPipelineState, const RefCountPtr<RHIGraphicsPipeline>& inFallback)
+{
+    RefCountPtr<RHIGraphicsPipeline> pipeline = inPipelineState.IsValid() ? inPipelineState->GetPipeline() : nullptr;
+    if(!pipeline.IsValid())
+    {
+        pipeline = inFallback;
+    }
+    if(!pipeline.IsValid())
+    {
+        return false;
+    }
+    SetPipelineState(pipeline);
+    return true;
+}
+
+bool RHICommandList::SetPipelineStateOrFallback(const RefCountPtr<RHIAsyncComputePipeline>& inPipelineState, const RefCountPtr<RHIComputePipeline>& inFallback)
+{
+    RefCountPtr<RHIComputePipeline> pipeline = inPipelineState.IsValid() ? inPipelineState->GetPipeline() : nullptr;
+    if(!pipeline.IsValid())
+    {
+        pipeline = inFallback;
+    }
+    if(!pipeline.IsValid())
+    {
+        return false;
+    }
+    SetPipelineState(pipeline);
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////////
+/// RHIPipelineManifest
+///////////////////////////////////////////////////////////////////////////////////
+static constexpr char s_ManifestMagic[4] = {'R', 'H', 'P', 'M'};
+static constexpr uint32_t s_ManifestVersion = 2;
+
+static_assert(std::is_trivially_copyable_v<RHIGraphicsPipelineDesc>, "The manifest stores the graphics pipeline desc as raw bytes");
+
+template<typename T>
+static void Write(std::ofstream& inFile, const T& inValue)
+{
+    static_assert(std::is_trivially_copyable_v<T>, "Only POD values can be written to the manifest");
+    inFile.write(reinterpret_cast<const char*>(&inValue), sizeof(T));
+}
+
+static void WriteString(std::ofstream& inFile, const std::string& inValue)
+{
+    Write(inFile, static_cast<uint32_t>(inValue.size()));
+    inFile.write(inValue.data(), static_cast<std::streamsize>(inValue.size()));
+}
+
+template<typename T>
+static bool Read(std::ifstream& inFile, T& outValue)
+{
+    static_assert(std::is_trivially_copyable_v<T>, "Only POD values can be read from the manifest");
+    return static_cast<bool>(inFile.read(reinterpret_cast<char*>(&outValue), sizeof(T)));
+}
+
+static bool ReadString(std::ifstream& inFile, std::string& outValue)
+{
+    uint32_t size = 0;
+    if(!Read(inFile, size) || size > (1u << 16))
+    {
+        return false;
+    }
+    outValue.resize(size);
+    return static_cast<bool>(inFile.read(outValue.data(), size));
+}
+
+static std::string GetShaderKey(ERHIShaderType inType, const std::string& inEntryName, const uint8_t* inByteCode, size_t inSize)
+{
+    const uint128 byteCodeHash = CityHash128(reinterpret_cast<const char*>(inByteCode), inSize);
+    std::string key(reinterpret_cast<const char*>(&byteCodeHash), sizeof(byteCodeHash));
+    key.push_back(static_cast<char>(inType));
+    key.append(inEntryName);
+    return key;
+}
+
+uint32_t RHIPipelineManifest::AddShader(const RHIShader* inShader)
+{
+    if(inShader == nullptr || inShader->GetSize() == 0)
+    {
+        return UINT32_MAX;
+    }
+
+    std::string key = GetShaderKey(inShader->GetType(), inShader->GetEntryName(), inShader->GetData(), inShader->GetSize());
+
+    auto iter = m_ShaderIndices.find(key);
+    if(iter != m_ShaderIndices.end())
+    {
+        return iter->second;
+    }
+
+    ShaderRecord record;
+    record.Type = inShader->GetType();
+    record.EntryName = inShader->GetEntryName();
+    record.ByteCode.assign(inShader->GetData(), inShader->GetData() + inShader->GetSize());
+    const uint32_t index = static_cast<uint32_t>(m_Shaders.size());
+    m_Shaders.emplace_back(std::move(record));
+    m_ShaderIndices.emplace(std::move(key), index);
+    return index;
+}
+
+uint32_t RHIPipelineManifest::AddBindingLayout(const RHIPipelineBindingLayout* inLayout)
+{
+    if(inLayout == nullptr)
+    {
+        return UINT32_MAX;
+    }
+
+    const RHIPipelineBindingLayoutDesc& desc = inLayout->GetDesc();
+    std::string key = RHIStateCache::GetKey(desc);
+
+    auto iter = m_BindingLayoutIndices.find(key);
+    if(iter != m_BindingLayoutIndices.end())
+    {
+        return iter->second;
+    }
+
+    const uint32_t index = static_cast<uint32_t>(m_BindingLayouts.size());
+    m_BindingLayouts.push_back(desc);
+    m_BindingLayoutIndices.emplace(std::move(key), index);
+    return index;
+}
+
+void RHIPipelineManifest::Add(const RHIGraphicsPipelineDesc& inDesc)
+{
+    std::string name = RHIPipelineCache::GetPersistentName(inDesc);
+    std::lock_guard lock(m_Mutex);
+    if(!m_PipelineNames.insert(name).second)
+    {
+        return;
+    }
+
+    PipelineRecord record;
+    record.Name = std::move(name);
+    record.IsCompute = false;
+    record.Shaders[Vertex] = AddShader(inDesc.VertexShader);
+    record.Shaders[Hull] = AddShader(inDesc.HullShader);
+    record.Shaders[Domain] = AddShader(inDesc.DomainShader);
+    record.Shaders[Geometry] = AddShader(inDesc.GeometryShader);
+    record.Shaders[Pixel] = AddShader(inDesc.PixelShader);
+    record.Shaders[Amplification] = AddShader(inDesc.AmplificationShader);
+    record.Shaders[Mesh] = AddShader(inDesc.MeshShader);
+    record.BindingLayout = AddBindingLayout(inDesc.BindingLayout);
+    record.HasVertexInput = inDesc.VertexInputLayout != nullptr;
+    if(record.HasVertexInput)
+    {
+        for(const RHIVertexInputItem& item : inDesc.VertexInputLayout->Items)
+        {
+            record.VertexInputs.push_back({item.SemanticName ? item.SemanticName : "", item.SemanticIndex, item.Format});
+        }
+    }
+
+    record.GraphicsDesc = inDesc;
+    record.GraphicsDesc.VertexShader = nullptr;
+    record.GraphicsDesc.HullShader = nullptr;
+    record.GraphicsDesc.DomainShader = nullptr;
+    record.GraphicsDesc.GeometryShader = nullptr;
+    record.GraphicsDesc.PixelShader = nullptr;
+    record.GraphicsDesc.AmplificationShader = nullptr;
+    record.GraphicsDesc.MeshShader = nullptr;
+    record.GraphicsDesc.BindingLayout = nullptr;
+    record.GraphicsDesc.VertexInputLayout = nullptr;
+
+    m_Pipelines.emplace_back(std::move(record));
+    m_Dirty = true;
+}
+
+void RHIPipelineManifest::Add(const RHIComputePipelineDesc& inDesc)
+{
+    std::string name = RHIPipelineCache::GetPersistentName(inDesc);
+    std::lock_guard lock(m_Mutex);
+    if(!m_PipelineNames.insert(name).second)
+    {
+        return;
+    }
+
+    PipelineRecord record;
+    record.Name = std::move(name);
+    record.IsCompute = true;
+    record.Shaders.fill(UINT32_MAX);
+    record.Shaders[Compute] = AddShader(inDesc.ComputeShader);
+    record.BindingLayout = AddBindingLayout(inDesc.BindingLayout);
+    m_Pipelines.emplace_back(std::move(record));
+    m_Dirty = true;
+}
+
+bool RHIPipelineManifest::Save(const std::filesystem::path& inPath) const
+{
+    std::lock_guard lock(m_Mutex);
+    std::error_code errorCode;
+    std::filesystem::create_directories(inPath.parent_path(), errorCode);
+    std::ofstream file(inPath, std::ios::binary | std::ios::trunc);
+    if(!file.is_open())
+    {
+        Log::Warning("[RHI] Failed to open %s for writing the pipeline manifest", inPath.string().c_str());
+        return false;
+    }
+
+    file.write(s_ManifestMagic, sizeof(s_ManifestMagic));
+    Write(file, s_ManifestVersion);
+    Write(file, static_cast<uint32_t>(sizeof(RHIGraphicsPipelineDesc)));
+
+    Write(file, static_cast<uint32_t>(m_Shaders.size()));
+    for(const ShaderRecord& shader : m_Shaders)
+    {
+        Write(file, shader.Type);
+        WriteString(file, shader.EntryName);
+        Write(file, static_cast<uint64_t>(shader.ByteCode.size()));
+        file.write(reinterpret_cast<const char*>(shader.ByteCode.data()), static_cast<std::streamsize>(shader.ByteCode.size()));
+    }
+
+    Write(file, static_cast<uint32_t>(m_BindingLayouts.size()));
+    for(const RHIPipelineBindingLayoutDesc& layout : m_BindingLayouts)
+    {
+        Write(file, layout.IsRayTracingLocalLayout);
+        Write(file, layout.AllowInputLayout);
+        Write(file, layout.UseBindlessTable);
+        Write(file, static_cast<uint32_t>(layout.Items.size()));
+        for(const RHIPipelineBindingItem& item : layout.Items)
+        {
+            Write(file, item.Type);
+            Write(file, item.BaseRegister);
+            Write(file, item.Space);
+            Write(file, item.NumResources);
+            Write(file, item.IsBindless);
+        }
+    }
+
+    Write(file, static_cast<uint32_t>(m_Pipelines.size()));
+    for(const PipelineRecord& pipeline : m_Pipelines)
+    {
+        WriteString(file, pipeline.Name);
+        Write(file, pipeline.IsCompute);
+        Write(file, pipeline.Shaders);
+        Write(file, pipeline.BindingLayout);
+        if(!pipeline.IsCompute)
+        {
+            Write(file, pipeline.HasVertexInput);
+            Write(file, static_cast<uint32_t>(pipeline.VertexInputs.size()));
+            for(const VertexInputRecord& input : pipeline.VertexInputs)
+            {
+                WriteString(file, input.SemanticName);
+                Write(file, input.SemanticIndex);
+                Write(file, input.Format);
+            }
+            Write(file, pipeline.GraphicsDesc);
+        }
+    }
+
+    if(!file.good())
+    {
+        Log::Warning("[RHI] Failed to write the pipeline manifest %s", inPath.string().c_str());
+        return false;
+    }
+    return true;
+}
+
+bool RHIPipelineManifest::Load(const std::filesystem::path& inPath)
+{
+    Clear();
+    std::ifstream file(inPath, std::ios::binary);
+    if(!file.is_open())
+    {
+        return false;
+    }
+
+    char magic[4];
+    uint32_t version = 0, descSize = 0;
+    if(!file.read(magic, sizeof(magic)) || memcmp(magic, s_ManifestMagic, sizeof(magic)) != 0
+        || !Read(file, version) || version != s_ManifestVersion
+        || !Read(file, descSize) || descSize != sizeof(RHIGraphicsPipelineDesc))
+    {
+        Log::Warning("[RHI] %s is not a valid pipeline manifest, discarded", inPath.string().c_str());
+        return false;
+    }
+
+    std::lock_guard lock(m_Mutex);
+    bool valid = true;
+    uint32_t count = 0;
+    valid = valid && Read(file, count);
+    for(uint32_t i = 0; valid && i < count; ++i)
+    {
+        ShaderRecord shader;
+        uint64_t size = 0;
+        valid = Read(file, shader.Type) && ReadString(file, shader.EntryName) && Read(file, size) && size < (1ull << 30);
+        if(valid)
+        {
+            shader.ByteCode.resize(size);
+            valid = static_cast<bool>(file.read(reinterpret_cast<char*>(shader.ByteCode.data()), static_cast<std::streamsize>(size)));
+        }
+        m_Shaders.emplace_back(std::move(shader));
+    }
+
+    valid = valid && Read(file, count);
+    for(uint32_t i = 0; valid && i < count; ++i)
+    {
+        RHIPipelineBindingLayoutDesc layout;
+        uint32_t numItems = 0;
+        valid = Read(file, layout.IsRayTracingLocalLayout) && Read(file, layout.AllowInputLayout) && Read(file, layout.UseBindlessTable)
+            && Read(file, numItems);
+        for(uint32_t j = 0; valid && j < numItems; ++j)
+        {
+            RHIPipelineBindingItem item(ERHIBindingResourceType::Texture_SRV, 0);
+            valid = Read(file, item.Type) && Read(file, item.BaseRegister) && Read(file, item.Space)
+                && Read(file, item.NumResources) && Read(file, item.IsBindless);
+            layout.Items.push_back(item);
+        }
+        m_BindingLayouts.emplace_back(std::move(layout));
+    }
+
+    valid = valid && Read(file, count);
+    for(uint32_t i = 0; valid && i < count; ++i)
+    {
+        PipelineRecord pipeline;
+        valid = ReadString(file, pipeline.Name) && Read(file, pipeline.IsCompute)
+            && Read(file, pipeline.Shaders) && Read(file, pipeline.BindingLayout);
+        if(valid && !pipeline.IsCompute)
+        {
+            uint32_t numInputs = 0;
+            valid = Read(file, pipeline.HasVertexInput) && Read(file, numInputs);
+            for(uint32_t j = 0; valid && j < numInputs; ++j)
+            {
+                VertexInputRecord input;
+                valid = ReadString(file, input.SemanticName) && Read(file, input.SemanticIndex) && Read(file, input.Format);
+                pipeline.VertexInputs.emplace_back(std::move(input));
+            }
+            valid = valid && Read(file, pipeline.GraphicsDesc);
+        }
+
+        for(uint32_t shader : pipeline.Shaders)
+        {
+            valid = valid && (shader == UINT32_MAX || shader < m_Shaders.size());
+        }
+        valid = valid && (pipeline.BindingLayout == UINT32_MAX || pipeline.BindingLayout < m_BindingLayouts.size());
+        if(valid)
+        {
+            m_PipelineNames.insert(pipeline.Name);
+            m_Pipelines.emplace_back(std::move(pipeline));
+        }
+    }
+
+    if(!valid)
+    {
+        Log::Warning("[RHI] The pipeline manifest %s is corrupted, discarded", inPath.string().c_str());
+        m_Shaders.clear();
+        m_BindingLayouts.clear();
+        m_Pipelines.clear();
+        m_PipelineNames.clear();
+        return false;
+    }
+
+    for(uint32_t i = 0; i < m_Shaders.size(); ++i)
+    {
+        const ShaderRecord& shader = m_Shaders[i];
+        m_ShaderIndices.emplace(GetShaderKey(shader.Type, shader.EntryName, shader.ByteCode.data(), shader.ByteCode.size()), i);
+    }
+    for(uint32_t i = 0; i < m_BindingLayouts.size(); ++i)
+    {
+        m_BindingLayoutIndices.emplace(RHIStateCache::GetKey(m_BindingLayouts[i]), i);
+    }
+    m_Dirty = false;
+    return true;
+}
+
+void RHIPipelineManifest::Clear()
+{
+    std::lock_guard lock(m_Mutex);
+    m_Shaders.clear();
+    m_BindingLayouts.clear();
+    m_Pipelines.clear();
+    m_ShaderIndices.clear();
+    m_BindingLayoutIndices.clear();
+    m_PipelineNames.clear();
+    m_Dirty = false;
+}
+
+uint32_t RHIPipelineManifest::GetNumPipelines() const
+{
+    std::lock_guard lock(m_Mutex);
+    return static_cast<uint32_t>(m_Pipelines.size());
+}
+
+bool RHIPipelineManifest::IsDirty() const
+{
+    std::lock_guard lock(m_Mutex);
+    return m_Dirty;
+}
+
+///////////////////////////////////////////////////////////////////////////////////
+/// RHIPipelineCompiler
+///////////////////////////////////////////////////////////////////////////////////
+RHIPipelineCompiler::RHIPipelineCompiler(RHIDevice& inDevice)
+    : m_Device(inDevice)
+{
+
+}
+
+RHIPipelineCompiler::~RHIPipelineCompiler()
+{
+    Shutdown();
+}
+
+RefCountPtr<RHIAsyncGraphicsPipeline> RHIPipelineCompiler::CompileAsync(const RHIGraphicsPipelineDesc& inDesc)
+{
+    RefCountPtr<RHIAsyncGraphicsPipeline> task(new RHIAsyncGraphicsPipeline(m_Device, inDesc));
+    Submit(RefCountPtr<RHIPipelineCompileTask>(task.GetReference()));
+    return task;
+}
+
+RefCountPtr<RHIAsyncComputePipeline> RHIPipelineCompiler::CompileAsync(const RHIComputePipelineDesc& inDesc)
+{
+    RefCountPtr<RHIAsyncComputePipeline> task(new RHIAsyncComputePipeline(m_Device, inDesc));
+    Submit(RefCountPtr<RHIPipelineCompileTask>(task.GetReference()));
+    return task;
+}
+
+void RHIPipelineCompiler::Submit(const RefCountPtr<RHIPipelineCompileTask>& inTask)
+{
+    {
+        std::lock_guard lock(m_Mutex);
+        if(!m_Stop)
+        {
+            if(m_Threads.empty())
+            {
+                const uint32_t numCores = std::thread::hardware_concurrency();
+                const uint32_t numThreads = numCores > 2 ? std::min(numCores - 1, 8u) : 1;
+                for(uint32_t i = 0; i < numThreads; ++i)
+                {
+                    m_Threads.emplace_back(&RHIPipelineCompiler::WorkerThread, this);
+                }
+            }
+            m_Queue.push_back(inTask);
+            m_QueueChanged.notify_one();
+            return;
+        }
+    }
+    inTask->Cancel();
+}
+
+void RHIPipelineCompiler::WorkerThread()
+{
+    while(true)
+    {
+        RefCountPtr<RHIPipelineCompileTask> task;
+        {
+            std::unique_lock lock(m_Mutex);
+            m_QueueChanged.wait(lock, [this]() { return m_Stop || !m_Queue.empty(); });
+            if(m_Stop)
+            {
+                return;
+            }
+            task = std::move(m_Queue.front());
+            m_Queue.pop_front();
+            m_NumRunning++;
+        }
+
+        task->Execute();
+        task.SafeRelease();
+
+        {
+            std::lock_guard lock(m_Mutex);
+            m_NumRunning--;
+        }
+        m_Idle.notify_all();
+    }
+}
+
+void RHIPipelineCompiler::WaitIdle()
+{
+    std::unique_lock lock(m_Mutex);
+    m_Idle.wait(lock, [this]() { return m_Queue.empty() && m_NumRunning == 0; });
+}
+
+uint32_t RHIPipelineCompiler::GetNumPending() const
+{
+    std::lock_guard lock(m_Mutex);
+    return static_cast<uint32_t>(m_Queue.size()) + m_NumRunning;
+}
+
+uint32_t RHIPipelineCompiler::WarmUp(const std::filesystem::path& inManifestPath)
+{
+    if(inManifestPath.empty())
+    {
+        return 0;
+    }
+
+    m_ManifestPath = inManifestPath;
+    m_Manifest.Load(inManifestPath);
+    m_Device.GetPipelineCache().SetManifest(&m_Manifest);
+
+    std::vector<RefCountPtr<RHIShader>> shaders(m_Manifest.m_Shaders.size());
+    std::vector<RefCountPtr<RHIPipelineBindingLayout>> layouts(m_Manifest.m_BindingLayouts.size());
+    uint32_t numQueued = 0;
+    for(const RHIPipelineManifest::PipelineRecord& record : m_Manifest.m_Pipelines)
+    {
+        std::array<RHIShader*, RHIPipelineManifest::ShaderSlotCount> recordShaders {};
+        for(uint32_t i = 0; i < RHIPipelineManifest::ShaderSlotCount; ++i)
+        {
+            const uint32_t index = record.Shaders[i];
+            if(index == UINT32_MAX)
+            {
+                continue;
+            }
+
+            if(!shaders[index].IsValid())
+            {
+                const RHIPipelineManifest::ShaderRecord& shaderRecord = m_Manifest.m_Shaders[index];
+                std::shared_ptr<Blob> byteCode = std::make_shared<Blob>();
+                byteCode->Copy(shaderRecord.ByteCode.data(), shaderRecord.ByteCode.size());
+                shaders[index] = m_Device.CreateShader(shaderRecord.Type);
+                shaders[index]->SetEntryName(shaderRecord.EntryName.c_str());
+                shaders[index]->SetByteCode(byteCode);
+            }
+            recordShaders[i] = shaders[index];
+        }
+
+        if(record.BindingLayout != UINT32_MAX && !layouts[record.BindingLayout].IsValid())
+        {
+            layouts[record.BindingLayout] = m_Device.CreatePipelineBindingLayout(m_Manifest.m_BindingLayouts[record.BindingLayout]);
+        }
+        RHIPipelineBindingLayout* layout = record.BindingLayout != UINT32_MAX ? layouts[record.BindingLayout].GetReference() : nullptr;
+
+        if(record.IsCompute)
+        {
+            RHIComputePipelineDesc desc;
+            desc.ComputeShader = recordShaders[RHIPipelineManifest::Compute];
+            desc.BindingLayout = layout;
+            CompileAsync(desc);
+        }
+        else
+        {
+            RHIVertexInputLayoutDesc vertexInputLayout;
+            for(const RHIPipelineManifest::VertexInputRecord& input : record.VertexInputs)
+            {
+                vertexInputLayout.Items.emplace_back(input.SemanticName.c_str(), input.Format, input.SemanticIndex);
+            }
+
+            RHIGraphicsPipelineDesc desc = record.GraphicsDesc;
+            desc.VertexShader = recordShaders[RHIPipelineManifest::Vertex];
+            desc.HullShader = recordShaders[RHIPipelineManifest::Hull];
+            desc.DomainShader = recordShaders[RHIPipelineManifest::Domain];
+            desc.GeometryShader = recordShaders[RHIPipelineManifest::Geometry];
+            desc.PixelShader = recordShaders[RHIPipelineManifest::Pixel];
+            desc.AmplificationShader = recordShaders[RHIPipelineManifest::Amplification];
+            desc.MeshShader = recordShaders[RHIPipelineManifest::Mesh];
+            desc.BindingLayout = layout;
+            desc.VertexInputLayout = record.HasVertexInput ? &vertexInputLayout : nullptr;
+            CompileAsync(desc);
+        }
+        numQueued++;
+    }
+
+    if(numQueued > 0)
+    {
+        Log::Info("[RHI] Warming up %u pipelines from %s", numQueued, inManifestPath.string().c_str());
+    }
+    return numQueued;
+}
+
+void RHIPipelineCompiler::Shutdown()
+{
+    std::deque<RefCountPtr<RHIPipelineCompileTask>> cancelled;
+    {
+        std::lock_guard lock(m_Mutex);
+        m_Stop = true;
+        cancelled.swap(m_Queue);
+    }
+    m_QueueChanged.notify_all();
+
+    for(std::thread& thread : m_Threads)
+    {
+        thread.join();
+    }
+    m_Threads.clear();
+
+    for(RefCountPtr<RHIPipelineCompileTask>& task : cancelled)
+    {
+        task->Cancel();
+    }
+    cancelled.clear();
+    m_Idle.notify_all();
+
+    if(!m_ManifestPath.empty())
+    {
+        m_Device.GetPipelineCache().SetManifest(nullptr);
+        if(m_Manifest.IsDirty() && m_Manifest.Save(m_ManifestPath))
+        {
+            Log::Info("[RHI] Saved %u pipelines to the manifest %s", m_Manifest.GetNumPipelines(), m_ManifestPath.string().c_str());
+        }
+        m_ManifestPath.clear();
+    }
+    m_Manifest.Clear();
+
+    std::lock_guard lock(m_Mutex);
+    m_Stop = false;
+}
\ No newline at end of file
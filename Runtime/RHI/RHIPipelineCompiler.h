@@ -0,0 +1,191 @@
+#pragma once
+
+#include "RHIPipelineState.h"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+
+class RHIDevice;
+
+enum class ERHIPipelineCompileStatus : uint8_t
+{
+    Pending,
+    Ready,
+    Failed
+};
+
+///////////////////////////////////////////////////////////////////////////////////
+/// RHIPipelineCompileTask
+///////////////////////////////////////////////////////////////////////////////////
+// A pipeline compile queued on the pipeline compiler threads, the handle is returned before the compile starts
+class RHIPipelineCompileTask : public RefCounter
+{
+public:
+    ERHIPipelineCompileStatus GetStatus() const { return m_Status.load(std::memory_order_acquire); }
+    bool IsPending() const { return GetStatus() == ERHIPipelineCompileStatus::Pending; }
+    bool IsReady() const { return GetStatus() == ERHIPipelineCompileStatus::Ready; }
+    bool IsFailed() const { return GetStatus() == ERHIPipelineCompileStatus::Failed; }
+
+    // Blocks until the compile finished, a compile no thread picked up yet runs on the calling thread
+    void Wait();
+
+protected:
+    friend class RHIPipelineCompiler;
+    explicit RHIPipelineCompileTask(RHIDevice& inDevice);
+    virtual bool Compile() = 0;
+    bool Execute();
+    void Cancel();
+    void Finish(ERHIPipelineCompileStatus inStatus);
+
+    RHIDevice& m_Device;
+    std::vector<RefCountPtr<RHIObject>> m_References; // shaders and layout of the desc, alive until the compile finished
+
+private:
+    std::atomic<bool> m_Claimed;
+    std::atomic<ERHIPipelineCompileStatus> m_Status;
+    std::mutex m_Mutex;
+    std::condition_variable m_Finished;
+};
+
+class RHIAsyncGraphicsPipeline : public RHIPipelineCompileTask
+{
+public:
+    // nullptr until the compile finished
+    RHIGraphicsPipeline* GetPipeline() const { return IsReady() ? m_Pipeline.GetReference() : nullptr; }
+    const RHIGraphicsPipelineDesc& GetDesc() const { return m_Desc; }
+
+private:
+    friend class RHIPipelineCompiler;
+    RHIAsyncGraphicsPipeline(RHIDevice& inDevice, const RHIGraphicsPipelineDesc& inDesc);
+    bool Compile() override;
+
+    RHIGraphicsPipelineDesc m_Desc;
+    RHIVertexInputLayoutDesc m_VertexInputLayout;
+    std::vector<std::string> m_SemanticNames;
+    RefCountPtr<RHIGraphicsPipeline> m_Pipeline;
+};
+
+class RHIAsyncComputePipeline : public RHIPipelineCompileTask
+{
+public:
+    // nullptr until the compile finished
+    RHIComputePipeline* GetPipeline() const { return IsReady() ? m_Pipeline.GetReference() : nullptr; }
+    const RHIComputePipelineDesc& GetDesc() const { return m_Desc; }
+
+private:
+    friend class RHIPipelineCompiler;
+    RHIAsyncComputePipeline(RHIDevice& inDevice, const RHIComputePipelineDesc& inDesc);
+    bool Compile() override;
+
+    RHIComputePipelineDesc m_Desc;
+    RefCountPtr<RHIComputePipeline> m_Pipeline;
+};
+
+///////////////////////////////////////////////////////////////////////////////////
+/// RHIPipelineManifest
+///////////////////////////////////////////////////////////////////////////////////
+// The pipeline descs created in a run, precompiled by the warm-up of the next run. Shaders are stored with their
+// byte code and binding layouts with their desc, so the manifest can recreate every pipeline on its own
+class RHIPipelineManifest
+{
+public:
+    void Add(const RHIGraphicsPipelineDesc& inDesc);
+    void Add(const RHIComputePipelineDesc& inDesc);
+    bool Load(const std::filesystem::path& inPath);
+    bool Save(const std::filesystem::path& inPath) const;
+    void Clear();
+    uint32_t GetNumPipelines() const;
+    bool IsDirty() const;
+
+private:
+    friend class RHIPipelineCompiler;
+
+    struct ShaderRecord
+    {
+        ERHIShaderType Type;
+        std::string EntryName;
+        std::vector<uint8_t> ByteCode;
+    };
+
+    struct VertexInputRecord
+    {
+        std::string SemanticName;
+        uint32_t SemanticIndex;
+        ERHIFormat Format;
+    };
+
+    enum EShaderSlot : uint32_t
+    {
+        Vertex = 0, Hull, Domain, Geometry, Pixel, Amplification, Mesh, Compute = 0,
+        ShaderSlotCount = 7
+    };
+
+    struct PipelineRecord
+    {
+        std::string Name;
+        bool IsCompute = false;
+        std::array<uint32_t, ShaderSlotCount> Shaders;
+        uint32_t BindingLayout = UINT32_MAX;
+        bool HasVertexInput = false;
+        std::vector<VertexInputRecord> VertexInputs;
+        RHIGraphicsPipelineDesc GraphicsDesc; // the object pointers are null, see Shaders and BindingLayout
+    };
+
+    uint32_t AddShader(const RHIShader* inShader);
+    uint32_t AddBindingLayout(const RHIPipelineBindingLayout* inLayout);
+
+    mutable std::mutex m_Mutex;
+    std::vector<ShaderRecord> m_Shaders;
+    std::vector<RHIPipelineBindingLayoutDesc> m_BindingLayouts;
+    std::vector<PipelineRecord> m_Pipelines;
+    std::unordered_map<std::string, uint32_t> m_ShaderIndices;
+    std::unordered_map<std::string, uint32_t> m_BindingLayoutIndices;
+    std::unordered_set<std::string> m_PipelineNames;
+    bool m_Dirty = false;
+};
+
+///////////////////////////////////////////////////////////////////////////////////
+/// RHIPipelineCompiler
+///////////////////////////////////////////////////////////////////////////////////
+// Compiles pipelines on worker threads so a new material or pass does not stall the render thread for a driver
+// compile. The compiled pipelines go through the device pipeline cache like RHIDevice::CreatePipeline. The desc
+// objects are kept alive until the compile finished, the vertex input layout is copied.
+class RHIPipelineCompiler
+{
+public:
+    explicit RHIPipelineCompiler(RHIDevice& inDevice);
+    ~RHIPipelineCompiler();
+    RHIPipelineCompiler(const RHIPipelineCompiler&) = delete;
+    RHIPipelineCompiler& operator=(const RHIPipelineCompiler&) = delete;
+
+    RefCountPtr<RHIAsyncGraphicsPipeline> CompileAsync(const RHIGraphicsPipelineDesc& inDesc);
+    RefCountPtr<RHIAsyncComputePipeline> CompileAsync(const RHIComputePipelineDesc& inDesc);
+    void WaitIdle();
+    uint32_t GetNumPending() const;
+
+    // Queues every pipeline of the manifest and records the pipelines of this run into it, returns the number queued
+    uint32_t WarmUp(const std::filesystem::path& inManifestPath);
+
+    // Cancels the queued compiles, joins the threads and saves the manifest
+    void Shutdown();
+
+private:
+    void Submit(const RefCountPtr<RHIPipelineCompileTask>& inTask);
+    void WorkerThread();
+
+    RHIDevice& m_Device;
+    mutable std::mutex m_Mutex;
+    std::condition_variable m_QueueChanged;
+    std::condition_variable m_Idle;
+    std::deque<RefCountPtr<RHIPipelineCompileTask>> m_Queue;
+    std::vector<std::thread> m_Threads;
+    uint32_t m_NumRunning = 0;
+    bool m_Stop = false;
+
+    RHIPipelineManifest m_Manifest;
+    std::filesystem::path m_ManifestPath;
+};
\ No newline at end of file
@@ -68,6 +68,7 @@ struct RHIPipelineBindingLayoutDesc
     std::vector<RHIPipelineBindingItem> Items;
     bool IsRayTracingLocalLayout = false;   // Using for d3d12
     bool AllowInputLayout = false;          // Using for d3d12
+    bool UseBindlessTable = false;          // Appends the global table of RHIBindlessTable to the layout
 };
 
 class RHIPipelineBindingLayout : public RHIObject
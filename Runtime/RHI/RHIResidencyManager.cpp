@@ -0,0 +1,381 @@
+#include "RHIResidencyManager.h"
+#include "RHIDevice.h"
+#include "RHIPipelineState.h"
+#include "../Core/Log.h"
+#include <algorithm>
+
+///////////////////////////////////////////////////////////////////////////////////
+/// RHIResidencyUsage
+///////////////////////////////////////////////////////////////////////////////////
+void RHIResidencyUsage::Add(const RHIBuffer* inBuffer)
+{
+    if(inBuffer != nullptr)
+    {
+        m_Objects.insert(GetResidencyObject(inBuffer));
+    }
+}
+
+void RHIResidencyUsage::Add(const RHITexture* inTexture)
+{
+    if(inTexture != nullptr)
+    {
+        m_Objects.insert(GetResidencyObject(inTexture));
+    }
+}
+
+void RHIResidencyUsage::Add(const RHIFrameBuffer* inFrameBuffer)
+{
+    if(inFrameBuffer == nullptr)
+    {
+        return;
+    }
+    for(uint32_t i = 0; i < inFrameBuffer->GetNumRenderTargets(); ++i)
+    {
+        Add(inFrameBuffer->GetRenderTarget(i));
+    }
+    Add(inFrameBuffer->GetDepthStencil());
+}
+
+void RHIResidencyUsage::Add(const RHIResidencyUsage& inUsage)
+{
+    m_Objects.insert(inUsage.m_Objects.begin(), inUsage.m_Objects.end());
+    for(const auto& binding : inUsage.m_Bindings)
+    {
+        m_Objects.insert(binding.second);
+    }
+}
+
+void RHIResidencyUsage::Bind(ERHIBindingResourceType inType, uint32_t inRegister, uint32_t inSpace, const RHIBuffer* inBuffer)
+{
+    Bind(inType, inRegister, inSpace, inBuffer != nullptr ? GetResidencyObject(inBuffer) : nullptr);
+}
+
+void RHIResidencyUsage::Bind(ERHIBindingResourceType inType, uint32_t inRegister, uint32_t inSpace, const RHITexture* inTexture)
+{
+    Bind(inType, inRegister, inSpace, inTexture != nullptr ? GetResidencyObject(inTexture) : nullptr);
+}
+
+void RHIResidencyUsage::Bind(ERHIBindingResourceType inType, uint32_t inRegister, uint32_t inSpace, const RHIObject* inObject)
+{
+    const uint64_t key = (static_cast<uint64_t>(inType) << 56) | (static_cast<uint64_t>(inSpace) << 32) | inRegister;
+    if(inObject != nullptr)
+    {
+        m_Bindings[key] = inObject;
+    }
+    else
+    {
+        m_Bindings.erase(key);
+    }
+}
+
+void RHIResidencyUsage::Clear()
+{
+    m_Objects.clear();
+    m_Bindings.clear();
+}
+
+const RHIObject* RHIResidencyUsage::GetResidencyObject(const RHIBuffer* inBuffer)
+{
+    const RHIResourceHeap* heap = inBuffer->GetResourceHeap();
+    return heap != nullptr ? static_cast<const RHIObject*>(heap) : inBuffer;
+}
+
+const RHIObject* RHIResidencyUsage::GetResidencyObject(const RHITexture* inTexture)
+{
+    const RHIResourceHeap* heap = inTexture->GetResourceHeap();
+    return heap != nullptr ? static_cast<const RHIObject*>(heap) : inTexture;
+}
+
+///////////////////////////////////////////////////////////////////////////////////
+/// RHIResidencyManager
+///////////////////////////////////////////////////////////////////////////////////
+RHIResidencyManager::RHIResidencyManager(RHIDevice& inDevice)
+    : m_Device(inDevice)
+{
+
+}
+
+bool RHIResidencyManager::Track(const RefCountPtr<RHIResourceHeap>& inHeap)
+{
+    if(!inHeap.IsValid() || !inHeap->IsValid())
+    {
+        return false;
+    }
+    return TrackInternal(inHeap.GetReference(), ERHIResidencyObjectType::ResourceHeap, inHeap->GetDesc().Size);
+}
+
+bool RHIResidencyManager::Track(const RefCountPtr<RHIBuffer>& inBuffer)
+{
+    if(!inBuffer.IsValid() || !inBuffer->IsValid())
+    {
+        return false;
+    }
+    if(inBuffer->IsVirtual())
+    {
+        Log::Warning("[RHI] The placed buffer %s is made resident with its heap, track the heap", inBuffer->GetName().c_str());
+        return false;
+    }
+    return TrackInternal(inBuffer.GetReference(), ERHIResidencyObjectType::Buffer, inBuffer->GetAllocSizeInByte());
+}
+
+bool RHIResidencyManager::Track(const RefCountPtr<RHITexture>& inTexture)
+{
+    if(!inTexture.IsValid() || !inTexture->IsValid())
+    {
+        return false;
+    }
+    if(inTexture->IsVirtual())
+    {
+        Log::Warning("[RHI] The placed texture %s is made resident with its heap, track the heap", inTexture->GetName().c_str());
+        return false;
+    }
+    return TrackInternal(inTexture.GetReference(), ERHIResidencyObjectType::Texture, inTexture->GetAllocSizeInByte());
+}
+
+bool RHIResidencyManager::TrackInternal(RHIObject* inObject, ERHIResidencyObjectType inType, uint64_t inSize)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    auto iter = m_Entries.find(inObject);
+    if(iter != m_Entries.end())
+    {
+        iter->second.LastUsedFrame = m_FrameNumber;
+        return true;
+    }
+
+    Entry entry;
+    entry.Object = inObject;
+    entry.Type = inType;
+    entry.Size = inSize;
+    entry.LastUsedFrame = m_FrameNumber;
+    m_Entries.emplace(inObject, std::move(entry));
+    m_Stats.TrackedBytes += inSize;
+    m_Stats.ResidentBytes += inSize;
+    return true;
+}
+
+void RHIResidencyManager::Untrack(const RHIObject* inObject)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    auto iter = m_Entries.find(inObject);
+    if(iter == m_Entries.end())
+    {
+        return;
+    }
+
+    // An evicted object has to be resident again before it is released, D3D12 does not release evicted heaps
+    Entry& entry = iter->second;
+    if(!entry.IsResident)
+    {
+        const RHIResidencyObject object{entry.Type, entry.Object};
+        m_Device.MakeObjectsResident(&object, 1);
+    }
+    else
+    {
+        m_Stats.ResidentBytes -= entry.Size;
+    }
+    m_Stats.TrackedBytes -= entry.Size;
+    m_Entries.erase(iter);
+}
+
+void RHIResidencyManager::Clear()
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    std::vector<RHIResidencyObject> evicted;
+    for(auto& pair : m_Entries)
+    {
+        if(!pair.second.IsResident)
+        {
+            evicted.push_back({pair.second.Type, pair.second.Object});
+        }
+    }
+    if(!evicted.empty())
+    {
+        m_Device.MakeObjectsResident(evicted.data(), static_cast<uint32_t>(evicted.size()));
+    }
+    m_Entries.clear();
+    m_Stats.TrackedBytes = 0;
+    m_Stats.ResidentBytes = 0;
+}
+
+bool RHIResidencyManager::MarkUsed(const RHIObject* inObject)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return MarkUsedInternal(inObject);
+}
+
+void RHIResidencyManager::MarkUsed(const RHIResidencyUsage& inUsage)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    if(m_Entries.empty())
+    {
+        return;
+    }
+    for(const RHIObject* object : inUsage.m_Objects)
+    {
+        MarkUsedInternal(object);
+    }
+    for(const auto& binding : inUsage.m_Bindings)
+    {
+        MarkUsedInternal(binding.second);
+    }
+}
+
+bool RHIResidencyManager::MarkUsedInternal(const RHIObject* inObject)
+{
+    auto iter = m_Entries.find(inObject);
+    if(iter == m_Entries.end())
+    {
+        return false;
+    }
+
+    Entry& entry = iter->second;
+    entry.LastUsedFrame = m_FrameNumber;
+    if(entry.IsResident)
+    {
+        return true;
+    }
+
+    // Makes room first, the object itself is not a candidate since it is stamped with the current frame
+    EvictInternal(entry.Size, m_CompletedFrames);
+    const RHIResidencyObject object{entry.Type, entry.Object};
+    if(!m_Device.MakeObjectsResident(&object, 1))
+    {
+        Log::Error("[RHI] Failed to make %s resident", entry.Object->GetName().c_str());
+        return false;
+    }
+    entry.IsResident = true;
+    m_Stats.ResidentBytes += entry.Size;
+    if(m_Budget.Usage > 0)
+    {
+        m_Budget.Usage += entry.Size;
+    }
+    ++m_Stats.MakeResidents;
+    m_Stats.MakeResidentBytes += entry.Size;
+    return true;
+}
+
+bool RHIResidencyManager::IsTracked(const RHIObject* inObject) const
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_Entries.find(inObject) != m_Entries.end();
+}
+
+bool RHIResidencyManager::IsResident(const RHIObject* inObject) const
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    auto iter = m_Entries.find(inObject);
+    return iter == m_Entries.end() || iter->second.IsResident;
+}
+
+void RHIResidencyManager::BeginFrame(uint64_t inFrameNumber, uint64_t inCompletedFrames)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_FrameNumber = inFrameNumber;
+    m_CompletedFrames = inCompletedFrames;
+
+    if(!m_Device.QueryMemoryBudget(m_Budget))
+    {
+        m_Budget = RHIMemoryBudget();
+    }
+    if(m_BudgetOverride > 0)
+    {
+        m_Budget.Budget = m_BudgetOverride;
+    }
+    
+    if(m_Budget.Budget > 0 && GetUsage() > m_Budget.Budget)
+    {
+        EvictInternal(0, inCompletedFrames);
+        if(GetUsage() > m_Budget.Budget)
+        {
+            ++m_Stats.OverBudgetFrames;
+        }
+    }
+}
+
+uint64_t RHIResidencyManager::GetUsage() const
+{
+    // The backend usage is from the last query, the tracked bytes are current
+    return std::max(m_Budget.Usage, m_Stats.ResidentBytes);
+}
+
+uint64_t RHIResidencyManager::EvictInternal(uint64_t inRequiredBytes, uint64_t inCompletedFrames)
+{
+    if(m_Budget.Budget == 0 || GetUsage() + inRequiredBytes <= m_Budget.Budget)
+    {
+        return 0;
+    }
+
+    std::vector<Entry*> candidates;
+    for(auto& pair : m_Entries)
+    {
+        Entry& entry = pair.second;
+        if(entry.IsResident && entry.LastUsedFrame < inCompletedFrames)
+        {
+            candidates.push_back(&entry);
+        }
+    }
+    std::sort(candidates.begin(), candidates.end(), [](const Entry* a, const Entry* b)
+    {
+        return a->LastUsedFrame < b->LastUsedFrame;
+    });
+
+    uint64_t usage = GetUsage();
+    uint64_t evictedBytes = 0;
+    std::vector<RHIResidencyObject> objects;
+    std::vector<Entry*> evicted;
+    for(Entry* entry : candidates)
+    {
+        if(usage + inRequiredBytes <= m_Budget.Budget)
+        {
+            break;
+        }
+        objects.push_back({entry->Type, entry->Object});
+        evicted.push_back(entry);
+        usage = usage > entry->Size ? usage - entry->Size : 0;
+        evictedBytes += entry->Size;
+    }
+
+    if(objects.empty())
+    {
+        return 0;
+    }
+
+    if(!m_Device.EvictObjects(objects.data(), static_cast<uint32_t>(objects.size())))
+    {
+        // The backend has no explicit residency control, the driver keeps paging on its own
+        return 0;
+    }
+
+    for(Entry* entry : evicted)
+    {
+        entry->IsResident = false;
+        m_Stats.ResidentBytes -= entry->Size;
+    }
+    // The backend usage of the last query still counts the evicted bytes
+    m_Budget.Usage = m_Budget.Usage > evictedBytes ? m_Budget.Usage - evictedBytes : 0;
+    m_Stats.Evictions += evicted.size();
+    m_Stats.EvictedBytes += evictedBytes;
+    return evictedBytes;
+}
+
+RHIMemoryBudget RHIResidencyManager::GetBudget() const
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_Budget;
+}
+
+RHIResidencyStats RHIResidencyManager::GetStats() const
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_Stats;
+}
+
+void RHIResidencyManager::ResetStats()
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Stats.Evictions = 0;
+    m_Stats.EvictedBytes = 0;
+    m_Stats.MakeResidents = 0;
+    m_Stats.MakeResidentBytes = 0;
+    m_Stats.OverBudgetFrames = 0;
+}
\ No newline at end of file
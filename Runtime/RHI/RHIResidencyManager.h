@@ -0,0 +1,130 @@
+#pragma once
+
+#include "RHIResources.h"
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+
+class RHIDevice;
+class RHIFrameBuffer;
+
+// The memory the os or driver lets the process use, the usage includes allocations the residency manager does not
+// track. Zero usage when the backend can not query it
+struct RHIMemoryBudget
+{
+    uint64_t Budget = 0;
+    uint64_t Usage = 0;
+};
+
+enum class ERHIResidencyObjectType : uint8_t
+{
+    ResourceHeap,
+    Buffer,
+    Texture
+};
+
+// A heap or committed resource handed to RHIDevice::EvictObjects and RHIDevice::MakeObjectsResident
+struct RHIResidencyObject
+{
+    ERHIResidencyObjectType Type;
+    RHIObject* Object;
+};
+
+struct RHIResidencyStats
+{
+    uint64_t TrackedBytes = 0;
+    uint64_t ResidentBytes = 0;
+    uint64_t Evictions = 0;
+    uint64_t EvictedBytes = 0;
+    uint64_t MakeResidents = 0;     // evicted objects used again
+    uint64_t MakeResidentBytes = 0;
+    uint64_t OverBudgetFrames = 0;  // frames which stayed over budget after evicting everything not in flight
+};
+
+// The heaps and committed resources used by a command list, a placed resource counts as its heap. The command lists of
+// the backends with explicit residency collect them while recording and the device stamps them at submit. A resource
+// set keeps the usage of its bindings, a rebind replaces the resource of the binding
+class RHIResidencyUsage
+{
+public:
+    void Add(const RHIBuffer* inBuffer);
+    void Add(const RHITexture* inTexture);
+    void Add(const RHIFrameBuffer* inFrameBuffer);
+    void Add(const RHIResidencyUsage& inUsage);
+    void Bind(ERHIBindingResourceType inType, uint32_t inRegister, uint32_t inSpace, const RHIBuffer* inBuffer);
+    void Bind(ERHIBindingResourceType inType, uint32_t inRegister, uint32_t inSpace, const RHITexture* inTexture);
+    void Clear();
+
+private:
+    friend class RHIResidencyManager;
+    static const RHIObject* GetResidencyObject(const RHIBuffer* inBuffer);
+    static const RHIObject* GetResidencyObject(const RHITexture* inTexture);
+    void Bind(ERHIBindingResourceType inType, uint32_t inRegister, uint32_t inSpace, const RHIObject* inObject);
+
+    // Only compared against the tracked objects, never dereferenced
+    std::unordered_set<const RHIObject*> m_Objects;
+    std::unordered_map<uint64_t, const RHIObject*> m_Bindings;
+};
+
+// Keeps the tracked heaps and committed resources within the memory budget. Every use stamps an object with the frame
+// number, BeginFrame evicts the least recently used objects the frames in flight do not reference while the usage is
+// over budget, and MarkUsed makes an evicted object resident again before it is recorded. Placed resources are
+// evicted with their heap, track the heap instead. The memory allocator tracks its device local blocks and the devices
+// with explicit residency track their device local committed resources, their command lists are stamped at submit.
+// The manager does not own the objects, a tracked object untracks itself when it is released
+class RHIResidencyManager
+{
+public:
+    explicit RHIResidencyManager(RHIDevice& inDevice);
+    RHIResidencyManager(const RHIResidencyManager&) = delete;
+    RHIResidencyManager& operator=(const RHIResidencyManager&) = delete;
+
+    bool Track(const RefCountPtr<RHIResourceHeap>& inHeap);
+    bool Track(const RefCountPtr<RHIBuffer>& inBuffer);
+    bool Track(const RefCountPtr<RHITexture>& inTexture);
+    // Called by the heaps and resources when they are released, untracked objects are ignored
+    void Untrack(const RHIObject* inObject);
+    void Clear();
+
+    // Stamps the object with the current frame, an evicted object is made resident. Untracked objects are ignored
+    bool MarkUsed(const RHIObject* inObject);
+    // Same as above for every object of the usage, called by the devices at submit
+    void MarkUsed(const RHIResidencyUsage& inUsage);
+    bool IsTracked(const RHIObject* inObject) const;
+    bool IsResident(const RHIObject* inObject) const;
+
+    // Called by RHIFrameContext::BeginFrame. The frames before inCompletedFrames finished on the gpu, so the objects
+    // they used last can be evicted
+    void BeginFrame(uint64_t inFrameNumber, uint64_t inCompletedFrames);
+
+    // Replaces the budget of the backend, 0 queries the backend again
+    void SetBudgetOverride(uint64_t inBudget) { m_BudgetOverride = inBudget; }
+    RHIMemoryBudget GetBudget() const;
+    RHIResidencyStats GetStats() const;
+    void ResetStats();
+
+private:
+    struct Entry
+    {
+        RHIObject* Object = nullptr;
+        ERHIResidencyObjectType Type;
+        uint64_t Size = 0;
+        uint64_t LastUsedFrame = 0;
+        bool IsResident = true;
+    };
+
+    bool TrackInternal(RHIObject* inObject, ERHIResidencyObjectType inType, uint64_t inSize);
+    bool MarkUsedInternal(const RHIObject* inObject);
+    uint64_t GetUsage() const;
+    // Evicts the least recently used objects until inRequiredBytes fit into the budget, returns the evicted bytes
+    uint64_t EvictInternal(uint64_t inRequiredBytes, uint64_t inCompletedFrames);
+
+    RHIDevice& m_Device;
+    mutable std::mutex m_Mutex;
+    std::unordered_map<const RHIObject*, Entry> m_Entries;
+    RHIMemoryBudget m_Budget;
+    uint64_t m_BudgetOverride = 0;
+    uint64_t m_FrameNumber = 0;
+    uint64_t m_CompletedFrames = 0;
+    RHIResidencyStats m_Stats;
+};
\ No newline at end of file
@@ -17,13 +17,25 @@ struct RHIResourceHeapDesc
     uint32_t TypeFilter = ~0u; // using for Vulkan
 };
 
+struct RHIMemoryRange
+{
+    uint64_t Offset = 0;
+    uint64_t Size = 0;
+};
+
 class RHIResourceHeap : public RHIObject
 {
 public:
     virtual const RHIResourceHeapDesc& GetDesc() const = 0;
     virtual bool IsEmpty() const = 0;
-    virtual bool TryAllocate(size_t inSize, size_t& outOffset) = 0;
+    // inAlignment must be a power of two, the resources pass their GetAllocAlignment
+    virtual bool TryAllocate(size_t inSize, size_t inAlignment, size_t& outOffset) = 0;
+    // True if TryAllocate would succeed, used to pick a heap before binding a resource
+    virtual bool CanAllocate(size_t inSize, size_t inAlignment) const = 0;
     virtual void Free(size_t inOffset, size_t inSize) = 0;
+    virtual size_t GetUsedSize() const = 0;
+    // The free ranges in offset order
+    virtual void GetFreeRanges(std::vector<RHIMemoryRange>& outRanges) const = 0;
     virtual uint32_t GetTotalChunks() const = 0;
 };
 
@@ -156,6 +168,8 @@ public:
     virtual bool IsManaged() const = 0;
     virtual bool BindMemory(RefCountPtr<RHIResourceHeap> inHeap) = 0;
     virtual size_t GetOffsetInHeap() const = 0;
+    // The heap the memory of the buffer is bound to, nullptr for committed resources
+    virtual RHIResourceHeap* GetResourceHeap() const = 0;
     virtual void* Map(uint64_t inSize, uint64_t inOffset = 0) = 0;
     virtual void  Unmap() = 0;
     virtual void  WriteData(const void* inData, uint64_t inSize, uint64_t inOffset = 0) = 0;
@@ -276,6 +290,8 @@ public:
     virtual bool IsManaged() const = 0;
     virtual bool BindMemory(RefCountPtr<RHIResourceHeap> inHeap) = 0;
     virtual size_t GetOffsetInHeap() const = 0;
+    // The heap the memory of the texture is bound to, nullptr for committed resources
+    virtual RHIResourceHeap* GetResourceHeap() const = 0;
     virtual const RHITextureDesc& GetDesc() const = 0;
     virtual uint32_t GetMemTypeFilter() const = 0; // Using for vulkan texture memory allocation, d3d12 return UINT32_MAX
     virtual size_t GetAllocSizeInByte() const = 0;
@@ -368,6 +384,19 @@ public:
 ///////////////////////////////////////////////////////////////////////////////////
 /// RHIResourcesSet
 ///////////////////////////////////////////////////////////////////////////////////
+// A 256 bytes aligned slice of a constant buffer, see RHIConstantAllocator
+struct RHIConstantAllocation
+{
+    RHIBuffer* Buffer = nullptr;
+    uint64_t Offset = 0;
+    uint64_t Size = 0;
+    uint8_t* CpuAddress = nullptr;
+    bool IsOverflow = false;    // the frame region was full, the slice has a constant buffer of its own
+
+    bool IsValid() const { return CpuAddress != nullptr; }
+};
+
+// The binds are batched, they reach the descriptors when the set is next set on a command list
 class RHIResourceSet : public RHIObject
 {
 public:
@@ -375,6 +404,9 @@ public:
     virtual void BindBufferSRV(uint32_t inRegister, uint32_t inSpace, const RefCountPtr<RHIBuffer>& inBuffer) = 0;
     virtual void BindBufferUAV(uint32_t inRegister, uint32_t inSpace, const RefCountPtr<RHIBuffer>& inBuffer) = 0;
     virtual void BindBufferCBV(uint32_t inRegister, uint32_t inSpace, const RefCountPtr<RHIBuffer>& inBuffer) = 0;
+    // Binds a root constant buffer in D3D12 and a dynamic uniform buffer offset in Vulkan, the set must be set again
+    // on the command list after rebinding it
+    virtual void BindBufferCBV(uint32_t inRegister, uint32_t inSpace, const RHIConstantAllocation& inAllocation) = 0;
     virtual void BindTextureSRV(uint32_t inRegister, uint32_t inSpace, const RefCountPtr<RHITexture>& inTexture) = 0;
     virtual void BindTextureUAV(uint32_t inRegister, uint32_t inSpace, const RefCountPtr<RHITexture>& inTexture) = 0;
     virtual void BindSampler(uint32_t inRegister, uint32_t inSpace, const RefCountPtr<RHISampler>& inSampler) = 0;
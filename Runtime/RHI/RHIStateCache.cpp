@@ -0,0 +1,153 @@
+#include "RHIStateCache.h"
+#include "../Core/Hash.h"
+
+template<typename T>
+static void AppendKey(std::string& outKey, const T& inValue)
+{
+    static_assert(std::is_trivially_copyable_v<T>, "Only POD values can be appended to a state key");
+    outKey.append(reinterpret_cast<const char*>(&inValue), sizeof(T));
+}
+
+std::string RHIStateCache::GetKey(const RHIPipelineBindingLayoutDesc& inDesc)
+{
+    std::string key;
+    AppendKey(key, static_cast<uint32_t>(inDesc.Items.size()));
+    for(const RHIPipelineBindingItem& item : inDesc.Items)
+    {
+        AppendKey(key, item.Type);
+        AppendKey(key, item.BaseRegister);
+        AppendKey(key, item.Space);
+        AppendKey(key, item.NumResources);
+        AppendKey(key, item.IsBindless);
+    }
+    AppendKey(key, inDesc.IsRayTracingLocalLayout);
+    AppendKey(key, inDesc.AllowInputLayout);
+    AppendKey(key, inDesc.UseBindlessTable);
+    return key;
+}
+
+std::string RHIStateCache::GetKey(const RHISamplerDesc& inDesc)
+{
+    std::string key;
+    for(float color : inDesc.BorderColor)
+    {
+        AppendKey(key, color);
+    }
+    AppendKey(key, inDesc.MaxAnisotropy);
+    AppendKey(key, inDesc.MipBias);
+    AppendKey(key, inDesc.MinFilter);
+    AppendKey(key, inDesc.MagFilter);
+    AppendKey(key, inDesc.MipFilter);
+    AppendKey(key, inDesc.AddressU);
+    AppendKey(key, inDesc.AddressV);
+    AppendKey(key, inDesc.AddressW);
+    AppendKey(key, inDesc.ReductionType);
+    return key;
+}
+
+RHIStateCache::~RHIStateCache()
+{
+    Clear();
+}
+
+template<typename ObjectType, typename DescType, typename CreateFuncType>
+RefCountPtr<ObjectType> RHIStateCache::FindOrCreate(CacheMap<ObjectType>& inCache, const DescType& inDesc, const CreateFuncType& inCreateFunc)
+{
+    std::string key = GetKey(inDesc);
+    const uint64_t hash = CityHash64(key.data(), key.size());
+
+    // Layouts and samplers are cheap to create, creating under the lock guarantees a single object per desc
+    std::lock_guard lock(m_Mutex);
+    std::vector<CacheEntry<ObjectType>>& entries = inCache[hash];
+    for(CacheEntry<ObjectType>& entry : entries)
+    {
+        if(entry.Key == key)
+        {
+            m_Stats.Hits++;
+            return entry.Object;
+        }
+    }
+
+    m_Stats.Misses++;
+    RefCountPtr<ObjectType> object = inCreateFunc(inDesc);
+    if(object.IsValid() && object->IsValid())
+    {
+        CacheEntry<ObjectType> entry;
+        entry.Key = std::move(key);
+        entry.Object = object;
+        entries.emplace_back(std::move(entry));
+    }
+    else if(entries.empty())
+    {
+        inCache.erase(hash);
+    }
+    return object;
+}
+
+RefCountPtr<RHIPipelineBindingLayout> RHIStateCache::FindOrCreate(const RHIPipelineBindingLayoutDesc& inDesc, const BindingLayoutCreateFunc& inCreateFunc)
+{
+    return FindOrCreate(m_BindingLayouts, inDesc, inCreateFunc);
+}
+
+RefCountPtr<RHISampler> RHIStateCache::FindOrCreate(const RHISamplerDesc& inDesc, const SamplerCreateFunc& inCreateFunc)
+{
+    return FindOrCreate(m_Samplers, inDesc, inCreateFunc);
+}
+
+template<typename ObjectType>
+uint32_t RHIStateCache::ReleaseUnused(CacheMap<ObjectType>& inCache)
+{
+    // Only handed out under the cache lock, an object referenced by the cache alone cannot gain a reference meanwhile
+    uint32_t numReleased = 0;
+    for(auto iter = inCache.begin(); iter != inCache.end();)
+    {
+        std::vector<CacheEntry<ObjectType>>& entries = iter->second;
+        for(size_t i = 0; i < entries.size();)
+        {
+            if(entries[i].Object.GetRefCount() == 1)
+            {
+                entries[i] = std::move(entries.back());
+                entries.pop_back();
+                numReleased++;
+            }
+            else
+            {
+                ++i;
+            }
+        }
+        iter = entries.empty() ? inCache.erase(iter) : std::next(iter);
+    }
+    return numReleased;
+}
+
+uint32_t RHIStateCache::ReleaseUnused()
+{
+    std::lock_guard lock(m_Mutex);
+    return ReleaseUnused(m_BindingLayouts) + ReleaseUnused(m_Samplers);
+}
+
+void RHIStateCache::Clear()
+{
+    std::lock_guard lock(m_Mutex);
+    m_BindingLayouts.clear();
+    m_Samplers.clear();
+}
+
+RHIStateCacheStats RHIStateCache::GetStats() const
+{
+    std::lock_guard lock(m_Mutex);
+    RHIStateCacheStats stats = m_Stats;
+    stats.NumBindingLayouts = 0;
+    stats.NumSamplers = 0;
+    for(const auto& entries : m_BindingLayouts)
+        stats.NumBindingLayouts += static_cast<uint32_t>(entries.second.size());
+    for(const auto& entries : m_Samplers)
+        stats.NumSamplers += static_cast<uint32_t>(entries.second.size());
+    return stats;
+}
+
+void RHIStateCache::ResetStats()
+{
+    std::lock_guard lock(m_Mutex);
+    m_Stats = RHIStateCacheStats();
+}
\ No newline at end of file
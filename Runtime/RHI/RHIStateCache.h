@@ -0,0 +1,62 @@
+#pragma once
+
+#include "RHIPipelineState.h"
+#include "RHIResources.h"
+#include <functional>
+#include <mutex>
+
+struct RHIStateCacheStats
+{
+    uint64_t Hits = 0;
+    uint64_t Misses = 0;
+    uint32_t NumBindingLayouts = 0;
+    uint32_t NumSamplers = 0;
+};
+
+// Deduplicates binding layouts and samplers by the content of their desc. Identical layouts share one root signature
+// or descriptor set layout, so two pipelines are layout compatible if their layouts are the same pointer. Identical
+// samplers share one descriptor of the sampler heap. The shared objects must not be shut down by their users.
+class RHIStateCache
+{
+public:
+    typedef std::function<RefCountPtr<RHIPipelineBindingLayout>(const RHIPipelineBindingLayoutDesc&)> BindingLayoutCreateFunc;
+    typedef std::function<RefCountPtr<RHISampler>(const RHISamplerDesc&)> SamplerCreateFunc;
+
+    RHIStateCache() = default;
+    ~RHIStateCache();
+    RHIStateCache(const RHIStateCache&) = delete;
+    RHIStateCache& operator=(const RHIStateCache&) = delete;
+
+    RefCountPtr<RHIPipelineBindingLayout> FindOrCreate(const RHIPipelineBindingLayoutDesc& inDesc, const BindingLayoutCreateFunc& inCreateFunc);
+    RefCountPtr<RHISampler> FindOrCreate(const RHISamplerDesc& inDesc, const SamplerCreateFunc& inCreateFunc);
+    // Releases the objects nobody but the cache references anymore, returns how many were released
+    uint32_t ReleaseUnused();
+    void Clear();
+    RHIStateCacheStats GetStats() const;
+    void ResetStats();
+
+    static std::string GetKey(const RHIPipelineBindingLayoutDesc& inDesc);
+    static std::string GetKey(const RHISamplerDesc& inDesc);
+
+private:
+    template<typename ObjectType>
+    struct CacheEntry
+    {
+        std::string Key;
+        RefCountPtr<ObjectType> Object;
+    };
+
+    template<typename ObjectType>
+    using CacheMap = std::unordered_map<uint64_t, std::vector<CacheEntry<ObjectType>>>;
+
+    template<typename ObjectType, typename DescType, typename CreateFuncType>
+    RefCountPtr<ObjectType> FindOrCreate(CacheMap<ObjectType>& inCache, const DescType& inDesc, const CreateFuncType& inCreateFunc);
+
+    template<typename ObjectType>
+    static uint32_t ReleaseUnused(CacheMap<ObjectType>& inCache);
+
+    mutable std::mutex m_Mutex;
+    CacheMap<RHIPipelineBindingLayout> m_BindingLayouts;
+    CacheMap<RHISampler> m_Samplers;
+    RHIStateCacheStats m_Stats;
+};
\ No newline at end of file
@@ -0,0 +1,339 @@
+#include "RHIUploadRing.h"
+#include <cstring>
+#include "RHIDevice.h"
+#include "RHICommandList.h"
+#include "../Core/Templates.h"
+#include "../Core/Log.h"
+
+RHIUploadRing::RHIUploadRing(RHIDevice& inDevice)
+    : m_Device(inDevice)
+{
+
+}
+
+RHIUploadRing::~RHIUploadRing()
+{
+    Shutdown();
+}
+
+bool RHIUploadRing::Init(uint64_t inSize)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    if(IsValid())
+    {
+        Log::Warning("[RHI] Upload ring already initialized");
+        return true;
+    }
+    return InitInternal(inSize);
+}
+
+bool RHIUploadRing::InitInternal(uint64_t inSize)
+{
+    // Every offset the ring wraps to must satisfy the largest alignment
+    const uint64_t capacity = Align(std::max<uint64_t>(inSize, s_TextureAlignment), s_TextureAlignment);
+    RefCountPtr<RHIBuffer> buffer = m_Device.CreateBuffer(RHIBufferDesc::StagingBuffer(capacity));
+    if(!buffer.IsValid() || !buffer->IsValid())
+    {
+        Log::Error("[RHI] Failed to create the upload ring of %llu bytes", capacity);
+        return false;
+    }
+    buffer->SetName("UploadRing");
+
+    // Mapped until shutdown, the map calls of the backends are ref counted so WriteData does not unmap it either
+    m_CpuAddress = static_cast<uint8_t*>(buffer->Map(capacity, 0));
+    if(m_CpuAddress == nullptr)
+    {
+        Log::Error("[RHI] Failed to map the upload ring");
+        return false;
+    }
+    
+    m_Buffer = buffer;
+    m_Capacity = capacity;
+    m_Head = 0;
+    m_Tail = 0;
+    m_Stats.Capacity = capacity;
+    return true;
+}
+
+void RHIUploadRing::Shutdown()
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    RetireInternal(true);
+    for(RefCountPtr<RHIBuffer>& buffer : m_PendingOverflowBuffers)
+    {
+        buffer->Unmap();
+    }
+    m_PendingOverflowBuffers.clear();
+    
+    if(m_Buffer.IsValid())
+    {
+        m_Buffer->Unmap();
+        m_Buffer.SafeRelease();
+    }
+    m_CpuAddress = nullptr;
+    m_Capacity = 0;
+    m_Head = 0;
+    m_Tail = 0;
+}
+
+RHIUploadAllocation RHIUploadRing::Allocate(uint64_t inSize, uint64_t inAlignment)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    RHIUploadAllocation allocation;
+    if(!IsValid() && !InitInternal(s_DefaultSize))
+    {
+        return allocation;
+    }
+    
+    inAlignment = std::max<uint64_t>(inAlignment, 1);
+    if(inSize == 0 || inAlignment > s_TextureAlignment)
+    {
+        Log::Error("[RHI] Invalid upload ring allocation of %llu bytes aligned to %llu", inSize, inAlignment);
+        return allocation;
+    }
+
+    ++m_Stats.Allocations;
+    m_Stats.AllocatedBytes += inSize;
+    
+    if(inSize <= m_Capacity)
+    {
+        // Retires the oldest submits until the range is free, waits for their fence if the gpu did not reach it yet.
+        // The ranges of the current submit can not be waited on
+        while(!TryAllocate(inSize, inAlignment, allocation) && !m_Submitted.empty())
+        {
+            SubmittedRange& oldest = m_Submitted.front();
+            if(!oldest.IsCompleted())
+            {
+                ++m_Stats.Stalls;
+                oldest.Wait();
+            }
+            RetireInternal(false);
+        }
+
+        if(allocation.IsValid())
+        {
+            return allocation;
+        }
+    }
+
+    // Larger than the ring or the current submit filled it, falls back to a staging buffer retired with the submit
+    RefCountPtr<RHIBuffer> buffer = m_Device.CreateBuffer(RHIBufferDesc::StagingBuffer(inSize));
+    if(!buffer.IsValid() || !buffer->IsValid())
+    {
+        Log::Error("[RHI] Failed to create a staging buffer of %llu bytes", inSize);
+        return allocation;
+    }
+    
+    ++m_Stats.Overflows;
+    allocation.Buffer = buffer.GetReference();
+    allocation.Offset = 0;
+    allocation.Size = inSize;
+    allocation.CpuAddress = static_cast<uint8_t*>(buffer->Map(inSize, 0));
+    m_PendingOverflowBuffers.push_back(buffer);
+    return allocation;
+}
+
+bool RHIUploadRing::TryAllocate(uint64_t inSize, uint64_t inAlignment, RHIUploadAllocation& outAllocation)
+{
+    const uint64_t offset = m_Head % m_Capacity;
+    uint64_t alignedOffset = Align(offset, inAlignment);
+    if(alignedOffset + inSize > m_Capacity)
+    {
+        // Skips the end of the buffer, offset 0 satisfies every alignment
+        alignedOffset = m_Capacity;
+    }
+    
+    const uint64_t newHead = m_Head + (alignedOffset - offset) + inSize;
+    if(newHead - m_Tail > m_Capacity)
+    {
+        return false;
+    }
+
+    alignedOffset %= m_Capacity;
+    m_Head = newHead;
+    m_Stats.UsedBytes = m_Head - m_Tail;
+    
+    outAllocation.Buffer = m_Buffer.GetReference();
+    outAllocation.Offset = alignedOffset;
+    outAllocation.Size = inSize;
+    outAllocation.CpuAddress = m_CpuAddress + alignedOffset;
+    return true;
+}
+
+bool RHIUploadRing::UploadBuffer(RHICommandList* inCmdList, RefCountPtr<RHIBuffer>& inDstBuffer, uint64_t inDstOffset, const void* inData, uint64_t inSize)
+{
+    if(inSize == 0)
+    {
+        return true;
+    }
+
+    if(inCmdList == nullptr || !inDstBuffer.IsValid() || inData == nullptr)
+    {
+        Log::Error("[RHI] Failed to upload the buffer, the arguments are invalid");
+        return false;
+    }
+    
+    RHIUploadAllocation allocation = Allocate(inSize);
+    if(!allocation.IsValid())
+    {
+        return false;
+    }
+
+    memcpy(allocation.CpuAddress, inData, inSize);
+    RefCountPtr<RHIBuffer> srcBuffer = allocation.Buffer;
+    inCmdList->CopyBuffer(inDstBuffer, inDstOffset, srcBuffer, allocation.Offset, inSize);
+    return true;
+}
+
+bool RHIUploadRing::UploadTexture(RHICommandList* inCmdList, RefCountPtr<RHITexture>& inDstTexture, const RHITextureSlice& inDstSlice, const void* inData, uint64_t inRowPitch)
+{
+    if(inCmdList == nullptr || !inDstTexture.IsValid() || inData == nullptr)
+    {
+        Log::Error("[RHI] Failed to upload the texture, the arguments are invalid");
+        return false;
+    }
+
+    const RHIFormatInfo& formatInfo = RHI::GetFormatInfo(inDstTexture->GetDesc().Format);
+    const uint32_t blockSize = std::max<uint32_t>(1, formatInfo.BlockSize);
+    const uint64_t rowSize = static_cast<uint64_t>((inDstSlice.Width + blockSize - 1) / blockSize) * formatInfo.BytesPerBlock;
+    const uint64_t numRows = static_cast<uint64_t>((inDstSlice.Height + blockSize - 1) / blockSize) * inDstSlice.Depth;
+    const uint64_t srcRowPitch = inRowPitch == 0 ? rowSize : inRowPitch;
+    // The copy reads the rows at the pitch alignment of the device, e.g. 256 bytes on D3D12
+    const uint64_t dstRowPitch = Align<uint64_t>(rowSize, m_Device.GetTextureDataPitchAlignment());
+    if(rowSize == 0 || numRows == 0)
+    {
+        return true;
+    }
+    
+    RHIUploadAllocation allocation = Allocate(dstRowPitch * numRows, s_TextureAlignment);
+    if(!allocation.IsValid())
+    {
+        return false;
+    }
+
+    const uint8_t* src = static_cast<const uint8_t*>(inData);
+    if(srcRowPitch == rowSize && dstRowPitch == rowSize)
+    {
+        memcpy(allocation.CpuAddress, src, rowSize * numRows);
+    }
+    else
+    {
+        for(uint64_t row = 0; row < numRows; ++row)
+        {
+            memcpy(allocation.CpuAddress + row * dstRowPitch, src + row * srcRowPitch, rowSize);
+        }
+    }
+    
+    RefCountPtr<RHIBuffer> srcBuffer = allocation.Buffer;
+    inCmdList->CopyBufferToTexture(inDstTexture, inDstSlice, srcBuffer, allocation.Offset);
+    return true;
+}
+
+bool RHIUploadRing::UploadTexture(RHICommandList* inCmdList, RefCountPtr<RHITexture>& inDstTexture, const void* inData, uint64_t inRowPitch)
+{
+    if(!inDstTexture.IsValid())
+    {
+        Log::Error("[RHI] Failed to upload the texture, the texture is invalid");
+        return false;
+    }
+    
+    const RHITextureSlice slice(inDstTexture->GetDesc());
+    return UploadTexture(inCmdList, inDstTexture, slice, inData, inRowPitch);
+}
+
+void RHIUploadRing::Submit(const RefCountPtr<RHIFence>& inFence)
+{
+    SubmittedRange range;
+    range.Fence = inFence;
+    SubmitInternal(range);
+}
+
+void RHIUploadRing::Submit(const RefCountPtr<RHITimelineFence>& inFence, uint64_t inValue)
+{
+    SubmittedRange range;
+    range.TimelineFence = inFence;
+    range.FenceValue = inValue;
+    SubmitInternal(range);
+}
+
+void RHIUploadRing::SubmitInternal(SubmittedRange& inRange)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    const uint64_t lastEnd = m_Submitted.empty() ? m_Tail : m_Submitted.back().End;
+    if(m_Head == lastEnd && m_PendingOverflowBuffers.empty())
+    {
+        RetireInternal(false);
+        return;
+    }
+
+    inRange.End = m_Head;
+    inRange.OverflowBuffers.swap(m_PendingOverflowBuffers);
+    m_Submitted.push_back(std::move(inRange));
+    RetireInternal(false);
+}
+
+void RHIUploadRing::Retire()
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    RetireInternal(false);
+}
+
+void RHIUploadRing::RetireInternal(bool inWait)
+{
+    while(!m_Submitted.empty())
+    {
+        SubmittedRange& range = m_Submitted.front();
+        if(!range.IsCompleted())
+        {
+            if(!inWait)
+            {
+                break;
+            }
+            range.Wait();
+        }
+
+        for(RefCountPtr<RHIBuffer>& buffer : range.OverflowBuffers)
+        {
+            buffer->Unmap();
+        }
+        m_Tail = range.End;
+        m_Submitted.pop_front();
+    }
+    m_Stats.UsedBytes = m_Head - m_Tail;
+}
+
+bool RHIUploadRing::SubmittedRange::IsCompleted() const
+{
+    if(TimelineFence.IsValid())
+    {
+        return TimelineFence->IsCompleted(FenceValue);
+    }
+    return !Fence.IsValid() || Fence->IsCompleted();
+}
+
+void RHIUploadRing::SubmittedRange::Wait() const
+{
+    if(TimelineFence.IsValid())
+    {
+        TimelineFence->Wait(FenceValue);
+    }
+    else if(Fence.IsValid())
+    {
+        Fence->CpuWait();
+    }
+}
+
+RHIUploadRingStats RHIUploadRing::GetStats() const
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_Stats;
+}
+
+void RHIUploadRing::ResetStats()
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Stats.Allocations = 0;
+    m_Stats.AllocatedBytes = 0;
+    m_Stats.Stalls = 0;
+    m_Stats.Overflows = 0;
+}
\ No newline at end of file
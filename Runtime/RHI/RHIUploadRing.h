@@ -0,0 +1,100 @@
+#pragma once
+
+#include "RHIResources.h"
+#include <deque>
+#include <mutex>
+
+class RHIDevice;
+class RHIFence;
+class RHITimelineFence;
+class RHICommandList;
+
+// A range of the upload ring, the cpu address stays valid until the fence of the submit retires the range
+struct RHIUploadAllocation
+{
+    RHIBuffer* Buffer = nullptr;
+    uint64_t Offset = 0;
+    uint64_t Size = 0;
+    uint8_t* CpuAddress = nullptr;
+
+    bool IsValid() const { return CpuAddress != nullptr; }
+};
+
+struct RHIUploadRingStats
+{
+    uint64_t Allocations = 0;
+    uint64_t AllocatedBytes = 0;
+    uint64_t Stalls = 0;            // allocations which waited for the gpu to retire a submit
+    uint64_t Overflows = 0;         // allocations which did not fit and got their own staging buffer
+    uint64_t UsedBytes = 0;         // allocated and not retired yet
+    uint64_t Capacity = 0;
+};
+
+// A persistently mapped upload buffer shared by every upload of the device. Allocations are sub-allocated from the
+// head and retired in submit order once the fence passed to Submit is signaled, so steady state frames do not create
+// staging buffers. Copy commands reference the ring buffer at the offset of the allocation.
+class RHIUploadRing
+{
+public:
+    static constexpr uint64_t s_DefaultSize = 32ull * 1024 * 1024;
+    static constexpr uint64_t s_TextureAlignment = 512; // D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT
+
+    explicit RHIUploadRing(RHIDevice& inDevice);
+    ~RHIUploadRing();
+    RHIUploadRing(const RHIUploadRing&) = delete;
+    RHIUploadRing& operator=(const RHIUploadRing&) = delete;
+
+    // Called by the first allocation with the default size, call it before to size the ring yourself
+    bool Init(uint64_t inSize = s_DefaultSize);
+    // Waits for the submitted uploads and releases the ring buffer
+    void Shutdown();
+    bool IsValid() const { return m_Buffer.IsValid(); }
+
+    RHIUploadAllocation Allocate(uint64_t inSize, uint64_t inAlignment = 16);
+
+    // Copies the data into the ring and records the copy into inCmdList
+    bool UploadBuffer(RHICommandList* inCmdList, RefCountPtr<RHIBuffer>& inDstBuffer, uint64_t inDstOffset, const void* inData, uint64_t inSize);
+    // inRowPitch is the pitch of inData, 0 for tightly packed rows. The rows are placed at the pitch alignment of the device in the ring
+    bool UploadTexture(RHICommandList* inCmdList, RefCountPtr<RHITexture>& inDstTexture, const RHITextureSlice& inDstSlice, const void* inData, uint64_t inRowPitch = 0);
+    bool UploadTexture(RHICommandList* inCmdList, RefCountPtr<RHITexture>& inDstTexture, const void* inData, uint64_t inRowPitch = 0);
+
+    // The allocations since the last submit are reused once inFence is signaled, pass the fence which is signaled
+    // after the command lists using them, e.g. the one passed to RHIDevice::ExecuteCommandList
+    void Submit(const RefCountPtr<RHIFence>& inFence);
+    // Same as above, the allocations are reused once inFence reached inValue
+    void Submit(const RefCountPtr<RHITimelineFence>& inFence, uint64_t inValue);
+    // Reclaims the ranges of the submits whose fence is signaled, does not block
+    void Retire();
+
+    RHIUploadRingStats GetStats() const;
+    void ResetStats();
+
+private:
+    struct SubmittedRange
+    {
+        RefCountPtr<RHIFence> Fence;
+        RefCountPtr<RHITimelineFence> TimelineFence;
+        uint64_t FenceValue = 0;
+        uint64_t End;
+        std::vector<RefCountPtr<RHIBuffer>> OverflowBuffers;
+
+        bool IsCompleted() const;
+        void Wait() const;
+    };
+
+    bool InitInternal(uint64_t inSize);
+    bool TryAllocate(uint64_t inSize, uint64_t inAlignment, RHIUploadAllocation& outAllocation);
+    void SubmitInternal(SubmittedRange& inRange);
+    void RetireInternal(bool inWait);
+
+    RHIDevice& m_Device;
+    mutable std::mutex m_Mutex;
+    RefCountPtr<RHIBuffer> m_Buffer;
+    uint8_t* m_CpuAddress = nullptr;
+    uint64_t m_Capacity = 0;
+    uint64_t m_Head = 0;            // total bytes allocated, the ring offset is m_Head % m_Capacity
+    uint64_t m_Tail = 0;            // total bytes retired
+    std::deque<SubmittedRange> m_Submitted;
+    std::vector<RefCountPtr<RHIBuffer>> m_PendingOverflowBuffers;
+    RHIUploadRingStats m_Stats;
+};
\ No newline at end of file
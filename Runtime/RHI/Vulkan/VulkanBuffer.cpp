@@ -184,7 +184,7 @@ bool VulkanBuffer::BindMemory(RefCountPtr<RHIResourceHeap> inHeap)
         }
     }
 
-    if(!inHeap->TryAllocate(GetAllocSizeInByte(), m_OffsetInHeap))
+    if(!inHeap->TryAllocate(GetAllocSizeInByte(), GetAllocAlignment(), m_OffsetInHeap))
     {
         Log::Error("[Vulkan] Failed to bind buffer memory, the heap size is not enough");
         return false;
@@ -2,8 +2,10 @@
 #include "VulkanDevice.h"
 #include "VulkanResources.h"
 #include "VulkanPipelineState.h"
+#include "VulkanDescriptorAllocator.h"
 #include "../../Core/Log.h"
 #include "../../Core/Templates.h"
+#include <algorithm>
 
 RefCountPtr<RHICommandList> VulkanDevice::CreateCommandList(ERHICommandQueueType inType)
 {
@@ -21,6 +23,7 @@ VulkanCommandList::VulkanCommandList(VulkanDevice& inDevice, ERHICommandQueueTyp
     , m_CmdPoolHandle(VK_NULL_HANDLE)
     , m_CmdBufferHandle(VK_NULL_HANDLE)
     , m_IsClosed(true)
+    , m_TransientPool(nullptr)
 {
     
 }
@@ -86,6 +89,7 @@ void VulkanCommandList::Begin()
 {
     if (IsValid() && IsClosed())
     {
+        ReleaseTransientPools();
         vkResetCommandPool(m_Device.GetDevice(), m_CmdPoolHandle, 0);
         vkResetCommandBuffer(m_CmdBufferHandle, 0);
         VkCommandBufferBeginInfo beginInfo{};
@@ -117,9 +121,8 @@ void VulkanCommandList::SetPipelineState(const RefCountPtr<RHIComputePipeline>&
         }
         const VulkanComputePipeline* pipeline = CheckCast<VulkanComputePipeline*>(inPipelineState.GetReference());
         VulkanPipelineBindingLayout* bindingLayout = CheckCast<VulkanPipelineBindingLayout*>(inPipelineState->GetDesc().BindingLayout);
-        m_Context.pipelineLayout = bindingLayout->GetPipelineLayout();
         vkCmdBindPipeline(m_CmdBufferHandle, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline->GetPipeline());
-        m_Context.bindPoint = VK_PIPELINE_BIND_POINT_COMPUTE;
+        SetPipelineLayout(bindingLayout, VK_PIPELINE_BIND_POINT_COMPUTE);
     }
 }
 
@@ -134,10 +137,23 @@ void VulkanCommandList::SetPipelineState(const RefCountPtr<RHIGraphicsPipeline>&
 
         const VulkanGraphicsPipeline* pipeline = CheckCast<VulkanGraphicsPipeline*>(inPipelineState.GetReference());
         const VulkanPipelineBindingLayout* bindingLayout = CheckCast<VulkanPipelineBindingLayout*>(inPipelineState->GetDesc().BindingLayout);
-        m_Context.pipelineLayout = bindingLayout->GetPipelineLayout();
         m_Context.renderPass = pipeline->GetRenderPass();
         m_Context.pipelineState = pipeline->GetPipeline();
-        m_Context.bindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+        SetPipelineLayout(bindingLayout, VK_PIPELINE_BIND_POINT_GRAPHICS);
+    }
+}
+
+void VulkanCommandList::SetPipelineLayout(const VulkanPipelineBindingLayout* inBindingLayout, VkPipelineBindPoint inBindPoint)
+{
+    m_Context.pipelineLayout = inBindingLayout->GetPipelineLayout();
+    m_Context.bindPoint = inBindPoint;
+    m_Context.pushConstantsSize = inBindingLayout->GetPushConstantsSize();
+
+    // The bindless set stays bound while the following layouts are compatible up to it
+    if(inBindingLayout->UsesBindlessTable())
+    {
+        VkDescriptorSet bindlessSet = m_Device.GetBindlessDescriptorSet();
+        vkCmdBindDescriptorSets(m_CmdBufferHandle, inBindPoint, m_Context.pipelineLayout, inBindingLayout->GetDescriptorSetLayoutCount(), 1, &bindlessSet, 0, nullptr);
     }
 }
 
@@ -500,6 +516,24 @@ void VulkanCommandList::DrawIndexedIndirect(RefCountPtr<RHIBuffer>& indirectComm
     }
 }
 
+void VulkanCommandList::DrawIndexedIndirectCount(RefCountPtr<RHIBuffer>& indirectCommands, RefCountPtr<RHIBuffer>& countBuffer, uint32_t maxDrawCount, size_t commandsBufferOffset, size_t countBufferOffset)
+{
+    if(IsValid() && !IsClosed())
+    {
+        if(!m_Device.SupportDrawIndirectCount())
+        {
+            Log::Error("[Vulkan] The device does not support draw indirect count");
+            return;
+        }
+        VulkanBuffer* buffer = CheckCast<VulkanBuffer*>(indirectCommands.GetReference());
+        VulkanBuffer* counts = CheckCast<VulkanBuffer*>(countBuffer.GetReference());
+        if(buffer && buffer->IsValid() && counts && counts->IsValid())
+        {
+            vkCmdDrawIndexedIndirectCount(m_CmdBufferHandle, buffer->GetBuffer(), commandsBufferOffset, counts->GetBuffer(), countBufferOffset, maxDrawCount, sizeof(RHIDrawIndexedArguments));
+        }
+    }
+}
+
 void VulkanCommandList::Dispatch(uint32_t threadGroupX, uint32_t threadGroupY, uint32_t threadGroupZ)
 {
     if(IsValid() && !IsClosed())
@@ -539,6 +573,24 @@ void VulkanCommandList::DispatchMeshIndirect(RefCountPtr<RHIBuffer>& indirectCom
     }
 }
 
+void VulkanCommandList::DispatchMeshIndirectCount(RefCountPtr<RHIBuffer>& indirectCommands, RefCountPtr<RHIBuffer>& countBuffer, uint32_t maxCount, size_t commandsBufferOffset, size_t countBufferOffset)
+{
+    if(IsValid() && !IsClosed())
+    {
+        if(!m_Device.SupportMeshShading() || !m_Device.SupportDrawIndirectCount())
+        {
+            Log::Error("[Vulkan] The device does not support mesh shading with draw indirect count");
+            return;
+        }
+        VulkanBuffer* buffer = CheckCast<VulkanBuffer*>(indirectCommands.GetReference());
+        VulkanBuffer* counts = CheckCast<VulkanBuffer*>(countBuffer.GetReference());
+        if(buffer && buffer->IsValid() && counts && counts->IsValid())
+        {
+            m_Device.vkCmdDrawMeshTasksIndirectCountEXT(m_CmdBufferHandle, buffer->GetBuffer(), commandsBufferOffset, counts->GetBuffer(), countBufferOffset, maxCount, sizeof(RHIDispatchArguments));
+        }
+    }
+}
+
 void VulkanCommandList::DispatchRays(uint32_t width, uint32_t height, uint32_t depth, const RHIShaderTable& shaderTable)
 {
     if(IsValid() && !IsClosed())
@@ -599,6 +651,11 @@ void VulkanCommandList::SetIndexBuffer(const RefCountPtr<RHIBuffer>& inBuffer, s
 }
 
 void VulkanCommandList::ResourceBarrier(RefCountPtr<RHITexture>& inResource , ERHIResourceStates inAfterState)
+{
+    ResourceBarrier(inResource, RHITextureSubResource::All, inAfterState);
+}
+
+void VulkanCommandList::ResourceBarrier(RefCountPtr<RHITexture>& inResource, const RHITextureSubResource& inSubResource, ERHIResourceStates inAfterState)
 {
     if(IsValid() && !IsClosed())
     {
@@ -606,7 +663,7 @@ void VulkanCommandList::ResourceBarrier(RefCountPtr<RHITexture>& inResource , ER
         const RHITextureDesc& desc = inResource->GetDesc();
         if(texture && texture->IsValid())
         {
-            VulkanTextureState currentState = texture->GetCurrentState();
+            VulkanTextureState currentState = texture->GetCurrentState(inSubResource);
             VkImageMemoryBarrier barrier{};
             barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
             barrier.oldLayout = currentState.Layout;
@@ -615,16 +672,18 @@ void VulkanCommandList::ResourceBarrier(RefCountPtr<RHITexture>& inResource , ER
             barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
             barrier.image = texture->GetTexture();
             barrier.subresourceRange.aspectMask = RHI::Vulkan::GuessImageAspectFlags(desc.Format);
-            barrier.subresourceRange.baseMipLevel = 0;
-            barrier.subresourceRange.levelCount = desc.MipLevels;
-            barrier.subresourceRange.baseArrayLayer = 0;
-            barrier.subresourceRange.layerCount = desc.ArraySize;
+            barrier.subresourceRange.baseMipLevel = inSubResource.FirstMipSlice;
+            barrier.subresourceRange.levelCount = std::min(inSubResource.NumMipSlices, desc.MipLevels - inSubResource.FirstMipSlice);
+            barrier.subresourceRange.baseArrayLayer = inSubResource.FirstArraySlice;
+            barrier.subresourceRange.layerCount = std::min(inSubResource.NumArraySlices, desc.ArraySize - inSubResource.FirstArraySlice);
             barrier.srcAccessMask = currentState.AccessFlags;
             barrier.dstAccessMask = RHI::Vulkan::ConvertAccessFlags(inAfterState);
+            if(barrier.oldLayout == barrier.newLayout && barrier.srcAccessMask == barrier.dstAccessMask)
+                return;
             m_ImageBarriers.push_back(barrier);
             currentState.Layout = barrier.newLayout;
-            currentState.AccessFlags = barrier.newLayout;
-            texture->ChangeState(currentState);
+            currentState.AccessFlags = barrier.dstAccessMask;
+            texture->ChangeState(currentState, inSubResource);
         }
     }
 }
@@ -646,8 +705,117 @@ void VulkanCommandList::SetResourceSet(RefCountPtr<RHIResourceSet>& inResourceSe
         }
         if(resourceSet && resourceSet->IsValid())
         {
-            vkCmdBindDescriptorSets(m_CmdBufferHandle, VK_PIPELINE_BIND_POINT_GRAPHICS, m_Context.pipelineLayout, 0, resourceSet->GetDescriptorSetsCount(), resourceSet->GetDescriptorSets(), 0, nullptr);
+            resourceSet->FlushDescriptorWrites();
+            const VkDescriptorSet* descriptorSets = resourceSet->GetDescriptorSets();
+            if(resourceSet->IsDynamic() || resourceSet->HasOverflowBindings())
+            {
+                if(!CommitDynamicResourceSet(resourceSet))
+                {
+                    Log::Error("[Vulkan] Failed to allocate the descriptor sets of the dynamic resource set");
+                    return;
+                }
+                descriptorSets = m_DynamicDescriptorSets.data();
+            }
+            vkCmdBindDescriptorSets(m_CmdBufferHandle, VK_PIPELINE_BIND_POINT_GRAPHICS, m_Context.pipelineLayout, 0, resourceSet->GetDescriptorSetsCount(), descriptorSets
+                , resourceSet->GetDynamicOffsetCount(), resourceSet->GetDynamicOffsets());
+        }
+    }
+}
+
+// Writes the bindings of the set into transient sets, bindings the command list already wrote reuse their set. The
+// spaces of a persistent set without an overflow constant buffer keep their persistent set
+bool VulkanCommandList::CommitDynamicResourceSet(VulkanResourceSet* inResourceSet)
+{
+    const uint32_t numSets = inResourceSet->GetDescriptorSetsCount();
+    m_DynamicDescriptorSets.assign(numSets, VK_NULL_HANDLE);
+    for(uint32_t i = 0; i < numSets; ++i)
+    {
+        if(!inResourceSet->IsTransientSpace(i))
+        {
+            m_DynamicDescriptorSets[i] = inResourceSet->GetDescriptorSets()[i];
+            continue;
+        }
+        
+        uint64_t hash;
+        const std::vector<uint64_t>& key = inResourceSet->GetDynamicSetKey(i, hash);
+        auto range = m_TransientSets.equal_range(hash);
+        auto iter = std::find_if(range.first, range.second, [&key](const auto& inPair) { return inPair.second.Key == key; });
+        if(iter != range.second)
+        {
+            m_DynamicDescriptorSets[i] = iter->second.Set;
+            continue;
+        }
+
+        VkDescriptorSet descriptorSet;
+        if(!AllocateTransientSet(inResourceSet->GetDescriptorSetLayout(i), inResourceSet->GetVariableDescriptorCount(i), descriptorSet))
+        {
+            return false;
+        }
+        inResourceSet->WriteDynamicDescriptorSet(i, descriptorSet);
+        m_TransientSets.emplace(hash, TransientSet{key, descriptorSet});
+        m_DynamicDescriptorSets[i] = descriptorSet;
+    }
+    return true;
+}
+
+bool VulkanCommandList::AllocateTransientSet(VkDescriptorSetLayout inLayout, uint32_t inVariableDescriptorCount, VkDescriptorSet& outSet)
+{
+    VulkanDescriptorAllocator& allocator = m_Device.GetDescriptorAllocator();
+    if(m_TransientPool != nullptr)
+    {
+        if(allocator.AllocateTransient(m_TransientPool, inLayout, inVariableDescriptorCount, outSet))
+        {
+            return true;
+        }
+        m_TransientPools.push_back(m_TransientPool);
+        m_TransientPool = nullptr;
+    }
+    
+    if(!allocator.AcquireTransientPool(m_TransientPool))
+    {
+        return false;
+    }
+    if(!allocator.AllocateTransient(m_TransientPool, inLayout, inVariableDescriptorCount, outSet))
+    {
+        Log::Error("[Vulkan] The descriptor set layout does not fit into an empty transient descriptor pool");
+        return false;
+    }
+    return true;
+}
+
+void VulkanCommandList::TakeTransientPools(std::vector<VulkanTransientDescriptorPool*>& outPools)
+{
+    if(m_TransientPool != nullptr)
+    {
+        m_TransientPools.push_back(m_TransientPool);
+        m_TransientPool = nullptr;
+    }
+    outPools.insert(outPools.end(), m_TransientPools.begin(), m_TransientPools.end());
+    m_TransientPools.clear();
+    m_TransientSets.clear();
+}
+
+// The pools of a command list which was not executed never reached a queue
+void VulkanCommandList::ReleaseTransientPools()
+{
+    std::vector<VulkanTransientDescriptorPool*> pools;
+    TakeTransientPools(pools);
+    if(!pools.empty())
+    {
+        m_Device.GetDescriptorAllocator().ReleaseTransientPools(pools);
+    }
+}
+
+void VulkanCommandList::SetPushConstants(const void* inData, uint32_t inSize)
+{
+    if(IsValid() && !IsClosed())
+    {
+        if(inSize == 0 || inSize > m_Context.pushConstantsSize || inSize % sizeof(uint32_t) != 0)
+        {
+            Log::Error("[Vulkan] The push constants of %u bytes do not fit the %u bytes of the pipeline binding layout", inSize, m_Context.pushConstantsSize);
+            return;
         }
+        vkCmdPushConstants(m_CmdBufferHandle, m_Context.pipelineLayout, VK_SHADER_STAGE_ALL, 0, inSize, inData);
     }
 }
 
@@ -676,6 +844,7 @@ bool VulkanCommandList::IsValid() const
 
 void VulkanCommandList::ShutdownInternal()
 {
+    ReleaseTransientPools();
     if(m_CmdBufferHandle != VK_NULL_HANDLE)
     {
         vkFreeCommandBuffers(m_Device.GetDevice(), m_CmdPoolHandle, 1, &m_CmdBufferHandle);
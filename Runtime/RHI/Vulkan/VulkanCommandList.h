@@ -3,6 +3,10 @@
 #include "../RHICommandList.h"
 #include "VulkanDefinitions.h"
 
+class VulkanPipelineBindingLayout;
+class VulkanResourceSet;
+struct VulkanTransientDescriptorPool;
+
 struct VulkanGraphicsPipelineContext
 {
     VkPipeline pipelineState = VK_NULL_HANDLE;
@@ -10,11 +14,13 @@ struct VulkanGraphicsPipelineContext
     VkRenderPass renderPass = VK_NULL_HANDLE;
     VkFramebuffer frameBuffer = VK_NULL_HANDLE;
     VkPipelineBindPoint bindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+    uint32_t pushConstantsSize = 0;
 
     void Clear()
     {
         pipelineState = VK_NULL_HANDLE;
         pipelineLayout = VK_NULL_HANDLE;
+        pushConstantsSize = 0;
         renderPass = VK_NULL_HANDLE;
         frameBuffer = VK_NULL_HANDLE;
     }
@@ -40,8 +46,10 @@ public:
         , const RHIClearValue* inColor , uint32_t inNumRenderTargets
         , float inDepth, uint8_t inStencil) override;
     void ResourceBarrier(RefCountPtr<RHITexture>& inResource , ERHIResourceStates inAfterState) override;
+    void ResourceBarrier(RefCountPtr<RHITexture>& inResource, const RHITextureSubResource& inSubResource, ERHIResourceStates inAfterState) override;
     void ResourceBarrier(RefCountPtr<RHIBuffer>& inResource, ERHIResourceStates inAfterState) override;
     void SetResourceSet(RefCountPtr<RHIResourceSet>& inResourceSet) override;
+    void SetPushConstants(const void* inData, uint32_t inSize) override;
     
     void CopyBuffer(RefCountPtr<RHIBuffer>& dstBuffer, size_t dstOffset, RefCountPtr<RHIBuffer>& srcBuffer, size_t srcOffset, size_t size) override;
     void CopyTexture(RefCountPtr<RHITexture>& dstTexture, RefCountPtr<RHITexture>& srcTexture) override;
@@ -53,10 +61,12 @@ public:
     void DrawIndirect(RefCountPtr<RHIBuffer>& indirectCommands, uint32_t drawCount, size_t commandsBufferOffset = 0) override;
     void DrawIndexed(uint32_t indexCount, uint32_t instanceCount, uint32_t firstIndex = 0, uint32_t vertexOffset = 0, uint32_t firstInstance = 0) override;
     void DrawIndexedIndirect(RefCountPtr<RHIBuffer>& indirectCommands, uint32_t drawCount, size_t commandsBufferOffset = 0) override;
+    void DrawIndexedIndirectCount(RefCountPtr<RHIBuffer>& indirectCommands, RefCountPtr<RHIBuffer>& countBuffer, uint32_t maxDrawCount, size_t commandsBufferOffset = 0, size_t countBufferOffset = 0) override;
     void Dispatch(uint32_t threadGroupX, uint32_t threadGroupY, uint32_t threadGroupZ) override;
     void DispatchIndirect(RefCountPtr<RHIBuffer>& indirectCommands, uint32_t count, size_t commandsBufferOffset = 0) override;
     void DispatchMesh(uint32_t threadGroupX, uint32_t threadGroupY, uint32_t threadGroupZ) override;
     void DispatchMeshIndirect(RefCountPtr<RHIBuffer>& indirectCommands, uint32_t count, size_t commandsBufferOffset = 0) override;
+    void DispatchMeshIndirectCount(RefCountPtr<RHIBuffer>& indirectCommands, RefCountPtr<RHIBuffer>& countBuffer, uint32_t maxCount, size_t commandsBufferOffset = 0, size_t countBufferOffset = 0) override;
     void DispatchRays(uint32_t width, uint32_t height, uint32_t depth, const RHIShaderTable& shaderTable) override;
     
     void SetVertexBuffer(const RefCountPtr<RHIBuffer>& inBuffer, size_t inOffset = 0) override;
@@ -66,6 +76,8 @@ public:
     bool IsClosed() const override { return m_IsClosed; }
     ERHICommandQueueType GetQueueType() const override { return m_QueueType; }
     VkCommandBuffer GetCommandBuffer() const { return m_CmdBufferHandle; }
+    // Appends the transient descriptor pools of the recorded commands to outPools for the queue submit
+    void TakeTransientPools(std::vector<VulkanTransientDescriptorPool*>& outPools);
     
 protected:
     void SetNameInternal() override;
@@ -74,10 +86,14 @@ private:
     friend class VulkanDevice;
     VulkanCommandList(VulkanDevice& inDevice, ERHICommandQueueType inType);
     void ShutdownInternal();
+    void SetPipelineLayout(const VulkanPipelineBindingLayout* inBindingLayout, VkPipelineBindPoint inBindPoint);
     void FlushBarriers(VkPipelineStageFlags srcStage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT
         , VkPipelineStageFlags dstStage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT);
 
     void EndRenderPass();
+    bool CommitDynamicResourceSet(VulkanResourceSet* inResourceSet);
+    bool AllocateTransientSet(VkDescriptorSetLayout inLayout, uint32_t inVariableDescriptorCount, VkDescriptorSet& outSet);
+    void ReleaseTransientPools();
     
     VulkanDevice& m_Device;
     const ERHICommandQueueType m_QueueType;
@@ -89,4 +105,15 @@ private:
     std::vector<VkBufferMemoryBarrier> m_BufferBarriers;
 
     VulkanGraphicsPipelineContext m_Context;
+
+    VulkanTransientDescriptorPool* m_TransientPool;
+    std::vector<VulkanTransientDescriptorPool*> m_TransientPools;     // the full pools taken since Begin
+    // The sets in the pools by the hash of their bindings, a hash collision is told apart by the key
+    struct TransientSet
+    {
+        std::vector<uint64_t> Key;
+        VkDescriptorSet Set;
+    };
+    std::unordered_multimap<uint64_t, TransientSet> m_TransientSets;
+    std::vector<VkDescriptorSet> m_DynamicDescriptorSets;
 };
\ No newline at end of file
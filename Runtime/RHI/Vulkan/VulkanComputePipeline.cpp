@@ -15,12 +15,15 @@ RefCountPtr<RHIShader> VulkanDevice::CreateShader(ERHIShaderType inType)
 
 RefCountPtr<RHIComputePipeline> VulkanDevice::CreatePipeline(const RHIComputePipelineDesc& inDesc)
 {
-    RefCountPtr<RHIComputePipeline> pipeline(new VulkanComputePipeline(*this, inDesc));
-    if(!pipeline->Init())
+    return m_PipelineCache.FindOrCreate(inDesc, [this](const RHIComputePipelineDesc& inCreateDesc)
     {
-        Log::Error("[Vulkan] Failed to create compute pipeline");
-    }
-    return pipeline;
+        RefCountPtr<RHIComputePipeline> pipeline(new VulkanComputePipeline(*this, inCreateDesc));
+        if(!pipeline->Init())
+        {
+            Log::Error("[Vulkan] Failed to create compute pipeline");
+        }
+        return pipeline;
+    });
 }
 
 VulkanComputePipeline::VulkanComputePipeline(VulkanDevice& inDevice, const RHIComputePipelineDesc& inDesc)
@@ -72,7 +75,7 @@ bool VulkanComputePipeline::Init()
     computePipelineInfo.layout = bindingLayout->GetPipelineLayout();
     computePipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
     computePipelineInfo.basePipelineIndex = -1;
-    VkResult result = vkCreateComputePipelines(m_Device.GetDevice(), VK_NULL_HANDLE, 1,  &computePipelineInfo, nullptr, &m_PipelineState);
+    VkResult result = vkCreateComputePipelines(m_Device.GetDevice(), m_Device.GetPipelineCacheHandle(), 1,  &computePipelineInfo, nullptr, &m_PipelineState);
     if(result != VK_SUCCESS)
     {
         OUTPUT_VULKAN_FAILED_RESULT(result)
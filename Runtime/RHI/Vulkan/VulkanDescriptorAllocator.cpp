@@ -0,0 +1,307 @@
+#include "VulkanDescriptorAllocator.h"
+#include "VulkanDevice.h"
+#include "../../Core/Log.h"
+
+// The descriptors of a pool per set it holds
+static const std::array<VkDescriptorPoolSize, 9> s_DescriptorsPerSet = {{
+    {VK_DESCRIPTOR_TYPE_SAMPLER, 4},
+    {VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, 8},
+    {VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 8},
+    {VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER, 8},
+    {VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER, 8},
+    {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 8},
+    {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 8},
+    {VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR, 1},
+    {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 4},
+}};
+
+VulkanDescriptorAllocator::VulkanDescriptorAllocator(VulkanDevice& inDevice)
+    : m_Device(inDevice)
+    , m_CurrentPool(0)
+{
+
+}
+
+VulkanDescriptorAllocator::~VulkanDescriptorAllocator()
+{
+    Shutdown();
+}
+
+bool VulkanDescriptorAllocator::Init()
+{
+    if(IsValid())
+    {
+        Log::Warning("[Vulkan] Descriptor allocator is already initialized");
+        return true;
+    }
+
+    VkDescriptorPool pool = CreatePool(s_MaxSetsPerPool, VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT);
+    if(pool == VK_NULL_HANDLE)
+    {
+        return false;
+    }
+    m_Pools.push_back(pool);
+    m_CurrentPool = 0;
+    return true;
+}
+
+bool VulkanDescriptorAllocator::IsValid() const
+{
+    return !m_Pools.empty();
+}
+
+void VulkanDescriptorAllocator::Shutdown()
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    VkDevice device = m_Device.GetDevice();
+    for(const Submission& submission : m_Submissions)
+    {
+        vkWaitForFences(device, 1, &submission.Fence, VK_TRUE, UINT64_MAX);
+        vkDestroyFence(device, submission.Fence, nullptr);
+    }
+    m_Submissions.clear();
+    for(VkFence fence : m_FreeFences)
+    {
+        vkDestroyFence(device, fence, nullptr);
+    }
+    m_FreeFences.clear();
+
+    for(VulkanTransientDescriptorPool* pool : m_TransientPools)
+    {
+        vkDestroyDescriptorPool(device, pool->Pool, nullptr);
+        delete pool;
+    }
+    m_TransientPools.clear();
+    m_FreeTransientPools.clear();
+
+    for(VkDescriptorPool pool : m_Pools)
+    {
+        vkDestroyDescriptorPool(device, pool, nullptr);
+    }
+    m_Pools.clear();
+    m_CurrentPool = 0;
+}
+
+VkDescriptorPool VulkanDescriptorAllocator::CreatePool(uint32_t inMaxSets, VkDescriptorPoolCreateFlags inFlags) const
+{
+    std::array<VkDescriptorPoolSize, s_DescriptorsPerSet.size()> poolSizes = s_DescriptorsPerSet;
+    for(VkDescriptorPoolSize& poolSize : poolSizes)
+    {
+        poolSize.descriptorCount *= inMaxSets;
+    }
+
+    VkDescriptorPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+    poolInfo.pPoolSizes = poolSizes.data();
+    poolInfo.maxSets = inMaxSets;
+    poolInfo.flags = inFlags;
+
+    VkDescriptorPool pool = VK_NULL_HANDLE;
+    VkResult result = vkCreateDescriptorPool(m_Device.GetDevice(), &poolInfo, nullptr, &pool);
+    if(result != VK_SUCCESS)
+    {
+        OUTPUT_VULKAN_FAILED_RESULT(result)
+        return VK_NULL_HANDLE;
+    }
+    return pool;
+}
+
+VkResult VulkanDescriptorAllocator::AllocateFromPool(VkDescriptorPool inPool, VkDescriptorSetLayout inLayout, uint32_t inVariableDescriptorCount, VkDescriptorSet& outSet) const
+{
+    VkDescriptorSetVariableDescriptorCountAllocateInfoEXT variableDescriptorCountAllocInfo{};
+    variableDescriptorCountAllocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_VARIABLE_DESCRIPTOR_COUNT_ALLOCATE_INFO_EXT;
+    variableDescriptorCountAllocInfo.descriptorSetCount = 1;
+    variableDescriptorCountAllocInfo.pDescriptorCounts = &inVariableDescriptorCount;
+
+    VkDescriptorSetAllocateInfo allocateInfo{};
+    allocateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocateInfo.descriptorPool = inPool;
+    allocateInfo.descriptorSetCount = 1;
+    allocateInfo.pSetLayouts = &inLayout;
+    allocateInfo.pNext = inVariableDescriptorCount > 0 ? &variableDescriptorCountAllocInfo : nullptr;
+    return vkAllocateDescriptorSets(m_Device.GetDevice(), &allocateInfo, &outSet);
+}
+
+bool VulkanDescriptorAllocator::Allocate(VkDescriptorSetLayout inLayout, uint32_t inVariableDescriptorCount, VkDescriptorSet& outSet, VkDescriptorPool& outPool)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    if(m_Pools.empty())
+    {
+        Log::Error("[Vulkan] The descriptor allocator is not initialized");
+        return false;
+    }
+
+    // The pool of the last allocation first, the older pools may have room again after their sets were freed
+    for(uint32_t i = 0; i < m_Pools.size(); ++i)
+    {
+        const uint32_t poolIndex = (m_CurrentPool + i) % static_cast<uint32_t>(m_Pools.size());
+        VkResult result = AllocateFromPool(m_Pools[poolIndex], inLayout, inVariableDescriptorCount, outSet);
+        if(result == VK_SUCCESS)
+        {
+            m_CurrentPool = poolIndex;
+            outPool = m_Pools[poolIndex];
+            return true;
+        }
+        if(result != VK_ERROR_OUT_OF_POOL_MEMORY && result != VK_ERROR_FRAGMENTED_POOL)
+        {
+            OUTPUT_VULKAN_FAILED_RESULT(result)
+            return false;
+        }
+    }
+
+    VkDescriptorPool pool = CreatePool(s_MaxSetsPerPool, VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT);
+    if(pool == VK_NULL_HANDLE)
+    {
+        return false;
+    }
+    m_Pools.push_back(pool);
+    m_CurrentPool = static_cast<uint32_t>(m_Pools.size() - 1);
+
+    VkResult result = AllocateFromPool(pool, inLayout, inVariableDescriptorCount, outSet);
+    if(result != VK_SUCCESS)
+    {
+        // Only a set with more descriptors of a type than a whole pool holds fails on an empty pool
+        Log::Error("[Vulkan] The descriptor set layout does not fit into an empty descriptor pool");
+        return false;
+    }
+    outPool = pool;
+    return true;
+}
+
+void VulkanDescriptorAllocator::Free(VkDescriptorPool inPool, VkDescriptorSet inSet)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    if(m_Pools.empty())
+    {
+        return; // the pools were destroyed with their sets
+    }
+    vkFreeDescriptorSets(m_Device.GetDevice(), inPool, 1, &inSet);
+}
+
+bool VulkanDescriptorAllocator::AcquireTransientPool(VulkanTransientDescriptorPool*& outPool)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    RetireInternal();
+    if(m_FreeTransientPools.empty())
+    {
+        VkDescriptorPool pool = CreatePool(s_MaxSetsPerTransientPool, 0);
+        if(pool != VK_NULL_HANDLE)
+        {
+            VulkanTransientDescriptorPool* transientPool = new VulkanTransientDescriptorPool();
+            transientPool->Pool = pool;
+            m_TransientPools.push_back(transientPool);
+            m_FreeTransientPools.push_back(transientPool);
+        }
+        else if(!m_Submissions.empty())
+        {
+            const VkFence fence = m_Submissions.front().Fence;
+            vkWaitForFences(m_Device.GetDevice(), 1, &fence, VK_TRUE, UINT64_MAX);
+            RetireInternal();
+        }
+        else
+        {
+            // Every pool belongs to a command list that is still recording
+            Log::Error("[Vulkan] The transient descriptor pools are exhausted by the recording command lists");
+            return false;
+        }
+    }
+
+    outPool = m_FreeTransientPools.front();
+    m_FreeTransientPools.pop_front();
+    return true;
+}
+
+bool VulkanDescriptorAllocator::AllocateTransient(VulkanTransientDescriptorPool* inPool, VkDescriptorSetLayout inLayout, uint32_t inVariableDescriptorCount, VkDescriptorSet& outSet)
+{
+    // A transient pool belongs to one command list, it is not shared with the other threads
+    VkResult result = AllocateFromPool(inPool->Pool, inLayout, inVariableDescriptorCount, outSet);
+    if(result == VK_SUCCESS)
+    {
+        ++inPool->NumAllocated;
+        return true;
+    }
+    if(result != VK_ERROR_OUT_OF_POOL_MEMORY && result != VK_ERROR_FRAGMENTED_POOL)
+    {
+        OUTPUT_VULKAN_FAILED_RESULT(result)
+    }
+    return false;
+}
+
+void VulkanDescriptorAllocator::ReleaseTransientPools(const std::vector<VulkanTransientDescriptorPool*>& inPools)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    if(m_Pools.empty())
+    {
+        return;
+    }
+    for(VulkanTransientDescriptorPool* pool : inPools)
+    {
+        vkResetDescriptorPool(m_Device.GetDevice(), pool->Pool, 0);
+        pool->NumAllocated = 0;
+        m_FreeTransientPools.push_back(pool);
+    }
+}
+
+void VulkanDescriptorAllocator::Submit(VkQueue inQueue, const std::vector<VulkanTransientDescriptorPool*>& inPools)
+{
+    if(inPools.empty())
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    VkFence fence = VK_NULL_HANDLE;
+    if(!m_FreeFences.empty())
+    {
+        fence = m_FreeFences.back();
+        m_FreeFences.pop_back();
+    }
+    else
+    {
+        VkFenceCreateInfo fenceInfo{};
+        fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+        VkResult result = vkCreateFence(m_Device.GetDevice(), &fenceInfo, nullptr, &fence);
+        if(result != VK_SUCCESS)
+        {
+            // The pools can not be tracked, waiting for the queue is the only safe way to reuse them
+            OUTPUT_VULKAN_FAILED_RESULT(result)
+            vkQueueWaitIdle(inQueue);
+            for(VulkanTransientDescriptorPool* pool : inPools)
+            {
+                vkResetDescriptorPool(m_Device.GetDevice(), pool->Pool, 0);
+                pool->NumAllocated = 0;
+                m_FreeTransientPools.push_back(pool);
+            }
+            return;
+        }
+    }
+
+    // A submit without command buffers signals the fence once the work submitted before it completed
+    vkQueueSubmit(inQueue, 0, nullptr, fence);
+    m_Submissions.push_back({fence, inPools});
+}
+
+void VulkanDescriptorAllocator::RetireInternal()
+{
+    // The queues run independently, a completed submit of one queue may wait behind a submit of another
+    for(auto it = m_Submissions.begin(); it != m_Submissions.end();)
+    {
+        if(vkGetFenceStatus(m_Device.GetDevice(), it->Fence) == VK_SUCCESS)
+        {
+            for(VulkanTransientDescriptorPool* pool : it->Pools)
+            {
+                vkResetDescriptorPool(m_Device.GetDevice(), pool->Pool, 0);
+                pool->NumAllocated = 0;
+                m_FreeTransientPools.push_back(pool);
+            }
+            vkResetFences(m_Device.GetDevice(), 1, &it->Fence);
+            m_FreeFences.push_back(it->Fence);
+            it = m_Submissions.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
\ No newline at end of file
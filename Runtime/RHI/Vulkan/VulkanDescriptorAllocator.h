@@ -0,0 +1,71 @@
+#pragma once
+#include "VulkanDefinitions.h"
+#include <deque>
+#include <mutex>
+#include <vector>
+
+class VulkanDevice;
+
+// A pool of the transient pools, a command list allocates the sets of its dynamic resource sets from it, see
+// VulkanDescriptorAllocator::AcquireTransientPool
+struct VulkanTransientDescriptorPool
+{
+    VkDescriptorPool Pool = VK_NULL_HANDLE;
+    uint32_t NumAllocated = 0;
+};
+
+// The descriptor sets come from a growing list of pools instead of one fixed pool. Resource sets allocate their sets
+// from the persistent pools for their whole lifetime, a new pool is added once the others are exhausted or fragmented.
+// Dynamic resource sets allocate a set each time their bindings change from a transient pool of the command list, the
+// transient pools are reset in bulk once the queues passed the submits which may still read them.
+class VulkanDescriptorAllocator
+{
+public:
+    static constexpr uint32_t s_MaxSetsPerPool = 128;
+    static constexpr uint32_t s_MaxSetsPerTransientPool = 256;
+
+    VulkanDescriptorAllocator(VulkanDevice& inDevice);
+    ~VulkanDescriptorAllocator();
+
+    bool Init();
+    bool IsValid() const;
+    void Shutdown();
+
+    // inVariableDescriptorCount is the size of the bindless array of the set layout, 0 if it has none
+    bool Allocate(VkDescriptorSetLayout inLayout, uint32_t inVariableDescriptorCount, VkDescriptorSet& outSet, VkDescriptorPool& outPool);
+    void Free(VkDescriptorPool inPool, VkDescriptorSet inSet);
+
+    // Returns a reset transient pool, waits for the oldest submit if every pool is in flight and no new pool can be created
+    bool AcquireTransientPool(VulkanTransientDescriptorPool*& outPool);
+    // Allocates from inPool, false if the pool is exhausted and the caller should acquire another one
+    bool AllocateTransient(VulkanTransientDescriptorPool* inPool, VkDescriptorSetLayout inLayout, uint32_t inVariableDescriptorCount, VkDescriptorSet& outSet);
+    // Returns pools which never reached a queue, e.g. of a command list that began again without being executed
+    void ReleaseTransientPools(const std::vector<VulkanTransientDescriptorPool*>& inPools);
+    // Submits a fence after each vkQueueSubmit, the pools of the executed command list are reset once it is signaled
+    void Submit(VkQueue inQueue, const std::vector<VulkanTransientDescriptorPool*>& inPools);
+
+    uint32_t GetNumPools() const { return static_cast<uint32_t>(m_Pools.size()); }
+    uint32_t GetNumTransientPools() const { return static_cast<uint32_t>(m_TransientPools.size()); }
+
+private:
+    struct Submission
+    {
+        VkFence Fence;
+        std::vector<VulkanTransientDescriptorPool*> Pools;
+    };
+
+    VkDescriptorPool CreatePool(uint32_t inMaxSets, VkDescriptorPoolCreateFlags inFlags) const;
+    VkResult AllocateFromPool(VkDescriptorPool inPool, VkDescriptorSetLayout inLayout, uint32_t inVariableDescriptorCount, VkDescriptorSet& outSet) const;
+    void RetireInternal();
+
+    VulkanDevice& m_Device;
+
+    std::mutex m_Mutex;
+    std::vector<VkDescriptorPool> m_Pools;
+    uint32_t m_CurrentPool;     // the pool of the last allocation, tried first
+
+    std::vector<VulkanTransientDescriptorPool*> m_TransientPools;
+    std::deque<VulkanTransientDescriptorPool*> m_FreeTransientPools;
+    std::deque<Submission> m_Submissions;   // in submit order
+    std::vector<VkFence> m_FreeFences;
+};
\ No newline at end of file
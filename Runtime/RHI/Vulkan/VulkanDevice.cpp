@@ -1,6 +1,8 @@
 #include "VulkanDevice.h"
 
 #include "VulkanCommandList.h"
+#include "VulkanResources.h"
+#include "VulkanDescriptorAllocator.h"
 #include "../RHICommandList.h"
 #include "../../Core/Log.h"
 #include "../../Core/Templates.h"
@@ -27,6 +29,7 @@ static VkPhysicalDeviceRayQueryFeaturesKHR              s_RayQueryFeatures{};
 static VkPhysicalDeviceRayTracingPipelineFeaturesKHR    s_RayTracingPipelineFeatures{};
 static VkPhysicalDeviceAccelerationStructureFeaturesKHR s_AccelerationStructureFeatures{};
 static VkPhysicalDeviceFragmentShadingRateFeaturesKHR   s_FragmentShadingRateFeatures{};
+static VkPhysicalDeviceTimelineSemaphoreFeatures        s_TimelineSemaphoreFeatures{};
 
 static VKAPI_ATTR VkBool32 VKAPI_CALL DebugCallback(VkDebugUtilsMessageSeverityFlagBitsEXT messageSeverity
     , VkDebugUtilsMessageTypeFlagsEXT messageType
@@ -65,6 +68,11 @@ VulkanDevice::VulkanDevice()
     , m_DeviceHandle(VK_NULL_HANDLE)
     , m_QueueIndex {-1, -1, -1}
     , m_QueueHandles {VK_NULL_HANDLE, VK_NULL_HANDLE, VK_NULL_HANDLE}
+    , m_DescriptorAllocator(nullptr)
+    , m_BindlessDescriptorPool(VK_NULL_HANDLE)
+    , m_BindlessSetLayout(VK_NULL_HANDLE)
+    , m_BindlessDescriptorSet(VK_NULL_HANDLE)
+    , m_PipelineCacheHandle(VK_NULL_HANDLE)
 {
     
 }
@@ -254,6 +262,10 @@ bool VulkanDevice::Init()
     {
         vkCmdDrawMeshTasksEXT = reinterpret_cast<PFN_vkCmdDrawMeshTasksEXT>(vkGetDeviceProcAddr(m_DeviceHandle, "vkCmdDrawMeshTasksEXT"));
         vkCmdDrawMeshTasksIndirectEXT = reinterpret_cast<PFN_vkCmdDrawMeshTasksIndirectEXT>(vkGetDeviceProcAddr(m_DeviceHandle, "vkCmdDrawMeshTasksIndirectEXT"));
+        if(m_SupportDrawIndirectCount)
+        {
+            vkCmdDrawMeshTasksIndirectCountEXT = reinterpret_cast<PFN_vkCmdDrawMeshTasksIndirectCountEXT>(vkGetDeviceProcAddr(m_DeviceHandle, "vkCmdDrawMeshTasksIndirectCountEXT"));
+        }
     }
 
     if(m_SupportBufferDeviceAddress)
@@ -287,8 +299,11 @@ bool VulkanDevice::Init()
     vkSetDebugUtilsObjectNameEXT = reinterpret_cast<PFN_vkSetDebugUtilsObjectNameEXT>(vkGetDeviceProcAddr(m_DeviceHandle, "vkSetDebugUtilsObjectNameEXT"));
 #endif
 
-    if(!InitDescriptorPool())
+    m_DescriptorAllocator = std::make_unique<VulkanDescriptorAllocator>(*this);
+    if(!m_DescriptorAllocator->Init())
         return false;
+
+    InitPipelineCache();
     
     return true;
 }
@@ -366,6 +381,20 @@ void VulkanDevice::EnableDeviceExtensions(VkPhysicalDeviceFeatures2& deviceFeatu
         {
             supportRayQuery = true;
         }
+
+        if(strcmp(extension.extensionName, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME) == 0)
+        {
+            Log::Info("[Vulkan] GPU supports memory budget");
+            m_SupportMemoryBudget = true;
+            s_DeviceExtensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+        }
+
+        if(strcmp(extension.extensionName, VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME) == 0)
+        {
+            Log::Info("[Vulkan] GPU supports draw indirect count");
+            m_SupportDrawIndirectCount = true;
+            s_DeviceExtensions.push_back(VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME);
+        }
     }
     
     if(m_SupportSpirv14 && m_SupportShaderFloatControls)
@@ -394,6 +423,23 @@ void VulkanDevice::EnableDeviceExtensions(VkPhysicalDeviceFeatures2& deviceFeatu
         }
     }
 
+    // Timeline semaphores are core since Vulkan 1.2, the feature still has to be enabled
+    VkPhysicalDeviceTimelineSemaphoreFeatures timelineSemaphoreFeatures{};
+    timelineSemaphoreFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES;
+    VkPhysicalDeviceFeatures2 supportedFeatures{};
+    supportedFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+    supportedFeatures.pNext = &timelineSemaphoreFeatures;
+    vkGetPhysicalDeviceFeatures2(m_PhysicalDeviceHandle, &supportedFeatures);
+    if(timelineSemaphoreFeatures.timelineSemaphore == VK_TRUE)
+    {
+        Log::Info("[Vulkan] GPU supports timeline semaphore");
+        m_SupportTimelineSemaphore = true;
+        s_TimelineSemaphoreFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES;
+        s_TimelineSemaphoreFeatures.timelineSemaphore = VK_TRUE;
+        s_TimelineSemaphoreFeatures.pNext = deviceFeatures2.pNext; // Chain the feature to the top of existing features
+        deviceFeatures2.pNext = &s_TimelineSemaphoreFeatures;
+    }
+
     // Enable descriptor indexing feature
     if(m_SupportDescriptorIndexing)
     {
@@ -404,6 +450,10 @@ void VulkanDevice::EnableDeviceExtensions(VkPhysicalDeviceFeatures2& deviceFeatu
         s_PhysicalDeviceDescriptorIndexingFeatures.shaderUniformBufferArrayNonUniformIndexing = VK_TRUE;
         s_PhysicalDeviceDescriptorIndexingFeatures.runtimeDescriptorArray = VK_TRUE;
         s_PhysicalDeviceDescriptorIndexingFeatures.descriptorBindingVariableDescriptorCount = VK_TRUE;
+        s_PhysicalDeviceDescriptorIndexingFeatures.descriptorBindingPartiallyBound = VK_TRUE;
+        s_PhysicalDeviceDescriptorIndexingFeatures.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+        s_PhysicalDeviceDescriptorIndexingFeatures.descriptorBindingStorageImageUpdateAfterBind = VK_TRUE;
+        s_PhysicalDeviceDescriptorIndexingFeatures.descriptorBindingStorageBufferUpdateAfterBind = VK_TRUE;
         s_PhysicalDeviceDescriptorIndexingFeatures.pNext = deviceFeatures2.pNext; // Chain the feature to the top of existing features
         deviceFeatures2.pNext = &s_PhysicalDeviceDescriptorIndexingFeatures;
     }
@@ -456,48 +506,6 @@ void VulkanDevice::EnableDeviceExtensions(VkPhysicalDeviceFeatures2& deviceFeatu
     }
 }
 
-bool VulkanDevice::InitDescriptorPool()
-{
-    std::array<VkDescriptorPoolSize, 8> poolSizes{};
-    poolSizes[0].type = VK_DESCRIPTOR_TYPE_SAMPLER;
-    poolSizes[0].descriptorCount = 512;
-    poolSizes[1].type = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
-    poolSizes[1].descriptorCount = 1024;
-    poolSizes[2].type = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
-    poolSizes[2].descriptorCount = 1024;
-    poolSizes[3].type = VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER;
-    poolSizes[3].descriptorCount = 1024;
-    poolSizes[4].type = VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER;
-    poolSizes[4].descriptorCount = 1024;
-    poolSizes[5].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-    poolSizes[5].descriptorCount = 1024;
-    poolSizes[6].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-    poolSizes[6].descriptorCount = 1024;
-    poolSizes[7].type = VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR;
-    poolSizes[7].descriptorCount = 16;
-    // poolSizes[7].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
-    // poolSizes[7].descriptorCount = 512;
-    // poolSizes[8].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC;
-    // poolSizes[8].descriptorCount = 512;
-
-    VkDescriptorPoolCreateInfo poolInfo{};
-    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-    poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
-    poolInfo.pPoolSizes = poolSizes.data();
-    poolInfo.maxSets = 100; 
-    poolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT;
-
-    VkResult result = vkCreateDescriptorPool(m_DeviceHandle, &poolInfo, nullptr, &m_DescriptorPoolHandle);
-
-    if(result != VK_SUCCESS)
-    {
-        Log::Error("Failed to create descriptor pool");
-        return false;
-    }
-    
-    return true;
-}
-
 void VulkanDevice::Shutdown()
 {
     ShutdownInternal();
@@ -505,6 +513,19 @@ void VulkanDevice::Shutdown()
 
 void VulkanDevice::ShutdownInternal()
 {
+    m_FrameContext.Shutdown();
+    m_CommandListPool.Clear();
+    m_BindlessTable.Shutdown();
+    m_Defragmenter.Clear();
+    m_MemoryAllocator.Clear();
+    m_ResidencyManager.Clear();
+    m_ConstantAllocator.Shutdown();
+    m_UploadRing.Shutdown();
+    m_PipelineCompiler.Shutdown();
+    m_PipelineCache.Clear();
+    m_StateCache.Clear();
+    SavePipelineCache();
+    
     for(auto semaphore : m_WaitForSemaphores)
     {
         semaphore.clear();
@@ -513,8 +534,17 @@ void VulkanDevice::ShutdownInternal()
     {
         semaphore.clear();
     }
+    for(auto& fences : m_WaitForFences)
+    {
+        fences.clear();
+    }
+    for(auto& fences : m_SignalFences)
+    {
+        fences.clear();
+    }
     
-    if(m_DescriptorPoolHandle != VK_NULL_HANDLE) vkDestroyDescriptorPool(m_DeviceHandle, m_DescriptorPoolHandle, nullptr);
+    ShutdownBindlessTable();
+    if(m_DescriptorAllocator) m_DescriptorAllocator->Shutdown();
     
     if(m_DeviceHandle != VK_NULL_HANDLE) vkDestroyDevice(m_DeviceHandle, nullptr);
 #if _DEBUG || DEBUG
@@ -526,13 +556,74 @@ void VulkanDevice::ShutdownInternal()
 #endif
     if(m_InstanceHandle != VK_NULL_HANDLE) vkDestroyInstance(m_InstanceHandle, nullptr);
 
-    m_DescriptorPoolHandle = VK_NULL_HANDLE;
     m_DeviceHandle = VK_NULL_HANDLE;
     m_PhysicalDeviceHandle = VK_NULL_HANDLE;
     m_DebugMessenger = VK_NULL_HANDLE;
     m_InstanceHandle = VK_NULL_HANDLE;
 }
 
+RHIPipelineCacheDeviceId VulkanDevice::GetPipelineCacheDeviceId() const
+{
+    RHIPipelineCacheDeviceId deviceId;
+    deviceId.VendorId = m_PhysicalDeviceProperties.vendorID;
+    deviceId.DeviceId = m_PhysicalDeviceProperties.deviceID;
+    deviceId.DriverVersion = m_PhysicalDeviceProperties.driverVersion;
+    memcpy(deviceId.CacheUuid.data(), m_PhysicalDeviceProperties.pipelineCacheUUID, VK_UUID_SIZE);
+    return deviceId;
+}
+
+void VulkanDevice::InitPipelineCache()
+{
+    std::vector<uint8_t> initialData;
+    RHIPipelineCache::LoadBlob(ERHIBackend::Vulkan, GetPipelineCacheDeviceId(), initialData);
+    
+    VkPipelineCacheCreateInfo cacheInfo{};
+    cacheInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+    cacheInfo.initialDataSize = initialData.size();
+    cacheInfo.pInitialData = initialData.empty() ? nullptr : initialData.data();
+
+    VkResult result = vkCreatePipelineCache(m_DeviceHandle, &cacheInfo, nullptr, &m_PipelineCacheHandle);
+    if(result != VK_SUCCESS && !initialData.empty())
+    {
+        // The driver refused the data, start from an empty cache
+        Log::Warning("[Vulkan] The driver rejected the pipeline cache data, starting with an empty cache");
+        cacheInfo.initialDataSize = 0;
+        cacheInfo.pInitialData = nullptr;
+        result = vkCreatePipelineCache(m_DeviceHandle, &cacheInfo, nullptr, &m_PipelineCacheHandle);
+    }
+    
+    if(result != VK_SUCCESS)
+    {
+        // Not fatal, pipelines are compiled without a cache
+        Log::Warning("[Vulkan] Failed to create the pipeline cache");
+        OUTPUT_VULKAN_FAILED_RESULT(result);
+        m_PipelineCacheHandle = VK_NULL_HANDLE;
+    }
+}
+
+void VulkanDevice::SavePipelineCache()
+{
+    if(m_DeviceHandle == VK_NULL_HANDLE || m_PipelineCacheHandle == VK_NULL_HANDLE)
+    {
+        return;
+    }
+    
+    size_t dataSize = 0;
+    VkResult result = vkGetPipelineCacheData(m_DeviceHandle, m_PipelineCacheHandle, &dataSize, nullptr);
+    if(result == VK_SUCCESS && dataSize > 0)
+    {
+        std::vector<uint8_t> data(dataSize);
+        result = vkGetPipelineCacheData(m_DeviceHandle, m_PipelineCacheHandle, &dataSize, data.data());
+        if(result == VK_SUCCESS)
+        {
+            RHIPipelineCache::SaveBlob(ERHIBackend::Vulkan, GetPipelineCacheDeviceId(), data.data(), dataSize);
+        }
+    }
+    
+    vkDestroyPipelineCache(m_DeviceHandle, m_PipelineCacheHandle, nullptr);
+    m_PipelineCacheHandle = VK_NULL_HANDLE;
+}
+
 bool VulkanDevice::IsValid() const
 {
     bool valid = m_InstanceHandle != VK_NULL_HANDLE
@@ -595,77 +686,306 @@ void VulkanDevice::AddQueueSignalSemaphore(ERHICommandQueueType inType, VkSemaph
     signalSemaphores.push_back(inSemaphore);
 }
 
-void VulkanDevice::ExecuteCommandList(const RefCountPtr<RHICommandList>& inCommandList, const RefCountPtr<RHIFence>& inSignalFence)
+void VulkanDevice::AddQueueWaitForFence(ERHICommandQueueType inType, RefCountPtr<RHITimelineFence>& inFence, uint64_t inValue)
 {
-    VulkanCommandList* commandList = CheckCast<VulkanCommandList*>(inCommandList.GetReference());
-    
-    if(commandList && commandList->IsValid())
+    VulkanTimelineFence* vulkanFence = CheckCast<VulkanTimelineFence*>(inFence.GetReference());
+    if(vulkanFence && vulkanFence->IsValid())
     {
-        if(!commandList->IsClosed())
-        {
-            commandList->End();
-        }
-        
-        VkQueue queue = GetCommandQueue(inCommandList->GetQueueType());
-        VkCommandBuffer cmdBuffer = commandList->GetCommandBuffer();
+        m_WaitForFences[static_cast<uint32_t>(inType)].push_back({vulkanFence, inValue});
+    }
+}
+
+void VulkanDevice::AddQueueSignalFence(ERHICommandQueueType inType, RefCountPtr<RHITimelineFence>& inFence, uint64_t inValue)
+{
+    VulkanTimelineFence* vulkanFence = CheckCast<VulkanTimelineFence*>(inFence.GetReference());
+    if(vulkanFence && vulkanFence->IsValid())
+    {
+        m_SignalFences[static_cast<uint32_t>(inType)].push_back({vulkanFence, inValue});
+    }
+}
 
-        VkSubmitInfo submitInfo{};
-        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-        submitInfo.commandBufferCount = 1;
-        submitInfo.pCommandBuffers = &cmdBuffer;
+void VulkanDevice::ExecuteCommandLists(const RefCountPtr<RHICommandList>* inCommandLists, uint32_t inCount
+    , const RHIQueueFenceValue* inWaitFences, uint32_t inNumWaitFences
+    , const RHIQueueFenceValue* inSignalFences, uint32_t inNumSignalFences
+    , const RefCountPtr<RHIFence>& inSignalFence)
+{
+    if(inCount == 0)
+    {
+        return;
+    }
 
-        std::vector<VkSemaphore>& waitSemaphores = m_WaitForSemaphores[static_cast<uint32_t>(inCommandList->GetQueueType())];
-        std::vector<VkPipelineStageFlags> waitStageMasks(waitSemaphores.size());
-        
-        if(!waitSemaphores.empty())
-        {
-            for(uint32_t i = 0; i < waitSemaphores.size(); ++i)
-            {
-                waitStageMasks[i] = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
-            }
-            
-            submitInfo.waitSemaphoreCount = (uint32_t)waitSemaphores.size();
-            submitInfo.pWaitSemaphores = waitSemaphores.data();
-            submitInfo.pWaitDstStageMask = waitStageMasks.data();
-        }
-        else
-        {
-            submitInfo.waitSemaphoreCount = 0;
-            submitInfo.pWaitSemaphores = nullptr;
-            submitInfo.pWaitDstStageMask = nullptr;
-        }
-        
-        
-        std::vector<VkSemaphore>& signalSemaphores = m_SignalSemaphores[static_cast<uint32_t>(inCommandList->GetQueueType())];
-        if(!signalSemaphores.empty())
-        {
-            submitInfo.signalSemaphoreCount = (uint32_t)signalSemaphores.size();
-            submitInfo.pSignalSemaphores = signalSemaphores.data();
-        }
-        else
+    const ERHICommandQueueType queueType = inCommandLists[0]->GetQueueType();
+    std::vector<VkCommandBuffer> cmdBuffers(inCount);
+    for(uint32_t i = 0; i < inCount; ++i)
+    {
+        VulkanCommandList* commandList = CheckCast<VulkanCommandList*>(inCommandLists[i].GetReference());
+        if(commandList == nullptr || !commandList->IsValid() || commandList->GetQueueType() != queueType)
         {
-            submitInfo.signalSemaphoreCount = 0;
-            submitInfo.pSignalSemaphores = nullptr;
+            Log::Error("[Vulkan] The command list %u is invalid or belongs to another queue than the first one", i);
+            return;
         }
-        
-        if(inSignalFence != nullptr && inSignalFence->IsValid())
+        if(!commandList->IsClosed())
         {
-            inSignalFence->Reset();
-            const VkFence fence = CheckCast<VulkanFence*>(inSignalFence.GetReference())->GetFence();
-            vkQueueSubmit(queue, 1, &submitInfo, fence);
+            commandList->End();
         }
-        else
+        cmdBuffers[i] = commandList->GetCommandBuffer();
+    }
+    
+    VkQueue queue = GetCommandQueue(queueType);
+    const uint32_t queueIndex = static_cast<uint32_t>(queueType);
+    for(uint32_t i = 0; i < inNumWaitFences; ++i)
+    {
+        RefCountPtr<RHITimelineFence> fence = inWaitFences[i].Fence;
+        AddQueueWaitForFence(queueType, fence, inWaitFences[i].Value);
+    }
+    for(uint32_t i = 0; i < inNumSignalFences; ++i)
+    {
+        RefCountPtr<RHITimelineFence> fence = inSignalFences[i].Fence;
+        AddQueueSignalFence(queueType, fence, inSignalFences[i].Value);
+    }
+    // The pooled lists are reused once the queue finished this submit
+    RHIQueueFenceValue poolSignal;
+    if(m_CommandListPool.GetExecuteSignal(inCommandLists, inCount, poolSignal))
+    {
+        AddQueueSignalFence(queueType, poolSignal.Fence, poolSignal.Value);
+    }
+
+    VkSubmitInfo submitInfo{};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.commandBufferCount = inCount;
+    submitInfo.pCommandBuffers = cmdBuffers.data();
+
+    // Binary and timeline semaphores share the arrays, the values of the binary ones are ignored
+    std::vector<VkSemaphore> waitSemaphores = m_WaitForSemaphores[queueIndex];
+    std::vector<uint64_t> waitValues(waitSemaphores.size(), 0);
+    for(const QueueFenceValue& waitFence : m_WaitForFences[queueIndex])
+    {
+        waitSemaphores.push_back(waitFence.Fence->GetSemaphore());
+        waitValues.push_back(waitFence.Value);
+    }
+    // Every command of the submit waits, a wait at the top of the pipe would not block the stages after it
+    std::vector<VkPipelineStageFlags> waitStageMasks(waitSemaphores.size(), VK_PIPELINE_STAGE_ALL_COMMANDS_BIT);
+    
+    std::vector<VkSemaphore> signalSemaphores = m_SignalSemaphores[queueIndex];
+    std::vector<uint64_t> signalValues(signalSemaphores.size(), 0);
+    for(const QueueFenceValue& signalFence : m_SignalFences[queueIndex])
+    {
+        signalSemaphores.push_back(signalFence.Fence->GetSemaphore());
+        signalValues.push_back(signalFence.Value);
+    }
+
+    submitInfo.waitSemaphoreCount = (uint32_t)waitSemaphores.size();
+    submitInfo.pWaitSemaphores = waitSemaphores.empty() ? nullptr : waitSemaphores.data();
+    submitInfo.pWaitDstStageMask = waitStageMasks.empty() ? nullptr : waitStageMasks.data();
+    submitInfo.signalSemaphoreCount = (uint32_t)signalSemaphores.size();
+    submitInfo.pSignalSemaphores = signalSemaphores.empty() ? nullptr : signalSemaphores.data();
+
+    VkTimelineSemaphoreSubmitInfo timelineSubmitInfo{};
+    if(!m_WaitForFences[queueIndex].empty() || !m_SignalFences[queueIndex].empty())
+    {
+        timelineSubmitInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+        timelineSubmitInfo.waitSemaphoreValueCount = (uint32_t)waitValues.size();
+        timelineSubmitInfo.pWaitSemaphoreValues = waitValues.empty() ? nullptr : waitValues.data();
+        timelineSubmitInfo.signalSemaphoreValueCount = (uint32_t)signalValues.size();
+        timelineSubmitInfo.pSignalSemaphoreValues = signalValues.empty() ? nullptr : signalValues.data();
+        submitInfo.pNext = &timelineSubmitInfo;
+    }
+    
+    if(inSignalFence != nullptr && inSignalFence->IsValid())
+    {
+        inSignalFence->Reset();
+        const VkFence fence = CheckCast<VulkanFence*>(inSignalFence.GetReference())->GetFence();
+        vkQueueSubmit(queue, 1, &submitInfo, fence);
+    }
+    else
+    {
+        vkQueueSubmit(queue, 1, &submitInfo, VK_NULL_HANDLE);
+    }
+    ++m_SubmitStats.Submits;
+    m_SubmitStats.CommandLists += inCount;
+
+    // The transient descriptor pools of every list are reset after one fence
+    m_SubmittedTransientPools.clear();
+    for(uint32_t i = 0; i < inCount; ++i)
+    {
+        CheckCast<VulkanCommandList*>(inCommandLists[i].GetReference())->TakeTransientPools(m_SubmittedTransientPools);
+    }
+    m_DescriptorAllocator->Submit(queue, m_SubmittedTransientPools);
+
+    m_WaitForSemaphores[queueIndex].clear();
+    m_SignalSemaphores[queueIndex].clear();
+    m_WaitForFences[queueIndex].clear();
+    m_SignalFences[queueIndex].clear();
+}
+
+bool VulkanDevice::QueryMemoryBudget(RHIMemoryBudget& outBudget)
+{
+    if(!m_SupportMemoryBudget)
+    {
+        return false;
+    }
+
+    VkPhysicalDeviceMemoryBudgetPropertiesEXT budgetProperties{};
+    budgetProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT;
+    VkPhysicalDeviceMemoryProperties2 memoryProperties{};
+    memoryProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2;
+    memoryProperties.pNext = &budgetProperties;
+    vkGetPhysicalDeviceMemoryProperties2(m_PhysicalDeviceHandle, &memoryProperties);
+
+    // Sums the device local heaps, the same segment DXGI_MEMORY_SEGMENT_GROUP_LOCAL reports
+    outBudget = RHIMemoryBudget();
+    for(uint32_t i = 0; i < memoryProperties.memoryProperties.memoryHeapCount; ++i)
+    {
+        if(memoryProperties.memoryProperties.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT)
         {
-            vkQueueSubmit(queue, 1, &submitInfo, VK_NULL_HANDLE);
+            outBudget.Budget += budgetProperties.heapBudget[i];
+            outBudget.Usage += budgetProperties.heapUsage[i];
         }
+    }
+    return true;
+}
+
+// Vulkan has no eviction, the driver pages device memory on its own
+bool VulkanDevice::EvictObjects(const RHIResidencyObject* inObjects, uint32_t inCount)
+{
+    return false;
+}
+
+bool VulkanDevice::MakeObjectsResident(const RHIResidencyObject* inObjects, uint32_t inCount)
+{
+    return false;
+}
 
-        waitSemaphores.clear();
-        signalSemaphores.clear();
+bool VulkanDevice::InitBindlessTable(uint32_t inNumResources, uint32_t inNumSamplers)
+{
+    if(!m_SupportDescriptorIndexing)
+    {
+        Log::Error("[Vulkan] The bindless table requires descriptor indexing");
+        return false;
     }
-    else
+
+    const VkDescriptorType types[] = {VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_DESCRIPTOR_TYPE_SAMPLER};
+    std::array<VkDescriptorSetLayoutBinding, 4> bindings{};
+    std::array<VkDescriptorBindingFlagsEXT, 4> bindingFlags{};
+    std::array<VkDescriptorPoolSize, 4> poolSizes{};
+    for(uint32_t i = 0; i < bindings.size(); ++i)
+    {
+        bindings[i].binding = i;
+        bindings[i].descriptorType = types[i];
+        bindings[i].descriptorCount = i == s_BindlessSamplerBinding ? inNumSamplers : inNumResources;
+        bindings[i].stageFlags = VK_SHADER_STAGE_ALL;
+        // The free indices are never written, and the registers write while recorded command buffers use the set
+        bindingFlags[i] = VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT_EXT | VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT_EXT;
+        poolSizes[i].type = types[i];
+        poolSizes[i].descriptorCount = bindings[i].descriptorCount;
+    }
+
+    VkDescriptorSetLayoutBindingFlagsCreateInfoEXT bindingFlagsInfo{};
+    bindingFlagsInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO_EXT;
+    bindingFlagsInfo.bindingCount = static_cast<uint32_t>(bindingFlags.size());
+    bindingFlagsInfo.pBindingFlags = bindingFlags.data();
+
+    VkDescriptorSetLayoutCreateInfo layoutInfo{};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT_EXT;
+    layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+    layoutInfo.pBindings = bindings.data();
+    layoutInfo.pNext = &bindingFlagsInfo;
+    VkResult result = vkCreateDescriptorSetLayout(m_DeviceHandle, &layoutInfo, nullptr, &m_BindlessSetLayout);
+    if(result != VK_SUCCESS)
+    {
+        OUTPUT_VULKAN_FAILED_RESULT(result);
+        return false;
+    }
+
+    VkDescriptorPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT_EXT;
+    poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+    poolInfo.pPoolSizes = poolSizes.data();
+    poolInfo.maxSets = 1;
+    result = vkCreateDescriptorPool(m_DeviceHandle, &poolInfo, nullptr, &m_BindlessDescriptorPool);
+    if(result != VK_SUCCESS)
     {
-        Log::Error("[Vulkan] The commandList is invalid.");
+        OUTPUT_VULKAN_FAILED_RESULT(result);
+        ShutdownBindlessTable();
+        return false;
     }
+
+    VkDescriptorSetAllocateInfo allocateInfo{};
+    allocateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocateInfo.descriptorPool = m_BindlessDescriptorPool;
+    allocateInfo.descriptorSetCount = 1;
+    allocateInfo.pSetLayouts = &m_BindlessSetLayout;
+    result = vkAllocateDescriptorSets(m_DeviceHandle, &allocateInfo, &m_BindlessDescriptorSet);
+    if(result != VK_SUCCESS)
+    {
+        OUTPUT_VULKAN_FAILED_RESULT(result);
+        ShutdownBindlessTable();
+        return false;
+    }
+    return true;
+}
+
+bool VulkanDevice::WriteBindlessDescriptor(uint32_t inIndex, const RHIBindlessDescriptor& inDescriptor)
+{
+    if(m_BindlessDescriptorSet == VK_NULL_HANDLE)
+    {
+        return false;
+    }
+
+    VkDescriptorImageInfo imageInfo{};
+    VkDescriptorBufferInfo bufferInfo{};
+    VkWriteDescriptorSet descriptorSetWriter{};
+    descriptorSetWriter.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    descriptorSetWriter.dstSet = m_BindlessDescriptorSet;
+    descriptorSetWriter.dstArrayElement = inIndex;
+    descriptorSetWriter.descriptorCount = 1;
+    switch (inDescriptor.Type)
+    {
+    case ERHIBindingResourceType::Texture_SRV:
+    case ERHIBindingResourceType::Texture_UAV:
+        imageInfo = CheckCast<VulkanTexture*>(inDescriptor.Object)->GetDescriptorImageInfo(inDescriptor.Type);
+        if(imageInfo.imageView == VK_NULL_HANDLE)
+            return false;
+        descriptorSetWriter.dstBinding = inDescriptor.Type == ERHIBindingResourceType::Texture_SRV ? s_BindlessSampledImageBinding : s_BindlessStorageImageBinding;
+        descriptorSetWriter.pImageInfo = &imageInfo;
+        break;
+    case ERHIBindingResourceType::Buffer_SRV:
+    case ERHIBindingResourceType::Buffer_UAV:
+        bufferInfo = CheckCast<VulkanBuffer*>(inDescriptor.Object)->GetDescriptorBufferInfo();
+        descriptorSetWriter.dstBinding = s_BindlessStorageBufferBinding;
+        descriptorSetWriter.pBufferInfo = &bufferInfo;
+        break;
+    case ERHIBindingResourceType::Sampler:
+        imageInfo.sampler = CheckCast<VulkanSampler*>(inDescriptor.Object)->GetSampler();
+        descriptorSetWriter.dstBinding = s_BindlessSamplerBinding;
+        descriptorSetWriter.pImageInfo = &imageInfo;
+        break;
+    default:
+        Log::Error("[Vulkan] The bindless table only holds SRVs, UAVs and samplers");
+        return false;
+    }
+    
+    descriptorSetWriter.descriptorType = RHI::Vulkan::ConvertDescriptorType(inDescriptor.Type);
+    vkUpdateDescriptorSets(m_DeviceHandle, 1, &descriptorSetWriter, 0, nullptr);
+    return true;
+}
+
+void VulkanDevice::ShutdownBindlessTable()
+{
+    // Destroying the pool frees the set
+    if(m_BindlessDescriptorPool != VK_NULL_HANDLE)
+    {
+        vkDestroyDescriptorPool(m_DeviceHandle, m_BindlessDescriptorPool, nullptr);
+        m_BindlessDescriptorPool = VK_NULL_HANDLE;
+    }
+    if(m_BindlessSetLayout != VK_NULL_HANDLE)
+    {
+        vkDestroyDescriptorSetLayout(m_DeviceHandle, m_BindlessSetLayout, nullptr);
+        m_BindlessSetLayout = VK_NULL_HANDLE;
+    }
+    m_BindlessDescriptorSet = VK_NULL_HANDLE;
 }
 
 void VulkanDevice::SetDebugName(VkObjectType objectType, uint64_t objectHandle, const std::string& name) const
@@ -787,6 +1107,11 @@ void VulkanFence::CpuWait()
     }
 }
 
+bool VulkanFence::IsCompleted()
+{
+    return IsValid() && vkGetFenceStatus(m_Device.GetDevice(), m_FenceHandle) == VK_SUCCESS;
+}
+
 void VulkanFence::ShutdownInternal()
 {
     if(m_FenceHandle != VK_NULL_HANDLE)
@@ -824,6 +1149,127 @@ RefCountPtr<VulkanSemaphore> VulkanDevice::CreateVulkanSemaphore()
     return semaphore;
 }
 
+RefCountPtr<RHITimelineFence> VulkanDevice::CreateTimelineFence(uint64_t inInitialValue)
+{
+    RefCountPtr<RHITimelineFence> fence(new VulkanTimelineFence(*this, inInitialValue));
+    if(!fence->Init())
+    {
+        Log::Error("[Vulkan] Failed to create timeline fence");
+    }
+    return fence;
+}
+
+VulkanTimelineFence::VulkanTimelineFence(VulkanDevice& inDevice, uint64_t inInitialValue)
+    : m_Device(inDevice)
+    , m_SemaphoreHandle(VK_NULL_HANDLE)
+    , m_InitialValue(inInitialValue)
+{
+    
+}
+
+VulkanTimelineFence::~VulkanTimelineFence()
+{
+    ShutdownInternal();
+}
+
+void VulkanTimelineFence::Shutdown()
+{
+    ShutdownInternal();
+}
+
+bool VulkanTimelineFence::Init()
+{
+    if(IsValid())
+    {
+        Log::Warning("[Vulkan] Timeline fence already initialized");
+        return true;
+    }
+
+    if(!m_Device.SupportTimelineSemaphore())
+    {
+        Log::Error("[Vulkan] The device does not support timeline semaphore");
+        return false;
+    }
+
+    VkSemaphoreTypeCreateInfo semaphoreTypeCreateInfo{};
+    semaphoreTypeCreateInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+    semaphoreTypeCreateInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+    semaphoreTypeCreateInfo.initialValue = m_InitialValue;
+
+    VkSemaphoreCreateInfo semaphoreCreateInfo{};
+    semaphoreCreateInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+    semaphoreCreateInfo.pNext = &semaphoreTypeCreateInfo;
+    
+    VkResult result = vkCreateSemaphore(m_Device.GetDevice(), &semaphoreCreateInfo, nullptr, &m_SemaphoreHandle);
+    if(result != VK_SUCCESS)
+    {
+        OUTPUT_VULKAN_FAILED_RESULT(result);
+        return false;
+    }
+    
+    return true;
+}
+
+bool VulkanTimelineFence::IsValid() const
+{
+    return m_SemaphoreHandle != VK_NULL_HANDLE;
+}
+
+void VulkanTimelineFence::Signal(uint64_t inValue)
+{
+    if(IsValid())
+    {
+        VkSemaphoreSignalInfo signalInfo{};
+        signalInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SIGNAL_INFO;
+        signalInfo.semaphore = m_SemaphoreHandle;
+        signalInfo.value = inValue;
+        vkSignalSemaphore(m_Device.GetDevice(), &signalInfo);
+    }
+}
+
+uint64_t VulkanTimelineFence::GetCompletedValue()
+{
+    uint64_t value = 0;
+    if(IsValid())
+    {
+        vkGetSemaphoreCounterValue(m_Device.GetDevice(), m_SemaphoreHandle, &value);
+    }
+    return value;
+}
+
+bool VulkanTimelineFence::Wait(uint64_t inValue, uint64_t inTimeoutMs)
+{
+    if(!IsValid())
+    {
+        return false;
+    }
+
+    VkSemaphoreWaitInfo waitInfo{};
+    waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+    waitInfo.semaphoreCount = 1;
+    waitInfo.pSemaphores = &m_SemaphoreHandle;
+    waitInfo.pValues = &inValue;
+    const uint64_t timeout = inTimeoutMs >= UINT64_MAX / 1000000 ? UINT64_MAX : inTimeoutMs * 1000000;
+    return vkWaitSemaphores(m_Device.GetDevice(), &waitInfo, timeout) == VK_SUCCESS;
+}
+
+void VulkanTimelineFence::ShutdownInternal()
+{
+    if(m_SemaphoreHandle != VK_NULL_HANDLE)
+    {
+        vkDestroySemaphore(m_Device.GetDevice(), m_SemaphoreHandle, nullptr);
+        m_SemaphoreHandle = VK_NULL_HANDLE;
+    }
+}
+
+void VulkanTimelineFence::SetNameInternal()
+{
+    if(IsValid())
+    {
+        m_Device.SetDebugName(VK_OBJECT_TYPE_SEMAPHORE, reinterpret_cast<uint64_t>(m_SemaphoreHandle), m_Name);
+    }
+}
+
 VulkanSemaphore::VulkanSemaphore(VulkanDevice& inDevice)
     : m_Device(inDevice)
     , m_SemaphoreHandle(VK_NULL_HANDLE)
@@ -3,9 +3,12 @@
 #include "../RHIResources.h"
 #include "../RHIDevice.h"
 #include "VulkanDefinitions.h"
+#include <memory>
 
 class VulkanBuffer;
 class VulkanTexture;
+class VulkanDescriptorAllocator;
+struct VulkanTransientDescriptorPool;
 
 class VulkanFence : public RHIFence
 {
@@ -16,6 +19,7 @@ public:
     bool IsValid() const override;
     void Reset() override;
     void CpuWait() override;
+    bool IsCompleted() override;
 
     VkFence GetFence() const { return m_FenceHandle; }
 
@@ -31,6 +35,33 @@ private:
     VkFence m_FenceHandle;
 };
 
+// A timeline semaphore, core since Vulkan 1.2
+class VulkanTimelineFence : public RHITimelineFence
+{
+public:
+    ~VulkanTimelineFence() override;
+    bool Init() override;
+    void Shutdown() override;
+    bool IsValid() const override;
+    void Signal(uint64_t inValue) override;
+    uint64_t GetCompletedValue() override;
+    bool Wait(uint64_t inValue, uint64_t inTimeoutMs = UINT64_MAX) override;
+
+    VkSemaphore GetSemaphore() const { return m_SemaphoreHandle; }
+
+protected:
+    void SetNameInternal() override;
+
+private:
+    friend class VulkanDevice;
+    VulkanTimelineFence(VulkanDevice& inDevice, uint64_t inInitialValue);
+    void ShutdownInternal();
+
+    VulkanDevice& m_Device;
+    VkSemaphore m_SemaphoreHandle;
+    uint64_t m_InitialValue;
+};
+
 class VulkanSemaphore : public RHISemaphore
 {
 public:
@@ -64,6 +95,7 @@ public:
     
     RefCountPtr<RHIFence>       CreateRhiFence() override;
     RefCountPtr<RHISemaphore>   CreateRhiSemaphore() override;
+    RefCountPtr<RHITimelineFence> CreateTimelineFence(uint64_t inInitialValue = 0) override;
     RefCountPtr<RHICommandList> CreateCommandList(ERHICommandQueueType inType = ERHICommandQueueType::Direct) override;
     RefCountPtr<RHIPipelineBindingLayout> CreatePipelineBindingLayout(const RHIPipelineBindingLayoutDesc& inBindingItems) override;
     RefCountPtr<RHIShader> CreateShader(ERHIShaderType inType) override;
@@ -78,13 +110,23 @@ public:
     RefCountPtr<RHIAccelerationStructure> CreateBottomLevelAccelerationStructure(const std::vector<RHIRayTracingGeometryDesc>& inDesc) override;
     RefCountPtr<RHIAccelerationStructure> CreateTopLevelAccelerationStructure(const std::vector<RHIRayTracingInstanceDesc>& inDesc) override;
     RefCountPtr<RHIFrameBuffer> CreateFrameBuffer(const RHIFrameBufferDesc& inDesc) override;
-    RefCountPtr<RHIResourceSet> CreateResourceSet(const RHIPipelineBindingLayout* inLayout) override;
+    RefCountPtr<RHIResourceSet> CreateResourceSet(const RHIPipelineBindingLayout* inLayout, bool inIsDynamic = false) override;
 
     void AddQueueWaitForSemaphore(ERHICommandQueueType inType, RefCountPtr<RHISemaphore>& inSemaphore) override;
     void AddQueueSignalSemaphore(ERHICommandQueueType inType, RefCountPtr<RHISemaphore>& inSemaphore) override;
     void AddQueueWaitForSemaphore(ERHICommandQueueType inType, RefCountPtr<VulkanSemaphore>& inSemaphore);
     void AddQueueSignalSemaphore(ERHICommandQueueType inType, RefCountPtr<VulkanSemaphore>& inSemaphore);
-    void ExecuteCommandList(const RefCountPtr<RHICommandList>& inCommandList, const RefCountPtr<RHIFence>& inSignalFence = nullptr) override;
+    void AddQueueWaitForFence(ERHICommandQueueType inType, RefCountPtr<RHITimelineFence>& inFence, uint64_t inValue) override;
+    void AddQueueSignalFence(ERHICommandQueueType inType, RefCountPtr<RHITimelineFence>& inFence, uint64_t inValue) override;
+    void ExecuteCommandLists(const RefCountPtr<RHICommandList>* inCommandLists, uint32_t inCount
+        , const RHIQueueFenceValue* inWaitFences = nullptr, uint32_t inNumWaitFences = 0
+        , const RHIQueueFenceValue* inSignalFences = nullptr, uint32_t inNumSignalFences = 0
+        , const RefCountPtr<RHIFence>& inSignalFence = nullptr) override;
+    bool QueryMemoryBudget(RHIMemoryBudget& outBudget) override;
+    bool EvictObjects(const RHIResidencyObject* inObjects, uint32_t inCount) override;
+    bool MakeObjectsResident(const RHIResidencyObject* inObjects, uint32_t inCount) override;
+    bool InitBindlessTable(uint32_t inNumResources, uint32_t inNumSamplers) override;
+    bool WriteBindlessDescriptor(uint32_t inIndex, const RHIBindlessDescriptor& inDescriptor) override;
 
     RefCountPtr<VulkanFence> CreateVulkanFence();
     RefCountPtr<VulkanSemaphore> CreateVulkanSemaphore();
@@ -92,20 +134,31 @@ public:
     void BeginDebugMarker(const char* name, VkCommandBuffer cmdBuffer) const;
     void EndDebugMarker(VkCommandBuffer cmdBuffer) const;
     ERHIBackend GetBackend() const override { return ERHIBackend::Vulkan; }
+    uint32_t GetTextureDataPitchAlignment() const override { return 1; }
     VkInstance GetInstance() const { return m_InstanceHandle; }
     VkPhysicalDevice GetPhysicalDevice() const { return m_PhysicalDeviceHandle; }
     VkDevice GetDevice() const { return m_DeviceHandle; }
-    VkDescriptorPool GetDescriptorPool() const { return m_DescriptorPoolHandle; }
+    VulkanDescriptorAllocator& GetDescriptorAllocator() { return *m_DescriptorAllocator; }
+    // The set of RHIBindlessTable, bound after the sets of the layouts with UseBindlessTable
+    VkDescriptorSetLayout GetBindlessSetLayout() const { return m_BindlessSetLayout; }
+    VkDescriptorSet GetBindlessDescriptorSet() const { return m_BindlessDescriptorSet; }
+    VkPipelineCache GetPipelineCacheHandle() const { return m_PipelineCacheHandle; }
     uint32_t GetQueueFamilyIndex(ERHICommandQueueType type) const {return m_QueueIndex[static_cast<uint32_t>(type)]; }
     VkQueue GetCommandQueue(ERHICommandQueueType type) const {return m_QueueHandles[static_cast<uint32_t>(type)]; }
     bool GetMemoryTypeIndex(uint32_t inTypeFilter, VkMemoryPropertyFlags inProperties, uint32_t& outMemTypeIndex) const;
     bool SupportBufferDeviceAddress() const {return m_SupportBufferDeviceAddress;}
     bool SupportVariableRateShading() const {return m_SupportVariableRateShading; }
+    bool SupportTimelineSemaphore() const {return m_SupportTimelineSemaphore; }
+    bool SupportMemoryBudget() const {return m_SupportMemoryBudget; }
+    bool SupportMeshShading() const {return m_SupportMeshShading; }
+    bool SupportDrawIndirectCount() const {return m_SupportDrawIndirectCount; }
+    uint32_t GetMaxUniformBufferRange() const { return m_PhysicalDeviceProperties.limits.maxUniformBufferRange; }
 
     PFN_vkSetDebugUtilsObjectNameEXT                vkSetDebugUtilsObjectNameEXT;
     PFN_vkGetBufferDeviceAddressKHR                 vkGetBufferDeviceAddressKHR;
     PFN_vkCmdDrawMeshTasksEXT                       vkCmdDrawMeshTasksEXT;
     PFN_vkCmdDrawMeshTasksIndirectEXT               vkCmdDrawMeshTasksIndirectEXT;
+    PFN_vkCmdDrawMeshTasksIndirectCountEXT          vkCmdDrawMeshTasksIndirectCountEXT;
     PFN_vkCreateAccelerationStructureKHR            vkCreateAccelerationStructureKHR;
     PFN_vkDestroyAccelerationStructureKHR           vkDestroyAccelerationStructureKHR;
     PFN_vkGetAccelerationStructureBuildSizesKHR     vkGetAccelerationStructureBuildSizesKHR;
@@ -118,13 +171,22 @@ public:
 
     PFN_vkCmdDebugMarkerBeginEXT                    vkCmdDebugMarkerBeginEXT;
     PFN_vkCmdDebugMarkerEndEXT                      vkCmdDebugMarkerEndEXT;
+
+    // The bindings of the bindless set, the buffer SRVs and UAVs share the storage buffers
+    static constexpr uint32_t s_BindlessSampledImageBinding = 0;
+    static constexpr uint32_t s_BindlessStorageImageBinding = 1;
+    static constexpr uint32_t s_BindlessStorageBufferBinding = 2;
+    static constexpr uint32_t s_BindlessSamplerBinding = 3;
     
 private:
-    friend bool RHI::Init(bool useVulkan);
+    friend bool RHI::Init(ERHIBackend inBackend);
     VulkanDevice();
     void ShutdownInternal();
     void EnableDeviceExtensions(VkPhysicalDeviceFeatures2& deviceFeatures2);
-    bool InitDescriptorPool();
+    void ShutdownBindlessTable();
+    void InitPipelineCache();
+    void SavePipelineCache();
+    RHIPipelineCacheDeviceId GetPipelineCacheDeviceId() const;
     void AddQueueWaitForSemaphore(ERHICommandQueueType inType, VkSemaphore inSemaphore);
     void AddQueueSignalSemaphore(ERHICommandQueueType inType, VkSemaphore inSemaphore);
 
@@ -151,9 +213,25 @@ private:
     bool m_SupportRayTracing {false};
     bool m_SupportMeshShading {false};
     bool m_SupportVariableRateShading {false};
+    bool m_SupportTimelineSemaphore {false};
+    bool m_SupportMemoryBudget {false};
+    bool m_SupportDrawIndirectCount {false};
 
-    VkDescriptorPool    m_DescriptorPoolHandle;
+    std::unique_ptr<VulkanDescriptorAllocator> m_DescriptorAllocator;
+    VkDescriptorPool    m_BindlessDescriptorPool;
+    VkDescriptorSetLayout m_BindlessSetLayout;
+    VkDescriptorSet     m_BindlessDescriptorSet;
+    VkPipelineCache     m_PipelineCacheHandle;
 
     std::array<std::vector<VkSemaphore>, COMMAND_QUEUES_COUNT> m_WaitForSemaphores;
     std::array<std::vector<VkSemaphore>, COMMAND_QUEUES_COUNT> m_SignalSemaphores;
+
+    struct QueueFenceValue
+    {
+        RefCountPtr<VulkanTimelineFence> Fence;
+        uint64_t Value;
+    };
+    std::array<std::vector<QueueFenceValue>, COMMAND_QUEUES_COUNT> m_WaitForFences;
+    std::array<std::vector<QueueFenceValue>, COMMAND_QUEUES_COUNT> m_SignalFences;
+    std::vector<VulkanTransientDescriptorPool*> m_SubmittedTransientPools;
 };
\ No newline at end of file
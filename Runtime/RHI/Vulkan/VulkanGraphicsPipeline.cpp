@@ -6,12 +6,15 @@
 
 RefCountPtr<RHIGraphicsPipeline> VulkanDevice::CreatePipeline(const RHIGraphicsPipelineDesc& inDesc)
 {
-    RefCountPtr<RHIGraphicsPipeline> pipeline(new VulkanGraphicsPipeline(*this, inDesc));
-    if(!pipeline->Init())
+    return m_PipelineCache.FindOrCreate(inDesc, [this](const RHIGraphicsPipelineDesc& inCreateDesc)
     {
-        Log::Error("[Vulkan] Failed to create graphics pipeline");
-    }
-    return pipeline;
+        RefCountPtr<RHIGraphicsPipeline> pipeline(new VulkanGraphicsPipeline(*this, inCreateDesc));
+        if(!pipeline->Init())
+        {
+            Log::Error("[Vulkan] Failed to create graphics pipeline");
+        }
+        return pipeline;
+    });
 }
 
 VulkanGraphicsPipeline::VulkanGraphicsPipeline(VulkanDevice& inDevice, const RHIGraphicsPipelineDesc& inDesc)
@@ -220,7 +223,7 @@ bool VulkanGraphicsPipeline::Init()
     multisampling.rasterizationSamples = RHI::Vulkan::ConvertSampleBits(m_Desc.SampleCount);
     pipelineInfo.pMultisampleState = &multisampling;
 
-    VkResult result = vkCreateGraphicsPipelines(m_Device.GetDevice(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &m_PipelineState);
+    VkResult result = vkCreateGraphicsPipelines(m_Device.GetDevice(), m_Device.GetPipelineCacheHandle(), 1, &pipelineInfo, nullptr, &m_PipelineState);
     if(result != VK_SUCCESS)
     {
         OUTPUT_VULKAN_FAILED_RESULT(result)
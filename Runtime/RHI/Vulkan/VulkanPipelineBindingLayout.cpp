@@ -3,21 +3,26 @@
 #include "VulkanResources.h"
 #include "../../Core/Log.h"
 #include <map>
+#include <algorithm>
 
 RefCountPtr<RHIPipelineBindingLayout> VulkanDevice::CreatePipelineBindingLayout(const RHIPipelineBindingLayoutDesc& inBindingItems)
 {
-    RefCountPtr<RHIPipelineBindingLayout> layout(new VulkanPipelineBindingLayout(*this, inBindingItems));
-    if(!layout->Init())
+    return m_StateCache.FindOrCreate(inBindingItems, [this](const RHIPipelineBindingLayoutDesc& inDesc)
     {
-        Log::Error("[Vulkan] Failed to create pipeline binding layout");
-    }
-    return layout;
+        RefCountPtr<RHIPipelineBindingLayout> layout(new VulkanPipelineBindingLayout(*this, inDesc));
+        if(!layout->Init())
+        {
+            Log::Error("[Vulkan] Failed to create pipeline binding layout");
+        }
+        return layout;
+    });
 }
 
 VulkanPipelineBindingLayout::VulkanPipelineBindingLayout(VulkanDevice& inDevice, const RHIPipelineBindingLayoutDesc& inBindingItems)
     : m_Device(inDevice)
     , m_BindingItems(inBindingItems)
     , m_PipelineLayout(VK_NULL_HANDLE)
+    , m_PushConstantsSize(0)
 {
     
 }
@@ -36,10 +41,23 @@ bool VulkanPipelineBindingLayout::Init()
     }
 
     m_DescriptorSetLayouts.clear();
+    m_DynamicBindings.clear();
+    m_PushConstantsSize = 0;
     
     std::map<uint32_t, std::vector<std::pair<RHIPipelineBindingItem, VkDescriptorSetLayoutBinding>>> descriptorSetLayouts;
     for(const auto& bindingItem : m_BindingItems.Items)
     {
+        // The push constants are a range of the pipeline layout, not a binding of a set
+        if(bindingItem.Type == ERHIBindingResourceType::PushConstants)
+        {
+            if(m_PushConstantsSize > 0)
+            {
+                Log::Error("[Vulkan] A pipeline binding layout holds at most one push constants item");
+                return false;
+            }
+            m_PushConstantsSize = bindingItem.NumResources * sizeof(uint32_t);
+            continue;
+        }
         descriptorSetLayouts[bindingItem.Space].emplace_back(std::make_pair(bindingItem
             , RHI::Vulkan::ConvertBindingLayoutItem(bindingItem)));
     }
@@ -70,7 +88,16 @@ bool VulkanPipelineBindingLayout::Init()
                 bindingFlags[i] = 0;
             }
             vkBindings[i] = descriptorSet.second[i].second;
+
+            // vkCmdBindDescriptorSets takes the dynamic offsets ordered by set and binding
+            if(bindingPair.first.Type == ERHIBindingResourceType::Buffer_CBV && !bindingPair.first.IsBindless
+                && bindingPair.first.NumResources == 1 && m_DynamicBindings.size() < s_DynamicUniformBuffersMaxCount)
+            {
+                vkBindings[i].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+                m_DynamicBindings.emplace_back(descriptorSet.first, vkBindings[i].binding);
+            }
         }
+        std::sort(m_DynamicBindings.begin(), m_DynamicBindings.end());
 
         VkDescriptorSetLayoutBindingFlagsCreateInfoEXT bindingFlagsInfo{};
         bindingFlagsInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO_EXT;
@@ -94,16 +121,36 @@ bool VulkanPipelineBindingLayout::Init()
         m_DescriptorSetLayouts.push_back(layout);
     }
 
-    if(m_DescriptorSetLayouts.empty())
+    if(m_DescriptorSetLayouts.empty() && m_PushConstantsSize == 0 && !m_BindingItems.UseBindlessTable)
     {
         Log::Error("[Vulkan] Failed to create descriptor set layout");
         return false;
     }
 
+    // The device owns the set layout of the bindless table, it follows the sets of the layout
+    std::vector<VkDescriptorSetLayout> pipelineSetLayouts = m_DescriptorSetLayouts;
+    if(m_BindingItems.UseBindlessTable)
+    {
+        RHIBindlessTable& bindlessTable = m_Device.GetBindlessTable();
+        if(!bindlessTable.IsValid() && !bindlessTable.Init())
+        {
+            Log::Error("[Vulkan] Failed to initialize the bindless table of the pipeline binding layout");
+            return false;
+        }
+        pipelineSetLayouts.push_back(m_Device.GetBindlessSetLayout());
+    }
+
+    VkPushConstantRange pushConstantRange{};
+    pushConstantRange.stageFlags = VK_SHADER_STAGE_ALL;
+    pushConstantRange.offset = 0;
+    pushConstantRange.size = m_PushConstantsSize;
+
     VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
     pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-    pipelineLayoutInfo.setLayoutCount = (uint32_t)m_DescriptorSetLayouts.size();
-    pipelineLayoutInfo.pSetLayouts = m_DescriptorSetLayouts.data();
+    pipelineLayoutInfo.setLayoutCount = (uint32_t)pipelineSetLayouts.size();
+    pipelineLayoutInfo.pSetLayouts = pipelineSetLayouts.data();
+    pipelineLayoutInfo.pushConstantRangeCount = m_PushConstantsSize > 0 ? 1 : 0;
+    pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
     VkResult result = vkCreatePipelineLayout(m_Device.GetDevice(), &pipelineLayoutInfo, nullptr, &m_PipelineLayout);
     if(result != VK_SUCCESS)
     {
@@ -114,6 +161,18 @@ bool VulkanPipelineBindingLayout::Init()
     return true;
 }
 
+int32_t VulkanPipelineBindingLayout::FindDynamicOffsetIndex(uint32_t inSpace, uint32_t inBinding) const
+{
+    for(uint32_t i = 0; i < m_DynamicBindings.size(); ++i)
+    {
+        if(m_DynamicBindings[i].first == inSpace && m_DynamicBindings[i].second == inBinding)
+        {
+            return static_cast<int32_t>(i);
+        }
+    }
+    return -1;
+}
+
 void VulkanPipelineBindingLayout::Shutdown()
 {
     ShutdownInternal();
@@ -121,9 +180,7 @@ void VulkanPipelineBindingLayout::Shutdown()
 
 bool VulkanPipelineBindingLayout::IsValid() const
 {
-    bool bValid = m_PipelineLayout != VK_NULL_HANDLE;
-    bValid = bValid && !m_DescriptorSetLayouts.empty();
-    return bValid;
+    return m_PipelineLayout != VK_NULL_HANDLE;
 }
 
 void VulkanPipelineBindingLayout::ShutdownInternal()
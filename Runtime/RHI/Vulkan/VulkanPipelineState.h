@@ -21,6 +21,16 @@ public:
     uint32_t GetDescriptorSetLayoutCount() const { return static_cast<uint32_t>(m_DescriptorSetLayouts.size()); }
     VkPipelineLayout GetPipelineLayout() const { return m_PipelineLayout; }
 
+    // The single constant buffers are dynamic uniform buffers, in the order of their dynamic offsets
+    int32_t FindDynamicOffsetIndex(uint32_t inSpace, uint32_t inBinding) const;
+    uint32_t GetDynamicOffsetCount() const { return static_cast<uint32_t>(m_DynamicBindings.size()); }
+
+    // The bindless set is bound at the index GetDescriptorSetLayoutCount()
+    bool UsesBindlessTable() const { return m_BindingItems.UseBindlessTable; }
+    uint32_t GetPushConstantsSize() const { return m_PushConstantsSize; }
+
+    constexpr static uint32_t s_DynamicUniformBuffersMaxCount = 8; // the minimum maxDescriptorSetUniformBuffersDynamic
+
 protected:
     void SetNameInternal() override;
 
@@ -33,6 +43,8 @@ private:
     RHIPipelineBindingLayoutDesc m_BindingItems;
     std::vector<VkDescriptorSetLayout> m_DescriptorSetLayouts;
     VkPipelineLayout m_PipelineLayout;
+    std::vector<std::pair<uint32_t, uint32_t>> m_DynamicBindings; // space and binding, sorted like the dynamic offsets
+    uint32_t m_PushConstantsSize; // in bytes
 };
 
 ///////////////////////////////////////////////////////////////////////////////////
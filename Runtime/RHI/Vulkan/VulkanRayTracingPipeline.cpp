@@ -169,7 +169,7 @@ bool VulkanRayTracingPipeline::Init()
     pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
     pipelineInfo.basePipelineIndex = -1;
 
-    VkResult result = m_Device.vkCreateRayTracingPipelinesKHR(m_Device.GetDevice(), VK_NULL_HANDLE, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &m_PipelineState);
+    VkResult result = m_Device.vkCreateRayTracingPipelinesKHR(m_Device.GetDevice(), VK_NULL_HANDLE, m_Device.GetPipelineCacheHandle(), 1, &pipelineInfo, nullptr, &m_PipelineState);
     if(result != VK_SUCCESS)
     {
         OUTPUT_VULKAN_FAILED_RESULT(result)
@@ -74,7 +74,7 @@ bool VulkanResourceHeap::Init()
     }
 
     m_TotalChunkNum = static_cast<uint32_t>(m_Desc.Size / m_Desc.Alignment);
-    m_MemAllocator.SetTotalCount(m_TotalChunkNum);
+    m_MemAllocator.SetTotalSize(m_Desc.Size);
 
     return true;
 }
@@ -86,6 +86,8 @@ void VulkanResourceHeap::Shutdown()
 
 void VulkanResourceHeap::ShutdownInternal()
 {
+    // Tracked objects are made resident again before they are released
+    m_Device.GetResidencyManager().Untrack(this);
     if(m_HeapHandle != VK_NULL_HANDLE)
     {
         vkFreeMemory(m_Device.GetDevice(), m_HeapHandle, nullptr);
@@ -106,7 +108,7 @@ void VulkanResourceHeap::SetNameInternal()
     }
 }
 
-bool VulkanResourceHeap::TryAllocate(size_t inSize, size_t& outOffset)
+bool VulkanResourceHeap::TryAllocate(size_t inSize, size_t inAlignment, size_t& outOffset)
 {
     if(!IsValid())
     {
@@ -114,12 +116,10 @@ bool VulkanResourceHeap::TryAllocate(size_t inSize, size_t& outOffset)
         return false;
     }
 
-    uint32_t chunks = static_cast<uint32_t>(Align(inSize, m_Desc.Alignment) / m_Desc.Alignment);
-    uint32_t offsetChunks = 0;
-
-    if(m_MemAllocator.TryAllocate(chunks, offsetChunks))
+    uint64_t offset = 0;
+    if(m_MemAllocator.TryAllocate(inSize, std::max<uint64_t>(inAlignment, 1), offset))
     {
-        outOffset = m_Desc.Alignment * offsetChunks;
+        outOffset = static_cast<size_t>(offset);
         return true;
     }
 
@@ -127,18 +127,25 @@ bool VulkanResourceHeap::TryAllocate(size_t inSize, size_t& outOffset)
     return false;   
 }
 
+bool VulkanResourceHeap::CanAllocate(size_t inSize, size_t inAlignment) const
+{
+    return IsValid() && m_MemAllocator.CanAllocate(inSize, std::max<uint64_t>(inAlignment, 1));
+}
+
 void VulkanResourceHeap::Free(size_t inOffset, size_t inSize)
 {
-    if(inOffset % m_Desc.Alignment != 0)
+    m_MemAllocator.Free(inOffset);
+}
+
+void VulkanResourceHeap::GetFreeRanges(std::vector<RHIMemoryRange>& outRanges) const
+{
+    std::vector<TlsfAllocator::Range> ranges;
+    m_MemAllocator.GetFreeRanges(ranges);
+    outRanges.clear();
+    for(const TlsfAllocator::Range& range : ranges)
     {
-        Log::Error("[Vulkan] Free offset is not aligned to the heap's alignment: %d", m_Desc.Alignment);
-        return;
+        outRanges.push_back({range.Offset, range.Size});
     }
-    
-    uint32_t offsetChunks = static_cast<uint32_t>(inOffset / m_Desc.Alignment);
-    uint32_t chunks = static_cast<uint32_t>(Align(inSize, m_Desc.Alignment) / m_Desc.Alignment);
-
-    m_MemAllocator.Free(offsetChunks, chunks);
 }
 
 bool VulkanResourceHeap::IsEmpty() const
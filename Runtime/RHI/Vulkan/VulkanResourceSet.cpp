@@ -1,12 +1,14 @@
 #include "VulkanDevice.h"
 #include "VulkanResources.h"
 #include "VulkanPipelineState.h"
+#include "VulkanDescriptorAllocator.h"
 #include "../../Core/Log.h"
 #include "../../Core/Templates.h"
+#include "../../Core/CityHash.h"
 
-RefCountPtr<RHIResourceSet> VulkanDevice::CreateResourceSet(const RHIPipelineBindingLayout* inLayout)
+RefCountPtr<RHIResourceSet> VulkanDevice::CreateResourceSet(const RHIPipelineBindingLayout* inLayout, bool inIsDynamic)
 {
-    RefCountPtr<RHIResourceSet> resourceSet(new VulkanResourceSet(*this, inLayout));
+    RefCountPtr<RHIResourceSet> resourceSet(new VulkanResourceSet(*this, inLayout, inIsDynamic));
     if(!resourceSet->Init())
     {
         Log::Error("[Vulkan] Failed to create resource set");
@@ -14,10 +16,11 @@ RefCountPtr<RHIResourceSet> VulkanDevice::CreateResourceSet(const RHIPipelineBin
     return resourceSet;
 }
 
-VulkanResourceSet::VulkanResourceSet(VulkanDevice& inDevice, const RHIPipelineBindingLayout* inLayout)
+VulkanResourceSet::VulkanResourceSet(VulkanDevice& inDevice, const RHIPipelineBindingLayout* inLayout, bool inIsDynamic)
     : m_Device(inDevice)
     , m_Layout(inLayout)
     , m_LayoutVulkan(nullptr)
+    , m_IsDynamic(inIsDynamic)
 {
     
 }
@@ -37,43 +40,38 @@ bool VulkanResourceSet::Init()
     }
 
     const RHIPipelineBindingLayoutDesc& rhiLayoutDesc = m_LayoutVulkan->GetDesc();
+    const uint32_t numSets = m_LayoutVulkan->GetDescriptorSetLayoutCount();
 
-    std::unordered_map<uint32_t, std::vector<uint32_t>> bindlessDescriptorsCount;
-    
-    
+    // A set layout has at most one variable sized binding, its last one
+    m_VariableDescriptorCounts.assign(numSets, 0);
     for(const auto& bindingItem : rhiLayoutDesc.Items)
     {
-        if(bindingItem.IsBindless)
+        if(bindingItem.IsBindless && bindingItem.Space < numSets)
         {
-            bindlessDescriptorsCount[bindingItem.Space].emplace_back(bindingItem.NumResources);
+            m_VariableDescriptorCounts[bindingItem.Space] = bindingItem.NumResources;
         }
     }
 
-    m_DescriptorSet.resize(m_LayoutVulkan->GetDescriptorSetLayoutCount());
-
-    const VkDescriptorSetLayout* layouts = m_LayoutVulkan->GetDescriptorSetLayouts();
+    m_DescriptorSet.assign(numSets, VK_NULL_HANDLE);
+    m_DescriptorPools.assign(numSets, VK_NULL_HANDLE);
+    m_DynamicOffsets.assign(m_LayoutVulkan->GetDynamicOffsetCount(), 0);
+    m_DynamicDescriptors.assign(m_LayoutVulkan->GetDynamicOffsetCount(), VkDescriptorBufferInfo{});
+    m_IsOverflowBinding.assign(m_LayoutVulkan->GetDynamicOffsetCount(), false);
+    m_NumSpaceOverflowBindings.assign(numSets, 0);
+    m_NumOverflowBindings = 0;
+    m_DynamicWrites.assign(numSets, {});
+    m_DynamicSetKeys.assign(numSets, {});
+    m_DynamicSetHashes.assign(numSets, 0);
+    m_DynamicSetHashValid.assign(numSets, false);
+
+    if(m_IsDynamic)
+    {
+        return true;
+    }
 
-    for(uint32_t i = 0; i < m_LayoutVulkan->GetDescriptorSetLayoutCount(); ++i)
+    for(uint32_t i = 0; i < numSets; ++i)
     {
-        bool hasBindless = false;
-        VkDescriptorSetVariableDescriptorCountAllocateInfoEXT variableDescriptorCountAllocInfo{};
-        if(bindlessDescriptorsCount.find(i) != bindlessDescriptorsCount.end())
-        {
-            variableDescriptorCountAllocInfo.sType              = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_VARIABLE_DESCRIPTOR_COUNT_ALLOCATE_INFO_EXT;
-            variableDescriptorCountAllocInfo.descriptorSetCount = (uint32_t)bindlessDescriptorsCount[i].size();
-            variableDescriptorCountAllocInfo.pDescriptorCounts  = bindlessDescriptorsCount[i].data();
-            hasBindless = true;
-        }
-        
-        VkDescriptorSetAllocateInfo allocateInfo{};
-        allocateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-        allocateInfo.descriptorPool = m_Device.GetDescriptorPool();
-        allocateInfo.descriptorSetCount = 1;
-        allocateInfo.pSetLayouts = &layouts[i];
-        allocateInfo.pNext = hasBindless ? &variableDescriptorCountAllocInfo : nullptr;
-
-        VkResult result = vkAllocateDescriptorSets(m_Device.GetDevice(), &allocateInfo, &m_DescriptorSet[i]);
-        if(result != VK_SUCCESS)
+        if(!m_Device.GetDescriptorAllocator().Allocate(GetDescriptorSetLayout(i), m_VariableDescriptorCounts[i], m_DescriptorSet[i], m_DescriptorPools[i]))
         {
             Log::Error("[Vulkan] Failed to allocate descriptor sets");
             return false;
@@ -95,11 +93,237 @@ bool VulkanResourceSet::IsValid() const
 
 void VulkanResourceSet::ShutdownInternal()
 {
-    if(!m_DescriptorSet.empty())
+    m_PendingWrites.clear();
+    m_PendingImageInfos.clear();
+    m_PendingBufferInfos.clear();
+    m_PendingAccelerationStructures.clear();
+    m_DynamicWrites.clear();
+    m_DynamicSetKeys.clear();
+    m_DynamicSetHashes.clear();
+    m_DynamicSetHashValid.clear();
+    m_IsOverflowBinding.clear();
+    m_NumSpaceOverflowBindings.clear();
+    m_NumOverflowBindings = 0;
+    for(uint32_t i = 0; i < m_DescriptorSet.size(); ++i)
+    {
+        if(m_DescriptorSet[i] != VK_NULL_HANDLE)
+        {
+            m_Device.GetDescriptorAllocator().Free(m_DescriptorPools[i], m_DescriptorSet[i]);
+        }
+    }
+    m_DescriptorSet.clear();
+    m_DescriptorPools.clear();
+}
+
+VkDescriptorSetLayout VulkanResourceSet::GetDescriptorSetLayout(uint32_t inSpace) const
+{
+    return m_LayoutVulkan->GetDescriptorSetLayouts()[inSpace];
+}
+
+// Copies the infos the write points to, they are patched back in by FlushDescriptorWrites
+void VulkanResourceSet::AddPendingWrite(uint32_t inSpace, const VkWriteDescriptorSet& inWrite)
+{
+    SetDynamicWrite(inSpace, inWrite);
+    if(m_IsDynamic)
+    {
+        return;
+    }
+    
+    PendingWrite pending;
+    pending.Write = inWrite;
+    pending.Write.pNext = nullptr;
+    pending.Write.pImageInfo = nullptr;
+    pending.Write.pBufferInfo = nullptr;
+    if(inWrite.descriptorType == VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR)
+    {
+        const auto* accelerationStructureInfo = static_cast<const VkWriteDescriptorSetAccelerationStructureKHR*>(inWrite.pNext);
+        pending.InfoOffset = m_PendingAccelerationStructures.size();
+        m_PendingAccelerationStructures.insert(m_PendingAccelerationStructures.end(), accelerationStructureInfo->pAccelerationStructures
+            , accelerationStructureInfo->pAccelerationStructures + accelerationStructureInfo->accelerationStructureCount);
+    }
+    else if(inWrite.pImageInfo != nullptr)
+    {
+        pending.InfoOffset = m_PendingImageInfos.size();
+        m_PendingImageInfos.insert(m_PendingImageInfos.end(), inWrite.pImageInfo, inWrite.pImageInfo + inWrite.descriptorCount);
+    }
+    else
+    {
+        pending.InfoOffset = m_PendingBufferInfos.size();
+        m_PendingBufferInfos.insert(m_PendingBufferInfos.end(), inWrite.pBufferInfo, inWrite.pBufferInfo + inWrite.descriptorCount);
+    }
+    m_PendingWrites.push_back(pending);
+}
+
+// Keeps the bindings of the space, the transient sets of the dynamic and the overflow bindings are written from them
+void VulkanResourceSet::SetDynamicWrite(uint32_t inSpace, const VkWriteDescriptorSet& inWrite)
+{
+    DynamicWrite& dynamicWrite = m_DynamicWrites[inSpace][inWrite.dstBinding];
+    dynamicWrite.Write = inWrite;
+    dynamicWrite.Write.pNext = nullptr;
+    dynamicWrite.Write.dstSet = VK_NULL_HANDLE;
+    dynamicWrite.Write.pImageInfo = nullptr;
+    dynamicWrite.Write.pBufferInfo = nullptr;
+    dynamicWrite.ImageInfos.clear();
+    dynamicWrite.BufferInfos.clear();
+    dynamicWrite.AccelerationStructures.clear();
+    if(inWrite.descriptorType == VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR)
+    {
+        const auto* accelerationStructureInfo = static_cast<const VkWriteDescriptorSetAccelerationStructureKHR*>(inWrite.pNext);
+        dynamicWrite.AccelerationStructures.assign(accelerationStructureInfo->pAccelerationStructures
+            , accelerationStructureInfo->pAccelerationStructures + accelerationStructureInfo->accelerationStructureCount);
+    }
+    else if(inWrite.pImageInfo != nullptr)
+    {
+        dynamicWrite.ImageInfos.assign(inWrite.pImageInfo, inWrite.pImageInfo + inWrite.descriptorCount);
+    }
+    else
+    {
+        dynamicWrite.BufferInfos.assign(inWrite.pBufferInfo, inWrite.pBufferInfo + inWrite.descriptorCount);
+    }
+    m_DynamicSetHashValid[inSpace] = false;
+}
+
+void VulkanResourceSet::SetOverflowBinding(uint32_t inSpace, int32_t inDynamicIndex, bool inIsOverflow)
+{
+    if(m_IsOverflowBinding[inDynamicIndex] == inIsOverflow)
+    {
+        return;
+    }
+    m_IsOverflowBinding[inDynamicIndex] = inIsOverflow;
+    if(inIsOverflow)
+    {
+        ++m_NumSpaceOverflowBindings[inSpace];
+        ++m_NumOverflowBindings;
+    }
+    else
+    {
+        --m_NumSpaceOverflowBindings[inSpace];
+        --m_NumOverflowBindings;
+    }
+}
+
+// vkUpdateDescriptorSets applies the writes in array order, a later bind of the same binding wins
+void VulkanResourceSet::FlushDescriptorWrites()
+{
+    if(m_PendingWrites.empty())
+    {
+        return;
+    }
+
+    std::vector<VkWriteDescriptorSet> writes(m_PendingWrites.size());
+    std::vector<VkWriteDescriptorSetAccelerationStructureKHR> accelerationStructureInfos;
+    accelerationStructureInfos.reserve(m_PendingWrites.size()); // the writes point into it
+    for(size_t i = 0; i < m_PendingWrites.size(); ++i)
+    {
+        const PendingWrite& pending = m_PendingWrites[i];
+        writes[i] = pending.Write;
+        if(pending.Write.descriptorType == VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR)
+        {
+            VkWriteDescriptorSetAccelerationStructureKHR accelerationStructureInfo{};
+            accelerationStructureInfo.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET_ACCELERATION_STRUCTURE_KHR;
+            accelerationStructureInfo.accelerationStructureCount = pending.Write.descriptorCount;
+            accelerationStructureInfo.pAccelerationStructures = &m_PendingAccelerationStructures[pending.InfoOffset];
+            accelerationStructureInfos.push_back(accelerationStructureInfo);
+            writes[i].pNext = &accelerationStructureInfos.back();
+        }
+        else if(pending.Write.descriptorType == VK_DESCRIPTOR_TYPE_SAMPLER || pending.Write.descriptorType == VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE
+            || pending.Write.descriptorType == VK_DESCRIPTOR_TYPE_STORAGE_IMAGE || pending.Write.descriptorType == VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER)
+        {
+            writes[i].pImageInfo = &m_PendingImageInfos[pending.InfoOffset];
+        }
+        else
+        {
+            writes[i].pBufferInfo = &m_PendingBufferInfos[pending.InfoOffset];
+        }
+    }
+    
+    vkUpdateDescriptorSets(m_Device.GetDevice(), static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+    m_PendingWrites.clear();
+    m_PendingImageInfos.clear();
+    m_PendingBufferInfos.clear();
+    m_PendingAccelerationStructures.clear();
+}
+
+// Keys the members instead of the info structs, their padding is not initialized
+const std::vector<uint64_t>& VulkanResourceSet::GetDynamicSetKey(uint32_t inSpace, uint64_t& outHash)
+{
+    std::vector<uint64_t>& key = m_DynamicSetKeys[inSpace];
+    if(m_DynamicSetHashValid[inSpace])
+    {
+        outHash = m_DynamicSetHashes[inSpace];
+        return key;
+    }
+
+    key.clear();
+    key.push_back(reinterpret_cast<uint64_t>(GetDescriptorSetLayout(inSpace)));
+    key.push_back(m_VariableDescriptorCounts[inSpace]);
+    for(const auto& binding : m_DynamicWrites[inSpace])
+    {
+        const DynamicWrite& dynamicWrite = binding.second;
+        key.push_back(dynamicWrite.Write.dstBinding);
+        key.push_back(dynamicWrite.Write.descriptorType);
+        key.push_back(dynamicWrite.Write.descriptorCount);
+        for(const VkDescriptorImageInfo& imageInfo : dynamicWrite.ImageInfos)
+        {
+            key.push_back(reinterpret_cast<uint64_t>(imageInfo.sampler));
+            key.push_back(reinterpret_cast<uint64_t>(imageInfo.imageView));
+            key.push_back(imageInfo.imageLayout);
+        }
+        for(const VkDescriptorBufferInfo& bufferInfo : dynamicWrite.BufferInfos)
+        {
+            key.push_back(reinterpret_cast<uint64_t>(bufferInfo.buffer));
+            key.push_back(bufferInfo.offset);
+            key.push_back(bufferInfo.range);
+        }
+        for(VkAccelerationStructureKHR accelerationStructure : dynamicWrite.AccelerationStructures)
+        {
+            key.push_back(reinterpret_cast<uint64_t>(accelerationStructure));
+        }
+    }
+
+    m_DynamicSetHashes[inSpace] = CityHash64(reinterpret_cast<const char*>(key.data()), key.size() * sizeof(uint64_t));
+    m_DynamicSetHashValid[inSpace] = true;
+    outHash = m_DynamicSetHashes[inSpace];
+    return key;
+}
+
+void VulkanResourceSet::WriteDynamicDescriptorSet(uint32_t inSpace, VkDescriptorSet inDescriptorSet) const
+{
+    const std::map<uint32_t, DynamicWrite>& dynamicWrites = m_DynamicWrites[inSpace];
+    if(dynamicWrites.empty())
     {
-        vkFreeDescriptorSets(m_Device.GetDevice(), m_Device.GetDescriptorPool(), static_cast<uint32_t>(m_DescriptorSet.size()), m_DescriptorSet.data());
-        m_DescriptorSet.clear();
+        return;
+    }
+    
+    std::vector<VkWriteDescriptorSet> writes;
+    std::vector<VkWriteDescriptorSetAccelerationStructureKHR> accelerationStructureInfos;
+    writes.reserve(dynamicWrites.size());
+    accelerationStructureInfos.reserve(dynamicWrites.size()); // the writes point into it
+    for(const auto& binding : dynamicWrites)
+    {
+        const DynamicWrite& dynamicWrite = binding.second;
+        VkWriteDescriptorSet write = dynamicWrite.Write;
+        write.dstSet = inDescriptorSet;
+        if(!dynamicWrite.AccelerationStructures.empty())
+        {
+            VkWriteDescriptorSetAccelerationStructureKHR accelerationStructureInfo{};
+            accelerationStructureInfo.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET_ACCELERATION_STRUCTURE_KHR;
+            accelerationStructureInfo.accelerationStructureCount = static_cast<uint32_t>(dynamicWrite.AccelerationStructures.size());
+            accelerationStructureInfo.pAccelerationStructures = dynamicWrite.AccelerationStructures.data();
+            accelerationStructureInfos.push_back(accelerationStructureInfo);
+            write.pNext = &accelerationStructureInfos.back();
+        }
+        else if(!dynamicWrite.ImageInfos.empty())
+        {
+            write.pImageInfo = dynamicWrite.ImageInfos.data();
+        }
+        else
+        {
+            write.pBufferInfo = dynamicWrite.BufferInfos.data();
+        }
+        writes.push_back(write);
     }
+    vkUpdateDescriptorSets(m_Device.GetDevice(), static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
 }
 
 static ERHIRegisterType ConvertRegisterType(ERHIBindingResourceType inViewType)
@@ -131,9 +355,20 @@ void VulkanResourceSet::BindBuffer(ERHIBindingResourceType inViewType, uint32_t
     descriptorSetWriter.dstSet = m_DescriptorSet[inSpace];
     descriptorSetWriter.dstBinding = RHI::Vulkan::GetBindingSlot(registerType, inRegister);
     descriptorSetWriter.descriptorType = RHI::Vulkan::ConvertDescriptorType(inViewType);
+    if(inViewType == ERHIBindingResourceType::Buffer_CBV)
+    {
+        const int32_t dynamicIndex = m_LayoutVulkan->FindDynamicOffsetIndex(inSpace, descriptorSetWriter.dstBinding);
+        if(dynamicIndex >= 0)
+        {
+            descriptorSetWriter.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+            m_DynamicOffsets[dynamicIndex] = 0;
+            m_DynamicDescriptors[dynamicIndex] = bufferInfo;
+            SetOverflowBinding(inSpace, dynamicIndex, false);
+        }
+    }
     descriptorSetWriter.pBufferInfo = &bufferInfo;
     descriptorSetWriter.descriptorCount = 1;
-    vkUpdateDescriptorSets(m_Device.GetDevice(), 1, &descriptorSetWriter, 0, nullptr);
+    AddPendingWrite(inSpace, descriptorSetWriter);
 }
 
 void VulkanResourceSet::BindBufferArray(ERHIBindingResourceType inViewType, uint32_t inRegister, uint32_t inSpace, const std::vector<RefCountPtr<RHIBuffer>>& inBuffer)
@@ -155,9 +390,20 @@ void VulkanResourceSet::BindBufferArray(ERHIBindingResourceType inViewType, uint
     descriptorSetWriter.dstSet = m_DescriptorSet[inSpace];
     descriptorSetWriter.dstBinding = RHI::Vulkan::GetBindingSlot(registerType, inRegister);
     descriptorSetWriter.descriptorType  = RHI::Vulkan::ConvertDescriptorType(inViewType);
+    if(inViewType == ERHIBindingResourceType::Buffer_CBV)
+    {
+        const int32_t dynamicIndex = m_LayoutVulkan->FindDynamicOffsetIndex(inSpace, descriptorSetWriter.dstBinding);
+        if(dynamicIndex >= 0)
+        {
+            descriptorSetWriter.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+            m_DynamicOffsets[dynamicIndex] = 0;
+            m_DynamicDescriptors[dynamicIndex] = bufferInfos[0];
+            SetOverflowBinding(inSpace, dynamicIndex, false);
+        }
+    }
     descriptorSetWriter.pBufferInfo = bufferInfos.data();
     descriptorSetWriter.descriptorCount = (uint32_t)bufferInfos.size();
-    vkUpdateDescriptorSets(m_Device.GetDevice(), 1, &descriptorSetWriter, 0, nullptr);
+    AddPendingWrite(inSpace, descriptorSetWriter);
 }
 
 void VulkanResourceSet::BindTexture(ERHIBindingResourceType inViewType, uint32_t inRegister, uint32_t inSpace, const RefCountPtr<RHITexture>& inTexture)
@@ -172,7 +418,7 @@ void VulkanResourceSet::BindTexture(ERHIBindingResourceType inViewType, uint32_t
     descriptorSetWriter.descriptorType  = RHI::Vulkan::ConvertDescriptorType(inViewType);
     descriptorSetWriter.pImageInfo = &imageInfo;
     descriptorSetWriter.descriptorCount = 1;
-    vkUpdateDescriptorSets(m_Device.GetDevice(), 1, &descriptorSetWriter, 0, nullptr);
+    AddPendingWrite(inSpace, descriptorSetWriter);
 }
 
 void VulkanResourceSet::BindTextureArray(ERHIBindingResourceType inViewType, uint32_t inRegister, uint32_t inSpace, const std::vector<RefCountPtr<RHITexture>>& inTexture)
@@ -196,7 +442,7 @@ void VulkanResourceSet::BindTextureArray(ERHIBindingResourceType inViewType, uin
     descriptorSetWriter.descriptorType  = RHI::Vulkan::ConvertDescriptorType(inViewType);
     descriptorSetWriter.pImageInfo = imageInfos.data();
     descriptorSetWriter.descriptorCount = (uint32_t)imageInfos.size();
-    vkUpdateDescriptorSets(m_Device.GetDevice(), 1, &descriptorSetWriter, 0, nullptr);
+    AddPendingWrite(inSpace, descriptorSetWriter);
 }
 
 void VulkanResourceSet::BindBufferSRV(uint32_t inRegister, uint32_t inSpace, const RefCountPtr<RHIBuffer>& inBuffer)
@@ -214,6 +460,69 @@ void VulkanResourceSet::BindBufferCBV(uint32_t inRegister, uint32_t inSpace, con
     BindBuffer(ERHIBindingResourceType::Buffer_CBV, inRegister, inSpace, inBuffer);
 }
 
+void VulkanResourceSet::BindBufferCBV(uint32_t inRegister, uint32_t inSpace, const RHIConstantAllocation& inAllocation)
+{
+    if(!IsValid() || inAllocation.Buffer == nullptr)
+    {
+        return;
+    }
+
+    const uint32_t binding = RHI::Vulkan::GetBindingSlot(ERHIRegisterType::ConstantBuffer, inRegister);
+    const int32_t dynamicIndex = m_LayoutVulkan->FindDynamicOffsetIndex(inSpace, binding);
+    if(dynamicIndex < 0)
+    {
+        Log::Error("[Vulkan] Constant allocations bind dynamic uniform buffers only, register %u space %u is not one", inRegister, inSpace);
+        return;
+    }
+
+    // Every slice of the allocator buffer is bound with the same range, the padding at its end keeps the range inside
+    const uint64_t maxRange = std::min<uint64_t>(m_Device.GetMaxUniformBufferRange(), RHIConstantAllocator::s_MaxAllocationSize);
+    if(inAllocation.Size > maxRange)
+    {
+        Log::Error("[Vulkan] Constant allocation of %llu bytes exceeds the uniform buffer range of %llu bytes", inAllocation.Size, maxRange);
+        return;
+    }
+
+    VulkanBuffer* buffer = CheckCast<VulkanBuffer*>(inAllocation.Buffer);
+    VkDescriptorBufferInfo bufferInfo{};
+    bufferInfo.buffer = buffer->GetBuffer();
+    bufferInfo.offset = 0;
+    bufferInfo.range = inAllocation.IsOverflow ? inAllocation.Size : maxRange;
+    
+    VkWriteDescriptorSet descriptorSetWriter{};
+    descriptorSetWriter.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    descriptorSetWriter.dstSet = m_DescriptorSet[inSpace];
+    descriptorSetWriter.dstBinding = binding;
+    descriptorSetWriter.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+    descriptorSetWriter.pBufferInfo = &bufferInfo;
+    descriptorSetWriter.descriptorCount = 1;
+
+    if(inAllocation.IsOverflow && !m_IsDynamic)
+    {
+        // An overflow buffer lives for one frame, the persistent set keeps the allocator buffer and the space is
+        // written into a transient set while the overflow slice is bound
+        SetDynamicWrite(inSpace, descriptorSetWriter);
+        SetOverflowBinding(inSpace, dynamicIndex, true);
+        m_DynamicOffsets[dynamicIndex] = 0;
+        return;
+    }
+
+    // Slices of the same buffer only change the dynamic offset. The persistent set is written when the binding is
+    // first bound and after the allocator regrows, which waits for every frame in flight
+    VkDescriptorBufferInfo& currentInfo = m_DynamicDescriptors[dynamicIndex];
+    if(currentInfo.buffer != bufferInfo.buffer || currentInfo.offset != bufferInfo.offset || currentInfo.range != bufferInfo.range)
+    {
+        AddPendingWrite(inSpace, descriptorSetWriter);
+        currentInfo = bufferInfo;
+    }
+    else if(m_IsOverflowBinding[dynamicIndex])
+    {
+        SetDynamicWrite(inSpace, descriptorSetWriter);
+    }
+    SetOverflowBinding(inSpace, dynamicIndex, false);
+    m_DynamicOffsets[dynamicIndex] = static_cast<uint32_t>(inAllocation.Offset);
+}
+
 void VulkanResourceSet::BindTextureSRV(uint32_t inRegister, uint32_t inSpace, const RefCountPtr<RHITexture>& inTexture)
 {
     BindTexture(ERHIBindingResourceType::Texture_SRV, inRegister, inSpace, inTexture);
@@ -262,7 +571,7 @@ void VulkanResourceSet::BindSampler(uint32_t inRegister, uint32_t inSpace, const
     descriptorSetWriter.descriptorType  = VK_DESCRIPTOR_TYPE_SAMPLER;
     descriptorSetWriter.pImageInfo = &samplerInfo;
     descriptorSetWriter.descriptorCount = 1;
-    vkUpdateDescriptorSets(m_Device.GetDevice(), 1, &descriptorSetWriter, 0, nullptr);
+    AddPendingWrite(inSpace, descriptorSetWriter);
 }
 
 void VulkanResourceSet::BindSamplerArray(uint32_t inBaseRegister, uint32_t inSpace, const std::vector<RefCountPtr<RHISampler>>& inSampler)
@@ -286,7 +595,7 @@ void VulkanResourceSet::BindSamplerArray(uint32_t inBaseRegister, uint32_t inSpa
     descriptorSetWriter.descriptorType  = VK_DESCRIPTOR_TYPE_SAMPLER;
     descriptorSetWriter.pImageInfo = samplerInfos.data();
     descriptorSetWriter.descriptorCount = (uint32_t)samplerInfos.size();
-    vkUpdateDescriptorSets(m_Device.GetDevice(), 1, &descriptorSetWriter, 0, nullptr);
+    AddPendingWrite(inSpace, descriptorSetWriter);
 }
 
 void VulkanResourceSet::BindAccelerationStructure(uint32_t inRegister, uint32_t inSpace, const RefCountPtr<RHIAccelerationStructure>& inAccelerationStructure)
@@ -308,6 +617,6 @@ void VulkanResourceSet::BindAccelerationStructure(uint32_t inRegister, uint32_t
         descriptorSetWriter.dstBinding =  RHI::Vulkan::GetBindingSlot(ERHIRegisterType::ShaderResource, inRegister); 
         descriptorSetWriter.descriptorCount = 1;
         descriptorSetWriter.descriptorType = VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR;
-        vkUpdateDescriptorSets(m_Device.GetDevice(), 1, &descriptorSetWriter, 0, nullptr);
+        AddPendingWrite(inSpace, descriptorSetWriter);
     }
 }
\ No newline at end of file
@@ -2,7 +2,8 @@
 
 #include "../RHIResources.h"
 #include "VulkanDefinitions.h"
-#include "../../Core/FreeListAllocator.h"
+#include "../../Core/TlsfAllocator.h"
+#include <map>
 
 
 class VulkanPipelineBindingLayout;
@@ -19,8 +20,11 @@ public:
     void Shutdown() override;
     bool IsValid() const override;
     const RHIResourceHeapDesc& GetDesc() const override {return m_Desc;}
-    bool TryAllocate(size_t inSize, size_t& outOffset) override;
+    bool TryAllocate(size_t inSize, size_t inAlignment, size_t& outOffset) override;
+    bool CanAllocate(size_t inSize, size_t inAlignment) const override;
     void Free(size_t inOffset, size_t inSize) override;
+    size_t GetUsedSize() const override { return m_MemAllocator.GetUsedSize(); }
+    void GetFreeRanges(std::vector<RHIMemoryRange>& outRanges) const override;
     VkDeviceMemory GetHeap() const { return m_HeapHandle; }
     uint32_t GetMemoryTypeIndex() const { return m_MemoryTypeIndex; }
     bool IsEmpty() const override;
@@ -39,7 +43,7 @@ private:
     VkDeviceMemory m_HeapHandle;
     uint32_t m_MemoryTypeIndex;
     uint32_t m_TotalChunkNum;
-    FreeListAllocator m_MemAllocator;
+    TlsfAllocator m_MemAllocator;
 };
 
 ///////////////////////////////////////////////////////////////////////////////////
@@ -61,6 +65,7 @@ public:
     bool IsManaged() const override { return IsManagedBuffer; }
     bool BindMemory(RefCountPtr<RHIResourceHeap> inHeap) override;
     size_t GetOffsetInHeap() const override { return m_OffsetInHeap; }
+    RHIResourceHeap* GetResourceHeap() const override { return m_ResourceHeap.GetReference(); }
     const RHIBufferDesc& GetDesc() const override { return m_Desc; }
     RHIResourceGpuAddress GetGpuAddress() const override;
     uint32_t GetMemTypeFilter()  const override { return m_MemRequirements.memoryTypeBits; }
@@ -120,6 +125,7 @@ public:
     bool BindMemory(RefCountPtr<RHIResourceHeap> inHeap) override;
     const RHITextureDesc& GetDesc() const override { return m_Desc; }
     size_t GetOffsetInHeap() const override { return m_OffsetInHeap; }
+    RHIResourceHeap* GetResourceHeap() const override { return m_ResourceHeap.GetReference(); }
     uint32_t GetMemTypeFilter()  const override { return m_MemRequirements.memoryTypeBits; }
     size_t GetAllocSizeInByte() const override { return m_MemRequirements.size; }
     size_t GetAllocAlignment() const override { return m_MemRequirements.alignment; }
@@ -251,6 +257,7 @@ public:
     void BindBufferSRV(uint32_t inRegister, uint32_t inSpace, const RefCountPtr<RHIBuffer>& inBuffer) override;
     void BindBufferUAV(uint32_t inRegister, uint32_t inSpace, const RefCountPtr<RHIBuffer>& inBuffer) override;
     void BindBufferCBV(uint32_t inRegister, uint32_t inSpace, const RefCountPtr<RHIBuffer>& inBuffer) override;
+    void BindBufferCBV(uint32_t inRegister, uint32_t inSpace, const RHIConstantAllocation& inAllocation) override;
     void BindTextureSRV(uint32_t inRegister, uint32_t inSpace, const RefCountPtr<RHITexture>& inTexture) override;
     void BindTextureUAV(uint32_t inRegister, uint32_t inSpace, const RefCountPtr<RHITexture>& inTexture) override;
     void BindSampler(uint32_t inRegister, uint32_t inSpace, const RefCountPtr<RHISampler>& inSampler) override;
@@ -265,11 +272,31 @@ public:
     const RHIPipelineBindingLayout* GetLayout() const override { return m_Layout; }
     uint32_t GetDescriptorSetsCount() const {return (uint32_t)m_DescriptorSet.size(); }
     const VkDescriptorSet* GetDescriptorSets() const { return m_DescriptorSet.data(); }
+    uint32_t GetDynamicOffsetCount() const { return (uint32_t)m_DynamicOffsets.size(); }
+    const uint32_t* GetDynamicOffsets() const { return m_DynamicOffsets.data(); }
+    // The binds only record the writes, SetResourceSet flushes them with one vkUpdateDescriptorSets
+    void FlushDescriptorWrites();
+
+    // A dynamic set owns no descriptor sets, SetResourceSet writes its bindings into transient sets of the command list
+    bool IsDynamic() const { return m_IsDynamic; }
+    // A space with a constant allocation in an overflow buffer is written into a transient set as well, the set of
+    // the space keeps the view of the constant allocator buffer the command lists in flight may still read
+    bool HasOverflowBindings() const { return m_NumOverflowBindings > 0; }
+    bool IsTransientSpace(uint32_t inSpace) const { return m_IsDynamic || m_NumSpaceOverflowBindings[inSpace] > 0; }
+    VkDescriptorSetLayout GetDescriptorSetLayout(uint32_t inSpace) const;
+    uint32_t GetVariableDescriptorCount(uint32_t inSpace) const { return m_VariableDescriptorCounts[inSpace]; }
+    // Equal keys mean equal layouts and bindings, the transient sets are shared then. outHash is the hash of the key
+    const std::vector<uint64_t>& GetDynamicSetKey(uint32_t inSpace, uint64_t& outHash);
+    void WriteDynamicDescriptorSet(uint32_t inSpace, VkDescriptorSet inDescriptorSet) const;
 
 private:
     friend VulkanDevice;
-    VulkanResourceSet(VulkanDevice& inDevice, const RHIPipelineBindingLayout* inLayout);
+    VulkanResourceSet(VulkanDevice& inDevice, const RHIPipelineBindingLayout* inLayout, bool inIsDynamic);
     void ShutdownInternal();
+    void AddPendingWrite(uint32_t inSpace, const VkWriteDescriptorSet& inWrite);
+    // Keeps the binding for the transient sets without writing the set of the space
+    void SetDynamicWrite(uint32_t inSpace, const VkWriteDescriptorSet& inWrite);
+    void SetOverflowBinding(uint32_t inSpace, int32_t inDynamicIndex, bool inIsOverflow);
     void BindBuffer(ERHIBindingResourceType inViewType, uint32_t inRegister, uint32_t inSpace, const RefCountPtr<RHIBuffer>& inBuffer);
     void BindTexture(ERHIBindingResourceType inViewType, uint32_t inRegister, uint32_t inSpace, const RefCountPtr<RHITexture>& inTexture);
     void BindBufferArray(ERHIBindingResourceType inViewType, uint32_t inRegister, uint32_t inSpace, const std::vector<RefCountPtr<RHIBuffer>>& inBuffer);
@@ -278,5 +305,37 @@ private:
     VulkanDevice& m_Device;
     const RHIPipelineBindingLayout* m_Layout;
     const VulkanPipelineBindingLayout* m_LayoutVulkan;
+    const bool m_IsDynamic;
     std::vector<VkDescriptorSet> m_DescriptorSet;
+    std::vector<VkDescriptorPool> m_DescriptorPools;        // the pools of the descriptor sets
+    std::vector<uint32_t> m_VariableDescriptorCounts;
+    std::vector<uint32_t> m_DynamicOffsets;
+    std::vector<VkDescriptorBufferInfo> m_DynamicDescriptors; // the descriptor is rewritten only if the buffer or range changes
+    std::vector<bool> m_IsOverflowBinding;                    // per dynamic offset
+    std::vector<uint32_t> m_NumSpaceOverflowBindings;
+    uint32_t m_NumOverflowBindings = 0;
+
+    struct PendingWrite
+    {
+        VkWriteDescriptorSet Write;
+        size_t InfoOffset;  // the first info of the write in the pending infos of its descriptor type
+    };
+    std::vector<PendingWrite> m_PendingWrites;
+    std::vector<VkDescriptorImageInfo> m_PendingImageInfos;
+    std::vector<VkDescriptorBufferInfo> m_PendingBufferInfos;
+    std::vector<VkAccelerationStructureKHR> m_PendingAccelerationStructures;
+
+    // The bindings of every space, written into the transient sets of a dynamic set or of a space with overflow
+    // bindings. A later bind of the same binding replaces the write
+    struct DynamicWrite
+    {
+        VkWriteDescriptorSet Write;
+        std::vector<VkDescriptorImageInfo> ImageInfos;
+        std::vector<VkDescriptorBufferInfo> BufferInfos;
+        std::vector<VkAccelerationStructureKHR> AccelerationStructures;
+    };
+    std::vector<std::map<uint32_t, DynamicWrite>> m_DynamicWrites; // per space, ordered by binding
+    std::vector<std::vector<uint64_t>> m_DynamicSetKeys;
+    std::vector<uint64_t> m_DynamicSetHashes;
+    std::vector<bool> m_DynamicSetHashValid;
 };
\ No newline at end of file
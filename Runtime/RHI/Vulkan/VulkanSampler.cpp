@@ -39,12 +39,15 @@ namespace RHI::Vulkan
 
 RefCountPtr<RHISampler> VulkanDevice::CreateSampler(const RHISamplerDesc& inDesc)
 {
-    RefCountPtr<RHISampler> sampler(new VulkanSampler(*this, inDesc));
-    if(!sampler->Init())
+    return m_StateCache.FindOrCreate(inDesc, [this](const RHISamplerDesc& inCreateDesc)
     {
-        Log::Error("[Vulkan] Failed to create sampler");
-    }
-    return sampler;
+        RefCountPtr<RHISampler> sampler(new VulkanSampler(*this, inCreateDesc));
+        if(!sampler->Init())
+        {
+            Log::Error("[Vulkan] Failed to create sampler");
+        }
+        return sampler;
+    });
 }
 
 VulkanSampler::VulkanSampler(VulkanDevice& inDevice, const RHISamplerDesc& inDesc)
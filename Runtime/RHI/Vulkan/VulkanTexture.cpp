@@ -192,7 +192,7 @@ bool VulkanTexture::BindMemory(RefCountPtr<RHIResourceHeap> inHeap)
         return false;
     }
 
-    if(!inHeap->TryAllocate(GetAllocSizeInByte(), m_OffsetInHeap))
+    if(!inHeap->TryAllocate(GetAllocSizeInByte(), GetAllocAlignment(), m_OffsetInHeap))
     {
         Log::Error("[Vulkan] Failed to bind texture memory, the heap size is not enough");
         return false;
@@ -0,0 +1,115 @@
+#include "Tests.h"
+#include "../RHI/RHI.h"
+#include "../RHI/RHIDevice.h"
+#include "../RHI/RHICommandList.h"
+#include "../RHI/Null/NullDevice.h"
+#include <thread>
+
+static constexpr ERHICommandQueueType s_QueueTypes[] = {ERHICommandQueueType::Direct, ERHICommandQueueType::Async, ERHICommandQueueType::Copy};
+
+static void TestReuseAfterWarmUp(TestContext& inContext, NullDevice* inDevice)
+{
+    RHICommandListPool& pool = inDevice->GetCommandListPool();
+    RHIFrameContext& frameContext = inDevice->GetFrameContext();
+    const RHICommandListPoolStats statsBefore = pool.GetStats();
+
+    // The lists of a frame are released after they were executed, the frames in flight keep the ones of their frame
+    uint64_t createsAfterWarmUp = 0;
+    for(uint32_t frame = 0; frame < 16; ++frame)
+    {
+        frameContext.BeginFrame();
+        for(ERHICommandQueueType queueType : s_QueueTypes)
+        {
+            RefCountPtr<RHICommandList> commandList = pool.Acquire(queueType);
+            commandList->End();
+            inDevice->ExecuteCommandList(commandList);
+            pool.Release(commandList);
+        }
+        frameContext.EndFrame();
+        if(frame == frameContext.GetNumFramesInFlight())
+        {
+            createsAfterWarmUp = pool.GetStats().Creates;
+        }
+    }
+    frameContext.WaitIdle();
+
+    const RHICommandListPoolStats stats = pool.GetStats();
+    TEST_CHECK(inContext, stats.Acquires == statsBefore.Acquires + 16 * 3);
+    TEST_CHECK(inContext, stats.Creates == createsAfterWarmUp);
+    TEST_CHECK(inContext, stats.Creates - statsBefore.Creates <= 3 * (frameContext.GetNumFramesInFlight() + 1));
+}
+
+static void TestWaitForQueueFence(TestContext& inContext, NullDevice* inDevice, ERHICommandQueueType inQueueType)
+{
+    RHICommandListPool& pool = inDevice->GetCommandListPool();
+    inDevice->SetSimulatedGpuTime(std::chrono::milliseconds(20));
+    pool.Retire();
+    
+    RefCountPtr<RHIFence> fence = inDevice->CreateRhiFence();
+    RefCountPtr<RHICommandList> executed = pool.Acquire(inQueueType);
+    executed->End();
+    inDevice->ExecuteCommandList(executed, fence);
+    pool.Release(executed);
+
+    // The simulated gpu is still busy, the released list is not handed out again
+    const uint32_t inFlight = pool.GetStats().InFlight;
+    pool.Retire();
+    TEST_CHECK(inContext, pool.GetStats().InFlight == inFlight);
+    const uint64_t creates = pool.GetStats().Creates;
+    RefCountPtr<RHICommandList> other = pool.Acquire(inQueueType);
+    TEST_CHECK(inContext, other.GetReference() != executed.GetReference());
+    TEST_CHECK(inContext, pool.GetStats().Creates == creates + 1);
+
+    // Once the queue finished it, the list returns without a Submit of the pool
+    fence->CpuWait();
+    pool.Retire();
+    TEST_CHECK(inContext, pool.GetStats().InFlight == inFlight - 1);
+    RefCountPtr<RHICommandList> reused = pool.Acquire(inQueueType);
+    TEST_CHECK(inContext, reused.GetReference() == executed.GetReference());
+    TEST_CHECK(inContext, pool.GetStats().Creates == creates + 1);
+
+    // The abandoned lists wait for the fence of the next Submit
+    pool.Release(other);
+    pool.Release(reused);
+    pool.Submit(nullptr);
+    pool.Retire();
+    TEST_CHECK(inContext, pool.GetStats().InFlight == inFlight - 1);
+    inDevice->SetSimulatedGpuTime(std::chrono::microseconds(0));
+}
+
+static void TestReleaseIdleThreads(TestContext& inContext, NullDevice* inDevice)
+{
+    RHICommandListPool& pool = inDevice->GetCommandListPool();
+    const uint32_t numCommandLists = pool.GetStats().CommandLists;
+    std::thread thread([&pool, inDevice]()
+    {
+        RefCountPtr<RHICommandList> commandList = pool.Acquire(ERHICommandQueueType::Copy);
+        commandList->End();
+        inDevice->ExecuteCommandList(commandList);
+        pool.Release(commandList);
+    });
+    thread.join();
+    TEST_CHECK(inContext, pool.GetStats().CommandLists == numCommandLists + 1);
+
+    // The list returns to the free lists of the finished thread, which are released once they were idle long enough.
+    // This thread keeps acquiring, its lists stay
+    for(uint64_t i = 0; i < RHICommandListPool::s_MaxIdleRetires; ++i)
+    {
+        RefCountPtr<RHICommandList> commandList = pool.Acquire();
+        pool.Release(commandList);
+        pool.Submit(nullptr);
+        pool.Retire();
+    }
+    TEST_CHECK(inContext, pool.GetStats().CommandLists == numCommandLists + 1);
+    pool.Retire();
+    TEST_CHECK(inContext, pool.GetStats().CommandLists == numCommandLists);
+}
+
+void Tests::RunCommandListPoolTests(TestContext& inContext)
+{
+    NullDevice* device = static_cast<NullDevice*>(RHI::GetDevice());
+    TestReuseAfterWarmUp(inContext, device);
+    TestWaitForQueueFence(inContext, device, ERHICommandQueueType::Async);
+    TestWaitForQueueFence(inContext, device, ERHICommandQueueType::Copy);
+    TestReleaseIdleThreads(inContext, device);
+}
\ No newline at end of file
@@ -0,0 +1,140 @@
+#include "Tests.h"
+#include "../RHI/RHI.h"
+#include "../RHI/RHIDevice.h"
+#include "../RHI/RHICommandList.h"
+#include "../RHI/RHICommandStream.h"
+#include "../RHI/Null/NullCommandList.h"
+#include <fstream>
+#include <iterator>
+
+static RefCountPtr<RHIBuffer> CreateBuffer(RHIDevice* inDevice, const char* inName, ERHIBufferUsage inUsages)
+{
+    RHIBufferDesc desc;
+    desc.Size = 4096;
+    desc.Usages = inUsages;
+    RefCountPtr<RHIBuffer> buffer = inDevice->CreateBuffer(desc);
+    buffer->SetName(inName);
+    return buffer;
+}
+
+// The first command copies object 1 into object 0, a texture barrier adds object 2
+static void RecordStream(RHIDevice* inDevice, RHICommandStream& outStream)
+{
+    RefCountPtr<RHIBuffer> dst = CreateBuffer(inDevice, "CommandStreamTests Dst", ERHIBufferUsage::None);
+    RefCountPtr<RHIBuffer> src = CreateBuffer(inDevice, "CommandStreamTests Src", ERHIBufferUsage::None);
+    RefCountPtr<RHIBuffer> arguments = CreateBuffer(inDevice, "CommandStreamTests Arguments", ERHIBufferUsage::IndirectCommands);
+    RHITextureDesc desc = RHITextureDesc::Texture2D(64, 64, ERHIFormat::RGBA8_UNORM);
+    desc.Usages = ERHITextureUsage::ShaderResource;
+    RefCountPtr<RHITexture> texture = inDevice->CreateTexture(desc);
+
+    outStream.Reset();
+    outStream.CopyBuffer(dst, 0, src, 0, 1024);
+    outStream.ResourceBarrier(texture, ERHIResourceStates::GpuReadOnly);
+    outStream.BeginMark("CommandStreamTests");
+    outStream.ResourceBarrier(arguments, ERHIResourceStates::IndirectCommands);
+    outStream.SetViewports({RHIViewport::Create(64.0f, 64.0f)});
+    outStream.DrawIndexedIndirectCount(arguments, arguments, 4, 0, 4092);
+    outStream.Dispatch(1, 1, 1);
+    outStream.EndMark();
+}
+
+static std::vector<char> ReadFile(const std::filesystem::path& inPath)
+{
+    std::ifstream file(inPath, std::ios::binary);
+    return std::vector<char>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+static void WriteFile(const std::filesystem::path& inPath, const std::vector<char>& inData)
+{
+    std::ofstream file(inPath, std::ios::binary);
+    file.write(inData.data(), static_cast<std::streamsize>(inData.size()));
+}
+
+static void TestRoundTrip(TestContext& inContext, RHIDevice* inDevice, const std::filesystem::path& inPath)
+{
+    RHICommandStream recorded;
+    RecordStream(inDevice, recorded);
+    TEST_CHECK(inContext, recorded.Save(inPath));
+
+    // Without a resolver the buffers and textures are recreated from their descs
+    RHICommandStream loaded;
+    TEST_CHECK(inContext, loaded.Load(inPath));
+    TEST_CHECK(inContext, loaded.GetNumCommands() == recorded.GetNumCommands());
+    TEST_CHECK(inContext, loaded.GetSizeInBytes() == recorded.GetSizeInBytes());
+    TEST_CHECK(inContext, loaded.GetObjects().size() == 4);
+    if(loaded.GetObjects().size() == 4)
+    {
+        TEST_CHECK(inContext, loaded.GetObjects()[0].Name == "CommandStreamTests Dst");
+        TEST_CHECK(inContext, loaded.GetObjects()[2].Type == ERHICommandObjectType::Texture);
+        TEST_CHECK(inContext, loaded.GetObjects()[3].BufferDesc.Usages == ERHIBufferUsage::IndirectCommands);
+    }
+
+    RefCountPtr<RHICommandList> commandList = inDevice->CreateCommandList();
+    commandList->Begin();
+    TEST_CHECK(inContext, loaded.Replay(commandList.GetReference()) == recorded.GetNumCommands());
+    commandList->End();
+    inDevice->ExecuteCommandList(commandList);
+
+    const NullCommandCounters& counters = static_cast<NullCommandList*>(commandList.GetReference())->GetCounters();
+    TEST_CHECK(inContext, counters.Copies == 1);
+    TEST_CHECK(inContext, counters.Barriers == 2);
+    TEST_CHECK(inContext, counters.Marks == 1);
+    TEST_CHECK(inContext, counters.Viewports == 1);
+    TEST_CHECK(inContext, counters.DrawsIndirectCount == 1);
+    TEST_CHECK(inContext, counters.Dispatches == 1);
+}
+
+static void TestRejectCorruptStreams(TestContext& inContext, RHIDevice* inDevice, const std::filesystem::path& inPath)
+{
+    RHICommandStream recorded;
+    RecordStream(inDevice, recorded);
+    recorded.Save(inPath);
+
+    // The commands are the tail of the file, their size in bytes is stored right before them
+    const std::vector<char> file = ReadFile(inPath);
+    const size_t dataOffset = file.size() - recorded.GetSizeInBytes();
+    const size_t dataSizeOffset = dataOffset - sizeof(uint64_t);
+    const std::filesystem::path corruptPath = inPath.string() + ".corrupt";
+    RHICommandStream loaded;
+
+    // Trailing bytes which do not hold a whole command header
+    std::vector<char> trailing = file;
+    trailing.insert(trailing.end(), 4, 0);
+    const uint64_t trailingSize = recorded.GetSizeInBytes() + 4;
+    memcpy(trailing.data() + dataSizeOffset, &trailingSize, sizeof(uint64_t));
+    WriteFile(corruptPath, trailing);
+    TEST_CHECK(inContext, !loaded.Load(corruptPath));
+    TEST_CHECK(inContext, loaded.IsEmpty() && loaded.GetObjects().empty());
+
+    // The copy references the texture, Replay would cast it to a buffer
+    std::vector<char> mismatched = file;
+    const uint32_t textureIndex = 2;
+    memcpy(mismatched.data() + dataOffset + 8, &textureIndex, sizeof(uint32_t));
+    WriteFile(corruptPath, mismatched);
+    TEST_CHECK(inContext, !loaded.Load(corruptPath));
+
+    // An object index behind the object table
+    std::vector<char> outOfRange = file;
+    const uint32_t invalidIndex = 4;
+    memcpy(outOfRange.data() + dataOffset + 8, &invalidIndex, sizeof(uint32_t));
+    WriteFile(corruptPath, outOfRange);
+    TEST_CHECK(inContext, !loaded.Load(corruptPath));
+
+    // The unmodified stream still loads
+    WriteFile(corruptPath, file);
+    TEST_CHECK(inContext, loaded.Load(corruptPath) && loaded.GetNumCommands() == recorded.GetNumCommands());
+
+    std::error_code error;
+    std::filesystem::remove(corruptPath, error);
+}
+
+void Tests::RunCommandStreamTests(TestContext& inContext)
+{
+    RHIDevice* device = RHI::GetDevice();
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "RHICommandStreamTests.rcs";
+    TestRoundTrip(inContext, device, path);
+    TestRejectCorruptStreams(inContext, device, path);
+
+    std::error_code error;
+    std::filesystem::remove(path, error);
+}
\ No newline at end of file
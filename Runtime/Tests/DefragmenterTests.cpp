@@ -0,0 +1,126 @@
+#include "Tests.h"
+#include "../RHI/RHIDefragmenter.h"
+
+static constexpr uint64_t KB = 1024;
+
+static RHIDefragmentationBlock CreateBlock(uint64_t inPool, uint64_t inSize, const std::vector<RHIDefragmentationAllocation>& inAllocations)
+{
+    // The free ranges are the gaps between the allocations, which are given in offset order
+    RHIDefragmentationBlock block;
+    block.Pool = inPool;
+    block.Size = inSize;
+    block.Allocations = inAllocations;
+    uint64_t offset = 0;
+    for(const RHIDefragmentationAllocation& allocation : inAllocations)
+    {
+        if(allocation.Offset > offset)
+        {
+            block.FreeRanges.push_back({offset, allocation.Offset - offset});
+        }
+        offset = allocation.Offset + allocation.Size;
+    }
+    if(inSize > offset)
+    {
+        block.FreeRanges.push_back({offset, inSize - offset});
+    }
+    return block;
+}
+
+static bool IsMove(const RHIDefragmentationMove& inMove, uint32_t inSrcBlock, uint32_t inAllocation, uint32_t inDstBlock, uint64_t inDstOffset)
+{
+    return inMove.SrcBlock == inSrcBlock && inMove.Allocation == inAllocation
+        && inMove.DstBlock == inDstBlock && inMove.DstOffset == inDstOffset;
+}
+
+static void TestEmptyLeastUsedBlocks(TestContext& inContext)
+{
+    std::vector<RHIDefragmentationBlock> blocks;
+    blocks.push_back(CreateBlock(0, 1024 * KB, {{128 * KB, 128 * KB, 256 * KB}}));
+    blocks.push_back(CreateBlock(0, 1024 * KB, {{0, 256 * KB, 256 * KB}, {512 * KB, 256 * KB, 256 * KB}}));
+    blocks.push_back(CreateBlock(0, 1024 * KB, {{512 * KB, 64 * KB, 64 * KB}}));
+
+    // The least used block moves first into the first free range of the fullest block, the aligned allocation of the
+    // other block skips the remainder of that range
+    std::vector<RHIDefragmentationMove> moves;
+    RHIDefragmenter::PlanMoves(blocks, UINT64_MAX, moves);
+    TEST_CHECK(inContext, moves.size() == 2);
+    if(moves.size() == 2)
+    {
+        TEST_CHECK(inContext, IsMove(moves[0], 2, 0, 1, 256 * KB));
+        TEST_CHECK(inContext, IsMove(moves[1], 0, 0, 1, 768 * KB));
+    }
+
+    // The byte budget skips the block which exceeds it
+    RHIDefragmenter::PlanMoves(blocks, 100 * KB, moves);
+    TEST_CHECK(inContext, moves.size() == 1 && IsMove(moves[0], 2, 0, 1, 256 * KB));
+}
+
+static void TestSkipBlocksOverBudget(TestContext& inContext)
+{
+    std::vector<RHIDefragmentationBlock> blocks;
+    blocks.push_back(CreateBlock(0, 1024 * KB, {{0, 512 * KB, 64 * KB}}));
+    // Fits into the first block but exceeds the budget on its own
+    blocks.push_back(CreateBlock(0, 1024 * KB, {{0, 384 * KB, 64 * KB}}));
+    blocks.push_back(CreateBlock(1, 1024 * KB, {{0, 512 * KB, 64 * KB}}));
+    blocks.push_back(CreateBlock(1, 1024 * KB, {{0, 64 * KB, 64 * KB}}));
+
+    // The block of the next pool still moves within the budget
+    std::vector<RHIDefragmentationMove> moves;
+    RHIDefragmenter::PlanMoves(blocks, 256 * KB, moves);
+    TEST_CHECK(inContext, moves.size() == 1 && IsMove(moves[0], 3, 0, 2, 512 * KB));
+
+    // Nothing is left of the budget for the large block once the small one of the same pool moved
+    blocks[1] = CreateBlock(0, 1024 * KB, {{0, 64 * KB, 64 * KB}, {256 * KB, 192 * KB, 64 * KB}});
+    blocks.push_back(CreateBlock(0, 1024 * KB, {{0, 64 * KB, 64 * KB}}));
+    RHIDefragmenter::PlanMoves(blocks, 256 * KB, moves);
+    TEST_CHECK(inContext, moves.size() == 2);
+    if(moves.size() == 2)
+    {
+        TEST_CHECK(inContext, IsMove(moves[0], 4, 0, 0, 512 * KB));
+        TEST_CHECK(inContext, IsMove(moves[1], 3, 0, 2, 512 * KB));
+    }
+}
+
+static void TestKeepBlocksWhichCanNotBeEmptied(TestContext& inContext)
+{
+    std::vector<RHIDefragmentationBlock> blocks;
+    blocks.push_back(CreateBlock(0, 1024 * KB, {{0, 768 * KB, 64 * KB}}));
+    // Only one of the two allocations fits into the fuller block, moving it alone would not release the block
+    blocks.push_back(CreateBlock(0, 1024 * KB, {{0, 192 * KB, 64 * KB}, {256 * KB, 192 * KB, 64 * KB}}));
+    // Holds an allocation the planner can not move
+    RHIDefragmentationBlock pinned = CreateBlock(0, 1024 * KB, {{0, 64 * KB, 64 * KB}});
+    pinned.FreeRanges = {{128 * KB, 896 * KB}};
+    blocks.push_back(pinned);
+    // The only block of another pool
+    blocks.push_back(CreateBlock(1, 1024 * KB, {{0, 64 * KB, 64 * KB}}));
+
+    std::vector<RHIDefragmentationMove> moves;
+    RHIDefragmenter::PlanMoves(blocks, UINT64_MAX, moves);
+    TEST_CHECK(inContext, moves.empty());
+}
+
+static void TestMoveWithinPools(TestContext& inContext)
+{
+    std::vector<RHIDefragmentationBlock> blocks;
+    blocks.push_back(CreateBlock(1, 1024 * KB, {{0, 64 * KB, 64 * KB}}));
+    blocks.push_back(CreateBlock(0, 1024 * KB, {{0, 512 * KB, 64 * KB}}));
+    blocks.push_back(CreateBlock(1, 1024 * KB, {{0, 512 * KB, 64 * KB}}));
+    blocks.push_back(CreateBlock(0, 1024 * KB, {{0, 64 * KB, 64 * KB}}));
+
+    std::vector<RHIDefragmentationMove> moves;
+    RHIDefragmenter::PlanMoves(blocks, UINT64_MAX, moves);
+    TEST_CHECK(inContext, moves.size() == 2);
+    if(moves.size() == 2)
+    {
+        TEST_CHECK(inContext, IsMove(moves[0], 3, 0, 1, 512 * KB));
+        TEST_CHECK(inContext, IsMove(moves[1], 0, 0, 2, 512 * KB));
+    }
+}
+
+void Tests::RunDefragmenterTests(TestContext& inContext)
+{
+    TestEmptyLeastUsedBlocks(inContext);
+    TestKeepBlocksWhichCanNotBeEmptied(inContext);
+    TestSkipBlocksOverBudget(inContext);
+    TestMoveWithinPools(inContext);
+}
\ No newline at end of file
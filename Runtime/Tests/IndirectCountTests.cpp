@@ -0,0 +1,70 @@
+#include "Tests.h"
+#include "../RHI/RHI.h"
+#include "../RHI/RHIDevice.h"
+#include "../RHI/RHICommandList.h"
+#include "../RHI/Null/NullCommandList.h"
+
+static RefCountPtr<RHIBuffer> CreateBuffer(RHIDevice* inDevice, uint64_t inSize, ERHIBufferUsage inUsages)
+{
+    RHIBufferDesc desc;
+    desc.Size = inSize;
+    desc.Usages = inUsages;
+    return inDevice->CreateBuffer(desc);
+}
+
+static const NullCommandCounters& GetCounters(const RefCountPtr<RHICommandList>& inCommandList)
+{
+    return static_cast<NullCommandList*>(inCommandList.GetReference())->GetCounters();
+}
+
+static void TestValidDraws(TestContext& inContext, RHIDevice* inDevice)
+{
+    RefCountPtr<RHIBuffer> arguments = CreateBuffer(inDevice, 4096, ERHIBufferUsage::IndirectCommands);
+    RefCountPtr<RHIBuffer> count = CreateBuffer(inDevice, 16, ERHIBufferUsage::IndirectCommands);
+    RefCountPtr<RHICommandList> commandList = inDevice->CreateCommandList();
+    commandList->Begin();
+
+    // Every argument slot up to the max count fits, the count is the last dword of its buffer
+    const uint32_t maxDraws = 4096 / sizeof(RHIDrawIndexedArguments);
+    commandList->DrawIndexedIndirectCount(arguments, count, maxDraws, 0, 12);
+    commandList->DrawIndexedIndirectCount(arguments, count, 1, 4096 - sizeof(RHIDrawIndexedArguments), 0);
+    commandList->DispatchMeshIndirectCount(arguments, count, 4096 / sizeof(RHIDispatchArguments), 0, 4);
+    TEST_CHECK(inContext, GetCounters(commandList).DrawsIndirectCount == 2);
+    TEST_CHECK(inContext, GetCounters(commandList).MeshDispatchesIndirectCount == 1);
+    commandList->End();
+}
+
+static void TestRejectInvalidDraws(TestContext& inContext, RHIDevice* inDevice)
+{
+    RefCountPtr<RHIBuffer> arguments = CreateBuffer(inDevice, 4096, ERHIBufferUsage::IndirectCommands);
+    RefCountPtr<RHIBuffer> count = CreateBuffer(inDevice, 16, ERHIBufferUsage::IndirectCommands);
+    RefCountPtr<RHIBuffer> vertices = CreateBuffer(inDevice, 4096, ERHIBufferUsage::VertexBuffer);
+    RefCountPtr<RHICommandList> commandList = inDevice->CreateCommandList();
+    commandList->Begin();
+
+    // Zero max count
+    commandList->DrawIndexedIndirectCount(arguments, count, 0);
+    commandList->DispatchMeshIndirectCount(arguments, count, 0);
+    // Offsets which are not a multiple of 4
+    commandList->DrawIndexedIndirectCount(arguments, count, 1, 2, 0);
+    commandList->DispatchMeshIndirectCount(arguments, count, 1, 0, 6);
+    // The last argument slot or the count is out of bounds
+    const uint32_t maxDraws = 4096 / sizeof(RHIDrawIndexedArguments);
+    commandList->DrawIndexedIndirectCount(arguments, count, maxDraws + 1);
+    commandList->DrawIndexedIndirectCount(arguments, count, maxDraws, sizeof(RHIDrawIndexedArguments));
+    commandList->DispatchMeshIndirectCount(arguments, count, 1, 0, 16);
+    // A buffer without the IndirectCommands usage
+    commandList->DrawIndexedIndirectCount(vertices, count, 1);
+    commandList->DispatchMeshIndirectCount(arguments, vertices, 1);
+
+    TEST_CHECK(inContext, GetCounters(commandList).DrawsIndirectCount == 0);
+    TEST_CHECK(inContext, GetCounters(commandList).MeshDispatchesIndirectCount == 0);
+    commandList->End();
+}
+
+void Tests::RunIndirectCountTests(TestContext& inContext)
+{
+    RHIDevice* device = RHI::GetDevice();
+    TestValidDraws(inContext, device);
+    TestRejectInvalidDraws(inContext, device);
+}
\ No newline at end of file
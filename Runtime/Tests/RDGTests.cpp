@@ -0,0 +1,189 @@
+#include "Tests.h"
+#include "../RDG/RDG.h"
+#include "../RHI/RHIDevice.h"
+#include "../RHI/RHICommandList.h"
+#include "../RHI/Null/NullDevice.h"
+
+static RHITextureRef CreateTarget(const char* inName)
+{
+    RHITextureDesc desc = RHITextureDesc::Texture2D(64, 64, ERHIFormat::RGBA8_UNORM);
+    desc.Usages = ERHITextureUsage::RenderTarget | ERHITextureUsage::ShaderResource;
+    RHITextureRef texture = RHI::GetDevice()->CreateTexture(desc);
+    texture->SetName(inName);
+    return texture;
+}
+
+static RDGNodeHandle AddDrawPass(RDGraph* inGraph, RDGNodeHandle inTarget, ERDGLoadAction inLoadAction)
+{
+    RDGRenderTargets renderTargets;
+    renderTargets.Colors[0].Texture = inTarget;
+    renderTargets.Colors[0].LoadAction = inLoadAction;
+    return inGraph->AddRasterPass("Draw", renderTargets, [](RHICommandList*, const RDGRenderPassInfo&) {});
+}
+
+static bool IsMerged(RDGraph* inGraph, RDGNodeHandle inPrevPass, RDGNodeHandle inPass)
+{
+    return !inGraph->GetPass(inPrevPass)->GetRenderPassInfo().EndRenderPass
+        && !inGraph->GetPass(inPass)->GetRenderPassInfo().BeginRenderPass;
+}
+
+static void TestMergeSameTargets(TestContext& inContext, RDGraph* inGraph, RHITextureRef& inTarget)
+{
+    inGraph->Reset();
+    RDGNodeHandle target = inGraph->AddResource("Target", inTarget, ERHIResourceStates::Present);
+    RDGNodeHandle first = AddDrawPass(inGraph, target, ERDGLoadAction::Clear);
+    RDGNodeHandle second = AddDrawPass(inGraph, target, ERDGLoadAction::Load);
+    RDGNodeHandle third = AddDrawPass(inGraph, target, ERDGLoadAction::Load);
+    inGraph->Compile();
+
+    TEST_CHECK(inContext, IsMerged(inGraph, first, second));
+    TEST_CHECK(inContext, IsMerged(inGraph, second, third));
+    TEST_CHECK(inContext, inGraph->GetPass(first)->GetRenderPassInfo().ColorLoadActions[0] == ERDGLoadAction::Clear);
+    // The imported target leaves the graph, the merged scope stores it once at its end
+    TEST_CHECK(inContext, inGraph->GetPass(third)->GetRenderPassInfo().ColorStoreActions[0] == ERDGStoreAction::Store);
+    TEST_CHECK(inContext, inGraph->GetPass(first)->GetBarriers().size() == 1);
+    TEST_CHECK(inContext, inGraph->GetPass(second)->GetBarriers().empty());
+}
+
+static void TestNoMergeOnClear(TestContext& inContext, RDGraph* inGraph, RHITextureRef& inTarget)
+{
+    inGraph->Reset();
+    RDGNodeHandle target = inGraph->AddResource("Target", inTarget, ERHIResourceStates::Present);
+    RDGNodeHandle first = AddDrawPass(inGraph, target, ERDGLoadAction::Load);
+    RDGNodeHandle second = AddDrawPass(inGraph, target, ERDGLoadAction::Clear);
+    inGraph->Compile();
+
+    TEST_CHECK(inContext, !IsMerged(inGraph, first, second));
+    TEST_CHECK(inContext, inGraph->GetPass(first)->GetRenderPassInfo().EndRenderPass);
+    TEST_CHECK(inContext, inGraph->GetPass(second)->GetRenderPassInfo().BeginRenderPass);
+}
+
+static void TestNoMergeOnOtherTargets(TestContext& inContext, RDGraph* inGraph, RHITextureRef& inTarget, RHITextureRef& inOtherTarget)
+{
+    inGraph->Reset();
+    RDGNodeHandle target = inGraph->AddResource("Target", inTarget, ERHIResourceStates::Present);
+    RDGNodeHandle otherTarget = inGraph->AddResource("OtherTarget", inOtherTarget, ERHIResourceStates::Present);
+    RDGNodeHandle first = AddDrawPass(inGraph, target, ERDGLoadAction::Load);
+    RDGNodeHandle second = AddDrawPass(inGraph, otherTarget, ERDGLoadAction::Load);
+    inGraph->Compile();
+
+    TEST_CHECK(inContext, !IsMerged(inGraph, first, second));
+}
+
+static void TestNoMergeOnBarrier(TestContext& inContext, RDGraph* inGraph, RHITextureRef& inTarget)
+{
+    inGraph->Reset();
+    RDGNodeHandle target = inGraph->AddResource("Target", inTarget, ERHIResourceStates::Present);
+    RHITextureDesc desc = RHITextureDesc::Texture2D(64, 64, ERHIFormat::RGBA8_UNORM);
+    desc.Usages = ERHITextureUsage::RenderTarget | ERHITextureUsage::ShaderResource;
+    RDGNodeHandle shadow = inGraph->AddResource("Shadow", desc);
+
+    RDGNodeHandle drawShadow = AddDrawPass(inGraph, shadow, ERDGLoadAction::Clear);
+    RDGNodeHandle first = AddDrawPass(inGraph, target, ERDGLoadAction::Clear);
+    // Reads the transient target drawn before, the barrier to GpuReadOnly splits the scope
+    RDGNodeHandle second = AddDrawPass(inGraph, target, ERDGLoadAction::Load);
+    inGraph->ReadResource(second, shadow, ERHIResourceStates::GpuReadOnly);
+    inGraph->Compile();
+
+    TEST_CHECK(inContext, !inGraph->GetPass(drawShadow)->IsCulled());
+    TEST_CHECK(inContext, inGraph->GetPass(second)->GetBarriers().size() == 1);
+    TEST_CHECK(inContext, !IsMerged(inGraph, drawShadow, first));
+    TEST_CHECK(inContext, !IsMerged(inGraph, first, second));
+    // Read after its scope ended, so the transient target is stored
+    TEST_CHECK(inContext, inGraph->GetPass(drawShadow)->GetRenderPassInfo().ColorStoreActions[0] == ERDGStoreAction::Store);
+}
+
+static void TestExecuteIssuesCompiledBarriers(TestContext& inContext, RDGraph* inGraph, RHITextureRef& inTarget)
+{
+    NullDevice* device = static_cast<NullDevice*>(RHI::GetDevice());
+
+    // Executed twice, the second frame gets the pooled color target back in the state the first frame left it in
+    for(uint32_t frame = 0; frame < 2; ++frame)
+    {
+        inGraph->Reset();
+        RDGNodeHandle target = inGraph->AddResource("Target", inTarget, frame == 0 ? ERHIResourceStates::Present : ERHIResourceStates::GpuReadOnly);
+        RHITextureDesc desc = RHITextureDesc::Texture2D(64, 64, ERHIFormat::RGBA8_UNORM);
+        desc.Usages = ERHITextureUsage::RenderTarget | ERHITextureUsage::ShaderResource;
+        RDGNodeHandle color = inGraph->AddResource("Color", desc);
+
+        AddDrawPass(inGraph, color, ERDGLoadAction::Clear);
+        AddDrawPass(inGraph, color, ERDGLoadAction::Load);
+        RDGNodeHandle resolve = AddDrawPass(inGraph, target, ERDGLoadAction::DontCare);
+        inGraph->ReadResource(resolve, color, ERHIResourceStates::GpuReadOnly);
+        RDGNodeHandle present = inGraph->AddPass("Present", [](){});
+        inGraph->ReadResource(present, target, ERHIResourceStates::GpuReadOnly);
+        inGraph->Compile();
+
+        size_t numPlannedBarriers = 0;
+        for(RDGNodeHandle i = 0; i < inGraph->GetNumPasses(); ++i)
+            numPlannedBarriers += inGraph->GetPass(i)->GetBarriers().size();
+
+        RefCountPtr<RHICommandList> commandList = device->CreateCommandList();
+        commandList->Begin();
+        const uint64_t barriersBefore = device->GetExecutedCommandCounters().Barriers;
+        inGraph->Execute(commandList.GetReference());
+        commandList->End();
+        device->ExecuteCommandList(commandList);
+
+        TEST_CHECK(inContext, device->GetExecutedCommandCounters().Barriers - barriersBefore == numPlannedBarriers);
+        TEST_CHECK(inContext, inGraph->GetResourceState(target) == ERHIResourceStates::GpuReadOnly);
+    }
+}
+
+static void TestExecuteWithoutRecording(TestContext& inContext, RDGraph* inGraph, RHITextureRef& inTarget)
+{
+    inGraph->Reset();
+    RDGNodeHandle target = inGraph->AddResource("Target", inTarget, ERHIResourceStates::Present);
+    AddDrawPass(inGraph, target, ERDGLoadAction::Clear);
+    inGraph->Execute();
+
+    // Nothing was recorded, so the imported target is still in the state it was imported with
+    TEST_CHECK(inContext, inGraph->GetResourceState(target) == ERHIResourceStates::Present);
+}
+
+static void TestExecuteOnPooledLists(TestContext& inContext, RDGraph* inGraph, RHITextureRef& inTarget)
+{
+    NullDevice* device = static_cast<NullDevice*>(RHI::GetDevice());
+    RHICommandListPool& pool = device->GetCommandListPool();
+    RefCountPtr<RHIFence> fence = device->CreateRhiFence();
+    const uint64_t createsBefore = pool.GetStats().Creates;
+    for(uint32_t frame = 0; frame < 4; ++frame)
+    {
+        inGraph->Reset();
+        RDGNodeHandle target = inGraph->AddResource("Target", inTarget, frame == 0 ? ERHIResourceStates::Present : ERHIResourceStates::GpuReadOnly);
+        RDGNodeHandle draw = AddDrawPass(inGraph, target, ERDGLoadAction::Clear);
+        RDGNodeHandle present = inGraph->AddPass("Present", [](){});
+        inGraph->ReadResource(present, target, ERHIResourceStates::GpuReadOnly);
+        inGraph->Compile();
+        const size_t numPlannedBarriers = inGraph->GetPass(draw)->GetBarriers().size() + inGraph->GetPass(present)->GetBarriers().size();
+
+        const uint64_t barriersBefore = device->GetExecutedCommandCounters().Barriers;
+        inGraph->ExecuteAndSubmit(fence);
+        fence->CpuWait();
+        pool.Retire();
+        TEST_CHECK(inContext, device->GetExecutedCommandCounters().Barriers - barriersBefore == numPlannedBarriers);
+    }
+
+    // The list of the first frame is reused by the later ones
+    TEST_CHECK(inContext, pool.GetStats().Creates <= createsBefore + 1);
+    TEST_CHECK(inContext, pool.GetStats().InFlight == 0);
+}
+
+void Tests::RunRDGTests(TestContext& inContext)
+{
+    RDG::Init();
+    RDGraph* graph = RDG::GetGraph();
+    graph->Shutdown();
+
+    RHITextureRef target = CreateTarget("RDGTests Target");
+    RHITextureRef otherTarget = CreateTarget("RDGTests OtherTarget");
+    TestMergeSameTargets(inContext, graph, target);
+    TestNoMergeOnClear(inContext, graph, target);
+    TestNoMergeOnOtherTargets(inContext, graph, target, otherTarget);
+    TestNoMergeOnBarrier(inContext, graph, target);
+    TestExecuteIssuesCompiledBarriers(inContext, graph, target);
+    TestExecuteWithoutRecording(inContext, graph, target);
+    TestExecuteOnPooledLists(inContext, graph, target);
+
+    graph->Shutdown();
+}
\ No newline at end of file
@@ -0,0 +1,151 @@
+#include "Tests.h"
+#include "../RHI/RHI.h"
+#include "../RHI/RHIDevice.h"
+#include "../RHI/RHICommandList.h"
+#include "../RHI/RHIPipelineState.h"
+#include "../RHI/Null/NullDevice.h"
+
+static RHITextureRef CreateTexture(RHIDevice* inDevice, const char* inName)
+{
+    RHITextureDesc desc = RHITextureDesc::Texture2D(64, 64, ERHIFormat::RGBA8_UNORM);
+    desc.Usages = ERHITextureUsage::ShaderResource;
+    RHITextureRef texture = inDevice->CreateTexture(desc);
+    texture->SetName(inName);
+    return texture;
+}
+
+static void TestTrackCommittedAndPlaced(TestContext& inContext, RHIDevice* inDevice)
+{
+    RHIResidencyManager& residencyManager = inDevice->GetResidencyManager();
+    const uint64_t trackedBytes = residencyManager.GetStats().TrackedBytes;
+    RHITextureRef committed = CreateTexture(inDevice, "ResidencyTests Committed");
+    TEST_CHECK(inContext, residencyManager.IsTracked(committed.GetReference()));
+    TEST_CHECK(inContext, residencyManager.GetStats().TrackedBytes == trackedBytes + committed->GetAllocSizeInByte());
+
+    // A placed texture is evicted with its block, only the block is tracked
+    RHITextureDesc desc = RHITextureDesc::Texture2D(64, 64, ERHIFormat::RGBA8_UNORM);
+    desc.Usages = ERHITextureUsage::ShaderResource;
+    RHITextureRef placed = inDevice->GetMemoryAllocator().CreateTexture(desc);
+    TEST_CHECK(inContext, placed.IsValid() && placed->GetResourceHeap() != nullptr);
+    if(placed.IsValid() && placed->GetResourceHeap() != nullptr)
+    {
+        TEST_CHECK(inContext, !residencyManager.IsTracked(placed.GetReference()));
+        TEST_CHECK(inContext, residencyManager.IsTracked(placed->GetResourceHeap()));
+    }
+}
+
+static void SubmitUsage(NullDevice* inDevice, RHITextureRef& inBarrierTexture, RefCountPtr<RHIResourceSet>& inResourceSet)
+{
+    RefCountPtr<RHICommandList> commandList = inDevice->CreateCommandList();
+    commandList->Begin();
+    if(inBarrierTexture.IsValid())
+    {
+        commandList->ResourceBarrier(inBarrierTexture, ERHIResourceStates::GpuReadOnly);
+    }
+    commandList->SetResourceSet(inResourceSet);
+    commandList->End();
+    inDevice->ExecuteCommandList(commandList);
+}
+
+static void TestEvictOverBudget(TestContext& inContext, NullDevice* inDevice, uint64_t inFrameNumber)
+{
+    RHIResidencyManager& residencyManager = inDevice->GetResidencyManager();
+    residencyManager.BeginFrame(inFrameNumber, inFrameNumber);
+
+    RHITextureRef first = CreateTexture(inDevice, "ResidencyTests First");
+    RHITextureRef second = CreateTexture(inDevice, "ResidencyTests Second");
+    RHITextureRef unused = CreateTexture(inDevice, "ResidencyTests Unused");
+    const uint64_t textureSize = first->GetAllocSizeInByte();
+
+    RHIPipelineBindingLayoutDesc layoutDesc;
+    layoutDesc.Items.emplace_back(ERHIBindingResourceType::Texture_SRV, 0);
+    RefCountPtr<RHIPipelineBindingLayout> layout = inDevice->CreatePipelineBindingLayout(layoutDesc);
+    RefCountPtr<RHIResourceSet> resourceSet = inDevice->CreateResourceSet(layout.GetReference());
+    resourceSet->BindTextureSRV(0, 0, second);
+
+    // The barrier and the binding stamp the two textures, the third one is only stamped by its creation
+    residencyManager.BeginFrame(inFrameNumber + 1, inFrameNumber + 1);
+    SubmitUsage(inDevice, first, resourceSet);
+
+    // Everything the last frame did not use is evicted first, the two used textures fit into the budget
+    const RHIResidencyStats statsBefore = residencyManager.GetStats();
+    const uint64_t evictedBefore = inDevice->GetNumEvictedObjects();
+    residencyManager.SetBudgetOverride(textureSize * 2);
+    residencyManager.BeginFrame(inFrameNumber + 2, inFrameNumber + 2);
+    TEST_CHECK(inContext, residencyManager.IsResident(first.GetReference()));
+    TEST_CHECK(inContext, residencyManager.IsResident(second.GetReference()));
+    TEST_CHECK(inContext, !residencyManager.IsResident(unused.GetReference()));
+    TEST_CHECK(inContext, residencyManager.GetStats().ResidentBytes == textureSize * 2);
+    TEST_CHECK(inContext, residencyManager.GetStats().Evictions > statsBefore.Evictions);
+    TEST_CHECK(inContext, inDevice->GetNumEvictedObjects() > evictedBefore);
+
+    // The rebound texture is made resident at submit and the least recently used one makes room for it
+    const uint64_t madeResidentBefore = inDevice->GetNumMadeResidentObjects();
+    residencyManager.BeginFrame(inFrameNumber + 3, inFrameNumber + 3);
+    resourceSet->BindTextureSRV(0, 0, unused);
+    RHITextureRef noBarrier;
+    SubmitUsage(inDevice, noBarrier, resourceSet);
+    TEST_CHECK(inContext, residencyManager.IsResident(unused.GetReference()));
+    TEST_CHECK(inContext, residencyManager.IsResident(first.GetReference()) != residencyManager.IsResident(second.GetReference()));
+    TEST_CHECK(inContext, residencyManager.GetStats().MakeResidents == statsBefore.MakeResidents + 1);
+    TEST_CHECK(inContext, inDevice->GetNumMadeResidentObjects() == madeResidentBefore + 1);
+    TEST_CHECK(inContext, residencyManager.GetStats().ResidentBytes == textureSize * 2);
+
+    // The evicted one of the two is made resident again before it is released
+    const uint64_t madeResidentBeforeRelease = inDevice->GetNumMadeResidentObjects();
+    residencyManager.SetBudgetOverride(0);
+    resourceSet.SafeRelease();
+    first.SafeRelease();
+    second.SafeRelease();
+    unused.SafeRelease();
+    TEST_CHECK(inContext, inDevice->GetNumMadeResidentObjects() == madeResidentBeforeRelease + 1);
+    TEST_CHECK(inContext, residencyManager.GetStats().TrackedBytes == statsBefore.TrackedBytes - textureSize * 3);
+}
+
+static void TestUntrackOnRelease(TestContext& inContext, RHIDevice* inDevice)
+{
+    // No frame begins in between, the resources untrack themselves when their last reference is released
+    RHIResidencyManager& residencyManager = inDevice->GetResidencyManager();
+    const uint64_t trackedBytes = residencyManager.GetStats().TrackedBytes;
+    for(uint32_t i = 0; i < 16; ++i)
+    {
+        RHIBufferDesc desc;
+        desc.Size = 1024 * 1024;
+        desc.Usages = ERHIBufferUsage::VertexBuffer;
+        RefCountPtr<RHIBuffer> buffer = inDevice->CreateBuffer(desc);
+        const RHIObject* released = buffer.GetReference();
+        TEST_CHECK(inContext, residencyManager.IsTracked(released));
+        buffer.SafeRelease();
+        TEST_CHECK(inContext, !residencyManager.IsTracked(released));
+    }
+    TEST_CHECK(inContext, residencyManager.GetStats().TrackedBytes == trackedBytes);
+
+    // A dedicated block of the memory allocator is not in a block list, Trim never sees it. It is untracked with its resource
+    RHIMemoryAllocator& memoryAllocator = inDevice->GetMemoryAllocator();
+    RHIBufferDesc desc;
+    desc.Size = memoryAllocator.GetDedicatedThreshold();
+    desc.Usages = ERHIBufferUsage::VertexBuffer;
+    RefCountPtr<RHIBuffer> dedicated = memoryAllocator.CreateBuffer(desc);
+    TEST_CHECK(inContext, dedicated.IsValid() && dedicated->GetResourceHeap() != nullptr);
+    if(dedicated.IsValid() && dedicated->GetResourceHeap() != nullptr)
+    {
+        const RHIObject* block = dedicated->GetResourceHeap();
+        TEST_CHECK(inContext, residencyManager.IsTracked(block));
+        dedicated.SafeRelease();
+        TEST_CHECK(inContext, !residencyManager.IsTracked(block));
+    }
+    TEST_CHECK(inContext, residencyManager.GetStats().TrackedBytes == trackedBytes);
+}
+
+void Tests::RunResidencyTests(TestContext& inContext)
+{
+    NullDevice* device = static_cast<NullDevice*>(RHI::GetDevice());
+    const uint64_t frameNumber = device->GetFrameContext().GetFrameNumber();
+
+    TestTrackCommittedAndPlaced(inContext, device);
+    TestEvictOverBudget(inContext, device, frameNumber + 1);
+    TestUntrackOnRelease(inContext, device);
+
+    // Back to the frame numbers of the frame context, the objects evicted above are made resident when they are used
+    device->GetResidencyManager().BeginFrame(frameNumber, frameNumber);
+}
\ No newline at end of file
@@ -0,0 +1,42 @@
+#include "Tests.h"
+#include "../RHI/RHI.h"
+#include "../RHI/RHIDevice.h"
+#include "../Core/Log.h"
+
+void TestContext::Check(bool inCondition, const char* inExpression, const char* inFile, int inLine)
+{
+    ++NumChecks;
+    if(!inCondition)
+    {
+        ++NumFailures;
+        Log::Error("[Test] %s(%d): %s failed", inFile, inLine, inExpression);
+    }
+}
+
+bool Tests::RunAll()
+{
+    RHIDevice* device = RHI::GetDevice();
+    if(device == nullptr || device->GetBackend() != ERHIBackend::Null)
+    {
+        Log::Error("[Test] The tests need the null device");
+        return false;
+    }
+
+    TestContext context;
+    RunRDGTests(context);
+    RunResidencyTests(context);
+    RunDefragmenterTests(context);
+    RunTlsfAllocatorTests(context);
+    RunCommandStreamTests(context);
+    RunCommandListPoolTests(context);
+    RunIndirectCountTests(context);
+    RunUploadRingTests(context);
+
+    if(context.NumFailures > 0)
+    {
+        Log::Error("[Test] %u of %u checks failed", context.NumFailures, context.NumChecks);
+        return false;
+    }
+    Log::Info("[Test] All %u checks passed", context.NumChecks);
+    return true;
+}
\ No newline at end of file
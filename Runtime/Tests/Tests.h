@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstdint>
+
+// Counts the checks of a test run, a failed check logs its expression and location
+struct TestContext
+{
+    uint32_t NumChecks = 0;
+    uint32_t NumFailures = 0;
+
+    void Check(bool inCondition, const char* inExpression, const char* inFile, int inLine);
+};
+
+#define TEST_CHECK(context, condition) (context).Check((condition), #condition, __FILE__, __LINE__)
+
+// Self tests of the cpu side of the runtime, run on the null device with the -tests command line
+namespace Tests
+{
+    void RunRDGTests(TestContext& inContext);
+    void RunResidencyTests(TestContext& inContext);
+    void RunDefragmenterTests(TestContext& inContext);
+    void RunTlsfAllocatorTests(TestContext& inContext);
+    void RunCommandStreamTests(TestContext& inContext);
+    void RunCommandListPoolTests(TestContext& inContext);
+    void RunIndirectCountTests(TestContext& inContext);
+    void RunUploadRingTests(TestContext& inContext);
+
+    // Returns false when a check failed
+    bool RunAll();
+}
\ No newline at end of file
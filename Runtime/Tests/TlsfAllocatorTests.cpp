@@ -0,0 +1,105 @@
+#include "Tests.h"
+#include "../Core/TlsfAllocator.h"
+
+static constexpr uint64_t KB = 1024;
+
+static bool IsFreeRanges(const TlsfAllocator& inAllocator, const std::vector<TlsfAllocator::Range>& inExpected)
+{
+    std::vector<TlsfAllocator::Range> ranges;
+    inAllocator.GetFreeRanges(ranges);
+    if(ranges.size() != inExpected.size())
+    {
+        return false;
+    }
+    for(size_t i = 0; i < ranges.size(); ++i)
+    {
+        if(ranges[i].Offset != inExpected[i].Offset || ranges[i].Size != inExpected[i].Size)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void TestAlignedAllocation(TestContext& inContext)
+{
+    TlsfAllocator allocator(64 * KB);
+    uint64_t first, aligned, small;
+    TEST_CHECK(inContext, allocator.TryAllocate(100, 1, first) && first == 0);
+    TEST_CHECK(inContext, allocator.TryAllocate(1000, 4 * KB, aligned) && aligned == 4 * KB);
+
+    // The padding in front of the aligned allocation stays free and takes the next small allocation
+    TEST_CHECK(inContext, IsFreeRanges(allocator, {{100, 4 * KB - 100}, {4 * KB + 1000, 60 * KB - 1000}}));
+    TEST_CHECK(inContext, allocator.TryAllocate(256, 1, small) && small == 100);
+    TEST_CHECK(inContext, allocator.GetUsedSize() == 100 + 1000 + 256);
+    TEST_CHECK(inContext, allocator.GetAllocationCount() == 3);
+
+    // The largest free range is smaller than the whole allocator now
+    uint64_t offset;
+    TEST_CHECK(inContext, !allocator.CanAllocate(64 * KB, 1));
+    TEST_CHECK(inContext, !allocator.TryAllocate(64 * KB, 1, offset) && offset == UINT64_MAX);
+    TEST_CHECK(inContext, allocator.GetAllocationCount() == 3);
+}
+
+static void TestFreeCoalesce(TestContext& inContext)
+{
+    TlsfAllocator allocator(64 * KB);
+    uint64_t first, aligned, small;
+    allocator.TryAllocate(100, 1, first);
+    allocator.TryAllocate(1000, 4 * KB, aligned);
+    allocator.TryAllocate(256, 1, small);
+
+    // Merges with the free ranges on both sides
+    allocator.Free(aligned);
+    TEST_CHECK(inContext, IsFreeRanges(allocator, {{356, 64 * KB - 356}}));
+    // The first block has no free neighbour
+    allocator.Free(first);
+    TEST_CHECK(inContext, IsFreeRanges(allocator, {{0, 100}, {356, 64 * KB - 356}}));
+    allocator.Free(small);
+    TEST_CHECK(inContext, IsFreeRanges(allocator, {{0, 64 * KB}}));
+    TEST_CHECK(inContext, allocator.IsEmpty() && allocator.GetUsedSize() == 0);
+
+    // Freeing an offset which is not allocated is ignored
+    allocator.Free(first);
+    TEST_CHECK(inContext, IsFreeRanges(allocator, {{0, 64 * KB}}));
+
+    uint64_t whole;
+    TEST_CHECK(inContext, allocator.TryAllocate(64 * KB, 64 * KB, whole) && whole == 0);
+}
+
+static void TestFragmentation(TestContext& inContext)
+{
+    TlsfAllocator allocator(64 * KB);
+    uint64_t offsets[16];
+    bool isAllocated = true;
+    for(uint64_t& offset : offsets)
+    {
+        isAllocated = allocator.TryAllocate(4 * KB, 4 * KB, offset) && isAllocated;
+    }
+    TEST_CHECK(inContext, isAllocated);
+    TEST_CHECK(inContext, !allocator.CanAllocate(1, 1));
+
+    // Every other range is free, none of them is adjacent to another
+    for(uint32_t i = 0; i < 16; i += 2)
+    {
+        allocator.Free(offsets[i]);
+    }
+    std::vector<TlsfAllocator::Range> ranges;
+    allocator.GetFreeRanges(ranges);
+    TEST_CHECK(inContext, ranges.size() == 8);
+    TEST_CHECK(inContext, allocator.CanAllocate(4 * KB, 4 * KB));
+    TEST_CHECK(inContext, !allocator.CanAllocate(4 * KB + 1, 1));
+
+    for(uint32_t i = 1; i < 16; i += 2)
+    {
+        allocator.Free(offsets[i]);
+    }
+    TEST_CHECK(inContext, IsFreeRanges(allocator, {{0, 64 * KB}}));
+}
+
+void Tests::RunTlsfAllocatorTests(TestContext& inContext)
+{
+    TestAlignedAllocation(inContext);
+    TestFreeCoalesce(inContext);
+    TestFragmentation(inContext);
+}
\ No newline at end of file
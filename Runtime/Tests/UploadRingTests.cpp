@@ -0,0 +1,118 @@
+#include "Tests.h"
+#include "../RHI/RHI.h"
+#include "../RHI/RHIDevice.h"
+#include "../RHI/RHICommandList.h"
+#include "../RHI/Null/NullDevice.h"
+
+static void TestWraparound(TestContext& inContext, RHIDevice* inDevice)
+{
+    RHIUploadRing ring(*inDevice);
+    TEST_CHECK(inContext, ring.Init(4096));
+    RefCountPtr<RHITimelineFence> fence = inDevice->CreateTimelineFence(0);
+
+    RHIUploadAllocation first = ring.Allocate(1024);
+    RHIUploadAllocation second = ring.Allocate(1024);
+    ring.Submit(fence, 1);
+    RHIUploadAllocation third = ring.Allocate(1536);
+    ring.Submit(fence, 2);
+    TEST_CHECK(inContext, first.Offset == 0 && second.Offset == 1024 && third.Offset == 2048);
+    TEST_CHECK(inContext, first.Buffer == third.Buffer);
+
+    // The first submit retires, the aligned allocation does not fit behind the third one and wraps to the start
+    fence->Signal(1);
+    ring.Retire();
+    TEST_CHECK(inContext, ring.GetStats().UsedBytes == 1536);
+    RHIUploadAllocation wrapped = ring.Allocate(1024, 512);
+    TEST_CHECK(inContext, wrapped.IsValid() && wrapped.Offset == 0 && wrapped.Buffer == first.Buffer);
+    // The skipped end of the buffer stays used until the submit of the wrapped allocation retires
+    TEST_CHECK(inContext, ring.GetStats().UsedBytes == 1536 + 512 + 1024);
+    RHIUploadAllocation behind = ring.Allocate(1024);
+    TEST_CHECK(inContext, behind.Offset == 1024);
+    ring.Submit(fence, 3);
+
+    fence->Signal(3);
+    ring.Retire();
+    TEST_CHECK(inContext, ring.GetStats().UsedBytes == 0);
+    TEST_CHECK(inContext, ring.GetStats().Stalls == 0 && ring.GetStats().Overflows == 0);
+}
+
+static void TestFenceGatedRetirement(TestContext& inContext, RHIDevice* inDevice)
+{
+    RHIUploadRing ring(*inDevice);
+    ring.Init(4096);
+    RefCountPtr<RHITimelineFence> fence = inDevice->CreateTimelineFence(0);
+
+    ring.Allocate(1024);
+    ring.Submit(fence, 1);
+    ring.Allocate(1024);
+    ring.Submit(fence, 2);
+
+    // Nothing retires before its fence, the submits retire in order
+    ring.Retire();
+    TEST_CHECK(inContext, ring.GetStats().UsedBytes == 2048);
+    fence->Signal(1);
+    ring.Retire();
+    TEST_CHECK(inContext, ring.GetStats().UsedBytes == 1024);
+    fence->Signal(2);
+    ring.Retire();
+    TEST_CHECK(inContext, ring.GetStats().UsedBytes == 0);
+}
+
+static void TestStallOnFullRing(TestContext& inContext, NullDevice* inDevice)
+{
+    RHIUploadRing ring(*inDevice);
+    ring.Init(4096);
+    inDevice->SetSimulatedGpuTime(std::chrono::milliseconds(20));
+
+    // The gpu is still busy with the submit which holds the whole ring, the allocation waits for its fence
+    RefCountPtr<RHIFence> fence = inDevice->CreateRhiFence();
+    RefCountPtr<RHICommandList> commandList = inDevice->CreateCommandList();
+    commandList->Begin();
+    commandList->End();
+    ring.Allocate(4096);
+    inDevice->ExecuteCommandList(commandList, fence);
+    ring.Submit(fence);
+    TEST_CHECK(inContext, !fence->IsCompleted());
+    
+    RHIUploadAllocation allocation = ring.Allocate(1024);
+    TEST_CHECK(inContext, allocation.IsValid() && allocation.Offset == 0);
+    TEST_CHECK(inContext, fence->IsCompleted());
+    TEST_CHECK(inContext, ring.GetStats().Stalls == 1 && ring.GetStats().Overflows == 0);
+    inDevice->SetSimulatedGpuTime(std::chrono::microseconds(0));
+}
+
+static void TestOverflowBuffers(TestContext& inContext, RHIDevice* inDevice)
+{
+    RHIUploadRing ring(*inDevice);
+    ring.Init(4096);
+    RefCountPtr<RHITimelineFence> fence = inDevice->CreateTimelineFence(0);
+
+    // Larger than the ring
+    RHIUploadAllocation large = ring.Allocate(8192);
+    RHIUploadAllocation inRing = ring.Allocate(4096);
+    TEST_CHECK(inContext, large.IsValid() && large.Buffer != inRing.Buffer && large.Offset == 0);
+    // The current submit filled the ring, its ranges can not be waited on
+    RHIUploadAllocation full = ring.Allocate(16);
+    TEST_CHECK(inContext, full.IsValid() && full.Buffer != inRing.Buffer && full.Buffer != large.Buffer);
+    TEST_CHECK(inContext, ring.GetStats().Overflows == 2 && ring.GetStats().Stalls == 0);
+
+    // The staging buffers live until the fence of their submit
+    RefCountPtr<RHIBuffer> largeBuffer(large.Buffer);
+    RefCountPtr<RHIBuffer> fullBuffer(full.Buffer);
+    ring.Submit(fence, 1);
+    ring.Retire();
+    TEST_CHECK(inContext, largeBuffer.GetRefCount() == 2 && fullBuffer.GetRefCount() == 2);
+    fence->Signal(1);
+    ring.Retire();
+    TEST_CHECK(inContext, largeBuffer.GetRefCount() == 1 && fullBuffer.GetRefCount() == 1);
+    TEST_CHECK(inContext, ring.GetStats().UsedBytes == 0);
+}
+
+void Tests::RunUploadRingTests(TestContext& inContext)
+{
+    NullDevice* device = static_cast<NullDevice*>(RHI::GetDevice());
+    TestWraparound(inContext, device);
+    TestFenceGatedRetirement(inContext, device);
+    TestStallOnFullRing(inContext, device);
+    TestOverflowBuffers(inContext, device);
+}
\ No newline at end of file
@@ -0,0 +1,49 @@
+#include "FramePacingBenchmark.h"
+#include "../RHI/Null/NullDevice.h"
+#include "../Core/Log.h"
+#include "../Core/Templates.h"
+#include <chrono>
+#include <thread>
+
+FramePacingBenchmarkResult FramePacingBenchmark::Run(const FramePacingBenchmarkDesc& inDesc)
+{
+    FramePacingBenchmarkResult result;
+    RHIDevice* device = RHI::GetDevice();
+    if(inDesc.NumFrames == 0 || device == nullptr || device->GetBackend() != ERHIBackend::Null)
+    {
+        Log::Error("[RHI] The frame pacing benchmark needs frames and the null device");
+        return result;
+    }
+
+    NullDevice* nullDevice = CheckCast<NullDevice*>(device);
+    nullDevice->SetSimulatedGpuTime(std::chrono::microseconds(static_cast<int64_t>(inDesc.GpuFrameTime * 1000.0)));
+
+    RHIFrameContext& frameContext = device->GetFrameContext();
+    frameContext.Shutdown();
+    frameContext.Init(inDesc.NumFramesInFlight);
+
+    const auto cpuFrameTime = std::chrono::microseconds(static_cast<int64_t>(inDesc.CpuFrameTime * 1000.0));
+    const auto start = std::chrono::high_resolution_clock::now();
+    for(uint32_t i = 0; i < inDesc.NumFrames; ++i)
+    {
+        RefCountPtr<RHICommandList>& commandList = frameContext.BeginFrame();
+        commandList->BeginMark("Frame");
+        std::this_thread::sleep_for(cpuFrameTime);
+        commandList->EndMark();
+        commandList->End();
+        frameContext.EndFrame();
+    }
+    frameContext.WaitIdle();
+    const double totalTime = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+    const RHIFrameContextStats& stats = frameContext.GetStats();
+    result.FrameTime = totalTime / inDesc.NumFrames;
+    result.StallTime = stats.StallTime / inDesc.NumFrames;
+    result.NumStalls = stats.Stalls;
+    Log::Info("[RHI] Frame pacing: %u frames in flight, cpu %.2f ms, gpu %.2f ms: frame %.3f ms, stall %.3f ms, %llu stalls"
+        , frameContext.GetNumFramesInFlight(), inDesc.CpuFrameTime, inDesc.GpuFrameTime, result.FrameTime, result.StallTime, result.NumStalls);
+
+    frameContext.Shutdown();
+    nullDevice->SetSimulatedGpuTime(std::chrono::microseconds(0));
+    return result;
+}
\ No newline at end of file
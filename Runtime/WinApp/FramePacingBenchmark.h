@@ -0,0 +1,26 @@
+#pragma once
+
+#include "../RHI/RHI.h"
+
+struct FramePacingBenchmarkDesc
+{
+    uint32_t NumFrames = 120;
+    uint32_t NumFramesInFlight = RHIFrameContext::s_DefaultNumFramesInFlight;
+    double CpuFrameTime = 8.0;  // Milliseconds the cpu records a frame
+    double GpuFrameTime = 8.0;  // Milliseconds the simulated gpu executes a frame
+};
+
+struct FramePacingBenchmarkResult
+{
+    double FrameTime = 0;       // Average in milliseconds
+    double StallTime = 0;       // Average milliseconds the cpu waited for the gpu per frame
+    uint64_t NumStalls = 0;
+};
+
+// Measures how much cpu time the frames in flight of RHIFrameContext save, on the null device with a simulated gpu
+// time per submission. One frame in flight serializes the cpu and gpu work like a CpuWait after every submit
+class FramePacingBenchmark
+{
+public:
+    static FramePacingBenchmarkResult Run(const FramePacingBenchmarkDesc& inDesc);
+};
\ No newline at end of file
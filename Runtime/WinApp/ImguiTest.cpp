@@ -119,50 +119,60 @@ void ImGuiTestApp::Tick()
 
     ImDrawData *drawData = ImGui::GetDrawData();
     
+    // the frame context waits for the frame which last used this slot, so its buffers and command lists are free
+    RHIFrameContext& frameContext = RHI::GetDevice()->GetFrameContext();
+    RefCountPtr<RHICommandList>& commandList = frameContext.BeginFrame();
+    RefCountPtr<RHICommandList>& copyCommandList = frameContext.GetCommandList(ERHICommandQueueType::Copy);
+    RHIBufferRef& vertexBuffer = m_VertexBuffers[frameContext.GetFrameIndex()];
+    RHIBufferRef& indexBuffer = m_IndexBuffers[frameContext.GetFrameIndex()];
+
+    RHIConstantAllocator& constantAllocator = RHI::GetDevice()->GetConstantAllocator();
     glm::vec2 invDisplaySize( 1.f / io.DisplaySize.x, 1.f / io.DisplaySize.y );
-    m_ConstantsBuffer->WriteData(&invDisplaySize, sizeof(glm::vec2));
+    m_ResourceSet->BindBufferCBV(0, 0, constantAllocator.Allocate(invDisplaySize));
     
-    ReallocateBuffer(m_VertexBuffer, drawData->TotalVtxCount * sizeof(ImDrawVert), 
+    ReallocateBuffer(vertexBuffer, drawData->TotalVtxCount * sizeof(ImDrawVert), 
         (drawData->TotalVtxCount + 5000) * sizeof(ImDrawVert));
-    ReallocateBuffer(m_IndexBuffer,
+    ReallocateBuffer(indexBuffer,
         drawData->TotalIdxCount * sizeof(ImDrawIdx),
         (drawData->TotalIdxCount + 5000) * sizeof(ImDrawIdx));
-    m_VtxBuffer.resize(m_VertexBuffer->GetDesc().Size / sizeof(ImDrawVert));
-    m_IdxBuffer.resize(m_IndexBuffer->GetDesc().Size / sizeof(ImDrawIdx));
+    // copy and convert all vertices into a single contiguous range of the upload ring
+    RHIUploadRing& uploadRing = RHI::GetDevice()->GetUploadRing();
+    const size_t vtxSize = drawData->TotalVtxCount * sizeof(ImDrawVert);
+    const size_t idxSize = drawData->TotalIdxCount * sizeof(ImDrawIdx);
+    RHIUploadAllocation vtxAllocation = vtxSize > 0 ? uploadRing.Allocate(vtxSize) : RHIUploadAllocation();
+    RHIUploadAllocation idxAllocation = idxSize > 0 ? uploadRing.Allocate(idxSize) : RHIUploadAllocation();
+    copyCommandList->Begin();
+    if(vtxAllocation.IsValid() && idxAllocation.IsValid())
+    {
+        ImDrawVert *vtxDst = reinterpret_cast<ImDrawVert*>(vtxAllocation.CpuAddress);
+        ImDrawIdx *idxDst = reinterpret_cast<ImDrawIdx*>(idxAllocation.CpuAddress);
 
-    // copy and convert all vertices into a single contiguous buffer
-    ImDrawVert *vtxDst = &m_VtxBuffer[0];
-    ImDrawIdx *idxDst = &m_IdxBuffer[0];
+        for(int n = 0; n < drawData->CmdListsCount; n++)
+        {
+            const ImDrawList *cmdList = drawData->CmdLists[n];
 
-    for(int n = 0; n < drawData->CmdListsCount; n++)
-    {
-        const ImDrawList *cmdList = drawData->CmdLists[n];
+            memcpy(vtxDst, cmdList->VtxBuffer.Data, cmdList->VtxBuffer.Size * sizeof(ImDrawVert));
+            memcpy(idxDst, cmdList->IdxBuffer.Data, cmdList->IdxBuffer.Size * sizeof(ImDrawIdx));
 
-        memcpy(vtxDst, cmdList->VtxBuffer.Data, cmdList->VtxBuffer.Size * sizeof(ImDrawVert));
-        memcpy(idxDst, cmdList->IdxBuffer.Data, cmdList->IdxBuffer.Size * sizeof(ImDrawIdx));
+            vtxDst += cmdList->VtxBuffer.Size;
+            idxDst += cmdList->IdxBuffer.Size;
+        }
 
-        vtxDst += cmdList->VtxBuffer.Size;
-        idxDst += cmdList->IdxBuffer.Size;
+        RHIBufferRef vtxUploadBuffer = vtxAllocation.Buffer;
+        RHIBufferRef idxUploadBuffer = idxAllocation.Buffer;
+        copyCommandList->CopyBuffer(vertexBuffer, 0, vtxUploadBuffer, vtxAllocation.Offset, vtxSize);
+        copyCommandList->CopyBuffer(indexBuffer, 0, idxUploadBuffer, idxAllocation.Offset, idxSize);
     }
-    
-    RHIBufferRef vertexStagingBuffer = RHI::GetDevice()->CreateBuffer(RHIBufferDesc::StagingBuffer(m_VertexBuffer->GetDesc().Size));
-    RHIBufferRef indexStagingBuffer = RHI::GetDevice()->CreateBuffer(RHIBufferDesc::StagingBuffer(m_IndexBuffer->GetDesc().Size));
-    vertexStagingBuffer->WriteData(m_VtxBuffer.data(), m_VertexBuffer->GetDesc().Size);
-    indexStagingBuffer->WriteData(m_IdxBuffer.data(), m_IndexBuffer->GetDesc().Size);
-    m_CopyCommandList->Begin();
-    m_CopyCommandList->CopyBuffer(m_VertexBuffer, 0, vertexStagingBuffer, 0, m_VertexBuffer->GetDesc().Size);
-    m_CopyCommandList->CopyBuffer(m_IndexBuffer, 0, indexStagingBuffer, 0, m_IndexBuffer->GetDesc().Size);
-    m_CopyCommandList->End();
+    copyCommandList->End();
     RHI::GetDevice()->AddQueueSignalSemaphore(ERHICommandQueueType::Copy, m_Semaphore);
-    RHI::GetDevice()->ExecuteCommandList(m_CopyCommandList);
+    RHI::GetDevice()->ExecuteCommandList(copyCommandList);
 
     drawData->ScaleClipRects(io.DisplayFramebufferScale);
     
-    m_CommandList->Begin();
     uint32_t currentFrame = m_SwapChain->GetCurrentBackBufferIndex();
 
     RefCountPtr<RHITexture> colorAttachment = m_SwapChain->GetCurrentBackBuffer();
-    m_CommandList->ResourceBarrier(colorAttachment, ERHIResourceStates::RenderTarget);
+    commandList->ResourceBarrier(colorAttachment, ERHIResourceStates::RenderTarget);
 
     std::vector<RHIViewport> viewports;
     viewports.push_back(RHIViewport::Create((float)m_Width, (float)m_Height));
@@ -172,16 +182,16 @@ void ImGuiTestApp::Tick()
     RHIClearValue clearColor(0.45f, 0.55f, 0.60f, 1.00f);
     
     // Render GUI
-    m_CommandList->BeginMark("ImGUI");
+    commandList->BeginMark("ImGUI");
 
     // ImDrawData *drawData = ImGui::GetDrawData();
-    m_CommandList->SetPipelineState(m_GraphicsPipeline);
-    m_CommandList->SetFrameBuffer(m_FrameBuffers[currentFrame], &clearColor, 1);
-    m_CommandList->SetViewports(viewports);
-    m_CommandList->SetScissorRects(scissorRects);
-    m_CommandList->SetVertexBuffer(m_VertexBuffer);
-    m_CommandList->SetIndexBuffer(m_IndexBuffer);
-    m_CommandList->SetResourceSet(m_ResourceSet);
+    commandList->SetPipelineState(m_GraphicsPipeline);
+    commandList->SetFrameBuffer(m_FrameBuffers[currentFrame], &clearColor, 1);
+    commandList->SetViewports(viewports);
+    commandList->SetScissorRects(scissorRects);
+    commandList->SetVertexBuffer(vertexBuffer);
+    commandList->SetIndexBuffer(indexBuffer);
+    commandList->SetResourceSet(m_ResourceSet);
     // render command lists
     int vtxOffset = 0;
     int idxOffset = 0;
@@ -198,7 +208,7 @@ void ImGuiTestApp::Tick()
             else
             {
                 
-                m_CommandList->DrawIndexed(pCmd->ElemCount, 1, idxOffset, vtxOffset, 0);
+                commandList->DrawIndexed(pCmd->ElemCount, 1, idxOffset, vtxOffset, 0);
             }
 
             idxOffset += pCmd->ElemCount;
@@ -207,18 +217,18 @@ void ImGuiTestApp::Tick()
         vtxOffset += cmdList->VtxBuffer.Size;
     }
     
-    m_CommandList->EndMark();
+    commandList->EndMark();
 
-    m_CommandList->ResourceBarrier(colorAttachment, ERHIResourceStates::Present);
-    m_CommandList->End();
+    commandList->ResourceBarrier(colorAttachment, ERHIResourceStates::Present);
+    commandList->End();
     RHI::GetDevice()->AddQueueWaitForSemaphore(ERHICommandQueueType::Direct, m_Semaphore);
-    RHI::GetDevice()->ExecuteCommandList(m_CommandList, m_Fence);
-    m_Fence->CpuWait();
+    frameContext.EndFrame();
     m_SwapChain->Present();
 }
 
 void ImGuiTestApp::Shutdown()
 {
+    RHI::GetDevice()->GetFrameContext().WaitIdle();
     m_DepthStencilTexture.SafeRelease();
     for(uint32_t i = 0; i < m_FrameBuffers.size(); ++i)
     {
@@ -281,12 +291,12 @@ void ImGuiTestApp::CreateFrameBuffer()
 void ImGuiTestApp::CreateResources()
 {
     RHIBufferDesc vertexBufferDesc = RHIBufferDesc::VertexBuffer(1024, sizeof(ImDrawVert));
-    m_VertexBuffer = RHI::GetDevice()->CreateBuffer(vertexBufferDesc);
     RHIBufferDesc indexBufferDesc = RHIBufferDesc::IndexBuffer(1024, ERHIFormat::R16_UINT);
-    m_IndexBuffer = RHI::GetDevice()->CreateBuffer(indexBufferDesc);
-
-    RHIBufferDesc constantsBufferDesc = RHIBufferDesc::ConstantsBuffer(sizeof(glm::vec2));
-    m_ConstantsBuffer = RHI::GetDevice()->CreateBuffer(constantsBufferDesc);
+    for(uint32_t i = 0; i < RHIFrameContext::s_MaxNumFramesInFlight; ++i)
+    {
+        m_VertexBuffers[i] = RHI::GetDevice()->CreateBuffer(vertexBufferDesc);
+        m_IndexBuffers[i] = RHI::GetDevice()->CreateBuffer(indexBufferDesc);
+    }
 
     ImFontConfig fontConfig;
     fontConfig.FontDataOwnedByAtlas = false;
@@ -316,15 +326,11 @@ void ImGuiTestApp::CreateResources()
     
     io.Fonts->TexID = m_FontTexture.GetReference();
 
-    RHIBufferDesc textureStagingBufferDesc = RHIBufferDesc::StagingBuffer(width * height * 4);
-    RHIBufferRef textureStagingBuffer = RHI::GetDevice()->CreateBuffer(textureStagingBufferDesc);
-    textureStagingBuffer->WriteData(pixels, width * height * 4);
-
     RHISamplerDesc samplerDesc;
     m_FontSampler = RHI::GetDevice()->CreateSampler(samplerDesc);
     
     m_CopyCommandList->Begin();
-    m_CopyCommandList->CopyBufferToTexture(m_FontTexture, textureStagingBuffer);
+    RHI::GetDevice()->GetUploadRing().UploadTexture(m_CopyCommandList, m_FontTexture, pixels);
     m_CopyCommandList->End();
     
     RHI::GetDevice()->AddQueueSignalSemaphore(ERHICommandQueueType::Copy, m_Semaphore);
@@ -335,10 +341,10 @@ void ImGuiTestApp::CreateResources()
     m_CommandList->End();
     RHI::GetDevice()->AddQueueWaitForSemaphore(ERHICommandQueueType::Direct, m_Semaphore);
     RHI::GetDevice()->ExecuteCommandList(m_CommandList, m_Fence);
+    RHI::GetDevice()->GetUploadRing().Submit(m_Fence);
     m_Fence->CpuWait();
 
     m_ResourceSet = RHI::GetDevice()->CreateResourceSet(m_GraphicsPassBindingLayout);
-    m_ResourceSet->BindBufferCBV(0, 0, m_ConstantsBuffer);
     m_ResourceSet->BindSampler(0, 0, m_FontSampler);
     m_ResourceSet->BindTextureSRV(0, 0, m_FontTexture);
 }
@@ -50,12 +50,9 @@ private:
     RHISamplerRef m_FontSampler;
     RHIBufferRef m_GUIConstants;
 
-    RHIBufferRef m_VertexBuffer;
-    RHIBufferRef m_IndexBuffer;
-    RHIBufferRef m_ConstantsBuffer;
-    
-    std::vector<ImDrawVert> m_VtxBuffer;
-    std::vector<ImDrawIdx> m_IdxBuffer;
+    // one per frame in flight, the gpu may still read the buffers of the previous frames
+    std::array<RHIBufferRef, RHIFrameContext::s_MaxNumFramesInFlight> m_VertexBuffers;
+    std::array<RHIBufferRef, RHIFrameContext::s_MaxNumFramesInFlight> m_IndexBuffers;
 
     RHIResourceSetRef m_ResourceSet;
 };
\ No newline at end of file
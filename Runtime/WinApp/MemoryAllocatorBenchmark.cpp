@@ -0,0 +1,69 @@
+#include "MemoryAllocatorBenchmark.h"
+#include "../RHI/RHIDevice.h"
+#include "../Core/Log.h"
+#include <chrono>
+#include <cmath>
+#include <random>
+
+MemoryAllocatorBenchmarkResult MemoryAllocatorBenchmark::Run(const MemoryAllocatorBenchmarkDesc& inDesc)
+{
+    MemoryAllocatorBenchmarkResult result;
+    RHIDevice* device = RHI::GetDevice();
+    if(inDesc.NumIterations == 0 || inDesc.NumLiveBuffers == 0 || device == nullptr || device->GetBackend() != ERHIBackend::Null)
+    {
+        Log::Error("[RHI] The memory allocator benchmark needs iterations, live buffers and the null device");
+        return result;
+    }
+
+    // Both passes create the same sequence of sizes and replaced slots
+    std::vector<std::pair<uint64_t, uint32_t>> sequence(inDesc.NumIterations);
+    std::mt19937 random(inDesc.Seed);
+    std::uniform_real_distribution<double> sizeDistribution(std::log2(static_cast<double>(inDesc.MinBufferSize)), std::log2(static_cast<double>(inDesc.MaxBufferSize)));
+    std::uniform_int_distribution<uint32_t> slotDistribution(0, inDesc.NumLiveBuffers - 1);
+    for(auto& step : sequence)
+    {
+        step.first = static_cast<uint64_t>(std::exp2(sizeDistribution(random)));
+        step.second = slotDistribution(random);
+    }
+
+    std::vector<RefCountPtr<RHIBuffer>> buffers(inDesc.NumLiveBuffers);
+    auto start = std::chrono::high_resolution_clock::now();
+    for(const auto& step : sequence)
+    {
+        RefCountPtr<RHIBuffer> buffer = device->CreateBuffer(RHIBufferDesc::StructuredBuffer(step.first, 4, ERHIBufferUsage::ShaderResource), true);
+        RHIResourceHeapDesc heapDesc;
+        heapDesc.Size = buffer->GetAllocSizeInByte();
+        heapDesc.Alignment = buffer->GetAllocAlignment();
+        buffer->BindMemory(device->CreateResourceHeap(heapDesc));
+        buffers[step.second] = buffer;
+        ++result.DedicatedHeapCreations;
+    }
+    result.DedicatedCreateTime = std::chrono::duration<double, std::micro>(std::chrono::high_resolution_clock::now() - start).count() / inDesc.NumIterations;
+    buffers.assign(inDesc.NumLiveBuffers, nullptr);
+
+    RHIMemoryAllocator& allocator = device->GetMemoryAllocator();
+    allocator.Clear();
+    allocator.ResetStats();
+    start = std::chrono::high_resolution_clock::now();
+    for(uint32_t i = 0; i < inDesc.NumIterations; ++i)
+    {
+        const auto& step = sequence[i];
+        buffers[step.second] = allocator.CreateBuffer(RHIBufferDesc::StructuredBuffer(step.first, 4, ERHIBufferUsage::ShaderResource));
+        if((i + 1) % inDesc.IterationsPerFrame == 0)
+        {
+            allocator.Trim();
+        }
+    }
+    result.AllocatorCreateTime = std::chrono::duration<double, std::micro>(std::chrono::high_resolution_clock::now() - start).count() / inDesc.NumIterations;
+
+    const RHIMemoryAllocatorStats stats = allocator.GetStats();
+    result.AllocatorHeapCreations = stats.BlockCreations + stats.DedicatedAllocations;
+    result.AllocatorUtilization = stats.BlockBytes > 0 ? static_cast<double>(stats.UsedBytes) / stats.BlockBytes : 0;
+    Log::Info("[RHI] Memory allocator: %u buffers, heap per buffer %.2f us and %llu heaps, allocator %.2f us and %llu heaps, %u blocks %.1f%% used"
+        , inDesc.NumIterations, result.DedicatedCreateTime, result.DedicatedHeapCreations
+        , result.AllocatorCreateTime, result.AllocatorHeapCreations, stats.Blocks, result.AllocatorUtilization * 100.0);
+
+    buffers.clear();
+    allocator.Clear();
+    return result;
+}
\ No newline at end of file
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "../RHI/RHI.h"
+
+struct MemoryAllocatorBenchmarkDesc
+{
+    uint32_t NumIterations = 20000;
+    uint32_t NumLiveBuffers = 512;          // a random live buffer is replaced every iteration
+    uint64_t MinBufferSize = 256;
+    uint64_t MaxBufferSize = 2ull * 1024 * 1024;
+    uint32_t IterationsPerFrame = 64;       // RHIMemoryAllocator::Trim runs once per frame
+    uint32_t Seed = 1;
+};
+
+struct MemoryAllocatorBenchmarkResult
+{
+    double DedicatedCreateTime = 0;     // Average microseconds per buffer with a heap per buffer
+    double AllocatorCreateTime = 0;     // Average microseconds per buffer with RHIMemoryAllocator
+    uint64_t DedicatedHeapCreations = 0;
+    uint64_t AllocatorHeapCreations = 0;
+    double AllocatorUtilization = 0;    // Bytes bound to buffers per byte of the blocks at the end
+};
+
+// Creates and destroys buffers of random sizes on the null device, once with a heap per buffer like the committed
+// resources of the backends and once sub-allocated by RHIMemoryAllocator. Every heap creation is a driver allocation
+// on the gpu backends
+class MemoryAllocatorBenchmark
+{
+public:
+    static MemoryAllocatorBenchmarkResult Run(const MemoryAllocatorBenchmarkDesc& inDesc);
+};
\ No newline at end of file
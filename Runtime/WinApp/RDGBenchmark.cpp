@@ -0,0 +1,163 @@
+#include "RDGBenchmark.h"
+#include "../RHI/RHIDevice.h"
+#include "../RDG/RDGDebug.h"
+#include "../Core/Log.h"
+#include <chrono>
+
+static double GetElapsedMilliseconds(const std::chrono::high_resolution_clock::time_point& inStart)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - inStart).count();
+}
+
+RDGBenchmarkResult RDGBenchmark::Run(const RDGBenchmarkDesc& inDesc)
+{
+    RDGBenchmarkResult result;
+    if(inDesc.NumIterations == 0 || inDesc.NumPasses == 0 || inDesc.NumTextures == 0 || inDesc.NumBuffers == 0)
+    {
+        Log::Error("[RDG] Invalid benchmark desc");
+        return result;
+    }
+
+    RHIDevice* device = RHI::GetDevice();
+    if(device == nullptr || device->GetBackend() != ERHIBackend::Null)
+    {
+        Log::Error("[RDG] The RDG benchmark runs headless, it needs the null device");
+        return result;
+    }
+    
+    RDGraph* graph = RDG::GetGraph();
+    graph->Shutdown();
+
+    RHITextureDesc backBufferDesc = RHITextureDesc::Texture2D(64, 64, ERHIFormat::RGBA8_UNORM);
+    backBufferDesc.Usages = ERHITextureUsage::RenderTarget;
+    RHITextureRef backBuffer = device->CreateTexture(backBufferDesc);
+    backBuffer->SetName("Benchmark BackBuffer");
+    
+    for(uint32_t i = 0; i < inDesc.NumIterations; ++i)
+    {
+        // Same seed each iteration, so the pooled resources are reused like in a steady state frame
+        std::mt19937 random(inDesc.Seed);
+        graph->Reset();
+        
+        auto start = std::chrono::high_resolution_clock::now();
+        BuildGraph(graph, inDesc, random, backBuffer);
+        result.AddPassTime += GetElapsedMilliseconds(start);
+
+        start = std::chrono::high_resolution_clock::now();
+        graph->Compile();
+        result.CompileTime += GetElapsedMilliseconds(start);
+
+        start = std::chrono::high_resolution_clock::now();
+        graph->Execute();
+        result.ExecuteTime += GetElapsedMilliseconds(start);
+    }
+
+    result.AddPassTime /= inDesc.NumIterations;
+    result.CompileTime /= inDesc.NumIterations;
+    result.ExecuteTime /= inDesc.NumIterations;
+
+    for(RDGNodeHandle i = 0; i < graph->GetNumPasses(); ++i)
+    {
+        const RDGPass* pass = graph->GetPass(i);
+        if(pass->IsCulled())
+            result.NumCulledPasses++;
+        if(pass->IsRaster() && !pass->GetRenderPassInfo().BeginRenderPass)
+            result.NumMergedPasses++;
+        result.NumBarriers += static_cast<uint32_t>(pass->GetBarriers().size());
+    }
+
+    const RDGResourcePoolStats& poolStats = graph->GetResourcePool().GetStats();
+    Log::Info("[RDG] Benchmark: %u passes, %u textures, %u buffers, %u iterations"
+        , inDesc.NumPasses, inDesc.NumTextures, inDesc.NumBuffers, inDesc.NumIterations);
+    Log::Info("[RDG] AddPass: %.4f ms, Compile: %.4f ms, Execute: %.4f ms"
+        , result.AddPassTime, result.CompileTime, result.ExecuteTime);
+    Log::Info("[RDG] Culled passes: %u, Merged passes: %u, Barriers: %u"
+        , result.NumCulledPasses, result.NumMergedPasses, result.NumBarriers);
+    Log::Info("[RDG] Resource pool hits: %llu, misses: %llu", poolStats.Hits, poolStats.Misses);
+
+    if(!inDesc.DumpDirectory.empty())
+    {
+        std::filesystem::create_directories(inDesc.DumpDirectory);
+        RDG::DumpGraphviz(*graph, inDesc.DumpDirectory / "RDGBenchmark.dot");
+        RDG::DumpJson(*graph, inDesc.DumpDirectory / "RDGBenchmark.json");
+    }
+
+    graph->Shutdown();
+    return result;
+}
+
+void RDGBenchmark::BuildGraph(RDGraph* inGraph, const RDGBenchmarkDesc& inDesc, std::mt19937& inRandom, RHITextureRef& inBackBuffer)
+{
+    RDGNodeHandle backBuffer = inGraph->AddResource("BackBuffer", inBackBuffer, ERHIResourceStates::Present);
+
+    RHITextureDesc textureDesc = RHITextureDesc::Texture2D(64, 64, ERHIFormat::RGBA8_UNORM);
+    textureDesc.Usages = ERHITextureUsage::RenderTarget | ERHITextureUsage::ShaderResource;
+    RHIBufferDesc bufferDesc = RHIBufferDesc::StructuredBuffer(1024, 16, ERHIBufferUsage::UnorderedAccess | ERHIBufferUsage::ShaderResource);
+    
+    std::vector<RDGNodeHandle> textures(inDesc.NumTextures);
+    std::vector<RDGNodeHandle> buffers(inDesc.NumBuffers);
+    for(uint32_t i = 0; i < inDesc.NumTextures; ++i)
+        textures[i] = inGraph->AddResource("Texture", textureDesc);
+    for(uint32_t i = 0; i < inDesc.NumBuffers; ++i)
+        buffers[i] = inGraph->AddResource("Buffer", bufferDesc);
+
+    // Resources written so far, reads only pick from them to keep the graph acyclic in submission order
+    std::vector<RDGNodeHandle> written;
+    written.reserve(inDesc.NumTextures + inDesc.NumBuffers);
+    
+    std::uniform_real_distribution<float> chance(0.0f, 1.0f);
+    std::uniform_int_distribution<uint32_t> readCount(0, inDesc.MaxReadsPerPass);
+    std::uniform_int_distribution<uint32_t> writeCount(1, std::max(inDesc.MaxWritesPerPass, 1u));
+    std::uniform_int_distribution<uint32_t> textureIndex(0, inDesc.NumTextures - 1);
+    std::uniform_int_distribution<uint32_t> bufferIndex(0, inDesc.NumBuffers - 1);
+    RDGNodeHandle prevTarget = RDGInvalidHandle;
+    
+    for(uint32_t i = 0; i < inDesc.NumPasses; ++i)
+    {
+        const bool isLastPass = i + 1 == inDesc.NumPasses;
+        const size_t numWrittenBefore = written.size();
+        RDGNodeHandle pass;
+        RDGNodeHandle target = RDGInvalidHandle;
+        
+        if(isLastPass || chance(inRandom) < inDesc.RasterPassRatio)
+        {
+            RDGRenderTargets renderTargets;
+            // Keep drawing into the previous target half of the time so there is something to merge
+            target = isLastPass ? backBuffer : (prevTarget != RDGInvalidHandle && chance(inRandom) < 0.5f ? prevTarget : textures[textureIndex(inRandom)]);
+            renderTargets.Colors[0].Texture = target;
+            renderTargets.Colors[0].LoadAction = chance(inRandom) < 0.25f ? ERDGLoadAction::Clear : ERDGLoadAction::Load;
+            pass = inGraph->AddRasterPass("Raster", renderTargets, [](RHICommandList*, const RDGRenderPassInfo&) {});
+            prevTarget = target;
+            written.push_back(target);
+        }
+        else
+        {
+            pass = inGraph->AddPass("Compute", [](){});
+            const uint32_t numWrites = writeCount(inRandom);
+            for(uint32_t w = 0; w < numWrites; ++w)
+            {
+                RDGNodeHandle buffer = buffers[bufferIndex(inRandom)];
+                inGraph->WriteResource(pass, buffer, ERHIResourceStates::UnorderedAccess);
+                written.push_back(buffer);
+            }
+            prevTarget = RDGInvalidHandle;
+        }
+
+        // Only read what earlier passes produced, a resource read and written by the same pass would need two barriers
+        if(numWrittenBefore > 0)
+        {
+            std::uniform_int_distribution<size_t> writtenIndex(0, numWrittenBefore - 1);
+            const uint32_t numReads = readCount(inRandom);
+            for(uint32_t r = 0; r < numReads; ++r)
+            {
+                RDGNodeHandle res = written[writtenIndex(inRandom)];
+                bool isWrittenByPass = false;
+                for(size_t w = numWrittenBefore; w < written.size(); ++w)
+                    isWrittenByPass |= written[w] == res;
+                
+                if(!isWrittenByPass)
+                    inGraph->ReadResource(pass, res, ERHIResourceStates::GpuReadOnly);
+            }
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "../RDG/RDG.h"
+#include <filesystem>
+#include <random>
+
+struct RDGBenchmarkDesc
+{
+    uint32_t NumPasses = 256;
+    uint32_t NumTextures = 32;
+    uint32_t NumBuffers = 64;
+    uint32_t MaxReadsPerPass = 4;   // fan-in
+    uint32_t MaxWritesPerPass = 2;  // fan-out of compute passes
+    float RasterPassRatio = 0.5f;
+    uint32_t NumIterations = 100;
+    uint32_t Seed = 0;
+    std::filesystem::path DumpDirectory; // Graphviz and json dumps of the last iteration are written here when not empty
+};
+
+struct RDGBenchmarkResult
+{
+    double AddPassTime = 0;     // Average in milliseconds
+    double CompileTime = 0;
+    double ExecuteTime = 0;
+    uint32_t NumCulledPasses = 0;
+    uint32_t NumMergedPasses = 0;
+    uint32_t NumBarriers = 0;
+};
+
+// Measures the CPU cost of building, compiling and executing randomly generated graphs with no-op passes.
+// Runs on the RDG global graph and the null device, so it must not be used while an app owns the graph
+class RDGBenchmark
+{
+public:
+    static RDGBenchmarkResult Run(const RDGBenchmarkDesc& inDesc);
+    
+private:
+    static void BuildGraph(RDGraph* inGraph, const RDGBenchmarkDesc& inDesc, std::mt19937& inRandom, RHITextureRef& inBackBuffer);
+};
\ No newline at end of file
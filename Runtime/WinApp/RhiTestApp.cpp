@@ -18,6 +18,9 @@ bool RhiTestApp::Init()
     case ERHIBackend::D3D12:
         Log::Info("RHI backend: D3D12");
         break;
+    case ERHIBackend::Null:
+        Log::Info("RHI backend: Null");
+        break;
     }
     
     m_Fence = RHI::GetDevice()->CreateRhiFence();
@@ -101,37 +104,38 @@ void RhiTestApp::Tick()
     {
         return;
     }
-    m_CommandList->Begin();
+    RHIFrameContext& frameContext = RHI::GetDevice()->GetFrameContext();
+    RefCountPtr<RHICommandList>& commandList = frameContext.BeginFrame();
     uint32_t currentFrame = m_SwapChain->GetCurrentBackBufferIndex();
     
     RefCountPtr<RHITexture> colorAttachment = m_SwapChain->GetCurrentBackBuffer();
-    m_CommandList->ResourceBarrier(colorAttachment, ERHIResourceStates::RenderTarget);
+    commandList->ResourceBarrier(colorAttachment, ERHIResourceStates::RenderTarget);
 
     std::vector<RHIViewport> viewports;
     viewports.push_back(RHIViewport::Create((float)m_Width, (float)m_Height));
     std::vector<RHIRect> scissorRects;
     scissorRects.push_back(RHIRect::Create(m_Width, m_Height));
 
-    m_CommandList->SetPipelineState(m_GraphicsPipeline);
-    m_CommandList->SetFrameBuffer(m_FrameBuffers[currentFrame], &RHIClearValue::Red, 1);
-    m_CommandList->SetViewports(viewports);
-    m_CommandList->SetScissorRects(scissorRects);
-    m_CommandList->SetVertexBuffer(m_VertexBuffer);
-    m_CommandList->SetIndexBuffer(m_IndexBuffer);
-    m_CommandList->SetResourceSet(m_ResourceSet);
-    m_CommandList->DrawIndexed(m_Mesh->GetIndicesCount(), s_InstancesCount);
-    // m_CommandList->DrawIndexedIndirect(m_IndirectDrawCommandsBuffer, 1);
-    m_CommandList->ResourceBarrier(colorAttachment, ERHIResourceStates::Present);
-    m_CommandList->End();
+    commandList->SetPipelineState(m_GraphicsPipeline);
+    commandList->SetFrameBuffer(m_FrameBuffers[currentFrame], &RHIClearValue::Red, 1);
+    commandList->SetViewports(viewports);
+    commandList->SetScissorRects(scissorRects);
+    commandList->SetVertexBuffer(m_VertexBuffer);
+    commandList->SetIndexBuffer(m_IndexBuffer);
+    commandList->SetResourceSet(m_ResourceSet);
+    commandList->DrawIndexed(m_Mesh->GetIndicesCount(), s_InstancesCount);
+    // commandList->DrawIndexedIndirect(m_IndirectDrawCommandsBuffer, 1);
+    commandList->ResourceBarrier(colorAttachment, ERHIResourceStates::Present);
+    commandList->End();
     
-    RHI::GetDevice()->ExecuteCommandList(m_CommandList, m_Fence);
-    m_Fence->CpuWait();
+    frameContext.EndFrame();
     m_SwapChain->Present();
     
 }
 
 void RhiTestApp::Shutdown()
 {
+    RHI::GetDevice()->GetFrameContext().WaitIdle();
     m_DepthStencilTexture.SafeRelease();
     for(uint32_t i = 0; i < m_FrameBuffers.size(); ++i)
     {